@@ -41,8 +41,6 @@
 #include <stdint.h>
 
 #include "generic_level_server.h"
-#include "app_timer.h"
-#include "fsm.h"
 
 /**
  * @defgroup APP_LEVEL Generic Level server behaviour
@@ -71,8 +69,9 @@
  * This behavioral interface will trigger large number of Set callbacks to report the changing
  * `present_level` value, therefore user must not do time consuming operations inside the callback.
  *
- * The smallest possible callback interval for a given transition time will be limited by
- * @ref MODEL_TIMER_TIMEOUT_MIN_TICKS.
+ * Transitions of all instances are driven by the shared transition engine (@ref MODEL_TRANSITION),
+ * so the callback interval during a transition is @ref MODEL_TRANSITION_TICK_INTERVAL_MS, and at
+ * most @ref MODEL_TRANSITION_SLOT_COUNT instances can be in transition at the same time.
  *
  * This module will call the `get_cb` to fetch the present level value from the application.
  *
@@ -91,8 +90,6 @@
 /**
  * Macro to create application level app_level_server_t context.
  *
- * Individual timer instances are created for each model instance.
- *
  * @param[in] _name                 Name of the app_level_server_t instance
  * @param[in] _force_segmented      If the Generic Level server shall use force segmentation of messages
  * @param[in] _mic_size             MIC size to be used by Generic Level server
@@ -102,12 +99,10 @@
 */
 
 #define APP_LEVEL_SERVER_DEF(_name, _force_segmented, _mic_size, _p_dtt, _set_cb, _get_cb)  \
-    APP_TIMER_DEF(_name ## _timer); \
     static app_level_server_t _name =  \
     {  \
         .server.settings.force_segmented = _force_segmented,  \
         .server.settings.transmic_size = _mic_size,  \
-        .timer.p_timer_id = &_name ## _timer,  \
         .p_dtt_ms = _p_dtt, \
         .level_set_cb = _set_cb,  \
         .level_get_cb = _get_cb  \
@@ -200,8 +195,6 @@ struct __app_level_server_t
 {
     /** Level server model interface context structure */
     generic_level_server_t server;
-    /** Timer instance pointer */
-    model_timer_t timer;
     /** Callaback to be called for informing the user application to update the value*/
     app_level_set_cb_t  level_set_cb;
     /** Callback to be called for requesting current value from the user application */
@@ -212,9 +205,6 @@ struct __app_level_server_t
     /** Internal variable. Representation of the Level state related data and transition parameters
      *  required for behavioral implementation, and for communicating with the application */
     app_level_state_t state;
-
-    /** Internal. */
-    fsm_t fsm;
 };
 
 /** Initiates value fetch from the user application by calling a get callback, updates internal state,
@@ -43,17 +43,11 @@
 #include "sdk_config.h"
 #include "example_common.h"
 #include "generic_level_server.h"
+#include "model_transition.h"
 
 #include "log.h"
-#include "app_timer.h"
-#include "fsm.h"
-#include "fsm_assistant.h"
 #include "nrf_mesh_assert.h"
 
-#define REMAINING_TIME(pserver)             ((pserver)->state.transition_time_ms - MODEL_TIMER_PERIOD_MS_GET(model_timer_elapsed_ticks_get(&(pserver)->timer)))
-#define TRANSITION_TIME_COMPLETE(pserver)   (MODEL_TIMER_PERIOD_MS_GET(model_timer_elapsed_ticks_get(&(pserver)->timer)) >= (pserver)->state.transition_time_ms)
-#define ELAPSED_TIME(pserver)               (MODEL_TIMER_PERIOD_MS_GET(model_timer_elapsed_ticks_get(&(pserver)->timer)))
-
 /* Forward declaration */
 static void generic_level_state_get_cb(const generic_level_server_t * p_self,
                                        const access_message_rx_meta_t * p_meta,
@@ -85,238 +79,14 @@ static const generic_level_server_callbacks_t m_level_srv_cbs =
 };
 
 /**************************************************************************************************/
-/* Behavioral state machine */
-/* Various states of level server behavioral module*/
-
-/*lint -e123 Lint fails to understand particular use of the all fsm macros and throws the warning:
-> Macro '_DECLARE_ENUM' defined with arguments at line 185 this is just a warning  --
-> The name of a macro defined with arguments was subsequently used without a following '('.
-> This is legal but may be an oversight.
-In this case it is intentional.*/
-
-#define EVENT_LIST E_SET,                       \
-                   E_DELTA_SET,                 \
-                   E_MOVE_SET,                  \
-                   E_TIMEOUT
-
-#define STATE_LIST  S_IDLE,                     \
-                    S_IN_DELAY,                 \
-                    S_IN_TRANSITION
-
-#define ACTION_LIST A_DELAY_START,          a_delay_start,         \
-                    A_TRANSITION_START,     a_transition_start,    \
-                    A_TRANSITION_COMPLETE,  a_transition_complete, \
-                    A_TRANSITION_TICK,      a_transition_tick
-
-#define GUARD_LIST  G_SET_DELAY,            g_set_delay,           \
-                    G_SET_TRANSITION,       g_set_transition,      \
-                    G_TRANSITION_COMPLETE,  g_transition_complete
-
-typedef enum
-{
-    DECLARE_ENUM(EVENT_LIST)
-} app_level_event_ids_t;
-
-typedef enum
-{
-    DECLARE_ENUM(STATE_LIST)
-} app_level_state_ids_t;
-
-typedef enum
-{
-    DECLARE_ENUM_PAIR(ACTION_LIST)
-} app_level_action_ids_t;
-
-typedef enum
-{
-    DECLARE_ENUM_PAIR(GUARD_LIST)
-} app_level_guard_ids_t;
+/***** Transition handling *****/
+/* Note: Gradual changes of `present_level` are interpolated by the shared transition engine
+ * (model_transition.h), which drives the transitions of all Level server instances from a
+ * single tick. */
 
-typedef void (* app_level_fsm_action_t)(void *);
-typedef bool (* app_level_fsm_guard_t)(void *);
-
-/* Not having a semi-colon is intentional. */
-DECLARE_ACTION_PROTOTYPE(ACTION_LIST)
-DECLARE_GUARD_PROTOTYPE(GUARD_LIST)
-
-static void app_level_fsm_action(fsm_action_id_t action_id, void * p_data);
-static bool app_level_fsm_guard(fsm_action_id_t action_id, void * p_data);
-
-static const fsm_transition_t m_app_level_fsm_transition_table[] =
-{
-    FSM_STATE(S_IDLE),
-
-    FSM_STATE(S_IN_DELAY),
-    FSM_TRANSITION(E_TIMEOUT,        G_SET_TRANSITION,       A_TRANSITION_START,    S_IN_TRANSITION),
-    FSM_TRANSITION(E_TIMEOUT,        FSM_OTHERWISE,          A_TRANSITION_COMPLETE, S_IDLE),
-
-    FSM_STATE(S_IN_TRANSITION),
-    FSM_TRANSITION(E_TIMEOUT,        G_TRANSITION_COMPLETE,  A_TRANSITION_COMPLETE, S_IDLE),
-    FSM_TRANSITION(E_TIMEOUT,        FSM_ALWAYS,             A_TRANSITION_TICK,     S_IN_TRANSITION),
-
-    FSM_STATE(FSM_ANY_STATE),
-    FSM_TRANSITION(E_SET,             G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
-    FSM_TRANSITION(E_SET,             G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
-    FSM_TRANSITION(E_SET,             FSM_OTHERWISE,      A_TRANSITION_COMPLETE,S_IDLE),
-    FSM_TRANSITION(E_DELTA_SET,       G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
-    FSM_TRANSITION(E_DELTA_SET,       G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
-    FSM_TRANSITION(E_DELTA_SET,       FSM_OTHERWISE,      A_TRANSITION_COMPLETE,S_IDLE),
-    FSM_TRANSITION(E_MOVE_SET,        G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
-    FSM_TRANSITION(E_MOVE_SET,        G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
-    FSM_TRANSITION(E_MOVE_SET,        FSM_OTHERWISE,      FSM_NO_ACTION,        S_IDLE)
-};
-
-#if FSM_DEBUG
-static const char * m_action_lookup_table[] =
+static void transition_complete(app_level_server_t * p_server)
 {
-    DECLARE_STRING_PAIR(ACTION_LIST)
-};
-
-static const char * m_guard_lookup_table[] =
-{
-    DECLARE_STRING_PAIR(GUARD_LIST)
-};
-
-static const char * m_event_lookup_table[] =
-{
-    DECLARE_STRING(EVENT_LIST)
-};
-
-static const char * m_state_lookup_table[] =
-{
-    DECLARE_STRING(STATE_LIST)
-};
-#endif  /* FSM_DEBUG */
-
-static const fsm_const_descriptor_t m_level_behaviour_descriptor =
-{
-    .transition_table = m_app_level_fsm_transition_table,
-    .transitions_count = ARRAY_SIZE(m_app_level_fsm_transition_table),
-    .initial_state = S_IDLE,
-    .guard = app_level_fsm_guard,
-    .action = app_level_fsm_action,
-#if FSM_DEBUG
-    .fsm_name = "LVL-fsm",
-    .action_lookup = m_action_lookup_table,
-    .event_lookup = m_event_lookup_table,
-    .guard_lookup = m_guard_lookup_table,
-    .state_lookup = m_state_lookup_table
-#endif  /* FSM_DEBUG */
-};
-
-static const app_level_fsm_action_t app_level_fsm_actions[] =
-{
-    DECLARE_HANDLER(ACTION_LIST)
-};
-
-static void app_level_fsm_action(fsm_action_id_t action_id, void * p_data)
-{
-    app_level_fsm_actions[action_id](p_data);
-}
-
-static const app_level_fsm_guard_t app_level_fsm_guards[] =
-{
-    DECLARE_HANDLER(GUARD_LIST)
-};
-
-static bool app_level_fsm_guard(fsm_guard_id_t guard_id, void * p_data)
-{
-    return app_level_fsm_guards[guard_id](p_data);
-}
-/*lint +e123 */
-/**************************************************************************************************/
-/***** State machine functions *****/
-/* Note: The task of this state machine is to implement gradual changes of `present_level` value
- * for all possible time intervals and step size combinations allowed by the level model */
-
-static void a_delay_start(void * p_data)
-{
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    p_server->timer.mode = MODEL_TIMER_MODE_SINGLE_SHOT;
-    p_server->timer.timeout_rtc_ticks = MODEL_TIMER_TICKS_GET_MS(p_server->state.delay_ms);
-
-    uint32_t status = model_timer_schedule(&p_server->timer);
-    if (status != NRF_SUCCESS)
-    {
-        __LOG(LOG_SRC_APP, LOG_LEVEL_ERROR, "Failed to start delay timer.\n");
-    }
-}
-
-static void a_transition_start(void * p_data)
-{
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    /* Calculate required delta factors required for level change. */
-    uint32_t abs_delta;
-    uint64_t transition_time_us;
-    uint64_t transition_step_us;
-
-    if (p_server->state.transition_type == TRANSITION_MOVE_SET)
-    {
-        abs_delta = abs(p_server->state.params.move.required_move);
-    }
-    else
-    {
-        abs_delta = abs(p_server->state.params.set.required_delta);
-    }
-    transition_time_us = MS_TO_US((uint64_t) p_server->state.transition_time_ms);
-    transition_step_us = transition_time_us/abs_delta;
-
-    if (transition_step_us < MS_TO_US(MODEL_TIMER_PERIOD_MS_GET(MODEL_TIMER_TIMEOUT_MIN_TICKS)))
-    {
-        /* We cannot fire timer more frequently than MODEL_TIMER_TIMEOUT_MIN_TICKS, thus
-        increment present level in suitable steps. */
-        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Selecting minimum tick interval\n");
-              p_server->timer.timeout_rtc_ticks = MODEL_TIMER_TIMEOUT_MIN_TICKS;
-    }
-    else
-    {
-        /* Perform level transition using time steps corresponding to one step change. */
-        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Selecting interval for one step change\n");
-              p_server->timer.timeout_rtc_ticks = MODEL_TIMER_TICKS_GET_US(transition_step_us);
-    }
-
-    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "timeout_rtc_ticks: %d ticks\n", (uint32_t) p_server->timer.timeout_rtc_ticks);
-
-    p_server->timer.mode = MODEL_TIMER_MODE_REPEATED;
-    uint32_t status = model_timer_schedule(&p_server->timer);
-
-    if (status != NRF_SUCCESS)
-    {
-        __LOG(LOG_SRC_APP, LOG_LEVEL_ERROR, "Failed to start transition timer\n");
-    }
-}
-
-static void a_transition_tick(void * p_data)
-{
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    if (p_server->state.transition_type != TRANSITION_MOVE_SET)
-    {
-        /* Calculate new value using linear interpolation and provide to the application. */
-        int32_t delta = (p_server->state.target_level - p_server->state.params.set.initial_present_level);
-        p_server->state.present_level = p_server->state.params.set.initial_present_level +
-                                        (delta * (int32_t)ELAPSED_TIME(p_server) / (int32_t)p_server->state.transition_time_ms);
-    }
-    else
-    {
-        p_server->state.present_level = p_server->state.params.move.initial_present_level +
-                                        (((int64_t)ELAPSED_TIME(p_server) * (int64_t)p_server->state.params.move.required_move) /
-                                          (int64_t)p_server->state.transition_time_ms);
-    }
-
-    p_server->level_set_cb(p_server, p_server->state.present_level);
-    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG1, "Elapsed time: %d\n", (uint32_t) ELAPSED_TIME(p_server));
-}
-
-static void a_transition_complete(void * p_data)
-{
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    model_timer_abort(&p_server->timer);
     p_server->state.transition_time_ms = 0;
-
     p_server->state.present_level = p_server->state.target_level;
 
     generic_level_status_params_t status_params;
@@ -328,56 +98,92 @@ static void a_transition_complete(void * p_data)
     p_server->level_set_cb(p_server, p_server->state.present_level);
 }
 
-static bool g_set_delay(void * p_data)
+static void level_transition_cb(void * p_context, int32_t present_value, bool complete)
 {
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
+    app_level_server_t * p_server = (app_level_server_t *) p_context;
 
-    return (p_server->state.delay_ms > 0);
+    if (complete)
+    {
+        /* Move transitions complete when reaching the limit of the Level state, which is also
+         * their target level. */
+        transition_complete(p_server);
+    }
+    else
+    {
+        p_server->state.present_level = (int16_t) present_value;
+        p_server->level_set_cb(p_server, p_server->state.present_level);
+    }
 }
 
-static bool g_set_transition(void * p_data)
+static bool transition_is_valid(const app_level_server_t * p_server)
 {
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    bool result = false;
-
     switch (p_server->state.transition_type)
     {
         /* Requirement: If transition time is not within valid range, do not start the transition. */
         case TRANSITION_SET:
         /* fall-through */
         case TRANSITION_DELTA_SET:
-            result = (p_server->state.transition_time_ms > 0);
-        break;
+            return (p_server->state.transition_time_ms > 0);
 
         /* Requirement: If transition time is not within valid range, or given move level (delta level)
         is zero, do not start the transition. */
         case TRANSITION_MOVE_SET:
-            result = (p_server->state.transition_time_ms > 0 &&
-                      p_server->state.transition_time_ms != MODEL_TRANSITION_TIME_INVALID &&
-                      p_server->state.params.move.required_move != 0);
-        break;
+            return (p_server->state.transition_time_ms > 0 &&
+                    p_server->state.transition_time_ms != MODEL_TRANSITION_TIME_INVALID &&
+                    p_server->state.params.move.required_move != 0);
 
         default:
-        break;
+            return false;
     }
-
-    return (result);
-}
-
-static bool g_transition_complete(void * p_data)
-{
-    app_level_server_t * p_server = (app_level_server_t *) p_data;
-
-    return (p_server->state.transition_type != TRANSITION_MOVE_SET && TRANSITION_TIME_COMPLETE(p_server));
 }
 
-/* Model timer callback. This is used for delay and step-wise transition implementation */
-static void level_state_timer_cb(void * p_context)
+static void transition_process(app_level_server_t * p_server)
 {
-    app_level_server_t * p_server = (app_level_server_t *) p_context;
+    model_transition_params_t params =
+    {
+        .type = MODEL_TRANSITION_TYPE_LINEAR,
+        .start_value = p_server->state.present_level,
+        .target_value = p_server->state.target_level,
+        .delay_ms = p_server->state.delay_ms,
+        .transition_time_ms = 0,
+        .cb = level_transition_cb,
+        .p_context = p_server
+    };
+
+    if (transition_is_valid(p_server))
+    {
+        params.transition_time_ms = p_server->state.transition_time_ms;
+        if (p_server->state.transition_type == TRANSITION_MOVE_SET)
+        {
+            params.type = MODEL_TRANSITION_TYPE_MOVE;
+            params.move_delta = p_server->state.params.move.required_move;
+        }
+        else
+        {
+            /* Delta Set transitions may accumulate over several messages, interpolate from the
+             * level the first message of the transaction started at. */
+            params.start_value = p_server->state.params.set.initial_present_level;
+        }
+    }
+    else if (p_server->state.transition_type == TRANSITION_MOVE_SET)
+    {
+        /* Requirement: A Move Set with invalid transition parameters stops any ongoing change. */
+        (void) model_transition_abort(p_server);
+        return;
+    }
+    else if (p_server->state.delay_ms == 0)
+    {
+        (void) model_transition_abort(p_server);
+        transition_complete(p_server);
+        return;
+    }
 
-    fsm_event_post(&p_server->fsm, E_TIMEOUT, p_server);
+    uint32_t status = model_transition_start(&params);
+    if (status != NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_ERROR, "Failed to start transition: %d\n", status);
+        transition_complete(p_server);
+    }
 }
 
 /**************************************************************************************************/
@@ -404,14 +210,7 @@ static void generic_level_state_get_cb(const generic_level_server_t * p_self,
     }
     else
     {
-        if (TRANSITION_TIME_COMPLETE(p_server))
-        {
-            p_out->remaining_time_ms = 0;
-        }
-        else
-        {
-            p_out->remaining_time_ms = REMAINING_TIME(p_server);
-        }
+        p_out->remaining_time_ms = model_transition_remaining_time_get(p_server);
     }
 }
 
@@ -453,7 +252,7 @@ static void generic_level_state_set_cb(const generic_level_server_t * p_self,
           p_server->state.target_level,  p_server->state.delay_ms, p_server->state.transition_time_ms,
           p_server->state.params.set.required_delta);
 
-    fsm_event_post(&p_server->fsm, E_SET, p_server);
+    transition_process(p_server);
 
     /* Prepare response */
     if (p_out != NULL)
@@ -515,7 +314,7 @@ static void generic_level_state_delta_set_cb(const generic_level_server_t * p_se
     __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Delta SET: initial-level: %d  present-level: %d  target-level: %d\n",
           p_server->state.params.set.initial_present_level, p_server->state.present_level, p_server->state.target_level);
 
-    fsm_event_post(&p_server->fsm, E_DELTA_SET, p_server);
+    transition_process(p_server);
 
     /* Prepare response */
     if (p_out != NULL)
@@ -585,7 +384,7 @@ static void generic_level_state_move_set_cb(const generic_level_server_t * p_sel
     __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "MOVE SET: move-level: %d  delay: %d  tt: %d \n",
           p_in->move_level, p_server->state.delay_ms, p_server->state.transition_time_ms);
 
-    fsm_event_post(&p_server->fsm, E_MOVE_SET, p_server);
+    transition_process(p_server);
 
     /* Prepare response */
     if (p_out != NULL)
@@ -602,7 +401,7 @@ static void generic_level_state_move_set_cb(const generic_level_server_t * p_sel
 uint32_t app_level_current_value_publish(app_level_server_t * p_server)
 {
     p_server->level_get_cb(p_server, &p_server->state.present_level);
-    model_timer_abort(&p_server->timer);
+    (void) model_transition_abort(p_server);
 
     p_server->state.target_level = p_server->state.present_level;
     p_server->state.delay_ms = 0;
@@ -636,11 +435,7 @@ uint32_t app_level_init(app_level_server_t * p_server, uint8_t element_index)
 
     if (status == NRF_SUCCESS)
     {
-        p_server->timer.p_context = p_server;
-        p_server->timer.cb = level_state_timer_cb;
-
-        fsm_init(&p_server->fsm, &m_level_behaviour_descriptor);
-        status = model_timer_create(&p_server->timer);
+        status = model_transition_init();
     }
 
     return status;
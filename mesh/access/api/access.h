@@ -379,6 +379,35 @@ uint32_t access_model_add(const access_model_add_params_t * p_model_params,
  */
 uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t * p_message);
 
+/**
+ * Publishes an access layer message to the given address instead of the publish address of the model.
+ *
+ * The message is sent with the publish TTL of the model. The publication state of the model is
+ * left unchanged.
+ *
+ * @param[in] handle         Access handle for the model that wants to send data.
+ * @param[in] address_handle Handle of the destination address.
+ * @param[in] appkey_handle  Handle of the application or device key to send the message with, or
+ *                           @ref DSM_HANDLE_INVALID to use the publish application key of the model.
+ * @param[in] p_message      Access layer TX message parameter structure.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle, model not bound to element or invalid
+ *                                  address handle.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER, or the
+ *                                  destination address is unassigned.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, address handle not set or wrong
+ *                                  opcode format.
+ * @retval NRF_ERROR_INVALID_LENGTH Attempted to send message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
+ */
+uint32_t access_model_publish_to(access_model_handle_t handle,
+                                 dsm_handle_t address_handle,
+                                 dsm_handle_t appkey_handle,
+                                 const access_message_tx_t * p_message);
+
 /**
  * Replies to an access layer message.
  *
@@ -93,6 +93,12 @@
 /** Time in microseconds to wait before retrying a publish if the stack reports @c NRF_ERROR_NO_MEM. */
 #define ACCESS_RELIABLE_RETRY_DELAY (MS_TO_US(BEARER_ADV_INT_DEFAULT_MS) * 2)
 
+/**
+ * Maximum number of times @ref ACCESS_RELIABLE_RETRY_DELAY is doubled for a transfer that keeps
+ * getting @c NRF_ERROR_NO_MEM.
+ */
+#define ACCESS_RELIABLE_RETRY_BACK_OFF_MAX (3)
+
 /** @} */
 
 /**
@@ -152,6 +158,48 @@ typedef struct
     access_reliable_cb_t status_cb;
 } access_reliable_t;
 
+/**
+ * Access layer reliable transaction callback type.
+ * Used to indicate a successful or unsuccessful transaction started with
+ * access_model_reliable_transaction_publish().
+ *
+ * @param[in] model_handle Access layer model handle.
+ * @param[in] p_args       Generic argument pointer.
+ * @param[in] dst          Destination address of the transaction.
+ * @param[in] status       Access reliable transfer status code.
+ */
+typedef void (*access_reliable_transaction_cb_t)(access_model_handle_t model_handle,
+                                                 void * p_args,
+                                                 uint16_t dst,
+                                                 access_reliable_status_t status);
+
+/**
+ * Access layer reliable transaction parameter structure.
+ *
+ * Unlike @ref access_reliable_t, a transaction has an explicit destination, and a model may have
+ * several transactions in progress at once. A transaction is identified by its model handle,
+ * destination address and reply opcode.
+ */
+typedef struct
+{
+    /** Access layer model handle. */
+    access_model_handle_t model_handle;
+    /** Handle of the destination address. The publish address of the model is not used. */
+    dsm_handle_t address_handle;
+    /**
+     * Access layer message.
+     * @note The data pointed to must be retained for the entire reliable
+     * transfer.
+     */
+    access_message_tx_t message;
+    /** Opcode of the expected reply. */
+    access_opcode_t reply_opcode;
+    /** Relative transaction timeout. */
+    uint32_t timeout;
+    /** Callback to call after the transaction has ended. */
+    access_reliable_transaction_cb_t status_cb;
+} access_reliable_transaction_t;
+
 /** @} */
 
 /**
@@ -184,7 +232,45 @@ void access_reliable_cancel_all(void);
 uint32_t access_model_reliable_publish(const access_reliable_t * p_reliable);
 
 /**
- * Cancels an ongoing reliable message.
+ * Starts a reliable transaction to an explicit destination.
+ *
+ * A model can have any number of transactions in progress, limited by
+ * @ref ACCESS_RELIABLE_TRANSFER_COUNT, as long as they differ in destination or reply opcode.
+ * Replies to a transaction with a unicast destination are only accepted from that address.
+ *
+ * @param[in] p_transaction Reliable transaction parameter structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully started the reliable transaction.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NO_MEM         No free transfer contexts, or no memory available to send the
+ *                                  message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle, model not bound to element or invalid
+ *                                  address handle.
+ * @retval NRF_ERROR_INVALID_ADDR   The destination address is unassigned.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to application key, invalid timeout or wrong
+ *                                  opcode format.
+ * @retval NRF_ERROR_INVALID_STATE  A transaction with the same destination and reply opcode is
+ *                                  already in progress for the model.
+ * @retval NRF_ERROR_INVALID_LENGTH Attempted to send message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
+ */
+uint32_t access_model_reliable_transaction_publish(const access_reliable_transaction_t * p_transaction);
+
+/**
+ * Cancels an ongoing reliable transaction.
+ *
+ * @param[in] model_handle Access layer model handle that owns the transaction.
+ * @param[in] dst          Destination address of the transaction.
+ * @param[in] reply_opcode Reply opcode of the transaction.
+ *
+ * @retval NRF_SUCCESS         Successfully canceled the transaction.
+ * @retval NRF_ERROR_NOT_FOUND No such transaction, or invalid model handle.
+ */
+uint32_t access_model_reliable_transaction_cancel(access_model_handle_t model_handle,
+                                                  uint16_t dst,
+                                                  access_opcode_t reply_opcode);
+
+/**
+ * Cancels all ongoing reliable messages and transactions of a model.
  *
  * @param[in] model_handle Access layer model handle that owns the transfer.
  *
@@ -206,6 +292,8 @@ void access_reliable_message_rx_cb(access_model_handle_t model_handle, const acc
 /**
  * Checks if the model context for the given model handle is free for acknowledged message publishing
  *
+ * A model is busy while it has any reliable message or transaction in progress.
+ *
  * @param[in] model_handle Model handle of the model
  *
  * @retval True  If the model context is free for sending new acknowledged message.
@@ -60,6 +60,8 @@
 #include "toolchain.h"
 #include "event.h"
 #include "bearer_event.h"
+#include "instr.h"
+#include "mesh_stats.h"
 #if PERSISTENT_STORAGE
 #include "flash_manager.h"
 #endif
@@ -278,7 +280,7 @@ static void mesh_evt_cb(const nrf_mesh_evt_t * p_evt)
 
 }
 
-static bool check_tx_params(access_model_handle_t handle, const access_message_tx_t * p_tx_message, const access_message_rx_t * p_rx_message, uint32_t * p_status)
+static bool check_tx_params(access_model_handle_t handle, const access_message_tx_t * p_tx_message, const access_message_rx_t * p_rx_message, dsm_handle_t dst_handle, dsm_handle_t appkey_handle, uint32_t * p_status)
 {
     NRF_MESH_ASSERT(NULL != p_status);
 
@@ -294,8 +296,9 @@ static bool check_tx_params(access_model_handle_t handle, const access_message_t
         *p_status = NRF_ERROR_NOT_FOUND;
     }
     else if ((p_rx_message == NULL &&
-             (m_model_pool[handle].model_info.publish_appkey_handle  == DSM_HANDLE_INVALID ||
-              m_model_pool[handle].model_info.publish_address_handle == DSM_HANDLE_INVALID)) ||
+             ((appkey_handle == DSM_HANDLE_INVALID &&
+               m_model_pool[handle].model_info.publish_appkey_handle == DSM_HANDLE_INVALID) ||
+              dst_handle == DSM_HANDLE_INVALID)) ||
               !is_valid_opcode(p_tx_message->opcode))
     {
         *p_status = NRF_ERROR_INVALID_PARAM;
@@ -308,12 +311,20 @@ static bool check_tx_params(access_model_handle_t handle, const access_message_t
     return (NRF_SUCCESS == *p_status);
 }
 
+/**
+ * Sends a message from a model.
+ *
+ * Replies to @c p_rx_message if given, otherwise publishes to @c dst_handle with @c appkey_handle,
+ * or with the publish application key of the model if @c appkey_handle is @ref DSM_HANDLE_INVALID.
+ */
 static uint32_t packet_tx(access_model_handle_t handle,
                           const access_message_tx_t * p_tx_message,
-                          const access_message_rx_t * p_rx_message)
+                          const access_message_rx_t * p_rx_message,
+                          dsm_handle_t dst_handle,
+                          dsm_handle_t appkey_handle)
 {
     uint32_t status;
-    if (!check_tx_params(handle, p_tx_message, p_rx_message, &status))
+    if (!check_tx_params(handle, p_tx_message, p_rx_message, dst_handle, appkey_handle, &status))
     {
         return status;
     }
@@ -328,7 +339,6 @@ static uint32_t packet_tx(access_model_handle_t handle,
     uint16_t src_address = local_addresses.address_start + m_model_pool[handle].model_info.element_index;
 
     nrf_mesh_address_t dst_address;
-    dsm_handle_t appkey_handle;
     dsm_handle_t subnet_handle = DSM_HANDLE_INVALID;
     if (p_rx_message != NULL)
     {
@@ -338,8 +348,11 @@ static uint32_t packet_tx(access_model_handle_t handle,
     }
     else
     {
-        appkey_handle = m_model_pool[handle].model_info.publish_appkey_handle;
-        if (dsm_address_get(m_model_pool[handle].model_info.publish_address_handle, &dst_address) != NRF_SUCCESS)
+        if (appkey_handle == DSM_HANDLE_INVALID)
+        {
+            appkey_handle = m_model_pool[handle].model_info.publish_appkey_handle;
+        }
+        if (dsm_address_get(dst_handle, &dst_address) != NRF_SUCCESS)
         {
             return NRF_ERROR_NOT_FOUND;
         }
@@ -935,7 +948,10 @@ void access_flash_config_store(void)
 /* ********** Private API ********** */
 void access_incoming_handle(const access_message_rx_t * p_message)
 {
+    INSTR_STAGE_BEGIN(instr_start);
+    MESH_STATS_INC(MESH_STATS_ACCESS_RX);
     const nrf_mesh_address_t * p_dst = &p_message->meta_data.dst;
+    bool handled = false;
 
     if (dsm_address_is_rx(p_dst))
     {
@@ -968,9 +984,16 @@ void access_incoming_handle(const access_message_rx_t * p_message)
                     access_reliable_message_rx_cb(i, p_message, p_model->p_args);
                 }
                 p_model->p_opcode_handlers[opcode_index].handler(i, p_message, p_model->p_args);
+                handled = true;
             }
         }
     }
+
+    if (!handled)
+    {
+        MESH_STATS_INC(MESH_STATS_ACCESS_RX_UNHANDLED);
+    }
+    INSTR_STAGE_END(INSTR_STAGE_ACCESS, instr_start);
 }
 
 /* ********** Public API ********** */
@@ -986,6 +1009,7 @@ void access_init(void)
     access_state_clear();
 
     m_evt_handler.evt_cb = mesh_evt_cb;
+    m_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
     nrf_mesh_evt_handler_add(&m_evt_handler);
     access_reliable_init();
     access_publish_init();
@@ -1068,7 +1092,25 @@ uint32_t access_model_publish(access_model_handle_t handle, const access_message
     }
     else
     {
-        return packet_tx(handle, p_message, NULL);
+        /* An invalid handle is reported by packet_tx(). */
+        dsm_handle_t publish_address_handle = model_handle_valid_and_allocated(handle) ?
+            m_model_pool[handle].model_info.publish_address_handle : DSM_HANDLE_INVALID;
+        return packet_tx(handle, p_message, NULL, publish_address_handle, DSM_HANDLE_INVALID);
+    }
+}
+
+uint32_t access_model_publish_to(access_model_handle_t handle,
+                                 dsm_handle_t address_handle,
+                                 dsm_handle_t appkey_handle,
+                                 const access_message_tx_t * p_message)
+{
+    if (p_message == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else
+    {
+        return packet_tx(handle, p_message, NULL, address_handle, appkey_handle);
     }
 }
 
@@ -1082,7 +1124,7 @@ uint32_t access_model_reply(access_model_handle_t handle,
     }
     else
     {
-        return packet_tx(handle, p_reply, p_message);
+        return packet_tx(handle, p_reply, p_message, DSM_HANDLE_INVALID, DSM_HANDLE_INVALID);
     }
 }
 
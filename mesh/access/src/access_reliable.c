@@ -52,6 +52,7 @@
 #include "nrf_mesh_assert.h"
 #include "nrf_mesh_config_core.h"
 #include "nrf_mesh_defines.h"
+#include "nrf_mesh_utils.h"
 #include "packet_mesh.h"
 
 #include "timer.h"
@@ -64,11 +65,27 @@
 /** Invalid pool index. */
 #define ACCESS_RELIABLE_INDEX_INVALID (0xFFFF)
 
+/** Number of buckets in the context lookup table. */
+#define ACCESS_RELIABLE_BUCKET_COUNT (ACCESS_RELIABLE_TRANSFER_COUNT)
+
 typedef struct
 {
+    /** Message parameters. @c params.status_cb is @c NULL for transactions. */
     access_reliable_t params;
+    /** Callback of a transaction. */
+    access_reliable_transaction_cb_t transaction_cb;
+    /** Destination address handle of a transaction, or @c DSM_HANDLE_INVALID to use the publish address. */
+    dsm_handle_t dst_handle;
+    /** Destination of a transaction, or @c NRF_MESH_ADDR_UNASSIGNED if the reply may come from anyone. */
+    uint16_t dst;
     uint32_t next_timeout;
     uint32_t interval;
+    /** Number of consecutive @c NRF_ERROR_NO_MEM retries. */
+    uint8_t retry_count;
+    /** Position in the timeout heap. */
+    uint16_t heap_index;
+    /** Next context in the same lookup bucket, or the next free context. */
+    uint16_t next;
     bool in_use;
 } access_reliable_ctx_t;
 
@@ -77,6 +94,7 @@ typedef struct
 NRF_MESH_STATIC_ASSERT(ACCESS_RELIABLE_BACK_OFF_FACTOR > 0);
 NRF_MESH_STATIC_ASSERT(ACCESS_RELIABLE_INTERVAL_DEFAULT >= MS_TO_US(BEARER_ADV_INT_MIN_MS));
 NRF_MESH_STATIC_ASSERT(ACCESS_RELIABLE_SEGMENT_COUNT_PENALTY >= MS_TO_US(BEARER_ADV_INT_MIN_MS));
+NRF_MESH_STATIC_ASSERT(ACCESS_RELIABLE_TRANSFER_COUNT < ACCESS_RELIABLE_INDEX_INVALID);
 
 /* ******************* Static variables ******************* */
 
@@ -84,157 +102,189 @@ static struct
 {
     timer_event_t timer;
     access_reliable_ctx_t pool[ACCESS_RELIABLE_TRANSFER_COUNT];
+    /** Binary min-heap of active contexts, ordered by @c next_timeout. */
+    uint16_t heap[ACCESS_RELIABLE_TRANSFER_COUNT];
+    /** Contexts hashed by model handle and destination. */
+    uint16_t buckets[ACCESS_RELIABLE_BUCKET_COUNT];
+    uint16_t free_head;
     uint16_t active_count;
-    uint16_t next_timeout_index;
+    /** Context to retry first after running out of memory. */
+    uint16_t retry_index;
+    /** Number of transactions to group or virtual addresses, which can't be looked up by the reply source. */
+    uint16_t group_count;
+    /** Number of active contexts per model. */
+    uint16_t model_active_count[ACCESS_MODEL_COUNT];
 } m_reliable;
 
 /* ******************* Static functions ******************* */
 
-static void reliable_timer_cb(timestamp_t timestamp, void * p_context)
+static inline bool timeout_is_earlier(uint16_t index_a, uint16_t index_b)
 {
-    NRF_MESH_ASSERT(0 < m_reliable.active_count);
+    return TIMER_OLDER_THAN(m_reliable.pool[index_a].next_timeout, m_reliable.pool[index_b].next_timeout);
+}
 
-    timestamp += ACCESS_RELIABLE_TIMEOUT_MARGIN; /* TODO: Divide by two? */
-    m_reliable.next_timeout_index = ACCESS_RELIABLE_INDEX_INVALID;
+static inline void heap_set(uint16_t heap_index, uint16_t index)
+{
+    m_reliable.heap[heap_index] = index;
+    m_reliable.pool[index].heap_index = heap_index;
+}
 
-    for (uint32_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
+static void heap_sift_up(uint16_t heap_index)
+{
+    uint16_t index = m_reliable.heap[heap_index];
+    while (heap_index > 0)
     {
-        if (!m_reliable.pool[i].in_use)
+        uint16_t parent = (heap_index - 1) / 2;
+        if (!timeout_is_earlier(index, m_reliable.heap[parent]))
         {
-            continue;
+            break;
         }
-        else if (TIMER_OLDER_THAN(m_reliable.pool[i].params.timeout, timestamp))
-        {
-            /* Remove first, in case a crazy user tries to reschedule it in the callback. */
-            m_reliable.pool[i].in_use = false;
-            m_reliable.active_count--;
+        heap_set(heap_index, m_reliable.heap[parent]);
+        heap_index = parent;
+    }
+    heap_set(heap_index, index);
+}
 
-            void * p_args;
-            NRF_MESH_ERROR_CHECK(access_model_p_args_get(m_reliable.pool[i].params.model_handle, &p_args));
-            m_reliable.pool[i].params.status_cb(m_reliable.pool[i].params.model_handle, p_args, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+static void heap_sift_down(uint16_t heap_index)
+{
+    uint16_t index = m_reliable.heap[heap_index];
+    for (;;)
+    {
+        uint16_t child = 2 * heap_index + 1;
+        if (child >= m_reliable.active_count)
+        {
+            break;
         }
-        else if (TIMER_OLDER_THAN(m_reliable.pool[i].next_timeout, timestamp))
+        if (child + 1 < m_reliable.active_count && timeout_is_earlier(m_reliable.heap[child + 1], m_reliable.heap[child]))
         {
-            uint32_t status = access_model_publish(m_reliable.pool[i].params.model_handle, &m_reliable.pool[i].params.message);
-            m_reliable.next_timeout_index = i;
-            if (NRF_SUCCESS == status)
-            {
-                m_reliable.pool[i].next_timeout += m_reliable.pool[i].interval;
-                m_reliable.pool[i].interval *= ACCESS_RELIABLE_BACK_OFF_FACTOR;
-            }
-            else if (NRF_ERROR_NO_MEM == status)
-            {
-                /* If there is no more memory available, we might as well cancel the rest and set
-                 * the timer to fire in ACCESS_RELIABLE_RETRY_DELAY. */
-                m_reliable.pool[i].next_timeout += ACCESS_RELIABLE_RETRY_DELAY;
-                break;
-            }
-            else
-            {
-                /* This should have been caught by the first publish() call. */
-                NRF_MESH_ASSERT(false);
-            }
-
-            if (TIMER_OLDER_THAN(m_reliable.pool[i].params.timeout, m_reliable.pool[i].next_timeout))
-            {
-                /* Shift timeout forward. */
-                m_reliable.pool[i].next_timeout = m_reliable.pool[i].params.timeout;
-            }
+            child++;
         }
-        else if (ACCESS_RELIABLE_INDEX_INVALID == m_reliable.next_timeout_index ||
-                 TIMER_OLDER_THAN(m_reliable.pool[i].next_timeout,
-                                  m_reliable.pool[m_reliable.next_timeout_index].next_timeout))
+        if (!timeout_is_earlier(m_reliable.heap[child], index))
         {
-            /* Keep track of the next firing timeout. */
-            m_reliable.next_timeout_index = i;
+            break;
         }
+        heap_set(heap_index, m_reliable.heap[child]);
+        heap_index = child;
     }
+    heap_set(heap_index, index);
+}
 
-    /* Setting the interval > 0 will reschedule the timer. */
-    if (m_reliable.active_count > 0)
+/** Removes a context from the heap. The caller decrements the active count. */
+static void heap_remove(uint16_t index)
+{
+    uint16_t heap_index = m_reliable.pool[index].heap_index;
+    uint16_t last = m_reliable.heap[m_reliable.active_count - 1];
+    m_reliable.active_count--;
+    if (last != index)
     {
-        NRF_MESH_ASSERT(m_reliable.next_timeout_index < ACCESS_RELIABLE_TRANSFER_COUNT);
-        timestamp -= ACCESS_RELIABLE_TIMEOUT_MARGIN;
-        m_reliable.timer.interval = TIMER_DIFF(m_reliable.pool[m_reliable.next_timeout_index].next_timeout, timestamp);
+        heap_set(heap_index, last);
+        heap_sift_up(heap_index);
+        heap_sift_down(m_reliable.pool[last].heap_index);
     }
-    else
+}
+
+static inline uint16_t bucket_get(access_model_handle_t model_handle, uint16_t dst)
+{
+    return (uint16_t) ((((uint32_t) model_handle << 16) ^ (dst * 0x9E3779B1u)) % ACCESS_RELIABLE_BUCKET_COUNT);
+}
+
+static void bucket_remove(uint16_t index)
+{
+    const access_reliable_ctx_t * p_ctx = &m_reliable.pool[index];
+    uint16_t * p_link = &m_reliable.buckets[bucket_get(p_ctx->params.model_handle, p_ctx->dst)];
+    while (*p_link != index)
     {
-        m_reliable.timer.interval = 0;
+        NRF_MESH_ASSERT(*p_link != ACCESS_RELIABLE_INDEX_INVALID);
+        p_link = &m_reliable.pool[*p_link].next;
     }
+    *p_link = p_ctx->next;
+}
+
+static inline bool opcode_matches(const access_opcode_t * p_opcode, const access_opcode_t * p_reply_opcode)
+{
+    return (p_reply_opcode == NULL ||
+            (p_opcode->opcode == p_reply_opcode->opcode && p_opcode->company_id == p_reply_opcode->company_id));
 }
 
 /**
- * Searches for a context index given a model handle.
- * Returns true if it is found, false otherwise.
+ * Looks up a context by model handle, destination and reply opcode.
+ * A @c NULL reply opcode matches any reply opcode.
  */
-static bool find_index(access_model_handle_t model_handle, uint16_t * p_index)
+static uint16_t find_index(access_model_handle_t model_handle, uint16_t dst, const access_opcode_t * p_reply_opcode)
 {
-    *p_index = ACCESS_RELIABLE_INDEX_INVALID;
-
-    for (uint32_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
+    for (uint16_t i = m_reliable.buckets[bucket_get(model_handle, dst)];
+         i != ACCESS_RELIABLE_INDEX_INVALID;
+         i = m_reliable.pool[i].next)
     {
-        if (m_reliable.pool[i].in_use &&
-            m_reliable.pool[i].params.model_handle == model_handle)
+        if (m_reliable.pool[i].params.model_handle == model_handle &&
+            m_reliable.pool[i].dst == dst &&
+            opcode_matches(&m_reliable.pool[i].params.reply_opcode, p_reply_opcode))
         {
-            *p_index = i;
-            break;
+            return i;
         }
     }
-    return (*p_index != ACCESS_RELIABLE_INDEX_INVALID);
+    return ACCESS_RELIABLE_INDEX_INVALID;
 }
 
-/**
- * Gets the first available context.
- * Returns false if there are no available contexts or if the context already exists.
- */
-static bool available_context_get(const access_reliable_t * p_message, uint16_t * p_index, uint32_t * p_status)
+/** Finds the context a received message replies to. */
+static uint16_t find_reply_index(access_model_handle_t model_handle, const access_message_rx_t * p_message)
 {
-    *p_index = ACCESS_RELIABLE_INDEX_INVALID;
-    *p_status = NRF_ERROR_NO_MEM;
-    bearer_event_critical_section_begin();
-    if (ACCESS_RELIABLE_TRANSFER_COUNT >= m_reliable.active_count)
+    uint16_t index = ACCESS_RELIABLE_INDEX_INVALID;
+    if (p_message->meta_data.src.value != NRF_MESH_ADDR_UNASSIGNED)
+    {
+        index = find_index(model_handle, p_message->meta_data.src.value, &p_message->opcode);
+    }
+
+    if (index == ACCESS_RELIABLE_INDEX_INVALID)
     {
-        for (uint32_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
+        index = find_index(model_handle, NRF_MESH_ADDR_UNASSIGNED, &p_message->opcode);
+    }
+
+    if (index == ACCESS_RELIABLE_INDEX_INVALID && m_reliable.group_count > 0)
+    {
+        /* Any member of the group may reply. */
+        for (uint16_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
         {
-            if (!m_reliable.pool[i].in_use)
-            {
-                if (ACCESS_RELIABLE_INDEX_INVALID == *p_index)
-                {
-                    *p_status = NRF_SUCCESS;
-                    *p_index = i;
-                }
-            }
-            else if (m_reliable.pool[i].params.model_handle == p_message->model_handle)
+            if (m_reliable.pool[i].in_use &&
+                m_reliable.pool[i].params.model_handle == model_handle &&
+                m_reliable.pool[i].dst != NRF_MESH_ADDR_UNASSIGNED &&
+                nrf_mesh_address_type_get(m_reliable.pool[i].dst) != NRF_MESH_ADDRESS_TYPE_UNICAST &&
+                opcode_matches(&m_reliable.pool[i].params.reply_opcode, &p_message->opcode))
             {
-                *p_status = NRF_ERROR_INVALID_STATE;
+                index = i;
                 break;
             }
         }
     }
-    bearer_event_critical_section_end();
-    return (NRF_SUCCESS == *p_status);
+    return index;
 }
 
-static bool is_earliest_timeout(uint16_t index)
-{
-    return !(m_reliable.active_count > 0 &&
-             TIMER_OLDER_THAN(m_reliable.pool[m_reliable.next_timeout_index].next_timeout,
-                              m_reliable.pool[index].next_timeout));
-}
-
-static uint16_t get_next_timeout_index(uint16_t old_index)
+/**
+ * Gets the first available context.
+ * Returns false if there are no available contexts or if the context already exists.
+ */
+static bool available_context_get(access_model_handle_t model_handle,
+                                  uint16_t dst,
+                                  const access_opcode_t * p_reply_opcode,
+                                  uint16_t * p_index,
+                                  uint32_t * p_status)
 {
-    uint32_t next_timeout = m_reliable.pool[old_index].next_timeout + ACCESS_RELIABLE_TIMEOUT_MAX;
-    uint16_t next_index = ACCESS_RELIABLE_INDEX_INVALID;
-    for (uint16_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
+    bearer_event_critical_section_begin();
+    *p_index = m_reliable.free_head;
+    if (find_index(model_handle, dst, p_reply_opcode) != ACCESS_RELIABLE_INDEX_INVALID)
     {
-        if (m_reliable.pool[i].in_use && TIMER_OLDER_THAN(m_reliable.pool[i].next_timeout, next_timeout))
-        {
-            next_timeout = m_reliable.pool[i].next_timeout;
-            next_index = i;
-        }
+        *p_status = NRF_ERROR_INVALID_STATE;
+    }
+    else if (ACCESS_RELIABLE_INDEX_INVALID == *p_index)
+    {
+        *p_status = NRF_ERROR_NO_MEM;
+    }
+    else
+    {
+        *p_status = NRF_SUCCESS;
     }
-    return next_index;
+    bearer_event_critical_section_end();
+    return (NRF_SUCCESS == *p_status);
 }
 
 static uint32_t calculate_interval(const access_reliable_t * p_message)
@@ -254,45 +304,255 @@ static uint32_t calculate_interval(const access_reliable_t * p_message)
     return MIN(p_message->timeout, interval);
 }
 
-static void add_reliable_message(uint16_t index, const access_reliable_t * p_message)
+static uint32_t message_send(const access_reliable_ctx_t * p_ctx)
 {
-    NRF_MESH_ASSERT(!m_reliable.pool[index].in_use);
+    if (p_ctx->dst_handle == DSM_HANDLE_INVALID)
+    {
+        return access_model_publish(p_ctx->params.model_handle, &p_ctx->params.message);
+    }
+    else
+    {
+        return access_model_publish_to(p_ctx->params.model_handle, p_ctx->dst_handle, DSM_HANDLE_INVALID,
+                                       &p_ctx->params.message);
+    }
+}
+
+static void add_reliable_message(uint16_t index,
+                                 const access_reliable_t * p_message,
+                                 access_reliable_transaction_cb_t transaction_cb,
+                                 dsm_handle_t dst_handle,
+                                 uint16_t dst)
+{
+    access_reliable_ctx_t * p_ctx = &m_reliable.pool[index];
+    NRF_MESH_ASSERT(!p_ctx->in_use);
     uint32_t time_now = timer_now();
-    memcpy(&(m_reliable.pool[index].params), p_message, sizeof(access_reliable_t));
-    m_reliable.pool[index].interval = calculate_interval(p_message);
-    m_reliable.pool[index].params.timeout += time_now;
-    m_reliable.pool[index].next_timeout = time_now + m_reliable.pool[index].interval;
+    memcpy(&p_ctx->params, p_message, sizeof(access_reliable_t));
+    p_ctx->transaction_cb = transaction_cb;
+    p_ctx->dst_handle = dst_handle;
+    p_ctx->dst = dst;
+    p_ctx->retry_count = 0;
+    p_ctx->interval = calculate_interval(p_message);
+    p_ctx->params.timeout += time_now;
+    p_ctx->next_timeout = time_now + p_ctx->interval;
 
     bearer_event_critical_section_begin();
-    if (is_earliest_timeout(index))
+    bool earliest = (m_reliable.active_count == 0 || !timeout_is_earlier(m_reliable.heap[0], index));
+
+    NRF_MESH_ASSERT(m_reliable.free_head == index);
+    m_reliable.free_head = p_ctx->next;
+    uint16_t bucket = bucket_get(p_ctx->params.model_handle, dst);
+    p_ctx->next = m_reliable.buckets[bucket];
+    m_reliable.buckets[bucket] = index;
+
+    heap_set(m_reliable.active_count, index);
+    m_reliable.active_count++;
+    heap_sift_up(p_ctx->heap_index);
+
+    if (dst != NRF_MESH_ADDR_UNASSIGNED && nrf_mesh_address_type_get(dst) != NRF_MESH_ADDRESS_TYPE_UNICAST)
     {
-        timer_sch_reschedule(&m_reliable.timer, m_reliable.pool[index].next_timeout);
-        m_reliable.next_timeout_index = index;
+        m_reliable.group_count++;
+    }
+    m_reliable.model_active_count[p_ctx->params.model_handle]++;
+    p_ctx->in_use = true;
+
+    if (earliest)
+    {
+        timer_sch_reschedule(&m_reliable.timer, p_ctx->next_timeout);
     }
-    m_reliable.pool[index].in_use = true;
-    m_reliable.active_count++;
     bearer_event_critical_section_end();
 }
 
-static void remove_and_reschedule(uint16_t index)
+/** Removes a context without touching the timer. Returns whether it was the earliest timeout. */
+static bool remove_context(uint16_t index)
 {
-    NRF_MESH_ASSERT(m_reliable.pool[index].in_use);
+    access_reliable_ctx_t * p_ctx = &m_reliable.pool[index];
+    NRF_MESH_ASSERT(p_ctx->in_use);
     NRF_MESH_ASSERT(m_reliable.active_count > 0);
-    m_reliable.pool[index].in_use = false;
-    m_reliable.active_count--;
-    if (m_reliable.active_count > 0)
+    bool was_earliest = (p_ctx->heap_index == 0);
+    if (m_reliable.retry_index == index)
+    {
+        m_reliable.retry_index = ACCESS_RELIABLE_INDEX_INVALID;
+    }
+
+    heap_remove(index);
+    bucket_remove(index);
+    if (p_ctx->dst != NRF_MESH_ADDR_UNASSIGNED && nrf_mesh_address_type_get(p_ctx->dst) != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        m_reliable.group_count--;
+    }
+    m_reliable.model_active_count[p_ctx->params.model_handle]--;
+    p_ctx->in_use = false;
+    p_ctx->next = m_reliable.free_head;
+    m_reliable.free_head = index;
+    return was_earliest;
+}
+
+static void remove_and_reschedule(uint16_t index)
+{
+    if (remove_context(index))
     {
-        if (m_reliable.next_timeout_index == index)
+        if (m_reliable.active_count > 0)
         {
-            m_reliable.next_timeout_index = get_next_timeout_index(index);
-            NRF_MESH_ASSERT(m_reliable.next_timeout_index != ACCESS_RELIABLE_INDEX_INVALID);
-            timer_sch_reschedule(&m_reliable.timer,
-                                 m_reliable.pool[m_reliable.next_timeout_index].next_timeout);
+            timer_sch_reschedule(&m_reliable.timer, m_reliable.pool[m_reliable.heap[0]].next_timeout);
         }
+        else
+        {
+            timer_sch_abort(&m_reliable.timer);
+        }
+    }
+}
+
+/** Notifies the owner of a context that has been removed. */
+static void notify(const access_reliable_ctx_t * p_ctx, void * p_args, access_reliable_status_t status)
+{
+    if (p_ctx->transaction_cb != NULL)
+    {
+        p_ctx->transaction_cb(p_ctx->params.model_handle, p_args, p_ctx->dst, status);
     }
     else
     {
-        timer_sch_abort(&m_reliable.timer);
+        p_ctx->params.status_cb(p_ctx->params.model_handle, p_args, status);
+    }
+}
+
+static void notify_with_model_args(const access_reliable_ctx_t * p_ctx, access_reliable_status_t status)
+{
+    void * p_args;
+    NRF_MESH_ERROR_CHECK(access_model_p_args_get(p_ctx->params.model_handle, &p_args));
+    notify(p_ctx, p_args, status);
+}
+
+static void reliable_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    NRF_MESH_ASSERT(0 < m_reliable.active_count);
+
+    timestamp += ACCESS_RELIABLE_TIMEOUT_MARGIN; /* TODO: Divide by two? */
+    uint16_t retry_index = ACCESS_RELIABLE_INDEX_INVALID;
+
+    while (m_reliable.active_count > 0)
+    {
+        /* The transfer that last ran out of buffers goes first, so it isn't starved by the others. */
+        uint16_t index = m_reliable.heap[0];
+        if (m_reliable.retry_index != ACCESS_RELIABLE_INDEX_INVALID &&
+            TIMER_OLDER_THAN(m_reliable.pool[m_reliable.retry_index].next_timeout, timestamp))
+        {
+            index = m_reliable.retry_index;
+        }
+        m_reliable.retry_index = ACCESS_RELIABLE_INDEX_INVALID;
+
+        access_reliable_ctx_t * p_ctx = &m_reliable.pool[index];
+        if (!TIMER_OLDER_THAN(p_ctx->next_timeout, timestamp))
+        {
+            break;
+        }
+        else if (TIMER_OLDER_THAN(p_ctx->params.timeout, timestamp))
+        {
+            /* Remove first, in case a crazy user tries to reschedule it in the callback. */
+            (void) remove_context(index);
+            notify_with_model_args(p_ctx, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+            continue;
+        }
+
+        uint32_t status = message_send(p_ctx);
+        if (NRF_SUCCESS == status)
+        {
+            p_ctx->next_timeout += p_ctx->interval;
+            p_ctx->interval *= ACCESS_RELIABLE_BACK_OFF_FACTOR;
+            p_ctx->retry_count = 0;
+            if (TIMER_OLDER_THAN(p_ctx->next_timeout, timestamp))
+            {
+                /* Don't send the same message twice in one go if the timer fired late. */
+                p_ctx->next_timeout = timestamp;
+            }
+        }
+        else if (NRF_ERROR_NO_MEM == status)
+        {
+            /* If there is no more memory available, we might as well hold off the rest until this
+             * one can be retried. Transfers that keep failing back off further. */
+            p_ctx->next_timeout += (ACCESS_RELIABLE_RETRY_DELAY << p_ctx->retry_count);
+            if (p_ctx->retry_count < ACCESS_RELIABLE_RETRY_BACK_OFF_MAX)
+            {
+                p_ctx->retry_count++;
+            }
+            retry_index = index;
+            m_reliable.retry_index = index;
+        }
+        else
+        {
+            /* This should have been caught by the first publish() call. */
+            NRF_MESH_ASSERT(false);
+        }
+
+        if (TIMER_OLDER_THAN(p_ctx->params.timeout, p_ctx->next_timeout))
+        {
+            /* Shift timeout forward. */
+            p_ctx->next_timeout = p_ctx->params.timeout;
+        }
+        heap_sift_down(p_ctx->heap_index);
+
+        if (retry_index != ACCESS_RELIABLE_INDEX_INVALID)
+        {
+            break;
+        }
+    }
+
+    /* Setting the interval > 0 will reschedule the timer. */
+    if (m_reliable.active_count > 0)
+    {
+        uint16_t next_index = (retry_index != ACCESS_RELIABLE_INDEX_INVALID) ? retry_index : m_reliable.heap[0];
+        timestamp -= ACCESS_RELIABLE_TIMEOUT_MARGIN;
+        m_reliable.timer.interval = TIMER_DIFF(m_reliable.pool[next_index].next_timeout, timestamp);
+    }
+    else
+    {
+        m_reliable.timer.interval = 0;
+    }
+}
+
+static uint32_t reliable_publish(const access_reliable_t * p_reliable,
+                                 access_reliable_transaction_cb_t transaction_cb,
+                                 dsm_handle_t dst_handle,
+                                 uint16_t dst)
+{
+    uint32_t status;
+    uint16_t index;
+
+    if (ACCESS_MODEL_COUNT <= p_reliable->model_handle)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    else if (ACCESS_RELIABLE_TIMEOUT_MIN > p_reliable->timeout  ||
+             ACCESS_RELIABLE_TIMEOUT_MAX < p_reliable->timeout)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    /* Only one reliable message per model. Transactions are keyed by destination and reply opcode. */
+    else if (!available_context_get(p_reliable->model_handle,
+                                    dst,
+                                    (transaction_cb == NULL) ? NULL : &p_reliable->reply_opcode,
+                                    &index,
+                                    &status))
+    {
+        return status;
+    }
+    else
+    {
+        access_reliable_ctx_t ctx;
+        ctx.params = *p_reliable;
+        ctx.dst_handle = dst_handle;
+        status = message_send(&ctx);
+        if (NRF_SUCCESS == status || NRF_ERROR_NO_MEM == status)
+        {
+            /** @todo If we get @c NRF_ERROR_NO_MEM, we could be even "smarter" and retry in @ref
+             * ACCESS_RELIABLE_RETRY_DELAY scaled based on advertising intervals or something.
+             * Ref.: MBTLE-1542. */
+            add_reliable_message(index, p_reliable, transaction_cb, dst_handle, dst);
+            return NRF_SUCCESS;
+        }
+        else
+        {
+            return status;
+        }
     }
 }
 
@@ -302,14 +562,12 @@ void access_reliable_message_rx_cb(access_model_handle_t model_handle, const acc
 {
     NRF_MESH_ASSERT(ACCESS_MODEL_COUNT > model_handle);
     bearer_event_critical_section_begin();
-    uint16_t index;
-    if (find_index(model_handle, &index) &&
-        m_reliable.pool[index].params.reply_opcode.opcode == p_message->opcode.opcode &&
-        m_reliable.pool[index].params.reply_opcode.company_id == p_message->opcode.company_id)
+    uint16_t index = find_reply_index(model_handle, p_message);
+    if (index != ACCESS_RELIABLE_INDEX_INVALID)
     {
         /* Remove first, in case a crazy user tries to reschedule it in the callback. */
         remove_and_reschedule(index);
-        m_reliable.pool[index].params.status_cb(model_handle, p_args, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+        notify(&m_reliable.pool[index], p_args, ACCESS_RELIABLE_TRANSFER_SUCCESS);
     }
 
     bearer_event_critical_section_end();
@@ -317,14 +575,7 @@ void access_reliable_message_rx_cb(access_model_handle_t model_handle, const acc
 
 bool access_reliable_model_is_free(access_model_handle_t model_handle)
 {
-    for (uint32_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
-    {
-        if (m_reliable.pool[i].in_use && m_reliable.pool[i].params.model_handle == model_handle)
-        {
-            return false;
-        }
-    }
-    return true;
+    return (model_handle >= ACCESS_MODEL_COUNT || m_reliable.model_active_count[model_handle] == 0);
 }
 
 /* ******************* Public API ******************* */
@@ -333,6 +584,16 @@ void access_reliable_init(void)
 {
     memset(&m_reliable, 0, sizeof(m_reliable));
     m_reliable.timer.cb = reliable_timer_cb;
+    for (uint16_t i = 0; i < ACCESS_RELIABLE_BUCKET_COUNT; ++i)
+    {
+        m_reliable.buckets[i] = ACCESS_RELIABLE_INDEX_INVALID;
+    }
+    for (uint16_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT; ++i)
+    {
+        m_reliable.pool[i].next = (i + 1 < ACCESS_RELIABLE_TRANSFER_COUNT) ? i + 1 : ACCESS_RELIABLE_INDEX_INVALID;
+    }
+    m_reliable.free_head = 0;
+    m_reliable.retry_index = ACCESS_RELIABLE_INDEX_INVALID;
 }
 
 void access_reliable_cancel_all(void)
@@ -340,7 +601,6 @@ void access_reliable_cancel_all(void)
     bearer_event_critical_section_begin();
     if (m_reliable.active_count > 0)
     {
-        m_reliable.active_count = 0;
         timer_sch_abort(&m_reliable.timer);
     }
 
@@ -349,15 +609,11 @@ void access_reliable_cancel_all(void)
     {
         if (m_reliable.pool[i].in_use)
         {
-            access_model_handle_t model_handle = m_reliable.pool[i].params.model_handle;
-            access_reliable_cb_t status_cb = m_reliable.pool[i].params.status_cb;
-
-            memset(&m_reliable.pool[i], 0, sizeof(access_reliable_ctx_t));
+            access_reliable_ctx_t ctx = m_reliable.pool[i];
+            (void) remove_context(i);
 
             /* Notify model */
-            void * p_args;
-            NRF_MESH_ERROR_CHECK(access_model_p_args_get(model_handle, &p_args));
-            status_cb(model_handle, p_args, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+            notify_with_model_args(&ctx, ACCESS_RELIABLE_TRANSFER_CANCELLED);
         }
     }
 
@@ -372,22 +628,18 @@ uint32_t access_model_reliable_cancel(access_model_handle_t model_handle)
     }
     else
     {
-        uint32_t status;
-        uint16_t index;
-        void * p_args;
+        uint32_t status = NRF_ERROR_NOT_FOUND;
         bearer_event_critical_section_begin();
-        if (find_index(model_handle, &index))
+        for (uint16_t i = 0; i < ACCESS_RELIABLE_TRANSFER_COUNT && m_reliable.model_active_count[model_handle] > 0; ++i)
         {
-            status = NRF_SUCCESS;
-            remove_and_reschedule(index);
+            if (m_reliable.pool[i].in_use && m_reliable.pool[i].params.model_handle == model_handle)
+            {
+                status = NRF_SUCCESS;
+                remove_and_reschedule(i);
 
-            /* Notify model */
-            NRF_MESH_ERROR_CHECK(access_model_p_args_get(model_handle, &p_args));
-            m_reliable.pool[index].params.status_cb(model_handle, p_args, ACCESS_RELIABLE_TRANSFER_CANCELLED);
-        }
-        else
-        {
-            status = NRF_ERROR_NOT_FOUND;
+                /* Notify model */
+                notify_with_model_args(&m_reliable.pool[i], ACCESS_RELIABLE_TRANSFER_CANCELLED);
+            }
         }
 
         bearer_event_critical_section_end();
@@ -395,42 +647,64 @@ uint32_t access_model_reliable_cancel(access_model_handle_t model_handle)
     }
 }
 
-uint32_t access_model_reliable_publish(const access_reliable_t * p_reliable)
+uint32_t access_model_reliable_transaction_cancel(access_model_handle_t model_handle,
+                                                  uint16_t dst,
+                                                  access_opcode_t reply_opcode)
 {
-    uint32_t status;
-    uint16_t index;
+    if (ACCESS_MODEL_COUNT <= model_handle || dst == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
 
+    uint32_t status = NRF_ERROR_NOT_FOUND;
+    bearer_event_critical_section_begin();
+    uint16_t index = find_index(model_handle, dst, &reply_opcode);
+    if (index != ACCESS_RELIABLE_INDEX_INVALID)
+    {
+        status = NRF_SUCCESS;
+        remove_and_reschedule(index);
+        notify_with_model_args(&m_reliable.pool[index], ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    }
+    bearer_event_critical_section_end();
+    return status;
+}
+
+uint32_t access_model_reliable_publish(const access_reliable_t * p_reliable)
+{
     if (NULL == p_reliable || NULL == p_reliable->status_cb)
     {
         return NRF_ERROR_NULL;
     }
-    else if (ACCESS_MODEL_COUNT <= p_reliable->model_handle)
+    else
     {
-        return NRF_ERROR_NOT_FOUND;
+        return reliable_publish(p_reliable, NULL, DSM_HANDLE_INVALID, NRF_MESH_ADDR_UNASSIGNED);
     }
-    else if (ACCESS_RELIABLE_TIMEOUT_MIN > p_reliable->timeout  ||
-             ACCESS_RELIABLE_TIMEOUT_MAX < p_reliable->timeout)
+}
+
+uint32_t access_model_reliable_transaction_publish(const access_reliable_transaction_t * p_transaction)
+{
+    if (NULL == p_transaction || NULL == p_transaction->status_cb)
     {
-        return NRF_ERROR_INVALID_PARAM;
+        return NRF_ERROR_NULL;
     }
-    else if (!available_context_get(p_reliable, &index, &status))
+
+    nrf_mesh_address_t dst;
+    if (dsm_address_get(p_transaction->address_handle, &dst) != NRF_SUCCESS)
     {
-        return status;
+        return NRF_ERROR_NOT_FOUND;
     }
-    else
+    else if (dst.value == NRF_MESH_ADDR_UNASSIGNED)
     {
-        status = access_model_publish(p_reliable->model_handle, &p_reliable->message);
-        if (NRF_SUCCESS == status || NRF_ERROR_NO_MEM == status)
-        {
-            /** @todo If we get @c NRF_ERROR_NO_MEM, we could be even "smarter" and retry in @ref
-             * ACCESS_RELIABLE_RETRY_DELAY scaled based on advertising intervals or something.
-             * Ref.: MBTLE-1542. */
-            add_reliable_message(index, p_reliable);
-            return NRF_SUCCESS;
-        }
-        else
-        {
-            return status;
-        }
+        return NRF_ERROR_INVALID_ADDR;
     }
+
+    const access_reliable_t reliable =
+    {
+        .model_handle = p_transaction->model_handle,
+        .message = p_transaction->message,
+        .reply_opcode = p_transaction->reply_opcode,
+        .timeout = p_transaction->timeout,
+        .status_cb = NULL
+    };
+    return reliable_publish(&reliable, p_transaction->status_cb, p_transaction->address_handle, dst.value);
 }
@@ -1571,6 +1571,7 @@ void dsm_clear(void)
 void dsm_init(void)
 {
     m_mesh_evt_handler.evt_cb = mesh_evt_handler;
+    m_mesh_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_NET_BEACON_RECEIVED);
     nrf_mesh_evt_handler_add(&m_mesh_evt_handler);
 
 #if PERSISTENT_STORAGE
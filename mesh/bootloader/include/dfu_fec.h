@@ -0,0 +1,100 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_FEC_H__
+#define DFU_FEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dfu_types_mesh.h"
+
+/**
+ * Forward error correction for DFU data segments.
+ *
+ * The data segments of a transfer are split into blocks of consecutive segments. For each block,
+ * the source may send repair segments, each of which is a linear combination of all the data
+ * segments in the block over GF(2^8). The coefficients form a Cauchy matrix, so any set of repair
+ * segments can recover the same number of lost data segments in the block.
+ *
+ * Data segment i of a block and repair segment j are combined with the coefficient
+ * 1 / ((0x80 | j) ^ i), using the field polynomial x^8 + x^4 + x^3 + x^2 + 1. Segments that are
+ * shorter than @ref SEGMENT_LENGTH are padded with 0xFF.
+ */
+
+/** Largest number of data segments in a block. */
+#define DFU_FEC_BLOCK_SIZE_MAX      (128)
+/** Largest number of repair segments for a block. */
+#define DFU_FEC_REPAIR_COUNT_MAX    (128)
+
+/**
+ * Add a data segment to a repair segment.
+ *
+ * Creating a repair segment from all the data segments of its block encodes it. Adding all the
+ * received data segments to a received repair segment leaves the combination of the lost ones.
+ *
+ * @param[in,out] p_repair Repair segment to add the data segment to.
+ * @param[in] p_segment Data segment to add.
+ * @param[in] repair_index Index of the repair segment, less than @ref DFU_FEC_REPAIR_COUNT_MAX.
+ * @param[in] segment_index Index of the data segment in its block, less than
+ *                          @ref DFU_FEC_BLOCK_SIZE_MAX.
+ */
+void dfu_fec_accumulate(uint8_t* p_repair,
+                        const uint8_t* p_segment,
+                        uint8_t repair_index,
+                        uint8_t segment_index);
+
+/**
+ * Recover lost data segments from repair segments the received data segments have been
+ * added to with @ref dfu_fec_accumulate.
+ *
+ * @param[in] count Number of lost data segments, and of repair segments to recover them with. At
+ *                  most @ref DFU_FEC_REPAIR_MAX.
+ * @param[in] p_repair_indices Indices of the repair segments.
+ * @param[in] p_segment_indices Block indices of the lost data segments.
+ * @param[in,out] p_segments The repair segments, replaced by the lost data segments in the
+ *                           order of @p p_segment_indices.
+ *
+ * @retval true The lost segments were recovered.
+ * @retval false The count is too high, or the indices repeat, and the segments can't be
+ *               recovered.
+ */
+bool dfu_fec_solve(uint32_t count,
+                   const uint8_t* p_repair_indices,
+                   const uint8_t* p_segment_indices,
+                   uint8_t (*p_segments)[SEGMENT_LENGTH]);
+
+#endif /* DFU_FEC_H__ */
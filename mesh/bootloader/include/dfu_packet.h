@@ -51,6 +51,12 @@
 #define DFU_PACKET_LEN_DATA         (DFU_PACKET_LEN_OVERHEAD + sizeof(dfu_packet_data_t))
 #define DFU_PACKET_LEN_DATA_REQ     (DFU_PACKET_LEN_OVERHEAD + sizeof(dfu_packet_data_req_t))
 #define DFU_PACKET_LEN_DATA_RSP     (DFU_PACKET_LEN_OVERHEAD + sizeof(dfu_packet_data_rsp_t))
+#define DFU_PACKET_LEN_DATA_REPAIR  (DFU_PACKET_LEN_OVERHEAD + sizeof(dfu_packet_data_repair_t))
+
+/** Longest missing segment bitmap a data request can carry, in bytes. */
+#define DFU_DATA_REQ_BITMAP_LEN_MAX     (SEGMENT_LENGTH)
+/** Length of a data request carrying a missing segment bitmap of the given length. */
+#define DFU_PACKET_LEN_DATA_REQ_WINDOW(bitmap_len) (DFU_PACKET_LEN_DATA_REQ + (bitmap_len))
 
 #define DFU_PACKET_ADV_OVERHEAD     (1 /* adv_type */ + 2 /* UUID */) /* overhead inside adv data */
 #define DFU_PACKET_OVERHEAD         (MESH_PACKET_BLE_OVERHEAD + 1 + DFU_PACKET_ADV_OVERHEAD) /* dfu packet total overhead */
@@ -58,6 +64,7 @@
 /** Packet types for DFU. */
 typedef enum
 {
+    DFU_PACKET_TYPE_DATA_REPAIR = 0xFFF8,
     DFU_PACKET_TYPE_DATA_RSP    = 0xFFFA,
     DFU_PACKET_TYPE_DATA_REQ    = 0xFFFB,
     DFU_PACKET_TYPE_DATA        = 0xFFFC,
@@ -108,6 +115,18 @@ typedef struct __attribute((packed))
     uint32_t transaction_id;
 } dfu_packet_data_req_t;
 
+/** DFU data request packet payload with a bitmap of additional missing segments.
+ *
+ * Shares its packet type with the plain data request, and is told apart by its length. Bit n
+ * (LSB first) of the bitmap is set if segment (segment + 1 + n) is missing too. Nodes that don't
+ * know about the bitmap only serve the first segment. */
+typedef struct __attribute((packed))
+{
+    uint16_t segment;
+    uint32_t transaction_id;
+    uint8_t missing[DFU_DATA_REQ_BITMAP_LEN_MAX];
+} dfu_packet_data_req_window_t;
+
 /** DFU data response packet payload */
 typedef struct __attribute((packed))
 {
@@ -116,18 +135,33 @@ typedef struct __attribute((packed))
     uint8_t data[SEGMENT_LENGTH];
 } dfu_packet_data_rsp_t;
 
+/** DFU data repair packet payload, see dfu_fec.h.
+ *
+ * Block n of a transfer covers the data segments from (n * block_size + 1) to
+ * ((n + 1) * block_size), excluding the signature segments. */
+typedef struct __attribute((packed))
+{
+    uint16_t block;
+    uint32_t transaction_id;
+    uint8_t block_size;
+    uint8_t index;
+    uint8_t data[SEGMENT_LENGTH];
+} dfu_packet_data_repair_t;
+
 /** DFU radio packet format */
 typedef struct __attribute((packed))
 {
     uint16_t packet_type;
     union __attribute((packed))
     {
-        fwid_t                fwid;
-        dfu_packet_state_t    state;
-        dfu_packet_start_t    start;
-        dfu_packet_data_t     data;
-        dfu_packet_data_req_t req_data;
-        dfu_packet_data_rsp_t rsp_data;
+        fwid_t                       fwid;
+        dfu_packet_state_t           state;
+        dfu_packet_start_t           start;
+        dfu_packet_data_t            data;
+        dfu_packet_data_req_t        req_data;
+        dfu_packet_data_req_window_t req_window;
+        dfu_packet_data_rsp_t        rsp_data;
+        dfu_packet_data_repair_t     repair;
     } payload;
 } dfu_packet_t;
 
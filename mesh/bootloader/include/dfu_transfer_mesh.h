@@ -58,6 +58,46 @@ bool dfu_transfer_get_oldest_missing_entry(
         uint32_t** pp_entry,
         uint32_t* p_len);
 
+/**
+* Get a bitmap of the missing segments following a given segment.
+*
+* @param[in] first_segment Segment the bitmap is relative to. Bit n (LSB first) represents segment
+*                          first_segment + 1 + n.
+* @param[in] last_segment  Last segment to consider, later segments are left out of the bitmap.
+* @param[out] p_bitmap     Bitmap to fill.
+* @param[in] bitmap_len    Length of the bitmap in bytes.
+*
+* @return The number of missing segments flagged in the bitmap.
+*/
+uint32_t dfu_transfer_missing_bitmap_get(
+        uint16_t first_segment,
+        uint16_t last_segment,
+        uint8_t* p_bitmap,
+        uint32_t bitmap_len);
+
+/** Returns true if a segment is being written to the bank, and the next one has to wait. */
+bool dfu_transfer_is_busy(void);
+
+/**
+* Hash the bank as the transfer is received.
+*
+* Segments are added to the hash context as soon as they and all segments before them are written
+* to flash, so that @ref dfu_transfer_sha256 only has to hash the parts that arrived out of order.
+*
+* @param[in,out] p_hash_context Initialized hash context to add the bank to. Must stay valid until
+*                               @ref dfu_transfer_sha256 is called with it.
+*/
+void dfu_transfer_sha256_stream(sha256_context_t* p_hash_context);
+
+/**
+* Add the transferred data to a hash. If the context was passed to @ref dfu_transfer_sha256_stream,
+* only the part of the data that hasn't already been hashed is added.
+*
+* @param[in,out] p_hash_context Hash context to add the data to.
+*
+* @retval NRF_SUCCESS The data was added to the hash.
+* @retval NRF_ERROR_INVALID_STATE No transfer is in progress.
+*/
 uint32_t dfu_transfer_sha256(sha256_context_t* p_hash_context);
 
 void dfu_transfer_end(void);
@@ -87,6 +87,32 @@
 
 #define SEGMENT_LENGTH              (16)
 
+/** Number of segments behind the newest received segment that are tracked as missing. A segment
+ * that falls out of this window before it is recovered aborts the transfer. Must be a multiple
+ * of 32. */
+#ifndef DFU_TRANSFER_MISSING_WINDOW
+#define DFU_TRANSFER_MISSING_WINDOW (256)
+#endif
+
+/** Number of segments following the oldest missing segment that can be requested in a single data
+ * request. Must be a multiple of 8, and at most 8 * SEGMENT_LENGTH. Set to 0 to only request one
+ * segment at a time. */
+#ifndef DFU_DATA_REQ_WINDOW
+#define DFU_DATA_REQ_WINDOW         (64)
+#endif
+
+/** Number of repair segments per forward error correction block that a target keeps. A block
+ * with up to this many lost data segments is recovered locally, without data requests. Set to 0
+ * to ignore repair segments. */
+#ifndef DFU_FEC_REPAIR_MAX
+#define DFU_FEC_REPAIR_MAX          (4)
+#endif
+
+/** Number of forward error correction blocks a target keeps repair segments for. */
+#ifndef DFU_FEC_BLOCK_CACHE_SIZE
+#define DFU_FEC_BLOCK_CACHE_SIZE    (2)
+#endif
+
 #define DFU_AUTHORITY_MAX           (0x07)
 
 #define DFU_FWID_LEN_APP            (10)
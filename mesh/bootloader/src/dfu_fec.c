@@ -0,0 +1,205 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_fec.h"
+
+/*****************************************************************************
+* Local defines
+*****************************************************************************/
+/** x^8 + x^4 + x^3 + x^2 + 1, with 2 as generator. */
+#define GF_POLYNOMIAL       (0x11D)
+#define GF_ORDER            (255)
+#define REPAIR_INDEX_BASE   (0x80)
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+/** Powers of the generator, doubled to avoid reducing the sum of two logarithms. */
+static uint8_t m_gf_exp[2 * GF_ORDER];
+static uint8_t m_gf_log[GF_ORDER + 1];
+static bool m_gf_initialized;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static void gf_init(void)
+{
+    uint32_t x = 1;
+    for (uint32_t i = 0; i < GF_ORDER; ++i)
+    {
+        m_gf_exp[i] = (uint8_t) x;
+        m_gf_exp[i + GF_ORDER] = (uint8_t) x;
+        m_gf_log[x] = (uint8_t) i;
+        x <<= 1;
+        if (x & 0x100)
+        {
+            x ^= GF_POLYNOMIAL;
+        }
+    }
+    m_gf_initialized = true;
+}
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0)
+    {
+        return 0;
+    }
+    return m_gf_exp[m_gf_log[a] + m_gf_log[b]];
+}
+
+static inline uint8_t gf_inv(uint8_t a)
+{
+    return m_gf_exp[GF_ORDER - m_gf_log[a]];
+}
+
+static inline uint8_t coefficient(uint8_t repair_index, uint8_t segment_index)
+{
+    /* The two index ranges don't overlap, so the sum is never 0. */
+    return gf_inv((REPAIR_INDEX_BASE | repair_index) ^ segment_index);
+}
+
+static void swap(uint8_t* p_a, uint8_t* p_b, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        uint8_t tmp = p_a[i];
+        p_a[i] = p_b[i];
+        p_b[i] = tmp;
+    }
+}
+
+/** p_dst += c * p_src */
+static void segment_mul_add(uint8_t* p_dst, const uint8_t* p_src, uint8_t c)
+{
+    if (c == 0)
+    {
+        return;
+    }
+    uint32_t log_c = m_gf_log[c];
+    for (uint32_t i = 0; i < SEGMENT_LENGTH; ++i)
+    {
+        if (p_src[i] != 0)
+        {
+            p_dst[i] ^= m_gf_exp[m_gf_log[p_src[i]] + log_c];
+        }
+    }
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void dfu_fec_accumulate(uint8_t* p_repair,
+                        const uint8_t* p_segment,
+                        uint8_t repair_index,
+                        uint8_t segment_index)
+{
+    if (!m_gf_initialized)
+    {
+        gf_init();
+    }
+    segment_mul_add(p_repair, p_segment, coefficient(repair_index, segment_index));
+}
+
+bool dfu_fec_solve(uint32_t count,
+                   const uint8_t* p_repair_indices,
+                   const uint8_t* p_segment_indices,
+                   uint8_t (*p_segments)[SEGMENT_LENGTH])
+{
+    if (count > DFU_FEC_REPAIR_MAX)
+    {
+        return false;
+    }
+    if (!m_gf_initialized)
+    {
+        gf_init();
+    }
+
+    /* Row r: the coefficients repair segment r applies to each of the lost data segments. */
+    uint8_t matrix[DFU_FEC_REPAIR_MAX][DFU_FEC_REPAIR_MAX];
+    for (uint32_t r = 0; r < count; ++r)
+    {
+        for (uint32_t c = 0; c < count; ++c)
+        {
+            matrix[r][c] = coefficient(p_repair_indices[r], p_segment_indices[c]);
+        }
+    }
+
+    /* Gauss-Jordan elimination, applying the same row operations to the segments. */
+    for (uint32_t col = 0; col < count; ++col)
+    {
+        uint32_t pivot = col;
+        while (pivot < count && matrix[pivot][col] == 0)
+        {
+            pivot++;
+        }
+        if (pivot == count)
+        {
+            return false;
+        }
+        if (pivot != col)
+        {
+            swap(matrix[pivot], matrix[col], count);
+            swap(p_segments[pivot], p_segments[col], SEGMENT_LENGTH);
+        }
+
+        uint8_t scale = gf_inv(matrix[col][col]);
+        for (uint32_t c = col; c < count; ++c)
+        {
+            matrix[col][c] = gf_mul(matrix[col][c], scale);
+        }
+        for (uint32_t i = 0; i < SEGMENT_LENGTH; ++i)
+        {
+            p_segments[col][i] = gf_mul(p_segments[col][i], scale);
+        }
+
+        for (uint32_t r = 0; r < count; ++r)
+        {
+            uint8_t factor = matrix[r][col];
+            if (r == col || factor == 0)
+            {
+                continue;
+            }
+            for (uint32_t c = col; c < count; ++c)
+            {
+                matrix[r][c] ^= gf_mul(matrix[col][c], factor);
+            }
+            segment_mul_add(p_segments[r], p_segments[col], factor);
+        }
+    }
+    return true;
+}
@@ -38,6 +38,7 @@
 #include "dfu_mesh.h"
 #include "sha256.h"
 #include "dfu_transfer_mesh.h"
+#include "dfu_fec.h"
 #include "dfu_types_mesh.h"
 #include "uECC.h"
 #include "bootloader_info.h"
@@ -80,6 +81,11 @@
 #define REQ_RX_COUNT_RETRY              (8)
 
 #define DATA_REQ_SEGMENT_NONE           (0)
+#define DATA_REQ_BITMAP_LEN             (DFU_DATA_REQ_WINDOW / 8)
+
+#if (DFU_DATA_REQ_WINDOW % 8) != 0 || DATA_REQ_BITMAP_LEN > DFU_DATA_REQ_BITMAP_LEN_MAX
+#error DFU_DATA_REQ_WINDOW must be a multiple of 8, and at most 8 * DFU_DATA_REQ_BITMAP_LEN_MAX
+#endif
 
 /*****************************************************************************
 * Local typedefs
@@ -107,9 +113,11 @@ typedef struct
     uint8_t         signature_bitmap;
     uint16_t        segments_remaining;
     uint16_t        segment_count;
+    uint16_t        segment_newest;
     fwid_union_t    target_fwid_union;
     bool            segment_is_valid_after_transfer;
     bool            flood;
+    bool            hash_streaming;
 } transaction_t;
 
 typedef struct
@@ -131,16 +139,33 @@ typedef struct
     uint16_t segment;
     uint16_t rx_count;
 } req_cache_entry_t;
+
+#if DFU_FEC_REPAIR_MAX > 0
+/** Repair segments received for a forward error correction block. */
+typedef struct
+{
+    uint16_t block;
+    uint8_t  block_size; /**< 0 if the entry is free. */
+    uint8_t  count;
+    uint8_t  indices[DFU_FEC_REPAIR_MAX];
+    uint8_t  data[DFU_FEC_REPAIR_MAX][SEGMENT_LENGTH];
+} fec_block_t;
+#endif
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
 static transaction_t            m_transaction;
 static dfu_state_t              m_state = DFU_STATE_FIND_FWID;
 static bl_info_pointers_t       m_bl_info_pointers;
+static sha256_context_t         m_hash_context;
 static req_cache_entry_t        m_req_cache[REQ_CACHE_SIZE];
 static uint8_t                  m_req_index;
 static uint8_t                  m_tx_slots;
 static uint16_t                 m_data_req_segment;
+#if DFU_FEC_REPAIR_MAX > 0
+static fec_block_t              m_fec_blocks[DFU_FEC_BLOCK_CACHE_SIZE];
+static uint8_t                  m_fec_block_index;
+#endif
 
 #ifdef RTT_LOG
 static const char*              m_state_strs[] =
@@ -299,6 +324,35 @@ static uint32_t packet_tx_dynamic(dfu_packet_t* p_packet,
     return status;
 }
 
+/** Start hashing the signed data, and let the transfer module add the bank to it as it's received. */
+static void signature_hash_start(void)
+{
+    sha256_init(&m_hash_context);
+    sha256_update(&m_hash_context, (uint8_t*) &m_transaction.type, 1);
+    sha256_update(&m_hash_context, (uint8_t*) &m_transaction.p_indicated_start_addr, 4);
+    sha256_update(&m_hash_context, (uint8_t*) &m_transaction.length, 4);
+    uint8_t padding = 0;
+    sha256_update(&m_hash_context, &padding, 1);
+
+    switch (m_transaction.type)
+    {
+        case DFU_TYPE_APP:
+            sha256_update(&m_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_APP);
+            break;
+        case DFU_TYPE_SD:
+            sha256_update(&m_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_SD);
+            break;
+        case DFU_TYPE_BOOTLOADER:
+            sha256_update(&m_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_BL);
+            break;
+        default:
+            break;
+    }
+
+    dfu_transfer_sha256_stream(&m_hash_context);
+    m_transaction.hash_streaming = true;
+}
+
 static bool signature_check(void)
 {
     __LOG("Verifying signature... ");
@@ -316,35 +370,17 @@ static bool signature_check(void)
         return false;
     }
 
-    uint8_t hash[uECC_BYTES];
-    sha256_context_t hash_context;
-    sha256_init(&hash_context);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.type, 1);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.p_indicated_start_addr, 4);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.length, 4);
-    uint8_t padding = 0;
-    sha256_update(&hash_context, &padding, 1);
-
-    switch (m_transaction.type)
+    if (!m_transaction.hash_streaming)
     {
-        case DFU_TYPE_APP:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_APP);
-            break;
-        case DFU_TYPE_SD:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_SD);
-            break;
-        case DFU_TYPE_BOOTLOADER:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_BL);
-            break;
-        default:
-            break;
+        signature_hash_start();
     }
-
-    dfu_transfer_sha256(&hash_context);
+    uint8_t hash[uECC_BYTES];
+    dfu_transfer_sha256(&m_hash_context);
+    m_transaction.hash_streaming = false;
 #if NORDIC_SDK_VERSION >= 11
-    sha256_final(&hash_context, hash, false);
+    sha256_final(&m_hash_context, hash, false);
 #else
-    sha256_final(&hash_context, hash);
+    sha256_final(&m_hash_context, hash);
 #endif
     bool success = (bool) (uECC_verify(m_bl_info_pointers.p_ecdsa_public_key, hash, m_transaction.signature));
 
@@ -636,6 +672,12 @@ static void start_target(void)
                 m_transaction.length,
                 m_transaction.segment_is_valid_after_transfer) == NRF_SUCCESS)
     {
+        if (m_bl_info_pointers.p_ecdsa_public_key != NULL && m_transaction.signature_length > 0)
+        {
+            /* Hash the image as it comes in, instead of all at once after the transfer. */
+            signature_hash_start();
+        }
+
         bl_evt_t abort_evt;
         abort_evt.type = BL_EVT_TYPE_TX_ABORT;
         abort_evt.params.tx.abort.tx_slot = TX_SLOT_BEACON;
@@ -679,7 +721,7 @@ static uint32_t notify_state_packet(dfu_packet_t* p_packet)
 }
 
 /* check whether we've lost any entries, and request them */
-static void request_missing_data(uint16_t prev_segment)
+static void request_missing_data(uint16_t newest_segment)
 {
     uint32_t* p_req_entry = NULL;
     uint32_t req_entry_len = 0;
@@ -690,8 +732,8 @@ static void request_missing_data(uint16_t prev_segment)
                 &req_entry_len) &&
             (
              /* don't request the previous packet yet */
-             ADDR_SEGMENT(p_req_entry, m_transaction.p_start_addr) < prev_segment - 1 ||
-             m_transaction.segment_count == prev_segment
+             ADDR_SEGMENT(p_req_entry, m_transaction.p_start_addr) < newest_segment - 1 ||
+             m_transaction.segment_count == newest_segment
             )
        )
     {
@@ -699,12 +741,30 @@ static void request_missing_data(uint16_t prev_segment)
         req_packet.packet_type = DFU_PACKET_TYPE_DATA_REQ;
         req_packet.payload.req_data.segment = ADDR_SEGMENT(p_req_entry, m_transaction.p_start_addr);
         req_packet.payload.req_data.transaction_id = m_transaction.transaction_id;
+        uint16_t length = DFU_PACKET_LEN_DATA_REQ;
+
+#if DFU_DATA_REQ_WINDOW > 0
+        /* Flag the other missing segments in the same request, so that every gap doesn't cost a
+         * separate round trip. The same rule as for the first segment applies to the last one. */
+        uint16_t last_segment = newest_segment - 2;
+        if (m_transaction.segment_count == newest_segment)
+        {
+            last_segment = m_transaction.segment_count - m_transaction.signature_length / SEGMENT_LENGTH;
+        }
+        if (dfu_transfer_missing_bitmap_get(req_packet.payload.req_window.segment,
+                                            last_segment,
+                                            req_packet.payload.req_window.missing,
+                                            DATA_REQ_BITMAP_LEN) > 0)
+        {
+            length = DFU_PACKET_LEN_DATA_REQ_WINDOW(DATA_REQ_BITMAP_LEN);
+        }
+#endif
 
         /* Use beacon slot */
         bl_evt_t tx_evt;
         tx_evt.type = BL_EVT_TYPE_TX_RADIO;
         tx_evt.params.tx.radio.p_dfu_packet = &req_packet;
-        tx_evt.params.tx.radio.length = DFU_PACKET_LEN_DATA_REQ;
+        tx_evt.params.tx.radio.length = length;
         tx_evt.params.tx.radio.interval_type = TX_INTERVAL_TYPE_REQ;
         tx_evt.params.tx.radio.tx_count = TX_REPEATS_REQ;
         tx_evt.params.tx.radio.tx_slot = TX_SLOT_BEACON;
@@ -713,7 +773,7 @@ static void request_missing_data(uint16_t prev_segment)
         {
             m_transaction.p_last_requested_entry = (uint32_t*) p_req_entry;
             m_data_req_segment = req_packet.payload.req_data.segment;
-            __LOG("TX REQ FOR 0x%x\n", m_data_req_segment);
+            __LOG("TX REQ FOR 0x%x (%u bytes)\n", m_data_req_segment, length);
         }
     }
 }
@@ -747,16 +807,21 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
 
     m_transaction.segments_remaining                = segment_count;
     m_transaction.segment_count                     = segment_count;
+    m_transaction.segment_newest                    = 0;
     m_transaction.p_start_addr                      = (uint32_t*) start_address;
     m_transaction.length                            = p_packet->payload.start.length * 4;
     m_transaction.signature_length                  = p_packet->payload.start.signature_length;
     m_transaction.segment_is_valid_after_transfer   = p_packet->payload.start.last;
     m_transaction.p_last_requested_entry            = NULL;
     m_transaction.signature_bitmap                  = 0;
+    m_transaction.hash_streaming                    = false;
 
     /* Reset all transfer specific caches. */
     memset(m_req_cache, 0, REQ_CACHE_SIZE * sizeof(m_req_cache[0]));
     packet_cache_flush();
+#if DFU_FEC_REPAIR_MAX > 0
+    memset(m_fec_blocks, 0, sizeof(m_fec_blocks));
+#endif
 
     /* If no bank was specified, we either have to do it single-banked or find a bank */
     if (m_transaction.p_bank_addr == (uint32_t*) 0xFFFFFFFF)
@@ -875,9 +940,16 @@ static uint32_t target_rx_data(dfu_packet_t* p_packet, uint16_t length, bool* p_
     send_progress_event(p_packet->payload.data.segment, m_transaction.segment_count);
     m_transaction.segments_remaining--;
     *p_do_relay = true;
+    if (p_packet->payload.data.segment > m_transaction.segment_newest)
+    {
+        m_transaction.segment_newest = p_packet->payload.data.segment;
+    }
+    /* Compare against the newest segment rather than the one we just got, so that receiving a
+     * requested segment lets us request the next gap right away, also at the end of the
+     * transfer, where no new data will trigger it. */
     if (m_data_req_segment == DATA_REQ_SEGMENT_NONE)
     {
-        request_missing_data(p_packet->payload.data.segment);
+        request_missing_data(m_transaction.segment_newest);
     }
     return error_code;
 }
@@ -1101,10 +1173,69 @@ static uint32_t handle_fwid_packet(dfu_packet_t* p_packet)
     return status;
 }
 
-static uint32_t handle_data_req_packet(dfu_packet_t* p_packet)
+/* Respond to a request for a single segment, unless we've served it recently. */
+static uint32_t data_req_serve(uint16_t segment, uint32_t transaction_id, bool* p_served)
+{
+    *p_served = false;
+    req_cache_entry_t* p_req_entry = NULL;
+    /* check that we haven't served this request recently. */
+    for (uint32_t i = 0; i < REQ_CACHE_SIZE; ++i)
+    {
+        if (m_req_cache[i].segment == segment)
+        {
+            if (m_req_cache[i].rx_count++ < REQ_RX_COUNT_RETRY)
+            {
+                return NRF_SUCCESS;
+            }
+            p_req_entry = &m_req_cache[i];
+            break;
+        }
+    }
+    /* serve request */
+    uint32_t status;
+    dfu_packet_t dfu_rsp;
+    if (
+        dfu_transfer_has_entry(
+            (uint32_t*) SEGMENT_ADDR(segment, m_transaction.p_start_addr),
+            dfu_rsp.payload.rsp_data.data, SEGMENT_LENGTH)
+       )
+    {
+        dfu_rsp.packet_type = DFU_PACKET_TYPE_DATA_RSP;
+        dfu_rsp.payload.rsp_data.segment = segment;
+        dfu_rsp.payload.rsp_data.transaction_id = transaction_id;
+
+        status = packet_tx_dynamic(&dfu_rsp, DFU_PACKET_LEN_DATA_RSP, TX_INTERVAL_TYPE_RSP, TX_REPEATS_RSP);
+    }
+    else
+    {
+        status = NRF_ERROR_NOT_FOUND;
+    }
+
+    /* log our attempt at responding */
+    if (status == NRF_SUCCESS)
+    {
+        if (!p_req_entry)
+        {
+            p_req_entry = &m_req_cache[(m_req_index++) & (REQ_CACHE_SIZE - 1)];
+            p_req_entry->segment = segment;
+        }
+        *p_served = true;
+    }
+    if (p_req_entry)
+    {
+        p_req_entry->rx_count = 0;
+    }
+    return status;
+}
+
+static uint32_t handle_data_req_packet(dfu_packet_t* p_packet, uint16_t length)
 {
     uint32_t status;
-    if (p_packet->payload.data.transaction_id == m_transaction.transaction_id)
+    if (length < DFU_PACKET_LEN_DATA_REQ)
+    {
+        status = NRF_ERROR_INVALID_LENGTH;
+    }
+    else if (p_packet->payload.data.transaction_id == m_transaction.transaction_id)
     {
         __LOG("RX data REQ #%u\n", p_packet->payload.data.segment);
         if (m_state == DFU_STATE_RELAY)
@@ -1116,51 +1247,40 @@ static uint32_t handle_data_req_packet(dfu_packet_t* p_packet)
             }
             else
             {
-                status = relay_packet(p_packet, 8);
+                status = relay_packet(p_packet, length);
             }
         }
         else /* In transfer */
         {
-            req_cache_entry_t* p_req_entry = NULL;
-            /* check that we haven't served this request recently. */
-            for (uint32_t i = 0; i < REQ_CACHE_SIZE; ++i)
+            bool served;
+            status = data_req_serve(p_packet->payload.req_window.segment,
+                                    p_packet->payload.req_window.transaction_id,
+                                    &served);
+
+            /* Serve the other missing segments flagged in a windowed request, using at most one
+             * response per dynamic TX slot, so that we don't overwrite our own responses. */
+            uint32_t bitmap_len = length - DFU_PACKET_LEN_DATA_REQ;
+            if (bitmap_len > DFU_DATA_REQ_BITMAP_LEN_MAX)
+            {
+                bitmap_len = DFU_DATA_REQ_BITMAP_LEN_MAX;
+            }
+            uint32_t rsp_count = (served ? 1 : 0);
+            for (uint32_t i = 0; i < bitmap_len * 8 && rsp_count < (uint32_t) m_tx_slots - 1; ++i)
             {
-                if (m_req_cache[i].segment == p_packet->payload.req_data.segment)
+                if (p_packet->payload.req_window.missing[i / 8] & (1 << (i & 7)))
                 {
-                    if (m_req_cache[i].rx_count++ < REQ_RX_COUNT_RETRY)
+                    uint32_t segment = p_packet->payload.req_window.segment + 1 + i;
+                    if (segment > m_transaction.segment_count)
                     {
-                        return NRF_SUCCESS;
+                        break;
                     }
-                    p_req_entry = &m_req_cache[i];
-                    break;
+                    if (data_req_serve(segment, p_packet->payload.req_window.transaction_id, &served) == NRF_SUCCESS)
+                    {
+                        status = NRF_SUCCESS;
+                    }
+                    rsp_count += (served ? 1 : 0);
                 }
             }
-            /* serve request */
-            dfu_packet_t dfu_rsp;
-            if (
-                dfu_transfer_has_entry(
-                    (uint32_t*) SEGMENT_ADDR(p_packet->payload.req_data.segment, m_transaction.p_start_addr),
-                    dfu_rsp.payload.rsp_data.data, SEGMENT_LENGTH)
-               )
-            {
-                dfu_rsp.packet_type = DFU_PACKET_TYPE_DATA_RSP;
-                dfu_rsp.payload.rsp_data.segment = p_packet->payload.req_data.segment;
-                dfu_rsp.payload.rsp_data.transaction_id = p_packet->payload.req_data.transaction_id;
-
-                status = packet_tx_dynamic(&dfu_rsp, DFU_PACKET_LEN_DATA_RSP, TX_INTERVAL_TYPE_RSP, TX_REPEATS_RSP);
-            }
-            else
-            {
-                status = NRF_ERROR_NOT_FOUND;
-            }
-
-            /* log our attempt at responding */
-            if (status == NRF_SUCCESS && !p_req_entry)
-            {
-                p_req_entry = &m_req_cache[(m_req_index++) & (REQ_CACHE_SIZE - 1)];
-                p_req_entry->segment = p_packet->payload.req_data.segment;
-            }
-            p_req_entry->rx_count = 0;
         }
     }
     else
@@ -1194,6 +1314,208 @@ static uint32_t handle_data_rsp_packet(dfu_packet_t* p_packet, uint16_t length)
     return status;
 }
 
+static uint16_t data_segment_count(void)
+{
+    return m_transaction.segment_count - m_transaction.signature_length / SEGMENT_LENGTH;
+}
+
+#if DFU_FEC_REPAIR_MAX > 0
+/** Length of a data segment, only the first and last segments can be short. */
+static uint16_t data_segment_length(uint16_t segment)
+{
+    uint32_t start = (uint32_t) m_transaction.p_start_addr;
+    uint32_t addr = SEGMENT_ADDR(segment, start);
+    uint32_t end = (addr & ~((uint32_t) SEGMENT_LENGTH - 1)) + SEGMENT_LENGTH;
+    if (end > start + m_transaction.length)
+    {
+        end = start + m_transaction.length;
+    }
+    return end - addr;
+}
+
+/**
+ * Find the data segments of a block that we don't have.
+ *
+ * @returns The number of missing segments, or (max + 1) if there are more than max.
+ */
+static uint32_t fec_missing_get(const fec_block_t* p_block, uint8_t* p_indices, uint32_t max)
+{
+    uint16_t first = p_block->block * p_block->block_size + 1;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < p_block->block_size && first + i <= data_segment_count(); ++i)
+    {
+        if (!dfu_transfer_has_entry(addr_from_seg(first + i, m_transaction.p_start_addr), NULL, 0))
+        {
+            if (count == max)
+            {
+                return max + 1;
+            }
+            p_indices[count++] = i;
+        }
+    }
+    return count;
+}
+
+/**
+ * Recover a missing data segment from the stored repair segments, if there are enough of them for
+ * its block. Only one segment can be written at a time, the next is recovered when the write is
+ * done.
+ */
+static void fec_recover(void)
+{
+    if (dfu_transfer_is_busy())
+    {
+        return;
+    }
+
+    for (uint32_t b = 0; b < DFU_FEC_BLOCK_CACHE_SIZE; ++b)
+    {
+        fec_block_t* p_block = &m_fec_blocks[b];
+        if (p_block->block_size == 0)
+        {
+            continue;
+        }
+        uint8_t missing[DFU_FEC_REPAIR_MAX];
+        uint32_t missing_count = fec_missing_get(p_block, missing, DFU_FEC_REPAIR_MAX);
+        if (missing_count == 0)
+        {
+            p_block->block_size = 0;
+            continue;
+        }
+        if (missing_count > p_block->count)
+        {
+            continue;
+        }
+
+        /* Remove the segments we have from the repair segments, leaving the missing ones. */
+        uint8_t segments[DFU_FEC_REPAIR_MAX][SEGMENT_LENGTH];
+        memcpy(segments, p_block->data, missing_count * SEGMENT_LENGTH);
+        uint16_t first = p_block->block * p_block->block_size + 1;
+        for (uint32_t i = 0, m = 0; i < p_block->block_size && first + i <= data_segment_count(); ++i)
+        {
+            if (m < missing_count && missing[m] == i)
+            {
+                m++;
+                continue;
+            }
+            uint8_t segment_data[SEGMENT_LENGTH];
+            memset(segment_data, 0xFF, SEGMENT_LENGTH);
+            dfu_transfer_has_entry(addr_from_seg(first + i, m_transaction.p_start_addr),
+                                   segment_data,
+                                   data_segment_length(first + i));
+            for (uint32_t r = 0; r < missing_count; ++r)
+            {
+                dfu_fec_accumulate(segments[r], segment_data, p_block->indices[r], i);
+            }
+        }
+
+        if (!dfu_fec_solve(missing_count, p_block->indices, missing, segments))
+        {
+            p_block->block_size = 0;
+            continue;
+        }
+
+        dfu_packet_t data_packet;
+        data_packet.packet_type = DFU_PACKET_TYPE_DATA;
+        data_packet.payload.data.segment = first + missing[0];
+        data_packet.payload.data.transaction_id = m_transaction.transaction_id;
+        memcpy(data_packet.payload.data.data, segments[0], SEGMENT_LENGTH);
+        uint16_t length = DFU_PACKET_LEN_DATA - SEGMENT_LENGTH + data_segment_length(first + missing[0]);
+
+        __LOG("FEC: Recovered segment 0x%x\n", data_packet.payload.data.segment);
+        bool do_relay = false;
+        if (target_rx_data(&data_packet, length, &do_relay) == NRF_SUCCESS &&
+            m_transaction.segments_remaining == 0)
+        {
+            start_rampdown();
+        }
+        return;
+    }
+}
+
+static void target_rx_repair(dfu_packet_t* p_packet)
+{
+    uint16_t block = p_packet->payload.repair.block;
+    uint8_t block_size = p_packet->payload.repair.block_size;
+    uint8_t index = p_packet->payload.repair.index;
+
+    fec_block_t* p_block = NULL;
+    for (uint32_t i = 0; i < DFU_FEC_BLOCK_CACHE_SIZE; ++i)
+    {
+        if (m_fec_blocks[i].block_size == block_size && m_fec_blocks[i].block == block)
+        {
+            p_block = &m_fec_blocks[i];
+            break;
+        }
+    }
+
+    if (p_block == NULL)
+    {
+        fec_block_t candidate = {.block = block, .block_size = block_size};
+        uint8_t missing[DFU_FEC_REPAIR_MAX];
+        if (fec_missing_get(&candidate, missing, DFU_FEC_REPAIR_MAX) == 0)
+        {
+            /* Nothing to repair. */
+            return;
+        }
+        p_block = &m_fec_blocks[m_fec_block_index];
+        m_fec_block_index = (m_fec_block_index + 1) % DFU_FEC_BLOCK_CACHE_SIZE;
+        *p_block = candidate;
+    }
+
+    if (p_block->count < DFU_FEC_REPAIR_MAX)
+    {
+        for (uint32_t i = 0; i < p_block->count; ++i)
+        {
+            if (p_block->indices[i] == index)
+            {
+                return;
+            }
+        }
+        p_block->indices[p_block->count] = index;
+        memcpy(p_block->data[p_block->count], p_packet->payload.repair.data, SEGMENT_LENGTH);
+        p_block->count++;
+        fec_recover();
+    }
+}
+#endif /* DFU_FEC_REPAIR_MAX > 0 */
+
+static uint32_t handle_data_repair_packet(dfu_packet_t* p_packet, uint16_t length)
+{
+    if (length < DFU_PACKET_LEN_DATA_REPAIR ||
+        p_packet->payload.repair.transaction_id != m_transaction.transaction_id)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    if (packet_in_cache(p_packet))
+    {
+        return NRF_SUCCESS;
+    }
+
+    switch (m_state)
+    {
+        case DFU_STATE_TARGET:
+            if (p_packet->payload.repair.block_size == 0 ||
+                p_packet->payload.repair.block_size > DFU_FEC_BLOCK_SIZE_MAX ||
+                p_packet->payload.repair.index >= DFU_FEC_REPAIR_COUNT_MAX ||
+                (uint32_t) p_packet->payload.repair.block * p_packet->payload.repair.block_size >=
+                    data_segment_count())
+            {
+                return NRF_ERROR_INVALID_DATA;
+            }
+#if DFU_FEC_REPAIR_MAX > 0
+            target_rx_repair(p_packet);
+#endif
+            break;
+        case DFU_STATE_RELAY:
+            break;
+        default:
+            return NRF_ERROR_INVALID_STATE;
+    }
+
+    return relay_packet(p_packet, length);
+}
+
 /*****************************************************************************
 * Interface Functions
 *****************************************************************************/
@@ -1314,13 +1636,17 @@ uint32_t dfu_mesh_rx(dfu_packet_t* p_packet, uint16_t length, bool from_serial)
             break;
 
         case DFU_PACKET_TYPE_DATA_REQ:
-            status = handle_data_req_packet(p_packet);
+            status = handle_data_req_packet(p_packet, length);
             break;
 
         case DFU_PACKET_TYPE_DATA_RSP:
             status = handle_data_rsp_packet(p_packet, length);
             break;
 
+        case DFU_PACKET_TYPE_DATA_REPAIR:
+            status = handle_data_repair_packet(p_packet, length);
+            break;
+
         default:
             /* don't care */
             status = NRF_ERROR_INVALID_DATA;
@@ -1534,4 +1860,11 @@ void dfu_mesh_on_flash_idle(void)
             dfu_mesh_start();
         }
     }
+#if DFU_FEC_REPAIR_MAX > 0
+    else if (m_state == DFU_STATE_TARGET)
+    {
+        /* The bank is up to date, continue recovering segments. */
+        fec_recover();
+    }
+#endif
 }
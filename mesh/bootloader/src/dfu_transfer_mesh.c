@@ -50,13 +50,20 @@
 * Local defines
 *****************************************************************************/
 #define INVALID_SEGMENT_INDEX   (0xFFFF)
-#define MISSING_BITFIELD_WIDTH  (64ULL)
+#define MISSING_BITFIELD_WIDTH  (DFU_TRANSFER_MISSING_WINDOW)
+#define MISSING_BITFIELD_WORDS  (MISSING_BITFIELD_WIDTH / 32)
+
+#if (MISSING_BITFIELD_WIDTH == 0) || (MISSING_BITFIELD_WIDTH % 32) != 0
+#error DFU_TRANSFER_MISSING_WINDOW must be a non-zero multiple of 32
+#endif
 
 /*****************************************************************************
 * Local typedefs
 *****************************************************************************/
 
-typedef uint64_t bitfield_t;
+/** Ring of missing segment flags, indexed by segment number modulo the window width. Only the
+ * segments in the window ending at segment_max are valid. */
+typedef uint32_t bitfield_t[MISSING_BITFIELD_WORDS];
 
 typedef struct
 {
@@ -69,6 +76,8 @@ typedef struct
     uint8_t         write_buffer[SEGMENT_LENGTH];
     uint16_t        segment_max;
     uint16_t        segment_prev;
+    sha256_context_t* p_hash_context; /**< Context to stream the bank into, or NULL. */
+    uint32_t        hashed_size;      /**< Length of the bank prefix added to the hash. */
 } dfu_transfer_t;
 
 /*****************************************************************************
@@ -86,17 +95,68 @@ static void transfer_abort(dfu_end_t end_reason)
     send_end_evt(end_reason);
 }
 
+static inline bool missing_bit_get(uint16_t segment)
+{
+    uint32_t index = segment % MISSING_BITFIELD_WIDTH;
+    return !!(m_transfer.missing_segments[index / 32] & (1UL << (index & 31)));
+}
+
+static inline void missing_bit_set(uint16_t segment, bool missing)
+{
+    uint32_t index = segment % MISSING_BITFIELD_WIDTH;
+    if (missing)
+    {
+        m_transfer.missing_segments[index / 32] |= (1UL << (index & 31));
+    }
+    else
+    {
+        m_transfer.missing_segments[index / 32] &= ~(1UL << (index & 31));
+    }
+}
+
 static bool segment_is_missing(uint16_t segment)
 {
     if (segment > m_transfer.segment_max)
     {
         return true;
     }
-    if (m_transfer.segment_max - segment > MISSING_BITFIELD_WIDTH)
+    if (m_transfer.segment_max - segment >= MISSING_BITFIELD_WIDTH)
     {
         return false;
     }
-    return !!((1ULL << (m_transfer.segment_max - segment)) & m_transfer.missing_segments);
+    return missing_bit_get(segment);
+}
+
+/** Add the segments following the hashed prefix of the bank to the hash, until the first segment
+ * that isn't in flash yet. */
+static void hash_catch_up(void)
+{
+    if (m_transfer.p_hash_context == NULL)
+    {
+        return;
+    }
+    /* The transfer starts on a page boundary, so all segments are full, except the last. */
+    uint32_t end = m_transfer.hashed_size;
+    while (end < m_transfer.size)
+    {
+        uint16_t segment = end / SEGMENT_LENGTH + 1;
+        if (segment_is_missing(segment) || segment == m_transfer.segment_prev)
+        {
+            break;
+        }
+        end += SEGMENT_LENGTH;
+    }
+    if (end > m_transfer.size)
+    {
+        end = m_transfer.size;
+    }
+    if (end > m_transfer.hashed_size)
+    {
+        sha256_update(m_transfer.p_hash_context,
+                      (uint8_t*) m_transfer.p_bank_addr + m_transfer.hashed_size,
+                      end - m_transfer.hashed_size);
+        m_transfer.hashed_size = end;
+    }
 }
 
 /*****************************************************************************
@@ -140,7 +200,7 @@ uint32_t dfu_transfer_start(
     m_transfer.segment_count = segment_count;
     m_transfer.final_transfer = final_transfer;
     m_transfer.size = size;
-    m_transfer.missing_segments = 0;
+    memset(m_transfer.missing_segments, 0, sizeof(m_transfer.missing_segments));
     m_transfer.segment_prev = INVALID_SEGMENT_INDEX;
     m_transfer.segment_max = 0;
     return NRF_SUCCESS;
@@ -177,27 +237,30 @@ uint32_t dfu_transfer_data(uint32_t p_addr, uint8_t* p_data, uint16_t length)
 
     if (segment > m_transfer.segment_max)
     {
-        /* Ensure that we don't shift out any set bits: Mask the shift on the
-         * MSB side (ie only look at the part that will overflow), and check
-         * whether there are any bits set in that section. */
+        /* All segments we skipped are considered missing. Their ring entries hold the segments
+         * that are about to fall out of the window, and if any of those are still missing, we
+         * can no longer recover them. */
         uint16_t segment_offset = segment - m_transfer.segment_max;
-        bitfield_t shift_mask = (1ULL << segment_offset) - 1ULL;
-        if (m_transfer.missing_segments & (shift_mask << (MISSING_BITFIELD_WIDTH - segment_offset)))
+        if (segment_offset > MISSING_BITFIELD_WIDTH)
         {
             transfer_abort(DFU_END_ERROR_PACKET_LOSS);
             return NRF_ERROR_NOT_FOUND;
         }
-        /* Offset the bitfield to match the new segment_max, and set all bits
-         * that we skipped to 1, as they're considered missing. */
-        m_transfer.missing_segments = (m_transfer.missing_segments << segment_offset) | shift_mask;
-        m_transfer.missing_segments &= ~1ULL; /* The newest segment isn't missing. */
+        for (uint16_t i = m_transfer.segment_max + 1; i <= segment; ++i)
+        {
+            if (missing_bit_get(i))
+            {
+                transfer_abort(DFU_END_ERROR_PACKET_LOSS);
+                return NRF_ERROR_NOT_FOUND;
+            }
+        }
+        for (uint16_t i = m_transfer.segment_max + 1; i < segment; ++i)
+        {
+            missing_bit_set(i, true);
+        }
         m_transfer.segment_max = segment;
     }
-    else
-    {
-        uint16_t segment_offset = m_transfer.segment_max - segment;
-        m_transfer.missing_segments &= ~(1 << segment_offset);
-    }
+    missing_bit_set(segment, false);
 
     m_transfer.segment_prev = segment;
     memcpy(m_transfer.write_buffer, p_data, length);
@@ -245,11 +308,16 @@ bool dfu_transfer_get_oldest_missing_entry(
     {
         return false;
     }
-    for (int32_t i = 63; i >= 0; i--)
+    for (int32_t i = MISSING_BITFIELD_WIDTH - 1; i >= 0; i--)
     {
-        if (m_transfer.missing_segments & (1ULL << i))
+        if (i >= m_transfer.segment_max)
+        {
+            /* Segment numbers start at 1. */
+            continue;
+        }
+        uint16_t segment = m_transfer.segment_max - i;
+        if (missing_bit_get(segment))
         {
-            uint16_t segment = m_transfer.segment_max - i;
             uint32_t addr = SEGMENT_ADDR(segment, m_transfer.p_start_addr);
             if (addr >= (uint32_t) p_start_addr)
             {
@@ -262,15 +330,63 @@ bool dfu_transfer_get_oldest_missing_entry(
     return false;
 }
 
+uint32_t dfu_transfer_missing_bitmap_get(
+        uint16_t first_segment,
+        uint16_t last_segment,
+        uint8_t* p_bitmap,
+        uint32_t bitmap_len)
+{
+    memset(p_bitmap, 0, bitmap_len);
+    if (m_transfer.segment_max == INVALID_SEGMENT_INDEX)
+    {
+        return 0;
+    }
+
+    uint32_t missing_count = 0;
+    for (uint32_t i = 0; i < bitmap_len * 8; ++i)
+    {
+        uint32_t segment = first_segment + 1 + i;
+        if (segment > last_segment)
+        {
+            break;
+        }
+        if (segment_is_missing(segment))
+        {
+            p_bitmap[i / 8] |= (1 << (i & 7));
+            missing_count++;
+        }
+    }
+    return missing_count;
+}
+
+bool dfu_transfer_is_busy(void)
+{
+    return (m_transfer.segment_prev != INVALID_SEGMENT_INDEX);
+}
+
+void dfu_transfer_sha256_stream(sha256_context_t* p_hash_context)
+{
+    m_transfer.p_hash_context = p_hash_context;
+    m_transfer.hashed_size = 0;
+    hash_catch_up();
+}
+
 uint32_t dfu_transfer_sha256(sha256_context_t* p_hash_context)
 {
     if (m_transfer.segment_max == INVALID_SEGMENT_INDEX)
     {
         return NRF_ERROR_INVALID_STATE;
     }
+    uint32_t offset = 0;
+    if (p_hash_context == m_transfer.p_hash_context)
+    {
+        /* Everything is in flash by now, only the parts that arrived out of order remain. */
+        offset = m_transfer.hashed_size;
+        m_transfer.p_hash_context = NULL;
+    }
     return sha256_update(p_hash_context,
-                  (uint8_t*) m_transfer.p_bank_addr,
-                  m_transfer.size);
+                  (uint8_t*) m_transfer.p_bank_addr + offset,
+                  m_transfer.size - offset);
 }
 
 void dfu_transfer_end(void)
@@ -283,6 +399,7 @@ void dfu_transfer_flash_write_complete(uint8_t* p_write_src)
     if (p_write_src == m_transfer.write_buffer)
     {
         m_transfer.segment_prev = INVALID_SEGMENT_INDEX;
+        hash_catch_up();
     }
 }
 
@@ -62,6 +62,7 @@ typedef struct
 {
     dfu_packet_type_t   type;
     uint16_t            segment;
+    uint8_t             index; /**< Repair segment index, 0 for other packets. */
 } packet_cache_entry_t;
 
 
@@ -76,6 +77,10 @@ static uint32_t                 m_packet_cache_index;
 /*****************************************************************************
 * Static functions
 *****************************************************************************/
+static inline uint8_t packet_cache_index(dfu_packet_t* p_packet)
+{
+    return (p_packet->packet_type == DFU_PACKET_TYPE_DATA_REPAIR) ? p_packet->payload.repair.index : 0;
+}
 
 /*****************************************************************************
 * Interface functions
@@ -254,7 +259,8 @@ bool packet_in_cache(dfu_packet_t* p_packet)
     for (uint32_t i = 0; i < PACKET_CACHE_SIZE; ++i)
     {
         if (m_packet_cache[i].type    == p_packet->packet_type &&
-            m_packet_cache[i].segment == p_packet->payload.data.segment)
+            m_packet_cache[i].segment == p_packet->payload.data.segment &&
+            m_packet_cache[i].index   == packet_cache_index(p_packet))
         {
             return true;
         }
@@ -266,6 +272,7 @@ void packet_cache_put(dfu_packet_t* p_packet)
 {
     m_packet_cache[(m_packet_cache_index) & (PACKET_CACHE_SIZE - 1)].type = (dfu_packet_type_t) p_packet->packet_type;
     m_packet_cache[(m_packet_cache_index) & (PACKET_CACHE_SIZE - 1)].segment = p_packet->payload.data.segment;
+    m_packet_cache[(m_packet_cache_index) & (PACKET_CACHE_SIZE - 1)].index = packet_cache_index(p_packet);
     m_packet_cache_index++;
 }
 
@@ -70,6 +70,15 @@
 #define NRF_MESH_UECC_ENABLE 1
 #endif
 
+/**
+ * Define to "1" to use the P-256 implementation with precomputed tables in ecc_p256.c for the
+ * provisioning key generation and ECDH, instead of uECC. Key generation is about four times faster,
+ * at the cost of about 2 kB of flash for the tables.
+ */
+#ifndef NRF_MESH_ECC_P256_ENABLE
+#define NRF_MESH_ECC_P256_ENABLE 0
+#endif
+
 /**
  * Switch on the time slotted flash manager as the back end subsystem.
  */
@@ -139,6 +148,17 @@
 #define CORE_TX_REPEAT_RELAY_DEFAULT 1
 #endif
 
+/**
+ * Number of network PDUs that can be shared by reference between the Core TX bearers.
+ *
+ * Bearers that support sending by reference (e.g. GATT proxy connections) hold on to a shared
+ * PDU until they are done with it. When all shared PDUs are in use, packets are copied to the
+ * bearers instead. The GATT proxy lets each connection hold an equal share of the pool.
+ */
+#ifndef CORE_TX_SHARED_PDU_COUNT
+#define CORE_TX_SHARED_PDU_COUNT 8
+#endif
+
 /** @} end of MESH_CONFIG_CORE_TX */
 
 /**
@@ -189,6 +209,22 @@
 
 /** @} end of MESH_CONFIG_INTERNAL */
 
+/**
+ * @defgroup MESH_CONFIG_EVENT Mesh event dispatch configuration
+ * @{
+ */
+
+/**
+ * Number of handler slots in the per-event-type dispatch index. A handler takes one slot for each
+ * event type it subscribes to. If the subscriptions don't fit, events are dispatched by walking
+ * all registered handlers instead.
+ */
+#ifndef EVENT_HANDLER_INDEX_SIZE
+#define EVENT_HANDLER_INDEX_SIZE 64
+#endif
+
+/** @} end of MESH_CONFIG_EVENT */
+
 /**
  * @defgroup MESH_CONFIG_LOG Log module configuration
  * @{
@@ -223,8 +259,103 @@
 #endif
 #endif
 
+/**
+ * Enable the deferred logging backend, @ref log_callback_deferred(). Log calls are stored as
+ * binary records in a RAM buffer, and formatted on the host by scripts/deferred_log/decode.py.
+ */
+#ifndef LOG_DEFERRED_ENABLE
+#define LOG_DEFERRED_ENABLE 0
+#endif
+
+/** Size of the deferred log buffer in bytes. Must be a power of two. */
+#ifndef LOG_DEFERRED_BUFFER_SIZE
+#define LOG_DEFERRED_BUFFER_SIZE 2048
+#endif
+
+/** Maximum number of argument bytes stored in a single deferred log record. */
+#ifndef LOG_DEFERRED_ARGS_SIZE_MAX
+#define LOG_DEFERRED_ARGS_SIZE_MAX 64
+#endif
+
 /** @} end of MESH_CONFIG_LOG */
 
+/**
+ * @defgroup MESH_CONFIG_INSTR Instrumentation configuration
+ * @{
+ */
+
+/** Enable timing of the packet processing stages, see @ref INSTR. */
+#ifndef INSTR_ENABLE
+#define INSTR_ENABLE 0
+#endif
+
+/**
+ * Number of logarithmic buckets in each instrumentation histogram. The last bucket holds all
+ * durations of 2^(INSTR_HISTOGRAM_BUCKET_COUNT - 1) or more.
+ */
+#ifndef INSTR_HISTOGRAM_BUCKET_COUNT
+#define INSTR_HISTOGRAM_BUCKET_COUNT 24
+#endif
+
+/** @} end of MESH_CONFIG_INSTR */
+
+/**
+ * @defgroup MESH_CONFIG_PACKET_TRACE Packet trace configuration
+ * @{
+ */
+
+/** Enable the recording of received scanner packets, see @ref PACKET_TRACE. */
+#ifndef PACKET_TRACE_ENABLE
+#define PACKET_TRACE_ENABLE 0
+#endif
+
+/** Size of the packet trace buffer in bytes. Must be a power of two. */
+#ifndef PACKET_TRACE_BUFFER_SIZE
+#define PACKET_TRACE_BUFFER_SIZE 1024
+#endif
+
+/** RTT up channel to write the packet trace to with @c packet_trace_flush_rtt(). */
+#ifndef PACKET_TRACE_RTT_CHANNEL
+#define PACKET_TRACE_RTT_CHANNEL 1
+#endif
+
+/** Size of the RTT up buffer for the packet trace. */
+#ifndef PACKET_TRACE_RTT_BUFFER_SIZE
+#define PACKET_TRACE_RTT_BUFFER_SIZE 512
+#endif
+
+/** @} end of MESH_CONFIG_PACKET_TRACE */
+
+/**
+ * @defgroup MESH_CONFIG_HEARTBEAT_COLLECTOR Heartbeat collector configuration
+ * @{
+ */
+
+/** Enable the collection of heartbeats from all sources, see @ref HEARTBEAT_COLLECTOR. */
+#ifndef HEARTBEAT_COLLECTOR_ENABLE
+#define HEARTBEAT_COLLECTOR_ENABLE 0
+#endif
+
+/** Number of heartbeat sources tracked by the collector. The least recently heard source is
+ * evicted when a new source is heard and the table is full. */
+#ifndef HEARTBEAT_COLLECTOR_ENTRIES
+#define HEARTBEAT_COLLECTOR_ENTRIES 64
+#endif
+
+/** @} end of MESH_CONFIG_HEARTBEAT_COLLECTOR */
+
+/**
+ * @defgroup MESH_CONFIG_STATS Statistics configuration
+ * @{
+ */
+
+/** Enable the statistics counters of the stack, see @ref MESH_STATS. */
+#ifndef MESH_STATS_ENABLE
+#define MESH_STATS_ENABLE 0
+#endif
+
+/** @} end of MESH_CONFIG_STATS */
+
 /**
  * @defgroup MESH_CONFIG_MSG_CACHE Message cache configuration
  * @{
@@ -291,6 +422,54 @@
 #define NET_FLASH_PAGE_COUNT 1
 #endif
 
+/**
+ * Number of authenticated secure network beacons to cache. Received beacons that match an entry
+ * in the cache are accepted without recalculating their CMAC. When the cache is full, the oldest
+ * entry is replaced.
+ */
+#ifndef NET_BEACON_CACHE_SIZE
+#define NET_BEACON_CACHE_SIZE (8)
+#endif
+
+/**
+ * Number of relayed packets that can wait out the random back-off of the counter-based relay
+ * policy at the same time. Packets that arrive when all are in use are relayed immediately.
+ */
+#ifndef RELAY_POLICY_PENDING_COUNT
+#define RELAY_POLICY_PENDING_COUNT (4)
+#endif
+
+/** Number of neighbours the density-adaptive relay policy can keep track of. */
+#ifndef RELAY_POLICY_NEIGHBOUR_COUNT
+#define RELAY_POLICY_NEIGHBOUR_COUNT (32)
+#endif
+
+/** Time in milliseconds after which a silent neighbour no longer counts towards the density. */
+#ifndef RELAY_POLICY_NEIGHBOUR_TIMEOUT_MS
+#define RELAY_POLICY_NEIGHBOUR_TIMEOUT_MS (10000)
+#endif
+
+/**
+ * Number of relayed packets that can wait for room in the relay bearers. When the queue is full,
+ * a packet is dropped according to the relay queue drop policy.
+ */
+#ifndef RELAY_QUEUE_SIZE
+#define RELAY_QUEUE_SIZE (8)
+#endif
+
+/** Time in milliseconds between attempts to hand queued relayed packets to the bearers. */
+#ifndef RELAY_QUEUE_RETRY_INTERVAL_MS
+#define RELAY_QUEUE_RETRY_INTERVAL_MS (10)
+#endif
+
+/**
+ * Time in milliseconds relayed packets are held back after a locally originated packet, when
+ * locally originated packets have priority.
+ */
+#ifndef RELAY_QUEUE_ORIGINATOR_HOLDOFF_MS
+#define RELAY_QUEUE_ORIGINATOR_HOLDOFF_MS (20)
+#endif
+
 /** @} end of MESH_CONFIG_NETWORK */
 
 /**
@@ -312,6 +491,32 @@
 #define TRANSPORT_SAR_SEGACK_TTL_DEFAULT (8)
 #endif
 
+/** Number of destinations to keep round trip time estimates for, used by adaptive SAR TX retry timing. */
+#ifndef TRANSPORT_RTT_ENTRY_COUNT
+#define TRANSPORT_RTT_ENTRY_COUNT (8)
+#endif
+
+/**
+ * Enable bulk transfer of long access messages. Once turned on with @ref NRF_MESH_OPT_TRS_BULK_ENABLE,
+ * access messages that would otherwise be segmented are sent as a single unsegmented network PDU,
+ * on the bearers that can carry long packets, like the Instaburst bearer. Messages fall back to
+ * segmentation when no bearer takes the long PDU.
+ *
+ * @warning Long network PDUs are not part of the Mesh Profile Specification, and are only understood
+ * by nodes built with this option. Only turn on bulk transfer when all nodes in the network are.
+ */
+#ifndef TRANSPORT_BULK_ENABLE
+#define TRANSPORT_BULK_ENABLE 0
+#endif
+
+/**
+ * Largest upper transport PDU (access payload and 32-bit TransMIC) sent in a single bulk transfer
+ * network PDU. All network packet buffers grow to hold a PDU of this size when bulk transfer is enabled.
+ */
+#ifndef TRANSPORT_BULK_PDU_MAX_SIZE
+#define TRANSPORT_BULK_PDU_MAX_SIZE (96)
+#endif
+
 /** @} end of MESH_CONFIG_TRANSPORT */
 /**
  * @defgroup MESH_CONFIG_PACMAN Packet manager configuration
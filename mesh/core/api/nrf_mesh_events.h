@@ -98,6 +98,19 @@ typedef enum
     NRF_MESH_EVT_CONFIG_LOAD_FAILURE
 } nrf_mesh_evt_type_t;
 
+/** Number of mesh event types. */
+#define NRF_MESH_EVT_TYPE_COUNT (NRF_MESH_EVT_CONFIG_LOAD_FAILURE + 1)
+
+/**
+ * Gets the subscription mask bit for an event type, for use in @ref nrf_mesh_evt_handler_t::evt_mask.
+ *
+ * @param[in] TYPE Event type, see @ref nrf_mesh_evt_type_t.
+ */
+#define NRF_MESH_EVT_MASK(TYPE) (1UL << (TYPE))
+
+/** Subscription mask for all event types. */
+#define NRF_MESH_EVT_MASK_ALL (0)
+
 /**
  * Message received event structure.
  */
@@ -381,6 +394,12 @@ typedef struct
 {
     /** Callback function pointer. */
     nrf_mesh_evt_handler_cb_t evt_cb;
+    /**
+     * Event types to subscribe to, as a bitwise OR of @ref NRF_MESH_EVT_MASK() values. Set to
+     * @ref NRF_MESH_EVT_MASK_ALL to get all events. Read when the handler is added, must not be
+     * changed while the handler is registered.
+     */
+    uint32_t evt_mask;
     /** Node for the keeping in linked list. Set and used internally. */
     list_node_t node;
     /** To save list integrity. Set and used internally. */
@@ -390,7 +409,8 @@ typedef struct
 /**
  * Registers an event handler to get events from the core stack.
  *
- * @todo Allow masking out certain events.
+ * The handler only gets the event types set in its @c evt_mask. Events are dispatched to the
+ * handlers in the order they were registered.
  *
  * @param[in,out] p_handler_params Event handler parameters.
  */
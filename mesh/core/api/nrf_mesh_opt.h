@@ -53,6 +53,10 @@
 #define NRF_MESH_OPT_TRS_START      300
 /** Start of network layer parameters. */
 #define NRF_MESH_OPT_NET_START      400
+/** Start of instrumentation parameters. */
+#define NRF_MESH_OPT_INSTR_START    500
+/** Start of statistics parameters. */
+#define NRF_MESH_OPT_STATS_START    600
 
 /**
  * Option ID type.
@@ -80,6 +84,10 @@ typedef enum
     NRF_MESH_OPT_TRS_SAR_SEGACK_TTL,
     /** 32-bit (@ref NRF_MESH_TRANSMIC_SIZE_SMALL) or 64-bit (@ref NRF_MESH_TRANSMIC_SIZE_LARGE) MIC size for transport layer. */
     NRF_MESH_OPT_TRS_SZMIC,
+    /** Enable (1) / disable (0) SAR TX retry timeouts based on the measured round trip time to each destination. */
+    NRF_MESH_OPT_TRS_SAR_TX_RETRY_ADAPTIVE,
+    /** Enable (1) / disable (0) sending long access messages unsegmented, see @ref TRANSPORT_BULK_ENABLE. */
+    NRF_MESH_OPT_TRS_BULK_ENABLE,
     /** Packet relaying enabled (1) or disabled (0). */
     NRF_MESH_OPT_NET_RELAY_ENABLE = NRF_MESH_OPT_NET_START,
     /** Number of retransmits per relayed packet. */
@@ -93,7 +101,60 @@ typedef enum
     /** Interval between retransmitted packets originating from this device in milliseconds. */
     NRF_MESH_OPT_NET_NETWORK_TRANSMIT_INTERVAL_MS,
     /** TX power for packets originating from this device. */
-    NRF_MESH_OPT_NET_NETWORK_TX_POWER
+    NRF_MESH_OPT_NET_NETWORK_TX_POWER,
+    /** Relay policy, see @ref relay_policy_type_t. */
+    NRF_MESH_OPT_NET_RELAY_POLICY,
+    /** Number of times a packet must be heard to suppress its relay, for the counter-based relay policy. */
+    NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD,
+    /** Upper limit of the random relay back-off in milliseconds, for the counter-based relay policy. */
+    NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS,
+    /** RSSI (as a signed integer) at or above which packets aren't relayed, for the RSSI-gated relay policy. */
+    NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD,
+    /** Expected number of relaying neighbours, for the density adaptive relay policy. */
+    NRF_MESH_OPT_NET_RELAY_POLICY_DENSITY_TARGET,
+    /**
+     * Relay policy counters. Get only. The option value is a @ref relay_policy_stats_t, copied to
+     * the @c p_array buffer, which must be at least @c len bytes long. Setting the option clears
+     * the counters, the value is ignored.
+     */
+    NRF_MESH_OPT_NET_RELAY_POLICY_STATS,
+    /** Priority between relayed and locally originated packets, see @ref relay_queue_priority_t. */
+    NRF_MESH_OPT_NET_RELAY_QUEUE_PRIORITY,
+    /** Packet to drop when the relay queue is full, see @ref relay_queue_drop_t. */
+    NRF_MESH_OPT_NET_RELAY_QUEUE_DROP,
+    /** Time in milliseconds after which a queued relayed packet is dropped. */
+    NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS,
+    /**
+     * Relay queue counters. Get only. The option value is a @ref relay_queue_stats_t, copied to
+     * the @c p_array buffer, which must be at least @c len bytes long. Setting the option clears
+     * the counters, the value is ignored.
+     */
+    NRF_MESH_OPT_NET_RELAY_QUEUE_STATS,
+    /** Clear all instrumentation histograms. Set only, the value is ignored. */
+    NRF_MESH_OPT_INSTR_CLEAR = NRF_MESH_OPT_INSTR_START,
+    /**
+     * Scanner RX stage histogram. Get only. The option value is an @ref instr_histogram_t, copied
+     * to the @c p_array buffer, which must be at least @c len bytes long.
+     */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX,
+    /** Network input stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_NETWORK_IN,
+    /** Net decrypt stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_NET_DECRYPT,
+    /** Transport input stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_TRANSPORT,
+    /** Access dispatch stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_ACCESS,
+    /** Core TX send stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_CORE_TX,
+    /** Advertiser TX complete stage histogram. Get only, see @ref NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX. */
+    NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX,
+    /**
+     * Statistics counters. The option value is a @ref mesh_stats_t, copied to the @c p_array
+     * buffer, which must be at least @c len bytes long. Setting the option clears the counters,
+     * the value is ignored.
+     */
+    NRF_MESH_OPT_STATS_COUNTERS = NRF_MESH_OPT_STATS_START
 } nrf_mesh_opt_id_t;
 
 
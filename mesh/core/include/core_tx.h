@@ -47,6 +47,9 @@
  * core_tx_bearer_bitmap_t type. */
 #define CORE_TX_BEARER_COUNT_MAX 32
 
+/** Number of writable bytes in front of a shared PDU, available for bearer specific headers. */
+#define CORE_TX_PDU_HEADROOM 1
+
 /**
  * @defgroup CORE_TX Core Transmission Handler
  * @ingroup MESH_CORE
@@ -85,6 +88,32 @@ typedef struct
 /** Bitmap type representing multiple bearers. */
 typedef uint32_t core_tx_bearer_bitmap_t;
 
+/**
+ * Reference counted network PDU, shared between the bearers that send it by reference.
+ *
+ * The @c headroom bytes in front of the packet may be overwritten by the bearers, as long as every
+ * bearer writes the same value for the same PDU.
+ */
+typedef struct
+{
+    uint8_t refcount; /**< Number of holders of the PDU. Only modified by the Core TX module. */
+    uint8_t length;   /**< Length of the network PDU. */
+    uint8_t headroom[CORE_TX_PDU_HEADROOM]; /**< Scratch space for bearer headers. */
+    packet_mesh_net_packet_t packet; /**< Network PDU. */
+} core_tx_pdu_t;
+
+/** Per-bearer allocation and transmission statistics. */
+typedef struct
+{
+    uint32_t alloc_count;   /**< Number of successful allocations. */
+    uint32_t no_mem_count;  /**< Number of allocations that failed because the bearer was full. */
+    uint32_t no_pdu_count;  /**< Number of packets offered by copy because no shared PDU was available. */
+    uint32_t reject_count;  /**< Number of allocations rejected by the bearer. */
+    uint32_t discard_count; /**< Number of discarded packets. */
+    uint32_t send_count;    /**< Number of packets sent by copy. */
+    uint32_t shared_count;  /**< Number of packets given to the bearer by reference. */
+} core_tx_bearer_stats_t;
+
 /**
  * @defgroup CORE_TX_BEARER_API Core TX bearer API
  * API for the Core TX bearers to interact with the Core TX module.
@@ -140,28 +169,37 @@ typedef void (*core_tx_bearer_packet_send_t)(core_tx_bearer_t * p_bearer,
  */
 typedef void (*core_tx_bearer_packet_discard_t)(core_tx_bearer_t * p_bearer);
 
+/**
+ * Shared packet send function type for Core TX bearer interfaces.
+ *
+ * The bearer is given a reference to the PDU instead of a copy, and is expected to commit it for
+ * sending without copying the payload into its own buffer. The bearer may still copy the payload,
+ * e.g. to limit the number of references it holds. The bearer owns the reference until it calls
+ * @ref core_tx_pdu_release(), which it must do exactly once, also if the send fails.
+ *
+ * @param[in] p_bearer Bearer to send on.
+ * @param[in,out] p_pdu Shared PDU to send.
+ */
+typedef void (*core_tx_bearer_packet_send_shared_t)(core_tx_bearer_t * p_bearer,
+                                                    core_tx_pdu_t * p_pdu);
+
 /**
  * Core TX interface definition, providing packet sending functionality for a single Core TX bearer type.
+ *
+ * A bearer must implement @c packet_send. If @c packet_send_shared is also set, it is used over
+ * @c packet_send for the packets that are staged in a shared PDU, see @ref core_tx_packet_is_shared().
  */
 typedef struct
 {
     core_tx_bearer_packet_alloc_t packet_alloc;
     core_tx_bearer_packet_send_t packet_send;
     core_tx_bearer_packet_discard_t packet_discard;
+    core_tx_bearer_packet_send_shared_t packet_send_shared;
 } core_tx_bearer_interface_t;
 
 struct core_tx_bearer
 {
-#ifdef CORE_TX_DEBUG
-    struct
-    {
-        uint32_t alloc_count;
-        uint32_t no_mem_count;
-        uint32_t reject_count;
-        uint32_t discard_count;
-        uint32_t send_count;
-    } debug;
-#endif
+    core_tx_bearer_stats_t stats;
 
     const core_tx_bearer_interface_t * p_interface;
 
@@ -242,6 +280,18 @@ core_tx_bearer_type_t core_tx_bearer_type_get(uint32_t bearer_index);
  */
 uint32_t core_tx_bearer_count_get(void);
 
+/**
+ * Get the allocation and transmission statistics of a bearer.
+ *
+ * @param[in] bearer_index Bearer index to look up.
+ * @param[out] p_stats Statistics structure to copy into.
+ *
+ * @retval NRF_SUCCESS The statistics were copied.
+ * @retval NRF_ERROR_NULL @p p_stats was NULL.
+ * @retval NRF_ERROR_NOT_FOUND No bearer with the given index exists.
+ */
+uint32_t core_tx_bearer_stats_get(uint32_t bearer_index, core_tx_bearer_stats_t * p_stats);
+
 /**
  * @ingroup CORE_TX_BEARER_API
  * @{
@@ -275,6 +325,27 @@ void core_tx_complete(core_tx_bearer_t * p_bearer,
                       core_tx_role_t role,
                       uint32_t timestamp,
                       nrf_mesh_tx_token_t token);
+
+/**
+ * Check whether the packet currently being allocated is staged in a shared PDU.
+ *
+ * Bearers that implement @c packet_send_shared may call this from their @c packet_alloc function
+ * to decide how much space to reserve. If the packet is shared, @c packet_send_shared is called
+ * to send it, otherwise @c packet_send. Shared PDUs are only available while the pool isn't
+ * exhausted, see @ref CORE_TX_SHARED_PDU_COUNT.
+ *
+ * @returns Whether the packet being allocated is staged in a shared PDU.
+ */
+bool core_tx_packet_is_shared(void);
+
+/**
+ * Release a reference to a shared PDU, given to the bearer in its @c packet_send_shared function.
+ *
+ * The PDU returns to the pool once all references are released. Safe to call from any IRQ level.
+ *
+ * @param[in,out] p_pdu Shared PDU to release.
+ */
+void core_tx_pdu_release(core_tx_pdu_t * p_pdu);
 /** @} */
 
 #ifdef UNIT_TEST
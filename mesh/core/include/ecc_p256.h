@@ -0,0 +1,111 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef ECC_P256_H__
+#define ECC_P256_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup ECC_P256 P-256 elliptic curve operations
+ * @ingroup MESH_CORE
+ * Key generation and ECDH on the secp256r1 curve, as an alternative to uECC for provisioning.
+ *
+ * Key generation multiplies the fixed base point with a comb method over precomputed tables of
+ * multiples of the base point, which takes roughly a quarter of the point operations of a generic
+ * scalar multiplication. ECDH uses a fixed 4-bit window over a table of multiples of the peer's
+ * public key. Both operations run in constant time with respect to the private key: all table
+ * lookups read every entry, and the point formulas are complete, with no special cases.
+ *
+ * Keys use the same big-endian format as uECC: a public key is the X coordinate followed by the
+ * Y coordinate, and the shared secret is the X coordinate of the shared point.
+ * @{
+ */
+
+/** Length of a private key, in bytes. */
+#define ECC_P256_PRIVATE_KEY_SIZE   (32)
+/** Length of a public key, in bytes. */
+#define ECC_P256_PUBLIC_KEY_SIZE    (64)
+/** Length of a shared secret, in bytes. */
+#define ECC_P256_SHARED_SECRET_SIZE (32)
+
+/**
+ * Generates a key pair.
+ *
+ * @param[out] p_public  Public key buffer of @ref ECC_P256_PUBLIC_KEY_SIZE bytes.
+ * @param[out] p_private Private key buffer of @ref ECC_P256_PRIVATE_KEY_SIZE bytes.
+ *
+ * @retval NRF_SUCCESS The key pair was generated.
+ */
+uint32_t ecc_p256_keys_generate(uint8_t * p_public, uint8_t * p_private);
+
+/**
+ * Computes the public key of a private key.
+ *
+ * @param[in]  p_private Private key.
+ * @param[out] p_public  Public key buffer of @ref ECC_P256_PUBLIC_KEY_SIZE bytes.
+ *
+ * @retval NRF_SUCCESS The public key was computed.
+ * @retval NRF_ERROR_INVALID_PARAM The private key is 0, or not less than the curve order.
+ */
+uint32_t ecc_p256_public_key_compute(const uint8_t * p_private, uint8_t * p_public);
+
+/**
+ * Checks that a public key is a point on the curve.
+ *
+ * @param[in] p_public Public key to check.
+ *
+ * @returns Whether the public key is valid.
+ */
+bool ecc_p256_public_key_valid(const uint8_t * p_public);
+
+/**
+ * Computes an ECDH shared secret.
+ *
+ * @param[in]  p_public      The peer's public key.
+ * @param[in]  p_private     Our private key.
+ * @param[out] p_secret      Shared secret buffer of @ref ECC_P256_SHARED_SECRET_SIZE bytes.
+ *
+ * @retval NRF_SUCCESS The shared secret was computed.
+ * @retval NRF_ERROR_INVALID_PARAM The public key isn't on the curve, or the private key is out of
+ *                                 range.
+ */
+uint32_t ecc_p256_shared_secret(const uint8_t * p_public, const uint8_t * p_private, uint8_t * p_secret);
+
+/** @} */
+
+#endif /* ECC_P256_H__ */
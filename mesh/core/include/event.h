@@ -47,6 +47,20 @@
  * @{
  */
 
+/** Dispatch statistics for a single event type. */
+typedef struct
+{
+    /** Number of events of this type dispatched since the last @ref event_stats_clear(). */
+    uint32_t dispatch_count;
+    /** Number of registered handlers subscribing to this type. */
+    uint32_t handler_count;
+    /**
+     * Total time spent dispatching events of this type, in instrumentation timestamp units (see
+     * @ref INSTR). Only counted if @ref INSTR_ENABLE is set.
+     */
+    uint64_t cycles;
+} event_stats_t;
+
 /**
  * Sends an event to the application.
  *
@@ -68,6 +82,23 @@ void event_handler_add(nrf_mesh_evt_handler_t * p_handler_params);
  */
 void event_handler_remove(nrf_mesh_evt_handler_t * p_handler_params);
 
+/**
+ * Gets the dispatch statistics for an event type.
+ *
+ * @param[in]  type    Event type to get the statistics for.
+ * @param[out] p_stats Statistics structure to fill.
+ *
+ * @retval NRF_SUCCESS             The statistics were copied to @p p_stats.
+ * @retval NRF_ERROR_NULL          The statistics pointer was NULL.
+ * @retval NRF_ERROR_INVALID_PARAM The event type is out of range.
+ */
+uint32_t event_stats_get(nrf_mesh_evt_type_t type, event_stats_t * p_stats);
+
+/**
+ * Clears the dispatch counts and times of all event types.
+ */
+void event_stats_clear(void);
+
 /** @} */
 
 #endif
@@ -208,6 +208,18 @@ typedef struct
      */
     fsm_action_t             action;
 
+    /** Pointer to the state index table, or NULL.
+     *
+     *  The table holds the transition table index of each state declaration, indexed by state ID.
+     *  It is filled in by @ref fsm_init(), and may be shared between all FSMs using this
+     *  descriptor. If NULL, the transition table is searched on every state change.
+     */
+    uint8_t *                state_index_table;
+
+    /** Number of entries in the state index table. Must be larger than the highest state ID.
+     */
+    uint8_t                  states_count;
+
 #if defined FSM_DEBUG
     /** Pointer to the string with fsm name.
      */
@@ -244,6 +256,10 @@ typedef struct
      */
     uint8_t                        any_state_transitions_index;
 
+    /** Index of the current state's transitions block.
+     */
+    uint8_t                        current_state_index;
+
     /** Current state ID.
      */
     volatile fsm_state_id_t        current_state;
@@ -255,6 +271,9 @@ typedef struct
 
 
 /**@brief   Initializes specific FSM.
+ *
+ * @details If the constant descriptor has a state index table, it is built from the transition
+ *          table, making event dispatch independent of the size of the transition table.
  *
  * @param[in]   p_fsm       Pointer to FSM descriptor to initialize.
  * @param[in]   p_fsm_const Pointer to constant FSM descriptor with transition table, etc.
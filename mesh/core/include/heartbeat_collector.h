@@ -0,0 +1,162 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HEARTBEAT_COLLECTOR_H__
+#define HEARTBEAT_COLLECTOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh.h"
+#include "nrf_mesh_config_core.h"
+
+/**
+ * @defgroup HEARTBEAT_COLLECTOR Heartbeat collector
+ * @ingroup MESH_CORE
+ * Keeps a table of the heartbeats received from every source, to monitor the health of a network.
+ *
+ * The heartbeat subscription state only tracks a single source. The collector tracks every source
+ * that sends a heartbeat to this node (to a unicast address of the node, or to a group address the
+ * node is subscribed to), regardless of the subscription state. For each source it keeps the number
+ * of heartbeats received, the hop statistics, the last feature bits, the time the source was last
+ * heard and a summary of the RSSI the heartbeats were received with.
+ *
+ * The table holds @ref HEARTBEAT_COLLECTOR_ENTRIES sources, sorted by source address. When a new
+ * source is heard and the table is full, the least recently heard source is evicted.
+ *
+ * The collector is compiled out unless @ref HEARTBEAT_COLLECTOR_ENABLE is set.
+ * @{
+ */
+
+/** Weight of a new RSSI sample in the RSSI average, as a power of two: 1/2^n. */
+#define HEARTBEAT_COLLECTOR_RSSI_AVG_SHIFT (3)
+
+/** Heartbeat collector entry. */
+typedef struct
+{
+    uint16_t src;          /**< Source address of the heartbeats. */
+    uint16_t count;        /**< Number of heartbeats received, saturates at 0xFFFF. */
+    uint32_t age_s;        /**< Seconds since the last heartbeat was received. */
+    uint16_t features;     /**< Feature bits of the last heartbeat. */
+    uint8_t min_hops;      /**< Lowest number of hops a heartbeat has traveled. */
+    uint8_t max_hops;      /**< Highest number of hops a heartbeat has traveled. */
+    uint8_t last_hops;     /**< Number of hops the last heartbeat traveled. */
+    int8_t rssi_last;      /**< RSSI of the last heartbeat received over the air. */
+    int8_t rssi_min;       /**< Lowest RSSI of the heartbeats received over the air. */
+    int8_t rssi_max;       /**< Highest RSSI of the heartbeats received over the air. */
+    int8_t rssi_avg;       /**< Exponential moving average of the RSSI. */
+    uint16_t rssi_count;   /**< Number of heartbeats with an RSSI, or 0 if the RSSI fields are unset. */
+} heartbeat_collector_entry_t;
+
+/** Heartbeat collector statistics. */
+typedef struct
+{
+    uint32_t received;     /**< Number of heartbeats collected. */
+    uint32_t evicted;      /**< Number of sources evicted to make room for a new source. */
+} heartbeat_collector_stats_t;
+
+#if HEARTBEAT_COLLECTOR_ENABLE
+
+/**
+ * Initializes the heartbeat collector, and empties the table.
+ */
+void heartbeat_collector_init(void);
+
+/**
+ * Adds a received heartbeat to the table.
+ *
+ * @param[in] src           Source address of the heartbeat.
+ * @param[in] hops          Number of hops the heartbeat traveled.
+ * @param[in] features      Feature bits of the heartbeat.
+ * @param[in] p_rx_metadata Metadata of the packet the heartbeat was received in.
+ */
+void heartbeat_collector_rx(uint16_t src,
+                            uint8_t hops,
+                            uint16_t features,
+                            const nrf_mesh_rx_metadata_t * p_rx_metadata);
+
+/**
+ * Gets the number of sources in the table.
+ *
+ * @returns The number of sources in the table.
+ */
+uint16_t heartbeat_collector_count_get(void);
+
+/**
+ * Gets an entry of the table. The entries are sorted by source address.
+ *
+ * @param[in]  index   Index of the entry, lower than @ref heartbeat_collector_count_get().
+ * @param[out] p_entry Entry to fill.
+ *
+ * @retval NRF_SUCCESS               The entry was copied to @p p_entry.
+ * @retval NRF_ERROR_INVALID_PARAM   There is no entry at the given index.
+ */
+uint32_t heartbeat_collector_entry_get(uint16_t index, heartbeat_collector_entry_t * p_entry);
+
+/**
+ * Gets the entry of a source.
+ *
+ * @param[in]  src     Source address to look up.
+ * @param[out] p_entry Entry to fill.
+ *
+ * @retval NRF_SUCCESS           The entry was copied to @p p_entry.
+ * @retval NRF_ERROR_NOT_FOUND   No heartbeat has been collected from the source.
+ */
+uint32_t heartbeat_collector_lookup(uint16_t src, heartbeat_collector_entry_t * p_entry);
+
+/**
+ * Removes all entries from the table, and resets the statistics.
+ */
+void heartbeat_collector_clear(void);
+
+/**
+ * Gets the heartbeat collector statistics.
+ *
+ * @returns A pointer to the statistics structure.
+ */
+const heartbeat_collector_stats_t * heartbeat_collector_stats_get(void);
+
+#else
+
+#define heartbeat_collector_init()
+#define heartbeat_collector_rx(src, hops, features, p_rx_metadata)
+
+#endif /* HEARTBEAT_COLLECTOR_ENABLE */
+
+/** @} */
+
+#endif /* HEARTBEAT_COLLECTOR_H__ */
@@ -0,0 +1,183 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef INSTR_H__
+#define INSTR_H__
+
+#include <stdint.h>
+
+#include "nrf_mesh_config_core.h"
+#include "nrf_mesh_opt.h"
+
+#if defined(HOST)
+    #include <time.h>
+#else
+    #include "nrf.h"
+#endif
+
+/**
+ * @defgroup INSTR Hot path instrumentation
+ * @ingroup MESH_CORE
+ * Measures the time spent in the stages of the packet processing path.
+ *
+ * Each stage is timed from entry to exit, and the durations are accumulated in a histogram per
+ * stage, with logarithmic buckets. The stages nest: the scanner RX stage contains the network input
+ * stage, which contains the net decrypt and transport stages, and so on.
+ *
+ * On target, the durations are in CPU cycles, counted by the DWT cycle counter. On host, they are in
+ * nanoseconds.
+ *
+ * The instrumentation is compiled out unless @ref INSTR_ENABLE is set, leaving no overhead.
+ * @{
+ */
+
+/** Instrumented stages. */
+typedef enum
+{
+    INSTR_STAGE_SCANNER_RX,   /**< Processing of a scanner packet, from the scanner queue to release. */
+    INSTR_STAGE_NETWORK_IN,   /**< Network layer input, @c network_packet_in(). */
+    INSTR_STAGE_NET_DECRYPT,  /**< Network PDU deobfuscation and decryption. */
+    INSTR_STAGE_TRANSPORT,    /**< Transport layer input, including the access layer. */
+    INSTR_STAGE_ACCESS,       /**< Access layer message dispatch, including the model handlers. */
+    INSTR_STAGE_CORE_TX,      /**< Passing an outgoing packet to the core TX bearers. */
+    INSTR_STAGE_ADV_TX,       /**< Advertiser TX complete processing. */
+    INSTR_STAGE_COUNT         /**< Number of instrumented stages. */
+} instr_stage_t;
+
+/** Latency histogram for a single stage. */
+typedef struct
+{
+    uint32_t count; /**< Number of measurements. */
+    uint32_t max;   /**< Longest measured duration. */
+    uint64_t total; /**< Sum of all measured durations. */
+    /**
+     * Number of measurements in each bucket. Bucket @c n holds the durations in the range
+     * [2^n, 2^(n+1)), except the first one, which also holds 0, and the last one, which holds all
+     * durations above it.
+     */
+    uint32_t buckets[INSTR_HISTOGRAM_BUCKET_COUNT];
+} instr_histogram_t;
+
+#if INSTR_ENABLE
+
+/**
+ * Gets the current instrumentation timestamp.
+ *
+ * @returns The current value of the cycle counter on target, or the monotonic clock in
+ * nanoseconds on host.
+ */
+static inline uint32_t instr_timestamp_get(void)
+{
+#if defined(HOST)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000000000UL) + now.tv_nsec;
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * Initializes the instrumentation module, and starts the cycle counter.
+ */
+void instr_init(void);
+
+/**
+ * Records the duration of a stage.
+ *
+ * @param[in] stage Stage to record the duration for.
+ * @param[in] start Timestamp taken with @ref instr_timestamp_get() when entering the stage.
+ */
+void instr_stage_record(instr_stage_t stage, uint32_t start);
+
+/**
+ * Gets the histogram of a stage.
+ *
+ * @param[in] stage Stage to get the histogram of.
+ *
+ * @returns A pointer to the histogram, or NULL if the stage is out of range.
+ */
+const instr_histogram_t * instr_histogram_get(instr_stage_t stage);
+
+/**
+ * Clears the histograms of all stages.
+ */
+void instr_clear(void);
+
+/** Takes a timestamp when entering a stage, to be passed to @ref INSTR_STAGE_END(). */
+#define INSTR_STAGE_BEGIN(start) uint32_t start = instr_timestamp_get()
+/** Records the duration of a stage that started with @ref INSTR_STAGE_BEGIN(). */
+#define INSTR_STAGE_END(stage, start) instr_stage_record(stage, start)
+
+#else
+
+#define instr_init()
+#define INSTR_STAGE_BEGIN(start)
+#define INSTR_STAGE_END(stage, start)
+
+#endif /* INSTR_ENABLE */
+
+/**
+ * Sets an instrumentation option.
+ *
+ * @param[in] id    Identifier of the option to set.
+ * @param[in] p_opt Pointer to the option value.
+ *
+ * @retval NRF_SUCCESS               Successfully set the option.
+ * @retval NRF_ERROR_NULL            The option pointer was NULL.
+ * @retval NRF_ERROR_NOT_FOUND       Unknown or read-only option.
+ * @retval NRF_ERROR_NOT_SUPPORTED   Instrumentation is not enabled in this build.
+ */
+uint32_t instr_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt);
+
+/**
+ * Gets an instrumentation option.
+ *
+ * @param[in]     id    Identifier of the option to get.
+ * @param[in,out] p_opt Pointer to the option value. For histograms, @c opt.p_array must point to a
+ *                      buffer of @c len bytes, and @c len is set to the size of the histogram.
+ *
+ * @retval NRF_SUCCESS               Successfully got the option.
+ * @retval NRF_ERROR_NULL            The option or array pointer was NULL.
+ * @retval NRF_ERROR_INVALID_LENGTH  The buffer is too small for the histogram.
+ * @retval NRF_ERROR_NOT_FOUND       Unknown or write-only option.
+ * @retval NRF_ERROR_NOT_SUPPORTED   Instrumentation is not enabled in this build.
+ */
+uint32_t instr_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * p_opt);
+
+/** @} */
+
+#endif /* INSTR_H__ */
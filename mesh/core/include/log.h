@@ -67,6 +67,11 @@
  *   [Python Log Viewer](https://pythonhosted.org/logview).
  * * **Standard output**: Provides output to `stdout` when running on host. This is
  *   used when `log_callback_stdout` is passed to `__LOG_INIT()`.
+ * * **Deferred**: stores each log call as a compact binary record in a RAM buffer, without
+ *   formatting the message. The records are read out with `log_deferred_read()` or
+ *   `log_deferred_flush_rtt()`, and formatted on the host with scripts/deferred_log/decode.py,
+ *   using the format strings in the application ELF file. This is used when
+ *   `log_callback_deferred()` is passed to `__LOG_INIT()`, and requires @ref LOG_DEFERRED_ENABLE.
  * @{
  */
 
@@ -157,6 +162,106 @@ void log_callback_stdout(uint32_t dbg_level, const char * p_filename, uint16_t l
     uint32_t timestamp, const char * format, va_list arguments);
 #endif
 
+#if LOG_DEFERRED_ENABLE
+/**
+ * @defgroup LOG_DEFERRED_RECORD Deferred log record format
+ * Each deferred log record is a @ref log_deferred_header_t, followed by @c args_length words of
+ * arguments. The arguments are stored in the order they appear in the format string:
+ * * Integers, characters and pointers are stored in their native size, rounded up to a whole word.
+ * * Floating point numbers are stored as doubles (two words).
+ * * Strings are stored as a word containing the string length in bytes, followed by the
+ *   characters, padded to a whole word. Strings are truncated to fit in the record.
+ * * Field widths and precisions given as @c * are stored as integers.
+ *
+ * Records logged with `__LOG_XB()` have the @ref LOG_DEFERRED_FLAG_ARRAY flag set. Their format
+ * field points to the message, and their arguments are the array, stored like a string.
+ * @{
+ */
+
+/** Mask of the log level in @ref log_deferred_header_t::flags_level. */
+#define LOG_DEFERRED_LEVEL_MASK     (0x3F)
+/** The record holds an array logged with `__LOG_XB()`. */
+#define LOG_DEFERRED_FLAG_ARRAY     (1 << 7)
+/** The arguments did not fit in the record, and the last ones have been cut off. */
+#define LOG_DEFERRED_FLAG_TRUNCATED (1 << 6)
+
+/** Deferred log record header. */
+typedef struct
+{
+    uint32_t format;      /**< Address of the format string. */
+    uint32_t filename;    /**< Address of the filename string. */
+    uint32_t timestamp;   /**< Timestamp for when the log function was called. */
+    uint16_t line;        /**< Line number where the log function was called. */
+    uint8_t  flags_level; /**< Log level, combined with the LOG_DEFERRED_FLAG_* flags. */
+    uint8_t  args_length; /**< Length of the arguments following the header, in words. */
+} log_deferred_header_t;
+
+/** @} */
+
+/** Deferred logging statistics. */
+typedef struct
+{
+    uint32_t records_written;   /**< Number of records stored in the log buffer. */
+    uint32_t records_dropped;   /**< Number of records dropped because the log buffer was full. */
+    uint32_t records_truncated; /**< Number of records stored with truncated arguments. */
+} log_deferred_stats_t;
+
+/**
+ * Callback function for storing log calls in the deferred log buffer.
+ *
+ * The format string is not parsed beyond finding the size of each argument, and must be a string
+ * literal present in the application image for the host decoder to find it.
+ */
+void log_callback_deferred(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * format, va_list arguments);
+
+/**
+ * Reads records from the deferred log buffer.
+ *
+ * Only whole records are read. Records that are read are removed from the log buffer.
+ *
+ * @param[out] p_buffer Buffer to copy the records to.
+ * @param[in]  length   Length of @p p_buffer in bytes.
+ *
+ * @returns The number of bytes copied to @p p_buffer.
+ */
+uint32_t log_deferred_read(uint8_t * p_buffer, uint32_t length);
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+/**
+ * Moves as many records as there is room for from the deferred log buffer to RTT channel 0.
+ *
+ * Should be called from a low priority context, for instance the application main loop.
+ */
+void log_deferred_flush_rtt(void);
+#endif
+
+/**
+ * Gets the deferred logging statistics.
+ *
+ * @returns A pointer to the deferred logging statistics.
+ */
+const log_deferred_stats_t * log_deferred_stats_get(void);
+
+/**
+ * Prints an array with a message.
+ *
+ * Used by `__LOG_XB()` when deferred logging is enabled. If the deferred log callback is in use,
+ * the array is stored as is, otherwise it is formatted as a hex string and passed on to the
+ * callback.
+ *
+ * @param[in] dbg_level  The debugging level to print the message as.
+ * @param[in] p_filename Name of the file in which the log call originated.
+ * @param[in] line       Line number where the function was called.
+ * @param[in] timestamp  Timestamp for when the log function was called.
+ * @param[in] p_msg      Message string.
+ * @param[in] p_array    Pointer to array.
+ * @param[in] array_len  Length of array (in bytes).
+ */
+void log_array_printf(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * p_msg, const uint8_t * p_array, uint32_t array_len);
+#endif
+
 /**
  * Initializes the logging module.
  *
@@ -263,6 +368,14 @@ void log_vprintf(uint32_t dbg_level, const char * p_filename, uint16_t line, uin
  * @param[in] array  Pointer to array
  * @param[in] len    Length of array (in bytes)
  */
+#if LOG_DEFERRED_ENABLE
+#define __LOG_XB(source, level, msg, array, array_len)                      \
+    if ((source & g_log_dbg_msk) && (level <= g_log_dbg_lvl))               \
+    {                                                                       \
+        log_array_printf(level, __FILENAME__, __LINE__, log_timestamp_get(), \
+                         msg, (const uint8_t *) (array), (array_len));      \
+    }
+#else
 #define __LOG_XB(source, level, msg, array, array_len)                      \
     if ((source & g_log_dbg_msk) && (level <= g_log_dbg_lvl))           \
     {                                                                       \
@@ -278,6 +391,7 @@ void log_vprintf(uint32_t dbg_level, const char * p_filename, uint16_t line, uin
         array_text[_array_len * 2] = 0;                                     \
         log_printf(level, __FILENAME__, __LINE__, log_timestamp_get(), "%s: %s\n", msg, array_text); \
     }
+#endif
 
 #else
 #define __LOG_INIT(...)
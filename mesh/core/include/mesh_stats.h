@@ -0,0 +1,165 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef MESH_STATS_H__
+#define MESH_STATS_H__
+
+#include <stdint.h>
+
+#include "nrf_mesh_config_core.h"
+#include "nrf_mesh_opt.h"
+
+/**
+ * @defgroup MESH_STATS Statistics counters
+ * @ingroup MESH_CORE
+ * Counts the packets processed by the layers of the stack, and the reasons they were dropped.
+ *
+ * Each counter is a 32-bit integer in a single array, and is incremented in place with
+ * @ref MESH_STATS_INC(), at a fixed cost and without logging. The counters are read and cleared with
+ * @ref mesh_stats_get() and @ref mesh_stats_clear(), the @ref NRF_MESH_OPT_STATS_COUNTERS option or
+ * the statistics serial commands.
+ *
+ * The scanner keeps its own counters in the bearer layer. They are included in the snapshot, relative
+ * to the values they had when the counters were last cleared.
+ *
+ * The increments are not atomic. Counters that are incremented from several interrupt levels may
+ * lose an increment when the increments collide.
+ *
+ * The counters are compiled out unless @ref MESH_STATS_ENABLE is set.
+ * @{
+ */
+
+/** Statistics counters. New counters are only ever added at the end. */
+typedef enum
+{
+    MESH_STATS_NET_RX,                     /**< Network PDUs received from the bearers. */
+    MESH_STATS_NET_DECRYPT_ATTEMPT,        /**< Network PDU decryptions attempted, at most one per candidate network key. */
+    MESH_STATS_NET_RX_DROP_CACHE,          /**< Network PDUs dropped because they were in the message cache. */
+    MESH_STATS_NET_RX_DROP_DECRYPT,        /**< Network PDUs dropped because no network key could decrypt them. */
+    MESH_STATS_NET_RX_DROP_INVALID,        /**< Network PDUs dropped because of an invalid decrypted header. */
+    MESH_STATS_NET_TX,                     /**< Network PDUs originated by this device. */
+    MESH_STATS_NET_RELAYED,                /**< Network PDUs relayed. */
+    MESH_STATS_TRS_RX_DROP_UNKNOWN_DST,    /**< Transport PDUs dropped because the destination isn't an address of this device. */
+    MESH_STATS_TRS_RX_DROP_REPLAY,         /**< Transport PDUs dropped by the replay protection. */
+    MESH_STATS_TRS_RX_DROP_REPLAY_FULL,    /**< Transport PDUs dropped because the replay cache had no room for the source. */
+    MESH_STATS_TRS_RX_DROP_DECRYPT,        /**< Upper transport PDUs dropped because no application or device key could decrypt them. */
+    MESH_STATS_TRS_SAR_RX_START,           /**< Segmented RX sessions started. */
+    MESH_STATS_TRS_SAR_RX_COMPLETE,        /**< Segmented RX sessions completed. */
+    MESH_STATS_TRS_SAR_RX_FAIL,            /**< Segmented RX sessions cancelled. */
+    MESH_STATS_TRS_SAR_TX_START,           /**< Segmented TX sessions started. */
+    MESH_STATS_TRS_SAR_TX_COMPLETE,        /**< Segmented TX sessions completed. */
+    MESH_STATS_TRS_SAR_TX_FAIL,            /**< Segmented TX sessions cancelled. */
+    MESH_STATS_ACCESS_RX,                  /**< Access messages dispatched to the models. */
+    MESH_STATS_ACCESS_RX_UNHANDLED,        /**< Access messages that no model had a handler for. */
+    MESH_STATS_ADV_TX_QUEUE_FULL,          /**< Advertiser packet allocations that failed because the queue was full. */
+    MESH_STATS_FLASH_WRITE,                /**< Flash write operations queued. */
+    MESH_STATS_FLASH_ERASE,                /**< Flash erase operations queued. */
+    MESH_STATS_FLASH_QUEUE_FULL,           /**< Flash operations rejected because the queue was full. */
+    MESH_STATS_SCANNER_RX,                 /**< Packets received by the scanner. */
+    MESH_STATS_SCANNER_CRC_FAIL,           /**< Packets received by the scanner with a CRC failure. */
+    MESH_STATS_SCANNER_NO_MEM,             /**< Packets dropped by the scanner because it ran out of memory. */
+    MESH_STATS_COUNT                       /**< Number of counters. */
+} mesh_stats_counter_t;
+
+/** Snapshot of the statistics counters. */
+typedef struct
+{
+    uint32_t counters[MESH_STATS_COUNT]; /**< Counter values, indexed by @ref mesh_stats_counter_t. */
+} mesh_stats_t;
+
+#if MESH_STATS_ENABLE
+
+/** @internal Counter array, only to be accessed through @ref MESH_STATS_INC(). */
+extern uint32_t g_mesh_stats_counters[MESH_STATS_COUNT];
+
+/** Increments a statistics counter. */
+#define MESH_STATS_INC(counter) (g_mesh_stats_counters[(counter)]++)
+
+/**
+ * Initializes the statistics module, and clears the counters.
+ */
+void mesh_stats_init(void);
+
+/**
+ * Gets a snapshot of the counters.
+ *
+ * @param[out] p_stats Snapshot to fill.
+ */
+void mesh_stats_get(mesh_stats_t * p_stats);
+
+/**
+ * Clears the counters.
+ */
+void mesh_stats_clear(void);
+
+#else
+
+#define MESH_STATS_INC(counter)
+#define mesh_stats_init()
+
+#endif /* MESH_STATS_ENABLE */
+
+/**
+ * Sets a statistics option.
+ *
+ * @param[in] id    Identifier of the option to set.
+ * @param[in] p_opt Pointer to the option value.
+ *
+ * @retval NRF_SUCCESS               Successfully set the option.
+ * @retval NRF_ERROR_NULL            The option pointer was NULL.
+ * @retval NRF_ERROR_NOT_FOUND       Unknown option.
+ * @retval NRF_ERROR_NOT_SUPPORTED   Statistics are not enabled in this build.
+ */
+uint32_t mesh_stats_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt);
+
+/**
+ * Gets a statistics option.
+ *
+ * @param[in]     id    Identifier of the option to get.
+ * @param[in,out] p_opt Pointer to the option value. @c opt.p_array must point to a buffer of @c len
+ *                      bytes, and @c len is set to the size of the snapshot.
+ *
+ * @retval NRF_SUCCESS               Successfully got the option.
+ * @retval NRF_ERROR_NULL            The option or array pointer was NULL.
+ * @retval NRF_ERROR_INVALID_LENGTH  The buffer is too small for the snapshot.
+ * @retval NRF_ERROR_NOT_FOUND       Unknown option.
+ * @retval NRF_ERROR_NOT_SUPPORTED   Statistics are not enabled in this build.
+ */
+uint32_t mesh_stats_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * p_opt);
+
+/** @} */
+
+#endif /* MESH_STATS_H__ */
@@ -59,6 +59,13 @@
  */
 #define NET_BEACON_CMAC_SIZE 8
 
+/** Network beacon RX statistics. Recorded since the module was initialized. */
+typedef struct
+{
+    uint32_t cache_hits;  /**< Number of received beacons found in the authenticated beacon cache. */
+    uint32_t cmacs_saved; /**< Number of CMAC calculations skipped because of cache hits. */
+} net_beacon_stats_t;
+
 /**
  * Initializes the network beacon module.
  */
@@ -112,6 +119,13 @@ uint32_t net_beacon_build(const nrf_mesh_beacon_secmat_t * p_beacon_secmat,
  */
 void net_beacon_packet_in(const uint8_t * p_beacon_data, uint8_t data_length, const nrf_mesh_rx_metadata_t * p_meta);
 
+/**
+ * Returns statistics related to the network beacon module.
+ *
+ * @return Pointer to statistics structure.
+ */
+const net_beacon_stats_t * net_beacon_stats_get(void);
+
 /**
  * Get the network beacon flag representation of the given key refresh phase.
  *
@@ -90,6 +90,9 @@ typedef struct
  *
  * @retval NRF_SUCCESS The packet was successfully decrypted.
  * @retval NRF_ERROR_NOT_FOUND Couldn't find a network key to decrypt the packet.
+ * @retval NRF_ERROR_INVALID_STATE The packet was dropped, as its deobfuscated source address and
+ *                                 sequence number were found in the message cache. Only the
+ *                                 source address and sequence number in the metadata are set.
  */
 uint32_t net_packet_decrypt(network_packet_metadata_t * p_net_metadata,
                         uint32_t net_packet_len,
@@ -110,6 +113,28 @@ void net_packet_encrypt(network_packet_metadata_t * p_net_metadata,
                         packet_mesh_net_packet_t * p_net_packet,
                         net_packet_kind_t packet_kind);
 
+/**
+ * Build and encrypt a relayed network packet straight from the received, decrypted packet.
+ *
+ * Replaces the header serialization, payload copy and in-place encryption of the regular TX path
+ * for relayed packets: The unobfuscated header is copied from the received packet with only the
+ * TTL field changed, and the destination and payload are encrypted directly from the decrypted
+ * packet into the relay packet.
+ *
+ * @note The TTL is part of the network nonce, and the privacy random used for the header
+ * obfuscation is taken from the ciphertext, so the CCM and obfuscation of the received packet can't
+ * be reused for the relayed packet.
+ *
+ * @param[in] p_net_metadata Metadata of the relayed packet, with the TTL already decremented.
+ * @param[in] payload_len Length of the packet payload.
+ * @param[in] p_net_decrypted_packet Received packet, as decrypted by @ref net_packet_decrypt.
+ * @param[out] p_net_packet Relay packet to build. Must not overlap the decrypted packet.
+ */
+void net_packet_relay_encrypt(const network_packet_metadata_t * p_net_metadata,
+                              uint32_t payload_len,
+                              const packet_mesh_net_packet_t * p_net_decrypted_packet,
+                              packet_mesh_net_packet_t * p_net_packet);
+
 /**
  * Populate the header of the given network packet with the given metadata.
  *
@@ -142,6 +142,7 @@ void network_packet_discard(const network_tx_packet_buffer_t * p_buffer);
  * @retval NRF_SUCCESS The packet was successfully processed.
  * @retval NRF_ERROR_INVALID_ADDR The destination address is not valid.
  * @retval NRF_ERROR_NOT_FOUND    The packet could not be decrypted.
+ * @retval NRF_ERROR_INVALID_LENGTH The packet is longer than any network PDU this device handles.
  */
 uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, const nrf_mesh_rx_metadata_t * p_rx_metadata);
 
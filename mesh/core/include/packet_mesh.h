@@ -39,6 +39,7 @@
 #define PACKET_MESH_H__
 
 #include <stdint.h>
+#include "nrf_mesh_config_core.h"
 
 /**
  * @defgroup PACKET_MESH Mesh packet formats
@@ -136,6 +137,7 @@
 
 #define PACKET_MESH_TRS_CONTROL_HEARTBEAT_SIZE (3) /**< Size of trs control heartbeat packet. */
 
+#define PACKET_MESH_NET_BUFFER_SIZE (TRANSPORT_BULK_ENABLE ? (PACKET_MESH_NET_MAX_SIZE + TRANSPORT_BULK_PDU_MAX_SIZE - PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE) : PACKET_MESH_NET_MAX_SIZE) /**< Size of net packet buffers, which hold long bulk transfer packets when TRANSPORT_BULK_ENABLE is set. */
 #define PACKET_MESH_NET_PDU_OFFSET (9) /**< Offset of net packet PDU. */
 #define PACKET_MESH_NET_MAX_SIZE (29) /**< Max size of net packet. */
 #define PACKET_MESH_NET_PDU_MAX_SIZE (20) /**< Max size of net packet PDU. */
@@ -164,7 +166,7 @@
  */
 typedef struct
 {
-    uint8_t pdu[29];
+    uint8_t pdu[PACKET_MESH_NET_BUFFER_SIZE];
 } packet_mesh_net_packet_t;
 
 /**
@@ -0,0 +1,159 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PACKET_TRACE_H__
+#define PACKET_TRACE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_config_core.h"
+#include "scanner.h"
+
+/**
+ * @defgroup PACKET_TRACE Packet trace
+ * @ingroup MESH_CORE
+ * Records the packets received by the scanner in a compact binary format, to be replayed offline.
+ *
+ * The trace is a byte stream, starting with a @ref packet_trace_header_t, followed by one
+ * @ref packet_trace_record_t for each received packet. Each record is followed by the advertiser
+ * address and the advertising payload of the packet, @c length bytes in total. All fields are
+ * little endian.
+ *
+ * The records are stored in a RAM ring buffer when the packets are processed, and read out with
+ * @ref packet_trace_read() (used by the serial interface) or moved to an RTT channel with
+ * @ref packet_trace_flush_rtt(). Records that do not fit in the buffer are dropped and counted.
+ * On the host, traces are replayed through the stack by the @c bm_trace_replay benchmark.
+ *
+ * The recording is compiled out unless @ref PACKET_TRACE_ENABLE is set.
+ * @{
+ */
+
+/** Magic number at the start of a packet trace, "MTRC". */
+#define PACKET_TRACE_MAGIC   (0x4352544D)
+/** Version of the packet trace format. */
+#define PACKET_TRACE_VERSION (1)
+
+/** Packet trace stream header. */
+typedef struct __attribute((packed))
+{
+    uint32_t magic;      /**< Always @ref PACKET_TRACE_MAGIC. */
+    uint8_t version;     /**< Trace format version, @ref PACKET_TRACE_VERSION. */
+    uint8_t _rfu[3];     /**< Reserved for future use. */
+} packet_trace_header_t;
+
+/** Packet trace record, followed by @c length bytes of the packet. */
+typedef struct __attribute((packed))
+{
+    uint32_t timestamp;  /**< RX timestamp of the packet in microseconds. */
+    uint8_t channel;     /**< Channel the packet was received on. */
+    int8_t rssi;         /**< RSSI of the packet. */
+    uint8_t pdu_type;    /**< BLE advertising PDU type, with the TX address type in bit 6. */
+    uint8_t length;      /**< Length of the advertiser address and the payload. */
+} packet_trace_record_t;
+
+/** Packet trace statistics. */
+typedef struct
+{
+    uint32_t recorded;   /**< Number of records stored since the trace was started. */
+    uint32_t dropped;    /**< Number of records dropped because the buffer was full. */
+} packet_trace_stats_t;
+
+#if PACKET_TRACE_ENABLE
+
+/**
+ * Starts recording a new trace.
+ *
+ * Discards any unread data from a previous trace, and writes a new trace header.
+ */
+void packet_trace_start(void);
+
+/**
+ * Stops recording. The data recorded so far can still be read out.
+ */
+void packet_trace_stop(void);
+
+/**
+ * Checks whether the packet trace is recording.
+ *
+ * @returns Whether the packet trace is recording.
+ */
+bool packet_trace_is_enabled(void);
+
+/**
+ * Records a packet received by the scanner, if the trace is recording.
+ *
+ * @param[in] p_packet Received packet.
+ */
+void packet_trace_scanner_rx(const scanner_packet_t * p_packet);
+
+/**
+ * Reads out recorded trace data.
+ *
+ * The trace is read as a byte stream; a record may be split over several reads.
+ *
+ * @param[out] p_buffer Buffer to copy the data to.
+ * @param[in]  length   Size of the buffer.
+ *
+ * @returns The number of bytes copied to the buffer.
+ */
+uint32_t packet_trace_read(uint8_t * p_buffer, uint32_t length);
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+/**
+ * Moves as much of the recorded trace data as possible to RTT up channel
+ * @ref PACKET_TRACE_RTT_CHANNEL.
+ */
+void packet_trace_flush_rtt(void);
+#endif
+
+/**
+ * Gets the packet trace statistics.
+ *
+ * @returns A pointer to the statistics structure.
+ */
+const packet_trace_stats_t * packet_trace_stats_get(void);
+
+#else
+
+#define packet_trace_scanner_rx(p_packet)
+
+#endif /* PACKET_TRACE_ENABLE */
+
+/** @} */
+
+#endif /* PACKET_TRACE_H__ */
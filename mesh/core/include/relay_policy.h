@@ -0,0 +1,256 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef RELAY_POLICY_H__
+#define RELAY_POLICY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh.h"
+#include "nrf_mesh_config_core.h"
+#include "network.h"
+#include "packet_mesh.h"
+#include "timer_scheduler.h"
+#include "rand.h"
+
+/**
+ * @defgroup RELAY_POLICY Relay policy
+ * @ingroup MESH_CORE
+ * Decides which of the packets that pass the relay rules of the Mesh Profile Specification v1.0,
+ * section 3.4.6.3, are actually relayed, to avoid broadcast storms in dense networks where many
+ * relays are within radio range of each other.
+ * @{
+ */
+
+/** Relay policy types. */
+typedef enum
+{
+    /** Relay every packet that passes the relay rules. This is the default. */
+    RELAY_POLICY_TYPE_ALWAYS,
+    /**
+     * Counter-based suppression. Wait a random back-off before relaying, and drop the relay if the
+     * same packet has been heard @c counter_threshold times by the end of it.
+     */
+    RELAY_POLICY_TYPE_COUNTER,
+    /**
+     * RSSI-gated relaying. Only relay packets received with an RSSI below @c rssi_threshold, as
+     * nodes far away from the previous hop add the most coverage.
+     */
+    RELAY_POLICY_TYPE_RSSI,
+    /**
+     * Neighbour density adaptive relaying. Relay with a probability of @c density_target divided by
+     * the number of neighbours heard recently, so that about @c density_target nodes in an area
+     * relay each packet.
+     */
+    RELAY_POLICY_TYPE_DENSITY,
+} relay_policy_type_t;
+
+/** Relay policy configuration. */
+typedef struct
+{
+    relay_policy_type_t type;      /**< Policy to apply. */
+    uint8_t counter_threshold;     /**< Number of times a packet must be heard to suppress the relay, for @ref RELAY_POLICY_TYPE_COUNTER. */
+    uint32_t backoff_max_us;       /**< Upper limit of the random back-off, for @ref RELAY_POLICY_TYPE_COUNTER. */
+    int8_t rssi_threshold;         /**< RSSI at or above which packets aren't relayed, for @ref RELAY_POLICY_TYPE_RSSI. */
+    uint8_t density_target;        /**< Expected number of relaying neighbours, for @ref RELAY_POLICY_TYPE_DENSITY. */
+} relay_policy_config_t;
+
+/** Relay policy counters. */
+typedef struct
+{
+    uint32_t relayed;              /**< Packets handed to the relay. */
+    uint32_t deferred;             /**< Packets held back for the counter-based back-off. */
+    uint32_t deferred_full;        /**< Packets relayed immediately because all back-off slots were in use. */
+    uint32_t duplicates;           /**< Duplicates heard of packets waiting out the back-off. */
+    uint32_t suppressed_counter;   /**< Relays dropped by the counter-based policy. */
+    uint32_t suppressed_rssi;      /**< Relays dropped by the RSSI-gated policy. */
+    uint32_t suppressed_density;   /**< Relays dropped by the density adaptive policy. */
+} relay_policy_stats_t;
+
+/** Default relay policy configuration. */
+#define RELAY_POLICY_CONFIG_DEFAULT                     \
+    {                                                   \
+        .type = RELAY_POLICY_TYPE_ALWAYS,               \
+        .counter_threshold = 3,                         \
+        .backoff_max_us = MS_TO_US(40),                 \
+        .rssi_threshold = -70,                          \
+        .density_target = 4,                            \
+    }
+
+typedef struct relay_policy relay_policy_t;
+
+/**
+ * Relays a packet whose back-off ended without being suppressed.
+ *
+ * @param[in,out] p_policy       Relay policy instance the packet was deferred by.
+ * @param[in,out] p_net_metadata Network metadata of the received packet.
+ * @param[in]     p_net_packet   Decrypted network packet.
+ * @param[in]     payload_len    Length of the network payload.
+ */
+typedef void (*relay_policy_relay_cb_t)(relay_policy_t * p_policy,
+                                        network_packet_metadata_t * p_net_metadata,
+                                        const packet_mesh_net_packet_t * p_net_packet,
+                                        uint8_t payload_len);
+
+/** A relay waiting out the counter-based back-off. */
+typedef struct
+{
+    bool active;                          /**< Whether the slot is in use. */
+    uint8_t count;                        /**< Number of times the packet has been heard. */
+    uint8_t payload_len;                  /**< Length of the network payload. */
+    timestamp_t deadline;                 /**< Time at which the back-off ends. */
+    network_packet_metadata_t metadata;   /**< Network metadata of the packet. */
+    packet_mesh_net_packet_t packet;      /**< Decrypted network packet. */
+} relay_policy_pending_t;
+
+/** A neighbour heard by the density adaptive policy. */
+typedef struct
+{
+    uint8_t addr[BLE_GAP_ADDR_LEN];       /**< Advertisement address of the neighbour. */
+    timestamp_t last_heard;               /**< Time the neighbour was last heard. */
+    bool active;                          /**< Whether the entry is in use. */
+} relay_policy_neighbour_t;
+
+/** Relay policy instance. All fields are internal and should not be accessed directly. */
+struct relay_policy
+{
+    relay_policy_config_t config;
+    relay_policy_stats_t stats;
+    relay_policy_relay_cb_t relay_cb;
+    prng_t prng;
+    timer_event_t timer;
+    relay_policy_pending_t pending[RELAY_POLICY_PENDING_COUNT];
+    relay_policy_neighbour_t neighbours[RELAY_POLICY_NEIGHBOUR_COUNT];
+};
+
+/**
+ * Initializes a relay policy instance with the default configuration.
+ *
+ * @param[out] p_policy Instance to initialize.
+ * @param[in]  relay_cb Function to call to relay packets at the end of their back-off.
+ */
+void relay_policy_init(relay_policy_t * p_policy, relay_policy_relay_cb_t relay_cb);
+
+/**
+ * Sets the relay policy configuration.
+ *
+ * Packets already waiting out a back-off are finished with the old configuration.
+ *
+ * @param[in,out] p_policy Relay policy instance.
+ * @param[in]     p_config New configuration.
+ *
+ * @retval NRF_SUCCESS             The configuration was applied.
+ * @retval NRF_ERROR_NULL          The configuration was NULL.
+ * @retval NRF_ERROR_INVALID_PARAM The configuration has an unknown type, or a zero threshold,
+ *                                 back-off or density target.
+ */
+uint32_t relay_policy_config_set(relay_policy_t * p_policy, const relay_policy_config_t * p_config);
+
+/**
+ * Gets the relay policy configuration.
+ *
+ * @param[in]  p_policy Relay policy instance.
+ * @param[out] p_config Current configuration.
+ */
+void relay_policy_config_get(const relay_policy_t * p_policy, relay_policy_config_t * p_config);
+
+/**
+ * Applies the policy to a received packet that passes the relay rules.
+ *
+ * If the packet is deferred, the policy keeps a copy of it, and passes it to the relay callback
+ * when the back-off ends, unless it has been suppressed.
+ *
+ * @param[in,out] p_policy       Relay policy instance.
+ * @param[in]     p_net_metadata Network metadata of the received packet.
+ * @param[in]     p_net_packet   Decrypted network packet.
+ * @param[in]     payload_len    Length of the network payload.
+ * @param[in]     p_rx_metadata  RX metadata of the received packet.
+ *
+ * @returns Whether the packet should be relayed immediately.
+ */
+bool relay_policy_packet_in(relay_policy_t * p_policy,
+                            const network_packet_metadata_t * p_net_metadata,
+                            const packet_mesh_net_packet_t * p_net_packet,
+                            uint8_t payload_len,
+                            const nrf_mesh_rx_metadata_t * p_rx_metadata);
+
+/**
+ * Reports a packet that was dropped as a duplicate by the message cache.
+ *
+ * @param[in,out] p_policy        Relay policy instance.
+ * @param[in]     src             Source address of the packet.
+ * @param[in]     sequence_number Sequence number of the packet.
+ */
+void relay_policy_duplicate_in(relay_policy_t * p_policy, uint16_t src, uint32_t sequence_number);
+
+/**
+ * Reports a received mesh packet, to keep track of the neighbour density.
+ *
+ * Only does anything for the density adaptive policy, and for packets received by the scanner.
+ *
+ * @param[in,out] p_policy      Relay policy instance.
+ * @param[in]     p_rx_metadata RX metadata of the received packet.
+ */
+void relay_policy_neighbour_heard(relay_policy_t * p_policy, const nrf_mesh_rx_metadata_t * p_rx_metadata);
+
+/**
+ * Gets the number of neighbours heard within the last @ref RELAY_POLICY_NEIGHBOUR_TIMEOUT_MS.
+ *
+ * @param[in] p_policy Relay policy instance.
+ *
+ * @returns The number of neighbours.
+ */
+uint32_t relay_policy_neighbour_count_get(const relay_policy_t * p_policy);
+
+/**
+ * Gets the relay policy counters.
+ *
+ * @param[in]  p_policy Relay policy instance.
+ * @param[out] p_stats  Counters.
+ */
+void relay_policy_stats_get(const relay_policy_t * p_policy, relay_policy_stats_t * p_stats);
+
+/**
+ * Clears the relay policy counters.
+ *
+ * @param[in,out] p_policy Relay policy instance.
+ */
+void relay_policy_stats_clear(relay_policy_t * p_policy);
+
+/** @} */
+
+#endif /* RELAY_POLICY_H__ */
@@ -0,0 +1,227 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef RELAY_QUEUE_H__
+#define RELAY_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_config_core.h"
+#include "network.h"
+#include "packet_mesh.h"
+#include "timer_scheduler.h"
+
+/**
+ * @defgroup RELAY_QUEUE Relay queue
+ * @ingroup MESH_CORE
+ * Holds relayed packets the relay bearers can't take yet, instead of dropping them, and arbitrates
+ * between relayed and locally originated traffic.
+ * @{
+ */
+
+/** Priority between relayed and locally originated packets. */
+typedef enum
+{
+    /** The roles don't wait for each other. This is the default. */
+    RELAY_QUEUE_PRIORITY_EQUAL,
+    /** Locally originated packets can't be allocated while relayed packets wait in the queue. */
+    RELAY_QUEUE_PRIORITY_RELAY,
+    /**
+     * Relayed packets are held in the queue for @ref RELAY_QUEUE_ORIGINATOR_HOLDOFF_MS after each
+     * locally originated packet, to leave the radio to it.
+     */
+    RELAY_QUEUE_PRIORITY_ORIGINATOR,
+} relay_queue_priority_t;
+
+/** Packet to drop when a relayed packet arrives at a full queue. */
+typedef enum
+{
+    /** Drop the packet that has been waiting the longest. This is the default. */
+    RELAY_QUEUE_DROP_OLDEST,
+    /** Drop the packet with the lowest TTL, as it has the fewest hops left to go. */
+    RELAY_QUEUE_DROP_LOWEST_TTL,
+} relay_queue_drop_t;
+
+/** Relay queue configuration. */
+typedef struct
+{
+    relay_queue_priority_t priority; /**< Priority between relayed and locally originated packets. */
+    relay_queue_drop_t drop;         /**< Packet to drop when the queue is full. */
+    uint32_t max_age_us;             /**< Time after which a queued packet is dropped instead of relayed. */
+} relay_queue_config_t;
+
+/** Relay queue counters. */
+typedef struct
+{
+    uint32_t sent_direct;            /**< Packets handed to the bearers without being queued. */
+    uint32_t sent_queued;            /**< Packets handed to the bearers after waiting in the queue. */
+    uint32_t dropped_full;           /**< Packets dropped because the queue was full. */
+    uint32_t dropped_age;            /**< Packets dropped because they waited longer than the maximum age. */
+    uint32_t originator_deferred;    /**< Locally originated packets refused to give relayed packets priority. */
+    uint16_t depth;                  /**< Number of packets in the queue. */
+    uint16_t depth_max;              /**< Highest number of packets in the queue. */
+    uint32_t latency_max_us;         /**< Longest time a packet waited in the queue before it was sent. */
+    uint32_t latency_total_us;       /**< Total time the @c sent_queued packets waited in the queue. */
+} relay_queue_stats_t;
+
+/** Default relay queue configuration. */
+#define RELAY_QUEUE_CONFIG_DEFAULT                      \
+    {                                                   \
+        .priority = RELAY_QUEUE_PRIORITY_EQUAL,         \
+        .drop = RELAY_QUEUE_DROP_OLDEST,                \
+        .max_age_us = MS_TO_US(500),                    \
+    }
+
+typedef struct relay_queue relay_queue_t;
+
+/**
+ * Hands a relayed packet to the bearers.
+ *
+ * @param[in,out] p_queue        Relay queue instance.
+ * @param[in,out] p_net_metadata Network metadata of the received packet.
+ * @param[in]     p_net_packet   Decrypted network packet.
+ * @param[in]     payload_len    Length of the network payload.
+ *
+ * @returns Whether any bearer took the packet. If not, it is kept in the queue.
+ */
+typedef bool (*relay_queue_tx_cb_t)(relay_queue_t * p_queue,
+                                    network_packet_metadata_t * p_net_metadata,
+                                    const packet_mesh_net_packet_t * p_net_packet,
+                                    uint8_t payload_len);
+
+/** A relayed packet waiting in the queue. */
+typedef struct
+{
+    bool active;                          /**< Whether the entry is in use. */
+    uint8_t payload_len;                  /**< Length of the network payload. */
+    timestamp_t queued;                   /**< Time the packet was queued. */
+    network_packet_metadata_t metadata;   /**< Network metadata of the packet. */
+    packet_mesh_net_packet_t packet;      /**< Decrypted network packet. */
+} relay_queue_entry_t;
+
+/** Relay queue instance. All fields are internal and should not be accessed directly. */
+struct relay_queue
+{
+    relay_queue_config_t config;
+    relay_queue_stats_t stats;
+    relay_queue_tx_cb_t tx_cb;
+    timer_event_t timer;
+    bool held;
+    timestamp_t held_until;
+    relay_queue_entry_t entries[RELAY_QUEUE_SIZE];
+};
+
+/**
+ * Initializes a relay queue instance with the default configuration.
+ *
+ * @param[out] p_queue Instance to initialize.
+ * @param[in]  tx_cb   Function to call to hand relayed packets to the bearers.
+ */
+void relay_queue_init(relay_queue_t * p_queue, relay_queue_tx_cb_t tx_cb);
+
+/**
+ * Sets the relay queue configuration.
+ *
+ * @param[in,out] p_queue  Relay queue instance.
+ * @param[in]     p_config New configuration.
+ *
+ * @retval NRF_SUCCESS             The configuration was applied.
+ * @retval NRF_ERROR_NULL          The configuration was NULL.
+ * @retval NRF_ERROR_INVALID_PARAM The configuration has an unknown priority or drop policy, or a
+ *                                 zero maximum age.
+ */
+uint32_t relay_queue_config_set(relay_queue_t * p_queue, const relay_queue_config_t * p_config);
+
+/**
+ * Gets the relay queue configuration.
+ *
+ * @param[in]  p_queue  Relay queue instance.
+ * @param[out] p_config Current configuration.
+ */
+void relay_queue_config_get(const relay_queue_t * p_queue, relay_queue_config_t * p_config);
+
+/**
+ * Relays a packet.
+ *
+ * The packet is handed to the bearers right away if nothing is waiting ahead of it, and queued
+ * otherwise. The packet must have passed the message cache, which drops packets that are already
+ * relayed or queued.
+ *
+ * @param[in,out] p_queue        Relay queue instance.
+ * @param[in]     p_net_metadata Network metadata of the packet, with the TTL of the received packet.
+ * @param[in]     p_net_packet   Decrypted network packet.
+ * @param[in]     payload_len    Length of the network payload.
+ */
+void relay_queue_push(relay_queue_t * p_queue,
+                      const network_packet_metadata_t * p_net_metadata,
+                      const packet_mesh_net_packet_t * p_net_packet,
+                      uint8_t payload_len);
+
+/**
+ * Checks whether a locally originated packet may be allocated, according to the priority.
+ *
+ * @param[in,out] p_queue Relay queue instance.
+ *
+ * @returns Whether the packet may be allocated.
+ */
+bool relay_queue_originator_allowed(relay_queue_t * p_queue);
+
+/**
+ * Reports that a locally originated packet was allocated.
+ *
+ * @param[in,out] p_queue Relay queue instance.
+ */
+void relay_queue_originator_sent(relay_queue_t * p_queue);
+
+/**
+ * Gets the relay queue counters.
+ *
+ * @param[in]  p_queue Relay queue instance.
+ * @param[out] p_stats Counters.
+ */
+void relay_queue_stats_get(const relay_queue_t * p_queue, relay_queue_stats_t * p_stats);
+
+/**
+ * Clears the relay queue counters.
+ *
+ * @param[in,out] p_queue Relay queue instance.
+ */
+void relay_queue_stats_clear(relay_queue_t * p_queue);
+
+/** @} */
+
+#endif /* RELAY_QUEUE_H__ */
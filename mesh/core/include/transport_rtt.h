@@ -0,0 +1,111 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef TRANSPORT_RTT_H__
+#define TRANSPORT_RTT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utils.h"
+#include "nrf_mesh_defines.h"
+#include "nrf_mesh_config_core.h"
+
+/**
+ * @defgroup TRANSPORT_RTT Transport SAR round trip time estimator
+ * @ingroup TRANSPORT
+ * Keeps a smoothed round trip time (SRTT) and round trip time variation (RTTVAR) per destination,
+ * measured between sending a round of segments and receiving the segment acknowledgment, and
+ * derives the SAR TX retry timeout from them.
+ * @{
+ */
+
+/** Smallest retry timeout the estimator will produce. */
+#define TRANSPORT_RTT_TIMEOUT_MIN_US TRANSPORT_SAR_TX_RETRY_TIMEOUT_BASE_MIN
+
+/** Largest retry timeout the estimator will produce. */
+#define TRANSPORT_RTT_TIMEOUT_MAX_US TRANSPORT_SAR_TX_RETRY_TIMEOUT_BASE_MAX
+
+/** Lower bound for the variation term of the retry timeout, to absorb scheduling jitter. */
+#define TRANSPORT_RTT_GRANULARITY_US MS_TO_US(20)
+
+/** Number of retry timeouts without a measurement after which the estimate is discarded. */
+#define TRANSPORT_RTT_TIMEOUT_COUNT_MAX (8)
+
+/**
+ * Initializes the estimator, forgetting all measurements.
+ */
+void transport_rtt_init(void);
+
+/**
+ * Adds a round trip time measurement for a destination.
+ *
+ * If the destination isn't known, the least recently used entry is replaced.
+ *
+ * @param[in] dst    Unicast destination address the measurement was made towards.
+ * @param[in] rtt_us Measured round trip time in microseconds.
+ */
+void transport_rtt_sample_add(uint16_t dst, uint32_t rtt_us);
+
+/**
+ * Reports that the retry timer for a destination expired, and gets the timeout for the next round.
+ *
+ * With an estimate, the timeout is most likely caused by a lost packet, and the estimated timeout
+ * is kept. Without one, the timeout is doubled and used for the destination until the next
+ * measurement, so that a timeout that is too short to ever measure the round trip time recovers
+ * (RFC 6298, section 5). An estimate that keeps timing out is discarded after
+ * @ref TRANSPORT_RTT_TIMEOUT_COUNT_MAX timeouts without a measurement.
+ *
+ * @param[in] dst        Unicast destination address.
+ * @param[in] timeout_us Retry timeout that expired, in microseconds.
+ *
+ * @returns The retry timeout for the next round in microseconds.
+ */
+uint32_t transport_rtt_timeout_expired(uint16_t dst, uint32_t timeout_us);
+
+/**
+ * Gets the retry timeout for a destination.
+ *
+ * @param[in]  dst          Unicast destination address.
+ * @param[out] p_timeout_us Retry timeout in microseconds, SRTT + max(G, 4 * RTTVAR).
+ *
+ * @returns Whether there is an estimate or a backed off timeout for the destination.
+ */
+bool transport_rtt_timeout_get(uint16_t dst, uint32_t * p_timeout_us);
+
+/** @} */
+
+#endif /* TRANSPORT_RTT_H__ */
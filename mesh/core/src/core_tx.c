@@ -35,13 +35,21 @@
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "core_tx.h"
+
+#include <stddef.h>
+#include <string.h>
+#include "nrf_error.h"
 #include "nrf_mesh_assert.h"
 #include "utils.h"
 #include "nordic_common.h"
 #include "list.h"
 #include "log.h"
+#include "instr.h"
+#include "toolchain.h"
 
 NRF_MESH_STATIC_ASSERT(sizeof(core_tx_bearer_bitmap_t) * 8 >= CORE_TX_BEARER_COUNT_MAX);
+/* Bearers write their headers into the headroom right in front of the shared packet. */
+NRF_MESH_STATIC_ASSERT(offsetof(core_tx_pdu_t, packet) == offsetof(core_tx_pdu_t, headroom) + CORE_TX_PDU_HEADROOM);
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
@@ -56,9 +64,13 @@ struct
 {
     uint8_t length;
     packet_mesh_net_packet_t buffer;
+    core_tx_pdu_t * p_pdu; /**< Shared PDU used for staging, or NULL if the local buffer is used. */
     core_tx_bearer_bitmap_t bearer_bitmap;
 } m_packet;
 
+/** Pool of PDUs that can be shared by reference between the bearers. */
+static core_tx_pdu_t m_pdu_pool[CORE_TX_SHARED_PDU_COUNT];
+
 /** Number of active bearers */
 static uint8_t m_bearer_count;
 /*****************************************************************************
@@ -66,28 +78,60 @@ static uint8_t m_bearer_count;
 *****************************************************************************/
 static inline void alloc_result_log(core_tx_bearer_t * p_bearer, core_tx_alloc_result_t result)
 {
-#ifdef CORE_TX_DEBUG
     switch (result)
     {
         case CORE_TX_ALLOC_SUCCESS:
-            p_bearer->debug.alloc_count++;
+            p_bearer->stats.alloc_count++;
             break;
         case CORE_TX_ALLOC_FAIL_REJECTED:
-            p_bearer->debug.reject_count++;
+            p_bearer->stats.reject_count++;
             break;
         case CORE_TX_ALLOC_FAIL_NO_MEM:
-            p_bearer->debug.no_mem_count++;
+            p_bearer->stats.no_mem_count++;
             break;
         default:
             __LOG(LOG_SRC_NETWORK, LOG_LEVEL_WARN, "Unknown result %u\n", result);
             return;
     }
+#ifdef CORE_TX_DEBUG
     static const char * p_result_names[] = {[CORE_TX_ALLOC_SUCCESS]             = "Success",
                                             [CORE_TX_ALLOC_FAIL_REJECTED]       = "Rejected",
                                             [CORE_TX_ALLOC_FAIL_NO_MEM]         = "No memory"};
     __LOG(LOG_SRC_NETWORK, LOG_LEVEL_INFO, "Bearer 0x%p alloc: %s\n", p_bearer, p_result_names[result]);
 #endif
 }
+
+static core_tx_pdu_t * shared_pdu_alloc(void)
+{
+    core_tx_pdu_t * p_pdu = NULL;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_pdu_pool); ++i)
+    {
+        if (m_pdu_pool[i].refcount == 0)
+        {
+            m_pdu_pool[i].refcount = 1;
+            p_pdu = &m_pdu_pool[i];
+            break;
+        }
+    }
+    _ENABLE_IRQS(was_masked);
+    return p_pdu;
+}
+
+static void shared_pdu_retain(core_tx_pdu_t * p_pdu)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    NRF_MESH_ASSERT(p_pdu->refcount > 0 && p_pdu->refcount < UINT8_MAX);
+    p_pdu->refcount++;
+    _ENABLE_IRQS(was_masked);
+}
+
+static inline bool bearer_is_shared(const core_tx_bearer_t * p_bearer)
+{
+    return (p_bearer->p_interface->packet_send_shared != NULL);
+}
 /*****************************************************************************
 * Interface functions
 *****************************************************************************/
@@ -111,10 +155,20 @@ core_tx_bearer_bitmap_t core_tx_packet_alloc(const core_tx_alloc_params_t * p_pa
     }
 
 
+    /* Stage the packet in a shared PDU if one is available, so bearers that support it can take a
+     * reference instead of a copy. When the pool is exhausted, all bearers get a copy from the local
+     * buffer instead. */
+    m_packet.p_pdu = shared_pdu_alloc();
+
     LIST_FOREACH(p_iterator, mp_bearers)
     {
         core_tx_bearer_t * p_bearer = PARENT_BY_FIELD_GET(core_tx_bearer_t, list_node, p_iterator);
 
+        if (m_packet.p_pdu == NULL && bearer_is_shared(p_bearer))
+        {
+            p_bearer->stats.no_pdu_count++;
+        }
+
         core_tx_alloc_result_t result = p_bearer->p_interface->packet_alloc(p_bearer, p_params);
 
         alloc_result_log(p_bearer, result);
@@ -128,7 +182,20 @@ core_tx_bearer_bitmap_t core_tx_packet_alloc(const core_tx_alloc_params_t * p_pa
     if (m_packet.bearer_bitmap != 0)
     {
         m_packet.length = p_params->net_packet_len;
-        *pp_packet = m_packet.buffer.pdu;
+        if (m_packet.p_pdu != NULL)
+        {
+            m_packet.p_pdu->length = m_packet.length;
+            *pp_packet = m_packet.p_pdu->packet.pdu;
+        }
+        else
+        {
+            *pp_packet = m_packet.buffer.pdu;
+        }
+    }
+    else if (m_packet.p_pdu != NULL)
+    {
+        core_tx_pdu_release(m_packet.p_pdu);
+        m_packet.p_pdu = NULL;
     }
     return m_packet.bearer_bitmap;
 }
@@ -136,6 +203,7 @@ core_tx_bearer_bitmap_t core_tx_packet_alloc(const core_tx_alloc_params_t * p_pa
 void core_tx_packet_send(void)
 {
     NRF_MESH_ASSERT(m_packet.bearer_bitmap != 0);
+    INSTR_STAGE_BEGIN(instr_start);
 
     LIST_FOREACH(p_iterator, mp_bearers)
     {
@@ -143,10 +211,29 @@ void core_tx_packet_send(void)
 
         if (m_packet.bearer_bitmap & (1 << p_bearer->bearer_index))
         {
-            p_bearer->p_interface->packet_send(p_bearer, m_packet.buffer.pdu, m_packet.length);
+            if (m_packet.p_pdu != NULL && bearer_is_shared(p_bearer))
+            {
+                shared_pdu_retain(m_packet.p_pdu);
+                p_bearer->stats.shared_count++;
+                p_bearer->p_interface->packet_send_shared(p_bearer, m_packet.p_pdu);
+            }
+            else
+            {
+                p_bearer->stats.send_count++;
+                p_bearer->p_interface->packet_send(p_bearer,
+                                                   (m_packet.p_pdu != NULL ? m_packet.p_pdu->packet.pdu
+                                                                           : m_packet.buffer.pdu),
+                                                   m_packet.length);
+            }
         }
     }
     m_packet.bearer_bitmap = 0;
+    if (m_packet.p_pdu != NULL)
+    {
+        core_tx_pdu_release(m_packet.p_pdu);
+        m_packet.p_pdu = NULL;
+    }
+    INSTR_STAGE_END(INSTR_STAGE_CORE_TX, instr_start);
 }
 
 void core_tx_packet_discard(void)
@@ -159,10 +246,16 @@ void core_tx_packet_discard(void)
 
         if (m_packet.bearer_bitmap & (1 << p_bearer->bearer_index))
         {
+            p_bearer->stats.discard_count++;
             p_bearer->p_interface->packet_discard(p_bearer);
         }
     }
     m_packet.bearer_bitmap = 0;
+    if (m_packet.p_pdu != NULL)
+    {
+        core_tx_pdu_release(m_packet.p_pdu);
+        m_packet.p_pdu = NULL;
+    }
 }
 
 core_tx_bearer_type_t core_tx_bearer_type_get(uint32_t bearer_index)
@@ -185,6 +278,26 @@ uint32_t core_tx_bearer_count_get(void)
     return m_bearer_count;
 }
 
+uint32_t core_tx_bearer_stats_get(uint32_t bearer_index, core_tx_bearer_stats_t * p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    LIST_FOREACH(p_iterator, mp_bearers)
+    {
+        core_tx_bearer_t * p_bearer = PARENT_BY_FIELD_GET(core_tx_bearer_t, list_node, p_iterator);
+
+        if (bearer_index == p_bearer->bearer_index)
+        {
+            *p_stats = p_bearer->stats;
+            return NRF_SUCCESS;
+        }
+    }
+    return NRF_ERROR_NOT_FOUND;
+}
+
 void core_tx_complete(core_tx_bearer_t * p_bearer,
                       core_tx_role_t role,
                       uint32_t timestamp,
@@ -214,14 +327,34 @@ void core_tx_bearer_add(core_tx_bearer_t * p_bearer,
     p_bearer->bearer_index = m_bearer_count++;
     p_bearer->type         = type;
 
+    memset(&p_bearer->stats, 0, sizeof(p_bearer->stats));
+
     list_add(&mp_bearers, &p_bearer->list_node);
 }
 
+bool core_tx_packet_is_shared(void)
+{
+    return (m_packet.p_pdu != NULL);
+}
+
+void core_tx_pdu_release(core_tx_pdu_t * p_pdu)
+{
+    NRF_MESH_ASSERT(p_pdu >= &m_pdu_pool[0] && p_pdu < &m_pdu_pool[ARRAY_SIZE(m_pdu_pool)]);
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    NRF_MESH_ASSERT(p_pdu->refcount > 0);
+    p_pdu->refcount--;
+    _ENABLE_IRQS(was_masked);
+}
+
 #ifdef UNIT_TEST
 void core_tx_reset(void)
 {
     mp_bearers = NULL;
     m_bearer_count = 0;
     m_packet.bearer_bitmap = 0;
+    m_packet.p_pdu = NULL;
+    memset(m_pdu_pool, 0, sizeof(m_pdu_pool));
 }
 #endif
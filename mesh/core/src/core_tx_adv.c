@@ -42,6 +42,8 @@
 #include "mesh_opt_core.h"
 #include "mesh_config_entry.h"
 #include "app_util_platform.h"
+#include "instr.h"
+#include "mesh_stats.h"
 
 static struct
 {
@@ -82,8 +84,10 @@ static void adv_tx_complete_callback(advertiser_t * p_adv,
                                      nrf_mesh_tx_token_t token,
                                      timestamp_t timestamp)
 {
+    INSTR_STAGE_BEGIN(instr_start);
     core_tx_role_t role = (core_tx_role_t) (p_adv - &m_bearer_roles[0].advertiser);
     core_tx_complete(&m_bearer, role, timestamp, token);
+    INSTR_STAGE_END(INSTR_STAGE_ADV_TX, instr_start);
 }
 
 static core_tx_alloc_result_t packet_alloc(core_tx_bearer_t * p_bearer, const core_tx_alloc_params_t * p_params)
@@ -91,12 +95,19 @@ static core_tx_alloc_result_t packet_alloc(core_tx_bearer_t * p_bearer, const co
     NRF_MESH_ASSERT(p_bearer == &m_bearer);
     NRF_MESH_ASSERT(m_current_alloc.p_packet == NULL);
 
+    /* Bulk transfer PDUs don't fit in a legacy advertising packet. */
+    if (p_params->net_packet_len > PACKET_MESH_NET_MAX_SIZE)
+    {
+        return CORE_TX_ALLOC_FAIL_REJECTED;
+    }
+
     m_current_alloc.p_packet =
         advertiser_packet_alloc(&m_bearer_roles[p_params->role].advertiser,
                                 sizeof(ble_ad_header_t) + p_params->net_packet_len);
 
     if (m_current_alloc.p_packet == NULL)
     {
+        MESH_STATS_INC(MESH_STATS_ADV_TX_QUEUE_FULL);
         return CORE_TX_ALLOC_FAIL_NO_MEM;
     }
     else
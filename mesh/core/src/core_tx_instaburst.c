@@ -44,6 +44,9 @@
 #include "app_util_platform.h"
 #include "advertiser.h"
 
+/* Bulk transfer network PDUs must fit in a single extended advertising packet. */
+NRF_MESH_STATIC_ASSERT(sizeof(ble_ad_header_t) + sizeof(packet_mesh_net_packet_t) <= ADV_EXT_TX_PAYLOAD_MAXLEN);
+
 static instaburst_tx_t m_instaburst[CORE_TX_ROLE_COUNT];
 
 static struct
@@ -0,0 +1,643 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include "ecc_p256.h"
+#include "nrf_error.h"
+#include "rand.h"
+
+/*****************************************************************************
+* Local defines
+*****************************************************************************/
+#define WORDS               (8)
+#define BITS                (WORDS * 32)
+
+/** Number of bits of the private key combined in each comb table lookup. */
+#define COMB_TEETH          (4)
+/** Distance between the bits combined in each comb table lookup. */
+#define COMB_SPACING        (BITS / COMB_TEETH)
+/** Number of comb tables, each covering its own range of columns. */
+#define COMB_TABLES         (2)
+#define COMB_ENTRIES        ((1 << COMB_TEETH) - 1)
+#define COMB_COLUMNS        (COMB_SPACING / COMB_TABLES)
+
+/** Number of bits of the private key handled in each ECDH window. */
+#define WINDOW_BITS         (4)
+#define WINDOW_ENTRIES      (1 << WINDOW_BITS)
+
+/*****************************************************************************
+* Local typedefs
+*****************************************************************************/
+/** Field element, as little-endian words, fully reduced modulo p. */
+typedef uint32_t fe_t[WORDS];
+
+typedef struct
+{
+    fe_t x;
+    fe_t y;
+} affine_point_t;
+
+/** Point in homogeneous projective coordinates, (x, y) = (X / Z, Y / Z). */
+typedef struct
+{
+    fe_t x;
+    fe_t y;
+    fe_t z;
+} point_t;
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+/* The constants and tables are generated from the curve parameters in SEC 2. */
+static const fe_t m_p  = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF};
+static const fe_t m_n  = {0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF};
+static const fe_t m_b  = {0x27D2604B, 0x3BCE3C3E, 0xCC53B0F6, 0x651D06B0, 0x769886BC, 0xB3EBBD55, 0xAA3A93E7, 0x5AC635D8};
+static const fe_t m_one = {1};
+
+/** Comb tables. Entry j - 1 of table t is the sum of 2^(COMB_SPACING * i + COMB_COLUMNS * t) * G
+ * for each bit i set in j. */
+static const affine_point_t m_comb_table[COMB_TABLES][COMB_ENTRIES] =
+{
+    {
+        {{0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81, 0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2},
+         {0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357, 0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2}},
+        {{0x8E14DB63, 0x90E75CB4, 0xAD651F7E, 0x29493BAA, 0x326E25DE, 0x8492592E, 0x2811AAA5, 0x0FA822BC},
+         {0x5F462EE7, 0xE4112454, 0x50FE82F5, 0x34B1A650, 0xB3DF188B, 0x6F4AD4BC, 0xF5DBA80D, 0xBFF44AE8}},
+        {{0x097992AF, 0x93391CE2, 0x0D35F1FA, 0xE96C98FD, 0x95E02789, 0xB257C0DE, 0x89D6726F, 0x300A4BBC},
+         {0xC08127A0, 0xAA54A291, 0xA9D806A5, 0x5BB1EEAD, 0xFF1E3C6F, 0x7F1DDB25, 0xD09B4644, 0x72AAC7E0}},
+        {{0xD789BD85, 0x57C84FC9, 0xC297EAC3, 0xFC35FF7D, 0x88C6766E, 0xFB982FD5, 0xEEDB5E67, 0x447D739B},
+         {0x72E25B32, 0x0C7E33C9, 0xA7FAE500, 0x3D349B95, 0x3A4AAFF7, 0xE12E9D95, 0x834131EE, 0x2D4825AB}},
+        {{0x2A1D367F, 0x13949C93, 0x1A0A11B7, 0xEF7FBD2B, 0xB91DFC60, 0xDDC6068B, 0x8A9C72FF, 0xEF951932},
+         {0x7376D8A8, 0x196035A7, 0x95CA1740, 0x23183B08, 0x022C219C, 0xC1EE9807, 0x7DBB2C9B, 0x611E9FC3}},
+        {{0x0B57F4BC, 0xCAE2B192, 0xC6C9BC36, 0x2936DF5E, 0xE11238BF, 0x7DEA6482, 0x7B51F5D8, 0x55066379},
+         {0x348A964C, 0x44FFE216, 0xDBDEFBE1, 0x9FB3D576, 0x8D9D50E5, 0x0AFA4001, 0x8AECB851, 0x15716484}},
+        {{0xFC5CDE01, 0xE48ECAFF, 0x0D715F26, 0x7CCD84E7, 0xF43E4391, 0xA2E8F483, 0xB21141EA, 0xEB5D7745},
+         {0x731A3479, 0xCAC917E2, 0x2844B645, 0x85F22CFE, 0x58006CEE, 0x0990E6A1, 0xDBECC17B, 0xEAFD72EB}},
+        {{0x313728BE, 0x6CF20FFB, 0xA3C6B94A, 0x96439591, 0x44315FC5, 0x2736FF83, 0xA7849276, 0xA6D39677},
+         {0xC357F5F4, 0xF2BAB833, 0x2284059B, 0x824A920C, 0x2D27ECDF, 0x66B8BABD, 0x9B0B8816, 0x674F8474}},
+        {{0x677C8A3E, 0x2DF48C04, 0x0203A56B, 0x74E02F08, 0xB8C7FEDB, 0x31855F7D, 0x72C9DDAD, 0x4E769E76},
+         {0xB824BBB0, 0xA4C36165, 0x3B9122A5, 0xFB9AE16F, 0x06947281, 0x1EC00572, 0xDE830663, 0x42B99082}},
+        {{0xDDA868B9, 0x6EF95150, 0x9C0CE131, 0xD1F89E79, 0x08A1C478, 0x7FDC1CA0, 0x1C6CE04D, 0x78878EF6},
+         {0x1FE0D976, 0x9C62B912, 0xBDE08D4F, 0x6ACE570E, 0x12309DEF, 0xDE53142C, 0x7B72C321, 0xB6CB3F5D}},
+        {{0xC31A3573, 0x7F991ED2, 0xD54FB496, 0x5B82DD5B, 0x812FFCAE, 0x595C5220, 0x716B1287, 0x0C88BC4D},
+         {0x5F48ACA8, 0x3A57BF63, 0xDF2564F3, 0x7C8181F4, 0x9C04E6AA, 0x18D1B5B3, 0xF3901DC6, 0xDD5DDEA3}},
+        {{0x3E72AD0C, 0xE96A79FB, 0x42BA792F, 0x43A0A28C, 0x083E49F3, 0xEFE0A423, 0x6B317466, 0x68F344AF},
+         {0x3FB24D4A, 0xCDFE17DB, 0x71F5C626, 0x668BFC22, 0x24D67FF3, 0x604ED93C, 0xF8540A20, 0x31B9C405}},
+        {{0xA2582E7F, 0xD36B4789, 0x4EC39C28, 0x0D1A1014, 0xEDBAD7A0, 0x663C62C3, 0x6F461DB9, 0x4052BF4B},
+         {0x188D25EB, 0x235A27C3, 0x99BFCC5B, 0xE724F339, 0x71D70CC8, 0x862BE6BD, 0x90B0FC61, 0xFECF4D51}},
+        {{0xA1D4CFAC, 0x74346C10, 0x8526A7A4, 0xAFDF5CC0, 0xF62BFF7A, 0x123202A8, 0xC802E41A, 0x1EDDBAE2},
+         {0xD603F844, 0x8FA0AF2D, 0x4C701917, 0x36E06B7E, 0x73DB33A0, 0x0C45F452, 0x560EBCFC, 0x43104D86}},
+        {{0x0D1D78E5, 0x9615B511, 0x25C4744B, 0x66B0DE32, 0x6AAF363A, 0x0A4A46FB, 0x84F7A21C, 0xB48E26B4},
+         {0x21A01B2D, 0x06EBB0F6, 0x8B7B0F98, 0xC004E404, 0xFED6F668, 0x64131BCD, 0x4D4D3DAB, 0xFAC01540}}
+    },
+    {
+        {{0x185A5943, 0x3A5A9E22, 0x5C65DFB6, 0x1AB91936, 0x262C71DA, 0x21656B32, 0xAF22AF89, 0x7FE36B40},
+         {0x699CA101, 0xD50D152C, 0x7B8AF212, 0x74B3D586, 0x07DCA6F1, 0x9F09F404, 0x25B63624, 0xE697D458}},
+        {{0x7512218E, 0xA84AA939, 0x74CA0141, 0xE9A521B0, 0x18A2E902, 0x57880B3A, 0x12A677A6, 0x4A5B5066},
+         {0x4C4F3840, 0x0BEADA7A, 0x19E26D9D, 0x626DB154, 0xE1627D40, 0xC42604FB, 0xEAC089F1, 0xEB13461C}},
+        {{0x27A43281, 0xF9FAED09, 0x4103ECBC, 0x5E52C414, 0xA815C857, 0xC342967A, 0x1C6A220A, 0x0781B829},
+         {0xEAC55F80, 0x5A8343CE, 0xE54A05E3, 0x88F80EEE, 0x12916434, 0x97B2A14F, 0xF0151593, 0x690CDE8D}},
+        {{0xF7F82F2A, 0xAEE9C75D, 0x4AFDF43A, 0x9E4C3587, 0x37371326, 0xF5622DF4, 0x6EC73617, 0x8A535F56},
+         {0x223094B7, 0xC5F9A0AC, 0x4C8C7669, 0xCDE53386, 0x085A92BF, 0x37E02819, 0x68B08BD7, 0x0455C084}},
+        {{0x9477B5D9, 0x0C0A6E2C, 0x876DC444, 0xF9A4BF62, 0xB6CDC279, 0x5050A949, 0xB77F8276, 0x06BADA7A},
+         {0xEA48DAC9, 0xC8B4AED1, 0x7EA1070F, 0xDEBD8A4B, 0x1366EB70, 0x427D4910, 0x0E6CB18A, 0x5B476DFD}},
+        {{0x278C340A, 0x7C5C3E44, 0x12D66F3B, 0x4D546068, 0xAE23C5D8, 0x29A751B1, 0x8A2EC908, 0x3E29864E},
+         {0x26DBB850, 0x142D2A66, 0x765BD780, 0xAD1744C4, 0xE322D1ED, 0x1F150E68, 0x3DC31E7E, 0x239B90EA}},
+        {{0x7A53322A, 0x78C41652, 0x09776F8E, 0x305DDE67, 0xF8862ED4, 0xDBCAB759, 0x49F72FF7, 0x820F4DD9},
+         {0x2B5DEBD4, 0x6CC544A6, 0x7B4E8CC4, 0x75BE5D93, 0x215C14D3, 0x1B481B1B, 0x783A05EC, 0x140406EC}},
+        {{0xE895DF07, 0x6A703F10, 0x01876BD8, 0xFD75F3FA, 0x0CE08FFE, 0xEB5B06E7, 0x2783DFEE, 0x68F6B854},
+         {0x78712655, 0x90C76F8A, 0xF310BF7F, 0xCF5293D2, 0xFDA45028, 0xFBC8044D, 0x92E40CE6, 0xCBE1FEBA}},
+        {{0x4396E4C1, 0xE998CEEA, 0x6ACEA274, 0xFC82EF0B, 0x2250E927, 0x230F729F, 0x2F420109, 0xD0B2F94D},
+         {0xB38D4966, 0x4305ADDD, 0x624C3B45, 0x10B838F8, 0x58954E7A, 0x7DB26366, 0x8B0719E5, 0x97145982}},
+        {{0x23369FC9, 0x4BD6B726, 0x53D0B876, 0x57F2929E, 0xF2340687, 0xC2D5CBA4, 0x4A866ABA, 0x96161000},
+         {0x2E407A5E, 0x49997BCD, 0x92DDCB24, 0x69AB197D, 0x8FE5131C, 0x2CF1F243, 0xCEE75E44, 0x7ACB9FAD}},
+        {{0x23D2D4C0, 0x254E8394, 0x7AEA685B, 0xF57F0C91, 0x6F75AAEA, 0xA60D880F, 0xA333BF5B, 0x24EB9ACC},
+         {0x1CDA5DEA, 0xE3DE4CCB, 0xC51A6B4F, 0xFEEF9341, 0x8BAC4C4D, 0x743125F8, 0xACD079CC, 0x69F891C5}},
+        {{0x702476B5, 0xEEE44B35, 0xE45C2258, 0x7ED031A0, 0xBD6F8514, 0xB422D1E7, 0x5972A107, 0xE51F547C},
+         {0xC9CF343D, 0xA25BCD6F, 0x097C184E, 0x8CA922EE, 0xA9FE9A06, 0xA62F98B3, 0x25BB1387, 0x1C309A2B}},
+        {{0x1967C459, 0x9295DBEB, 0x3472C98E, 0xB0014883, 0x08011828, 0xC5049777, 0xA2C4E503, 0x20B87B8A},
+         {0xE057C277, 0x3063175D, 0x8FE582DD, 0x1BD53933, 0x5F69A044, 0x0D11ADEF, 0x919776BE, 0xF5C6FA49}},
+        {{0x0FD59E11, 0x8C944E76, 0x102FAD5F, 0x3876CBA1, 0xD83FAA56, 0xA454C3FA, 0x332010B9, 0x1ED7D1B9},
+         {0x0024B889, 0xA1011A27, 0xAC0CD344, 0x05E4D0DC, 0xEB6A2A24, 0x52B520F0, 0x3217257A, 0x3A2B03F0}},
+        {{0xDF1D043D, 0xF20FC2AF, 0xB58D5A62, 0xF330240D, 0xA0058C3B, 0xFC7D229C, 0xC78DD9F6, 0x15FEE545},
+         {0x5BC98CDA, 0x501E8288, 0xD046AC04, 0x41EF80E5, 0x461210FB, 0x557D9F49, 0xB8753F81, 0x4AB5B6B2}}
+    }
+};
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+/** Returns 0xFFFFFFFF if a equals b, 0 otherwise. */
+static inline uint32_t mask_eq(uint32_t a, uint32_t b)
+{
+    uint32_t x = a ^ b;
+    return ((x | (0 - x)) >> 31) - 1;
+}
+
+static uint32_t words_add(uint32_t * p_r, const uint32_t * p_a, const uint32_t * p_b)
+{
+    uint64_t carry = 0;
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        uint64_t sum = (uint64_t) p_a[i] + p_b[i] + carry;
+        p_r[i] = (uint32_t) sum;
+        carry = sum >> 32;
+    }
+    return (uint32_t) carry;
+}
+
+static uint32_t words_sub(uint32_t * p_r, const uint32_t * p_a, const uint32_t * p_b)
+{
+    uint64_t borrow = 0;
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        uint64_t diff = (uint64_t) p_a[i] - p_b[i] - borrow;
+        p_r[i] = (uint32_t) diff;
+        borrow = (diff >> 32) & 1;
+    }
+    return (uint32_t) borrow;
+}
+
+/** Sets r to a where the mask is set, without branching. */
+static void words_select(uint32_t * p_r, const uint32_t * p_a, uint32_t mask, uint32_t words)
+{
+    for (uint32_t i = 0; i < words; ++i)
+    {
+        p_r[i] ^= mask & (p_r[i] ^ p_a[i]);
+    }
+}
+
+static bool words_is_zero(const uint32_t * p_a)
+{
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        bits |= p_a[i];
+    }
+    return (bits == 0);
+}
+
+static void words_from_bytes(uint32_t * p_r, const uint8_t * p_bytes)
+{
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        const uint8_t * p_word = &p_bytes[4 * (WORDS - 1 - i)];
+        p_r[i] = ((uint32_t) p_word[0] << 24) | ((uint32_t) p_word[1] << 16) | ((uint32_t) p_word[2] << 8) | p_word[3];
+    }
+}
+
+static void words_to_bytes(uint8_t * p_bytes, const uint32_t * p_a)
+{
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        uint8_t * p_word = &p_bytes[4 * (WORDS - 1 - i)];
+        p_word[0] = p_a[i] >> 24;
+        p_word[1] = p_a[i] >> 16;
+        p_word[2] = p_a[i] >> 8;
+        p_word[3] = p_a[i];
+    }
+}
+
+/** Checks that 0 < k < n. */
+static bool scalar_valid(const uint32_t * p_k)
+{
+    uint32_t diff[WORDS];
+    return !words_is_zero(p_k) && words_sub(diff, p_k, m_n) == 1;
+}
+
+static void fe_add(fe_t r, const fe_t a, const fe_t b)
+{
+    uint32_t diff[WORDS];
+    uint32_t carry = words_add(r, a, b);
+    uint32_t borrow = words_sub(diff, r, m_p);
+    /* Reduce if the sum overflowed, or is at least p. */
+    words_select(r, diff, 0 - (carry | (borrow ^ 1)), WORDS);
+}
+
+static void fe_sub(fe_t r, const fe_t a, const fe_t b)
+{
+    uint32_t sum[WORDS];
+    uint32_t borrow = words_sub(r, a, b);
+    (void) words_add(sum, r, m_p);
+    words_select(r, sum, 0 - borrow, WORDS);
+}
+
+/** r = a * b. The product is reduced with the special form of p, as in FIPS 186-4 appendix D.2. */
+static void fe_mul(fe_t r, const fe_t a, const fe_t b)
+{
+    uint32_t c[2 * WORDS];
+    uint64_t carry = 0;
+    for (uint32_t k = 0; k < 2 * WORDS - 1; ++k)
+    {
+        /* Column sums of up to 8 products don't fit in 64 bits, so carry the overflow separately. */
+        uint64_t sum = carry;
+        uint32_t overflow = 0;
+        for (uint32_t i = (k < WORDS ? 0 : k - WORDS + 1); i <= k && i < WORDS; ++i)
+        {
+            uint64_t product = (uint64_t) a[i] * b[k - i];
+            sum += product;
+            overflow += (sum < product);
+        }
+        c[k] = (uint32_t) sum;
+        carry = (sum >> 32) | ((uint64_t) overflow << 32);
+    }
+    c[2 * WORDS - 1] = (uint32_t) carry;
+
+    int64_t t[WORDS];
+    t[0] = (int64_t) c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+    t[1] = (int64_t) c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+    t[2] = (int64_t) c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+    t[3] = (int64_t) c[3] + 2 * (int64_t) c[11] + 2 * (int64_t) c[12] + c[13] - c[15] - c[8] - c[9];
+    t[4] = (int64_t) c[4] + 2 * (int64_t) c[12] + 2 * (int64_t) c[13] + c[14] - c[9] - c[10];
+    t[5] = (int64_t) c[5] + 2 * (int64_t) c[13] + 2 * (int64_t) c[14] + c[15] - c[10] - c[11];
+    t[6] = (int64_t) c[6] + 3 * (int64_t) c[14] + 2 * (int64_t) c[15] + c[13] - c[8] - c[9];
+    t[7] = (int64_t) c[7] + 3 * (int64_t) c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+
+    /* Propagate the carries, and fold the bits above 2^256 back in with
+     * 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod p). Two folds always leave a value in [0, 2^256). */
+    int64_t top = 0;
+    for (uint32_t round = 0; round < 3; ++round)
+    {
+        t[0] += top;
+        t[3] -= top;
+        t[6] -= top;
+        t[7] += top;
+        for (uint32_t i = 0; i < WORDS - 1; ++i)
+        {
+            t[i + 1] += t[i] >> 32;
+            t[i] &= 0xFFFFFFFF;
+        }
+        top = t[WORDS - 1] >> 32;
+        t[WORDS - 1] &= 0xFFFFFFFF;
+    }
+
+    uint32_t diff[WORDS];
+    for (uint32_t i = 0; i < WORDS; ++i)
+    {
+        r[i] = (uint32_t) t[i];
+    }
+    uint32_t borrow = words_sub(diff, r, m_p);
+    words_select(r, diff, 0 - (borrow ^ 1), WORDS);
+}
+
+/** r = a^-1, as a^(p - 2). The exponent is public, so the branches don't leak anything. */
+static void fe_inv(fe_t r, const fe_t a)
+{
+    fe_t exponent;
+    fe_t result;
+    static const fe_t two = {2};
+    (void) words_sub(exponent, m_p, two);
+    memcpy(result, m_one, sizeof(fe_t));
+    for (int32_t bit = BITS - 1; bit >= 0; --bit)
+    {
+        fe_mul(result, result, result);
+        if ((exponent[bit / 32] >> (bit % 32)) & 1)
+        {
+            fe_mul(result, result, a);
+        }
+    }
+    memcpy(r, result, sizeof(fe_t));
+}
+
+static void point_identity(point_t * p_r)
+{
+    memset(p_r->x, 0, sizeof(fe_t));
+    memcpy(p_r->y, m_one, sizeof(fe_t));
+    memset(p_r->z, 0, sizeof(fe_t));
+}
+
+/* The point formulas are the complete formulas for a = -3 from Renes, Costello and Batina,
+ * "Complete addition formulas for prime order elliptic curves" (2016), algorithms 4, 5 and 6. They
+ * handle the identity and doubling without special cases. */
+
+/** r = p + q */
+static void point_add(point_t * p_r, const point_t * p_p, const point_t * p_q)
+{
+    fe_t t0, t1, t2, t3, t4, x3, y3, z3;
+    fe_mul(t0, p_p->x, p_q->x);
+    fe_mul(t1, p_p->y, p_q->y);
+    fe_mul(t2, p_p->z, p_q->z);
+    fe_add(t3, p_p->x, p_p->y);
+    fe_add(t4, p_q->x, p_q->y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_add(t4, p_p->y, p_p->z);
+    fe_add(x3, p_q->y, p_q->z);
+    fe_mul(t4, t4, x3);
+    fe_add(x3, t1, t2);
+    fe_sub(t4, t4, x3);
+    fe_add(x3, p_p->x, p_p->z);
+    fe_add(y3, p_q->x, p_q->z);
+    fe_mul(x3, x3, y3);
+    fe_add(y3, t0, t2);
+    fe_sub(y3, x3, y3);
+    fe_mul(z3, m_b, t2);
+    fe_sub(x3, y3, z3);
+    fe_add(z3, x3, x3);
+    fe_add(x3, x3, z3);
+    fe_sub(z3, t1, x3);
+    fe_add(x3, t1, x3);
+    fe_mul(y3, m_b, y3);
+    fe_add(t1, t2, t2);
+    fe_add(t2, t1, t2);
+    fe_sub(y3, y3, t2);
+    fe_sub(y3, y3, t0);
+    fe_add(t1, y3, y3);
+    fe_add(y3, t1, y3);
+    fe_add(t1, t0, t0);
+    fe_add(t0, t1, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t1, t4, y3);
+    fe_mul(t2, t0, y3);
+    fe_mul(y3, x3, z3);
+    fe_add(y3, y3, t2);
+    fe_mul(x3, t3, x3);
+    fe_sub(x3, x3, t1);
+    fe_mul(z3, t4, z3);
+    fe_mul(t1, t3, t0);
+    fe_add(z3, z3, t1);
+    memcpy(p_r->x, x3, sizeof(fe_t));
+    memcpy(p_r->y, y3, sizeof(fe_t));
+    memcpy(p_r->z, z3, sizeof(fe_t));
+}
+
+/** r = p + q, where q isn't the identity. */
+static void point_add_affine(point_t * p_r, const point_t * p_p, const affine_point_t * p_q)
+{
+    fe_t t0, t1, t2, t3, t4, x3, y3, z3;
+    fe_mul(t0, p_p->x, p_q->x);
+    fe_mul(t1, p_p->y, p_q->y);
+    fe_add(t3, p_q->x, p_q->y);
+    fe_add(t4, p_p->x, p_p->y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_mul(t4, p_q->y, p_p->z);
+    fe_add(t4, t4, p_p->y);
+    fe_mul(y3, p_q->x, p_p->z);
+    fe_add(y3, y3, p_p->x);
+    fe_mul(z3, m_b, p_p->z);
+    fe_sub(x3, y3, z3);
+    fe_add(z3, x3, x3);
+    fe_add(x3, x3, z3);
+    fe_sub(z3, t1, x3);
+    fe_add(x3, t1, x3);
+    fe_mul(y3, m_b, y3);
+    fe_add(t1, p_p->z, p_p->z);
+    fe_add(t2, t1, p_p->z);
+    fe_sub(y3, y3, t2);
+    fe_sub(y3, y3, t0);
+    fe_add(t1, y3, y3);
+    fe_add(y3, t1, y3);
+    fe_add(t1, t0, t0);
+    fe_add(t0, t1, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t1, t4, y3);
+    fe_mul(t2, t0, y3);
+    fe_mul(y3, x3, z3);
+    fe_add(y3, y3, t2);
+    fe_mul(x3, t3, x3);
+    fe_sub(x3, x3, t1);
+    fe_mul(z3, t4, z3);
+    fe_mul(t1, t3, t0);
+    fe_add(z3, z3, t1);
+    memcpy(p_r->x, x3, sizeof(fe_t));
+    memcpy(p_r->y, y3, sizeof(fe_t));
+    memcpy(p_r->z, z3, sizeof(fe_t));
+}
+
+/** r = 2p */
+static void point_double(point_t * p_r, const point_t * p_p)
+{
+    fe_t t0, t1, t2, t3, x3, y3, z3;
+    fe_mul(t0, p_p->x, p_p->x);
+    fe_mul(t1, p_p->y, p_p->y);
+    fe_mul(t2, p_p->z, p_p->z);
+    fe_mul(t3, p_p->x, p_p->y);
+    fe_add(t3, t3, t3);
+    fe_mul(z3, p_p->x, p_p->z);
+    fe_add(z3, z3, z3);
+    fe_mul(y3, m_b, t2);
+    fe_sub(y3, y3, z3);
+    fe_add(x3, y3, y3);
+    fe_add(y3, x3, y3);
+    fe_sub(x3, t1, y3);
+    fe_add(y3, t1, y3);
+    fe_mul(y3, x3, y3);
+    fe_mul(x3, x3, t3);
+    fe_add(t3, t2, t2);
+    fe_add(t2, t2, t3);
+    fe_mul(z3, m_b, z3);
+    fe_sub(z3, z3, t2);
+    fe_sub(z3, z3, t0);
+    fe_add(t3, z3, z3);
+    fe_add(z3, z3, t3);
+    fe_add(t3, t0, t0);
+    fe_add(t0, t3, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t0, t0, z3);
+    fe_add(y3, y3, t0);
+    fe_mul(t0, p_p->y, p_p->z);
+    fe_add(t0, t0, t0);
+    fe_mul(z3, t0, z3);
+    fe_sub(x3, x3, z3);
+    fe_mul(z3, t0, t1);
+    fe_add(z3, z3, z3);
+    fe_add(z3, z3, z3);
+    memcpy(p_r->x, x3, sizeof(fe_t));
+    memcpy(p_r->y, y3, sizeof(fe_t));
+    memcpy(p_r->z, z3, sizeof(fe_t));
+}
+
+/** Converts a point to affine coordinates. Fails for the identity. */
+static bool point_to_affine(affine_point_t * p_r, const point_t * p_p)
+{
+    fe_t z_inv;
+    fe_inv(z_inv, p_p->z);
+    fe_mul(p_r->x, p_p->x, z_inv);
+    fe_mul(p_r->y, p_p->y, z_inv);
+    return !words_is_zero(p_p->z);
+}
+
+static uint32_t scalar_bit(const uint32_t * p_k, uint32_t bit)
+{
+    return (p_k[bit / 32] >> (bit % 32)) & 1;
+}
+
+/** r = k * G, with the comb tables. */
+static void point_mul_base(point_t * p_r, const uint32_t * p_k)
+{
+    point_identity(p_r);
+    for (int32_t column = COMB_COLUMNS - 1; column >= 0; --column)
+    {
+        point_double(p_r, p_r);
+        for (uint32_t t = 0; t < COMB_TABLES; ++t)
+        {
+            uint32_t index = 0;
+            for (uint32_t i = 0; i < COMB_TEETH; ++i)
+            {
+                index |= scalar_bit(p_k, COMB_SPACING * i + COMB_COLUMNS * t + column) << i;
+            }
+
+            /* Read every entry, and always add, so that the timing doesn't depend on the key. */
+            affine_point_t entry;
+            memset(&entry, 0, sizeof(entry));
+            for (uint32_t j = 0; j < COMB_ENTRIES; ++j)
+            {
+                words_select((uint32_t *) &entry, (const uint32_t *) &m_comb_table[t][j],
+                             mask_eq(index, j + 1), 2 * WORDS);
+            }
+            point_t sum;
+            point_add_affine(&sum, p_r, &entry);
+            words_select((uint32_t *) p_r, (const uint32_t *) &sum, ~mask_eq(index, 0), 3 * WORDS);
+        }
+    }
+}
+
+/** r = k * p, with a fixed window. */
+static void point_mul(point_t * p_r, const affine_point_t * p_p, const uint32_t * p_k)
+{
+    point_t table[WINDOW_ENTRIES];
+    point_identity(&table[0]);
+    memcpy(table[1].x, p_p->x, sizeof(fe_t));
+    memcpy(table[1].y, p_p->y, sizeof(fe_t));
+    memcpy(table[1].z, m_one, sizeof(fe_t));
+    for (uint32_t i = 2; i < WINDOW_ENTRIES; ++i)
+    {
+        point_add_affine(&table[i], &table[i - 1], p_p);
+    }
+
+    point_identity(p_r);
+    for (int32_t window = BITS / WINDOW_BITS - 1; window >= 0; --window)
+    {
+        for (uint32_t i = 0; i < WINDOW_BITS; ++i)
+        {
+            point_double(p_r, p_r);
+        }
+        uint32_t index = (p_k[window * WINDOW_BITS / 32] >> ((window * WINDOW_BITS) % 32)) & (WINDOW_ENTRIES - 1);
+        point_t entry;
+        for (uint32_t j = 0; j < WINDOW_ENTRIES; ++j)
+        {
+            words_select((uint32_t *) &entry, (const uint32_t *) &table[j], mask_eq(index, j), 3 * WORDS);
+        }
+        point_add(p_r, p_r, &entry);
+    }
+}
+
+/** Reads a public key, and checks that it's on the curve. */
+static bool public_key_read(affine_point_t * p_r, const uint8_t * p_public)
+{
+    fe_t diff;
+    words_from_bytes(p_r->x, &p_public[0]);
+    words_from_bytes(p_r->y, &p_public[ECC_P256_PUBLIC_KEY_SIZE / 2]);
+    if (words_sub(diff, p_r->x, m_p) == 0 || words_sub(diff, p_r->y, m_p) == 0)
+    {
+        return false;
+    }
+
+    /* y^2 = x^3 - 3x + b */
+    fe_t lhs, rhs;
+    fe_mul(lhs, p_r->y, p_r->y);
+    fe_mul(rhs, p_r->x, p_r->x);
+    fe_mul(rhs, rhs, p_r->x);
+    fe_sub(rhs, rhs, p_r->x);
+    fe_sub(rhs, rhs, p_r->x);
+    fe_sub(rhs, rhs, p_r->x);
+    fe_add(rhs, rhs, m_b);
+    return (memcmp(lhs, rhs, sizeof(fe_t)) == 0);
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+uint32_t ecc_p256_keys_generate(uint8_t * p_public, uint8_t * p_private)
+{
+    uint32_t status;
+    do
+    {
+        rand_hw_rng_get(p_private, ECC_P256_PRIVATE_KEY_SIZE);
+        status = ecc_p256_public_key_compute(p_private, p_public);
+    } while (status == NRF_ERROR_INVALID_PARAM);
+    return status;
+}
+
+uint32_t ecc_p256_public_key_compute(const uint8_t * p_private, uint8_t * p_public)
+{
+    uint32_t k[WORDS];
+    words_from_bytes(k, p_private);
+    if (!scalar_valid(k))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    point_t r;
+    affine_point_t public_key;
+    point_mul_base(&r, k);
+    (void) point_to_affine(&public_key, &r);
+    words_to_bytes(&p_public[0], public_key.x);
+    words_to_bytes(&p_public[ECC_P256_PUBLIC_KEY_SIZE / 2], public_key.y);
+    return NRF_SUCCESS;
+}
+
+bool ecc_p256_public_key_valid(const uint8_t * p_public)
+{
+    affine_point_t point;
+    return public_key_read(&point, p_public);
+}
+
+uint32_t ecc_p256_shared_secret(const uint8_t * p_public, const uint8_t * p_private, uint8_t * p_secret)
+{
+    uint32_t k[WORDS];
+    affine_point_t peer;
+    words_from_bytes(k, p_private);
+    if (!scalar_valid(k) || !public_key_read(&peer, p_public))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    point_t r;
+    affine_point_t shared;
+    point_mul(&r, &peer, k);
+    if (!point_to_affine(&shared, &r))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    words_to_bytes(p_secret, shared.x);
+    return NRF_SUCCESS;
+}
@@ -34,22 +34,53 @@
  * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <string.h>
 #include <nrf_error.h>
 
 #include "event.h"
 #include "list.h"
+#include "instr.h"
+#include "nrf_mesh_assert.h"
 #include "utils.h"
 
-typedef enum
-{
-    EVENT_HANDLER_IDLE,
-    EVENT_HANDLER_PROCEEDING,
-    EVENT_HANDLER_CLEANING_REQUIRED,
-} event_handler_state_t;
+/*
+ * Events are dispatched through an index of the registered handlers, sorted by event type: the
+ * handlers subscribing to event type N are stored in m_index[m_index_start[N]] up to
+ * m_index[m_index_start[N + 1]], in registration order. The index is rebuilt from the handler list
+ * when handlers are added or removed outside of the dispatch.
+ *
+ * To keep the iteration stable, the index isn't touched while events are being dispatched:
+ * - Handlers removed during the dispatch are only flagged, and get removed from the list and the
+ *   index when the outermost dispatch returns.
+ * - Handlers added during the dispatch are appended to the list, behind the last indexed handler,
+ *   and get the ongoing event after the indexed handlers, like they would in a plain list walk.
+ */
+
+NRF_MESH_STATIC_ASSERT(NRF_MESH_EVT_TYPE_COUNT <= 32);
+NRF_MESH_STATIC_ASSERT(EVENT_HANDLER_INDEX_SIZE <= UINT16_MAX);
 
 /** Linked list of event handlers */
 static list_node_t * mp_evt_handlers_head;
-static event_handler_state_t m_event_handler_state = EVENT_HANDLER_IDLE;
+/** Last handler in the list when the index was built, or NULL if the list was empty. */
+static list_node_t * mp_index_last;
+/** Handlers subscribing to each event type, see the description above. */
+static nrf_mesh_evt_handler_t * m_index[EVENT_HANDLER_INDEX_SIZE];
+static uint16_t m_index_start[NRF_MESH_EVT_TYPE_COUNT + 1];
+/** Whether the index holds all handlers in the list. If not, the whole list is walked. */
+static bool m_index_valid;
+/** Whether handlers have been added behind @ref mp_index_last during the dispatch. */
+static bool m_handlers_added;
+/** Whether handlers have been flagged for removal during the dispatch. */
+static bool m_cleaning_required;
+/** Number of nested event_handle() calls. */
+static uint32_t m_dispatch_depth;
+static event_stats_t m_stats[NRF_MESH_EVT_TYPE_COUNT];
+
+static inline bool is_subscribed(const nrf_mesh_evt_handler_t * p_handler, nrf_mesh_evt_type_t type)
+{
+    return (p_handler->evt_mask == NRF_MESH_EVT_MASK_ALL ||
+            (type < NRF_MESH_EVT_TYPE_COUNT && (p_handler->evt_mask & NRF_MESH_EVT_MASK(type))));
+}
 
 static void event_list_clean(void)
 {
@@ -68,30 +99,123 @@ static void event_list_clean(void)
     }
 }
 
-void event_handle(const nrf_mesh_evt_t * p_evt)
+static void index_build(void)
 {
-    NRF_MESH_ASSERT(p_evt != NULL);
+    uint32_t count = 0;
+    m_index_valid = false;
+    m_handlers_added = false;
+    mp_index_last = NULL;
 
-    if (mp_evt_handlers_head != NULL)
+    for (uint32_t type = 0; type < NRF_MESH_EVT_TYPE_COUNT; ++type)
     {
-        m_event_handler_state = EVENT_HANDLER_PROCEEDING;
+        m_index_start[type] = count;
+        m_stats[type].handler_count = 0;
         LIST_FOREACH(p_node, mp_evt_handlers_head)
         {
             nrf_mesh_evt_handler_t * p_handler = PARENT_BY_FIELD_GET(nrf_mesh_evt_handler_t,
                                                                      node,
                                                                      p_node);
+            if (is_subscribed(p_handler, (nrf_mesh_evt_type_t) type))
+            {
+                if (count < EVENT_HANDLER_INDEX_SIZE)
+                {
+                    m_index[count] = p_handler;
+                }
+                count++;
+                m_stats[type].handler_count++;
+            }
+        }
+    }
+
+    LIST_FOREACH(p_node, mp_evt_handlers_head)
+    {
+        mp_index_last = (list_node_t *) p_node;
+    }
+
+    if (count <= EVENT_HANDLER_INDEX_SIZE)
+    {
+        m_index_start[NRF_MESH_EVT_TYPE_COUNT] = count;
+        m_index_valid = true;
+    }
+}
 
-            if (!p_handler->is_removed)
+static void dispatch_indexed(const nrf_mesh_evt_t * p_evt)
+{
+    for (uint32_t i = m_index_start[p_evt->type]; i < m_index_start[p_evt->type + 1]; ++i)
+    {
+        if (!m_index[i]->is_removed)
+        {
+            m_index[i]->evt_cb(p_evt);
+        }
+    }
+
+    /* Handlers added by the callbacks aren't in the index, but have been appended to the list. */
+    if (m_handlers_added)
+    {
+        const list_node_t * p_first = (mp_index_last == NULL) ? mp_evt_handlers_head : mp_index_last->p_next;
+        LIST_FOREACH(p_node, p_first)
+        {
+            nrf_mesh_evt_handler_t * p_handler = PARENT_BY_FIELD_GET(nrf_mesh_evt_handler_t,
+                                                                     node,
+                                                                     p_node);
+            if (!p_handler->is_removed && is_subscribed(p_handler, p_evt->type))
             {
                 p_handler->evt_cb(p_evt);
             }
         }
+    }
+}
 
-        if (EVENT_HANDLER_CLEANING_REQUIRED == m_event_handler_state)
+static void dispatch_all(const nrf_mesh_evt_t * p_evt)
+{
+    LIST_FOREACH(p_node, mp_evt_handlers_head)
+    {
+        nrf_mesh_evt_handler_t * p_handler = PARENT_BY_FIELD_GET(nrf_mesh_evt_handler_t,
+                                                                 node,
+                                                                 p_node);
+
+        if (!p_handler->is_removed && is_subscribed(p_handler, p_evt->type))
+        {
+            p_handler->evt_cb(p_evt);
+        }
+    }
+}
+
+void event_handle(const nrf_mesh_evt_t * p_evt)
+{
+    NRF_MESH_ASSERT(p_evt != NULL);
+
+#if INSTR_ENABLE
+    uint32_t start = instr_timestamp_get();
+#endif
+
+    m_dispatch_depth++;
+    if (m_index_valid && p_evt->type < NRF_MESH_EVT_TYPE_COUNT)
+    {
+        dispatch_indexed(p_evt);
+    }
+    else
+    {
+        dispatch_all(p_evt);
+    }
+    m_dispatch_depth--;
+
+    if (m_dispatch_depth == 0 && (m_cleaning_required || m_handlers_added))
+    {
+        if (m_cleaning_required)
         {
             event_list_clean();
-            m_event_handler_state = EVENT_HANDLER_IDLE;
+            m_cleaning_required = false;
         }
+        index_build();
+    }
+
+    if (p_evt->type < NRF_MESH_EVT_TYPE_COUNT)
+    {
+        m_stats[p_evt->type].dispatch_count++;
+#if INSTR_ENABLE
+        m_stats[p_evt->type].cycles += instr_timestamp_get() - start;
+#endif
     }
 }
 
@@ -100,18 +224,52 @@ void event_handler_add(nrf_mesh_evt_handler_t * p_handler_params)
     NRF_MESH_ASSERT(p_handler_params != NULL);
     p_handler_params->is_removed = false;
     list_add(&mp_evt_handlers_head, &p_handler_params->node);
+
+    if (m_dispatch_depth > 0)
+    {
+        m_handlers_added = true;
+    }
+    else
+    {
+        index_build();
+    }
 }
 
 void event_handler_remove(nrf_mesh_evt_handler_t * p_handler_params)
 {
     NRF_MESH_ASSERT(p_handler_params != NULL);
-    if (EVENT_HANDLER_PROCEEDING == m_event_handler_state || EVENT_HANDLER_CLEANING_REQUIRED == m_event_handler_state)
+    if (m_dispatch_depth > 0)
     {
-        m_event_handler_state = EVENT_HANDLER_CLEANING_REQUIRED;
+        m_cleaning_required = true;
         p_handler_params->is_removed = true;
     }
     else
     {
         (void) list_remove(&mp_evt_handlers_head, &p_handler_params->node);
+        index_build();
+    }
+}
+
+uint32_t event_stats_get(nrf_mesh_evt_type_t type, event_stats_t * p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (type >= NRF_MESH_EVT_TYPE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    *p_stats = m_stats[type];
+    return NRF_SUCCESS;
+}
+
+void event_stats_clear(void)
+{
+    for (uint32_t type = 0; type < NRF_MESH_EVT_TYPE_COUNT; ++type)
+    {
+        m_stats[type].dispatch_count = 0;
+        m_stats[type].cycles = 0;
     }
 }
@@ -46,10 +46,11 @@
 #define FSM_INVALID_INDEX   0xFF
 
 static void fsm_any_state_find(fsm_t * p_fsm);
+static uint8_t fsm_state_index_find(const fsm_const_descriptor_t * p_fsm_const, fsm_state_id_t state_id);
 static bool fsm_event_post_try(fsm_t * p_fsm,
                                fsm_event_id_t event_id,
                                void * p_data,
-                               uint8_t start_table_idx);
+                               uint8_t state_table_idx);
 static bool fsm_transition_perform_try(fsm_t * p_fsm,
                                        const fsm_transition_t * p_transition,
                                        void * p_data);
@@ -85,7 +86,7 @@ static void fsm_any_state_find(fsm_t * p_fsm)
 
     if (found_idx != FSM_INVALID_INDEX)
     {
-        if (found_idx >= p_fsm_const->transitions_count)
+        if (found_idx + 1 >= p_fsm_const->transitions_count)
         {
             // Empty state declaration block (without transitions).
             // This is allowed for convenience.
@@ -96,40 +97,76 @@ static void fsm_any_state_find(fsm_t * p_fsm)
 }
 
 
-static bool fsm_event_post_try(fsm_t * p_fsm,
-                               fsm_event_id_t event_id,
-                               void * p_data,
-                               uint8_t start_table_idx)
+static uint8_t fsm_state_index_find(const fsm_const_descriptor_t * p_fsm_const, fsm_state_id_t state_id)
 {
-    const fsm_const_descriptor_t * p_fsm_const;
-    const fsm_transition_t * p_transition_table;
-    const fsm_transition_t * p_transition_table_end;
-    const fsm_transition_t * p_transition;
-    fsm_state_id_t           current_state;
+    const fsm_transition_t * p_transition_table = p_fsm_const->transition_table;
 
-    current_state = p_fsm->current_state;
-    p_fsm_const = p_fsm->fsm_const_desc;
-    p_transition_table = p_fsm_const->transition_table;
-    p_transition_table_end = p_transition_table + p_fsm_const->transitions_count;
+    for (uint8_t i = 0; i < p_fsm_const->transitions_count; i++)
+    {
+        if ((p_transition_table[i].event_id ^ FSM_STATE_FLAG) == state_id)
+        {
+            return i;
+        }
+    }
+    return FSM_INVALID_INDEX;
+}
 
-    if (start_table_idx == 0 && p_fsm->any_state_transitions_index != 0)
+
+static void fsm_state_index_table_build(const fsm_const_descriptor_t * p_fsm_const)
+{
+    for (fsm_state_id_t state = 0; state < p_fsm_const->states_count; state++)
+    {
+        p_fsm_const->state_index_table[state] = fsm_state_index_find(p_fsm_const, state);
+    }
+
+    // All declared states must fit in the table.
+    for (uint8_t i = 0; i < p_fsm_const->transitions_count; i++)
     {
-        // look for the beginning of the current state's transitions
-        for (p_transition = p_transition_table; p_transition < p_transition_table_end; p_transition++)
+        fsm_event_id_t event_id = p_fsm_const->transition_table[i].event_id;
+        if (event_id != FSM_ANY_STATE && (event_id & FSM_STATE_FLAG))
         {
-            if ((p_transition->event_id ^ FSM_STATE_FLAG) == current_state)
-            {
-                break;
-            }
+            NRF_MESH_ASSERT((event_id ^ FSM_STATE_FLAG) < p_fsm_const->states_count);
         }
     }
+}
+
+
+static inline uint8_t fsm_state_index_get(const fsm_const_descriptor_t * p_fsm_const, fsm_state_id_t state_id)
+{
+    if (p_fsm_const->state_index_table != NULL)
+    {
+        NRF_MESH_ASSERT(state_id < p_fsm_const->states_count);
+        return p_fsm_const->state_index_table[state_id];
+    }
     else
     {
-        p_transition = p_transition_table + start_table_idx;
+        return fsm_state_index_find(p_fsm_const, state_id);
     }
+}
+
+
+static bool fsm_event_post_try(fsm_t * p_fsm,
+                               fsm_event_id_t event_id,
+                               void * p_data,
+                               uint8_t state_table_idx)
+{
+    const fsm_const_descriptor_t * p_fsm_const;
+    const fsm_transition_t * p_transition_table_end;
+    const fsm_transition_t * p_transition;
 
-    // continue lookup - look for the occurred event in the current state's transitions
-    for (p_transition++; p_transition < p_transition_table_end; p_transition++)
+    if (state_table_idx == FSM_INVALID_INDEX)
+    {
+        // the state has no transitions
+        return false;
+    }
+
+    p_fsm_const = p_fsm->fsm_const_desc;
+    p_transition_table_end = p_fsm_const->transition_table + p_fsm_const->transitions_count;
+
+    // look for the occurred event in the given state's transitions
+    for (p_transition = p_fsm_const->transition_table + state_table_idx + 1;
+         p_transition < p_transition_table_end;
+         p_transition++)
     {
         // check this transition is for the given event
         if (p_transition->event_id == event_id)
@@ -202,7 +239,11 @@ static bool fsm_transition_perform_try(fsm_t * p_fsm,
 #endif
 
         // switch to the new state
-        p_fsm->current_state = p_transition->new_state_id;
+        if (p_fsm->current_state != p_transition->new_state_id)
+        {
+            p_fsm->current_state_index = fsm_state_index_get(p_fsm->fsm_const_desc, p_transition->new_state_id);
+            p_fsm->current_state = p_transition->new_state_id;
+        }
     }
 
     // transition has been done
@@ -222,7 +263,13 @@ void fsm_init(fsm_t * p_fsm, const fsm_const_descriptor_t * p_fsm_const)
     __LOG(LOG_SRC_FSM, LOG_LEVEL_INFO, "%s: init\n", p_fsm->fsm_const_desc->fsm_name);
 #endif
 
+    if (p_fsm_const->state_index_table != NULL)
+    {
+        fsm_state_index_table_build(p_fsm_const);
+    }
+
     fsm_any_state_find(p_fsm);
+    p_fsm->current_state_index = fsm_state_index_get(p_fsm_const, p_fsm->current_state);
 }
 
 void fsm_event_post(fsm_t * p_fsm, fsm_event_id_t event_id, void * p_data)
@@ -235,12 +282,9 @@ void fsm_event_post(fsm_t * p_fsm, fsm_event_id_t event_id, void * p_data)
 
     p_fsm->recursion_protection++;
 
-    if (!fsm_event_post_try(p_fsm, event_id, p_data, 0))
+    if (!fsm_event_post_try(p_fsm, event_id, p_data, p_fsm->current_state_index))
     {
-        if (p_fsm->any_state_transitions_index != FSM_INVALID_INDEX)
-        {
-            (void) fsm_event_post_try(p_fsm, event_id, p_data, p_fsm->any_state_transitions_index);
-        }
+        (void) fsm_event_post_try(p_fsm, event_id, p_data, p_fsm->any_state_transitions_index);
     }
 
     p_fsm->recursion_protection--;
@@ -60,6 +60,7 @@
 #include "mesh_opt_core.h"
 #include "mesh_config_listener.h"
 #include "mesh_config_entry.h"
+#include "heartbeat_collector.h"
 #if GATT_PROXY
 #include "mesh_opt_gatt.h"
 #endif
@@ -156,6 +157,19 @@ static void heartbeat_restart_publication(void)
 static void heartbeat_opcode_handle(const transport_control_packet_t * p_control_packet,
                                     const nrf_mesh_rx_metadata_t *     p_rx_metadata)
 {
+#if HEARTBEAT_COLLECTOR_ENABLE
+    if ((p_control_packet->opcode == TRANSPORT_CONTROL_OPCODE_HEARTBEAT) &&
+        (p_control_packet->data_len == PACKET_MESH_TRS_CONTROL_HEARTBEAT_SIZE))
+    {
+        /* The collector tracks all sources, independent of the subscription state. */
+        uint8_t hops = packet_mesh_trs_control_heartbeat_init_ttl_get(p_control_packet->p_data) -
+                       p_control_packet->ttl + 1;
+        uint16_t features = packet_mesh_trs_control_heartbeat_features_get(p_control_packet->p_data) &
+                            HEARTBEAT_TRIGGER_TYPE_RFU_MASK;
+        heartbeat_collector_rx(p_control_packet->src, hops, features, p_rx_metadata);
+    }
+#endif
+
     if ((p_control_packet->opcode != TRANSPORT_CONTROL_OPCODE_HEARTBEAT) ||
         (p_control_packet->src != m_heartbeat_subscription.src) ||
         (p_control_packet->dst.value != m_heartbeat_subscription.dst) ||
@@ -456,6 +470,9 @@ void heartbeat_init(void)
     m_subscription_timer.interval  = SEC_TO_US(HEARTBEAT_SUBSCRIPTION_TIMER_GRANULARITY_S);
 
     m_hb_core_evt_handler.evt_cb = heartbeat_core_evt_cb;
+    m_hb_core_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE);
+
+    heartbeat_collector_init();
 
     m_heartbeat_init_done = true;
 }
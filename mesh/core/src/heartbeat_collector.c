@@ -0,0 +1,302 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "heartbeat_collector.h"
+
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "utils.h"
+#include "nordic_common.h"
+
+#if HEARTBEAT_COLLECTOR_ENABLE
+
+NRF_MESH_STATIC_ASSERT(HEARTBEAT_COLLECTOR_ENTRIES > 0 && HEARTBEAT_COLLECTOR_ENTRIES <= UINT16_MAX);
+
+/* The seconds clock is advanced whenever it's read, and at least once per interval, which must be
+ * well within the wrap-around time of the microsecond timer. */
+#define CLOCK_UPDATE_INTERVAL_S (1800)
+
+#define RSSI_AVG_SCALE (1 << HEARTBEAT_COLLECTOR_RSSI_AVG_SHIFT)
+
+typedef struct
+{
+    uint16_t src;
+    uint16_t count;
+    uint32_t last_seen_s;
+    uint16_t features;
+    uint8_t min_hops;
+    uint8_t max_hops;
+    uint8_t last_hops;
+    int8_t rssi_last;
+    int8_t rssi_min;
+    int8_t rssi_max;
+    /** RSSI average, scaled by @c RSSI_AVG_SCALE to keep the fraction. */
+    int16_t rssi_avg_scaled;
+    uint16_t rssi_count;
+} entry_t;
+
+/* The entries are kept sorted by source address, so lookups are binary searches. Inserting or
+ * evicting moves the entries above it, which is cheap for a table of this size compared to the
+ * processing of the heartbeat itself. */
+static entry_t m_entries[HEARTBEAT_COLLECTOR_ENTRIES];
+static uint16_t m_count;
+static heartbeat_collector_stats_t m_stats;
+
+static uint32_t m_clock_s;
+static timestamp_t m_clock_ref;
+static timer_event_t m_clock_timer;
+
+static uint32_t clock_get(void)
+{
+    uint32_t elapsed_s = (timer_now() - m_clock_ref) / SEC_TO_US(1);
+    m_clock_s += elapsed_s;
+    m_clock_ref += SEC_TO_US(elapsed_s);
+    return m_clock_s;
+}
+
+static void clock_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    (void) clock_get();
+}
+
+/* Gets the index of the entry for the given source, or the index it should be inserted at. */
+static uint16_t entry_search(uint16_t src, bool * p_found)
+{
+    uint16_t low = 0;
+    uint16_t high = m_count;
+    while (low < high)
+    {
+        uint16_t mid = low + (high - low) / 2;
+        if (m_entries[mid].src < src)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    *p_found = (low < m_count && m_entries[low].src == src);
+    return low;
+}
+
+static void entry_remove(uint16_t index)
+{
+    memmove(&m_entries[index], &m_entries[index + 1], (m_count - index - 1) * sizeof(entry_t));
+    m_count--;
+}
+
+static void oldest_evict(void)
+{
+    uint16_t oldest = 0;
+    for (uint16_t i = 1; i < m_count; i++)
+    {
+        /* The ages are compared rather than the timestamps, in case the seconds clock wrapped. */
+        if ((uint32_t) (m_clock_s - m_entries[i].last_seen_s) >
+            (uint32_t) (m_clock_s - m_entries[oldest].last_seen_s))
+        {
+            oldest = i;
+        }
+    }
+    entry_remove(oldest);
+    m_stats.evicted++;
+}
+
+static entry_t * entry_add(uint16_t src)
+{
+    bool found;
+    uint16_t index = entry_search(src, &found);
+    if (found)
+    {
+        return &m_entries[index];
+    }
+
+    if (m_count == HEARTBEAT_COLLECTOR_ENTRIES)
+    {
+        oldest_evict();
+        index = entry_search(src, &found);
+    }
+
+    memmove(&m_entries[index + 1], &m_entries[index], (m_count - index) * sizeof(entry_t));
+    m_count++;
+
+    entry_t * p_entry = &m_entries[index];
+    memset(p_entry, 0, sizeof(entry_t));
+    p_entry->src = src;
+    p_entry->min_hops = UINT8_MAX;
+    return p_entry;
+}
+
+static bool rssi_get(const nrf_mesh_rx_metadata_t * p_rx_metadata, int8_t * p_rssi)
+{
+    switch (p_rx_metadata->source)
+    {
+        case NRF_MESH_RX_SOURCE_SCANNER:
+            *p_rssi = p_rx_metadata->params.scanner.rssi;
+            return true;
+        case NRF_MESH_RX_SOURCE_INSTABURST:
+            *p_rssi = p_rx_metadata->params.instaburst.rssi;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void rssi_add(entry_t * p_entry, int8_t rssi)
+{
+    if (p_entry->rssi_count == 0)
+    {
+        p_entry->rssi_min = rssi;
+        p_entry->rssi_max = rssi;
+        p_entry->rssi_avg_scaled = rssi * RSSI_AVG_SCALE;
+    }
+    else
+    {
+        p_entry->rssi_min = MIN(p_entry->rssi_min, rssi);
+        p_entry->rssi_max = MAX(p_entry->rssi_max, rssi);
+        p_entry->rssi_avg_scaled += rssi - p_entry->rssi_avg_scaled / RSSI_AVG_SCALE;
+    }
+    p_entry->rssi_last = rssi;
+
+    if (p_entry->rssi_count < UINT16_MAX)
+    {
+        p_entry->rssi_count++;
+    }
+}
+
+static void entry_copy(heartbeat_collector_entry_t * p_dst, const entry_t * p_src)
+{
+    p_dst->src = p_src->src;
+    p_dst->count = p_src->count;
+    p_dst->age_s = clock_get() - p_src->last_seen_s;
+    p_dst->features = p_src->features;
+    p_dst->min_hops = p_src->min_hops;
+    p_dst->max_hops = p_src->max_hops;
+    p_dst->last_hops = p_src->last_hops;
+    p_dst->rssi_last = p_src->rssi_last;
+    p_dst->rssi_min = p_src->rssi_min;
+    p_dst->rssi_max = p_src->rssi_max;
+    p_dst->rssi_avg = p_src->rssi_avg_scaled / RSSI_AVG_SCALE;
+    p_dst->rssi_count = p_src->rssi_count;
+}
+
+void heartbeat_collector_init(void)
+{
+    m_count = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    m_clock_s = 0;
+    m_clock_ref = timer_now();
+    m_clock_timer.cb = clock_timer_cb;
+    m_clock_timer.interval = SEC_TO_US(CLOCK_UPDATE_INTERVAL_S);
+    timer_sch_reschedule(&m_clock_timer, m_clock_ref + m_clock_timer.interval);
+}
+
+void heartbeat_collector_rx(uint16_t src,
+                            uint8_t hops,
+                            uint16_t features,
+                            const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    NRF_MESH_ASSERT(p_rx_metadata != NULL);
+
+    entry_t * p_entry = entry_add(src);
+    if (p_entry->count < UINT16_MAX)
+    {
+        p_entry->count++;
+    }
+    p_entry->last_seen_s = clock_get();
+    p_entry->features = features;
+    p_entry->min_hops = MIN(p_entry->min_hops, hops);
+    p_entry->max_hops = MAX(p_entry->max_hops, hops);
+    p_entry->last_hops = hops;
+
+    int8_t rssi;
+    if (rssi_get(p_rx_metadata, &rssi))
+    {
+        rssi_add(p_entry, rssi);
+    }
+
+    m_stats.received++;
+}
+
+uint16_t heartbeat_collector_count_get(void)
+{
+    return m_count;
+}
+
+uint32_t heartbeat_collector_entry_get(uint16_t index, heartbeat_collector_entry_t * p_entry)
+{
+    NRF_MESH_ASSERT(p_entry != NULL);
+    if (index >= m_count)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    entry_copy(p_entry, &m_entries[index]);
+    return NRF_SUCCESS;
+}
+
+uint32_t heartbeat_collector_lookup(uint16_t src, heartbeat_collector_entry_t * p_entry)
+{
+    NRF_MESH_ASSERT(p_entry != NULL);
+    bool found;
+    uint16_t index = entry_search(src, &found);
+    if (!found)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    entry_copy(p_entry, &m_entries[index]);
+    return NRF_SUCCESS;
+}
+
+void heartbeat_collector_clear(void)
+{
+    m_count = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+const heartbeat_collector_stats_t * heartbeat_collector_stats_get(void)
+{
+    return &m_stats;
+}
+
+#endif /* HEARTBEAT_COLLECTOR_ENABLE */
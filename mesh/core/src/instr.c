@@ -0,0 +1,156 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "instr.h"
+
+#include <string.h>
+#include <nrf_error.h>
+
+#include "nrf_mesh_assert.h"
+#include "toolchain.h"
+#include "utils.h"
+
+#if INSTR_ENABLE
+
+#if !defined(HOST) && defined(NRF51)
+#error "Instrumentation requires the DWT cycle counter, which is not available on nRF51."
+#endif
+
+NRF_MESH_STATIC_ASSERT(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX - NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX ==
+                       INSTR_STAGE_ADV_TX - INSTR_STAGE_SCANNER_RX);
+
+static instr_histogram_t m_histograms[INSTR_STAGE_COUNT];
+
+void instr_init(void)
+{
+#if !defined(HOST)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    instr_clear();
+}
+
+void instr_stage_record(instr_stage_t stage, uint32_t start)
+{
+    NRF_MESH_ASSERT(stage < INSTR_STAGE_COUNT);
+
+    /* Unsigned arithmetic handles wrapping of the counter. */
+    uint32_t duration = instr_timestamp_get() - start;
+    uint32_t bucket = MIN(log2_get(duration), INSTR_HISTOGRAM_BUCKET_COUNT - 1);
+    instr_histogram_t * p_histogram = &m_histograms[stage];
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    p_histogram->count++;
+    p_histogram->total += duration;
+    if (duration > p_histogram->max)
+    {
+        p_histogram->max = duration;
+    }
+    p_histogram->buckets[bucket]++;
+    _ENABLE_IRQS(was_masked);
+}
+
+const instr_histogram_t * instr_histogram_get(instr_stage_t stage)
+{
+    if (stage >= INSTR_STAGE_COUNT)
+    {
+        return NULL;
+    }
+    return &m_histograms[stage];
+}
+
+void instr_clear(void)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memset(m_histograms, 0, sizeof(m_histograms));
+    _ENABLE_IRQS(was_masked);
+}
+
+#endif /* INSTR_ENABLE */
+
+uint32_t instr_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt)
+{
+#if INSTR_ENABLE
+    if (p_opt == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (id != NRF_MESH_OPT_INSTR_CLEAR)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    instr_clear();
+    return NRF_SUCCESS;
+#else
+    return NRF_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t instr_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * p_opt)
+{
+#if INSTR_ENABLE
+    if (p_opt == NULL || p_opt->opt.p_array == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (id < NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX || id > NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    if (p_opt->len < sizeof(instr_histogram_t))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    instr_stage_t stage = (instr_stage_t) (id - NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX);
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memcpy(p_opt->opt.p_array, &m_histograms[stage], sizeof(instr_histogram_t));
+    _ENABLE_IRQS(was_masked);
+    p_opt->len = sizeof(instr_histogram_t);
+    return NRF_SUCCESS;
+#else
+    return NRF_ERROR_NOT_SUPPORTED;
+#endif
+}
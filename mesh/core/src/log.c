@@ -42,6 +42,13 @@
 #if defined(HOST)
 #include <stdio.h>
 #endif
+#if LOG_DEFERRED_ENABLE
+#include <stdbool.h>
+#include <string.h>
+#include "nrf_mesh_assert.h"
+#include "toolchain.h"
+#include "utils.h"
+#endif
 
 #if NRF_MESH_LOG_ENABLE
 
@@ -83,12 +90,375 @@ void log_callback_stdout(uint32_t dbg_level, const char * p_filename, uint16_t l
 }
 #endif
 
+#if LOG_DEFERRED_ENABLE
+#define DEFERRED_BUFFER_WORDS   (LOG_DEFERRED_BUFFER_SIZE / sizeof(uint32_t))
+#define DEFERRED_HEADER_WORDS   (sizeof(log_deferred_header_t) / sizeof(uint32_t))
+#define DEFERRED_ARGS_WORDS_MAX (LOG_DEFERRED_ARGS_SIZE_MAX / sizeof(uint32_t))
+
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(LOG_DEFERRED_BUFFER_SIZE));
+NRF_MESH_STATIC_ASSERT(sizeof(log_deferred_header_t) == 16);
+NRF_MESH_STATIC_ASSERT(LOG_DEFERRED_ARGS_SIZE_MAX % sizeof(uint32_t) == 0);
+NRF_MESH_STATIC_ASSERT(DEFERRED_ARGS_WORDS_MAX <= UINT8_MAX);
+NRF_MESH_STATIC_ASSERT(DEFERRED_HEADER_WORDS + DEFERRED_ARGS_WORDS_MAX <= DEFERRED_BUFFER_WORDS);
+
+typedef struct
+{
+    log_deferred_header_t header;
+    uint32_t args[DEFERRED_ARGS_WORDS_MAX];
+} deferred_record_t;
+
+/* Ring buffer of records. The indexes count words, and wrap around naturally. */
+static uint32_t m_deferred_buffer[DEFERRED_BUFFER_WORDS];
+static uint32_t m_deferred_head;
+static uint32_t m_deferred_tail;
+static log_deferred_stats_t m_deferred_stats;
+
+static bool deferred_args_put(deferred_record_t * p_record, const void * p_data, uint32_t size)
+{
+    if (size == 0)
+    {
+        return true;
+    }
+
+    uint32_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    if (p_record->header.args_length + words > DEFERRED_ARGS_WORDS_MAX)
+    {
+        p_record->header.flags_level |= LOG_DEFERRED_FLAG_TRUNCATED;
+        return false;
+    }
+    uint32_t * p_dst = &p_record->args[p_record->header.args_length];
+    p_dst[words - 1] = 0;
+    memcpy(p_dst, p_data, size);
+    p_record->header.args_length += words;
+    return true;
+}
+
+static bool deferred_bytes_put(deferred_record_t * p_record, const uint8_t * p_data, uint32_t length)
+{
+    /* Leave room for the length word, and cut the data to fit. */
+    uint32_t space = (DEFERRED_ARGS_WORDS_MAX - p_record->header.args_length) * sizeof(uint32_t);
+    if (space < sizeof(uint32_t))
+    {
+        p_record->header.flags_level |= LOG_DEFERRED_FLAG_TRUNCATED;
+        return false;
+    }
+    space -= sizeof(uint32_t);
+    if (length > space)
+    {
+        length = space;
+        p_record->header.flags_level |= LOG_DEFERRED_FLAG_TRUNCATED;
+    }
+    (void) deferred_args_put(p_record, &length, sizeof(length));
+    (void) deferred_args_put(p_record, p_data, length);
+    return true;
+}
+
+/* Stores the arguments in the record, by walking through the conversion specifications of the
+ * format string. Only the argument sizes matter here, the host decoder does the actual formatting. */
+static void deferred_args_store(deferred_record_t * p_record, const char * p_format, va_list arguments)
+{
+    bool room = true;
+    while (room && *p_format != '\0')
+    {
+        if (*p_format++ != '%')
+        {
+            continue;
+        }
+
+        /* Flags */
+        while (*p_format != '\0' && strchr("-+ #0", *p_format) != NULL)
+        {
+            p_format++;
+        }
+
+        /* Field width and precision */
+        for (uint32_t i = 0; i < 2 && room; ++i)
+        {
+            if (i == 1)
+            {
+                if (*p_format != '.')
+                {
+                    break;
+                }
+                p_format++;
+            }
+
+            if (*p_format == '*')
+            {
+                int value = va_arg(arguments, int);
+                room = deferred_args_put(p_record, &value, sizeof(value));
+                p_format++;
+            }
+            else
+            {
+                while (*p_format >= '0' && *p_format <= '9')
+                {
+                    p_format++;
+                }
+            }
+        }
+
+        /* Length modifier */
+        uint32_t size = sizeof(int);
+        bool long_double = false;
+        switch (*p_format)
+        {
+            case 'h':
+                p_format += (p_format[1] == 'h') ? 2 : 1;
+                break;
+            case 'l':
+                if (p_format[1] == 'l')
+                {
+                    size = sizeof(long long);
+                    p_format++;
+                }
+                else
+                {
+                    size = sizeof(long);
+                }
+                p_format++;
+                break;
+            case 'j':
+                size = sizeof(intmax_t);
+                p_format++;
+                break;
+            case 'z':
+            case 't':
+                size = sizeof(size_t);
+                p_format++;
+                break;
+            case 'L':
+                long_double = true;
+                p_format++;
+                break;
+            default:
+                break;
+        }
+
+        if (!room)
+        {
+            break;
+        }
+
+        switch (*p_format)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                if (size == sizeof(long long))
+                {
+                    long long value = va_arg(arguments, long long);
+                    room = deferred_args_put(p_record, &value, sizeof(value));
+                }
+                else if (size == sizeof(long))
+                {
+                    long value = va_arg(arguments, long);
+                    room = deferred_args_put(p_record, &value, sizeof(value));
+                }
+                else
+                {
+                    int value = va_arg(arguments, int);
+                    room = deferred_args_put(p_record, &value, sizeof(value));
+                }
+                break;
+            case 'p':
+            {
+                void * p_value = va_arg(arguments, void *);
+                room = deferred_args_put(p_record, &p_value, sizeof(p_value));
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                /* The decoder reads all floating point arguments as double. */
+                double value = long_double ? (double) va_arg(arguments, long double)
+                                           : va_arg(arguments, double);
+                room = deferred_args_put(p_record, &value, sizeof(value));
+                break;
+            }
+            case 's':
+            {
+                const char * p_str = va_arg(arguments, const char *);
+                if (p_str == NULL)
+                {
+                    /* Same as the formatting callbacks print. */
+                    p_str = "(null)";
+                }
+                room = deferred_bytes_put(p_record, (const uint8_t *) p_str, strlen(p_str));
+                break;
+            }
+            case 'n':
+                (void) va_arg(arguments, void *);
+                break;
+            case '\0':
+                return;
+            default:
+                /* %% or an unknown conversion, no argument. */
+                break;
+        }
+        p_format++;
+    }
+}
+
+static void deferred_record_commit(const deferred_record_t * p_record)
+{
+    const uint32_t * p_words = (const uint32_t *) p_record;
+    uint32_t length = DEFERRED_HEADER_WORDS + p_record->header.args_length;
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (m_deferred_head - m_deferred_tail + length > DEFERRED_BUFFER_WORDS)
+    {
+        m_deferred_stats.records_dropped++;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            m_deferred_buffer[(m_deferred_head + i) & (DEFERRED_BUFFER_WORDS - 1)] = p_words[i];
+        }
+        m_deferred_head += length;
+        m_deferred_stats.records_written++;
+        if (p_record->header.flags_level & LOG_DEFERRED_FLAG_TRUNCATED)
+        {
+            m_deferred_stats.records_truncated++;
+        }
+    }
+    _ENABLE_IRQS(was_masked);
+}
+
+static void deferred_header_set(deferred_record_t * p_record, uint32_t dbg_level,
+    const char * p_filename, uint16_t line, uint32_t timestamp, const char * p_format)
+{
+    /* The decoder looks the strings up in the 32-bit target image. */
+    p_record->header.format = (uint32_t) (uintptr_t) p_format;
+    p_record->header.filename = (uint32_t) (uintptr_t) p_filename;
+    p_record->header.timestamp = timestamp;
+    p_record->header.line = line;
+    p_record->header.flags_level = dbg_level & LOG_DEFERRED_LEVEL_MASK;
+    p_record->header.args_length = 0;
+}
+
+/* Copies the record at the tail of the buffer, returns its length in words, or 0 if the buffer is
+ * empty. Must be called with interrupts disabled. */
+static uint32_t deferred_record_peek(deferred_record_t * p_record)
+{
+    if (m_deferred_head == m_deferred_tail)
+    {
+        return 0;
+    }
+
+    uint32_t * p_words = (uint32_t *) p_record;
+    for (uint32_t i = 0; i < DEFERRED_HEADER_WORDS; ++i)
+    {
+        p_words[i] = m_deferred_buffer[(m_deferred_tail + i) & (DEFERRED_BUFFER_WORDS - 1)];
+    }
+    uint32_t length = DEFERRED_HEADER_WORDS + p_record->header.args_length;
+    NRF_MESH_ASSERT(m_deferred_head - m_deferred_tail >= length);
+    for (uint32_t i = DEFERRED_HEADER_WORDS; i < length; ++i)
+    {
+        p_words[i] = m_deferred_buffer[(m_deferred_tail + i) & (DEFERRED_BUFFER_WORDS - 1)];
+    }
+    return length;
+}
+
+void log_callback_deferred(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * format, va_list arguments)
+{
+    deferred_record_t record;
+    deferred_header_set(&record, dbg_level, p_filename, line, timestamp, format);
+    deferred_args_store(&record, format, arguments);
+    deferred_record_commit(&record);
+}
+
+void log_array_printf(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * p_msg, const uint8_t * p_array, uint32_t array_len)
+{
+    if (m_log_callback == log_callback_deferred)
+    {
+        deferred_record_t record;
+        deferred_header_set(&record, dbg_level, p_filename, line, timestamp, p_msg);
+        record.header.flags_level |= LOG_DEFERRED_FLAG_ARRAY;
+        (void) deferred_bytes_put(&record, p_array, array_len);
+        deferred_record_commit(&record);
+    }
+    else
+    {
+        char array_text[array_len * 2 + 1];
+        for (uint32_t i = 0; i < array_len; ++i)
+        {
+            array_text[i * 2] = g_log_hex_digits[(p_array[i] >> 4) & 0xf];
+            array_text[i * 2 + 1] = g_log_hex_digits[p_array[i] & 0xf];
+        }
+        array_text[array_len * 2] = 0;
+        log_printf(dbg_level, p_filename, line, timestamp, "%s: %s\n", p_msg, array_text);
+    }
+}
+
+uint32_t log_deferred_read(uint8_t * p_buffer, uint32_t length)
+{
+    uint32_t bytes_read = 0;
+    deferred_record_t record;
+    uint32_t record_length;
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    while ((record_length = deferred_record_peek(&record)) != 0 &&
+           bytes_read + record_length * sizeof(uint32_t) <= length)
+    {
+        memcpy(&p_buffer[bytes_read], &record, record_length * sizeof(uint32_t));
+        bytes_read += record_length * sizeof(uint32_t);
+        m_deferred_tail += record_length;
+    }
+    _ENABLE_IRQS(was_masked);
+    return bytes_read;
+}
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+void log_deferred_flush_rtt(void)
+{
+    deferred_record_t record;
+    uint32_t record_length;
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    /* SEGGER_RTT_WriteSkipNoLock() writes all or nothing, so records are never split. */
+    while ((record_length = deferred_record_peek(&record)) != 0 &&
+           SEGGER_RTT_WriteSkipNoLock(0, &record, record_length * sizeof(uint32_t)) != 0)
+    {
+        m_deferred_tail += record_length;
+    }
+    _ENABLE_IRQS(was_masked);
+}
+#endif
+
+const log_deferred_stats_t * log_deferred_stats_get(void)
+{
+    return &m_deferred_stats;
+}
+#endif /* LOG_DEFERRED_ENABLE */
+
 void log_init(uint32_t mask, uint32_t level, log_callback_t callback)
 {
     g_log_dbg_msk = mask;
     g_log_dbg_lvl = level;
 
     m_log_callback = callback;
+#if LOG_DEFERRED_ENABLE
+    m_deferred_head = 0;
+    m_deferred_tail = 0;
+    memset(&m_deferred_stats, 0, sizeof(m_deferred_stats));
+#endif
 }
 
 void log_set_callback(log_callback_t callback)
@@ -49,6 +49,7 @@
 #include "msqueue.h"
 #include "bearer_handler.h"
 #include "hal.h"
+#include "mesh_stats.h"
 
 /*****************************************************************************
 * Local defines
@@ -362,10 +363,12 @@ uint32_t mesh_flash_op_push(mesh_flash_user_t user, const flash_operation_t * p_
     flash_operation_t * p_free_op = msq_get(&m_users[user].flash_op_queue.queue, FLASH_OP_STAGE_FREE);
     if (p_free_op == NULL)
     {
+        MESH_STATS_INC(MESH_STATS_FLASH_QUEUE_FULL);
         status = NRF_ERROR_NO_MEM;
     }
     else
     {
+        MESH_STATS_INC(p_op->type == FLASH_OP_TYPE_WRITE ? MESH_STATS_FLASH_WRITE : MESH_STATS_FLASH_ERASE);
         msq_move(&m_users[user].flash_op_queue.queue, FLASH_OP_STAGE_FREE);
         memcpy(p_free_op, p_op, sizeof(flash_operation_t));
         status = NRF_SUCCESS;
@@ -0,0 +1,129 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "mesh_stats.h"
+
+#include <string.h>
+#include <nrf_error.h>
+
+#include "scanner.h"
+#include "toolchain.h"
+
+#if MESH_STATS_ENABLE
+
+uint32_t g_mesh_stats_counters[MESH_STATS_COUNT];
+
+/** Scanner counters at the time of the last clear. */
+static scanner_stats_t m_scanner_baseline;
+
+void mesh_stats_init(void)
+{
+    /* The scanner is initialized later, and starts counting from zero. */
+    memset(g_mesh_stats_counters, 0, sizeof(g_mesh_stats_counters));
+    memset(&m_scanner_baseline, 0, sizeof(m_scanner_baseline));
+}
+
+void mesh_stats_get(mesh_stats_t * p_stats)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memcpy(p_stats->counters, g_mesh_stats_counters, sizeof(p_stats->counters));
+    const scanner_stats_t * p_scanner = scanner_stats_get();
+    p_stats->counters[MESH_STATS_SCANNER_RX] = p_scanner->successful_receives - m_scanner_baseline.successful_receives;
+    p_stats->counters[MESH_STATS_SCANNER_CRC_FAIL] = p_scanner->crc_failures - m_scanner_baseline.crc_failures;
+    p_stats->counters[MESH_STATS_SCANNER_NO_MEM] = p_scanner->out_of_memory - m_scanner_baseline.out_of_memory;
+    _ENABLE_IRQS(was_masked);
+}
+
+void mesh_stats_clear(void)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memset(g_mesh_stats_counters, 0, sizeof(g_mesh_stats_counters));
+    m_scanner_baseline = *scanner_stats_get();
+    _ENABLE_IRQS(was_masked);
+}
+
+#endif /* MESH_STATS_ENABLE */
+
+uint32_t mesh_stats_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt)
+{
+#if MESH_STATS_ENABLE
+    if (p_opt == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (id != NRF_MESH_OPT_STATS_COUNTERS)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    mesh_stats_clear();
+    return NRF_SUCCESS;
+#else
+    return NRF_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t mesh_stats_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * p_opt)
+{
+#if MESH_STATS_ENABLE
+    if (p_opt == NULL || p_opt->opt.p_array == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (id != NRF_MESH_OPT_STATS_COUNTERS)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    if (p_opt->len < sizeof(mesh_stats_t))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    /* The option buffer is a byte array, and may not be aligned for the counters. */
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+    memcpy(p_opt->opt.p_array, &stats, sizeof(stats));
+    p_opt->len = sizeof(mesh_stats_t);
+    return NRF_SUCCESS;
+#else
+    return NRF_ERROR_NOT_SUPPORTED;
+#endif
+}
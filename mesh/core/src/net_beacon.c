@@ -49,6 +49,7 @@
 #include "nordic_common.h"
 #include "mesh_opt_core.h"
 #include "mesh_config_entry.h"
+#include "cache.h"
 
 /*****************************************************************************
 * Local defines
@@ -65,6 +66,7 @@
 
 /** rx_count index to treat as current. */
 #define RX_COUNT_SAMPLE_INDEX_CURRENT 0
+
 /*****************************************************************************
 * Local typedefs
 *****************************************************************************/
@@ -98,6 +100,19 @@ typedef struct __attribute((packed))
     net_beacon_payload_t payload;                    /**< Payload of the secure network beacon. */
     uint8_t              cmac[NET_BEACON_CMAC_SIZE]; /**< CMAC authentication value. */
 } net_beacon_t;
+
+/**
+ * Authenticated beacon cache entry.
+ *
+ * A beacon is only considered authenticated for the beacon key it was verified with, so the key is
+ * part of the entry. The @c in_use field prevents erased (all-zero) entries from matching.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t      in_use;                   /**< Always 1 for valid entries. */
+    net_beacon_t beacon;                   /**< Authenticated beacon content. */
+    uint8_t      key[NRF_MESH_KEY_SIZE];   /**< Beacon key the beacon was authenticated with. */
+} beacon_cache_entry_t;
 /*lint -align_max(pop) */
 
 NRF_MESH_STATIC_ASSERT(NET_BEACON_BUFFER_SIZE == sizeof(net_beacon_t) + BEACON_PACKET_OVERHEAD);
@@ -111,6 +126,9 @@ static bool          m_enabled;                        /**< Secure network beaco
 static advertiser_t  m_adv;
 static uint8_t       m_adv_buf[ADVERTISER_PACKET_BUFFER_PACKET_MAXLEN] __attribute((aligned(WORD_SIZE)));
 static const nrf_mesh_beacon_info_t * mp_beacon_info;
+static beacon_cache_entry_t m_beacon_cache_entries[NET_BEACON_CACHE_SIZE];
+static cache_t       m_beacon_cache;                   /**< Cache of recently authenticated beacons. */
+static net_beacon_stats_t m_stats;
 
 /*****************************************************************************
 * Static functions
@@ -157,6 +175,85 @@ static bool is_valid_beacon_pkt(const nrf_mesh_beacon_secmat_t * p_beacon_secmat
     }
 }
 
+static inline void beacon_cache_entry_make(const nrf_mesh_beacon_secmat_t * p_beacon_secmat,
+                                           const net_beacon_t * p_beacon,
+                                           beacon_cache_entry_t * p_entry)
+{
+    p_entry->in_use = 1;
+    memcpy(&p_entry->beacon, p_beacon, sizeof(net_beacon_t));
+    memcpy(p_entry->key, p_beacon_secmat->key, NRF_MESH_KEY_SIZE);
+}
+
+/**
+ * Looks for a beacon that has previously been authenticated with the given security material.
+ *
+ * @param[in] p_beacon_secmat Network beacon security material.
+ * @param[in] p_beacon        Beacon to look for.
+ *
+ * @return true  If the beacon has already been authenticated with @p p_beacon_secmat.
+ * @return false Otherwise.
+ */
+static bool beacon_cache_has(const nrf_mesh_beacon_secmat_t * p_beacon_secmat, const net_beacon_t * p_beacon)
+{
+    beacon_cache_entry_t entry;
+    beacon_cache_entry_make(p_beacon_secmat, p_beacon, &entry);
+    return cache_has_elem(&m_beacon_cache, &entry);
+}
+
+static void beacon_cache_put(const nrf_mesh_beacon_secmat_t * p_beacon_secmat, const net_beacon_t * p_beacon)
+{
+    beacon_cache_entry_t entry;
+    beacon_cache_entry_make(p_beacon_secmat, p_beacon, &entry);
+    cache_put(&m_beacon_cache, &entry);
+}
+
+/**
+ * Authenticates a beacon against the given network, trying the updated security material if the
+ * subnet is in a key refresh phase.
+ *
+ * Both sets of security material are checked against the cache of authenticated beacons before any
+ * CMAC is calculated, so a repeated beacon never costs a CMAC calculation.
+ *
+ * @param[in] p_beacon_info Beacon info of the network to authenticate the beacon for.
+ * @param[in] kr_phase      Key refresh phase of the network.
+ * @param[in] p_beacon      Beacon to authenticate.
+ *
+ * @returns The security material that authenticated the beacon, or NULL if the beacon isn't
+ * authentic.
+ */
+static const nrf_mesh_beacon_secmat_t * beacon_authenticate(const nrf_mesh_beacon_info_t * p_beacon_info,
+                                                            nrf_mesh_key_refresh_phase_t kr_phase,
+                                                            const net_beacon_t * p_beacon)
+{
+    bool check_updated = (kr_phase != NRF_MESH_KEY_REFRESH_PHASE_0);
+
+    if (beacon_cache_has(&p_beacon_info->secmat, p_beacon))
+    {
+        m_stats.cache_hits++;
+        m_stats.cmacs_saved++;
+        return &p_beacon_info->secmat;
+    }
+    else if (check_updated && beacon_cache_has(&p_beacon_info->secmat_updated, p_beacon))
+    {
+        m_stats.cache_hits++;
+        m_stats.cmacs_saved++;
+        return &p_beacon_info->secmat_updated;
+    }
+
+    if (is_valid_beacon_pkt(&p_beacon_info->secmat, p_beacon))
+    {
+        beacon_cache_put(&p_beacon_info->secmat, p_beacon);
+        return &p_beacon_info->secmat;
+    }
+    else if (check_updated && is_valid_beacon_pkt(&p_beacon_info->secmat_updated, p_beacon))
+    {
+        beacon_cache_put(&p_beacon_info->secmat_updated, p_beacon);
+        return &p_beacon_info->secmat_updated;
+    }
+
+    return NULL;
+}
+
 static inline void make_network_beacon_packet(const nrf_mesh_beacon_secmat_t * p_beacon_secmat,
                                             bool key_refresh,
                                             net_state_iv_update_t iv_update,
@@ -339,6 +436,12 @@ void net_beacon_init(void)
     advertiser_interval_set(&m_adv, SEC_TO_MS(1));
 
     enc_s1(NETWORK_BKEY_SALT_INPUT, NETWORK_BKEY_SALT_INPUT_LENGTH, m_beacon_salt);
+
+    m_beacon_cache.elem_array = m_beacon_cache_entries;
+    m_beacon_cache.elem_size = sizeof(beacon_cache_entry_t);
+    m_beacon_cache.array_len = NET_BEACON_CACHE_SIZE;
+    cache_init(&m_beacon_cache);
+    memset(&m_stats, 0, sizeof(m_stats));
 }
 
 void net_beacon_enable(void)
@@ -401,22 +504,10 @@ void net_beacon_packet_in(const uint8_t * p_beacon_data, uint8_t data_length, co
             nrf_mesh_beacon_info_next_get(p_beacon->payload.network_id, &p_beacon_info, &subnet_kr_phase))
     {
         NRF_MESH_ASSERT(p_beacon_info->p_tx_info != NULL);
-        const nrf_mesh_beacon_secmat_t * p_beacon_secmat = NULL;
+        const nrf_mesh_beacon_secmat_t * p_beacon_secmat = beacon_authenticate(p_beacon_info, subnet_kr_phase, p_beacon);
         uint32_t iv_index = BE2LE32(p_beacon->payload.iv_index);
 
-        bool valid_pkt = false;
-        if (is_valid_beacon_pkt(&p_beacon_info->secmat, p_beacon))
-        {
-            p_beacon_secmat = &p_beacon_info->secmat;
-            valid_pkt = true;
-        }
-        else if (subnet_kr_phase != NRF_MESH_KEY_REFRESH_PHASE_0 && is_valid_beacon_pkt(&p_beacon_info->secmat_updated, p_beacon))
-        {
-            p_beacon_secmat = &p_beacon_info->secmat_updated;
-            valid_pkt = true;
-        }
-
-        if (valid_pkt)
+        if (p_beacon_secmat != NULL)
         {
             if (p_beacon_info->p_tx_info->rx_count[RX_COUNT_SAMPLE_INDEX_CURRENT] < BEACON_RX_COUNT_MAX)
             {
@@ -436,3 +527,8 @@ void net_beacon_packet_in(const uint8_t * p_beacon_data, uint8_t data_length, co
         }
     }
 }
+
+const net_beacon_stats_t * net_beacon_stats_get(void)
+{
+    return &m_stats;
+}
@@ -42,6 +42,7 @@
 #include "net_state.h"
 #include "enc.h"
 #include "nordic_common.h"
+#include "mesh_stats.h"
 
 /** Offset of the start of the encrypted part of the network packet. */
 #define NET_PACKET_ENCRYPTION_START_OFFSET PACKET_MESH_NET_DST0_OFFSET
@@ -101,12 +102,14 @@ static inline enc_nonce_t nonce_type_get(net_packet_kind_t packet_kind)
  * @param[in] p_net_metadata Metadata to check for.
  * @param[in] net_packet_len Length of the network packet.
  * @param[in] p_net_packet Pointer to the network packet, used for logging.
+ * @param[out] p_cached Set to true if the packet was found in the message cache.
  *
  * @returns Whether the metadata represents a potentially valid header.
  */
 static inline bool deobfuscated_header_is_valid(const network_packet_metadata_t * p_net_metadata,
                                                 uint32_t net_packet_len,
-                                                const packet_mesh_net_packet_t * p_net_packet)
+                                                const packet_mesh_net_packet_t * p_net_packet,
+                                                bool * p_cached)
 {
     /* If the source address isn't a unicast address, this packet won't be valid, and we can skip it
      * without decrypting, saving us an average of 50% of all failing decryptions.  */
@@ -128,6 +131,7 @@ static inline bool deobfuscated_header_is_valid(const network_packet_metadata_t
     if (msg_cache_entry_exists(p_net_metadata->src, p_net_metadata->internal.sequence_number))
     {
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_DROPPED, PACKET_DROPPED_NETWORK_CACHE, net_packet_len, p_net_packet);
+        *p_cached = true;
         return false;
     }
     /* If the source address is one of our unicast rx addresses, we sent it ourselves, and shouldn't
@@ -190,7 +194,8 @@ static bool try_decrypt(network_packet_metadata_t * p_net_metadata,
                         const packet_mesh_net_packet_t * p_net_encrypted_packet,
                         packet_mesh_net_packet_t * p_net_decrypted_packet,
                         const nrf_mesh_network_secmat_t * p_secmat,
-                        net_packet_kind_t packet_kind)
+                        net_packet_kind_t packet_kind,
+                        bool * p_cached)
 {
     bool authenticated = false;
     uint8_t nonce[CCM_NONCE_LENGTH];
@@ -209,8 +214,9 @@ static bool try_decrypt(network_packet_metadata_t * p_net_metadata,
 
     deobfuscated_header_fields_get(p_net_metadata, p_net_decrypted_packet);
 
-    if (deobfuscated_header_is_valid(p_net_metadata, net_packet_len, p_net_decrypted_packet))
+    if (deobfuscated_header_is_valid(p_net_metadata, net_packet_len, p_net_decrypted_packet, p_cached))
     {
+        MESH_STATS_INC(MESH_STATS_NET_DECRYPT_ATTEMPT);
         ccm_params.mic_len = net_packet_mic_size_get(p_net_metadata->control_packet);
         ccm_params.m_len   = (net_packet_len
                                 - NET_PACKET_ENCRYPTION_START_OFFSET
@@ -249,24 +255,45 @@ uint32_t net_packet_decrypt(network_packet_metadata_t * p_net_metadata,
     p_net_metadata->p_security_material = NULL;
     uint8_t nid = packet_mesh_net_nid_get(p_net_encrypted_packet);
 
+    /* Source and sequence number of the first deobfuscation found in the message cache. */
+    bool cached = false;
+    uint16_t cached_src = NRF_MESH_ADDR_UNASSIGNED;
+    uint32_t cached_sequence_number = 0;
+
     const nrf_mesh_network_secmat_t * p_secmat[2] = { NULL, NULL };
     do {
         nrf_mesh_net_secmat_next_get(nid, &p_secmat[0], &p_secmat[1]);
 
         for (uint32_t i = 0; i < ARRAY_SIZE(p_secmat) && p_secmat[i] != NULL; i++)
         {
+            bool secmat_cached = false;
             if (try_decrypt(p_net_metadata,
                             net_packet_len,
                             p_net_encrypted_packet,
                             p_net_decrypted_packet,
                             p_secmat[i],
-                            packet_kind))
+                            packet_kind,
+                            &secmat_cached))
             {
                 return NRF_SUCCESS;
             }
+
+            if (secmat_cached && !cached)
+            {
+                cached = true;
+                cached_src = p_net_metadata->src;
+                cached_sequence_number = p_net_metadata->internal.sequence_number;
+            }
         }
     } while (p_secmat[0] != NULL);
 
+    if (cached)
+    {
+        p_net_metadata->src = cached_src;
+        p_net_metadata->internal.sequence_number = cached_sequence_number;
+        return NRF_ERROR_INVALID_STATE;
+    }
+
     return NRF_ERROR_NOT_FOUND;
 }
 
@@ -300,6 +327,42 @@ void net_packet_encrypt(network_packet_metadata_t * p_net_metadata,
     header_obfuscate(p_net_metadata, p_net_packet, p_net_packet);
 }
 
+void net_packet_relay_encrypt(const network_packet_metadata_t * p_net_metadata,
+                              uint32_t payload_len,
+                              const packet_mesh_net_packet_t * p_net_decrypted_packet,
+                              packet_mesh_net_packet_t * p_net_packet)
+{
+    NRF_MESH_ASSERT(p_net_metadata);
+    NRF_MESH_ASSERT(p_net_decrypted_packet);
+    NRF_MESH_ASSERT(p_net_packet);
+    NRF_MESH_ASSERT(p_net_packet != p_net_decrypted_packet);
+    NRF_MESH_ASSERT(p_net_metadata->ttl <= NRF_MESH_TTL_MAX);
+
+    uint8_t nonce[CCM_NONCE_LENGTH];
+
+    /* The relayed header only differs from the received one in the TTL field. */
+    memcpy(p_net_packet, p_net_decrypted_packet, NET_PACKET_ENCRYPTION_START_OFFSET);
+    packet_mesh_net_ttl_set(p_net_packet, p_net_metadata->ttl);
+
+    enc_nonce_generate(p_net_metadata, ENC_NONCE_NET, 0, nonce);
+
+    ccm_soft_data_t ccm_params;
+    ccm_params.mic_len = net_packet_mic_size_get(p_net_metadata->control_packet);
+    ccm_params.p_key   = p_net_metadata->p_security_material->encryption_key;
+    ccm_params.p_nonce = nonce;
+    /* Encrypt the destination and payload directly out of the received packet. */
+    ccm_params.p_m     = net_packet_enc_start_get(p_net_decrypted_packet);
+    ccm_params.p_out   = net_packet_enc_start_get(p_net_packet);
+    ccm_params.m_len   = (NET_PACKET_ENCRYPTION_START_PAYLOAD_OVERHEAD + payload_len);
+    ccm_params.a_len   = 0;
+    ccm_params.p_a     = NULL;
+    ccm_params.p_mic   = ccm_params.p_out + ccm_params.m_len;
+
+    enc_aes_ccm_encrypt(&ccm_params);
+
+    header_obfuscate(p_net_metadata, p_net_packet, p_net_packet);
+}
+
 void net_packet_header_set(packet_mesh_net_packet_t * p_net_packet,
                            const network_packet_metadata_t * p_metadata)
 {
@@ -528,6 +528,7 @@ void net_state_enable(void)
     if (!m_enabled)
     {
         m_mesh_evt_handler.evt_cb = mesh_evt_handler;
+        m_mesh_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_NET_BEACON_RECEIVED);
         nrf_mesh_evt_handler_add(&m_mesh_evt_handler);
         timer_sch_schedule(&m_iv_update_timer);
         m_enabled = true;
@@ -60,6 +60,10 @@
 #include "heartbeat.h"
 #include "nrf_mesh_config_bearer.h"
 #include "mesh_opt_core.h"
+#include "instr.h"
+#include "mesh_stats.h"
+#include "relay_policy.h"
+#include "relay_queue.h"
 #if GATT_PROXY
 #include "proxy.h"
 #endif
@@ -67,6 +71,8 @@
  * Static variables *
  ********************/
 static nrf_mesh_relay_check_cb_t m_relay_check_cb;
+static relay_policy_t m_relay_policy;
+static relay_queue_t m_relay_queue;
 /********************
  * Static functions *
  ********************/
@@ -118,34 +124,58 @@ static uint32_t allocate_packet(network_tx_packet_buffer_t * p_buffer)
 /**
  * Relay the network packet, if memory is available.
  *
+ * The relay packet is built and encrypted directly from the decrypted packet, instead of going
+ * through the header serialization and payload copy of the originator path.
+ *
  * @param[in] p_net_metadata Network metadata of packet to relay.
- * @param[in,out] p_net_payload Payload of the network packet to relay.
+ * @param[in] p_net_decrypted_packet Decrypted network packet to relay.
  * @param[in] payload_len Length of the network payload.
+ *
+ * @returns Whether memory was available for the relay packet.
  */
-static void packet_relay(network_packet_metadata_t * p_net_metadata,
-                         const uint8_t * p_net_payload,
+static bool packet_relay(network_packet_metadata_t * p_net_metadata,
+                         const packet_mesh_net_packet_t * p_net_decrypted_packet,
                          uint8_t payload_len)
 {
     p_net_metadata->ttl--; /* Subtract this hop */
 
-    network_tx_packet_buffer_t buffer;
-    buffer.user_data.p_metadata = p_net_metadata;
-    buffer.user_data.payload_len = payload_len;
-    buffer.user_data.token = NRF_MESH_RELAY_TOKEN;
-    buffer.role = CORE_TX_ROLE_RELAY;
-
-    if (allocate_packet(&buffer) == NRF_SUCCESS)
+    const core_tx_alloc_params_t alloc_params =
     {
-        memcpy(buffer.p_payload, p_net_payload, payload_len);
-        network_packet_send(&buffer);
-        __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_RELAYED, 0, payload_len, p_net_payload);
-    }
-    else
+        .role           = CORE_TX_ROLE_RELAY,
+        .net_packet_len = m_core_tx_buffer_size_get(p_net_metadata, payload_len),
+        .p_metadata     = p_net_metadata,
+        .token          = NRF_MESH_RELAY_TOKEN
+    };
+
+    packet_mesh_net_packet_t * p_net_packet;
+    bool allocated = (core_tx_packet_alloc(&alloc_params, (uint8_t **) &p_net_packet) != 0);
+    if (allocated)
     {
-        __LOG(LOG_SRC_NETWORK, LOG_LEVEL_WARN, "Unable to allocate memory for relay packet.\n");
+        net_packet_relay_encrypt(p_net_metadata, payload_len, p_net_decrypted_packet, p_net_packet);
+        core_tx_packet_send();
+        MESH_STATS_INC(MESH_STATS_NET_RELAYED);
+        __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_NET_PACKET_QUEUED_TX, 0, payload_len, packet_mesh_net_payload_get(p_net_packet));
+        __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_RELAYED, 0, payload_len, packet_mesh_net_payload_get(p_net_decrypted_packet));
     }
 
     p_net_metadata->ttl++; /* Revert the change (cannot affect the allocated packet) */
+    return allocated;
+}
+
+static bool relay_queue_tx(relay_queue_t * p_queue,
+                           network_packet_metadata_t * p_net_metadata,
+                           const packet_mesh_net_packet_t * p_net_packet,
+                           uint8_t payload_len)
+{
+    return packet_relay(p_net_metadata, p_net_packet, payload_len);
+}
+
+static void relay_policy_relay(relay_policy_t * p_policy,
+                               network_packet_metadata_t * p_net_metadata,
+                               const packet_mesh_net_packet_t * p_net_packet,
+                               uint8_t payload_len)
+{
+    relay_queue_push(&m_relay_queue, p_net_metadata, p_net_packet, payload_len);
 }
 
 static bool metadata_is_valid(const network_packet_metadata_t * p_net_metadata)
@@ -216,6 +246,8 @@ void network_init(const nrf_mesh_init_params_t * p_init_params)
         m_relay_check_cb = p_init_params->relay_cb;
     }
 
+    relay_policy_init(&m_relay_policy, relay_policy_relay);
+    relay_queue_init(&m_relay_queue, relay_queue_tx);
     net_state_init();
     net_state_recover_from_flash();
     net_beacon_init();
@@ -233,7 +265,18 @@ uint32_t network_packet_alloc(network_tx_packet_buffer_t * p_buffer)
     NRF_MESH_ASSERT(p_buffer->user_data.p_metadata != NULL);
     NRF_MESH_ASSERT(p_buffer->user_data.p_metadata->p_security_material != NULL);
     p_buffer->role = CORE_TX_ROLE_ORIGINATOR;
-    return allocate_packet(p_buffer);
+
+    if (!relay_queue_originator_allowed(&m_relay_queue))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint32_t status = allocate_packet(p_buffer);
+    if (status == NRF_SUCCESS)
+    {
+        relay_queue_originator_sent(&m_relay_queue);
+    }
+    return status;
 }
 
 void network_packet_send(const network_tx_packet_buffer_t * p_buffer)
@@ -251,6 +294,7 @@ void network_packet_send(const network_tx_packet_buffer_t * p_buffer)
                        NET_PACKET_KIND_TRANSPORT);
 
     core_tx_packet_send();
+    MESH_STATS_INC(MESH_STATS_NET_TX);
 
     __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_NET_PACKET_QUEUED_TX, 0, p_buffer->user_data.payload_len, p_buffer->p_payload);
 }
@@ -270,6 +314,15 @@ uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, co
         return NRF_ERROR_NULL;
     }
 
+    /* Extended advertising packets can carry network PDUs longer than the decryption buffer. */
+    if (net_packet_len > sizeof(packet_mesh_net_packet_t))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    INSTR_STAGE_BEGIN(instr_start);
+    MESH_STATS_INC(MESH_STATS_NET_RX);
+    relay_policy_neighbour_heard(&m_relay_policy, p_rx_metadata);
     const packet_mesh_net_packet_t * p_net_packet = (const packet_mesh_net_packet_t *) p_packet;
     uint32_t status = NRF_SUCCESS;
 
@@ -282,11 +335,13 @@ uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, co
            net_packet_obfuscation_start_get(p_net_packet) - (uint8_t *) p_net_packet);
 
     network_packet_metadata_t net_metadata;
+    INSTR_STAGE_BEGIN(instr_decrypt_start);
     status = net_packet_decrypt(&net_metadata,
                                 net_packet_len,
                                 p_net_packet,
                                 &net_decrypted_packet,
                                 NET_PACKET_KIND_TRANSPORT);
+    INSTR_STAGE_END(INSTR_STAGE_NET_DECRYPT, instr_decrypt_start);
     if ((status == NRF_SUCCESS) && metadata_is_valid(&net_metadata))
     {
         NRF_MESH_ASSERT(net_metadata.p_security_material != NULL);
@@ -301,17 +356,35 @@ uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, co
 
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_NET_PACKET_RECEIVED, 0, net_packet_len, &net_decrypted_packet);
 
+        INSTR_STAGE_BEGIN(instr_transport_start);
         status = transport_packet_in((const packet_mesh_trs_packet_t *) p_net_payload,
                                      payload_len,
                                      &net_metadata,
                                      p_rx_metadata);
+        INSTR_STAGE_END(INSTR_STAGE_TRANSPORT, instr_transport_start);
 
-        if (should_relay(&net_metadata))
+        if (should_relay(&net_metadata) &&
+            relay_policy_packet_in(&m_relay_policy, &net_metadata, &net_decrypted_packet, payload_len, p_rx_metadata))
         {
-            packet_relay(&net_metadata, p_net_payload, payload_len);
+            relay_queue_push(&m_relay_queue, &net_metadata, &net_decrypted_packet, payload_len);
         }
         msg_cache_entry_add(net_metadata.src, net_metadata.internal.sequence_number);
     }
+    else if (status == NRF_SUCCESS)
+    {
+        MESH_STATS_INC(MESH_STATS_NET_RX_DROP_INVALID);
+    }
+    else if (status == NRF_ERROR_INVALID_STATE)
+    {
+        MESH_STATS_INC(MESH_STATS_NET_RX_DROP_CACHE);
+        relay_policy_duplicate_in(&m_relay_policy, net_metadata.src, net_metadata.internal.sequence_number);
+        status = NRF_ERROR_NOT_FOUND;
+    }
+    else
+    {
+        MESH_STATS_INC(MESH_STATS_NET_RX_DROP_DECRYPT);
+    }
+    INSTR_STAGE_END(INSTR_STAGE_NETWORK_IN, instr_start);
     return status;
 }
 
@@ -363,6 +436,80 @@ uint32_t network_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt)
         }
         case NRF_MESH_OPT_NET_NETWORK_TX_POWER:
             return mesh_opt_core_tx_power_set(CORE_TX_ROLE_ORIGINATOR, (radio_tx_power_t) p_opt->opt.val);
+        case NRF_MESH_OPT_NET_RELAY_POLICY:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_DENSITY_TARGET:
+        {
+            relay_policy_config_t cfg;
+            relay_policy_config_get(&m_relay_policy, &cfg);
+            switch (id)
+            {
+                case NRF_MESH_OPT_NET_RELAY_POLICY:
+                    cfg.type = (relay_policy_type_t) p_opt->opt.val;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD:
+                    if (p_opt->opt.val > UINT8_MAX)
+                    {
+                        return NRF_ERROR_INVALID_PARAM;
+                    }
+                    cfg.counter_threshold = p_opt->opt.val;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS:
+                    if (p_opt->opt.val > UINT32_MAX / 1000)
+                    {
+                        return NRF_ERROR_INVALID_PARAM;
+                    }
+                    cfg.backoff_max_us = MS_TO_US(p_opt->opt.val);
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD:
+                    if ((int32_t) p_opt->opt.val < INT8_MIN || (int32_t) p_opt->opt.val > INT8_MAX)
+                    {
+                        return NRF_ERROR_INVALID_PARAM;
+                    }
+                    cfg.rssi_threshold = (int8_t) p_opt->opt.val;
+                    break;
+                default:
+                    if (p_opt->opt.val > UINT8_MAX)
+                    {
+                        return NRF_ERROR_INVALID_PARAM;
+                    }
+                    cfg.density_target = p_opt->opt.val;
+                    break;
+            }
+            return relay_policy_config_set(&m_relay_policy, &cfg);
+        }
+        case NRF_MESH_OPT_NET_RELAY_POLICY_STATS:
+            relay_policy_stats_clear(&m_relay_policy);
+            return NRF_SUCCESS;
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_PRIORITY:
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_DROP:
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS:
+        {
+            relay_queue_config_t cfg;
+            relay_queue_config_get(&m_relay_queue, &cfg);
+            switch (id)
+            {
+                case NRF_MESH_OPT_NET_RELAY_QUEUE_PRIORITY:
+                    cfg.priority = (relay_queue_priority_t) p_opt->opt.val;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_QUEUE_DROP:
+                    cfg.drop = (relay_queue_drop_t) p_opt->opt.val;
+                    break;
+                default:
+                    if (p_opt->opt.val > UINT32_MAX / 1000)
+                    {
+                        return NRF_ERROR_INVALID_PARAM;
+                    }
+                    cfg.max_age_us = MS_TO_US(p_opt->opt.val);
+                    break;
+            }
+            return relay_queue_config_set(&m_relay_queue, &cfg);
+        }
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_STATS:
+            relay_queue_stats_clear(&m_relay_queue);
+            return NRF_SUCCESS;
         default:
             return NRF_ERROR_NOT_FOUND;
     }
@@ -433,6 +580,88 @@ uint32_t network_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * p_opt)
             p_opt->len = sizeof(p_opt->opt.val);
             break;
         }
+        case NRF_MESH_OPT_NET_RELAY_POLICY:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD:
+        case NRF_MESH_OPT_NET_RELAY_POLICY_DENSITY_TARGET:
+        {
+            relay_policy_config_t cfg;
+            relay_policy_config_get(&m_relay_policy, &cfg);
+            switch (id)
+            {
+                case NRF_MESH_OPT_NET_RELAY_POLICY:
+                    p_opt->opt.val = cfg.type;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD:
+                    p_opt->opt.val = cfg.counter_threshold;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS:
+                    p_opt->opt.val = US_TO_MS(cfg.backoff_max_us);
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD:
+                    p_opt->opt.val = (uint32_t) (int32_t) cfg.rssi_threshold;
+                    break;
+                default:
+                    p_opt->opt.val = cfg.density_target;
+                    break;
+            }
+            p_opt->len = sizeof(p_opt->opt.val);
+            break;
+        }
+        case NRF_MESH_OPT_NET_RELAY_POLICY_STATS:
+        {
+            if (p_opt->opt.p_array == NULL)
+            {
+                return NRF_ERROR_NULL;
+            }
+            if (p_opt->len < sizeof(relay_policy_stats_t))
+            {
+                return NRF_ERROR_INVALID_LENGTH;
+            }
+            relay_policy_stats_t stats;
+            relay_policy_stats_get(&m_relay_policy, &stats);
+            memcpy(p_opt->opt.p_array, &stats, sizeof(stats));
+            p_opt->len = sizeof(stats);
+            break;
+        }
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_PRIORITY:
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_DROP:
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS:
+        {
+            relay_queue_config_t cfg;
+            relay_queue_config_get(&m_relay_queue, &cfg);
+            switch (id)
+            {
+                case NRF_MESH_OPT_NET_RELAY_QUEUE_PRIORITY:
+                    p_opt->opt.val = cfg.priority;
+                    break;
+                case NRF_MESH_OPT_NET_RELAY_QUEUE_DROP:
+                    p_opt->opt.val = cfg.drop;
+                    break;
+                default:
+                    p_opt->opt.val = US_TO_MS(cfg.max_age_us);
+                    break;
+            }
+            p_opt->len = sizeof(p_opt->opt.val);
+            break;
+        }
+        case NRF_MESH_OPT_NET_RELAY_QUEUE_STATS:
+        {
+            if (p_opt->opt.p_array == NULL)
+            {
+                return NRF_ERROR_NULL;
+            }
+            if (p_opt->len < sizeof(relay_queue_stats_t))
+            {
+                return NRF_ERROR_INVALID_LENGTH;
+            }
+            relay_queue_stats_t stats;
+            relay_queue_stats_get(&m_relay_queue, &stats);
+            memcpy(p_opt->opt.p_array, &stats, sizeof(stats));
+            p_opt->len = sizeof(stats);
+            break;
+        }
         default:
             break;
     }
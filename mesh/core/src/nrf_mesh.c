@@ -77,6 +77,9 @@
 #include "prov_bearer_adv.h"
 #include "mesh_config.h"
 #include "mesh_opt.h"
+#include "instr.h"
+#include "mesh_stats.h"
+#include "packet_trace.h"
 
 #if GATT_PROXY
 #include "proxy.h"
@@ -180,6 +183,8 @@ static bool scanner_packet_process_cb(void)
 
     if (p_scanner_packet != NULL)
     {
+        INSTR_STAGE_BEGIN(instr_start);
+        packet_trace_scanner_rx(p_scanner_packet);
         nrf_mesh_rx_metadata_t metadata;
 
         metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
@@ -216,6 +221,7 @@ static bool scanner_packet_process_cb(void)
         }
 
         scanner_packet_release(p_scanner_packet);
+        INSTR_STAGE_END(INSTR_STAGE_SCANNER_RX, instr_start);
     }
 
     return !scanner_rx_pending();
@@ -304,6 +310,8 @@ uint32_t nrf_mesh_init(const nrf_mesh_init_params_t * p_init_params)
     toolchain_init_irqs();
 #endif
 
+    instr_init();
+    mesh_stats_init();
     msg_cache_init();
     timer_sch_init();
     bearer_event_init(irq_priority);
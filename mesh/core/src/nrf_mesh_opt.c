@@ -36,6 +36,8 @@
  */
 #include "nrf_mesh_opt.h"
 
+#include "instr.h"
+#include "mesh_stats.h"
 #include "network.h"
 #include "prov_utils.h"
 #include "transport.h"
@@ -53,10 +55,18 @@ uint32_t  nrf_mesh_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * const p_
     {
         return transport_opt_set(id, p_opt);
     }
-    else if (NRF_MESH_OPT_NET_START <= id)
+    else if (NRF_MESH_OPT_NET_START <= id && id < NRF_MESH_OPT_INSTR_START)
     {
         return network_opt_set(id, p_opt);
     }
+    else if (NRF_MESH_OPT_INSTR_START <= id && id < NRF_MESH_OPT_STATS_START)
+    {
+        return instr_opt_set(id, p_opt);
+    }
+    else if (NRF_MESH_OPT_STATS_START <= id)
+    {
+        return mesh_stats_opt_set(id, p_opt);
+    }
     else
     {
         return NRF_ERROR_NOT_SUPPORTED;
@@ -73,10 +83,18 @@ uint32_t nrf_mesh_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * const p_opt)
     {
         return transport_opt_get(id, p_opt);
     }
-    else if (NRF_MESH_OPT_NET_START <= id)
+    else if (NRF_MESH_OPT_NET_START <= id && id < NRF_MESH_OPT_INSTR_START)
     {
         return network_opt_get(id, p_opt);
     }
+    else if (NRF_MESH_OPT_INSTR_START <= id && id < NRF_MESH_OPT_STATS_START)
+    {
+        return instr_opt_get(id, p_opt);
+    }
+    else if (NRF_MESH_OPT_STATS_START <= id)
+    {
+        return mesh_stats_opt_get(id, p_opt);
+    }
     else
     {
         return NRF_ERROR_NOT_SUPPORTED;
@@ -0,0 +1,203 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "packet_trace.h"
+
+#include <string.h>
+
+#include "nrf_mesh_assert.h"
+#include "toolchain.h"
+#include "utils.h"
+#include "nordic_common.h"
+
+#if PACKET_TRACE_ENABLE
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+#include <SEGGER_RTT.h>
+#endif
+
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(PACKET_TRACE_BUFFER_SIZE));
+NRF_MESH_STATIC_ASSERT(PACKET_TRACE_BUFFER_SIZE >= sizeof(packet_trace_header_t) +
+                                                   sizeof(packet_trace_record_t) +
+                                                   BLE_ADV_PACKET_OVERHEAD +
+                                                   BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+
+/* The ring buffer indexes run freely, and are masked on access. The buffer is written in the
+ * bearer event context, and read in any context, so both ends are protected by disabling IRQs. */
+static uint8_t m_buffer[PACKET_TRACE_BUFFER_SIZE];
+static uint32_t m_head;
+static uint32_t m_tail;
+static bool m_enabled;
+static packet_trace_stats_t m_stats;
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+static uint8_t m_rtt_buffer[PACKET_TRACE_RTT_BUFFER_SIZE];
+#endif
+
+static void buffer_write(const void * p_data, uint32_t length)
+{
+    const uint8_t * p_bytes = p_data;
+    uint32_t offset = m_head & (PACKET_TRACE_BUFFER_SIZE - 1);
+    uint32_t first = MIN(length, PACKET_TRACE_BUFFER_SIZE - offset);
+
+    memcpy(&m_buffer[offset], p_bytes, first);
+    memcpy(&m_buffer[0], &p_bytes[first], length - first);
+    m_head += length;
+}
+
+/* Gets the readable data in the buffer up to the point where it wraps around. */
+static uint32_t buffer_contiguous_get(const uint8_t ** pp_data)
+{
+    uint32_t offset = m_tail & (PACKET_TRACE_BUFFER_SIZE - 1);
+    *pp_data = &m_buffer[offset];
+    return MIN(m_head - m_tail, PACKET_TRACE_BUFFER_SIZE - offset);
+}
+
+void packet_trace_start(void)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+    (void) SEGGER_RTT_ConfigUpBuffer(PACKET_TRACE_RTT_CHANNEL,
+                                     "mesh_trace",
+                                     m_rtt_buffer,
+                                     sizeof(m_rtt_buffer),
+                                     SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+
+    m_head = 0;
+    m_tail = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    packet_trace_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PACKET_TRACE_MAGIC;
+    header.version = PACKET_TRACE_VERSION;
+    buffer_write(&header, sizeof(header));
+
+    m_enabled = true;
+    _ENABLE_IRQS(was_masked);
+}
+
+void packet_trace_stop(void)
+{
+    m_enabled = false;
+}
+
+bool packet_trace_is_enabled(void)
+{
+    return m_enabled;
+}
+
+void packet_trace_scanner_rx(const scanner_packet_t * p_packet)
+{
+    NRF_MESH_ASSERT(p_packet != NULL);
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    packet_trace_record_t record;
+    record.timestamp = p_packet->metadata.timestamp;
+    record.channel = p_packet->metadata.channel;
+    record.rssi = p_packet->metadata.rssi;
+    record.pdu_type = p_packet->packet.header.type | (p_packet->packet.header.addr_type << 6);
+    record.length = MIN(p_packet->packet.header.length, BLE_ADV_PACKET_OVERHEAD + BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (PACKET_TRACE_BUFFER_SIZE - (m_head - m_tail) >= sizeof(record) + record.length)
+    {
+        buffer_write(&record, sizeof(record));
+        /* The advertiser address and the payload are contiguous in the packet. */
+        buffer_write(p_packet->packet.addr, record.length);
+        m_stats.recorded++;
+    }
+    else
+    {
+        m_stats.dropped++;
+    }
+    _ENABLE_IRQS(was_masked);
+}
+
+uint32_t packet_trace_read(uint8_t * p_buffer, uint32_t length)
+{
+    NRF_MESH_ASSERT(p_buffer != NULL);
+    uint32_t bytes_read = 0;
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    while (bytes_read < length && m_head != m_tail)
+    {
+        const uint8_t * p_data;
+        uint32_t chunk = MIN(buffer_contiguous_get(&p_data), length - bytes_read);
+        memcpy(&p_buffer[bytes_read], p_data, chunk);
+        bytes_read += chunk;
+        m_tail += chunk;
+    }
+    _ENABLE_IRQS(was_masked);
+    return bytes_read;
+}
+
+#if (LOG_ENABLE_RTT && !defined(HOST))
+void packet_trace_flush_rtt(void)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    while (m_head != m_tail)
+    {
+        const uint8_t * p_data;
+        uint32_t chunk = buffer_contiguous_get(&p_data);
+        /* The trace is a byte stream, so it's fine to only write part of the chunk. */
+        uint32_t written = SEGGER_RTT_WriteNoLock(PACKET_TRACE_RTT_CHANNEL, p_data, chunk);
+        m_tail += written;
+        if (written < chunk)
+        {
+            break;
+        }
+    }
+    _ENABLE_IRQS(was_masked);
+}
+#endif
+
+const packet_trace_stats_t * packet_trace_stats_get(void)
+{
+    return &m_stats;
+}
+
+#endif /* PACKET_TRACE_ENABLE */
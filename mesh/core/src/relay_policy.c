@@ -0,0 +1,350 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "relay_policy.h"
+
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "utils.h"
+#include "log.h"
+
+/********************
+ * Static functions *
+ ********************/
+
+static relay_policy_pending_t * pending_find(relay_policy_t * p_policy, uint16_t src, uint32_t sequence_number)
+{
+    for (uint32_t i = 0; i < RELAY_POLICY_PENDING_COUNT; ++i)
+    {
+        relay_policy_pending_t * p_pending = &p_policy->pending[i];
+        if (p_pending->active &&
+            p_pending->metadata.src == src &&
+            p_pending->metadata.internal.sequence_number == sequence_number)
+        {
+            return p_pending;
+        }
+    }
+    return NULL;
+}
+
+static relay_policy_pending_t * pending_alloc(relay_policy_t * p_policy)
+{
+    for (uint32_t i = 0; i < RELAY_POLICY_PENDING_COUNT; ++i)
+    {
+        if (!p_policy->pending[i].active)
+        {
+            return &p_policy->pending[i];
+        }
+    }
+    return NULL;
+}
+
+/** Orders the timer for the earliest back-off deadline, if any. */
+static void timer_update(relay_policy_t * p_policy)
+{
+    bool found = false;
+    timestamp_t earliest = 0;
+    for (uint32_t i = 0; i < RELAY_POLICY_PENDING_COUNT; ++i)
+    {
+        const relay_policy_pending_t * p_pending = &p_policy->pending[i];
+        if (p_pending->active && (!found || TIMER_OLDER_THAN(p_pending->deadline, earliest)))
+        {
+            earliest = p_pending->deadline;
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        timer_sch_reschedule(&p_policy->timer, earliest);
+    }
+}
+
+static void timeout(timestamp_t timestamp, void * p_context)
+{
+    relay_policy_t * p_policy = p_context;
+
+    /* The scheduler may fire the timer slightly ahead of the deadline it was ordered for. Relay
+     * everything up to that deadline, or the timer would be ordered for it again. */
+    timestamp_t limit = timestamp;
+    if (TIMER_OLDER_THAN(limit, p_policy->timer.timestamp))
+    {
+        limit = p_policy->timer.timestamp;
+    }
+
+    for (uint32_t i = 0; i < RELAY_POLICY_PENDING_COUNT; ++i)
+    {
+        relay_policy_pending_t * p_pending = &p_policy->pending[i];
+        if (p_pending->active && !TIMER_OLDER_THAN(limit, p_pending->deadline))
+        {
+            /* Free the slot before relaying, the packet isn't needed after the callback. */
+            p_pending->active = false;
+            p_policy->stats.relayed++;
+            p_policy->relay_cb(p_policy, &p_pending->metadata, &p_pending->packet, p_pending->payload_len);
+        }
+    }
+
+    timer_update(p_policy);
+}
+
+static bool counter_packet_in(relay_policy_t * p_policy,
+                              const network_packet_metadata_t * p_net_metadata,
+                              const packet_mesh_net_packet_t * p_net_packet,
+                              uint8_t payload_len)
+{
+    relay_policy_pending_t * p_pending = pending_alloc(p_policy);
+    if (p_pending == NULL)
+    {
+        /* Relaying without a back-off is better than not relaying at all. */
+        p_policy->stats.deferred_full++;
+        return true;
+    }
+
+    p_pending->active = true;
+    p_pending->count = 1;
+    p_pending->payload_len = payload_len;
+    p_pending->deadline = timer_now() + (rand_prng_get(&p_policy->prng) % p_policy->config.backoff_max_us);
+    memcpy(&p_pending->metadata, p_net_metadata, sizeof(p_pending->metadata));
+    memcpy(&p_pending->packet, p_net_packet, PACKET_MESH_NET_PDU_OFFSET + payload_len);
+    p_policy->stats.deferred++;
+
+    timer_update(p_policy);
+    return false;
+}
+
+static bool rssi_packet_in(relay_policy_t * p_policy, const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    int8_t rssi;
+    switch (p_rx_metadata->source)
+    {
+        case NRF_MESH_RX_SOURCE_SCANNER:
+            rssi = p_rx_metadata->params.scanner.rssi;
+            break;
+        case NRF_MESH_RX_SOURCE_INSTABURST:
+            rssi = p_rx_metadata->params.instaburst.rssi;
+            break;
+        default:
+            /* No radio link to the previous hop, always relay. */
+            return true;
+    }
+
+    if (rssi >= p_policy->config.rssi_threshold)
+    {
+        p_policy->stats.suppressed_rssi++;
+        return false;
+    }
+    return true;
+}
+
+static bool density_packet_in(relay_policy_t * p_policy)
+{
+    uint32_t neighbours = relay_policy_neighbour_count_get(p_policy);
+    if (neighbours > p_policy->config.density_target &&
+        (rand_prng_get(&p_policy->prng) % neighbours) >= p_policy->config.density_target)
+    {
+        p_policy->stats.suppressed_density++;
+        return false;
+    }
+    return true;
+}
+
+static bool neighbour_is_recent(const relay_policy_neighbour_t * p_neighbour, timestamp_t now)
+{
+    return (p_neighbour->active &&
+            TIMER_DIFF(now, p_neighbour->last_heard) < MS_TO_US(RELAY_POLICY_NEIGHBOUR_TIMEOUT_MS));
+}
+
+/******************************
+ * Public interface functions *
+ ******************************/
+
+void relay_policy_init(relay_policy_t * p_policy, relay_policy_relay_cb_t relay_cb)
+{
+    NRF_MESH_ASSERT(p_policy != NULL && relay_cb != NULL);
+
+    const relay_policy_config_t config = RELAY_POLICY_CONFIG_DEFAULT;
+
+    memset(p_policy, 0, sizeof(relay_policy_t));
+    p_policy->config = config;
+    p_policy->relay_cb = relay_cb;
+    p_policy->timer.cb = timeout;
+    p_policy->timer.p_context = p_policy;
+    rand_prng_seed(&p_policy->prng);
+}
+
+uint32_t relay_policy_config_set(relay_policy_t * p_policy, const relay_policy_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_policy != NULL);
+
+    if (p_config == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_config->type > RELAY_POLICY_TYPE_DENSITY ||
+        p_config->counter_threshold == 0 ||
+        p_config->backoff_max_us == 0 ||
+        p_config->density_target == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_policy->config = *p_config;
+    return NRF_SUCCESS;
+}
+
+void relay_policy_config_get(const relay_policy_t * p_policy, relay_policy_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_policy != NULL && p_config != NULL);
+    *p_config = p_policy->config;
+}
+
+bool relay_policy_packet_in(relay_policy_t * p_policy,
+                            const network_packet_metadata_t * p_net_metadata,
+                            const packet_mesh_net_packet_t * p_net_packet,
+                            uint8_t payload_len,
+                            const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    NRF_MESH_ASSERT(p_policy != NULL && p_net_metadata != NULL && p_net_packet != NULL && p_rx_metadata != NULL);
+
+    bool relay;
+    switch (p_policy->config.type)
+    {
+        case RELAY_POLICY_TYPE_COUNTER:
+            relay = counter_packet_in(p_policy, p_net_metadata, p_net_packet, payload_len);
+            break;
+        case RELAY_POLICY_TYPE_RSSI:
+            relay = rssi_packet_in(p_policy, p_rx_metadata);
+            break;
+        case RELAY_POLICY_TYPE_DENSITY:
+            relay = density_packet_in(p_policy);
+            break;
+        default:
+            relay = true;
+            break;
+    }
+
+    if (relay)
+    {
+        p_policy->stats.relayed++;
+    }
+    return relay;
+}
+
+void relay_policy_duplicate_in(relay_policy_t * p_policy, uint16_t src, uint32_t sequence_number)
+{
+    NRF_MESH_ASSERT(p_policy != NULL);
+
+    relay_policy_pending_t * p_pending = pending_find(p_policy, src, sequence_number);
+    if (p_pending != NULL)
+    {
+        p_policy->stats.duplicates++;
+        if (++p_pending->count >= p_policy->config.counter_threshold)
+        {
+            /* Enough neighbours have relayed the packet already. The timer is left running, as it
+             * will just find nothing to do for this slot. */
+            p_pending->active = false;
+            p_policy->stats.suppressed_counter++;
+            __LOG(LOG_SRC_NETWORK, LOG_LEVEL_DBG1, "Relay of 0x%04x:%u suppressed\n", src, sequence_number);
+        }
+    }
+}
+
+void relay_policy_neighbour_heard(relay_policy_t * p_policy, const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    NRF_MESH_ASSERT(p_policy != NULL && p_rx_metadata != NULL);
+
+    if (p_policy->config.type != RELAY_POLICY_TYPE_DENSITY ||
+        p_rx_metadata->source != NRF_MESH_RX_SOURCE_SCANNER)
+    {
+        return;
+    }
+
+    const uint8_t * p_addr = p_rx_metadata->params.scanner.adv_addr.addr;
+    timestamp_t now = timer_now();
+    relay_policy_neighbour_t * p_replace = &p_policy->neighbours[0];
+    for (uint32_t i = 0; i < RELAY_POLICY_NEIGHBOUR_COUNT; ++i)
+    {
+        relay_policy_neighbour_t * p_neighbour = &p_policy->neighbours[i];
+        if (p_neighbour->active && memcmp(p_neighbour->addr, p_addr, BLE_GAP_ADDR_LEN) == 0)
+        {
+            p_neighbour->last_heard = now;
+            return;
+        }
+
+        /* Replace the unused entry, or the one that has been silent the longest. */
+        if (p_replace->active &&
+            (!p_neighbour->active || TIMER_OLDER_THAN(p_neighbour->last_heard, p_replace->last_heard)))
+        {
+            p_replace = p_neighbour;
+        }
+    }
+
+    memcpy(p_replace->addr, p_addr, BLE_GAP_ADDR_LEN);
+    p_replace->last_heard = now;
+    p_replace->active = true;
+}
+
+uint32_t relay_policy_neighbour_count_get(const relay_policy_t * p_policy)
+{
+    NRF_MESH_ASSERT(p_policy != NULL);
+
+    timestamp_t now = timer_now();
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < RELAY_POLICY_NEIGHBOUR_COUNT; ++i)
+    {
+        if (neighbour_is_recent(&p_policy->neighbours[i], now))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void relay_policy_stats_get(const relay_policy_t * p_policy, relay_policy_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_policy != NULL && p_stats != NULL);
+    *p_stats = p_policy->stats;
+}
+
+void relay_policy_stats_clear(relay_policy_t * p_policy)
+{
+    NRF_MESH_ASSERT(p_policy != NULL);
+    memset(&p_policy->stats, 0, sizeof(p_policy->stats));
+}
@@ -0,0 +1,313 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "relay_queue.h"
+
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "utils.h"
+#include "log.h"
+
+/********************
+ * Static functions *
+ ********************/
+
+static uint32_t depth_get(const relay_queue_t * p_queue)
+{
+    uint32_t depth = 0;
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        if (p_queue->entries[i].active)
+        {
+            depth++;
+        }
+    }
+    return depth;
+}
+
+/** Gets the packet that has been waiting the longest, or NULL if the queue is empty. */
+static relay_queue_entry_t * oldest_get(relay_queue_t * p_queue)
+{
+    relay_queue_entry_t * p_oldest = NULL;
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        relay_queue_entry_t * p_entry = &p_queue->entries[i];
+        if (p_entry->active && (p_oldest == NULL || TIMER_OLDER_THAN(p_entry->queued, p_oldest->queued)))
+        {
+            p_oldest = p_entry;
+        }
+    }
+    return p_oldest;
+}
+
+/** Gets the packet to drop from a full queue, according to the drop policy. */
+static relay_queue_entry_t * victim_get(relay_queue_t * p_queue)
+{
+    if (p_queue->config.drop == RELAY_QUEUE_DROP_OLDEST)
+    {
+        return oldest_get(p_queue);
+    }
+
+    relay_queue_entry_t * p_victim = &p_queue->entries[0];
+    for (uint32_t i = 1; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        relay_queue_entry_t * p_entry = &p_queue->entries[i];
+        /* Of the packets with the lowest TTL, drop the oldest one. */
+        if (p_entry->metadata.ttl < p_victim->metadata.ttl ||
+            (p_entry->metadata.ttl == p_victim->metadata.ttl &&
+             TIMER_OLDER_THAN(p_entry->queued, p_victim->queued)))
+        {
+            p_victim = p_entry;
+        }
+    }
+    return p_victim;
+}
+
+static void aged_drop(relay_queue_t * p_queue, timestamp_t now)
+{
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        relay_queue_entry_t * p_entry = &p_queue->entries[i];
+        if (p_entry->active && TIMER_DIFF(now, p_entry->queued) > p_queue->config.max_age_us)
+        {
+            p_entry->active = false;
+            p_queue->stats.dropped_age++;
+        }
+    }
+}
+
+static bool is_held(relay_queue_t * p_queue, timestamp_t now)
+{
+    if (p_queue->held && !TIMER_OLDER_THAN(now, p_queue->held_until))
+    {
+        p_queue->held = false;
+    }
+    return p_queue->held;
+}
+
+/** Hands as many queued packets to the bearers as they will take, oldest first. */
+static void flush(relay_queue_t * p_queue)
+{
+    timestamp_t now = timer_now();
+    aged_drop(p_queue, now);
+
+    if (is_held(p_queue, now))
+    {
+        if (oldest_get(p_queue) != NULL)
+        {
+            timer_sch_reschedule(&p_queue->timer, p_queue->held_until);
+        }
+        return;
+    }
+
+    relay_queue_entry_t * p_entry;
+    while ((p_entry = oldest_get(p_queue)) != NULL)
+    {
+        if (!p_queue->tx_cb(p_queue, &p_entry->metadata, &p_entry->packet, p_entry->payload_len))
+        {
+            /* The bearers are still busy, try again later. */
+            timer_sch_reschedule(&p_queue->timer, now + MS_TO_US(RELAY_QUEUE_RETRY_INTERVAL_MS));
+            return;
+        }
+
+        uint32_t latency = TIMER_DIFF(now, p_entry->queued);
+        p_entry->active = false;
+        p_queue->stats.sent_queued++;
+        p_queue->stats.latency_total_us += latency;
+        p_queue->stats.latency_max_us = MAX(p_queue->stats.latency_max_us, latency);
+    }
+}
+
+static void timeout(timestamp_t timestamp, void * p_context)
+{
+    relay_queue_t * p_queue = p_context;
+
+    /* The scheduler may fire the timer slightly ahead of the deadline it was ordered for. The
+     * hold-off is over if the timer was ordered for its end, or the timer would be ordered for it
+     * again. */
+    if (p_queue->held && !TIMER_OLDER_THAN(p_queue->timer.timestamp, p_queue->held_until))
+    {
+        p_queue->held = false;
+    }
+    flush(p_queue);
+}
+
+/******************************
+ * Public interface functions *
+ ******************************/
+
+void relay_queue_init(relay_queue_t * p_queue, relay_queue_tx_cb_t tx_cb)
+{
+    NRF_MESH_ASSERT(p_queue != NULL && tx_cb != NULL);
+
+    const relay_queue_config_t config = RELAY_QUEUE_CONFIG_DEFAULT;
+
+    memset(p_queue, 0, sizeof(relay_queue_t));
+    p_queue->config = config;
+    p_queue->tx_cb = tx_cb;
+    p_queue->timer.cb = timeout;
+    p_queue->timer.p_context = p_queue;
+}
+
+uint32_t relay_queue_config_set(relay_queue_t * p_queue, const relay_queue_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_queue != NULL);
+
+    if (p_config == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_config->priority > RELAY_QUEUE_PRIORITY_ORIGINATOR ||
+        p_config->drop > RELAY_QUEUE_DROP_LOWEST_TTL ||
+        p_config->max_age_us == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_queue->config = *p_config;
+    if (p_config->priority != RELAY_QUEUE_PRIORITY_ORIGINATOR)
+    {
+        p_queue->held = false;
+    }
+    return NRF_SUCCESS;
+}
+
+void relay_queue_config_get(const relay_queue_t * p_queue, relay_queue_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_queue != NULL && p_config != NULL);
+    *p_config = p_queue->config;
+}
+
+void relay_queue_push(relay_queue_t * p_queue,
+                      const network_packet_metadata_t * p_net_metadata,
+                      const packet_mesh_net_packet_t * p_net_packet,
+                      uint8_t payload_len)
+{
+    NRF_MESH_ASSERT(p_queue != NULL && p_net_metadata != NULL && p_net_packet != NULL);
+
+    timestamp_t now = timer_now();
+    aged_drop(p_queue, now);
+
+    if (oldest_get(p_queue) == NULL && !is_held(p_queue, now))
+    {
+        network_packet_metadata_t metadata = *p_net_metadata;
+        if (p_queue->tx_cb(p_queue, &metadata, p_net_packet, payload_len))
+        {
+            p_queue->stats.sent_direct++;
+            return;
+        }
+    }
+
+    relay_queue_entry_t * p_entry = NULL;
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE && p_entry == NULL; ++i)
+    {
+        if (!p_queue->entries[i].active)
+        {
+            p_entry = &p_queue->entries[i];
+        }
+    }
+
+    if (p_entry == NULL)
+    {
+        p_entry = victim_get(p_queue);
+        p_queue->stats.dropped_full++;
+        if (p_queue->config.drop == RELAY_QUEUE_DROP_LOWEST_TTL &&
+            p_net_metadata->ttl <= p_entry->metadata.ttl)
+        {
+            /* The new packet is the one with the fewest hops left. */
+            __LOG(LOG_SRC_NETWORK, LOG_LEVEL_WARN, "Relay queue full, dropped new packet.\n");
+            return;
+        }
+        __LOG(LOG_SRC_NETWORK, LOG_LEVEL_WARN, "Relay queue full, dropped 0x%04x:%u.\n",
+              p_entry->metadata.src, p_entry->metadata.internal.sequence_number);
+    }
+
+    p_entry->active = true;
+    p_entry->payload_len = payload_len;
+    p_entry->queued = now;
+    memcpy(&p_entry->metadata, p_net_metadata, sizeof(p_entry->metadata));
+    memcpy(&p_entry->packet, p_net_packet, PACKET_MESH_NET_PDU_OFFSET + payload_len);
+
+    uint16_t depth = depth_get(p_queue);
+    p_queue->stats.depth_max = MAX(p_queue->stats.depth_max, depth);
+
+    if (p_queue->timer.state == TIMER_EVENT_STATE_UNUSED)
+    {
+        timer_sch_reschedule(&p_queue->timer,
+                             is_held(p_queue, now) ? p_queue->held_until
+                                                   : now + MS_TO_US(RELAY_QUEUE_RETRY_INTERVAL_MS));
+    }
+}
+
+bool relay_queue_originator_allowed(relay_queue_t * p_queue)
+{
+    NRF_MESH_ASSERT(p_queue != NULL);
+
+    if (p_queue->config.priority == RELAY_QUEUE_PRIORITY_RELAY && oldest_get(p_queue) != NULL)
+    {
+        p_queue->stats.originator_deferred++;
+        return false;
+    }
+    return true;
+}
+
+void relay_queue_originator_sent(relay_queue_t * p_queue)
+{
+    NRF_MESH_ASSERT(p_queue != NULL);
+
+    if (p_queue->config.priority == RELAY_QUEUE_PRIORITY_ORIGINATOR)
+    {
+        p_queue->held = true;
+        p_queue->held_until = timer_now() + MS_TO_US(RELAY_QUEUE_ORIGINATOR_HOLDOFF_MS);
+    }
+}
+
+void relay_queue_stats_get(const relay_queue_t * p_queue, relay_queue_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_queue != NULL && p_stats != NULL);
+    *p_stats = p_queue->stats;
+    p_stats->depth = depth_get(p_queue);
+}
+
+void relay_queue_stats_clear(relay_queue_t * p_queue)
+{
+    NRF_MESH_ASSERT(p_queue != NULL);
+    memset(&p_queue->stats, 0, sizeof(p_queue->stats));
+}
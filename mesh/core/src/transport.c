@@ -50,6 +50,7 @@
 #include "network.h"
 #include "net_state.h"
 #include "replay_cache.h"
+#include "transport_rtt.h"
 #include "internal_event.h"
 #include "timer_scheduler.h"
 #include "bearer_event.h"
@@ -59,6 +60,7 @@
 #include "nrf_mesh_utils.h"
 #include "nrf_mesh_externs.h"
 #include "packet_mesh.h"
+#include "mesh_stats.h"
 
 /*********************
  * Local definitions *
@@ -82,6 +84,12 @@ NRF_MESH_STATIC_ASSERT(NRF_MESH_SEG_PAYLOAD_SIZE_MAX == TRANSPORT_SAR_SEGMENT_CO
                        PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE);
 /* Checks whether the maximum unsegmented access payload is according to 3.7.3 Access payload */
 NRF_MESH_STATIC_ASSERT(NRF_MESH_UNSEG_PAYLOAD_SIZE_MAX == PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE);
+#if TRANSPORT_BULK_ENABLE
+/* Bulk transfer PDUs must be longer than regular unsegmented PDUs, and their network PDUs must fit
+ * in the 8-bit length fields of the network layer. */
+NRF_MESH_STATIC_ASSERT(TRANSPORT_BULK_PDU_MAX_SIZE > PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE);
+NRF_MESH_STATIC_ASSERT(PACKET_MESH_NET_BUFFER_SIZE <= UINT8_MAX);
+#endif
 
 /*********************
  * Local types *
@@ -102,6 +110,8 @@ typedef struct
     uint8_t tx_retries;                    /**< Number of retries before canceling SAR session. */
     uint8_t segack_ttl; /**< Default TTL value for segment acknowledgment messages. */
     uint8_t szmic;      /**< Use 32- or 64-bit MIC for application payload. */
+    bool tx_retry_adaptive; /**< Derive the TX retry timeout from the measured round trip time. */
+    bool bulk_enabled;      /**< Send long access messages unsegmented on the bearers that can carry them. */
 } transport_config_t;
 
 typedef struct
@@ -115,6 +125,7 @@ typedef struct
 typedef struct
 {
     bool segmented;
+    bool bulk; /**< Whether a segmented message may be sent as a single bulk transfer PDU instead. */
     uint8_t mic_size;
     union
     {
@@ -176,6 +187,8 @@ typedef struct
                 uint8_t  retries;               /**< Number of retries left. */
                 bool payload_encrypted;         /**< Flag indicating whether the payload has been encrypted. */
                 bool seqzero_is_set;         /**< Flag indicating whether the seqzero has been set. */
+                bool retransmitted;             /**< Flag indicating whether any segment has been sent more than once. */
+                timestamp_t round_timestamp;    /**< Time of the last round of segments. */
                 nrf_mesh_tx_token_t token;      /**< TX Token set by the user. */
             } tx;
             /** Fields that are only valid for RX-sessions */
@@ -289,6 +302,18 @@ static inline uint32_t tx_retry_timer_delay_get(uint8_t ttl)
     return m_trs_config.tx_retry_base_timeout + m_trs_config.tx_retry_per_hop_addition * ttl;
 }
 
+/** Gets the TX retry timeout for a unicast destination, preferring the measured round trip time. */
+static uint32_t tx_retry_timer_unicast_delay_get(const trs_sar_ctx_t * p_sar_ctx)
+{
+    uint32_t delay;
+    if (!m_trs_config.tx_retry_adaptive ||
+        !transport_rtt_timeout_get(p_sar_ctx->metadata.net.dst.value, &delay))
+    {
+        delay = tx_retry_timer_delay_get(p_sar_ctx->metadata.net.ttl);
+    }
+    return delay;
+}
+
 /**
  * Check whether the RX SAR session has been handled before. As the sessions are stored in a FIFO
  * cache manner, getting a pointer to the completed session.
@@ -397,6 +422,7 @@ static bool sar_ctx_alloc(trs_sar_ctx_t * p_sar_ctx,
     /* The IV index should stay the same for the duration of the session. */
     net_state_iv_index_lock(true);
     p_sar_ctx->session.session_type = session_type;
+    MESH_STATS_INC(session_type == TRS_SAR_SESSION_TX ? MESH_STATS_TRS_SAR_TX_START : MESH_STATS_TRS_SAR_RX_START);
     return true;
 }
 
@@ -419,6 +445,7 @@ static void sar_ctx_cancel(trs_sar_ctx_t * p_sar_ctx, nrf_mesh_sar_session_cance
     NRF_MESH_ASSERT(p_sar_ctx != NULL);
 
     __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_SAR_CANCELLED, reason, 0, NULL);
+    MESH_STATS_INC(p_sar_ctx->session.session_type == TRS_SAR_SESSION_TX ? MESH_STATS_TRS_SAR_TX_FAIL : MESH_STATS_TRS_SAR_RX_FAIL);
 
     sar_rx_session_mark_as_handled(&p_sar_ctx->metadata, false);
     m_send_sar_cancel_event(p_sar_ctx->session.params.tx.token, reason);
@@ -432,6 +459,7 @@ static void sar_ctx_rx_complete(trs_sar_ctx_t * p_sar_ctx)
 {
     sar_rx_session_mark_as_handled(&p_sar_ctx->metadata, true);
     sar_ctx_free(p_sar_ctx);
+    MESH_STATS_INC(MESH_STATS_TRS_SAR_RX_COMPLETE);
 }
 
 static void sar_ctx_tx_complete(trs_sar_ctx_t * p_sar_ctx)
@@ -442,6 +470,7 @@ static void sar_ctx_tx_complete(trs_sar_ctx_t * p_sar_ctx)
     evt.params.tx_complete.token = p_sar_ctx->session.params.tx.token;
     event_handle(&evt);
     sar_ctx_free(p_sar_ctx);
+    MESH_STATS_INC(MESH_STATS_TRS_SAR_TX_COMPLETE);
     __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_SAR_SUCCESS, 0, 0, NULL);
 }
 
@@ -466,7 +495,7 @@ static void tx_retry_timer_reset(trs_sar_ctx_t * p_sar_ctx)
 
     if (p_sar_ctx->metadata.net.dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
     {
-        p_sar_ctx->timer_event.interval = tx_retry_timer_delay_get(p_sar_ctx->metadata.net.ttl);
+        p_sar_ctx->timer_event.interval = tx_retry_timer_unicast_delay_get(p_sar_ctx);
     }
     else
     {
@@ -474,7 +503,9 @@ static void tx_retry_timer_reset(trs_sar_ctx_t * p_sar_ctx)
          * point in scaling the retry interval according to TTL. */
         p_sar_ctx->timer_event.interval = tx_retry_timer_delay_get(0);
     }
-    timer_sch_reschedule(&p_sar_ctx->timer_event, timer_now() + p_sar_ctx->timer_event.interval);
+    p_sar_ctx->session.params.tx.round_timestamp = timer_now();
+    timer_sch_reschedule(&p_sar_ctx->timer_event,
+                         p_sar_ctx->session.params.tx.round_timestamp + p_sar_ctx->timer_event.interval);
 }
 
 static void trs_packet_header_build(const transport_packet_metadata_t * p_metadata, packet_mesh_trs_packet_t * p_packet)
@@ -816,6 +847,10 @@ static uint32_t transport_metadata_from_tx_params(transport_packet_metadata_t *
 
     p_metadata->segmented = ((p_tx_params->data_len > PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE - p_metadata->mic_size) ||
                              p_tx_params->force_segmented);
+    /* Unsegmented PDUs can't signal a large TransMIC, see Table 3.42 of Mesh Profile Specification v1.0. */
+    p_metadata->bulk = (m_trs_config.bulk_enabled && p_metadata->segmented && !p_tx_params->force_segmented &&
+                        p_metadata->mic_size == PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE &&
+                        p_tx_params->data_len + p_metadata->mic_size <= TRANSPORT_BULK_PDU_MAX_SIZE);
 
     if (p_metadata->segmented)
     {
@@ -845,6 +880,7 @@ static void transport_metadata_from_control_tx_params(
     p_metadata->p_security_material = NULL;
     p_metadata->segmented = ((p_tx_params->data_len > PACKET_MESH_TRS_UNSEG_CONTROL_PDU_MAX_SIZE) ||
                              p_tx_params->reliable);
+    p_metadata->bulk = false;
     p_metadata->mic_size = PACKET_MESH_TRS_TRANSMIC_CONTROL_SIZE;
 
     if (p_metadata->segmented)
@@ -865,14 +901,10 @@ static void transport_metadata_from_control_tx_params(
     p_metadata->token = tx_token;
 }
 
-static uint32_t unsegmented_packet_tx(transport_packet_metadata_t * p_metadata,
-                                      const uint8_t * p_payload,
-                                      uint32_t payload_len)
+static uint32_t unsegmented_packet_out(transport_packet_metadata_t * p_metadata,
+                                       const uint8_t * p_payload,
+                                       uint32_t payload_len)
 {
-    if (payload_len + p_metadata->mic_size > TRANSPORT_UNSEG_PDU_LEN(p_metadata->net.control_packet))
-    {
-        return NRF_ERROR_INVALID_LENGTH;
-    }
     network_tx_packet_buffer_t net_buf;
 
     uint8_t * p_packet_buffer_payload;
@@ -898,6 +930,38 @@ static uint32_t unsegmented_packet_tx(transport_packet_metadata_t * p_metadata,
     return status;
 }
 
+static uint32_t unsegmented_packet_tx(transport_packet_metadata_t * p_metadata,
+                                      const uint8_t * p_payload,
+                                      uint32_t payload_len)
+{
+    if (payload_len + p_metadata->mic_size > TRANSPORT_UNSEG_PDU_LEN(p_metadata->net.control_packet))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    return unsegmented_packet_out(p_metadata, p_payload, payload_len);
+}
+
+/**
+ * Sends a message that would otherwise be segmented as a single unsegmented bulk transfer PDU.
+ *
+ * Only the bearers that can carry long network PDUs accept the packet, so the allocation fails if
+ * there are none, and the message must be segmented instead.
+ *
+ * @returns Whether the message was sent.
+ */
+static bool bulk_packet_tx(transport_packet_metadata_t * p_metadata,
+                           const uint8_t * p_payload,
+                           uint32_t payload_len)
+{
+    p_metadata->segmented = false;
+    if (unsegmented_packet_out(p_metadata, p_payload, payload_len) == NRF_SUCCESS)
+    {
+        return true;
+    }
+    p_metadata->segmented = true;
+    return false;
+}
+
 static bool sar_segment_send(trs_sar_ctx_t * p_sar_ctx, uint32_t segment_index)
 {
     uint32_t segment_len = TRANSPORT_SAR_PDU_LEN(p_sar_ctx->metadata.net.control_packet);
@@ -1212,6 +1276,16 @@ static void segack_packet_in(const packet_mesh_trs_control_packet_t * p_trs_cont
     {
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_TRS_ACK_RECEIVED, 0, control_packet_len, p_trs_control_packet);
 
+        /* Only measure acks for segments that have been sent once, as we can't tell which
+         * transmission a retransmitted segment is acknowledged for (Karn's algorithm). */
+        if (m_trs_config.tx_retry_adaptive &&
+            !p_sar_ctx->session.params.tx.retransmitted &&
+            (block_ack & ~p_sar_ctx->session.block_ack) != 0)
+        {
+            transport_rtt_sample_add(p_sar_ctx->metadata.net.dst.value,
+                                     TIMER_DIFF(timer_now(), p_sar_ctx->session.params.tx.round_timestamp));
+        }
+
         p_sar_ctx->session.block_ack |= block_ack;
         if (block_ack == 0)
         {
@@ -1229,6 +1303,7 @@ static void segack_packet_in(const packet_mesh_trs_control_packet_t * p_trs_cont
              * shall reset the segment transmission timer and retransmit all unacknowledged Lower
              * Transport PDUs." */
              p_sar_ctx->session.params.tx.start_index = 0;
+             p_sar_ctx->session.params.tx.retransmitted = true;
              (void) trs_sar_packet_out(p_sar_ctx); /* Ignore return, as we'll reset the retry timer regardless. */
              tx_retry_timer_reset(p_sar_ctx);
         }
@@ -1318,6 +1393,7 @@ static void upper_transport_access_packet_in(const uint8_t * p_upper_trs_packet,
     else
     {
         __LOG(LOG_SRC_TRANSPORT, LOG_LEVEL_DBG2, "Could not decrypt transport layer data.\n");
+        MESH_STATS_INC(MESH_STATS_TRS_RX_DROP_DECRYPT);
 
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_DROPPED,
                                 (p_metadata->type.access.using_app_key ? PACKET_DROPPED_INVALID_APPKEY
@@ -1378,6 +1454,14 @@ static void retry_timeout(timestamp_t timestamp, void * p_context)
     {
         p_sar_ctx->session.params.tx.retries--;
         p_sar_ctx->session.params.tx.start_index = 0;
+        p_sar_ctx->session.params.tx.retransmitted = true;
+        p_sar_ctx->session.params.tx.round_timestamp = timestamp;
+        if (m_trs_config.tx_retry_adaptive &&
+            p_sar_ctx->metadata.net.dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
+        {
+            p_sar_ctx->timer_event.interval = transport_rtt_timeout_expired(p_sar_ctx->metadata.net.dst.value,
+                                                                            p_sar_ctx->timer_event.interval);
+        }
         (void) trs_sar_packet_out(p_sar_ctx);/* Ignore return, as the timer will be rescheduled regardless. */
     }
 }
@@ -1414,6 +1498,11 @@ static uint32_t upper_transport_tx(transport_packet_metadata_t * p_metadata, con
         return NRF_ERROR_INVALID_PARAM;
     }
 
+    if (p_metadata->bulk && bulk_packet_tx(p_metadata, p_data, data_len))
+    {
+        return NRF_SUCCESS;
+    }
+
     if (p_metadata->segmented)
     {
         return segmented_packet_tx(p_metadata, p_data, data_len);
@@ -1445,6 +1534,9 @@ void transport_init(const nrf_mesh_init_params_t * p_init_params)
     m_trs_config.tx_retries                = TRANSPORT_SAR_TX_RETRIES_DEFAULT;
     m_trs_config.szmic                     = NRF_MESH_TRANSMIC_SIZE_SMALL;
     m_trs_config.segack_ttl                = TRANSPORT_SAR_SEGACK_TTL_DEFAULT;
+    m_trs_config.tx_retry_adaptive         = false;
+    m_trs_config.bulk_enabled              = false;
+    transport_rtt_init();
     m_sar_process_flag = bearer_event_flag_add(transport_sar_process);
     m_control_packet_consumer_count = 0;
 
@@ -1495,6 +1587,7 @@ uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
 
     if (!nrf_mesh_rx_address_get(p_net_metadata->dst.value, &dst_addr))
     {
+        MESH_STATS_INC(MESH_STATS_TRS_RX_DROP_UNKNOWN_DST);
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_DROPPED,
                               PACKET_DROPPED_UNKNOWN_ADDRESS,
                               trs_packet_len,
@@ -1506,6 +1599,7 @@ uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
                               p_net_metadata->internal.sequence_number,
                               p_net_metadata->internal.iv_index & NETWORK_IVI_MASK))
     {
+        MESH_STATS_INC(MESH_STATS_TRS_RX_DROP_REPLAY);
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_PACKET_DROPPED,
                               PACKET_DROPPED_REPLAY_CACHE,
                               trs_packet_len,
@@ -1518,6 +1612,7 @@ uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
                               p_net_metadata->internal.iv_index & NETWORK_IVI_MASK);
     if (status != NRF_SUCCESS)
     {
+        MESH_STATS_INC(MESH_STATS_TRS_RX_DROP_REPLAY_FULL);
         m_send_replay_cache_full_event(p_net_metadata->src,
                                        p_net_metadata->internal.iv_index & NETWORK_IVI_MASK,
                                        NRF_MESH_RX_FAILED_REASON_REPLAY_CACHE_FULL);
@@ -1680,6 +1775,26 @@ uint32_t transport_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * const p_
             m_trs_config.szmic = p_opt->opt.val;
             break;
 
+        case NRF_MESH_OPT_TRS_SAR_TX_RETRY_ADAPTIVE:
+            if (p_opt->opt.val > 1)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            m_trs_config.tx_retry_adaptive = (p_opt->opt.val == 1);
+            break;
+
+        case NRF_MESH_OPT_TRS_BULK_ENABLE:
+#if TRANSPORT_BULK_ENABLE
+            if (p_opt->opt.val > 1)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            m_trs_config.bulk_enabled = (p_opt->opt.val == 1);
+            break;
+#else
+            return NRF_ERROR_NOT_SUPPORTED;
+#endif
+
         default:
             return NRF_ERROR_NOT_FOUND;
     }
@@ -1728,6 +1843,14 @@ uint32_t transport_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * const p_opt)
             p_opt->opt.val = m_trs_config.szmic;
             break;
 
+        case NRF_MESH_OPT_TRS_SAR_TX_RETRY_ADAPTIVE:
+            p_opt->opt.val = m_trs_config.tx_retry_adaptive;
+            break;
+
+        case NRF_MESH_OPT_TRS_BULK_ENABLE:
+            p_opt->opt.val = m_trs_config.bulk_enabled;
+            break;
+
         default:
             return NRF_ERROR_NOT_FOUND;
     }
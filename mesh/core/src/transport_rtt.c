@@ -0,0 +1,174 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "transport_rtt.h"
+
+#include <string.h>
+
+#include "nrf_mesh_assert.h"
+
+typedef struct
+{
+    uint16_t dst;      /**< Destination address, or @c NRF_MESH_ADDR_UNASSIGNED if the entry is unused. */
+    uint32_t srtt;     /**< Smoothed round trip time in microseconds. */
+    uint32_t rttvar;   /**< Round trip time variation in microseconds. */
+    uint32_t backoff;  /**< Backed off retry timeout in microseconds, used until there is an estimate. */
+    uint8_t timeout_count; /**< Number of retry timeouts since the last measurement. */
+    uint32_t last_use; /**< Value of the use counter when the entry was last updated. */
+} transport_rtt_entry_t;
+
+static transport_rtt_entry_t m_entries[TRANSPORT_RTT_ENTRY_COUNT];
+static uint32_t m_use_counter;
+
+static transport_rtt_entry_t * entry_get(uint16_t dst)
+{
+    for (uint32_t i = 0; i < TRANSPORT_RTT_ENTRY_COUNT; ++i)
+    {
+        if (m_entries[i].dst == dst)
+        {
+            return &m_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static transport_rtt_entry_t * entry_replace(uint16_t dst)
+{
+    transport_rtt_entry_t * p_oldest = &m_entries[0];
+    for (uint32_t i = 0; i < TRANSPORT_RTT_ENTRY_COUNT; ++i)
+    {
+        if (m_entries[i].dst == NRF_MESH_ADDR_UNASSIGNED)
+        {
+            p_oldest = &m_entries[i];
+            break;
+        }
+        else if ((int32_t) (m_entries[i].last_use - p_oldest->last_use) < 0)
+        {
+            p_oldest = &m_entries[i];
+        }
+    }
+    memset(p_oldest, 0, sizeof(transport_rtt_entry_t));
+    p_oldest->dst = dst;
+    return p_oldest;
+}
+
+void transport_rtt_init(void)
+{
+    memset(m_entries, 0, sizeof(m_entries));
+    m_use_counter = 0;
+}
+
+void transport_rtt_sample_add(uint16_t dst, uint32_t rtt_us)
+{
+    NRF_MESH_ASSERT(dst != NRF_MESH_ADDR_UNASSIGNED);
+
+    transport_rtt_entry_t * p_entry = entry_get(dst);
+    if (p_entry == NULL || p_entry->srtt == 0)
+    {
+        /* First measurement: SRTT = R, RTTVAR = R / 2 (RFC 6298, section 2.2). */
+        if (p_entry == NULL)
+        {
+            p_entry = entry_replace(dst);
+        }
+        p_entry->srtt = MAX(rtt_us, 1);
+        p_entry->rttvar = rtt_us / 2;
+    }
+    else
+    {
+        /* RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R (RFC 6298, section 2.3). */
+        uint32_t error = (p_entry->srtt > rtt_us) ? (p_entry->srtt - rtt_us) : (rtt_us - p_entry->srtt);
+        p_entry->rttvar = (3 * (uint64_t) p_entry->rttvar + error) / 4;
+        p_entry->srtt = (7 * (uint64_t) p_entry->srtt + rtt_us) / 8;
+    }
+    p_entry->backoff = 0;
+    p_entry->timeout_count = 0;
+    p_entry->last_use = ++m_use_counter;
+}
+
+uint32_t transport_rtt_timeout_expired(uint16_t dst, uint32_t timeout_us)
+{
+    NRF_MESH_ASSERT(dst != NRF_MESH_ADDR_UNASSIGNED);
+
+    transport_rtt_entry_t * p_entry = entry_get(dst);
+    if (p_entry == NULL)
+    {
+        p_entry = entry_replace(dst);
+    }
+    p_entry->last_use = ++m_use_counter;
+
+    if (p_entry->srtt != 0)
+    {
+        if (++p_entry->timeout_count < TRANSPORT_RTT_TIMEOUT_COUNT_MAX)
+        {
+            /* With an estimate, a timeout is most likely a lost packet, which is best recovered
+             * from by retrying at the estimated timeout. */
+            uint32_t estimate;
+            (void) transport_rtt_timeout_get(dst, &estimate);
+            return estimate;
+        }
+
+        /* Retransmitted segments can't be measured, so an estimate that has become too short
+         * would never be corrected. Start over from backing off. */
+        p_entry->srtt = 0;
+        p_entry->rttvar = 0;
+    }
+
+    p_entry->backoff = MIN(2 * (uint64_t) timeout_us, TRANSPORT_RTT_TIMEOUT_MAX_US);
+    return p_entry->backoff;
+}
+
+bool transport_rtt_timeout_get(uint16_t dst, uint32_t * p_timeout_us)
+{
+    NRF_MESH_ASSERT(p_timeout_us != NULL);
+
+    const transport_rtt_entry_t * p_entry = entry_get(dst);
+    if (dst == NRF_MESH_ADDR_UNASSIGNED || p_entry == NULL)
+    {
+        return false;
+    }
+
+    uint64_t timeout;
+    if (p_entry->srtt != 0)
+    {
+        timeout = (uint64_t) p_entry->srtt + MAX(TRANSPORT_RTT_GRANULARITY_US, 4 * (uint64_t) p_entry->rttvar);
+    }
+    else
+    {
+        timeout = p_entry->backoff;
+    }
+    *p_timeout_us = (uint32_t) MIN(MAX(timeout, TRANSPORT_RTT_TIMEOUT_MIN_US), TRANSPORT_RTT_TIMEOUT_MAX_US);
+    return true;
+}
@@ -78,7 +78,7 @@ typedef struct bl_cmd bl_cmd_t; /**< Forward declaration of @c bl_cmd_t from bl_
 #define DFU_FWID_LEN_SD             (2)
 
 /** First OpenMesh handle considered a DFU packet. */
-#define DFU_HANDLE_RANGE_START      (0xFFF9)
+#define DFU_HANDLE_RANGE_START      (0xFFF8)
 
 /**
  * @defgroup DFU_PACKET_LENGTH Retention register values for the bootloader
@@ -101,6 +101,8 @@ typedef struct bl_cmd bl_cmd_t; /**< Forward declaration of @c bl_cmd_t from bl_
 #define DFU_PACKET_LEN_DATA_REQ     (2 + 2 + 4)
 /** DATA RESPONSE packet packet length */
 #define DFU_PACKET_LEN_DATA_RSP     (2 + 2 + 4 + SEGMENT_LENGTH)
+/** DATA REPAIR packet packet length */
+#define DFU_PACKET_LEN_DATA_REPAIR  (2 + 2 + 4 + 1 + 1 + SEGMENT_LENGTH)
 /** RELAY REQUEST packet packet length */
 #define DFU_PACKET_LEN_RELAY_REQ    (2 + 2 + 4 + BLE_GAP_ADDR_LEN)
 
@@ -132,6 +134,7 @@ typedef struct __attribute((packed))
 /** Types of DFU packets. */
 typedef enum
 {
+    DFU_PACKET_TYPE_DATA_REPAIR = 0xFFF8, /**< Data repair packet. */
     DFU_PACKET_TYPE_RELAY_REQ   = 0xFFF9, /**< Relay request packet. */
     DFU_PACKET_TYPE_DATA_RSP    = 0xFFFA, /**< Data response packet. */
     DFU_PACKET_TYPE_DATA_REQ    = 0xFFFB, /**< Data request packet. */
@@ -194,6 +197,15 @@ typedef struct __attribute((packed))
             uint32_t transaction_id;                             /**< Transaction ID the data segment belongs to. */
             uint8_t data[NRF_MESH_DFU_SEGMENT_LENGTH];           /**< Data in the segment. */
         } rsp_data;
+        /** Data repair packet parameters. */
+        struct __attribute((packed))
+        {
+            uint16_t block;                                      /**< Forward error correction block the repair segment belongs to. */
+            uint32_t transaction_id;                             /**< Transaction ID the repair segment belongs to. */
+            uint8_t block_size;                                  /**< Number of data segments in each block. */
+            uint8_t index;                                       /**< Index of the repair segment in its block. */
+            uint8_t data[NRF_MESH_DFU_SEGMENT_LENGTH];           /**< Combination of the data segments in the block. */
+        } repair;
         /** Relay request packet parameters. */
         struct __attribute((packed))
         {
@@ -124,6 +124,14 @@ typedef struct mesh_gatt mesh_gatt_t;
 
 typedef void (*mesh_gatt_evt_handler_t)(const mesh_gatt_evt_t * p_evt, void * p_context);
 
+/**
+ * Release callback for packets sent by reference.
+ *
+ * @param[in] conn_index Connection index the packet was sent on.
+ * @param[in] p_data     Data pointer given in the corresponding @ref mesh_gatt_packet_ref_send() call.
+ */
+typedef void (*mesh_gatt_packet_ref_release_cb_t)(uint16_t conn_index, uint8_t * p_data);
+
 typedef struct
 {
     /** Pointer to the current active packet buffer packet. */
@@ -222,6 +230,44 @@ uint8_t * mesh_gatt_packet_alloc(uint16_t conn_index,
  */
 uint32_t mesh_gatt_packet_send(uint16_t conn_index, const uint8_t * p_packet);
 
+/**
+ * Allocates a packet whose payload is sent by reference, for the given connection index and PDU type.
+ *
+ * Only the PDU header is stored in the connection buffer, which lets the same payload be queued
+ * on several connections without copying it. The returned pointer shall be passed to
+ * @ref mesh_gatt_packet_ref_send() or @ref mesh_gatt_packet_discard(), and must not be written to.
+ *
+ * @param[in]     conn_index Connection index.
+ * @param[in]     type       Type of Mesh GATT PDU.
+ * @param[in]     token      TX token that shall be present in the TX complete callback for the packet.
+ * @returns a packet handle or @c NULL if no buffer could be allocated.
+ */
+uint8_t * mesh_gatt_packet_ref_alloc(uint16_t conn_index,
+                                     mesh_gatt_pdu_type_t type,
+                                     nrf_mesh_tx_token_t token);
+
+/**
+ * Sends a packet allocated with @ref mesh_gatt_packet_ref_alloc(), referencing the given payload.
+ *
+ * The payload must stay valid until @p release_cb is called, which happens once the packet has
+ * been transmitted or the connection is terminated. The byte in front of @p p_data is overwritten
+ * with the PDU header.
+ *
+ * @param[in]     conn_index Connection index of the Mesh GATT connection to transmit the packet.
+ * @param[in]     p_packet   Packet handle returned by @ref mesh_gatt_packet_ref_alloc().
+ * @param[in,out] p_data     Payload to send, with one writable byte in front of it.
+ * @param[in]     length     Length of the payload.
+ * @param[in]     release_cb Callback to release the payload with.
+ * @retval NRF_SUCCESS             Successfully started packet transmission.
+ * @retval NRF_ERROR_INVALID_STATE The given @c conn_index is not in a connected state. The payload
+ *                                 is not referenced, and the packet must be discarded.
+ */
+uint32_t mesh_gatt_packet_ref_send(uint16_t conn_index,
+                                   const uint8_t * p_packet,
+                                   uint8_t * p_data,
+                                   uint16_t length,
+                                   mesh_gatt_packet_ref_release_cb_t release_cb);
+
 /**
  * Discards a previously allocated packet.
  *
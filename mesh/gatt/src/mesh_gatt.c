@@ -73,8 +73,10 @@ typedef struct __attribute((packed))
 typedef struct __attribute((packed))
 {
     nrf_mesh_tx_token_t token;
+    uint8_t * p_ref;            /**< Referenced payload following the header, or NULL if stored in @c pdu. */
+    mesh_gatt_packet_ref_release_cb_t release_cb; /**< Release callback for @c p_ref. */
     uint8_t length;             /**< Length of the PDU. */
-    uint8_t pdu[];
+    uint8_t pdu[];              /**< PDU, or only the PDU header if @c p_ref is set. */
 } mesh_gatt_proxy_buffer_t;
 
 /*******************************************************************************
@@ -146,8 +148,29 @@ static void mesh_gatt_pdu_send(uint16_t conn_index)
     //__LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "mesh_gatt_pdu_send ASSERT length <= p_conn->effective_mtu\n");
     NRF_MESH_ASSERT(length <= p_conn->effective_mtu);
 
-    mesh_gatt_proxy_pdu_t * p_proxy_pdu =
-        (mesh_gatt_proxy_pdu_t *) &p_proxy_buffer->pdu[p_conn->tx.transaction.offset];
+    mesh_gatt_proxy_pdu_t * p_proxy_pdu;
+    uint8_t segment[MESH_GATT_MTU_SIZE_MAX];
+    if (p_proxy_buffer->p_ref == NULL)
+    {
+        p_proxy_pdu = (mesh_gatt_proxy_pdu_t *) &p_proxy_buffer->pdu[p_conn->tx.transaction.offset];
+    }
+    else if (sar_type == PROXY_SAR_TYPE_COMPLETE)
+    {
+        /* Send straight from the referenced payload, with the header in the byte in front of it. */
+        p_proxy_pdu = (mesh_gatt_proxy_pdu_t *) &p_proxy_buffer->p_ref[-1];
+        p_proxy_pdu->pdu_type = ((mesh_gatt_proxy_pdu_t *) p_proxy_buffer->pdu)->pdu_type;
+    }
+    else
+    {
+        /* The referenced payload may be shared with other connections, so segments can't be
+         * built in place. The offset counts the header, which isn't part of the payload. */
+        NRF_MESH_ASSERT(length <= sizeof(segment));
+        p_proxy_pdu = (mesh_gatt_proxy_pdu_t *) segment;
+        p_proxy_pdu->pdu_type = ((mesh_gatt_proxy_pdu_t *) p_proxy_buffer->pdu)->pdu_type;
+        memcpy(p_proxy_pdu->pdu,
+               &p_proxy_buffer->p_ref[p_conn->tx.transaction.offset],
+               length - sizeof(mesh_gatt_proxy_pdu_t));
+    }
 
     p_proxy_pdu->sar_type = sar_type;
 
@@ -180,8 +203,9 @@ static void mesh_gatt_pdu_send(uint16_t conn_index)
         /* Next offset starts at the final byte of the previous packet. */
         uint8_t next_offset = p_conn->tx.transaction.offset + length - sizeof(mesh_gatt_proxy_pdu_t);
 
-        if (sar_type == PROXY_SAR_TYPE_FIRST_SEGMENT ||
-            sar_type == PROXY_SAR_TYPE_CONT_SEGMENT)
+        if (p_proxy_buffer->p_ref == NULL &&
+            (sar_type == PROXY_SAR_TYPE_FIRST_SEGMENT ||
+             sar_type == PROXY_SAR_TYPE_CONT_SEGMENT))
         {
             /* Copy the header in front of the next packet. */
             memcpy(&p_proxy_buffer->pdu[next_offset],
@@ -196,10 +220,21 @@ static void mesh_gatt_pdu_send(uint16_t conn_index)
 
 }
 
+static void packet_ref_release(uint16_t conn_index, packet_buffer_packet_t * p_packet)
+{
+    mesh_gatt_proxy_buffer_t * p_proxy_buffer = (mesh_gatt_proxy_buffer_t *) p_packet->packet;
+    if (p_proxy_buffer->p_ref != NULL)
+    {
+        p_proxy_buffer->release_cb(conn_index, p_proxy_buffer->p_ref);
+        p_proxy_buffer->p_ref = NULL;
+    }
+}
+
 static void tx_state_clear(mesh_gatt_connection_t * p_conn)
 {
     if (p_conn->tx.transaction.p_curr_packet != NULL)
     {
+        packet_ref_release((uint16_t) (p_conn - &m_gatt.connections[0]), p_conn->tx.transaction.p_curr_packet);
         packet_buffer_free(&p_conn->tx.packet_buffer, p_conn->tx.transaction.p_curr_packet);
         p_conn->tx.transaction.p_curr_packet = NULL;
         p_conn->tx.transaction.offset = 0;
@@ -232,6 +267,14 @@ static void conn_index_free(uint16_t conn_index)
     NRF_MESH_ASSERT(conn_index < MESH_GATT_CONNECTION_COUNT_MAX);
     rx_state_clear(&m_gatt.connections[conn_index]);
     tx_state_clear(&m_gatt.connections[conn_index]);
+
+    /* Queued packets may hold references to payloads owned by someone else. */
+    packet_buffer_packet_t * p_packet;
+    while (packet_buffer_pop(&m_gatt.connections[conn_index].tx.packet_buffer, &p_packet) == NRF_SUCCESS)
+    {
+        packet_ref_release(conn_index, p_packet);
+        packet_buffer_free(&m_gatt.connections[conn_index].tx.packet_buffer, p_packet);
+    }
     packet_buffer_flush(&m_gatt.connections[conn_index].tx.packet_buffer);
     m_gatt.connections[conn_index].conn_handle = BLE_CONN_HANDLE_INVALID;
 }
@@ -620,6 +663,8 @@ uint8_t * mesh_gatt_packet_alloc(uint16_t conn_index,
     {
         mesh_gatt_proxy_buffer_t * p_proxy_buffer =  (mesh_gatt_proxy_buffer_t *) p_packet->packet;
         p_proxy_buffer->token = token;
+        p_proxy_buffer->p_ref = NULL;
+        p_proxy_buffer->release_cb = NULL;
         p_proxy_buffer->length = sizeof(mesh_gatt_proxy_pdu_t) + size;
         mesh_gatt_proxy_pdu_t * p_proxy_pdu = (mesh_gatt_proxy_pdu_t *) p_proxy_buffer->pdu;
         p_proxy_pdu->pdu_type = type;
@@ -632,6 +677,38 @@ uint8_t * mesh_gatt_packet_alloc(uint16_t conn_index,
     }
 }
 
+uint8_t * mesh_gatt_packet_ref_alloc(uint16_t conn_index,
+                                     mesh_gatt_pdu_type_t type,
+                                     nrf_mesh_tx_token_t token)
+{
+    /* A zero length packet only holds the header, the payload is filled in on send. */
+    return mesh_gatt_packet_alloc(conn_index, type, 0, token);
+}
+
+uint32_t mesh_gatt_packet_ref_send(uint16_t conn_index,
+                                   const uint8_t * p_packet,
+                                   uint8_t * p_data,
+                                   uint16_t length,
+                                   mesh_gatt_packet_ref_release_cb_t release_cb)
+{
+    NRF_MESH_ASSERT(p_packet != NULL && p_data != NULL && release_cb != NULL);
+    NRF_MESH_ASSERT(length > 0 && length < MESH_GATT_PROXY_PDU_MAX_SIZE);
+    NRF_MESH_ASSERT(conn_index < MESH_GATT_CONNECTION_COUNT_MAX);
+    if (m_gatt.connections[conn_index].conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    mesh_gatt_proxy_pdu_t * p_proxy_pdu = PARENT_BY_FIELD_GET(mesh_gatt_proxy_pdu_t, pdu, p_packet);
+    mesh_gatt_proxy_buffer_t * p_proxy_buffer = PARENT_BY_FIELD_GET(mesh_gatt_proxy_buffer_t, pdu, p_proxy_pdu);
+    NRF_MESH_ASSERT(p_proxy_buffer->length == sizeof(mesh_gatt_proxy_pdu_t));
+
+    p_proxy_buffer->p_ref = p_data;
+    p_proxy_buffer->release_cb = release_cb;
+    p_proxy_buffer->length = sizeof(mesh_gatt_proxy_pdu_t) + length;
+    return mesh_gatt_packet_send(conn_index, p_packet);
+}
+
 
 uint32_t mesh_gatt_packet_send(uint16_t conn_index, const uint8_t * p_packet)
 {
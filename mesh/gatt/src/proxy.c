@@ -71,6 +71,10 @@
 
 #define ADV_NETWORK_ITERATE_INTERVAL_US     SEC_TO_US(10)
 
+/** Number of shared Core TX PDUs a single connection may hold. Network PDUs beyond this are copied,
+ * so a slow client can't starve the other connections. */
+#define SHARED_PDU_COUNT_MAX (CORE_TX_SHARED_PDU_COUNT / MESH_GATT_CONNECTION_COUNT_MAX)
+
 /** Macro for copying a packed big-endian address list into a regular uint16_t array. */
 #define ADDRS_LIST_ENDIANESS_SWAP_AND_COPY(P_ADDRS, P_ADDRS_PACKED, ADDR_COUNT) \
     do {                                                                \
@@ -97,6 +101,8 @@ typedef struct
     nrf_mesh_key_refresh_phase_t kr_phase;
     const nrf_mesh_beacon_info_t * p_pending_beacon_info;
     uint8_t * p_alloc_packet;
+    bool alloc_shared; /**< Whether @c p_alloc_packet only holds the header of a shared PDU. */
+    uint8_t shared_pdu_count; /**< Number of shared PDUs held by the connection. */
     core_tx_bearer_t bearer;
 } proxy_connection_t;
 
@@ -127,15 +133,17 @@ typedef struct __attribute((packed))
 
 static core_tx_alloc_result_t core_tx_packet_alloc_cb(core_tx_bearer_t * p_bearer, const core_tx_alloc_params_t * p_params);
 static void core_tx_packet_send_cb(core_tx_bearer_t * p_bearer, const uint8_t * p_packet, uint32_t packet_length);
+static void core_tx_packet_send_shared_cb(core_tx_bearer_t * p_bearer, core_tx_pdu_t * p_pdu);
 static void core_tx_packet_discard_cb(core_tx_bearer_t * p_bearer);
 
 static void adv_start(proxy_adv_type_t proxy_adv_type, bool interleave_networks);
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
-static const core_tx_bearer_interface_t m_interface = {core_tx_packet_alloc_cb,
-                                                       core_tx_packet_send_cb,
-                                                       core_tx_packet_discard_cb};
+static const core_tx_bearer_interface_t m_interface = {.packet_alloc       = core_tx_packet_alloc_cb,
+                                                       .packet_send        = core_tx_packet_send_cb,
+                                                       .packet_discard     = core_tx_packet_discard_cb,
+                                                       .packet_send_shared = core_tx_packet_send_shared_cb};
 static proxy_connection_t m_connections[MESH_GATT_CONNECTION_COUNT_MAX];
 static nrf_mesh_evt_handler_t m_mesh_evt_handler;
 static bool m_enabled = PROXY_ENABLED_DEFAULT;
@@ -735,9 +743,26 @@ core_tx_alloc_result_t core_tx_packet_alloc_cb(core_tx_bearer_t * p_bearer,
     NRF_MESH_ASSERT(p_bearer && p_params);
     proxy_connection_t * p_connection = PARENT_BY_FIELD_GET(proxy_connection_t, bearer, p_bearer);
 
-    if (p_connection->connected && proxy_filter_accept(&p_connection->filter, p_params->p_metadata->dst.value))
+    /* Bulk transfer PDUs are not forwarded, as proxy clients only expect standard network PDUs. */
+    if (p_connection->connected && p_params->net_packet_len <= PACKET_MESH_NET_MAX_SIZE &&
+        proxy_filter_accept(&p_connection->filter, p_params->p_metadata->dst.value))
     {
-        uint32_t status = packet_alloc(p_connection, MESH_GATT_PDU_TYPE_NETWORK_PDU, p_params->net_packet_len, p_params->token);
+        uint32_t status;
+        /* Shared network PDUs are sent by reference, so the connection buffer only holds the header. */
+        p_connection->alloc_shared = (core_tx_packet_is_shared() &&
+                                      p_connection->shared_pdu_count < SHARED_PDU_COUNT_MAX);
+        if (p_connection->alloc_shared)
+        {
+            NRF_MESH_ASSERT(p_connection->p_alloc_packet == NULL);
+            p_connection->p_alloc_packet = mesh_gatt_packet_ref_alloc(connection_index(p_connection),
+                                                                      MESH_GATT_PDU_TYPE_NETWORK_PDU,
+                                                                      p_params->token);
+            status = (p_connection->p_alloc_packet != NULL) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+        }
+        else
+        {
+            status = packet_alloc(p_connection, MESH_GATT_PDU_TYPE_NETWORK_PDU, p_params->net_packet_len, p_params->token);
+        }
 
         return ((status == NRF_SUCCESS) ? CORE_TX_ALLOC_SUCCESS : CORE_TX_ALLOC_FAIL_NO_MEM);
     }
@@ -751,12 +776,47 @@ void core_tx_packet_send_cb(core_tx_bearer_t * p_bearer, const uint8_t * p_packe
 {
     NRF_MESH_ASSERT(p_bearer && p_packet);
     proxy_connection_t * p_connection = PARENT_BY_FIELD_GET(proxy_connection_t, bearer, p_bearer);
-    NRF_MESH_ASSERT(p_connection->p_alloc_packet);
+    NRF_MESH_ASSERT(p_connection->p_alloc_packet && !p_connection->alloc_shared);
 
     memcpy(p_connection->p_alloc_packet, p_packet, packet_length);
     packet_send(p_connection);
 }
 
+static void shared_pdu_release(uint16_t conn_index, uint8_t * p_data)
+{
+    NRF_MESH_ASSERT(m_connections[conn_index].shared_pdu_count > 0);
+    m_connections[conn_index].shared_pdu_count--;
+    core_tx_pdu_release(PARENT_BY_FIELD_GET(core_tx_pdu_t, packet, p_data));
+}
+
+void core_tx_packet_send_shared_cb(core_tx_bearer_t * p_bearer, core_tx_pdu_t * p_pdu)
+{
+    NRF_MESH_ASSERT(p_bearer && p_pdu);
+    proxy_connection_t * p_connection = PARENT_BY_FIELD_GET(proxy_connection_t, bearer, p_bearer);
+    NRF_MESH_ASSERT(p_connection->p_alloc_packet);
+
+    if (!p_connection->alloc_shared)
+    {
+        /* The connection already holds its share of the pool, and reserved room for a copy. */
+        core_tx_packet_send_cb(p_bearer, p_pdu->packet.pdu, p_pdu->length);
+        core_tx_pdu_release(p_pdu);
+    }
+    else
+    {
+        p_connection->shared_pdu_count++;
+        if (mesh_gatt_packet_ref_send(connection_index(p_connection),
+                                      p_connection->p_alloc_packet,
+                                      p_pdu->packet.pdu,
+                                      p_pdu->length,
+                                      shared_pdu_release) != NRF_SUCCESS)
+        {
+            mesh_gatt_packet_discard(connection_index(p_connection), p_connection->p_alloc_packet);
+            shared_pdu_release(connection_index(p_connection), p_pdu->packet.pdu);
+        }
+        p_connection->p_alloc_packet = NULL;
+    }
+}
+
 void core_tx_packet_discard_cb(core_tx_bearer_t * p_bearer)
 {
     NRF_MESH_ASSERT(p_bearer);
@@ -773,11 +833,12 @@ void proxy_init(void)
                                .rx_char = PROXY_UUID_CHAR_RX};
     mesh_gatt_init(&uuids, gatt_evt_handler, NULL);
     m_mesh_evt_handler.evt_cb = mesh_evt_handle;
+    m_mesh_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_NET_BEACON_RECEIVED);
     nrf_mesh_evt_handler_add(&m_mesh_evt_handler);
 
     m_beacon_cache.array_len = MESH_GATT_PROXY_BEACON_CACHE_SIZE;
     m_beacon_cache.elem_array = m_beacon_cache_entries;
-    m_beacon_cache.elem_size = sizeof(sizeof(beacon_cache_entry_t));
+    m_beacon_cache.elem_size = sizeof(beacon_cache_entry_t);
     cache_init(&m_beacon_cache);
 
     m_advertising.timer.cb = adv_timer_handler;
@@ -0,0 +1,280 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NRF_MESH_PROV_SCHEDULER_H__
+#define NRF_MESH_PROV_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_prov.h"
+#include "nrf_mesh_prov_events.h"
+#include "nrf_mesh_config_prov.h"
+#include "timer.h"
+
+/**
+ * @defgroup NRF_MESH_PROV_SCHEDULER Provisioning scheduler
+ * @ingroup MESH_API_GROUP_PROV
+ * Provisions many devices over concurrent provisioning links.
+ *
+ * The provisioning scheduler keeps a queue of device UUIDs waiting to be provisioned and runs the
+ * provisioner role on several links at the same time, one @ref nrf_mesh_prov_ctx_t per link. For
+ * PB-ADV, every link is a separate @ref nrf_mesh_prov_bearer_adv_t instance, which is
+ * demultiplexed on its link ID by the bearer. As most of the provisioning time is spent waiting
+ * for round trips on the advertising bearer, running links in parallel reduces the time needed to
+ * commission a large network by roughly the number of links.
+ *
+ * All links share the same provisioner key pair, which the application generates (or loads) once
+ * before calling @ref nrf_mesh_prov_scheduler_init(). Unicast addresses are assigned consecutively
+ * from a configured range when a device reports its number of elements.
+ *
+ * The device key of a provisioned device is handed to the application in the
+ * @ref NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_PROVISIONED event as soon as the Provisioning Complete
+ * PDU is received, so the application can add it to the device state manager while the link is
+ * being closed and the next device is started on it.
+ *
+ * The time spent in each phase of the provisioning procedure is measured per device, and
+ * accumulated in @ref nrf_mesh_prov_scheduler_stats_t.
+ *
+ * @{
+ */
+
+/** Maximum number of device UUIDs waiting to be provisioned. */
+#ifndef NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE
+#define NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE (16)
+#endif
+
+/** Phases of a provisioning session, as seen by the provisioner. */
+typedef enum
+{
+    /** From sending the link open request until the link is established. */
+    NRF_MESH_PROV_SCHEDULER_PHASE_LINK,
+    /** From the link being established until the device capabilities are received. */
+    NRF_MESH_PROV_SCHEDULER_PHASE_INVITE,
+    /** Public key exchange, ECDH, authentication and provisioning data distribution. */
+    NRF_MESH_PROV_SCHEDULER_PHASE_PROVISION,
+    /** From receiving the Provisioning Complete PDU until the link is closed. */
+    NRF_MESH_PROV_SCHEDULER_PHASE_CLOSE,
+    /** Number of phases. */
+    NRF_MESH_PROV_SCHEDULER_PHASE_COUNT
+} nrf_mesh_prov_scheduler_phase_t;
+
+/** Scheduler event types. */
+typedef enum
+{
+    /** A device has been provisioned. The device key must be stored by the application. */
+    NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_PROVISIONED,
+    /** Provisioning of a device failed, and its link has been closed. */
+    NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_FAILED,
+    /** The device queue is empty and all links are idle. */
+    NRF_MESH_PROV_SCHEDULER_EVT_IDLE,
+    /** A provisioning event the scheduler does not handle itself, such as
+     * @ref NRF_MESH_PROV_EVT_ECDH_REQUEST with ECDH offloading enabled. */
+    NRF_MESH_PROV_SCHEDULER_EVT_PROV
+} nrf_mesh_prov_scheduler_evt_type_t;
+
+/** Provisioned device parameters. */
+typedef struct
+{
+    /** Device UUID. */
+    const uint8_t * p_uuid;
+    /** Device key of the device. Must be copied before the event handler returns. */
+    const uint8_t * p_devkey;
+    /** Unicast address of the primary element. */
+    uint16_t address;
+    /** Number of elements on the device. */
+    uint8_t num_elements;
+    /** Duration of every completed phase, in microseconds. */
+    const uint32_t * p_phase_durations_us;
+} nrf_mesh_prov_scheduler_evt_device_provisioned_t;
+
+/** Failed device parameters. */
+typedef struct
+{
+    /** Device UUID. */
+    const uint8_t * p_uuid;
+    /** Phase the session was in when it failed. */
+    nrf_mesh_prov_scheduler_phase_t phase;
+    /** Reason the link was closed. */
+    nrf_mesh_prov_link_close_reason_t close_reason;
+    /** Failure code reported in a Provisioning Failed PDU, or 0 if none was received. */
+    nrf_mesh_prov_failure_code_t failure_code;
+} nrf_mesh_prov_scheduler_evt_device_failed_t;
+
+/** Scheduler event. */
+typedef struct
+{
+    /** Event type. */
+    nrf_mesh_prov_scheduler_evt_type_t type;
+    /** Event parameters. */
+    union
+    {
+        /** Parameters for @ref NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_PROVISIONED. */
+        nrf_mesh_prov_scheduler_evt_device_provisioned_t device_provisioned;
+        /** Parameters for @ref NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_FAILED. */
+        nrf_mesh_prov_scheduler_evt_device_failed_t device_failed;
+        /** Parameters for @ref NRF_MESH_PROV_SCHEDULER_EVT_PROV. */
+        const nrf_mesh_prov_evt_t * p_prov_evt;
+    } params;
+} nrf_mesh_prov_scheduler_evt_t;
+
+/**
+ * Scheduler event handler.
+ *
+ * @param[in] p_evt Event.
+ */
+typedef void (*nrf_mesh_prov_scheduler_evt_cb_t)(const nrf_mesh_prov_scheduler_evt_t * p_evt);
+
+/** Provisioning link owned by the scheduler. */
+typedef struct
+{
+    /** Provisioning context of the link. Must be zero initialized before the first call to
+     * @ref nrf_mesh_prov_scheduler_init(). */
+    nrf_mesh_prov_ctx_t ctx;
+    /** Bearer to run the link on. Set by the application before initialization. */
+    prov_bearer_t * p_bearer;
+
+    /** Internal variable. */
+    uint8_t uuid[NRF_MESH_UUID_SIZE];
+    /** Internal variable. */
+    uint32_t phase_durations_us[NRF_MESH_PROV_SCHEDULER_PHASE_COUNT];
+    /** Internal variable. */
+    timestamp_t phase_start;
+    /** Internal variable. */
+    nrf_mesh_prov_scheduler_phase_t phase;
+    /** Internal variable. */
+    nrf_mesh_prov_failure_code_t failure_code;
+    /** Internal variable. */
+    uint8_t num_elements;
+    /** Internal variable. */
+    bool active;
+    /** Internal variable. */
+    bool provisioned;
+} nrf_mesh_prov_scheduler_link_t;
+
+/** Scheduler initialization parameters. */
+typedef struct
+{
+    /** Array of links to run concurrently. */
+    nrf_mesh_prov_scheduler_link_t * p_links;
+    /** Number of links in @p p_links. */
+    uint32_t link_count;
+    /** Provisioner public key shared by all links. */
+    const uint8_t * p_public_key;
+    /** Provisioner private key shared by all links. */
+    const uint8_t * p_private_key;
+    /** Static OOB authentication data used for devices supporting it, or NULL to always use
+     * no OOB authentication. Must be @ref PROV_AUTH_LEN bytes long. */
+    const uint8_t * p_static_data;
+    /** Provisioning data to give all devices. The address field is the first unicast address
+     * to assign. */
+    nrf_mesh_prov_provisioning_data_t prov_data;
+    /** Last unicast address that can be assigned. */
+    uint16_t address_last;
+    /** Event handler. */
+    nrf_mesh_prov_scheduler_evt_cb_t evt_cb;
+} nrf_mesh_prov_scheduler_init_params_t;
+
+/** Accumulated provisioning statistics. */
+typedef struct
+{
+    /** Number of devices provisioned. */
+    uint32_t devices_provisioned;
+    /** Number of devices that failed provisioning. */
+    uint32_t devices_failed;
+    /** Total time spent in each phase by provisioned devices, in microseconds. */
+    uint64_t phase_total_us[NRF_MESH_PROV_SCHEDULER_PHASE_COUNT];
+    /** Longest time spent in each phase by a provisioned device, in microseconds. */
+    uint32_t phase_max_us[NRF_MESH_PROV_SCHEDULER_PHASE_COUNT];
+} nrf_mesh_prov_scheduler_stats_t;
+
+/**
+ * Initializes the provisioning scheduler.
+ *
+ * Initializes the provisioning context of every link with the shared key pair and adds the
+ * link's bearer to it.
+ *
+ * @param[in] p_params Initialization parameters. The link array must stay valid while the
+ *                     scheduler is in use.
+ *
+ * @retval NRF_SUCCESS              The scheduler was initialized.
+ * @retval NRF_ERROR_NULL           A required parameter was NULL.
+ * @retval NRF_ERROR_INVALID_PARAM  There are no links, or the address range is empty.
+ * @retval NRF_ERROR_INVALID_STATE  One of the links is in use.
+ * @returns Other return values returned by @ref nrf_mesh_prov_init() or
+ *          @ref nrf_mesh_prov_bearer_add().
+ */
+uint32_t nrf_mesh_prov_scheduler_init(const nrf_mesh_prov_scheduler_init_params_t * p_params);
+
+/**
+ * Adds a device to the provisioning queue.
+ *
+ * The device is started right away if there is an idle link.
+ *
+ * @param[in] p_uuid Device UUID, typically taken from an unprovisioned device beacon.
+ *
+ * @retval NRF_SUCCESS              The device was queued or started.
+ * @retval NRF_ERROR_NULL           @p p_uuid was NULL.
+ * @retval NRF_ERROR_INVALID_STATE  The device is already queued or being provisioned.
+ * @retval NRF_ERROR_NO_MEM         The queue is full.
+ */
+uint32_t nrf_mesh_prov_scheduler_device_add(const uint8_t * p_uuid);
+
+/**
+ * Gets the number of links currently provisioning a device.
+ *
+ * @returns Number of active links.
+ */
+uint32_t nrf_mesh_prov_scheduler_active_link_count_get(void);
+
+/**
+ * Gets the number of devices waiting in the queue.
+ *
+ * @returns Number of queued devices.
+ */
+uint32_t nrf_mesh_prov_scheduler_queue_length_get(void);
+
+/**
+ * Gets the accumulated provisioning statistics.
+ *
+ * @returns Pointer to the statistics structure.
+ */
+const nrf_mesh_prov_scheduler_stats_t * nrf_mesh_prov_scheduler_stats_get(void);
+
+/** @} end of NRF_MESH_PROV_SCHEDULER */
+
+#endif /* NRF_MESH_PROV_SCHEDULER_H__ */
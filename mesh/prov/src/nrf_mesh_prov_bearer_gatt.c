@@ -157,6 +157,9 @@ static const char * m_state_lookup_table[] =
 };
 #endif  /* FSM_DEBUG */
 
+/* Filled in by fsm_init(), shared between all instances. */
+static uint8_t m_pb_gatt_fsm_state_index_table[VA_NARGS(STATE_LIST)];
+
 static const fsm_const_descriptor_t m_pb_gatt_fsm_descriptor =
 {
     .transition_table = m_pb_gatt_fsm_transition_table,
@@ -164,6 +167,8 @@ static const fsm_const_descriptor_t m_pb_gatt_fsm_descriptor =
     .initial_state = S_IDLE,
     .guard = pb_gatt_fsm_guard,
     .action = pb_gatt_fsm_action,
+    .state_index_table = m_pb_gatt_fsm_state_index_table,
+    .states_count = ARRAY_SIZE(m_pb_gatt_fsm_state_index_table),
 #if FSM_DEBUG
     .fsm_name = "PB-GATT bearer",
     .action_lookup = m_action_lookup_table,
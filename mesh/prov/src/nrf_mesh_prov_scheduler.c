@@ -0,0 +1,394 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "nrf_mesh_prov_scheduler.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "nrf_mesh_prov.h"
+#include "log.h"
+#include "utils.h"
+
+/** Ring buffer of device UUIDs waiting for a free link. */
+typedef struct
+{
+    uint8_t uuids[NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE][NRF_MESH_UUID_SIZE];
+    uint32_t head;
+    uint32_t count;
+} device_queue_t;
+
+static nrf_mesh_prov_scheduler_link_t * mp_links;
+static uint32_t m_link_count;
+static uint32_t m_active_link_count;
+static const uint8_t * mp_static_data;
+static nrf_mesh_prov_provisioning_data_t m_prov_data;
+static uint16_t m_address_last;
+static nrf_mesh_prov_scheduler_evt_cb_t m_evt_cb;
+static device_queue_t m_queue;
+static nrf_mesh_prov_scheduler_stats_t m_stats;
+
+static void schedule(void);
+
+static inline nrf_mesh_prov_scheduler_link_t * link_get(nrf_mesh_prov_ctx_t * p_ctx)
+{
+    return PARENT_BY_FIELD_GET(nrf_mesh_prov_scheduler_link_t, ctx, p_ctx);
+}
+
+static void phase_end(nrf_mesh_prov_scheduler_link_t * p_link, nrf_mesh_prov_scheduler_phase_t next_phase)
+{
+    timestamp_t now = timer_now();
+    p_link->phase_durations_us[p_link->phase] = TIMER_DIFF(now, p_link->phase_start);
+    p_link->phase_start = now;
+    p_link->phase = next_phase;
+}
+
+static bool uuid_is_pending(const uint8_t * p_uuid)
+{
+    for (uint32_t i = 0; i < m_link_count; ++i)
+    {
+        if (mp_links[i].active && memcmp(mp_links[i].uuid, p_uuid, NRF_MESH_UUID_SIZE) == 0)
+        {
+            return true;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_queue.count; ++i)
+    {
+        uint32_t index = (m_queue.head + i) % NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE;
+        if (memcmp(m_queue.uuids[index], p_uuid, NRF_MESH_UUID_SIZE) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void link_start(nrf_mesh_prov_scheduler_link_t * p_link)
+{
+    memcpy(p_link->uuid, m_queue.uuids[m_queue.head], NRF_MESH_UUID_SIZE);
+    m_queue.head = (m_queue.head + 1) % NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE;
+    m_queue.count--;
+
+    memset(p_link->phase_durations_us, 0, sizeof(p_link->phase_durations_us));
+    p_link->phase = NRF_MESH_PROV_SCHEDULER_PHASE_LINK;
+    p_link->phase_start = timer_now();
+    p_link->failure_code = (nrf_mesh_prov_failure_code_t) 0;
+    p_link->provisioned = false;
+
+    /* The address is assigned when the number of elements is known. */
+    uint32_t status = nrf_mesh_prov_provision(&p_link->ctx, p_link->uuid, &m_prov_data,
+                                              p_link->p_bearer->bearer_type);
+    if (status == NRF_SUCCESS)
+    {
+        p_link->active = true;
+        m_active_link_count++;
+    }
+    else
+    {
+        __LOG(LOG_SRC_PROV, LOG_LEVEL_WARN, "Scheduler: unable to open link: %u\n", status);
+        m_stats.devices_failed++;
+
+        nrf_mesh_prov_scheduler_evt_t evt;
+        evt.type = NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_FAILED;
+        evt.params.device_failed.p_uuid = p_link->uuid;
+        evt.params.device_failed.phase = NRF_MESH_PROV_SCHEDULER_PHASE_LINK;
+        evt.params.device_failed.close_reason = NRF_MESH_PROV_LINK_CLOSE_REASON_ERROR;
+        evt.params.device_failed.failure_code = (nrf_mesh_prov_failure_code_t) 0;
+        m_evt_cb(&evt);
+    }
+}
+
+static void schedule(void)
+{
+    for (uint32_t i = 0; i < m_link_count && m_queue.count > 0; ++i)
+    {
+        if (!mp_links[i].active)
+        {
+            link_start(&mp_links[i]);
+        }
+    }
+
+    if (m_queue.count == 0 && m_active_link_count == 0)
+    {
+        nrf_mesh_prov_scheduler_evt_t evt;
+        evt.type = NRF_MESH_PROV_SCHEDULER_EVT_IDLE;
+        m_evt_cb(&evt);
+    }
+}
+
+static void caps_handle(nrf_mesh_prov_scheduler_link_t * p_link, const nrf_mesh_prov_oob_caps_t * p_caps)
+{
+    phase_end(p_link, NRF_MESH_PROV_SCHEDULER_PHASE_PROVISION);
+
+    uint32_t address_end = (uint32_t) m_prov_data.address + p_caps->num_elements;
+    if (p_caps->num_elements == 0 || address_end - 1 > m_address_last)
+    {
+        __LOG(LOG_SRC_PROV, LOG_LEVEL_ERROR, "Scheduler: out of unicast addresses\n");
+        p_link->failure_code = NRF_MESH_PROV_FAILURE_CODE_OUT_OF_RESOURCES;
+        p_link->ctx.p_active_bearer->p_interface->link_close(p_link->ctx.p_active_bearer,
+                                                             NRF_MESH_PROV_LINK_CLOSE_REASON_ERROR);
+        return;
+    }
+
+    /* Addresses are handed out in the order devices report their capabilities, so that devices
+     * failing before this point do not leave holes in the address range. */
+    p_link->ctx.data.address = m_prov_data.address;
+    p_link->num_elements = p_caps->num_elements;
+    m_prov_data.address = (uint16_t) address_end;
+
+    uint32_t status;
+    if (mp_static_data != NULL && (p_caps->oob_static_types & NRF_MESH_PROV_OOB_STATIC_TYPE_SUPPORTED))
+    {
+        status = nrf_mesh_prov_oob_use(&p_link->ctx, NRF_MESH_PROV_OOB_METHOD_STATIC, 0, PROV_AUTH_LEN);
+    }
+    else
+    {
+        status = nrf_mesh_prov_oob_use(&p_link->ctx, NRF_MESH_PROV_OOB_METHOD_NONE, 0, 0);
+    }
+
+    if (status != NRF_SUCCESS)
+    {
+        p_link->ctx.p_active_bearer->p_interface->link_close(p_link->ctx.p_active_bearer,
+                                                             NRF_MESH_PROV_LINK_CLOSE_REASON_ERROR);
+    }
+}
+
+static void complete_handle(nrf_mesh_prov_scheduler_link_t * p_link, const nrf_mesh_prov_evt_complete_t * p_complete)
+{
+    phase_end(p_link, NRF_MESH_PROV_SCHEDULER_PHASE_CLOSE);
+    p_link->provisioned = true;
+
+    nrf_mesh_prov_scheduler_evt_t evt;
+    evt.type = NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_PROVISIONED;
+    evt.params.device_provisioned.p_uuid = p_link->uuid;
+    evt.params.device_provisioned.p_devkey = p_complete->p_devkey;
+    evt.params.device_provisioned.address = p_complete->p_prov_data->address;
+    evt.params.device_provisioned.num_elements = p_link->num_elements;
+    evt.params.device_provisioned.p_phase_durations_us = p_link->phase_durations_us;
+    m_evt_cb(&evt);
+}
+
+static void link_closed_handle(nrf_mesh_prov_scheduler_link_t * p_link, nrf_mesh_prov_link_close_reason_t reason)
+{
+    nrf_mesh_prov_scheduler_phase_t failed_phase = p_link->phase;
+    phase_end(p_link, p_link->phase);
+
+    p_link->active = false;
+    NRF_MESH_ASSERT(m_active_link_count > 0);
+    m_active_link_count--;
+
+    if (p_link->provisioned)
+    {
+        m_stats.devices_provisioned++;
+        for (uint32_t i = 0; i < NRF_MESH_PROV_SCHEDULER_PHASE_COUNT; ++i)
+        {
+            m_stats.phase_total_us[i] += p_link->phase_durations_us[i];
+            if (p_link->phase_durations_us[i] > m_stats.phase_max_us[i])
+            {
+                m_stats.phase_max_us[i] = p_link->phase_durations_us[i];
+            }
+        }
+    }
+    else
+    {
+        m_stats.devices_failed++;
+
+        nrf_mesh_prov_scheduler_evt_t evt;
+        evt.type = NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_FAILED;
+        evt.params.device_failed.p_uuid = p_link->uuid;
+        evt.params.device_failed.phase = failed_phase;
+        evt.params.device_failed.close_reason = reason;
+        evt.params.device_failed.failure_code = p_link->failure_code;
+        m_evt_cb(&evt);
+    }
+
+    /* The context is idle again, the link can be reused right away. */
+    schedule();
+}
+
+static void prov_evt_handler(const nrf_mesh_prov_evt_t * p_evt)
+{
+    switch (p_evt->type)
+    {
+        case NRF_MESH_PROV_EVT_LINK_ESTABLISHED:
+            phase_end(link_get(p_evt->params.link_established.p_context), NRF_MESH_PROV_SCHEDULER_PHASE_INVITE);
+            break;
+
+        case NRF_MESH_PROV_EVT_CAPS_RECEIVED:
+            caps_handle(link_get(p_evt->params.oob_caps_received.p_context),
+                        &p_evt->params.oob_caps_received.oob_caps);
+            break;
+
+        case NRF_MESH_PROV_EVT_STATIC_REQUEST:
+            NRF_MESH_ASSERT(mp_static_data != NULL);
+            NRF_MESH_ERROR_CHECK(nrf_mesh_prov_auth_data_provide(p_evt->params.static_request.p_context,
+                                                                 mp_static_data, PROV_AUTH_LEN));
+            break;
+
+        case NRF_MESH_PROV_EVT_COMPLETE:
+            complete_handle(link_get(p_evt->params.complete.p_context), &p_evt->params.complete);
+            break;
+
+        case NRF_MESH_PROV_EVT_FAILED:
+            link_get(p_evt->params.failed.p_context)->failure_code = p_evt->params.failed.failure_code;
+            break;
+
+        case NRF_MESH_PROV_EVT_LINK_CLOSED:
+            link_closed_handle(link_get(p_evt->params.link_closed.p_context),
+                               p_evt->params.link_closed.close_reason);
+            break;
+
+        default:
+        {
+            nrf_mesh_prov_scheduler_evt_t evt;
+            evt.type = NRF_MESH_PROV_SCHEDULER_EVT_PROV;
+            evt.params.p_prov_evt = p_evt;
+            m_evt_cb(&evt);
+            break;
+        }
+    }
+}
+
+/***** Interface functions *****/
+
+uint32_t nrf_mesh_prov_scheduler_init(const nrf_mesh_prov_scheduler_init_params_t * p_params)
+{
+    if (p_params == NULL || p_params->p_links == NULL || p_params->p_public_key == NULL ||
+        p_params->p_private_key == NULL || p_params->evt_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_params->link_count == 0 || p_params->prov_data.address == 0 ||
+        p_params->prov_data.address > p_params->address_last)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < p_params->link_count; ++i)
+    {
+        if (p_params->p_links[i].p_bearer == NULL)
+        {
+            return NRF_ERROR_NULL;
+        }
+        if (p_params->p_links[i].active)
+        {
+            return NRF_ERROR_INVALID_STATE;
+        }
+    }
+
+    /* The provisioner does not authenticate itself, only the public key type is used. */
+    const nrf_mesh_prov_oob_caps_t caps = NRF_MESH_PROV_OOB_CAPS_DEFAULT(1);
+
+    for (uint32_t i = 0; i < p_params->link_count; ++i)
+    {
+        nrf_mesh_prov_scheduler_link_t * p_link = &p_params->p_links[i];
+        uint32_t status = nrf_mesh_prov_init(&p_link->ctx, p_params->p_public_key,
+                                             p_params->p_private_key, &caps, prov_evt_handler);
+        if (status != NRF_SUCCESS)
+        {
+            return status;
+        }
+
+        /* The bearer is kept in the context on repeated initialization. */
+        if (p_link->ctx.p_bearers == NULL)
+        {
+            status = nrf_mesh_prov_bearer_add(&p_link->ctx, p_link->p_bearer);
+            if (status != NRF_SUCCESS)
+            {
+                return status;
+            }
+        }
+    }
+
+    mp_links = p_params->p_links;
+    m_link_count = p_params->link_count;
+    m_active_link_count = 0;
+    mp_static_data = p_params->p_static_data;
+    m_prov_data = p_params->prov_data;
+    m_address_last = p_params->address_last;
+    m_evt_cb = p_params->evt_cb;
+    memset(&m_queue, 0, sizeof(m_queue));
+    memset(&m_stats, 0, sizeof(m_stats));
+    return NRF_SUCCESS;
+}
+
+uint32_t nrf_mesh_prov_scheduler_device_add(const uint8_t * p_uuid)
+{
+    if (p_uuid == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (uuid_is_pending(p_uuid))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (m_queue.count == NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint32_t index = (m_queue.head + m_queue.count) % NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE;
+    memcpy(m_queue.uuids[index], p_uuid, NRF_MESH_UUID_SIZE);
+    m_queue.count++;
+
+    if (m_active_link_count < m_link_count)
+    {
+        schedule();
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t nrf_mesh_prov_scheduler_active_link_count_get(void)
+{
+    return m_active_link_count;
+}
+
+uint32_t nrf_mesh_prov_scheduler_queue_length_get(void)
+{
+    return m_queue.count;
+}
+
+const nrf_mesh_prov_scheduler_stats_t * nrf_mesh_prov_scheduler_stats_get(void)
+{
+    return &m_stats;
+}
@@ -45,6 +45,7 @@
 #include "enc.h"
 #include "rand.h"
 #include "uECC.h"
+#include "ecc_p256.h"
 #include "mesh_config.h"
 #include "mesh_opt_prov.h"
 
@@ -191,7 +192,9 @@ void prov_utils_authentication_values_derive(const nrf_mesh_prov_ctx_t * p_ctx,
 
 uint32_t prov_utils_keys_generate(uint8_t * p_public, uint8_t * p_private)
 {
-#if NRF_MESH_UECC_ENABLE
+#if NRF_MESH_ECC_P256_ENABLE
+    return ecc_p256_keys_generate(p_public, p_private);
+#elif NRF_MESH_UECC_ENABLE
     return uECC_make_key(p_public, p_private, uECC_secp256r1()) == 1 ? NRF_SUCCESS : NRF_ERROR_INTERNAL;
 #else
     return NRF_ERROR_NOT_SUPPORTED;
@@ -247,7 +250,14 @@ void prov_utils_derive_keys(const nrf_mesh_prov_ctx_t * p_ctx,
 
 uint32_t prov_utils_calculate_shared_secret(const nrf_mesh_prov_ctx_t * p_ctx, uint8_t * p_shared_secret)
 {
-#if NRF_MESH_UECC_ENABLE
+#if NRF_MESH_ECC_P256_ENABLE
+    if (ecc_p256_shared_secret(p_ctx->peer_public_key, p_ctx->p_private_key, p_shared_secret) != NRF_SUCCESS)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+
+    return NRF_SUCCESS;
+#elif NRF_MESH_UECC_ENABLE
     if (!uECC_valid_public_key(p_ctx->peer_public_key, uECC_secp256r1()))
     {
         return NRF_ERROR_INTERNAL;
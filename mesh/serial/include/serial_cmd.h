@@ -68,6 +68,11 @@
 #define SERIAL_OPCODE_CMD_DEVICE_BEACON_PARAMS_GET            (0x13) /**< Params: @ref serial_cmd_device_beacon_params_get_t */
 #define SERIAL_OPCODE_CMD_DEVICE_HOUSEKEEPING_DATA_GET        (0x14) /**< Params: None. */
 #define SERIAL_OPCODE_CMD_DEVICE_HOUSEKEEPING_DATA_CLEAR      (0x15) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_DEVICE_INSTR_HISTOGRAM_GET          (0x16) /**< Params: @ref serial_cmd_device_instr_histogram_get_t */
+#define SERIAL_OPCODE_CMD_DEVICE_INSTR_CLEAR                  (0x17) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_START           (0x18) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_STOP            (0x19) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_READ            (0x1A) /**< Params: None. */
 
 #define SERIAL_OPCODE_CMD_RANGE_DEVICE_END                    (0x1F) /**< DEVICE range end. */
 
@@ -152,9 +157,16 @@
 #define SERIAL_OPCODE_CMD_MESH_ADDR_VIRTUAL_COUNT_MAX_GET     (0xAA) /**< Params: None. */
 #define SERIAL_OPCODE_CMD_MESH_PACKET_SEND                    (0xAB) /**< Params: @ref serial_cmd_mesh_packet_send_t */
 #define SERIAL_OPCODE_CMD_MESH_STATE_CLEAR                    (0xAC) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_GET            (0xAD) /**< Params: @ref serial_cmd_mesh_heartbeat_table_get_t */
+#define SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_CLEAR          (0xAE) /**< Params: None. */
 
 #define SERIAL_OPCODE_CMD_RANGE_MESH_END                      (0xAF) /**< MESH range end. */
 
+#define SERIAL_OPCODE_CMD_RANGE_STATS_START                   (0xB0) /**< STATS range start. */
+#define SERIAL_OPCODE_CMD_STATS_GET                           (0xB0) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_STATS_CLEAR                         (0xB1) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_RANGE_STATS_END                     (0xBF) /**< STATS range end. */
+
 #define SERIAL_OPCODE_CMD_RANGE_DFU_START                     (0xD0) /**< DFU range start. */
 #define SERIAL_OPCODE_CMD_DFU_JUMP_TO_BOOTLOADER              (0xD0) /**< Params: None. */
 #define SERIAL_OPCODE_CMD_DFU_REQUEST                         (0xD1) /**< Params: @ref serial_cmd_dfu_request_t */
@@ -234,6 +246,12 @@ typedef struct __attribute((packed))
     uint8_t beacon_slot; /**< Slot number of the beacon to get the parameters of. */
 } serial_cmd_device_beacon_params_get_t;
 
+/** Instrumentation histogram get cmd parameters. */
+typedef struct __attribute((packed))
+{
+    uint8_t stage; /**< Stage to get the histogram of, see @ref instr_stage_t. */
+} serial_cmd_device_instr_histogram_get_t;
+
 /** Union of all device command parameters. */
 typedef union __attribute((packed))
 {
@@ -242,6 +260,7 @@ typedef union __attribute((packed))
     serial_cmd_device_beacon_stop_t beacon_stop; /**< Beacon stop parameters. */
     serial_cmd_device_beacon_params_set_t beacon_params_set; /**< Beacon params set parameters. */
     serial_cmd_device_beacon_params_get_t beacon_params_get; /**< Beacon params get parameters. */
+    serial_cmd_device_instr_histogram_get_t instr_histogram_get; /**< Instrumentation histogram get parameters. */
 } serial_cmd_device_t;
 
 /************** Config commands **************/
@@ -500,6 +519,11 @@ typedef struct __attribute((packed))
 
 NRF_MESH_STATIC_ASSERT(sizeof(serial_cmd_mesh_packet_send_t) == NRF_MESH_SERIAL_PAYLOAD_MAXLEN);
 
+/** Mesh heartbeat table get command parameters. */
+typedef struct __attribute((packed))
+{
+    uint16_t start_index; /**< Index of the first heartbeat collector entry to get. */
+} serial_cmd_mesh_heartbeat_table_get_t;
 
 /** Mesh command parameters. */
 typedef union __attribute((packed))
@@ -530,6 +554,7 @@ typedef union __attribute((packed))
     serial_cmd_mesh_addr_publication_remove_t       addr_publication_remove;       /**< Publication address remove parameters. */
 
     serial_cmd_mesh_packet_send_t                   packet_send;                   /**< Packet send parameters. */
+    serial_cmd_mesh_heartbeat_table_get_t           heartbeat_table_get;           /**< Heartbeat table get parameters. */
 } serial_cmd_mesh_t;
 
 /* **** PB-MESH Client **** */
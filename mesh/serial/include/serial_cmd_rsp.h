@@ -41,6 +41,7 @@
 #include <stdint.h>
 
 #include "nrf_mesh_defines.h"
+#include "nrf_mesh_config_core.h"
 #include "nrf_mesh_dfu_types.h"
 #include "nrf_mesh_serial.h"
 #include "nrf_mesh_prov.h"
@@ -69,6 +70,54 @@ typedef struct __attribute((packed))
     uint32_t alloc_fail_count;  /**< Number of failed serial packet allocations. */
 } serial_evt_cmd_rsp_data_housekeeping_t;
 
+/** Instrumentation histogram of a single stage. */
+typedef struct __attribute((packed))
+{
+    uint8_t stage;                                  /**< Stage of the histogram, see @ref instr_stage_t. */
+    uint32_t count;                                 /**< Number of measurements. */
+    uint32_t max;                                   /**< Longest measured duration. */
+    uint64_t total;                                 /**< Sum of all measured durations. */
+    uint32_t buckets[INSTR_HISTOGRAM_BUCKET_COUNT]; /**< Number of measurements in each logarithmic bucket. */
+} serial_evt_cmd_rsp_data_instr_histogram_t;
+
+/** Packet trace data. */
+typedef struct __attribute((packed))
+{
+    uint32_t dropped;                                                /**< Number of records dropped since the trace was started. */
+    uint8_t data[SERIAL_EVT_CMD_RSP_DATA_MAXLEN - sizeof(uint32_t)]; /**< Trace data, see @ref PACKET_TRACE. The length is given by the packet length. */
+} serial_evt_cmd_rsp_data_packet_trace_t;
+
+/** Heartbeat collector entry, see @ref heartbeat_collector_entry_t. */
+typedef struct __attribute((packed))
+{
+    uint16_t src;       /**< Source address of the heartbeats. */
+    uint16_t count;     /**< Number of heartbeats received, saturates at 0xFFFF. */
+    uint32_t age_s;     /**< Seconds since the last heartbeat was received. */
+    uint16_t features;  /**< Feature bits of the last heartbeat. */
+    uint8_t min_hops;   /**< Lowest number of hops a heartbeat has traveled. */
+    uint8_t max_hops;   /**< Highest number of hops a heartbeat has traveled. */
+    uint8_t last_hops;  /**< Number of hops the last heartbeat traveled. */
+    int8_t rssi_last;   /**< RSSI of the last heartbeat received over the air, or 0 if none. */
+    int8_t rssi_min;    /**< Lowest RSSI of the heartbeats received over the air, or 0 if none. */
+    int8_t rssi_max;    /**< Highest RSSI of the heartbeats received over the air, or 0 if none. */
+    int8_t rssi_avg;    /**< Moving average of the RSSI, or 0 if no heartbeats were received over the air. */
+} serial_evt_cmd_rsp_data_heartbeat_entry_t;
+
+/** Heartbeat table response data. */
+typedef struct __attribute((packed))
+{
+    uint16_t total_count; /**< Number of entries in the heartbeat collector table. */
+    serial_evt_cmd_rsp_data_heartbeat_entry_t entries[(SERIAL_EVT_CMD_RSP_DATA_MAXLEN - sizeof(uint16_t)) /
+                                                      sizeof(serial_evt_cmd_rsp_data_heartbeat_entry_t)]; /**< Entries from the requested start index on. The number of entries is given by the packet length. */
+} serial_evt_cmd_rsp_data_heartbeat_table_t;
+
+/** Statistics counters response data. */
+typedef struct __attribute((packed))
+{
+    uint8_t counter_count; /**< Number of counters in the response. */
+    uint32_t counters[(SERIAL_EVT_CMD_RSP_DATA_MAXLEN - sizeof(uint8_t)) / sizeof(uint32_t)]; /**< Counter values, in the order of @ref mesh_stats_counter_t. */
+} serial_evt_cmd_rsp_data_stats_t;
+
 /** Subnetwork access response data */
 typedef struct __attribute((packed))
 {
@@ -302,6 +351,10 @@ typedef struct __attribute((packed))
     union __attribute((packed))
     {
         serial_evt_cmd_rsp_data_housekeeping_t         hk_data;        /**< Housekeeping data response. */
+        serial_evt_cmd_rsp_data_instr_histogram_t      instr_histogram; /**< Instrumentation histogram response. */
+        serial_evt_cmd_rsp_data_packet_trace_t         packet_trace;   /**< Packet trace data. */
+        serial_evt_cmd_rsp_data_heartbeat_table_t      heartbeat_table; /**< Heartbeat collector table. */
+        serial_evt_cmd_rsp_data_stats_t                stats;          /**< Statistics counters. */
         serial_evt_cmd_rsp_data_subnet_t               subnet;         /**< Subnet response. */
         serial_evt_cmd_rsp_data_subnet_list_t          subnet_list;    /**< List of all subnet key indexes. */
         serial_evt_cmd_rsp_data_appkey_t               appkey;         /**< Appkey response. */
@@ -67,6 +67,7 @@
 #include "serial_handler_access.h"
 #include "serial_handler_models.h"
 #include "serial_handler_openmesh.h"
+#include "serial_handler_stats.h"
 
 
 /* The serial_device_operating_mode_t must fit inside a single byte, to make sure it can go into the packet. */
@@ -96,6 +97,7 @@ static const serial_cmd_handler_entry_t m_cmd_handlers[] =
     {SERIAL_OPCODE_CMD_RANGE_CONFIG_START,           SERIAL_OPCODE_CMD_RANGE_CONFIG_END,           serial_handler_config_rx},
     {SERIAL_OPCODE_CMD_RANGE_OPENMESH_START,         SERIAL_OPCODE_CMD_RANGE_OPENMESH_END,         serial_handler_openmesh_rx},
     {SERIAL_OPCODE_CMD_RANGE_MESH_START,             SERIAL_OPCODE_CMD_RANGE_MESH_END,             serial_handler_mesh_rx},
+    {SERIAL_OPCODE_CMD_RANGE_STATS_START,            SERIAL_OPCODE_CMD_RANGE_STATS_END,            serial_handler_stats_rx},
     {SERIAL_OPCODE_CMD_RANGE_PROV_START,             SERIAL_OPCODE_CMD_RANGE_PROV_END,             serial_handler_prov_pkt_in},
     {SERIAL_OPCODE_CMD_RANGE_DFU_START,              SERIAL_OPCODE_CMD_RANGE_DFU_END,              serial_handler_dfu_rx},
     {SERIAL_OPCODE_CMD_RANGE_ACCESS_START,           SERIAL_OPCODE_CMD_RANGE_ACCESS_END,           serial_handler_access_rx},
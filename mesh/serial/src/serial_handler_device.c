@@ -49,6 +49,9 @@
 #include "nrf_mesh_dfu.h"
 #include "hal.h"
 #include "advertiser.h"
+#include "instr.h"
+#include "packet_trace.h"
+#include "toolchain.h"
 
 #define BEACON_START_CMD_DATA_OVERHEAD  (sizeof(serial_cmd_device_beacon_start_t) - BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH)
 #define BEACON_INTERVAL_RANDOMIZE_INTERVAL_MS   (10)
@@ -85,6 +88,7 @@ static struct
 } m_hk_data;
 
 NRF_MESH_STATIC_ASSERT(sizeof(m_hk_data) == sizeof(serial_evt_cmd_rsp_data_housekeeping_t));
+NRF_MESH_STATIC_ASSERT(sizeof(serial_evt_cmd_rsp_data_instr_histogram_t) <= SERIAL_EVT_CMD_RSP_DATA_MAXLEN);
 /*****************************************************************************
 * Static functions
 *****************************************************************************/
@@ -282,6 +286,82 @@ static void handle_cmd_hk_data_clear(const serial_packet_t * p_cmd)
     serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
 }
 
+static void handle_cmd_instr_histogram_get(const serial_packet_t * p_cmd)
+{
+#if INSTR_ENABLE
+    const instr_histogram_t * p_histogram =
+        instr_histogram_get((instr_stage_t) p_cmd->payload.cmd.device.instr_histogram_get.stage);
+    if (p_histogram == NULL)
+    {
+        serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_INVALID_PARAMETER, NULL, 0);
+    }
+    else
+    {
+        /* The stages record from interrupt context, take a consistent snapshot. */
+        instr_histogram_t histogram;
+        uint32_t was_masked;
+        _DISABLE_IRQS(was_masked);
+        histogram = *p_histogram;
+        _ENABLE_IRQS(was_masked);
+
+        serial_evt_cmd_rsp_data_instr_histogram_t rsp;
+        rsp.stage = p_cmd->payload.cmd.device.instr_histogram_get.stage;
+        rsp.count = histogram.count;
+        rsp.max = histogram.max;
+        rsp.total = histogram.total;
+        memcpy(rsp.buckets, histogram.buckets, sizeof(rsp.buckets));
+        serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, (const uint8_t *) &rsp, sizeof(rsp));
+    }
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
+static void handle_cmd_instr_clear(const serial_packet_t * p_cmd)
+{
+#if INSTR_ENABLE
+    instr_clear();
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
+static void handle_cmd_packet_trace_start(const serial_packet_t * p_cmd)
+{
+#if PACKET_TRACE_ENABLE
+    packet_trace_start();
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
+static void handle_cmd_packet_trace_stop(const serial_packet_t * p_cmd)
+{
+#if PACKET_TRACE_ENABLE
+    packet_trace_stop();
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
+static void handle_cmd_packet_trace_read(const serial_packet_t * p_cmd)
+{
+#if PACKET_TRACE_ENABLE
+    serial_evt_cmd_rsp_data_packet_trace_t rsp;
+    rsp.dropped = packet_trace_stats_get()->dropped;
+    uint32_t length = packet_trace_read(rsp.data, sizeof(rsp.data));
+    serial_cmd_rsp_send(p_cmd->opcode,
+                        SERIAL_STATUS_SUCCESS,
+                        (const uint8_t *) &rsp,
+                        sizeof(rsp) - sizeof(rsp.data) + length);
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
 
 /* Serial command handler lookup table. */
 static const serial_handler_common_opcode_to_fp_map_t m_cmd_handlers[] =
@@ -297,6 +377,11 @@ static const serial_handler_common_opcode_to_fp_map_t m_cmd_handlers[] =
     {SERIAL_OPCODE_CMD_DEVICE_BEACON_PARAMS_GET,       sizeof(serial_cmd_device_beacon_params_get_t),                  0, handle_cmd_device_beacon_params_get},
     {SERIAL_OPCODE_CMD_DEVICE_HOUSEKEEPING_DATA_GET,   0,                                                              0, handle_cmd_hk_data_get},
     {SERIAL_OPCODE_CMD_DEVICE_HOUSEKEEPING_DATA_CLEAR, 0,                                                              0, handle_cmd_hk_data_clear},
+    {SERIAL_OPCODE_CMD_DEVICE_INSTR_HISTOGRAM_GET,     sizeof(serial_cmd_device_instr_histogram_get_t),                0, handle_cmd_instr_histogram_get},
+    {SERIAL_OPCODE_CMD_DEVICE_INSTR_CLEAR,             0,                                                              0, handle_cmd_instr_clear},
+    {SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_START,      0,                                                              0, handle_cmd_packet_trace_start},
+    {SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_STOP,       0,                                                              0, handle_cmd_packet_trace_stop},
+    {SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_READ,       0,                                                              0, handle_cmd_packet_trace_read},
 };
 
 /*****************************************************************************
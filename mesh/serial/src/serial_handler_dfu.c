@@ -144,6 +144,13 @@ static void serial_handler_mesh_evt_handle(const nrf_mesh_evt_t* p_evt)
 void serial_handler_dfu_init(void)
 {
     m_evt_handler.evt_cb = serial_handler_mesh_evt_handle;
+    m_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_FIRMWARE_OUTDATED) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_FIRMWARE_OUTDATED_NO_AUTH) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_REQ_RELAY) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_REQ_SOURCE) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_START) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_END) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_DFU_BANK_AVAILABLE);
     nrf_mesh_evt_handler_add(&m_evt_handler);
 }
 
@@ -47,6 +47,7 @@
 #include "nrf_mesh_events.h"
 #include "nrf_mesh_utils.h"
 #include "nrf_mesh_assert.h"
+#include "heartbeat_collector.h"
 #include "hal.h"
 
 /* Ensure that we're mapping the size of the serial parameter to the
@@ -407,6 +408,54 @@ static void handle_cmd_clear(const serial_packet_t * p_cmd)
     serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
 }
 
+static void handle_cmd_heartbeat_table_get(const serial_packet_t * p_cmd)
+{
+#if HEARTBEAT_COLLECTOR_ENABLE
+    serial_evt_cmd_rsp_data_heartbeat_table_t rsp;
+    uint16_t total_count = heartbeat_collector_count_get();
+    uint16_t index = p_cmd->payload.cmd.mesh.heartbeat_table_get.start_index;
+    uint32_t entry_count = 0;
+    heartbeat_collector_entry_t entry;
+
+    rsp.total_count = total_count;
+    while (entry_count < sizeof(rsp.entries) / sizeof(rsp.entries[0]) &&
+           heartbeat_collector_entry_get(index, &entry) == NRF_SUCCESS)
+    {
+        serial_evt_cmd_rsp_data_heartbeat_entry_t * p_rsp_entry = &rsp.entries[entry_count];
+        p_rsp_entry->src = entry.src;
+        p_rsp_entry->count = entry.count;
+        p_rsp_entry->age_s = entry.age_s;
+        p_rsp_entry->features = entry.features;
+        p_rsp_entry->min_hops = entry.min_hops;
+        p_rsp_entry->max_hops = entry.max_hops;
+        p_rsp_entry->last_hops = entry.last_hops;
+        p_rsp_entry->rssi_last = entry.rssi_last;
+        p_rsp_entry->rssi_min = entry.rssi_min;
+        p_rsp_entry->rssi_max = entry.rssi_max;
+        p_rsp_entry->rssi_avg = entry.rssi_avg;
+        entry_count++;
+        index++;
+    }
+
+    serial_cmd_rsp_send(p_cmd->opcode,
+                        SERIAL_STATUS_SUCCESS,
+                        (const uint8_t *) &rsp,
+                        sizeof(rsp.total_count) + entry_count * sizeof(rsp.entries[0]));
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
+static void handle_cmd_heartbeat_table_clear(const serial_packet_t * p_cmd)
+{
+#if HEARTBEAT_COLLECTOR_ENABLE
+    heartbeat_collector_clear();
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
+
 /*****************************************************************************
 * Static functions
 *****************************************************************************/
@@ -443,7 +492,9 @@ static const mesh_serial_cmd_handler_t m_handlers[] =
     {SERIAL_OPCODE_CMD_MESH_ADDR_NONVIRTUAL_COUNT_MAX_GET,  0,                                                       0,  handle_cmd_addr_nonvirtual_count_max_get},
     {SERIAL_OPCODE_CMD_MESH_ADDR_VIRTUAL_COUNT_MAX_GET,     0,                                                       0,  handle_cmd_addr_virtual_count_max_get},
     {SERIAL_OPCODE_CMD_MESH_PACKET_SEND, SERIAL_CMD_MESH_PACKET_SEND_OVERHEAD, sizeof(serial_cmd_mesh_packet_send_t) - SERIAL_CMD_MESH_PACKET_SEND_OVERHEAD,  handle_cmd_packet_send},
-    {SERIAL_OPCODE_CMD_MESH_STATE_CLEAR,                    0,                                                       0,  handle_cmd_clear}
+    {SERIAL_OPCODE_CMD_MESH_STATE_CLEAR,                    0,                                                       0,  handle_cmd_clear},
+    {SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_GET,            sizeof(serial_cmd_mesh_heartbeat_table_get_t),           0,  handle_cmd_heartbeat_table_get},
+    {SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_CLEAR,          0,                                                       0,  handle_cmd_heartbeat_table_clear}
 };
 
 static void serial_handler_mesh_evt_handle(const nrf_mesh_evt_t* p_evt)
@@ -528,6 +579,9 @@ static void serial_handler_mesh_evt_handle(const nrf_mesh_evt_t* p_evt)
 void serial_handler_mesh_init(void)
 {
     m_evt_handler.evt_cb = serial_handler_mesh_evt_handle;
+    m_evt_handler.evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_IV_UPDATE_NOTIFICATION) |
+                             NRF_MESH_EVT_MASK(NRF_MESH_EVT_KEY_REFRESH_NOTIFICATION);
     nrf_mesh_evt_handler_add(&m_evt_handler);
 }
 
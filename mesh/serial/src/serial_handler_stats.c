@@ -0,0 +1,92 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "serial_handler_stats.h"
+
+#include "serial_handler_common.h"
+#include "serial.h"
+#include "serial_status.h"
+#include "serial_cmd_rsp.h"
+#include "nrf_mesh_assert.h"
+#include "mesh_stats.h"
+
+#if MESH_STATS_ENABLE
+
+NRF_MESH_STATIC_ASSERT(MESH_STATS_COUNT <= sizeof(((serial_evt_cmd_rsp_data_stats_t *) 0)->counters) / sizeof(uint32_t));
+
+static void handle_cmd_stats_get(const serial_packet_t * p_cmd)
+{
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+
+    serial_evt_cmd_rsp_data_stats_t rsp;
+    rsp.counter_count = MESH_STATS_COUNT;
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        rsp.counters[i] = stats.counters[i];
+    }
+    serial_cmd_rsp_send(p_cmd->opcode,
+                        SERIAL_STATUS_SUCCESS,
+                        (const uint8_t *) &rsp,
+                        sizeof(rsp.counter_count) + MESH_STATS_COUNT * sizeof(rsp.counters[0]));
+}
+
+static void handle_cmd_stats_clear(const serial_packet_t * p_cmd)
+{
+    mesh_stats_clear();
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
+}
+
+/* Serial command handler lookup table. */
+static const serial_handler_common_opcode_to_fp_map_t m_cmd_handlers[] =
+{
+    {SERIAL_OPCODE_CMD_STATS_GET,   0, 0, handle_cmd_stats_get},
+    {SERIAL_OPCODE_CMD_STATS_CLEAR, 0, 0, handle_cmd_stats_clear}
+};
+
+#endif /* MESH_STATS_ENABLE */
+
+void serial_handler_stats_rx(const serial_packet_t * p_cmd)
+{
+    NRF_MESH_ASSERT(p_cmd->opcode >= SERIAL_OPCODE_CMD_RANGE_STATS_START &&
+                    p_cmd->opcode <= SERIAL_OPCODE_CMD_RANGE_STATS_END);
+#if MESH_STATS_ENABLE
+    serial_handler_common_rx(p_cmd, m_cmd_handlers, sizeof(m_cmd_handlers) / sizeof(m_cmd_handlers[0]));
+#else
+    serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+#endif
+}
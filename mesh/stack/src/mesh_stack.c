@@ -216,7 +216,8 @@ void mesh_stack_device_reset(void)
     else
     {
         static nrf_mesh_evt_handler_t s_evt_handler = {
-            .evt_cb = mesh_evt_handler
+            .evt_cb = mesh_evt_handler,
+            .evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_FLASH_STABLE)
         };
 
         nrf_mesh_evt_handler_add(&s_evt_handler);
@@ -0,0 +1,91 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "benchmark.h"
+
+#define LCG_MULTIPLIER 1103515245
+#define LCG_INCREMENT  12345
+
+static uint32_t m_rand_state = 1;
+
+uint64_t benchmark_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000ull) + (uint64_t) now.tv_nsec;
+}
+
+uint64_t benchmark_run(const char * p_name, uint32_t iterations, benchmark_func_t func, void * p_context)
+{
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        func(i, p_context);
+    }
+    uint64_t elapsed = benchmark_time_ns() - start;
+
+    benchmark_report(p_name, iterations, elapsed);
+    return elapsed;
+}
+
+void benchmark_report(const char * p_name, uint64_t operations, uint64_t elapsed_ns)
+{
+    double seconds = (double) elapsed_ns / 1e9;
+    double ops_per_second = (seconds > 0.0) ? ((double) operations / seconds) : 0.0;
+    double ns_per_op = (operations > 0) ? ((double) elapsed_ns / (double) operations) : 0.0;
+
+    printf("%-48s %12llu ops %12.3f ms %14.1f ops/s %10.1f ns/op\n",
+           p_name,
+           (unsigned long long) operations,
+           (double) elapsed_ns / 1e6,
+           ops_per_second,
+           ns_per_op);
+}
+
+uint32_t benchmark_random(void)
+{
+    m_rand_state = m_rand_state * LCG_MULTIPLIER + LCG_INCREMENT;
+    return m_rand_state;
+}
+
+void benchmark_random_seed(uint32_t seed)
+{
+    m_rand_state = seed;
+}
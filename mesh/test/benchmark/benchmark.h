@@ -0,0 +1,104 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCHMARK_H__
+#define BENCHMARK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Number of times to run each benchmark function by default. Can be overridden in the benchmark's
+ * compile options.
+ */
+#ifndef BENCHMARK_ITERATIONS_DEFAULT
+#define BENCHMARK_ITERATIONS_DEFAULT (1000000)
+#endif
+
+/**
+ * Function run for each iteration of a benchmark.
+ *
+ * @param[in]     iteration Iteration number, starting at 0.
+ * @param[in,out] p_context Context pointer passed to @ref benchmark_run().
+ */
+typedef void (*benchmark_func_t)(uint32_t iteration, void * p_context);
+
+/**
+ * Gets a monotonic timestamp.
+ *
+ * @returns The current time in nanoseconds.
+ */
+uint64_t benchmark_time_ns(void);
+
+/**
+ * Runs a benchmark function a given number of times and prints the result.
+ *
+ * @param[in]     p_name     Name of the benchmark, printed with the result.
+ * @param[in]     iterations Number of times to call the benchmark function.
+ * @param[in]     func       Function to benchmark.
+ * @param[in,out] p_context  Context pointer to pass to the benchmark function.
+ *
+ * @returns The total run time of the benchmark in nanoseconds.
+ */
+uint64_t benchmark_run(const char * p_name, uint32_t iterations, benchmark_func_t func, void * p_context);
+
+/**
+ * Prints the result of a benchmark that has been timed by the caller.
+ *
+ * @param[in] p_name     Name of the benchmark.
+ * @param[in] operations Number of operations performed.
+ * @param[in] elapsed_ns Time spent on the operations in nanoseconds.
+ */
+void benchmark_report(const char * p_name, uint64_t operations, uint64_t elapsed_ns);
+
+/**
+ * Gets a pseudo-random number for use in benchmarks.
+ *
+ * The sequence is deterministic, to make benchmark runs comparable.
+ *
+ * @returns A pseudo-random number between 0 and 2^32 - 1.
+ */
+uint32_t benchmark_random(void);
+
+/**
+ * Reseeds the pseudo-random number generator.
+ *
+ * @param[in] seed New seed.
+ */
+void benchmark_random_seed(uint32_t seed);
+
+#endif
@@ -0,0 +1,626 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "host_stack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+#include "nrf_mesh_events.h"
+#include "network.h"
+#include "transport.h"
+#include "net_state.h"
+#include "msg_cache.h"
+#include "heartbeat.h"
+#include "timer_scheduler.h"
+#include "bearer_event.h"
+#include "event.h"
+#include "instr.h"
+#include "mesh_stats.h"
+#include "packet_trace.h"
+#include "ad_listener.h"
+#include "ad_type_filter.h"
+#include "advertiser.h"
+#include "beacon.h"
+#include "core_tx_adv.h"
+#include "mesh_opt_core.h"
+#include "mesh_config_entry.h"
+#include "device_state_manager.h"
+#include "access_config.h"
+#include "rand.h"
+#include "log.h"
+#include "utils.h"
+
+/** Number of hardware timers emulated by the virtual clock. */
+#define TIMER_COUNT               (TIMER_INDEX_TIMESTAMP + 1)
+/** Maximum number of bearer event flags. */
+#define FLAG_COUNT                (32)
+/** Maximum number of packets sent, but not reported as TX complete yet. */
+#define TX_COMPLETE_QUEUE_SIZE    (32)
+/** Seed of the C library random number generator used by the stack on host. */
+#define RANDOM_SEED               (0x5eed)
+
+typedef struct
+{
+    bool active;
+    timestamp_t time;
+    timer_callback_t callback;
+} host_timer_t;
+
+typedef struct
+{
+    core_tx_role_t role;
+    nrf_mesh_tx_token_t token;
+} tx_complete_t;
+
+static host_stack_init_params_t m_params;
+static timestamp_t m_time;
+static host_timer_t m_timers[TIMER_COUNT];
+
+static bearer_event_flag_callback_t m_flag_callbacks[FLAG_COUNT];
+static uint32_t m_flag_count;
+static uint32_t m_flags_pending;
+
+static core_tx_bearer_t m_bearer;
+static core_tx_alloc_params_t m_alloc_params;
+static tx_complete_t m_tx_completes[TX_COMPLETE_QUEUE_SIZE];
+static uint32_t m_tx_complete_head;
+static uint32_t m_tx_complete_tail;
+
+static mesh_opt_core_adv_t m_adv_options[CORE_TX_ROLE_COUNT];
+static radio_tx_power_t m_tx_power[CORE_TX_ROLE_COUNT];
+
+static scanner_stats_t m_scanner_stats;
+
+static access_model_handle_t m_model_handle;
+static nrf_mesh_tx_token_t m_tx_token;
+
+/*****************************************************************************
+* Virtual clock
+*****************************************************************************/
+static host_timer_t * timer_next_get(void)
+{
+    host_timer_t * p_next = NULL;
+    for (uint32_t i = 0; i < TIMER_COUNT; ++i)
+    {
+        if (m_timers[i].active &&
+            (p_next == NULL || TIMER_OLDER_THAN(m_timers[i].time, p_next->time)))
+        {
+            p_next = &m_timers[i];
+        }
+    }
+    return p_next;
+}
+
+/*****************************************************************************
+* Core TX bearer
+*****************************************************************************/
+static core_tx_alloc_result_t bearer_packet_alloc(core_tx_bearer_t * p_bearer,
+                                                  const core_tx_alloc_params_t * p_params)
+{
+    /* Legacy advertising packets can't carry bulk transfer PDUs. */
+    if (!m_params.adv_ext && p_params->net_packet_len > PACKET_MESH_NET_MAX_SIZE)
+    {
+        return CORE_TX_ALLOC_FAIL_REJECTED;
+    }
+    if (m_tx_complete_head - m_tx_complete_tail == TX_COMPLETE_QUEUE_SIZE)
+    {
+        return CORE_TX_ALLOC_FAIL_NO_MEM;
+    }
+    m_alloc_params = *p_params;
+    return CORE_TX_ALLOC_SUCCESS;
+}
+
+static void bearer_packet_send(core_tx_bearer_t * p_bearer, const uint8_t * p_packet, uint32_t packet_length)
+{
+    if (m_params.tx_cb != NULL)
+    {
+        m_params.tx_cb(m_alloc_params.role, p_packet, packet_length);
+    }
+
+    /* The TX complete is deferred to the next processing round, like on target, where it comes
+     * from the advertiser once the packet has been sent. */
+    tx_complete_t * p_complete = &m_tx_completes[m_tx_complete_head++ % TX_COMPLETE_QUEUE_SIZE];
+    p_complete->role = m_alloc_params.role;
+    p_complete->token = m_alloc_params.token;
+}
+
+static void bearer_packet_discard(core_tx_bearer_t * p_bearer)
+{
+}
+
+static const core_tx_bearer_interface_t m_bearer_interface =
+{
+    .packet_alloc = bearer_packet_alloc,
+    .packet_send = bearer_packet_send,
+    .packet_discard = bearer_packet_discard,
+};
+
+/*****************************************************************************
+* Model and AD listener
+*****************************************************************************/
+static void model_message_handle(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    if (m_params.rx_cb != NULL)
+    {
+        m_params.rx_cb(p_message);
+    }
+}
+
+static const access_opcode_handler_t m_opcode_handlers[] =
+{
+    {HOST_STACK_OPCODE, model_message_handle},
+};
+
+/* Routes the AD types the way the AD listener of the core does on target. */
+static void ad_packet_handle(const uint8_t * p_packet,
+                             uint32_t ad_packet_length,
+                             const nrf_mesh_rx_metadata_t * p_metadata)
+{
+    const ble_ad_data_t * p_ad_data = PARENT_BY_FIELD_GET(ble_ad_data_t, data, p_packet);
+    if (p_metadata->source == NRF_MESH_RX_SOURCE_SCANNER &&
+        p_metadata->params.scanner.adv_type != BLE_PACKET_TYPE_ADV_NONCONN_IND)
+    {
+        return;
+    }
+
+    switch (p_ad_data->type)
+    {
+        case AD_TYPE_MESH:
+            (void) network_packet_in(p_ad_data->data, p_ad_data->length - BLE_AD_DATA_OVERHEAD, p_metadata);
+            break;
+        case AD_TYPE_BEACON:
+            beacon_packet_in(p_ad_data->data, p_ad_data->length - BLE_AD_DATA_OVERHEAD, p_metadata);
+            break;
+        default:
+            break;
+    }
+}
+
+static ad_listener_t m_ad_listener =
+{
+    .ad_type = ADL_WILDCARD_AD_TYPE,
+    .adv_packet_type = ADL_WILDCARD_ADV_TYPE,
+    .handler = ad_packet_handle
+};
+
+static void dsm_setup(void)
+{
+    dsm_local_unicast_address_t local_address = {m_params.unicast_address, ACCESS_ELEMENT_COUNT};
+    NRF_MESH_ERROR_CHECK(dsm_local_unicast_addresses_set(&local_address));
+
+    dsm_handle_t subnet_handle;
+    dsm_handle_t appkey_handle;
+    dsm_handle_t publish_handle;
+    NRF_MESH_ERROR_CHECK(dsm_subnet_add(0, m_params.p_netkey, &subnet_handle));
+    NRF_MESH_ERROR_CHECK(dsm_appkey_add(0, subnet_handle, m_params.p_appkey, &appkey_handle));
+    NRF_MESH_ERROR_CHECK(dsm_address_publish_add(m_params.publish_address, &publish_handle));
+
+    access_model_add_params_t model_params =
+    {
+        .model_id = {.company_id = HOST_STACK_COMPANY_ID, .model_id = HOST_STACK_MODEL_ID},
+        .element_index = 0,
+        .p_opcode_handlers = m_opcode_handlers,
+        .opcode_count = ARRAY_SIZE(m_opcode_handlers),
+    };
+    NRF_MESH_ERROR_CHECK(access_model_add(&model_params, &m_model_handle));
+    NRF_MESH_ERROR_CHECK(access_model_application_bind(m_model_handle, appkey_handle));
+    NRF_MESH_ERROR_CHECK(access_model_publish_application_set(m_model_handle, appkey_handle));
+    NRF_MESH_ERROR_CHECK(access_model_publish_address_set(m_model_handle, publish_handle));
+    NRF_MESH_ERROR_CHECK(access_model_publish_ttl_set(m_model_handle, m_params.ttl));
+
+    if (m_params.subscription_address != NRF_MESH_ADDR_UNASSIGNED)
+    {
+        dsm_handle_t subscription_handle;
+        NRF_MESH_ERROR_CHECK(dsm_address_subscription_add(m_params.subscription_address, &subscription_handle));
+        NRF_MESH_ERROR_CHECK(access_model_subscription_list_alloc(m_model_handle));
+        NRF_MESH_ERROR_CHECK(access_model_subscription_add(m_model_handle, subscription_handle));
+    }
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void host_stack_init(const host_stack_init_params_t * p_params)
+{
+    NRF_MESH_ASSERT(p_params != NULL && p_params->p_netkey != NULL && p_params->p_appkey != NULL);
+    m_params = *p_params;
+
+    /* The stack seeds the C library random number generator from the wall clock on the first use on
+     * host. Reseed it with a fixed value, to make runs repeatable. */
+    uint8_t dummy;
+    rand_hw_rng_get(&dummy, sizeof(dummy));
+    srand(RANDOM_SEED);
+
+    m_time = 0;
+    memset(m_timers, 0, sizeof(m_timers));
+    m_flag_count = 0;
+    m_flags_pending = 0;
+    m_tx_complete_head = 0;
+    m_tx_complete_tail = 0;
+    memset(m_adv_options, 0, sizeof(m_adv_options));
+    memset(&m_scanner_stats, 0, sizeof(m_scanner_stats));
+    m_adv_options[CORE_TX_ROLE_ORIGINATOR].enabled = true;
+    m_adv_options[CORE_TX_ROLE_RELAY].enabled = p_params->relay;
+
+    instr_init();
+    mesh_stats_init();
+    msg_cache_init();
+    timer_sch_init();
+    core_tx_bearer_add(&m_bearer, &m_bearer_interface, CORE_TX_BEARER_TYPE_ADV);
+    network_init(NULL);
+    transport_init(NULL);
+    heartbeat_init();
+    NRF_MESH_ERROR_CHECK(ad_listener_subscribe(&m_ad_listener));
+
+    dsm_init();
+    access_init();
+    dsm_setup();
+
+    NRF_MESH_ERROR_CHECK(net_state_iv_index_set(p_params->iv_index, false));
+    network_enable();
+    host_stack_process();
+}
+
+void host_stack_process(void)
+{
+    bool pending;
+    do
+    {
+        pending = false;
+        for (uint32_t i = 0; i < m_flag_count; ++i)
+        {
+            if (m_flags_pending & (1u << i))
+            {
+                m_flags_pending &= ~(1u << i);
+                if (!m_flag_callbacks[i]())
+                {
+                    m_flags_pending |= (1u << i);
+                }
+            }
+        }
+
+        while (m_tx_complete_tail != m_tx_complete_head)
+        {
+            tx_complete_t complete = m_tx_completes[m_tx_complete_tail++ % TX_COMPLETE_QUEUE_SIZE];
+            core_tx_complete(&m_bearer, complete.role, m_time, complete.token);
+        }
+
+        pending = (m_flags_pending != 0 || m_tx_complete_tail != m_tx_complete_head);
+    } while (pending);
+}
+
+timestamp_t host_stack_time_get(void)
+{
+    return m_time;
+}
+
+void host_stack_time_advance(timestamp_t time)
+{
+    for (;;)
+    {
+        /* Fire the earliest timer that expires before the target time, if any. */
+        host_timer_t * p_next = timer_next_get();
+        if (p_next == NULL || TIMER_OLDER_THAN(time, p_next->time))
+        {
+            break;
+        }
+
+        p_next->active = false;
+        if (TIMER_OLDER_THAN(m_time, p_next->time))
+        {
+            m_time = p_next->time;
+        }
+        p_next->callback(m_time);
+        host_stack_process();
+    }
+
+    if (TIMER_OLDER_THAN(m_time, time))
+    {
+        m_time = time;
+    }
+}
+
+bool host_stack_timeout_next_get(timestamp_t * p_time)
+{
+    const host_timer_t * p_next = timer_next_get();
+    if (p_next == NULL)
+    {
+        return false;
+    }
+    *p_time = p_next->time;
+    return true;
+}
+
+void host_stack_scanner_rx(const scanner_packet_t * p_packet)
+{
+    INSTR_STAGE_BEGIN(instr_start);
+    packet_trace_scanner_rx(p_packet);
+    m_scanner_stats.successful_receives++;
+
+    nrf_mesh_rx_metadata_t metadata;
+    metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
+    metadata.params.scanner = p_packet->metadata;
+
+    if (p_packet->packet.header.length >= BLE_ADV_PACKET_OVERHEAD &&
+        p_packet->packet.header.type != BLE_PACKET_TYPE_ADV_EXT)
+    {
+        ad_listener_process((ble_packet_type_t) p_packet->packet.header.type,
+                            p_packet->packet.payload,
+                            p_packet->packet.header.length - BLE_ADV_PACKET_OVERHEAD,
+                            &metadata);
+    }
+    INSTR_STAGE_END(INSTR_STAGE_SCANNER_RX, instr_start);
+
+    host_stack_process();
+}
+
+void host_stack_scanner_packet_build(scanner_packet_t * p_packet,
+                                     const uint8_t * p_net_packet,
+                                     uint32_t length,
+                                     timestamp_t timestamp,
+                                     int8_t rssi)
+{
+    NRF_MESH_ASSERT(length + BLE_AD_DATA_OVERHEAD + 1 <= BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+    memset(p_packet, 0, sizeof(scanner_packet_t));
+
+    p_packet->metadata.timestamp = timestamp;
+    p_packet->metadata.access_addr = BEARER_ACCESS_ADDR_DEFAULT;
+    p_packet->metadata.channel = 37;
+    p_packet->metadata.rssi = rssi;
+    p_packet->metadata.adv_type = BLE_PACKET_TYPE_ADV_NONCONN_IND;
+    p_packet->metadata.adv_addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+
+    p_packet->packet.header.type = BLE_PACKET_TYPE_ADV_NONCONN_IND;
+    p_packet->packet.header.addr_type = 1;
+    p_packet->packet.header.length = BLE_ADV_PACKET_OVERHEAD + BLE_AD_DATA_OVERHEAD + 1 + length;
+
+    ble_ad_data_t * p_ad_data = (ble_ad_data_t *) p_packet->packet.payload;
+    p_ad_data->length = BLE_AD_DATA_OVERHEAD + length;
+    p_ad_data->type = AD_TYPE_MESH;
+    memcpy(p_ad_data->data, p_net_packet, length);
+}
+
+void host_stack_adv_ext_rx(const uint8_t * p_net_packet, uint32_t length, timestamp_t timestamp, int8_t rssi)
+{
+    NRF_MESH_ASSERT(length <= sizeof(packet_mesh_net_packet_t));
+
+    nrf_mesh_rx_metadata_t metadata;
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.source = NRF_MESH_RX_SOURCE_INSTABURST;
+    metadata.params.instaburst.timestamp = timestamp;
+    metadata.params.instaburst.rssi = rssi;
+    metadata.params.instaburst.event.is_last_in_chain = true;
+
+    uint8_t payload[BLE_AD_DATA_OVERHEAD + 1 + sizeof(packet_mesh_net_packet_t)];
+    ble_ad_data_t * p_ad_data = (ble_ad_data_t *) payload;
+    p_ad_data->length = BLE_AD_DATA_OVERHEAD + length;
+    p_ad_data->type = AD_TYPE_MESH;
+    memcpy(p_ad_data->data, p_net_packet, length);
+
+    ad_listener_process(BLE_PACKET_TYPE_ADV_EXT, payload, BLE_AD_DATA_OVERHEAD + 1 + length, &metadata);
+    host_stack_process();
+}
+
+uint32_t host_stack_publish(const uint8_t * p_data, uint16_t length, bool force_segmented)
+{
+    access_message_tx_t message =
+    {
+        .opcode = HOST_STACK_OPCODE,
+        .p_buffer = p_data,
+        .length = length,
+        .force_segmented = force_segmented,
+        .transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT,
+        .access_token = ++m_tx_token,
+    };
+    uint32_t status = access_model_publish(m_model_handle, &message);
+    host_stack_process();
+    return status;
+}
+
+/*****************************************************************************
+* Replacements for the hardware dependent and unused parts of the stack
+*****************************************************************************/
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+timestamp_t timer_now(void)
+{
+    return m_time;
+}
+
+uint32_t timer_order_cb(uint8_t timer, timestamp_t time, timer_callback_t callback, timer_attr_t attributes)
+{
+    NRF_MESH_ASSERT(timer < TIMER_COUNT);
+    m_timers[timer].active = true;
+    m_timers[timer].time = time;
+    m_timers[timer].callback = callback;
+    return NRF_SUCCESS;
+}
+
+uint32_t timer_abort(uint8_t timer)
+{
+    NRF_MESH_ASSERT(timer < TIMER_COUNT);
+    m_timers[timer].active = false;
+    return NRF_SUCCESS;
+}
+
+bearer_event_flag_t bearer_event_flag_add(bearer_event_flag_callback_t callback)
+{
+    NRF_MESH_ASSERT(m_flag_count < FLAG_COUNT);
+    m_flag_callbacks[m_flag_count] = callback;
+    return m_flag_count++;
+}
+
+void bearer_event_flag_set(bearer_event_flag_t flag)
+{
+    NRF_MESH_ASSERT(flag < m_flag_count);
+    m_flags_pending |= (1u << flag);
+}
+
+void bearer_event_critical_section_begin(void)
+{
+}
+
+void bearer_event_critical_section_end(void)
+{
+}
+
+bool bearer_event_in_correct_irq_priority(void)
+{
+    return true;
+}
+
+const scanner_stats_t * scanner_stats_get(void)
+{
+    return &m_scanner_stats;
+}
+
+void bearer_adtype_add(uint8_t type)
+{
+}
+
+void bearer_adtype_remove(uint8_t type)
+{
+}
+
+void bearer_adtype_clear(void)
+{
+}
+
+void bearer_adtype_mode_set(ad_type_mode_t mode)
+{
+}
+
+void bearer_adtype_filtering_set(bool onoff)
+{
+}
+
+/* The secure network beacons are not sent on host. */
+void advertiser_instance_init(advertiser_t * p_adv,
+                              advertiser_tx_complete_cb_t tx_complete_cb,
+                              uint8_t * p_buffer,
+                              uint32_t buffer_size)
+{
+}
+
+void advertiser_enable(advertiser_t * p_adv)
+{
+}
+
+void advertiser_interval_set(advertiser_t * p_adv, uint32_t interval_ms)
+{
+}
+
+adv_packet_t * advertiser_packet_alloc(advertiser_t * p_adv, uint32_t adv_payload_size)
+{
+    return NULL;
+}
+
+void advertiser_packet_send(advertiser_t * p_adv, adv_packet_t * p_packet)
+{
+}
+
+bool core_tx_adv_is_enabled(core_tx_role_t role)
+{
+    return m_adv_options[role].enabled;
+}
+
+uint32_t mesh_opt_core_adv_set(core_tx_role_t role, const mesh_opt_core_adv_t * p_entry)
+{
+    m_adv_options[role] = *p_entry;
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_opt_core_adv_get(core_tx_role_t role, mesh_opt_core_adv_t * p_entry)
+{
+    *p_entry = m_adv_options[role];
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_opt_core_tx_power_set(core_tx_role_t role, radio_tx_power_t tx_power)
+{
+    m_tx_power[role] = tx_power;
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_opt_core_tx_power_get(core_tx_role_t role, radio_tx_power_t * p_tx_power)
+{
+    *p_tx_power = m_tx_power[role];
+    return NRF_SUCCESS;
+}
+
+/* There is no persistent storage on host: writes are accepted and dropped. */
+uint32_t mesh_config_entry_set(mesh_config_entry_id_t id, const void * p_entry)
+{
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_config_entry_get(mesh_config_entry_id_t id, void * p_entry)
+{
+    return NRF_ERROR_NOT_FOUND;
+}
+
+void nrf_mesh_evt_handler_add(nrf_mesh_evt_handler_t * p_handler_params)
+{
+    event_handler_add(p_handler_params);
+}
+
+void nrf_mesh_evt_handler_remove(nrf_mesh_evt_handler_t * p_handler_params)
+{
+    event_handler_remove(p_handler_params);
+}
+
+uint32_t nrf_mesh_packet_send(const nrf_mesh_tx_params_t * p_params, uint32_t * const p_packet_reference)
+{
+    return transport_tx(p_params, p_packet_reference);
+}
+
+void nrf_mesh_subnet_added(uint16_t net_key_index, const uint8_t * p_network_id)
+{
+}
+
+void prov_beacon_unprov_packet_in(const uint8_t * p_data, uint8_t length, const nrf_mesh_rx_metadata_t * p_meta)
+{
+}
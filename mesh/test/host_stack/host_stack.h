@@ -0,0 +1,177 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HOST_STACK_H__
+#define HOST_STACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "access.h"
+#include "core_tx.h"
+#include "scanner.h"
+#include "timer.h"
+
+/**
+ * Host stack, running the network, transport and access layers of the mesh stack on the host.
+ *
+ * The radio, the timers and the bearer event IRQ are replaced by a virtual clock, a TX callback and
+ * synchronous event processing, so that a stream of received packets can be fed through the stack
+ * deterministically. The node has a single element with a single vendor model, which publishes and
+ * receives @ref HOST_STACK_OPCODE messages.
+ */
+
+/** Company ID of the host stack model. */
+#define HOST_STACK_COMPANY_ID (0x0059)
+/** Model ID of the host stack model. */
+#define HOST_STACK_MODEL_ID   (0x0001)
+/** Opcode of the messages sent and received by the host stack model. */
+#define HOST_STACK_OPCODE     ACCESS_OPCODE_VENDOR(0xC1, HOST_STACK_COMPANY_ID)
+
+/**
+ * Network PDU transmitted callback.
+ *
+ * @param[in] role          Role the packet was sent in.
+ * @param[in] p_net_packet  Encrypted network PDU.
+ * @param[in] length        Length of the network PDU.
+ */
+typedef void (*host_stack_tx_cb_t)(core_tx_role_t role, const uint8_t * p_net_packet, uint32_t length);
+
+/**
+ * Access message received callback.
+ *
+ * @param[in] p_message Received message.
+ */
+typedef void (*host_stack_rx_cb_t)(const access_message_rx_t * p_message);
+
+/** Host stack initialization parameters. */
+typedef struct
+{
+    uint16_t unicast_address;       /**< Unicast address of the node's only element. */
+    const uint8_t * p_netkey;       /**< Network key of the node's only subnetwork. */
+    const uint8_t * p_appkey;       /**< Application key bound to the model. */
+    uint32_t iv_index;              /**< IV index of the network. */
+    uint16_t publish_address;       /**< Address the model publishes to. */
+    uint16_t subscription_address;  /**< Group address the model subscribes to, or 0 for none. */
+    uint8_t ttl;                    /**< TTL of the published messages. */
+    bool relay;                     /**< Whether the node relays packets. */
+    bool adv_ext;                   /**< Whether the bearer sends extended advertising packets, which can carry bulk transfer PDUs. */
+    host_stack_tx_cb_t tx_cb;       /**< Called for every network PDU sent, may be NULL. */
+    host_stack_rx_cb_t rx_cb;       /**< Called for every message received by the model, may be NULL. */
+} host_stack_init_params_t;
+
+/**
+ * Initializes and enables the host stack.
+ *
+ * @param[in] p_params Initialization parameters.
+ */
+void host_stack_init(const host_stack_init_params_t * p_params);
+
+/**
+ * Processes all pending bearer events and TX complete events.
+ */
+void host_stack_process(void);
+
+/**
+ * Gets the current time of the virtual clock.
+ *
+ * @returns The current time in microseconds.
+ */
+timestamp_t host_stack_time_get(void);
+
+/**
+ * Advances the virtual clock, firing all timers that expire on the way in order.
+ *
+ * @param[in] time Time to advance to. Times in the past are ignored.
+ */
+void host_stack_time_advance(timestamp_t time);
+
+/**
+ * Gets the time of the next timer expiry.
+ *
+ * @param[out] p_time Time of the next timer expiry.
+ *
+ * @returns Whether any timer is running.
+ */
+bool host_stack_timeout_next_get(timestamp_t * p_time);
+
+/**
+ * Feeds a packet received by the scanner through the stack, like the scanner packet processing in
+ * the core does on target.
+ *
+ * @param[in] p_packet Received packet.
+ */
+void host_stack_scanner_rx(const scanner_packet_t * p_packet);
+
+/**
+ * Builds a scanner packet carrying a network PDU.
+ *
+ * @param[out] p_packet     Scanner packet to build.
+ * @param[in]  p_net_packet Network PDU to put in the packet.
+ * @param[in]  length       Length of the network PDU.
+ * @param[in]  timestamp    RX timestamp of the packet.
+ * @param[in]  rssi         RSSI of the packet.
+ */
+void host_stack_scanner_packet_build(scanner_packet_t * p_packet,
+                                     const uint8_t * p_net_packet,
+                                     uint32_t length,
+                                     timestamp_t timestamp,
+                                     int8_t rssi);
+
+/**
+ * Feeds a network PDU received in an extended advertising packet through the stack, like the
+ * Instaburst packet processing in the core does on target.
+ *
+ * @param[in] p_net_packet Received network PDU.
+ * @param[in] length       Length of the network PDU.
+ * @param[in] timestamp    RX timestamp of the packet.
+ * @param[in] rssi         RSSI of the packet.
+ */
+void host_stack_adv_ext_rx(const uint8_t * p_net_packet, uint32_t length, timestamp_t timestamp, int8_t rssi);
+
+/**
+ * Publishes a message from the host stack model.
+ *
+ * @param[in] p_data          Message payload.
+ * @param[in] length          Length of the payload.
+ * @param[in] force_segmented Whether to send the message segmented, even if it is short.
+ *
+ * @returns The result of @ref access_model_publish().
+ */
+uint32_t host_stack_publish(const uint8_t * p_data, uint16_t length, bool force_segmented);
+
+#endif /* HOST_STACK_H__ */
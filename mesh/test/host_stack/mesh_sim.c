@@ -0,0 +1,675 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mesh_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "packet_mesh.h"
+#include "utils.h"
+
+/** Time on air of a single byte at 1 Mbps, in microseconds. */
+#define BYTE_TIME_US          (8)
+/** Bytes sent on air in addition to the network PDU: preamble, access address, header, advertiser
+ * address, AD length and type and CRC. */
+#define AIR_OVERHEAD_BYTES    (1 + 4 + 2 + 6 + BLE_AD_DATA_OVERHEAD + 1 + 3)
+/** Bytes sent on air in the ADV_EXT_IND packet on the primary channel: preamble, access address,
+ * header, extended header with ADI and AuxPtr, and CRC. */
+#define ADV_EXT_PRIMARY_BYTES (1 + 4 + 2 + 2 + 2 + 3 + 3)
+/** Bytes sent on air in the AUX_ADV_IND packet in addition to the network PDU: preamble, access
+ * address, header, extended header with advertiser address and ADI, AD length and type and CRC. */
+#define ADV_EXT_AUX_OVERHEAD_BYTES (1 + 4 + 2 + 2 + 6 + 2 + BLE_AD_DATA_OVERHEAD + 1 + 3)
+/** Time from the end of the primary channel packet until the auxiliary packet starts. */
+#define ADV_EXT_AUX_OFFSET_US (300)
+/** RSSI at one meter from the sender. */
+#define RSSI_AT_ONE_METER     (-40.0f)
+/** Path loss exponent of the log-distance path loss model. */
+#define PATH_LOSS_EXPONENT    (2.0f)
+/** Length of the part of the published messages the simulator uses. */
+#define MESSAGE_HEADER_LENGTH (8)
+/** Marks a node without any running timers. */
+#define WAKE_TIME_NONE        (UINT64_MAX)
+
+/* Every node keeps its own copy of all static data of the host stack, which the linker script of
+ * the simulator puts in a single section. */
+extern uint8_t __start_mesh_sim_node_state[];
+extern uint8_t __stop_mesh_sim_node_state[];
+
+typedef enum
+{
+    EVENT_WAKE,
+    EVENT_RX_START,
+    EVENT_RX_END,
+    EVENT_FUNC,
+} event_type_t;
+
+/** A network PDU on air, shared by all its receptions. */
+typedef struct
+{
+    uint32_t ref_count;
+    uint32_t sender;
+    uint8_t length;
+    uint8_t data[PACKET_MESH_NET_BUFFER_SIZE];
+} transmission_t;
+
+typedef struct
+{
+    transmission_t * p_transmission;
+    uint64_t end_time;
+    int8_t rssi;
+    bool corrupted;
+} reception_t;
+
+typedef struct
+{
+    uint64_t time;
+    uint64_t seq;
+    event_type_t type;
+    uint32_t node;
+    union
+    {
+        reception_t * p_reception;
+        struct
+        {
+            mesh_sim_node_func_t func;
+            void * p_context;
+        } func;
+    } params;
+} event_t;
+
+typedef struct
+{
+    uint32_t node;
+    int8_t rssi;
+} link_t;
+
+typedef struct
+{
+    uint8_t * p_state;
+    float x;
+    float y;
+    bool relay;
+    link_t * p_links;
+    uint32_t link_count;
+    uint64_t wake_time;
+    uint64_t tx_busy_until;
+    uint64_t rx_busy_until;
+    reception_t * p_rx_last;
+} node_t;
+
+static mesh_sim_radio_t m_radio;
+static mesh_sim_stats_t m_stats;
+static node_t * mp_nodes;
+static uint32_t m_node_count;
+/** Node whose state is in the state section, or @p m_node_count for none. */
+static uint32_t m_active_node;
+static uint8_t * mp_pristine_state;
+static uint64_t m_time;
+static uint32_t m_rand_state;
+
+static event_t * mp_events;
+static uint32_t m_event_count;
+static uint32_t m_event_capacity;
+static uint64_t m_event_seq;
+
+static const uint8_t m_netkey[NRF_MESH_KEY_SIZE] = {0x7d, 0xd7, 0x36, 0x4c, 0xd8, 0x42, 0xad, 0x18,
+                                                    0xc1, 0x7c, 0x2b, 0x82, 0x0c, 0x84, 0xc3, 0xd6};
+static const uint8_t m_appkey[NRF_MESH_KEY_SIZE] = {0x63, 0x96, 0x47, 0x71, 0x73, 0x4f, 0xbd, 0x76,
+                                                    0xe3, 0xb4, 0x05, 0x19, 0xd1, 0xd9, 0x4a, 0x48};
+
+/*****************************************************************************
+* Random numbers
+*****************************************************************************/
+/* Xorshift generator, to keep the radio independent of the random numbers drawn by the stack. */
+static uint32_t rand_next(void)
+{
+    m_rand_state ^= m_rand_state << 13;
+    m_rand_state ^= m_rand_state >> 17;
+    m_rand_state ^= m_rand_state << 5;
+    return m_rand_state;
+}
+
+static uint32_t rand_below(uint32_t limit)
+{
+    return (limit == 0) ? 0 : (rand_next() % limit);
+}
+
+/*****************************************************************************
+* Event queue
+*****************************************************************************/
+static bool event_before(const event_t * p_a, const event_t * p_b)
+{
+    return (p_a->time < p_b->time || (p_a->time == p_b->time && p_a->seq < p_b->seq));
+}
+
+static event_t * event_push(uint64_t time, event_type_t type, uint32_t node)
+{
+    if (m_event_count == m_event_capacity)
+    {
+        m_event_capacity = (m_event_capacity == 0) ? 1024 : (m_event_capacity * 2);
+        mp_events = realloc(mp_events, m_event_capacity * sizeof(event_t));
+        NRF_MESH_ASSERT(mp_events != NULL);
+    }
+
+    event_t event = {.time = time, .seq = m_event_seq++, .type = type, .node = node};
+    uint32_t i = m_event_count++;
+    while (i > 0 && event_before(&event, &mp_events[(i - 1) / 2]))
+    {
+        mp_events[i] = mp_events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    mp_events[i] = event;
+    return &mp_events[i];
+}
+
+static event_t event_pop(void)
+{
+    NRF_MESH_ASSERT(m_event_count > 0);
+    event_t top = mp_events[0];
+    event_t last = mp_events[--m_event_count];
+
+    uint32_t i = 0;
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= m_event_count)
+        {
+            break;
+        }
+        if (child + 1 < m_event_count && event_before(&mp_events[child + 1], &mp_events[child]))
+        {
+            child++;
+        }
+        if (!event_before(&mp_events[child], &last))
+        {
+            break;
+        }
+        mp_events[i] = mp_events[child];
+        i = child;
+    }
+    mp_events[i] = last;
+    return top;
+}
+
+/*****************************************************************************
+* Node context
+*****************************************************************************/
+static void node_activate(uint32_t node)
+{
+    if (node == m_active_node)
+    {
+        return;
+    }
+
+    const uint32_t size = mesh_sim_node_state_size_get();
+    if (m_active_node < m_node_count)
+    {
+        memcpy(mp_nodes[m_active_node].p_state, __start_mesh_sim_node_state, size);
+    }
+    memcpy(__start_mesh_sim_node_state, mp_nodes[node].p_state, size);
+    m_active_node = node;
+    m_stats.node_switches++;
+}
+
+/* Brings the active node up to the current time, running its expired timers. */
+static void node_time_sync(void)
+{
+    host_stack_time_advance((timestamp_t) m_time);
+}
+
+/* Schedules a wake up of the active node for its next timer expiry. Wake ups that are no longer
+ * needed are left in the queue, and ignored when they expire. */
+static void node_wake_schedule(void)
+{
+    node_t * p_node = &mp_nodes[m_active_node];
+    uint64_t wake_time = WAKE_TIME_NONE;
+    timestamp_t timeout;
+    if (host_stack_timeout_next_get(&timeout))
+    {
+        int32_t delta = (int32_t) (timeout - (timestamp_t) m_time);
+        wake_time = m_time + (uint64_t) MAX(delta, 0);
+    }
+
+    if (wake_time != p_node->wake_time)
+    {
+        p_node->wake_time = wake_time;
+        if (wake_time != WAKE_TIME_NONE)
+        {
+            (void) event_push(wake_time, EVENT_WAKE, m_active_node);
+        }
+    }
+}
+
+/*****************************************************************************
+* Radio
+*****************************************************************************/
+static void transmission_release(transmission_t * p_transmission)
+{
+    if (--p_transmission->ref_count == 0)
+    {
+        free(p_transmission);
+    }
+}
+
+/* Called by the host stack of the active node for every network PDU it sends. */
+static void node_tx_cb(core_tx_role_t role, const uint8_t * p_net_packet, uint32_t length)
+{
+    NRF_MESH_ASSERT(length <= (m_radio.adv_ext ? PACKET_MESH_NET_BUFFER_SIZE : PACKET_MESH_NET_MAX_SIZE));
+    node_t * p_node = &mp_nodes[m_active_node];
+    m_stats.tx_count++;
+
+    /* The packets of a node are sent one by one, like the advertiser sends them in separate
+     * advertising events. Extended advertising packets occupy the receivers from the start of the
+     * primary channel packet until the end of the auxiliary packet. */
+    uint64_t start = MAX(m_time, p_node->tx_busy_until) + m_radio.latency_us + rand_below(m_radio.jitter_us);
+    uint64_t end;
+    if (m_radio.adv_ext)
+    {
+        uint32_t airtime = (ADV_EXT_PRIMARY_BYTES + ADV_EXT_AUX_OVERHEAD_BYTES + length) * BYTE_TIME_US;
+        end = start + airtime + ADV_EXT_AUX_OFFSET_US;
+        m_stats.airtime_us += airtime;
+    }
+    else
+    {
+        end = start + (length + AIR_OVERHEAD_BYTES) * BYTE_TIME_US;
+        m_stats.airtime_us += end - start;
+    }
+    p_node->tx_busy_until = end;
+
+    transmission_t * p_transmission = malloc(sizeof(transmission_t));
+    NRF_MESH_ASSERT(p_transmission != NULL);
+    p_transmission->ref_count = 1;
+    p_transmission->sender = m_active_node;
+    p_transmission->length = length;
+    memcpy(p_transmission->data, p_net_packet, length);
+
+    for (uint32_t i = 0; i < p_node->link_count; ++i)
+    {
+        if (rand_below(100) < m_radio.loss_percent)
+        {
+            m_stats.lost_count++;
+            continue;
+        }
+
+        reception_t * p_reception = malloc(sizeof(reception_t));
+        NRF_MESH_ASSERT(p_reception != NULL);
+        p_reception->p_transmission = p_transmission;
+        p_reception->end_time = end;
+        p_reception->rssi = p_node->p_links[i].rssi;
+        p_reception->corrupted = false;
+        p_transmission->ref_count++;
+
+        event_push(start, EVENT_RX_START, p_node->p_links[i].node)->params.p_reception = p_reception;
+    }
+    transmission_release(p_transmission);
+}
+
+static void node_rx_start(uint32_t node, reception_t * p_reception)
+{
+    node_t * p_node = &mp_nodes[node];
+    if (m_radio.collisions)
+    {
+        /* The radio can't receive while it's sending, and overlapping packets destroy each other. */
+        if (m_time < p_node->tx_busy_until)
+        {
+            p_reception->corrupted = true;
+        }
+        if (m_time < p_node->rx_busy_until)
+        {
+            p_reception->corrupted = true;
+            if (p_node->p_rx_last != NULL)
+            {
+                p_node->p_rx_last->corrupted = true;
+            }
+        }
+    }
+
+    if (p_reception->end_time >= p_node->rx_busy_until)
+    {
+        p_node->rx_busy_until = p_reception->end_time;
+        p_node->p_rx_last = p_reception;
+    }
+    event_push(p_reception->end_time, EVENT_RX_END, node)->params.p_reception = p_reception;
+}
+
+static void node_rx_end(uint32_t node, reception_t * p_reception)
+{
+    node_t * p_node = &mp_nodes[node];
+    if (p_node->p_rx_last == p_reception)
+    {
+        p_node->p_rx_last = NULL;
+    }
+
+    if (p_reception->corrupted)
+    {
+        m_stats.collision_count++;
+    }
+    else if (m_radio.adv_ext)
+    {
+        m_stats.rx_count++;
+        node_activate(node);
+        node_time_sync();
+        host_stack_adv_ext_rx(p_reception->p_transmission->data,
+                              p_reception->p_transmission->length,
+                              (timestamp_t) m_time,
+                              p_reception->rssi);
+        node_wake_schedule();
+    }
+    else
+    {
+        m_stats.rx_count++;
+        scanner_packet_t packet;
+        host_stack_scanner_packet_build(&packet,
+                                        p_reception->p_transmission->data,
+                                        p_reception->p_transmission->length,
+                                        (timestamp_t) m_time,
+                                        p_reception->rssi);
+        /* Give every node its own static random address, so that they can tell their neighbours
+         * apart. */
+        uint32_t sender = p_reception->p_transmission->sender;
+        memcpy(packet.metadata.adv_addr.addr, &sender, sizeof(sender));
+        packet.metadata.adv_addr.addr[BLE_GAP_ADDR_LEN - 1] |= 0xC0;
+        memcpy(packet.packet.addr, packet.metadata.adv_addr.addr, BLE_GAP_ADDR_LEN);
+        node_activate(node);
+        node_time_sync();
+        host_stack_scanner_rx(&packet);
+        node_wake_schedule();
+    }
+
+    transmission_release(p_reception->p_transmission);
+    free(p_reception);
+}
+
+/* Called by the host stack of the active node for every message it receives. */
+static void node_rx_cb(const access_message_rx_t * p_message)
+{
+    /* Messages looped back to the publisher don't count as delivered. */
+    if (p_message->length < MESSAGE_HEADER_LENGTH || p_message->meta_data.src.value == m_active_node + 1)
+    {
+        return;
+    }
+
+    uint64_t sent;
+    memcpy(&sent, p_message->p_data, sizeof(sent));
+    uint32_t latency = (uint32_t) (m_time - sent);
+    m_stats.delivered++;
+    m_stats.latency_total_us += latency;
+    m_stats.latency_max_us = MAX(m_stats.latency_max_us, latency);
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void mesh_sim_init(uint32_t node_count, const mesh_sim_radio_t * p_radio)
+{
+    NRF_MESH_ASSERT(node_count > 0 && node_count <= MESH_SIM_NODE_COUNT_MAX && p_radio != NULL);
+    const uint32_t size = mesh_sim_node_state_size_get();
+
+    if (mp_pristine_state == NULL)
+    {
+        /* The first call happens before any node has run, when the state section holds the
+         * initial values of all static data. */
+        mp_pristine_state = malloc(size);
+        NRF_MESH_ASSERT(mp_pristine_state != NULL);
+        memcpy(mp_pristine_state, __start_mesh_sim_node_state, size);
+    }
+
+    while (m_event_count > 0)
+    {
+        event_t event = event_pop();
+        if (event.type == EVENT_RX_START || event.type == EVENT_RX_END)
+        {
+            transmission_release(event.params.p_reception->p_transmission);
+            free(event.params.p_reception);
+        }
+    }
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        free(mp_nodes[i].p_state);
+        free(mp_nodes[i].p_links);
+    }
+    free(mp_nodes);
+
+    mp_nodes = calloc(node_count, sizeof(node_t));
+    NRF_MESH_ASSERT(mp_nodes != NULL);
+    for (uint32_t i = 0; i < node_count; ++i)
+    {
+        mp_nodes[i].p_state = malloc(size);
+        NRF_MESH_ASSERT(mp_nodes[i].p_state != NULL);
+        memcpy(mp_nodes[i].p_state, mp_pristine_state, size);
+        mp_nodes[i].relay = true;
+        mp_nodes[i].wake_time = WAKE_TIME_NONE;
+    }
+
+    memcpy(__start_mesh_sim_node_state, mp_pristine_state, size);
+    m_node_count = node_count;
+    m_active_node = node_count;
+    m_radio = *p_radio;
+    m_rand_state = (p_radio->seed == 0) ? 1 : p_radio->seed;
+    m_time = 0;
+    m_event_seq = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void mesh_sim_node_position_set(uint32_t node, float x, float y)
+{
+    NRF_MESH_ASSERT(node < m_node_count);
+    mp_nodes[node].x = x;
+    mp_nodes[node].y = y;
+}
+
+void mesh_sim_node_relay_set(uint32_t node, bool relay)
+{
+    NRF_MESH_ASSERT(node < m_node_count);
+    mp_nodes[node].relay = relay;
+}
+
+void mesh_sim_topology_grid(uint32_t columns, float spacing)
+{
+    NRF_MESH_ASSERT(columns > 0);
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        mesh_sim_node_position_set(i, (i % columns) * spacing, (i / columns) * spacing);
+    }
+}
+
+void mesh_sim_topology_random(float side)
+{
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        mesh_sim_node_position_set(i,
+                                   side * rand_below(0x10000) / 0x10000,
+                                   side * rand_below(0x10000) / 0x10000);
+    }
+}
+
+void mesh_sim_start(float range)
+{
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        node_t * p_node = &mp_nodes[i];
+        p_node->p_links = NULL;
+        p_node->link_count = 0;
+        uint32_t capacity = 0;
+        for (uint32_t j = 0; j < m_node_count; ++j)
+        {
+            float distance = hypotf(p_node->x - mp_nodes[j].x, p_node->y - mp_nodes[j].y);
+            if (j == i || distance > range)
+            {
+                continue;
+            }
+
+            float rssi = RSSI_AT_ONE_METER - 10.0f * PATH_LOSS_EXPONENT * log10f(MAX(distance, 1.0f));
+            if (rssi < m_radio.rssi_min)
+            {
+                continue;
+            }
+
+            if (p_node->link_count == capacity)
+            {
+                capacity = (capacity == 0) ? 8 : (capacity * 2);
+                p_node->p_links = realloc(p_node->p_links, capacity * sizeof(link_t));
+                NRF_MESH_ASSERT(p_node->p_links != NULL);
+            }
+            p_node->p_links[p_node->link_count].node = j;
+            p_node->p_links[p_node->link_count].rssi = (int8_t) rssi;
+            p_node->link_count++;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        host_stack_init_params_t params =
+        {
+            .unicast_address = i + 1,
+            .p_netkey = m_netkey,
+            .p_appkey = m_appkey,
+            .iv_index = 0,
+            .publish_address = MESH_SIM_GROUP_ADDRESS,
+            .subscription_address = MESH_SIM_GROUP_ADDRESS,
+            .ttl = NRF_MESH_TTL_MAX,
+            .relay = mp_nodes[i].relay,
+            .adv_ext = m_radio.adv_ext,
+            .tx_cb = node_tx_cb,
+            .rx_cb = node_rx_cb,
+        };
+        node_activate(i);
+        host_stack_init(&params);
+        node_time_sync();
+        node_wake_schedule();
+    }
+
+    /* Every node seeds the C library random number generator with the same value on init. Reseed
+     * it, to let the seed of the simulation decide the random numbers drawn by the stack. */
+    srand(m_rand_state);
+}
+
+void mesh_sim_node_run(uint32_t node, mesh_sim_node_func_t func, void * p_context)
+{
+    NRF_MESH_ASSERT(node < m_node_count && func != NULL);
+    node_activate(node);
+    node_time_sync();
+    func(node, p_context);
+    host_stack_process();
+    node_wake_schedule();
+}
+
+void mesh_sim_schedule(uint64_t time_us, uint32_t node, mesh_sim_node_func_t func, void * p_context)
+{
+    NRF_MESH_ASSERT(node < m_node_count && func != NULL && time_us >= m_time);
+    event_t * p_event = event_push(time_us, EVENT_FUNC, node);
+    p_event->params.func.func = func;
+    p_event->params.func.p_context = p_context;
+}
+
+uint32_t mesh_sim_publish(uint32_t node, uint16_t length, bool force_segmented)
+{
+    NRF_MESH_ASSERT(node < m_node_count && length >= MESSAGE_HEADER_LENGTH &&
+                    length <= ACCESS_MESSAGE_LENGTH_MAX);
+    uint8_t data[ACCESS_MESSAGE_LENGTH_MAX];
+    memset(data, 0, length);
+    memcpy(data, &m_time, sizeof(m_time));
+
+    node_activate(node);
+    node_time_sync();
+    uint32_t status = host_stack_publish(data, length, force_segmented);
+    node_wake_schedule();
+    if (status == NRF_SUCCESS)
+    {
+        m_stats.published++;
+    }
+    return status;
+}
+
+void mesh_sim_run(uint64_t time_us)
+{
+    while (m_event_count > 0 && mp_events[0].time <= time_us)
+    {
+        event_t event = event_pop();
+        m_time = event.time;
+        m_stats.events++;
+
+        switch (event.type)
+        {
+            case EVENT_WAKE:
+                if (mp_nodes[event.node].wake_time == event.time)
+                {
+                    mp_nodes[event.node].wake_time = WAKE_TIME_NONE;
+                    node_activate(event.node);
+                    node_time_sync();
+                    node_wake_schedule();
+                }
+                break;
+            case EVENT_RX_START:
+                node_rx_start(event.node, event.params.p_reception);
+                break;
+            case EVENT_RX_END:
+                node_rx_end(event.node, event.params.p_reception);
+                break;
+            case EVENT_FUNC:
+                mesh_sim_node_run(event.node, event.params.func.func, event.params.func.p_context);
+                break;
+        }
+    }
+
+    m_time = MAX(m_time, time_us);
+}
+
+uint64_t mesh_sim_time_get(void)
+{
+    return m_time;
+}
+
+uint32_t mesh_sim_neighbour_count_get(uint32_t node)
+{
+    NRF_MESH_ASSERT(node < m_node_count);
+    return mp_nodes[node].link_count;
+}
+
+const mesh_sim_stats_t * mesh_sim_stats_get(void)
+{
+    return &m_stats;
+}
+
+uint32_t mesh_sim_node_state_size_get(void)
+{
+    return (uint32_t) (__stop_mesh_sim_node_state - __start_mesh_sim_node_state);
+}
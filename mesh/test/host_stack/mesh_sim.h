@@ -0,0 +1,233 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MESH_SIM_H__
+#define MESH_SIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_stack.h"
+
+/**
+ * Whole network simulator, running a complete host stack instance for every node of a mesh network
+ * in a single process.
+ *
+ * The state of the host stack (all its static data) is kept in a single linker section, and the
+ * simulator keeps a copy of the section for every node, swapping it in before running a node. All
+ * nodes share a virtual clock, driven by a discrete event queue, and a simulated advertising channel
+ * with configurable latency, loss and collisions. The nodes are placed on a plane, and can hear each
+ * other when they are within the radio range, with an RSSI that drops with the distance.
+ *
+ * All nodes share the same network and application keys, publish to @ref MESH_SIM_GROUP_ADDRESS and
+ * subscribe to it. Node @c n has the unicast address <tt>n + 1</tt>.
+ */
+
+/** Group address all nodes publish to and subscribe to. */
+#define MESH_SIM_GROUP_ADDRESS (0xC001)
+/** Maximum number of nodes. */
+#define MESH_SIM_NODE_COUNT_MAX (4096)
+
+/** Simulated radio parameters. */
+typedef struct
+{
+    uint32_t latency_us;   /**< Time from a packet is sent by the stack until it is on air. */
+    uint32_t jitter_us;    /**< Upper limit of a random delay added to the latency, like the advertiser's. */
+    uint32_t loss_percent; /**< Probability of losing a packet on a link, in percent. */
+    bool collisions;       /**< Whether overlapping packets at a receiver destroy each other. */
+    int8_t rssi_min;       /**< Weakest RSSI a packet can be received with. */
+    bool adv_ext;          /**< Whether the nodes send extended advertising packets, like the Instaburst
+                                bearer, which carry bulk transfer PDUs at the cost of a primary channel packet. */
+    uint32_t seed;         /**< Seed of the simulator's random number generator. */
+} mesh_sim_radio_t;
+
+/** Default radio parameters. */
+#define MESH_SIM_RADIO_DEFAULT                                                                     \
+    {                                                                                              \
+        .latency_us = 500,                                                                         \
+        .jitter_us = 10000,                                                                        \
+        .loss_percent = 0,                                                                         \
+        .collisions = true,                                                                        \
+        .rssi_min = -90,                                                                           \
+        .adv_ext = false,                                                                          \
+        .seed = 1                                                                                  \
+    }
+
+/** Simulator statistics. */
+typedef struct
+{
+    uint64_t events;          /**< Number of processed events. */
+    uint64_t node_switches;   /**< Number of times the state of a node was swapped in. */
+    uint32_t tx_count;        /**< Number of network PDUs sent by the nodes. */
+    uint32_t rx_count;        /**< Number of network PDUs received by the nodes. */
+    uint32_t lost_count;      /**< Number of network PDUs lost on a link. */
+    uint32_t collision_count; /**< Number of network PDUs destroyed by collisions. */
+    uint64_t airtime_us;      /**< Total time on air of the network PDUs sent by the nodes. */
+    uint32_t published;       /**< Number of messages published with @ref mesh_sim_publish(). */
+    uint32_t delivered;       /**< Number of published messages received by a node. */
+    uint64_t latency_total_us; /**< Sum of the delivery latencies of the received messages. */
+    uint32_t latency_max_us;   /**< Longest delivery latency. */
+} mesh_sim_stats_t;
+
+/**
+ * Function run in the context of a node, see @ref mesh_sim_node_run() and @ref mesh_sim_schedule().
+ *
+ * @param[in]     node      Index of the node.
+ * @param[in,out] p_context Context pointer given when running or scheduling the function.
+ */
+typedef void (*mesh_sim_node_func_t)(uint32_t node, void * p_context);
+
+/**
+ * Initializes the simulator with the given number of nodes, all at position (0, 0).
+ *
+ * Any previous simulation is discarded. The nodes are started when the topology is set, with
+ * @ref mesh_sim_start().
+ *
+ * @param[in] node_count Number of nodes.
+ * @param[in] p_radio    Radio parameters.
+ */
+void mesh_sim_init(uint32_t node_count, const mesh_sim_radio_t * p_radio);
+
+/**
+ * Places a node on the plane.
+ *
+ * @param[in] node Index of the node.
+ * @param[in] x    X coordinate in meters.
+ * @param[in] y    Y coordinate in meters.
+ */
+void mesh_sim_node_position_set(uint32_t node, float x, float y);
+
+/**
+ * Sets whether a node relays packets. All nodes relay by default.
+ *
+ * @param[in] node  Index of the node.
+ * @param[in] relay Whether the node relays.
+ */
+void mesh_sim_node_relay_set(uint32_t node, bool relay);
+
+/**
+ * Places the nodes in a grid, row by row.
+ *
+ * @param[in] columns Number of nodes in each row.
+ * @param[in] spacing Distance between neighbouring nodes in meters.
+ */
+void mesh_sim_topology_grid(uint32_t columns, float spacing);
+
+/**
+ * Places the nodes at random positions in a square.
+ *
+ * @param[in] side Length of the sides of the square in meters.
+ */
+void mesh_sim_topology_random(float side);
+
+/**
+ * Builds the links between the nodes and starts all nodes.
+ *
+ * @param[in] range Radio range in meters. Nodes further apart can not hear each other.
+ */
+void mesh_sim_start(float range);
+
+/**
+ * Runs a function in the context of a node, at the current time.
+ *
+ * @param[in]     node      Index of the node.
+ * @param[in]     func      Function to run.
+ * @param[in,out] p_context Context pointer to pass to the function.
+ */
+void mesh_sim_node_run(uint32_t node, mesh_sim_node_func_t func, void * p_context);
+
+/**
+ * Schedules a function to run in the context of a node.
+ *
+ * @param[in]     time_us   Simulation time to run the function at.
+ * @param[in]     node      Index of the node.
+ * @param[in]     func      Function to run.
+ * @param[in,out] p_context Context pointer to pass to the function.
+ */
+void mesh_sim_schedule(uint64_t time_us, uint32_t node, mesh_sim_node_func_t func, void * p_context);
+
+/**
+ * Publishes a message from a node to the group address, at the current time.
+ *
+ * The message carries its publish time, to measure the delivery latency.
+ *
+ * @param[in] node   Index of the node.
+ * @param[in] length Length of the message, at least 8 bytes.
+ * @param[in] force_segmented Whether to send the message segmented, even if it is short.
+ *
+ * @returns The result of @ref host_stack_publish().
+ */
+uint32_t mesh_sim_publish(uint32_t node, uint16_t length, bool force_segmented);
+
+/**
+ * Runs the simulation until the given time, or until there are no more events.
+ *
+ * @param[in] time_us Simulation time to run until.
+ */
+void mesh_sim_run(uint64_t time_us);
+
+/**
+ * Gets the current simulation time.
+ *
+ * @returns The current simulation time in microseconds.
+ */
+uint64_t mesh_sim_time_get(void);
+
+/**
+ * Gets the number of nodes a node can hear.
+ *
+ * @param[in] node Index of the node.
+ *
+ * @returns The number of neighbours of the node.
+ */
+uint32_t mesh_sim_neighbour_count_get(uint32_t node);
+
+/**
+ * Gets the simulator statistics.
+ *
+ * @returns A pointer to the statistics.
+ */
+const mesh_sim_stats_t * mesh_sim_stats_get(void);
+
+/**
+ * Gets the size of the state of a single node.
+ *
+ * @returns The size of the state in bytes.
+ */
+uint32_t mesh_sim_node_state_size_get(void);
+
+#endif /* MESH_SIM_H__ */
@@ -55,6 +55,10 @@ uint8_t * gatt_tx_packet_get(uint16_t * p_size);
 bool gatt_tx_packet_is_allocated(void);
 void gatt_tx_packet_availability_set(bool available);
 uint32_t gatt_tx_packet_alloc_count(void);
+void gatt_tx_refs_hold_set(bool hold);
+uint32_t gatt_tx_refs_release(void);
+void core_tx_packet_shared_set(bool shared);
+uint32_t core_tx_pdu_release_count(void);
 const core_tx_bearer_interface_t * core_tx_if_get(void);
 core_tx_bearer_t * core_tx_bearer_get(void);
 
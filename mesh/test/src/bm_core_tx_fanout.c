@@ -0,0 +1,264 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "core_tx.h"
+#include "packet_buffer.h"
+#include "log.h"
+#include "utils.h"
+
+/* Fan-out of network packets from Core TX to a number of GATT proxy connections, comparing bearers
+ * that copy the packet into their connection buffer against bearers that queue a reference to the
+ * shared PDU. Each connection is modelled with a packet buffer of the same size as the Mesh GATT TX
+ * buffer, holding a small entry header in front of the PDU, or only the header when the PDU is
+ * referenced. Shared bearers fall back to copying when the shared PDU pool is exhausted. The first part measures the CPU time of a fan-out, the second how many packets of a
+ * burst the connections can take before they have a chance to transmit. */
+
+#define CONNECTION_COUNT_MAX    (16)
+/** Size of the Mesh GATT TX buffer of each connection. */
+#define CONN_BUFFER_SIZE        (ALIGN_VAL(65 + sizeof(packet_buffer_packet_t), WORD_SIZE) * 3)
+/** Size of the Mesh GATT buffer entry header, including the proxy PDU header. */
+#define ENTRY_HEADER_SIZE       (14)
+#define NET_PACKET_LEN          (29)
+#define FANOUT_ITERATIONS       (BENCHMARK_ITERATIONS_DEFAULT / 10)
+#define BURST_COUNT             (1000)
+#define BURST_LENGTH            (8)
+
+typedef struct
+{
+    core_tx_bearer_t bearer;
+    packet_buffer_t buffer;
+    uint8_t buffer_data[CONN_BUFFER_SIZE] __attribute__((aligned(WORD_SIZE)));
+    packet_buffer_packet_t * p_alloc;
+    uint32_t delivered;
+} connection_t;
+
+static connection_t m_connections[CONNECTION_COUNT_MAX];
+static uint32_t m_connection_count;
+static bool m_shared;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+static core_tx_alloc_result_t entry_alloc(core_tx_bearer_t * p_bearer, uint16_t size)
+{
+    connection_t * p_connection = PARENT_BY_FIELD_GET(connection_t, bearer, p_bearer);
+    if (packet_buffer_reserve(&p_connection->buffer, &p_connection->p_alloc, size) != NRF_SUCCESS)
+    {
+        return CORE_TX_ALLOC_FAIL_NO_MEM;
+    }
+    return CORE_TX_ALLOC_SUCCESS;
+}
+
+static core_tx_alloc_result_t copy_packet_alloc(core_tx_bearer_t * p_bearer, const core_tx_alloc_params_t * p_params)
+{
+    return entry_alloc(p_bearer, ENTRY_HEADER_SIZE + p_params->net_packet_len);
+}
+
+static core_tx_alloc_result_t shared_packet_alloc(core_tx_bearer_t * p_bearer, const core_tx_alloc_params_t * p_params)
+{
+    if (core_tx_packet_is_shared())
+    {
+        return entry_alloc(p_bearer, ENTRY_HEADER_SIZE);
+    }
+    return copy_packet_alloc(p_bearer, p_params);
+}
+
+static void copy_packet_send(core_tx_bearer_t * p_bearer, const uint8_t * p_packet, uint32_t packet_length)
+{
+    connection_t * p_connection = PARENT_BY_FIELD_GET(connection_t, bearer, p_bearer);
+    memcpy(&p_connection->p_alloc->packet[ENTRY_HEADER_SIZE], p_packet, packet_length);
+    packet_buffer_commit(&p_connection->buffer, p_connection->p_alloc, p_connection->p_alloc->size);
+}
+
+static void shared_packet_send(core_tx_bearer_t * p_bearer, core_tx_pdu_t * p_pdu)
+{
+    connection_t * p_connection = PARENT_BY_FIELD_GET(connection_t, bearer, p_bearer);
+    memcpy(p_connection->p_alloc->packet, &p_pdu, sizeof(p_pdu));
+    packet_buffer_commit(&p_connection->buffer, p_connection->p_alloc, p_connection->p_alloc->size);
+}
+
+static void packet_discard(core_tx_bearer_t * p_bearer)
+{
+    connection_t * p_connection = PARENT_BY_FIELD_GET(connection_t, bearer, p_bearer);
+    packet_buffer_free(&p_connection->buffer, p_connection->p_alloc);
+}
+
+static const core_tx_bearer_interface_t m_copy_interface = {.packet_alloc   = copy_packet_alloc,
+                                                            .packet_send    = copy_packet_send,
+                                                            .packet_discard = packet_discard};
+
+static const core_tx_bearer_interface_t m_shared_interface = {.packet_alloc       = shared_packet_alloc,
+                                                              .packet_send        = copy_packet_send,
+                                                              .packet_discard     = packet_discard,
+                                                              .packet_send_shared = shared_packet_send};
+
+static void connections_setup(uint32_t count, bool shared)
+{
+    core_tx_reset();
+    m_connection_count = count;
+    m_shared = shared;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        memset(&m_connections[i], 0, sizeof(m_connections[i]));
+        packet_buffer_init(&m_connections[i].buffer, m_connections[i].buffer_data, sizeof(m_connections[i].buffer_data));
+        core_tx_bearer_add(&m_connections[i].bearer,
+                           (shared ? &m_shared_interface : &m_copy_interface),
+                           CORE_TX_BEARER_TYPE_GATT_SERVER);
+    }
+}
+
+/* Transmits the oldest packet of the connection, as the GATT TX complete event would. */
+static void connection_drain(connection_t * p_connection)
+{
+    packet_buffer_packet_t * p_packet;
+    if (packet_buffer_pop(&p_connection->buffer, &p_packet) == NRF_SUCCESS)
+    {
+        if (m_shared && p_packet->size == ENTRY_HEADER_SIZE)
+        {
+            core_tx_pdu_t * p_pdu;
+            memcpy(&p_pdu, p_packet->packet, sizeof(p_pdu));
+            if (p_pdu->length != NET_PACKET_LEN)
+            {
+                printf("Shared PDU corrupted\n");
+                exit(EXIT_FAILURE);
+            }
+            core_tx_pdu_release(p_pdu);
+        }
+        packet_buffer_free(&p_connection->buffer, p_packet);
+        p_connection->delivered++;
+    }
+}
+
+static void packet_originate(uint32_t iteration)
+{
+    static network_packet_metadata_t metadata;
+    core_tx_alloc_params_t params = {.role           = CORE_TX_ROLE_ORIGINATOR,
+                                     .net_packet_len = NET_PACKET_LEN,
+                                     .p_metadata     = &metadata,
+                                     .token          = iteration};
+    uint8_t * p_packet;
+    if (core_tx_packet_alloc(&params, &p_packet) != 0)
+    {
+        memset(p_packet, iteration, NET_PACKET_LEN);
+        core_tx_packet_send();
+    }
+}
+
+static void bm_fanout(uint32_t iteration, void * p_context)
+{
+    packet_originate(iteration);
+    for (uint32_t i = 0; i < m_connection_count; ++i)
+    {
+        connection_drain(&m_connections[i]);
+    }
+}
+
+static void burst_run(uint32_t count, bool shared)
+{
+    connections_setup(count, shared);
+
+    for (uint32_t i = 0; i < BURST_COUNT; ++i)
+    {
+        for (uint32_t j = 0; j < BURST_LENGTH; ++j)
+        {
+            packet_originate(j);
+        }
+        /* The connections get to transmit everything before the next burst: */
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            for (uint32_t k = 0; k < BURST_LENGTH; ++k)
+            {
+                connection_drain(&m_connections[j]);
+            }
+        }
+    }
+
+    uint32_t delivered = 0;
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        core_tx_bearer_stats_t stats;
+        if (core_tx_bearer_stats_get(m_connections[i].bearer.bearer_index, &stats) != NRF_SUCCESS)
+        {
+            printf("No stats for bearer %u\n", i);
+            exit(EXIT_FAILURE);
+        }
+        delivered += m_connections[i].delivered;
+        dropped += stats.no_mem_count;
+    }
+    printf("burst %-6s %2u connections: %6u delivered, %6u dropped (%5.1f%% of offered)\n",
+           (shared ? "shared" : "copy"),
+           count,
+           delivered,
+           dropped,
+           (100.0 * dropped) / (count * BURST_COUNT * BURST_LENGTH));
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_NETWORK, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    static const uint32_t connection_counts[] = {1, 4, 8, 16};
+    char name[64];
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(connection_counts); ++i)
+    {
+        connections_setup(connection_counts[i], false);
+        sprintf(name, "fan-out copy, %u connections", connection_counts[i]);
+        benchmark_run(name, FANOUT_ITERATIONS, bm_fanout, NULL);
+
+        connections_setup(connection_counts[i], true);
+        sprintf(name, "fan-out shared, %u connections", connection_counts[i]);
+        benchmark_run(name, FANOUT_ITERATIONS, bm_fanout, NULL);
+    }
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(connection_counts); ++i)
+    {
+        burst_run(connection_counts[i], false);
+        burst_run(connection_counts[i], true);
+    }
+    return EXIT_SUCCESS;
+}
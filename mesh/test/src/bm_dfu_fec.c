@@ -0,0 +1,198 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "dfu_fec.h"
+
+/* Benchmark of DFU forward error correction. Runs a transfer with independent packet loss through
+ * the encoder and decoder, and reports how many of the lost segments are recovered without data
+ * requests, and the time spent decoding. */
+
+#define SEGMENT_COUNT   (2048)
+#define BLOCK_SIZE      (32)
+#define BLOCK_COUNT     ((SEGMENT_COUNT + BLOCK_SIZE - 1) / BLOCK_SIZE)
+
+static uint8_t m_image[SEGMENT_COUNT][SEGMENT_LENGTH];
+
+typedef struct
+{
+    uint32_t lost;
+    uint32_t recovered;
+    uint64_t decode_ns;
+    uint32_t decodes;
+} transfer_result_t;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+static bool is_lost(uint32_t loss_percent)
+{
+    return (benchmark_random() % 100) < loss_percent;
+}
+
+static bool block_transfer(uint32_t block, uint32_t repair_count, uint32_t loss_percent, transfer_result_t * p_result)
+{
+    const uint8_t (*p_block)[SEGMENT_LENGTH] = &m_image[block * BLOCK_SIZE];
+    uint32_t block_size = SEGMENT_COUNT - block * BLOCK_SIZE;
+    if (block_size > BLOCK_SIZE)
+    {
+        block_size = BLOCK_SIZE;
+    }
+
+    uint8_t lost[BLOCK_SIZE];
+    uint32_t lost_count = 0;
+    for (uint32_t i = 0; i < block_size; ++i)
+    {
+        if (is_lost(loss_percent))
+        {
+            lost[lost_count++] = i;
+        }
+    }
+
+    uint8_t repair_indices[DFU_FEC_REPAIR_MAX];
+    uint8_t segments[DFU_FEC_REPAIR_MAX][SEGMENT_LENGTH];
+    uint32_t repair_received = 0;
+    for (uint32_t j = 0; j < repair_count; ++j)
+    {
+        if (!is_lost(loss_percent))
+        {
+            repair_indices[repair_received] = j;
+            memset(segments[repair_received], 0, SEGMENT_LENGTH);
+            for (uint32_t i = 0; i < block_size; ++i)
+            {
+                dfu_fec_accumulate(segments[repair_received], p_block[i], j, i);
+            }
+            repair_received++;
+        }
+    }
+
+    p_result->lost += lost_count;
+    if (lost_count == 0 || lost_count > repair_received)
+    {
+        return true;
+    }
+
+    /* Decode like the target does: remove the received segments from the repair segments, and
+     * solve for the rest. */
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0, m = 0; i < block_size; ++i)
+    {
+        if (m < lost_count && lost[m] == i)
+        {
+            m++;
+            continue;
+        }
+        for (uint32_t r = 0; r < lost_count; ++r)
+        {
+            dfu_fec_accumulate(segments[r], p_block[i], repair_indices[r], i);
+        }
+    }
+    bool solved = dfu_fec_solve(lost_count, repair_indices, lost, segments);
+    p_result->decode_ns += benchmark_time_ns() - start;
+    p_result->decodes++;
+
+    if (!solved)
+    {
+        return false;
+    }
+    for (uint32_t r = 0; r < lost_count; ++r)
+    {
+        if (memcmp(segments[r], p_block[lost[r]], SEGMENT_LENGTH) != 0)
+        {
+            return false;
+        }
+    }
+    p_result->recovered += lost_count;
+    return true;
+}
+
+static void bm_accumulate(uint32_t iteration, void * p_ctx)
+{
+    dfu_fec_accumulate(p_ctx, m_image[iteration % SEGMENT_COUNT], iteration % DFU_FEC_REPAIR_MAX, iteration % BLOCK_SIZE);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < SEGMENT_COUNT; ++i)
+    {
+        for (uint32_t j = 0; j < SEGMENT_LENGTH; ++j)
+        {
+            m_image[i][j] = benchmark_random();
+        }
+    }
+
+    uint8_t repair[SEGMENT_LENGTH] = {0};
+    benchmark_run("dfu_fec_accumulate (one segment)", BENCHMARK_ITERATIONS_DEFAULT, bm_accumulate, repair);
+
+    static const uint32_t loss_rates[] = {5, 10, 20, 30};
+    static const uint32_t repair_counts[] = {2, 4, DFU_FEC_REPAIR_MAX};
+
+    printf("%u segments in blocks of %u\n", SEGMENT_COUNT, BLOCK_SIZE);
+    printf("%-8s %-8s %10s %10s %10s %12s\n", "Loss", "Repair", "Overhead", "Lost", "Recovered", "Decode (ns)");
+    for (uint32_t l = 0; l < sizeof(loss_rates) / sizeof(loss_rates[0]); ++l)
+    {
+        for (uint32_t r = 0; r < sizeof(repair_counts) / sizeof(repair_counts[0]); ++r)
+        {
+            benchmark_random_seed(loss_rates[l]);
+            transfer_result_t result = {0};
+            for (uint32_t b = 0; b < BLOCK_COUNT; ++b)
+            {
+                if (!block_transfer(b, repair_counts[r], loss_rates[l], &result))
+                {
+                    printf("Block %u wasn't recovered correctly\n", b);
+                    return EXIT_FAILURE;
+                }
+            }
+            printf("%6u%% %8u %9u%% %10u %9u%% %12llu\n",
+                   loss_rates[l],
+                   repair_counts[r],
+                   repair_counts[r] * 100 / BLOCK_SIZE,
+                   result.lost,
+                   result.lost ? result.recovered * 100 / result.lost : 100,
+                   result.decodes ? (unsigned long long) (result.decode_ns / result.decodes) : 0ULL);
+        }
+    }
+    return EXIT_SUCCESS;
+}
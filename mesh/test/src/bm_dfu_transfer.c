@@ -0,0 +1,207 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "dfu_transfer_mesh.h"
+#include "dfu_types_mesh.h"
+#include "bootloader_app_bridge.h"
+#include "sha256.h"
+
+/* Benchmark of the image hashing in the DFU signature check. Feeds transfers of realistic image
+ * sizes through the transfer module, with some segments arriving late as if they were lost and
+ * requested again, and compares the time left for hashing after the transfer when the image is
+ * hashed as it's received, with hashing the whole image at the end. */
+
+#define IMAGE_SIZE_MAX          (256 * 1024)
+/** Number of segments a lost segment arrives behind, approximating a data request round trip. */
+#define LATE_SEGMENT_DELAY      (32)
+
+static uint8_t m_image[IMAGE_SIZE_MAX];
+static uint8_t m_bank[IMAGE_SIZE_MAX] __attribute__((aligned(PAGE_SIZE)));
+static uint16_t m_order[IMAGE_SIZE_MAX / SEGMENT_LENGTH];
+static uint8_t * mp_write_src;
+static bool m_aborted;
+
+typedef struct
+{
+    uint64_t receive_ns;
+    uint64_t final_ns;
+} hash_result_t;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+/* The flash operations finish immediately. */
+uint32_t flash_write(void* p_dest, void* p_data, uint32_t length)
+{
+    memcpy(p_dest, p_data, length);
+    mp_write_src = p_data;
+    return NRF_SUCCESS;
+}
+
+uint32_t flash_erase(void* p_dest, uint32_t length)
+{
+    memset(p_dest, 0xFF, length);
+    return NRF_SUCCESS;
+}
+
+void send_end_evt(dfu_end_t end_reason)
+{
+    m_aborted = true;
+}
+
+/* Creates the order the segments arrive in. */
+static uint32_t segment_order_create(uint32_t segment_count, uint32_t late_percent)
+{
+    uint16_t late[IMAGE_SIZE_MAX / SEGMENT_LENGTH];
+    uint32_t late_count = 0;
+    uint32_t late_next = 0;
+    uint32_t count = 0;
+    for (uint32_t segment = 1; segment <= segment_count; ++segment)
+    {
+        if ((benchmark_random() % 100) < late_percent)
+        {
+            late[late_count++] = segment;
+        }
+        else
+        {
+            m_order[count++] = segment;
+        }
+        /* Deliver the late segments once the request for them has been served. */
+        while (late_next < late_count && late[late_next] + LATE_SEGMENT_DELAY <= segment)
+        {
+            m_order[count++] = late[late_next++];
+        }
+    }
+    while (late_next < late_count)
+    {
+        m_order[count++] = late[late_next++];
+    }
+    return count;
+}
+
+/* Runs a transfer, and measures the time spent receiving it and hashing after it. */
+static bool transfer_run(uint32_t size, uint32_t late_percent, bool stream, hash_result_t * p_result, uint8_t * p_hash)
+{
+    uint32_t segment_count = (size + SEGMENT_LENGTH - 1) / SEGMENT_LENGTH;
+    benchmark_random_seed(late_percent);
+    segment_order_create(segment_count, late_percent);
+
+    m_aborted = false;
+    dfu_transfer_init();
+    if (dfu_transfer_start((uint32_t *) m_bank, (uint32_t *) m_bank, size, true) != NRF_SUCCESS)
+    {
+        return false;
+    }
+
+    sha256_context_t hash_context;
+    sha256_init(&hash_context);
+    if (stream)
+    {
+        dfu_transfer_sha256_stream(&hash_context);
+    }
+
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0; i < segment_count; ++i)
+    {
+        uint32_t offset = (m_order[i] - 1) * SEGMENT_LENGTH;
+        uint32_t length = (size - offset < SEGMENT_LENGTH) ? size - offset : SEGMENT_LENGTH;
+        if (dfu_transfer_data((uint32_t) &m_bank[offset], &m_image[offset], length) != NRF_SUCCESS)
+        {
+            return false;
+        }
+        dfu_transfer_flash_write_complete(mp_write_src);
+    }
+    p_result->receive_ns += benchmark_time_ns() - start;
+
+    start = benchmark_time_ns();
+    dfu_transfer_sha256(&hash_context);
+    sha256_final(&hash_context, p_hash, false);
+    p_result->final_ns += benchmark_time_ns() - start;
+    return !m_aborted;
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < IMAGE_SIZE_MAX; ++i)
+    {
+        m_image[i] = benchmark_random();
+    }
+
+    static const uint32_t image_sizes[] = {32 * 1024, 128 * 1024, IMAGE_SIZE_MAX};
+    static const uint32_t late_rates[] = {0, 5, 20};
+
+    printf("Time in us to receive the transfer, and to finish the hash after it\n");
+    printf("%-10s %-6s %16s %16s %16s %16s\n", "Image", "Late", "Receive, end", "Receive, stream", "Final, end", "Final, stream");
+    for (uint32_t s = 0; s < sizeof(image_sizes) / sizeof(image_sizes[0]); ++s)
+    {
+        for (uint32_t l = 0; l < sizeof(late_rates) / sizeof(late_rates[0]); ++l)
+        {
+            hash_result_t end = {0};
+            hash_result_t stream = {0};
+            uint8_t hash_end[32];
+            uint8_t hash_stream[32];
+            if (!transfer_run(image_sizes[s], late_rates[l], false, &end, hash_end) ||
+                !transfer_run(image_sizes[s], late_rates[l], true, &stream, hash_stream))
+            {
+                printf("Transfer of %u bytes failed\n", image_sizes[s]);
+                return EXIT_FAILURE;
+            }
+            if (memcmp(hash_end, hash_stream, sizeof(hash_end)) != 0)
+            {
+                printf("Streamed hash of %u bytes doesn't match\n", image_sizes[s]);
+                return EXIT_FAILURE;
+            }
+            printf("%7u kB %5u%% %16llu %16llu %16llu %16llu\n",
+                   image_sizes[s] / 1024,
+                   late_rates[l],
+                   (unsigned long long) (end.receive_ns / 1000),
+                   (unsigned long long) (stream.receive_ns / 1000),
+                   (unsigned long long) (end.final_ns / 1000),
+                   (unsigned long long) (stream.final_ns / 1000));
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "ecc_p256.h"
+#include "nrf_error.h"
+#include "uECC.h"
+
+/* Benchmark of the P-256 operations used in provisioning, with the precomputed table backend and
+ * uECC side by side. Every result is checked against the other implementation. */
+
+#define ITERATIONS  (200)
+#define KEY_COUNT   (16)
+
+static uint8_t m_private_keys[KEY_COUNT][ECC_P256_PRIVATE_KEY_SIZE];
+static uint8_t m_public_keys[KEY_COUNT][ECC_P256_PUBLIC_KEY_SIZE];
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+void rand_hw_rng_get(uint8_t * p_result, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        p_result[i] = benchmark_random();
+    }
+}
+
+static int rng(uint8_t * p_dest, unsigned size)
+{
+    rand_hw_rng_get(p_dest, size);
+    return 1;
+}
+
+static void bm_ecc_p256_public_key(uint32_t iteration, void * p_ctx)
+{
+    uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+    (void) ecc_p256_public_key_compute(m_private_keys[iteration % KEY_COUNT], public_key);
+}
+
+static void bm_uecc_public_key(uint32_t iteration, void * p_ctx)
+{
+    uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+    (void) uECC_compute_public_key(m_private_keys[iteration % KEY_COUNT], public_key, uECC_secp256r1());
+}
+
+static void bm_ecc_p256_shared_secret(uint32_t iteration, void * p_ctx)
+{
+    uint8_t secret[ECC_P256_SHARED_SECRET_SIZE];
+    (void) ecc_p256_shared_secret(m_public_keys[(iteration + 1) % KEY_COUNT], m_private_keys[iteration % KEY_COUNT], secret);
+}
+
+static void bm_uecc_shared_secret(uint32_t iteration, void * p_ctx)
+{
+    uint8_t secret[ECC_P256_SHARED_SECRET_SIZE];
+    (void) uECC_shared_secret(m_public_keys[(iteration + 1) % KEY_COUNT], m_private_keys[iteration % KEY_COUNT], secret, uECC_secp256r1());
+}
+
+int main(void)
+{
+    uECC_set_rng(rng);
+    for (uint32_t i = 0; i < KEY_COUNT; ++i)
+    {
+        uint8_t expected[ECC_P256_PUBLIC_KEY_SIZE];
+        if (ecc_p256_keys_generate(m_public_keys[i], m_private_keys[i]) != NRF_SUCCESS ||
+            !uECC_compute_public_key(m_private_keys[i], expected, uECC_secp256r1()) ||
+            memcmp(expected, m_public_keys[i], sizeof(expected)) != 0)
+        {
+            printf("Public key %u doesn't match uECC\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    for (uint32_t i = 0; i < KEY_COUNT; ++i)
+    {
+        uint8_t expected[ECC_P256_SHARED_SECRET_SIZE];
+        uint8_t secret[ECC_P256_SHARED_SECRET_SIZE];
+        const uint8_t * p_public = m_public_keys[(i + 1) % KEY_COUNT];
+        if (ecc_p256_shared_secret(p_public, m_private_keys[i], secret) != NRF_SUCCESS ||
+            !uECC_shared_secret(p_public, m_private_keys[i], expected, uECC_secp256r1()) ||
+            memcmp(expected, secret, sizeof(expected)) != 0)
+        {
+            printf("Shared secret %u doesn't match uECC\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint64_t table_ns = benchmark_run("ecc_p256_public_key_compute", ITERATIONS, bm_ecc_p256_public_key, NULL);
+    uint64_t uecc_ns = benchmark_run("uECC_compute_public_key", ITERATIONS, bm_uecc_public_key, NULL);
+    printf("Public key speedup: %.2fx\n", (double) uecc_ns / table_ns);
+
+    table_ns = benchmark_run("ecc_p256_shared_secret", ITERATIONS, bm_ecc_p256_shared_secret, NULL);
+    uecc_ns = benchmark_run("uECC_shared_secret", ITERATIONS, bm_uecc_shared_secret, NULL);
+    printf("Shared secret speedup: %.2fx\n", (double) uecc_ns / table_ns);
+    return EXIT_SUCCESS;
+}
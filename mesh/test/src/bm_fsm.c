@@ -0,0 +1,299 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#include "fsm.h"
+#include "fsm_assistant.h"
+#include "log.h"
+#include "nrf_mesh_defines.h"
+#include "utils.h"
+
+/* Benchmark of FSM event dispatch, using the transition table of the app_level behaviour module in
+ * examples/common. The guards are driven by the benchmark context, so that each event runs through
+ * the same guard checks as in the application. */
+
+#define EVENT_LIST E_SET,                       \
+                   E_DELTA_SET,                 \
+                   E_MOVE_SET,                  \
+                   E_TIMEOUT
+
+#define STATE_LIST  S_IDLE,                     \
+                    S_IN_DELAY,                 \
+                    S_IN_TRANSITION
+
+#define ACTION_LIST A_DELAY_START,          a_delay_start,         \
+                    A_TRANSITION_START,     a_transition_start,    \
+                    A_TRANSITION_COMPLETE,  a_transition_complete, \
+                    A_TRANSITION_TICK,      a_transition_tick
+
+#define GUARD_LIST  G_SET_DELAY,            g_set_delay,           \
+                    G_SET_TRANSITION,       g_set_transition,      \
+                    G_TRANSITION_COMPLETE,  g_transition_complete
+
+typedef enum
+{
+    DECLARE_ENUM(EVENT_LIST)
+} bm_event_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM(STATE_LIST)
+} bm_state_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM_PAIR(ACTION_LIST)
+} bm_action_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM_PAIR(GUARD_LIST)
+} bm_guard_ids_t;
+
+typedef void (* bm_fsm_action_t)(void *);
+typedef bool (* bm_fsm_guard_t)(void *);
+
+/* Not having a semi-colon is intentional. */
+DECLARE_ACTION_PROTOTYPE(ACTION_LIST)
+DECLARE_GUARD_PROTOTYPE(GUARD_LIST)
+
+static void bm_fsm_action(fsm_action_id_t action_id, void * p_data);
+static bool bm_fsm_guard(fsm_guard_id_t guard_id, void * p_data);
+
+static const fsm_transition_t m_bm_fsm_transition_table[] =
+{
+    FSM_STATE(S_IDLE),
+
+    FSM_STATE(S_IN_DELAY),
+    FSM_TRANSITION(E_TIMEOUT,        G_SET_TRANSITION,       A_TRANSITION_START,    S_IN_TRANSITION),
+    FSM_TRANSITION(E_TIMEOUT,        FSM_OTHERWISE,          A_TRANSITION_COMPLETE, S_IDLE),
+
+    FSM_STATE(S_IN_TRANSITION),
+    FSM_TRANSITION(E_TIMEOUT,        G_TRANSITION_COMPLETE,  A_TRANSITION_COMPLETE, S_IDLE),
+    FSM_TRANSITION(E_TIMEOUT,        FSM_ALWAYS,             A_TRANSITION_TICK,     S_IN_TRANSITION),
+
+    FSM_STATE(FSM_ANY_STATE),
+    FSM_TRANSITION(E_SET,             G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
+    FSM_TRANSITION(E_SET,             G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
+    FSM_TRANSITION(E_SET,             FSM_OTHERWISE,      A_TRANSITION_COMPLETE,S_IDLE),
+    FSM_TRANSITION(E_DELTA_SET,       G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
+    FSM_TRANSITION(E_DELTA_SET,       G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
+    FSM_TRANSITION(E_DELTA_SET,       FSM_OTHERWISE,      A_TRANSITION_COMPLETE,S_IDLE),
+    FSM_TRANSITION(E_MOVE_SET,        G_SET_DELAY,        A_DELAY_START,        S_IN_DELAY),
+    FSM_TRANSITION(E_MOVE_SET,        G_SET_TRANSITION,   A_TRANSITION_START,   S_IN_TRANSITION),
+    FSM_TRANSITION(E_MOVE_SET,        FSM_OTHERWISE,      FSM_NO_ACTION,        S_IDLE)
+};
+
+static const char * m_action_lookup_table[] =
+{
+    DECLARE_STRING_PAIR(ACTION_LIST)
+};
+
+static const char * m_guard_lookup_table[] =
+{
+    DECLARE_STRING_PAIR(GUARD_LIST)
+};
+
+static const char * m_event_lookup_table[] =
+{
+    DECLARE_STRING(EVENT_LIST)
+};
+
+static const char * m_state_lookup_table[] =
+{
+    DECLARE_STRING(STATE_LIST)
+};
+
+static uint8_t m_bm_fsm_state_index_table[VA_NARGS(STATE_LIST)];
+
+static const fsm_const_descriptor_t m_indexed_descriptor =
+{
+    .transition_table = m_bm_fsm_transition_table,
+    .transitions_count = ARRAY_SIZE(m_bm_fsm_transition_table),
+    .initial_state = S_IDLE,
+    .guard = bm_fsm_guard,
+    .action = bm_fsm_action,
+    .state_index_table = m_bm_fsm_state_index_table,
+    .states_count = ARRAY_SIZE(m_bm_fsm_state_index_table),
+    .fsm_name = "BM-fsm",
+    .action_lookup = m_action_lookup_table,
+    .event_lookup = m_event_lookup_table,
+    .guard_lookup = m_guard_lookup_table,
+    .state_lookup = m_state_lookup_table
+};
+
+/* Same FSM without the state index table, dispatching by searching the transition table. */
+static const fsm_const_descriptor_t m_unindexed_descriptor =
+{
+    .transition_table = m_bm_fsm_transition_table,
+    .transitions_count = ARRAY_SIZE(m_bm_fsm_transition_table),
+    .initial_state = S_IDLE,
+    .guard = bm_fsm_guard,
+    .action = bm_fsm_action,
+    .state_index_table = NULL,
+    .states_count = 0,
+    .fsm_name = "BM-fsm",
+    .action_lookup = m_action_lookup_table,
+    .event_lookup = m_event_lookup_table,
+    .guard_lookup = m_guard_lookup_table,
+    .state_lookup = m_state_lookup_table
+};
+
+static const bm_fsm_action_t bm_fsm_actions[] =
+{
+    DECLARE_HANDLER(ACTION_LIST)
+};
+
+static const bm_fsm_guard_t bm_fsm_guards[] =
+{
+    DECLARE_HANDLER(GUARD_LIST)
+};
+
+/** Number of ticks in each simulated transition. */
+#define TRANSITION_TICKS 8
+
+typedef struct
+{
+    fsm_t fsm;
+    bool delay;
+    bool transition;
+    uint32_t ticks_remaining;
+    uint32_t actions;
+} bm_context_t;
+
+static void bm_fsm_action(fsm_action_id_t action_id, void * p_data)
+{
+    bm_fsm_actions[action_id](p_data);
+}
+
+static bool bm_fsm_guard(fsm_guard_id_t guard_id, void * p_data)
+{
+    return bm_fsm_guards[guard_id](p_data);
+}
+
+static void a_delay_start(void * p_data)
+{
+    bm_context_t * p_context = p_data;
+    p_context->delay = false;
+    p_context->actions++;
+}
+
+static void a_transition_start(void * p_data)
+{
+    bm_context_t * p_context = p_data;
+    p_context->ticks_remaining = TRANSITION_TICKS;
+    p_context->actions++;
+}
+
+static void a_transition_complete(void * p_data)
+{
+    bm_context_t * p_context = p_data;
+    p_context->ticks_remaining = 0;
+    p_context->actions++;
+}
+
+static void a_transition_tick(void * p_data)
+{
+    bm_context_t * p_context = p_data;
+    p_context->ticks_remaining--;
+    p_context->actions++;
+}
+
+static bool g_set_delay(void * p_data)
+{
+    return ((bm_context_t *) p_data)->delay;
+}
+
+static bool g_set_transition(void * p_data)
+{
+    return ((bm_context_t *) p_data)->transition;
+}
+
+static bool g_transition_complete(void * p_data)
+{
+    return ((bm_context_t *) p_data)->ticks_remaining == 0;
+}
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+/* Runs a mix of events resembling a level server: set messages with and without delay, followed by
+ * timeouts until the transition completes. */
+static void bm_kernel(uint32_t iteration, void * p_ctx)
+{
+    bm_context_t * p_context = p_ctx;
+
+    switch (p_context->fsm.current_state)
+    {
+        case S_IDLE:
+            p_context->delay = ((iteration & 0x3) == 0);
+            p_context->transition = ((iteration & 0x1) == 0);
+            fsm_event_post(&p_context->fsm, (fsm_event_id_t) (iteration % 3), p_context);
+            break;
+        default:
+            fsm_event_post(&p_context->fsm, E_TIMEOUT, p_context);
+            break;
+    }
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_FSM, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    bm_context_t indexed = {0};
+    bm_context_t unindexed = {0};
+    fsm_init(&indexed.fsm, &m_indexed_descriptor);
+    fsm_init(&unindexed.fsm, &m_unindexed_descriptor);
+
+    benchmark_run("fsm_event_post (app_level table, scanned)", BENCHMARK_ITERATIONS_DEFAULT, bm_kernel, &unindexed);
+    benchmark_run("fsm_event_post (app_level table, indexed)", BENCHMARK_ITERATIONS_DEFAULT, bm_kernel, &indexed);
+
+    /* Both FSMs must have taken exactly the same transitions. */
+    if (indexed.actions != unindexed.actions || indexed.fsm.current_state != unindexed.fsm.current_state)
+    {
+        printf("Indexed and scanned dispatch diverged: %u/%u actions\n", indexed.actions, unindexed.actions);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
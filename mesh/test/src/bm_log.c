@@ -0,0 +1,121 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#include "log.h"
+#include "nrf_mesh_defines.h"
+#include "utils.h"
+
+/* Benchmark of the per-call cost of logging, comparing a callback that formats the message at the
+ * call site (like the RTT and stdout backends) with the deferred backend. The formatting callback
+ * writes to a RAM buffer, so that only the formatting is measured, not the output channel. The
+ * deferred log buffer is drained every few calls, like the application would in its main loop. */
+
+/** Number of log calls between each read-out of the deferred log buffer. */
+#define DRAIN_INTERVAL 16
+
+static char m_text[256];
+static uint8_t m_drain_buffer[LOG_DEFERRED_BUFFER_SIZE];
+static uint32_t m_bytes_read;
+
+static void log_callback_format(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * format, va_list arguments)
+{
+    int length = snprintf(m_text, sizeof(m_text), "<t: %10u>, %s, %4d, ", timestamp, p_filename, line);
+    (void) vsnprintf(&m_text[length], sizeof(m_text) - length, format, arguments);
+}
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+static void drain(uint32_t iteration)
+{
+    if ((iteration % DRAIN_INTERVAL) == DRAIN_INTERVAL - 1)
+    {
+        m_bytes_read += log_deferred_read(m_drain_buffer, sizeof(m_drain_buffer));
+    }
+}
+
+/* Same arguments as the network layer's packet logging. */
+static void bm_log(uint32_t iteration, void * p_ctx)
+{
+    __LOG(LOG_SRC_NETWORK, LOG_LEVEL_INFO, "RX: iv_index: 0x%08x src: 0x%04x dst: 0x%04x seq: %u ttl: %u\n",
+          0x12345678, iteration & 0xFFFF, 0xC000, iteration, 7);
+    drain(iteration);
+}
+
+static void bm_log_xb(uint32_t iteration, void * p_ctx)
+{
+    const uint8_t * p_payload = p_ctx;
+    __LOG_XB(LOG_SRC_NETWORK, LOG_LEVEL_INFO, "Decrypted payload", p_payload, 16);
+    drain(iteration);
+}
+
+int main(void)
+{
+    uint8_t payload[16];
+    for (uint32_t i = 0; i < sizeof(payload); ++i)
+    {
+        payload[i] = benchmark_random();
+    }
+
+    __LOG_INIT(LOG_SRC_NETWORK, LOG_LEVEL_INFO, log_callback_format);
+    benchmark_run("__LOG (formatted)", BENCHMARK_ITERATIONS_DEFAULT, bm_log, NULL);
+    benchmark_run("__LOG_XB 16 bytes (formatted)", BENCHMARK_ITERATIONS_DEFAULT, bm_log_xb, payload);
+
+    __LOG_INIT(LOG_SRC_NETWORK, LOG_LEVEL_INFO, log_callback_deferred);
+    benchmark_run("__LOG (deferred)", BENCHMARK_ITERATIONS_DEFAULT, bm_log, NULL);
+    benchmark_run("__LOG_XB 16 bytes (deferred)", BENCHMARK_ITERATIONS_DEFAULT, bm_log_xb, payload);
+
+    /* Every deferred call must have been stored and read back out. */
+    const log_deferred_stats_t * p_stats = log_deferred_stats_get();
+    if (p_stats->records_dropped != 0 || p_stats->records_written != 2 * BENCHMARK_ITERATIONS_DEFAULT ||
+        m_bytes_read == 0)
+    {
+        printf("Deferred log records lost: %u written, %u dropped\n",
+               p_stats->records_written, p_stats->records_dropped);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,505 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "mesh_sim.h"
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "nrf_mesh_opt.h"
+#include "network.h"
+#include "transport.h"
+#include "relay_policy.h"
+#include "log.h"
+#include "utils.h"
+
+/* Whole network simulation of a mesh network, with a full host stack instance in every node. The
+ * network is set up and driven by a scenario script:
+ *
+ *     bm_mesh_sim SCENARIO_FILE
+ *
+ * with one command per line, and comments starting with '#':
+ *
+ *     seed SEED                            Seed of the simulation, before "nodes".
+ *     radio latency|jitter US              Radio timing, before "nodes".
+ *     radio loss PERCENT                   Link loss probability, before "nodes".
+ *     radio collisions on|off              Whether overlapping packets collide, before "nodes".
+ *     radio rssi_min DBM                   Receiver sensitivity, before "nodes".
+ *     radio adv_ext on|off                 Whether the nodes send extended advertising packets,
+ *                                          like the Instaburst bearer, before "nodes".
+ *     nodes COUNT                          Creates the network.
+ *     topology grid COLUMNS SPACING_M      Places the nodes in a grid.
+ *     topology random SIDE_M               Places the nodes at random in a square.
+ *     relay all|none|every N               Picks the relay nodes.
+ *     start RANGE_M                        Links the nodes within range, and starts them.
+ *     policy always                        Relay policy of all nodes, after "start".
+ *     policy counter THRESHOLD BACKOFF_MS
+ *     policy rssi THRESHOLD_DBM
+ *     policy density TARGET
+ *     bulk on|off                          Whether all nodes send long messages as single bulk
+ *                                          transfer PDUs, after "start". Without "radio adv_ext on",
+ *                                          they fall back to segmentation.
+ *     publish NODE|random COUNT INTERVAL_MS LENGTH [segmented]
+ *                                          Publishes messages to all nodes, starting now. Every
+ *                                          node tracks at most REPLAY_CACHE_ENTRIES sources, and
+ *                                          drops messages from any others.
+ *     run SECONDS                          Runs the simulation.
+ *     report                               Prints the statistics.
+ *     expect delivery PERCENT              Fails unless enough messages were delivered.
+ *
+ * Without arguments, a built-in scenario with 100 nodes in a grid is run. */
+
+#define LINE_LENGTH_MAX (256)
+#define ARGS_MAX        (8)
+
+typedef struct
+{
+    uint32_t node;
+    uint16_t length;
+    bool segmented;
+} publication_t;
+
+static const char * mp_default_scenario[] =
+{
+    "seed 1",
+    "nodes 100",
+    "topology grid 10 10",
+    "relay every 2",
+    "start 25",
+    "policy counter 3 40",
+    "publish 0 50 500 8",
+    "publish 55 50 500 8",
+    "publish 99 50 500 8",
+    "publish 9 5 5000 30 segmented",
+    "run 30",
+    "report",
+    "expect delivery 95",
+};
+
+static mesh_sim_radio_t m_radio = MESH_SIM_RADIO_DEFAULT;
+static uint32_t m_node_count;
+static uint32_t m_publish_failures;
+static uint32_t m_publish_seed = 1;
+static uint64_t m_elapsed_ns;
+
+/*****************************************************************************
+* Node functions
+*****************************************************************************/
+static void publish_run(uint32_t node, void * p_context)
+{
+    publication_t * p_publication = p_context;
+    if (mesh_sim_publish(node, p_publication->length, p_publication->segmented) != NRF_SUCCESS)
+    {
+        m_publish_failures++;
+    }
+    free(p_publication);
+}
+
+static void policy_set(uint32_t node, void * p_context)
+{
+    const relay_policy_config_t * p_config = p_context;
+    nrf_mesh_opt_t opt = {.len = sizeof(uint32_t)};
+    opt.opt.val = p_config->type;
+    NRF_MESH_ERROR_CHECK(network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY, &opt));
+    opt.opt.val = p_config->counter_threshold;
+    NRF_MESH_ERROR_CHECK(network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_COUNTER_THRESHOLD, &opt));
+    opt.opt.val = US_TO_MS(p_config->backoff_max_us);
+    NRF_MESH_ERROR_CHECK(network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS, &opt));
+    opt.opt.val = (uint32_t) (int32_t) p_config->rssi_threshold;
+    NRF_MESH_ERROR_CHECK(network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_RSSI_THRESHOLD, &opt));
+    opt.opt.val = p_config->density_target;
+    NRF_MESH_ERROR_CHECK(network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_DENSITY_TARGET, &opt));
+}
+
+static void bulk_set(uint32_t node, void * p_context)
+{
+    const bool * p_enabled = p_context;
+    nrf_mesh_opt_t opt = {.len = sizeof(uint32_t)};
+    opt.opt.val = *p_enabled;
+    NRF_MESH_ERROR_CHECK(transport_opt_set(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+}
+
+static void policy_stats_add(uint32_t node, void * p_context)
+{
+    relay_policy_stats_t * p_total = p_context;
+    relay_policy_stats_t stats;
+    nrf_mesh_opt_t opt = {.len = sizeof(stats)};
+    opt.opt.p_array = (uint8_t *) &stats;
+    NRF_MESH_ERROR_CHECK(network_opt_get(NRF_MESH_OPT_NET_RELAY_POLICY_STATS, &opt));
+    p_total->relayed += stats.relayed;
+    p_total->suppressed_counter += stats.suppressed_counter;
+    p_total->suppressed_rssi += stats.suppressed_rssi;
+    p_total->suppressed_density += stats.suppressed_density;
+}
+
+/*****************************************************************************
+* Scenario commands
+*****************************************************************************/
+static uint32_t delivery_percent_get(void)
+{
+    const mesh_sim_stats_t * p_stats = mesh_sim_stats_get();
+    uint64_t expected = (uint64_t) p_stats->published * (m_node_count - 1);
+    return (expected == 0) ? 0 : (uint32_t) (100 * (uint64_t) p_stats->delivered / expected);
+}
+
+static void report(void)
+{
+    const mesh_sim_stats_t * p_stats = mesh_sim_stats_get();
+    relay_policy_stats_t policy_stats;
+    memset(&policy_stats, 0, sizeof(policy_stats));
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        mesh_sim_node_run(i, policy_stats_add, &policy_stats);
+    }
+
+    uint64_t neighbours = 0;
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        neighbours += mesh_sim_neighbour_count_get(i);
+    }
+
+    benchmark_report("mesh sim (events)", p_stats->events, m_elapsed_ns);
+    printf("%u nodes, %llu neighbours on average, %u bytes of state per node\n",
+           m_node_count,
+           (unsigned long long) (neighbours / m_node_count),
+           mesh_sim_node_state_size_get());
+    printf("simulated %llu ms in %llu ms, %llu node switches\n",
+           (unsigned long long) (mesh_sim_time_get() / 1000),
+           (unsigned long long) (m_elapsed_ns / 1000000),
+           (unsigned long long) p_stats->node_switches);
+    printf("published %u messages (%u failed), delivered %u (%u%%)\n",
+           p_stats->published, m_publish_failures, p_stats->delivered, delivery_percent_get());
+    if (p_stats->delivered > 0)
+    {
+        printf("latency: mean %llu us, max %u us\n",
+               (unsigned long long) (p_stats->latency_total_us / p_stats->delivered),
+               p_stats->latency_max_us);
+    }
+    printf("radio: %u packets sent, %u received, %u lost, %u collided, %llu ms on air\n",
+           p_stats->tx_count, p_stats->rx_count, p_stats->lost_count, p_stats->collision_count,
+           (unsigned long long) (p_stats->airtime_us / 1000));
+    printf("relay policy: %u relayed, suppressed %u by counter, %u by RSSI, %u by density\n",
+           policy_stats.relayed,
+           policy_stats.suppressed_counter,
+           policy_stats.suppressed_rssi,
+           policy_stats.suppressed_density);
+}
+
+static bool radio_command(char ** pp_args, uint32_t arg_count)
+{
+    if (arg_count != 3 || m_node_count != 0)
+    {
+        return false;
+    }
+
+    if (strcmp(pp_args[1], "latency") == 0)
+    {
+        m_radio.latency_us = strtoul(pp_args[2], NULL, 0);
+    }
+    else if (strcmp(pp_args[1], "jitter") == 0)
+    {
+        m_radio.jitter_us = strtoul(pp_args[2], NULL, 0);
+    }
+    else if (strcmp(pp_args[1], "loss") == 0)
+    {
+        m_radio.loss_percent = strtoul(pp_args[2], NULL, 0);
+    }
+    else if (strcmp(pp_args[1], "collisions") == 0)
+    {
+        m_radio.collisions = (strcmp(pp_args[2], "on") == 0);
+    }
+    else if (strcmp(pp_args[1], "rssi_min") == 0)
+    {
+        m_radio.rssi_min = strtol(pp_args[2], NULL, 0);
+    }
+    else if (strcmp(pp_args[1], "adv_ext") == 0)
+    {
+        m_radio.adv_ext = (strcmp(pp_args[2], "on") == 0);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+static bool policy_command(char ** pp_args, uint32_t arg_count)
+{
+    relay_policy_config_t config = RELAY_POLICY_CONFIG_DEFAULT;
+    if (arg_count == 2 && strcmp(pp_args[1], "always") == 0)
+    {
+        config.type = RELAY_POLICY_TYPE_ALWAYS;
+    }
+    else if (arg_count == 4 && strcmp(pp_args[1], "counter") == 0)
+    {
+        config.type = RELAY_POLICY_TYPE_COUNTER;
+        config.counter_threshold = strtoul(pp_args[2], NULL, 0);
+        config.backoff_max_us = MS_TO_US(strtoul(pp_args[3], NULL, 0));
+    }
+    else if (arg_count == 3 && strcmp(pp_args[1], "rssi") == 0)
+    {
+        config.type = RELAY_POLICY_TYPE_RSSI;
+        config.rssi_threshold = strtol(pp_args[2], NULL, 0);
+    }
+    else if (arg_count == 3 && strcmp(pp_args[1], "density") == 0)
+    {
+        config.type = RELAY_POLICY_TYPE_DENSITY;
+        config.density_target = strtoul(pp_args[2], NULL, 0);
+    }
+    else
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        mesh_sim_node_run(i, policy_set, &config);
+    }
+    return true;
+}
+
+static bool publish_command(char ** pp_args, uint32_t arg_count)
+{
+    if (arg_count < 5 || arg_count > 6)
+    {
+        return false;
+    }
+
+    bool random_node = (strcmp(pp_args[1], "random") == 0);
+    uint32_t node = strtoul(pp_args[1], NULL, 0);
+    uint32_t count = strtoul(pp_args[2], NULL, 0);
+    uint64_t interval_us = MS_TO_US((uint64_t) strtoul(pp_args[3], NULL, 0));
+    uint32_t length = strtoul(pp_args[4], NULL, 0);
+    if ((!random_node && node >= m_node_count) || length < 8 || length > ACCESS_MESSAGE_LENGTH_MAX)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        publication_t * p_publication = malloc(sizeof(publication_t));
+        NRF_MESH_ASSERT(p_publication != NULL);
+        p_publication->length = length;
+        p_publication->segmented = (arg_count == 6 && strcmp(pp_args[5], "segmented") == 0);
+        /* The publishers are picked with the benchmark generator, to keep the radio's random
+         * numbers independent of the traffic pattern. */
+        p_publication->node = random_node ? (benchmark_random() % m_node_count) : node;
+        mesh_sim_schedule(mesh_sim_time_get() + i * interval_us,
+                          p_publication->node,
+                          publish_run,
+                          p_publication);
+    }
+    return true;
+}
+
+static bool command_run(char * p_line)
+{
+    char * pp_args[ARGS_MAX];
+    uint32_t arg_count = 0;
+    char * p_comment = strchr(p_line, '#');
+    if (p_comment != NULL)
+    {
+        *p_comment = '\0';
+    }
+    for (char * p_token = strtok(p_line, " \t\r\n"); p_token != NULL && arg_count < ARGS_MAX;
+         p_token = strtok(NULL, " \t\r\n"))
+    {
+        pp_args[arg_count++] = p_token;
+    }
+
+    if (arg_count == 0)
+    {
+        return true;
+    }
+
+    const char * p_command = pp_args[0];
+    bool started = (m_node_count != 0);
+    if (strcmp(p_command, "seed") == 0 && arg_count == 2 && !started)
+    {
+        m_radio.seed = strtoul(pp_args[1], NULL, 0);
+        m_publish_seed = m_radio.seed;
+        return true;
+    }
+    if (strcmp(p_command, "radio") == 0)
+    {
+        return radio_command(pp_args, arg_count);
+    }
+    if (strcmp(p_command, "nodes") == 0 && arg_count == 2 && !started)
+    {
+        m_node_count = strtoul(pp_args[1], NULL, 0);
+        if (m_node_count < 2 || m_node_count > MESH_SIM_NODE_COUNT_MAX)
+        {
+            m_node_count = 0;
+            return false;
+        }
+        mesh_sim_init(m_node_count, &m_radio);
+        benchmark_random_seed(m_publish_seed);
+        return true;
+    }
+    if (!started)
+    {
+        return false;
+    }
+
+    if (strcmp(p_command, "topology") == 0 && arg_count == 4 && strcmp(pp_args[1], "grid") == 0)
+    {
+        mesh_sim_topology_grid(MAX(strtoul(pp_args[2], NULL, 0), 1), strtof(pp_args[3], NULL));
+        return true;
+    }
+    if (strcmp(p_command, "topology") == 0 && arg_count == 3 && strcmp(pp_args[1], "random") == 0)
+    {
+        mesh_sim_topology_random(strtof(pp_args[2], NULL));
+        return true;
+    }
+    if (strcmp(p_command, "relay") == 0 && arg_count >= 2)
+    {
+        uint32_t every = 1;
+        if (strcmp(pp_args[1], "none") == 0)
+        {
+            every = 0;
+        }
+        else if (strcmp(pp_args[1], "every") == 0 && arg_count == 3)
+        {
+            every = strtoul(pp_args[2], NULL, 0);
+        }
+        else if (strcmp(pp_args[1], "all") != 0)
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < m_node_count; ++i)
+        {
+            mesh_sim_node_relay_set(i, every != 0 && (i % every) == 0);
+        }
+        return true;
+    }
+    if (strcmp(p_command, "start") == 0 && arg_count == 2)
+    {
+        mesh_sim_start(strtof(pp_args[1], NULL));
+        return true;
+    }
+    if (strcmp(p_command, "policy") == 0)
+    {
+        return policy_command(pp_args, arg_count);
+    }
+    if (strcmp(p_command, "bulk") == 0 && arg_count == 2)
+    {
+        bool enabled = (strcmp(pp_args[1], "on") == 0);
+        if (!TRANSPORT_BULK_ENABLE)
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < m_node_count; ++i)
+        {
+            mesh_sim_node_run(i, bulk_set, &enabled);
+        }
+        return true;
+    }
+    if (strcmp(p_command, "publish") == 0)
+    {
+        return publish_command(pp_args, arg_count);
+    }
+    if (strcmp(p_command, "run") == 0 && arg_count == 2)
+    {
+        uint64_t start = benchmark_time_ns();
+        mesh_sim_run(mesh_sim_time_get() + SEC_TO_US((uint64_t) strtoul(pp_args[1], NULL, 0)));
+        m_elapsed_ns += benchmark_time_ns() - start;
+        return true;
+    }
+    if (strcmp(p_command, "report") == 0 && arg_count == 1)
+    {
+        report();
+        return true;
+    }
+    if (strcmp(p_command, "expect") == 0 && arg_count == 3 && strcmp(pp_args[1], "delivery") == 0)
+    {
+        uint32_t expected = strtoul(pp_args[2], NULL, 0);
+        if (delivery_percent_get() < expected)
+        {
+            printf("Expected a delivery ratio of at least %u%%, got %u%%\n", expected, delivery_percent_get());
+            exit(EXIT_FAILURE);
+        }
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char ** argv)
+{
+    __LOG_INIT(LOG_SRC_NETWORK | LOG_SRC_TRANSPORT | LOG_SRC_ACCESS, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    char line[LINE_LENGTH_MAX];
+    uint32_t line_number = 0;
+    if (argc < 2)
+    {
+        for (uint32_t i = 0; i < ARRAY_SIZE(mp_default_scenario); ++i)
+        {
+            line_number++;
+            strcpy(line, mp_default_scenario[i]);
+            if (!command_run(line))
+            {
+                printf("Invalid command on line %u: %s\n", line_number, mp_default_scenario[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    FILE * p_file = fopen(argv[1], "r");
+    if (p_file == NULL)
+    {
+        printf("Failed opening %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    while (fgets(line, sizeof(line), p_file) != NULL)
+    {
+        char command[LINE_LENGTH_MAX];
+        line_number++;
+        strcpy(command, line);
+        if (!command_run(command))
+        {
+            printf("Invalid command on line %u: %s", line_number, line);
+            fclose(p_file);
+            return EXIT_FAILURE;
+        }
+    }
+    fclose(p_file);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "net_packet.h"
+#include "packet_mesh.h"
+#include "nrf_mesh_externs.h"
+#include "nrf_mesh_utils.h"
+#include "msg_cache.h"
+#include "net_state.h"
+#include "rand.h"
+#include "log.h"
+#include "utils.h"
+
+/* Benchmark of the relay path of the network layer. A set of network packets with random headers
+ * and payloads is encrypted and decrypted once, and then relayed over and over, both through the
+ * originator TX path the relay used before (header serialization, payload copy and in-place
+ * encryption), and through the relay encryption straight from the decrypted packet. The full
+ * receive and relay of a packet is measured as well, for comparison. All crypto runs on the
+ * software AES implementation. */
+
+#define PACKET_COUNT          (64)
+#define RELAY_ITERATIONS      (BENCHMARK_ITERATIONS_DEFAULT / 10)
+#define IV_INDEX              (0x12345678)
+
+typedef struct
+{
+    network_packet_metadata_t metadata;
+    uint32_t net_packet_len;
+    uint32_t payload_len;
+    packet_mesh_net_packet_t encrypted;
+    packet_mesh_net_packet_t decrypted;
+} bm_packet_t;
+
+static bm_packet_t m_packets[PACKET_COUNT];
+static nrf_mesh_network_secmat_t m_secmat;
+static packet_mesh_net_packet_t m_relay_packet;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+/* The network state and key lookups are stubbed out, as only the crypto is of interest. */
+void rand_hw_rng_get(uint8_t * p_result, uint16_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        p_result[i] = benchmark_random();
+    }
+}
+
+bool msg_cache_entry_exists(uint16_t src_addr, uint32_t sequence_number)
+{
+    return false;
+}
+
+uint32_t net_state_rx_iv_index_get(uint8_t ivi)
+{
+    return IV_INDEX;
+}
+
+void nrf_mesh_net_secmat_next_get(uint8_t nid,
+                                  const nrf_mesh_network_secmat_t ** pp_secmat,
+                                  const nrf_mesh_network_secmat_t ** pp_aux_secmat)
+{
+    *pp_secmat = (*pp_secmat == NULL && nid == m_secmat.nid) ? &m_secmat : NULL;
+    *pp_aux_secmat = NULL;
+}
+
+bool nrf_mesh_rx_address_get(uint16_t raw_address, nrf_mesh_address_t * p_address)
+{
+    return false;
+}
+
+/* Relays the packet the way the relay used to, through the originator TX path. */
+static void relay_legacy(const bm_packet_t * p_packet)
+{
+    network_packet_metadata_t metadata = p_packet->metadata;
+    metadata.ttl--;
+
+    net_packet_header_set(&m_relay_packet, &metadata);
+    memcpy(net_packet_payload_get(&m_relay_packet),
+           packet_mesh_net_payload_get(&p_packet->decrypted),
+           p_packet->payload_len);
+    net_packet_encrypt(&metadata, p_packet->payload_len, &m_relay_packet, NET_PACKET_KIND_TRANSPORT);
+}
+
+static void relay_fast(const bm_packet_t * p_packet)
+{
+    network_packet_metadata_t metadata = p_packet->metadata;
+    metadata.ttl--;
+
+    net_packet_relay_encrypt(&metadata, p_packet->payload_len, &p_packet->decrypted, &m_relay_packet);
+}
+
+static void bm_relay_legacy(uint32_t iteration, void * p_context)
+{
+    relay_legacy(&m_packets[iteration % PACKET_COUNT]);
+}
+
+static void bm_relay_fast(uint32_t iteration, void * p_context)
+{
+    relay_fast(&m_packets[iteration % PACKET_COUNT]);
+}
+
+static void bm_receive_and_relay_fast(uint32_t iteration, void * p_context)
+{
+    bm_packet_t * p_packet = &m_packets[iteration % PACKET_COUNT];
+    network_packet_metadata_t metadata;
+    packet_mesh_net_packet_t decrypted;
+    memcpy(&decrypted, &p_packet->encrypted, 1);
+    if (net_packet_decrypt(&metadata,
+                           p_packet->net_packet_len,
+                           &p_packet->encrypted,
+                           &decrypted,
+                           NET_PACKET_KIND_TRANSPORT) != NRF_SUCCESS)
+    {
+        printf("Decryption of packet %u failed\n", iteration % PACKET_COUNT);
+        exit(EXIT_FAILURE);
+    }
+    metadata.ttl--;
+    net_packet_relay_encrypt(&metadata, p_packet->payload_len, &decrypted, &m_relay_packet);
+}
+
+static void packets_generate(void)
+{
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        m_secmat.encryption_key[i] = benchmark_random();
+        m_secmat.privacy_key[i] = benchmark_random();
+    }
+    m_secmat.nid = benchmark_random() & 0x7F;
+
+    for (uint32_t i = 0; i < PACKET_COUNT; ++i)
+    {
+        bm_packet_t * p_packet = &m_packets[i];
+        network_packet_metadata_t metadata;
+        metadata.control_packet           = (benchmark_random() % 4) == 0;
+        metadata.src                      = 0x0001 + (benchmark_random() % 0x7FFE);
+        metadata.dst.value                = 0xC000 + (benchmark_random() % 0x3F00);
+        metadata.dst.type                 = NRF_MESH_ADDRESS_TYPE_GROUP;
+        metadata.ttl                      = 2 + (benchmark_random() % (NRF_MESH_TTL_MAX - 1));
+        metadata.internal.iv_index        = IV_INDEX;
+        metadata.internal.sequence_number = benchmark_random() & NETWORK_SEQNUM_MAX;
+        metadata.p_security_material      = &m_secmat;
+
+        /* Payload lengths of unsegmented access and control messages, and of segments. */
+        uint32_t payload_len_max = metadata.control_packet ? 12 : 16;
+        p_packet->payload_len = 1 + (benchmark_random() % payload_len_max);
+        p_packet->net_packet_len = PACKET_MESH_NET_PDU_OFFSET + p_packet->payload_len +
+                                   net_packet_mic_size_get(metadata.control_packet);
+
+        net_packet_header_set(&p_packet->encrypted, &metadata);
+        uint8_t * p_payload = (uint8_t *) packet_mesh_net_payload_get(&p_packet->encrypted);
+        for (uint32_t j = 0; j < p_packet->payload_len; ++j)
+        {
+            p_payload[j] = benchmark_random();
+        }
+        net_packet_encrypt(&metadata, p_packet->payload_len, &p_packet->encrypted, NET_PACKET_KIND_TRANSPORT);
+
+        memcpy(&p_packet->decrypted, &p_packet->encrypted, 1);
+        if (net_packet_decrypt(&p_packet->metadata,
+                               p_packet->net_packet_len,
+                               &p_packet->encrypted,
+                               &p_packet->decrypted,
+                               NET_PACKET_KIND_TRANSPORT) != NRF_SUCCESS)
+        {
+            printf("Decryption of packet %u failed\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_NETWORK, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    packets_generate();
+
+    /* Both paths must produce exactly the same relay packets. */
+    for (uint32_t i = 0; i < PACKET_COUNT; ++i)
+    {
+        packet_mesh_net_packet_t legacy;
+        relay_legacy(&m_packets[i]);
+        memcpy(&legacy, &m_relay_packet, m_packets[i].net_packet_len);
+        relay_fast(&m_packets[i]);
+        if (memcmp(&legacy, &m_relay_packet, m_packets[i].net_packet_len) != 0)
+        {
+            printf("Relay paths differ for packet %u\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    benchmark_run("relay (originator TX path)", RELAY_ITERATIONS, bm_relay_legacy, NULL);
+    benchmark_run("relay (relay encrypt)", RELAY_ITERATIONS, bm_relay_fast, NULL);
+    benchmark_run("decrypt + relay (relay encrypt)", RELAY_ITERATIONS, bm_receive_and_relay_fast, NULL);
+    return EXIT_SUCCESS;
+}
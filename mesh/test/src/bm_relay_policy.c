@@ -0,0 +1,393 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#include "relay_policy.h"
+#include "timer_scheduler.h"
+#include "log.h"
+#include "utils.h"
+
+/* Simulation of a network of relay nodes, comparing the relay policies on how many nodes a
+ * flooded message reaches against how much airtime it takes to get there. The nodes are placed in
+ * a grid, and hear each other within a fixed radio range, with an RSSI falling off linearly with
+ * the distance. A node that decides to relay transmits after a random advertiser delay, and packets
+ * that overlap in time at a receiver are lost. Messages are sent one at a time from a random
+ * node, with enough time between them for the network to settle. */
+
+#define GRID_ROWS               (10)
+#define GRID_COLS               (10)
+#define NODE_COUNT              (GRID_ROWS * GRID_COLS)
+#define NODE_SPACING_DM         (80)
+#define RADIO_RANGE_DM          (250)
+#define RSSI_AT_ZERO_DBM        (-40)
+#define RSSI_LOSS_PER_M         (2)
+#define PACKET_AIRTIME_US       (376)
+#define ADV_DELAY_MAX_US        (10000)
+#define MESSAGE_INTERVAL_US     (1000000)
+#define MESSAGE_TTL             (16)
+#define MESSAGE_COUNT           (500)
+#define TX_QUEUE_SIZE           (NODE_COUNT * 2)
+/** Fraction of the nodes flooding must reach, in percent, for the simulation to be sane. */
+#define FLOOD_DELIVERY_MIN      (90)
+
+typedef struct
+{
+    bool in_range;
+    int8_t rssi;
+} link_t;
+
+typedef struct
+{
+    relay_policy_t policy;
+    bool seen;
+    uint8_t index;
+} node_t;
+
+typedef struct
+{
+    timestamp_t start;
+    uint8_t node;
+    uint8_t ttl;
+} tx_t;
+
+typedef struct
+{
+    const char * p_name;
+    relay_policy_config_t config;
+    uint64_t delivered;
+    uint64_t transmissions;
+    uint64_t collisions;
+} scenario_t;
+
+static node_t m_nodes[NODE_COUNT];
+static link_t m_links[NODE_COUNT][NODE_COUNT];
+static timestamp_t m_now;
+
+/* Transmissions of the current message, in the order they were ordered. As each node transmits a
+ * message at most once, the log never wraps. */
+static tx_t m_tx_log[TX_QUEUE_SIZE];
+static uint32_t m_tx_count;
+static uint32_t m_tx_done;
+static uint32_t m_sequence_number;
+static scenario_t * mp_scenario;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    printf("Assertion at PC = %.08x\n", pc);
+    exit(EXIT_FAILURE);
+}
+
+/* The simulation runs on its own clock, and fires the policy timers itself. */
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    p_timer_evt->state = TIMER_EVENT_STATE_ADDED;
+}
+
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    while ((root + 1) * (root + 1) <= value)
+    {
+        root++;
+    }
+    return root;
+}
+
+static void links_build(void)
+{
+    for (uint32_t a = 0; a < NODE_COUNT; ++a)
+    {
+        for (uint32_t b = 0; b < NODE_COUNT; ++b)
+        {
+            int32_t dx = (int32_t) (a % GRID_COLS) - (int32_t) (b % GRID_COLS);
+            int32_t dy = (int32_t) (a / GRID_COLS) - (int32_t) (b / GRID_COLS);
+            uint32_t distance_dm = isqrt((dx * dx + dy * dy) * NODE_SPACING_DM * NODE_SPACING_DM);
+            m_links[a][b].in_range = (a != b && distance_dm <= RADIO_RANGE_DM);
+            m_links[a][b].rssi = RSSI_AT_ZERO_DBM - (int32_t) (distance_dm * RSSI_LOSS_PER_M) / 10;
+        }
+    }
+}
+
+static void rx_metadata_build(nrf_mesh_rx_metadata_t * p_rx_metadata, uint32_t from, uint32_t to)
+{
+    memset(p_rx_metadata, 0, sizeof(nrf_mesh_rx_metadata_t));
+    p_rx_metadata->source = NRF_MESH_RX_SOURCE_SCANNER;
+    p_rx_metadata->params.scanner.rssi = m_links[from][to].rssi;
+    p_rx_metadata->params.scanner.adv_addr.addr[0] = from;
+}
+
+static void tx_order(uint32_t node, uint8_t ttl)
+{
+    if (m_tx_count == TX_QUEUE_SIZE)
+    {
+        printf("Transmission log overflow\n");
+        exit(EXIT_FAILURE);
+    }
+    m_tx_log[m_tx_count].start = m_now + (benchmark_random() % ADV_DELAY_MAX_US);
+    m_tx_log[m_tx_count].node = node;
+    m_tx_log[m_tx_count].ttl = ttl;
+    m_tx_count++;
+}
+
+static void relay_cb(relay_policy_t * p_policy,
+                     network_packet_metadata_t * p_net_metadata,
+                     const packet_mesh_net_packet_t * p_net_packet,
+                     uint8_t payload_len)
+{
+    node_t * p_node = PARENT_BY_FIELD_GET(node_t, policy, p_policy);
+    tx_order(p_node->index, p_net_metadata->ttl - 1);
+}
+
+/** Whether the transmission is lost at the receiver to another one overlapping it in time. */
+static bool collided(const tx_t * p_tx, uint32_t receiver)
+{
+    for (uint32_t i = 0; i < m_tx_count; ++i)
+    {
+        const tx_t * p_other = &m_tx_log[i];
+        if (p_other != p_tx &&
+            (p_other->node == receiver || m_links[p_other->node][receiver].in_range) &&
+            p_other->start < p_tx->start + PACKET_AIRTIME_US &&
+            p_tx->start < p_other->start + PACKET_AIRTIME_US)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void transmit(const tx_t * p_tx)
+{
+    mp_scenario->transmissions++;
+
+    network_packet_metadata_t metadata;
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.src = 0x0001;
+    metadata.ttl = p_tx->ttl;
+    metadata.internal.sequence_number = m_sequence_number;
+    packet_mesh_net_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        if (!m_links[p_tx->node][i].in_range)
+        {
+            continue;
+        }
+        if (collided(p_tx, i))
+        {
+            mp_scenario->collisions++;
+            continue;
+        }
+
+        node_t * p_node = &m_nodes[i];
+        nrf_mesh_rx_metadata_t rx_metadata;
+        rx_metadata_build(&rx_metadata, p_tx->node, i);
+        relay_policy_neighbour_heard(&p_node->policy, &rx_metadata);
+        if (p_node->seen)
+        {
+            relay_policy_duplicate_in(&p_node->policy, metadata.src, metadata.internal.sequence_number);
+        }
+        else
+        {
+            p_node->seen = true;
+            mp_scenario->delivered++;
+            if (metadata.ttl >= 2 &&
+                relay_policy_packet_in(&p_node->policy, &metadata, &packet, 16, &rx_metadata))
+            {
+                tx_order(i, metadata.ttl - 1);
+            }
+        }
+    }
+}
+
+/** Runs the event that comes first of the ordered transmissions and the policy timers. */
+static bool event_process(void)
+{
+    const tx_t * p_next_tx = NULL;
+    for (uint32_t i = m_tx_done; i < m_tx_count; ++i)
+    {
+        if (p_next_tx == NULL || TIMER_OLDER_THAN(m_tx_log[i].start, p_next_tx->start))
+        {
+            p_next_tx = &m_tx_log[i];
+        }
+    }
+    timer_event_t * p_next_timer = NULL;
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        timer_event_t * p_timer = &m_nodes[i].policy.timer;
+        if (p_timer->state == TIMER_EVENT_STATE_ADDED &&
+            (p_next_timer == NULL || TIMER_OLDER_THAN(p_timer->timestamp, p_next_timer->timestamp)))
+        {
+            p_next_timer = p_timer;
+        }
+    }
+
+    if (p_next_timer != NULL && (p_next_tx == NULL || TIMER_OLDER_THAN(p_next_timer->timestamp, p_next_tx->start)))
+    {
+        m_now = p_next_timer->timestamp;
+        p_next_timer->state = TIMER_EVENT_STATE_IN_CALLBACK;
+        p_next_timer->cb(m_now, p_next_timer->p_context);
+        if (p_next_timer->state == TIMER_EVENT_STATE_IN_CALLBACK)
+        {
+            p_next_timer->state = TIMER_EVENT_STATE_UNUSED;
+        }
+        return true;
+    }
+    else if (p_next_tx != NULL)
+    {
+        /* Keep the transmissions that are done in the log for the collision checks, but move the
+         * next one to the front of the pending part. */
+        tx_t next = *p_next_tx;
+        *(tx_t *) p_next_tx = m_tx_log[m_tx_done];
+        m_tx_log[m_tx_done] = next;
+        m_now = next.start;
+        transmit(&m_tx_log[m_tx_done++]);
+        return true;
+    }
+    return false;
+}
+
+/** Lets every node hear every neighbour once, like it would through the periodic beacons. */
+static void beacons_hear(void)
+{
+    for (uint32_t a = 0; a < NODE_COUNT; ++a)
+    {
+        for (uint32_t b = 0; b < NODE_COUNT; ++b)
+        {
+            if (m_links[b][a].in_range)
+            {
+                nrf_mesh_rx_metadata_t rx_metadata;
+                rx_metadata_build(&rx_metadata, b, a);
+                relay_policy_neighbour_heard(&m_nodes[a].policy, &rx_metadata);
+            }
+        }
+    }
+}
+
+static void bm_message(uint32_t iteration, void * p_context)
+{
+    beacons_hear();
+
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        m_nodes[i].seen = false;
+    }
+    m_tx_count = 0;
+    m_tx_done = 0;
+    m_sequence_number++;
+
+    uint32_t source = benchmark_random() % NODE_COUNT;
+    m_nodes[source].seen = true;
+    tx_order(source, MESSAGE_TTL);
+    while (event_process())
+    {
+    }
+
+    m_now += MESSAGE_INTERVAL_US;
+}
+
+static void scenario_run(scenario_t * p_scenario)
+{
+    mp_scenario = p_scenario;
+    m_now = 0;
+    m_sequence_number = 0;
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        relay_policy_init(&m_nodes[i].policy, relay_cb);
+        m_nodes[i].index = i;
+        if (relay_policy_config_set(&m_nodes[i].policy, &p_scenario->config) != NRF_SUCCESS)
+        {
+            printf("Invalid configuration for %s\n", p_scenario->p_name);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    benchmark_run(p_scenario->p_name, MESSAGE_COUNT, bm_message, NULL);
+
+    uint64_t reachable = (uint64_t) MESSAGE_COUNT * (NODE_COUNT - 1);
+    printf("    delivery: %5.1f %%, transmissions/message: %6.1f, airtime/message: %6.2f ms, collisions/message: %6.1f\n",
+           100.0 * p_scenario->delivered / reachable,
+           (double) p_scenario->transmissions / MESSAGE_COUNT,
+           (double) p_scenario->transmissions * PACKET_AIRTIME_US / MESSAGE_COUNT / 1000,
+           (double) p_scenario->collisions / MESSAGE_COUNT);
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_NETWORK, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    links_build();
+
+    static scenario_t scenarios[] = {
+        {"flooding", RELAY_POLICY_CONFIG_DEFAULT},
+        {"counter (k = 2)", RELAY_POLICY_CONFIG_DEFAULT},
+        {"counter (k = 3)", RELAY_POLICY_CONFIG_DEFAULT},
+        {"RSSI (-70 dBm)", RELAY_POLICY_CONFIG_DEFAULT},
+        {"density (target 4)", RELAY_POLICY_CONFIG_DEFAULT},
+    };
+    scenarios[1].config.type = RELAY_POLICY_TYPE_COUNTER;
+    scenarios[1].config.counter_threshold = 2;
+    scenarios[2].config.type = RELAY_POLICY_TYPE_COUNTER;
+    scenarios[2].config.counter_threshold = 3;
+    scenarios[3].config.type = RELAY_POLICY_TYPE_RSSI;
+    scenarios[3].config.rssi_threshold = -70;
+    scenarios[4].config.type = RELAY_POLICY_TYPE_DENSITY;
+    scenarios[4].config.density_target = 4;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(scenarios); ++i)
+    {
+        scenario_run(&scenarios[i]);
+    }
+
+    if (scenarios[0].delivered * 100 < (uint64_t) MESSAGE_COUNT * (NODE_COUNT - 1) * FLOOD_DELIVERY_MIN)
+    {
+        printf("Flooding doesn't reach enough nodes for the comparison to be meaningful\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
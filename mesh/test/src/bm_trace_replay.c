@@ -0,0 +1,365 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "benchmark.h"
+#include "host_stack.h"
+
+#include "packet_trace.h"
+#include "instr.h"
+#include "event.h"
+#include "nrf_mesh_config_bearer.h"
+#include "log.h"
+#include "utils.h"
+
+/* Replay of a packet trace through the network, transport and access layers of the stack, with
+ * simulated time. Traces recorded on a device with the packet trace module are replayed with:
+ *
+ *     bm_trace_replay TRACE_FILE [NETKEY [APPKEY [IV_INDEX]]]
+ *
+ * where the keys are given as 32 hex digits. Without the keys of the recorded network, only the
+ * network layer drop path is exercised. Without arguments, the benchmark records a trace of a
+ * sender node in a child process, replays it in a receiver node, and fails unless all messages
+ * arrive. In both cases, the replay throughput and the time spent in each stage is printed. */
+
+#define SENDER_ADDRESS          (0x0001)
+#define RECEIVER_ADDRESS        (0x7FFE)
+#define GROUP_ADDRESS           (0xC001)
+#define MESSAGE_TTL             (3)
+#define MESSAGE_COUNT           (500)
+#define MESSAGE_INTERVAL_US     (500000)
+#define SEGMENTED_MESSAGE_LEN   (30)
+#define UNSEGMENTED_MESSAGE_LEN (4)
+#define SENDER_RSSI             (-60)
+/** Time to let the receiver finish processing after the last packet of the trace. */
+#define REPLAY_TAIL_US          (10000000)
+
+static uint8_t m_netkey[NRF_MESH_KEY_SIZE] = {0x7d, 0xd7, 0x36, 0x4c, 0xd8, 0x42, 0xad, 0x18,
+                                              0xc1, 0x7c, 0x2b, 0x82, 0x0c, 0x84, 0xc3, 0xd6};
+static uint8_t m_appkey[NRF_MESH_KEY_SIZE] = {0x63, 0x96, 0x47, 0x71, 0x73, 0x4f, 0xbd, 0x76,
+                                              0xe3, 0xb4, 0x05, 0x19, 0xd1, 0xd9, 0x4a, 0x48};
+static uint32_t m_iv_index = 0x12345678;
+
+static FILE * mp_trace_file;
+static uint32_t m_rx_count;
+
+static const char * mp_stage_names[INSTR_STAGE_COUNT] =
+{
+    "scanner rx", "network in", "net decrypt", "transport", "access", "core tx", "adv tx"
+};
+
+static bool hex_parse(const char * p_hex, uint8_t * p_out, uint32_t length)
+{
+    if (strlen(p_hex) != length * 2)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        unsigned int byte;
+        if (sscanf(&p_hex[i * 2], "%2x", &byte) != 1)
+        {
+            return false;
+        }
+        p_out[i] = byte;
+    }
+    return true;
+}
+
+/*****************************************************************************
+* Sender
+*****************************************************************************/
+static void trace_drain(void)
+{
+    uint8_t buffer[PACKET_TRACE_BUFFER_SIZE];
+    uint32_t length = packet_trace_read(buffer, sizeof(buffer));
+    if (fwrite(buffer, 1, length, mp_trace_file) != length)
+    {
+        printf("Failed writing the trace\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Records the packets sent by the sender as if a receiver in range had picked them up. */
+static void sender_tx_cb(core_tx_role_t role, const uint8_t * p_net_packet, uint32_t length)
+{
+    scanner_packet_t packet;
+    host_stack_scanner_packet_build(&packet, p_net_packet, length, host_stack_time_get(), SENDER_RSSI);
+    packet_trace_scanner_rx(&packet);
+    trace_drain();
+}
+
+static void sender_run(void)
+{
+    host_stack_init_params_t params =
+    {
+        .unicast_address = SENDER_ADDRESS,
+        .p_netkey = m_netkey,
+        .p_appkey = m_appkey,
+        .iv_index = m_iv_index,
+        .publish_address = GROUP_ADDRESS,
+        .ttl = MESSAGE_TTL,
+        .tx_cb = sender_tx_cb,
+    };
+    host_stack_init(&params);
+    packet_trace_start();
+
+    uint8_t data[SEGMENTED_MESSAGE_LEN];
+    for (uint32_t i = 0; i < MESSAGE_COUNT; ++i)
+    {
+        for (uint32_t j = 0; j < sizeof(data); ++j)
+        {
+            data[j] = benchmark_random();
+        }
+        /* Every fourth message is segmented. Segmented messages to a group address are sent
+         * repeatedly for a couple of seconds, so sending more would run out of SAR sessions. */
+        uint16_t length = ((i % 4) == 3) ? SEGMENTED_MESSAGE_LEN : UNSEGMENTED_MESSAGE_LEN;
+        if (host_stack_publish(data, length, false) != NRF_SUCCESS)
+        {
+            printf("Failed publishing message %u\n", i);
+            exit(EXIT_FAILURE);
+        }
+        host_stack_time_advance(host_stack_time_get() + MESSAGE_INTERVAL_US);
+    }
+    host_stack_time_advance(host_stack_time_get() + REPLAY_TAIL_US);
+
+    packet_trace_stop();
+    trace_drain();
+}
+
+/*****************************************************************************
+* Receiver
+*****************************************************************************/
+static void receiver_rx_cb(const access_message_rx_t * p_message)
+{
+    m_rx_count++;
+}
+
+static void histograms_print(void)
+{
+    printf("%-12s %10s %12s %12s\n", "stage", "count", "mean (ns)", "max (ns)");
+    for (uint32_t i = 0; i < INSTR_STAGE_COUNT; ++i)
+    {
+        const instr_histogram_t * p_histogram = instr_histogram_get((instr_stage_t) i);
+        if (p_histogram->count > 0)
+        {
+            printf("%-12s %10u %12llu %12u\n",
+                   mp_stage_names[i],
+                   p_histogram->count,
+                   (unsigned long long) (p_histogram->total / p_histogram->count),
+                   p_histogram->max);
+        }
+    }
+
+    event_stats_t stats;
+    NRF_MESH_ERROR_CHECK(event_stats_get(NRF_MESH_EVT_MESSAGE_RECEIVED, &stats));
+    printf("message received events: %u dispatched to %u handlers in %llu ns\n",
+           stats.dispatch_count, stats.handler_count, (unsigned long long) stats.cycles);
+}
+
+/* Replays the trace in the given buffer, and returns the number of replayed packets. */
+static uint32_t replay(const uint8_t * p_trace, uint32_t length)
+{
+    packet_trace_header_t header;
+    if (length < sizeof(header))
+    {
+        printf("Trace too short\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&header, p_trace, sizeof(header));
+    if (header.magic != PACKET_TRACE_MAGIC || header.version != PACKET_TRACE_VERSION)
+    {
+        printf("Not a packet trace, or unsupported version\n");
+        exit(EXIT_FAILURE);
+    }
+
+    host_stack_init_params_t params =
+    {
+        .unicast_address = RECEIVER_ADDRESS,
+        .p_netkey = m_netkey,
+        .p_appkey = m_appkey,
+        .iv_index = m_iv_index,
+        .publish_address = GROUP_ADDRESS,
+        .subscription_address = GROUP_ADDRESS,
+        .ttl = MESSAGE_TTL,
+        .rx_cb = receiver_rx_cb,
+    };
+    host_stack_init(&params);
+    instr_clear();
+    event_stats_clear();
+
+    uint32_t packet_count = 0;
+    uint32_t offset = sizeof(header);
+    uint32_t first_timestamp = 0;
+    uint64_t start = benchmark_time_ns();
+    while (offset + sizeof(packet_trace_record_t) <= length)
+    {
+        packet_trace_record_t record;
+        memcpy(&record, &p_trace[offset], sizeof(record));
+        offset += sizeof(record);
+        if (offset + record.length > length || record.length < BLE_ADV_PACKET_OVERHEAD)
+        {
+            printf("Truncated or malformed record at offset %u\n", offset);
+            break;
+        }
+
+        scanner_packet_t packet;
+        memset(&packet, 0, sizeof(packet));
+        packet.metadata.timestamp = record.timestamp;
+        packet.metadata.access_addr = BEARER_ACCESS_ADDR_DEFAULT;
+        packet.metadata.channel = record.channel;
+        packet.metadata.rssi = record.rssi;
+        packet.metadata.adv_type = record.pdu_type & 0x0F;
+        packet.packet.header.type = record.pdu_type & 0x0F;
+        packet.packet.header.addr_type = (record.pdu_type >> 6) & 0x01;
+        packet.packet.header.length = record.length;
+        memcpy(packet.packet.addr, &p_trace[offset], record.length);
+        memcpy(packet.metadata.adv_addr.addr, packet.packet.addr, BLE_GAP_ADDR_LEN);
+        offset += record.length;
+
+        /* The trace timestamps are relative to the recording device's clock. */
+        if (packet_count == 0)
+        {
+            first_timestamp = record.timestamp;
+        }
+        host_stack_time_advance(record.timestamp - first_timestamp);
+        host_stack_scanner_rx(&packet);
+        packet_count++;
+    }
+    host_stack_time_advance(host_stack_time_get() + REPLAY_TAIL_US);
+    uint64_t elapsed = benchmark_time_ns() - start;
+
+    benchmark_report("trace replay (packets)", packet_count, elapsed);
+    printf("replayed %u packets over %u ms of simulated time, %u messages received\n",
+           packet_count, host_stack_time_get() / 1000, m_rx_count);
+    histograms_print();
+    return packet_count;
+}
+
+static uint8_t * trace_load(FILE * p_file, uint32_t * p_length)
+{
+    if (fseek(p_file, 0, SEEK_END) != 0)
+    {
+        return NULL;
+    }
+    long length = ftell(p_file);
+    rewind(p_file);
+
+    uint8_t * p_trace = malloc(length);
+    if (p_trace == NULL || fread(p_trace, 1, length, p_file) != (size_t) length)
+    {
+        free(p_trace);
+        return NULL;
+    }
+    *p_length = length;
+    return p_trace;
+}
+
+int main(int argc, char ** argv)
+{
+    __LOG_INIT(LOG_SRC_NETWORK | LOG_SRC_TRANSPORT | LOG_SRC_ACCESS, LOG_LEVEL_ERROR, LOG_CALLBACK_DEFAULT);
+
+    bool self_test = (argc < 2);
+    if (self_test)
+    {
+        mp_trace_file = tmpfile();
+        if (mp_trace_file == NULL)
+        {
+            printf("Failed creating the trace file\n");
+            return EXIT_FAILURE;
+        }
+
+        /* The stack has a single instance, so the sender runs in its own process. */
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            sender_run();
+            fflush(mp_trace_file);
+            _exit(EXIT_SUCCESS);
+        }
+
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            printf("Recording the trace failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        mp_trace_file = fopen(argv[1], "rb");
+        if (mp_trace_file == NULL)
+        {
+            printf("Failed opening %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        if ((argc > 2 && !hex_parse(argv[2], m_netkey, sizeof(m_netkey))) ||
+            (argc > 3 && !hex_parse(argv[3], m_appkey, sizeof(m_appkey))))
+        {
+            printf("Keys must be given as %u hex digits\n", NRF_MESH_KEY_SIZE * 2);
+            return EXIT_FAILURE;
+        }
+        if (argc > 4)
+        {
+            m_iv_index = strtoul(argv[4], NULL, 0);
+        }
+    }
+
+    uint32_t length;
+    uint8_t * p_trace = trace_load(mp_trace_file, &length);
+    fclose(mp_trace_file);
+    if (p_trace == NULL)
+    {
+        printf("Failed reading the trace\n");
+        return EXIT_FAILURE;
+    }
+
+    uint32_t packet_count = replay(p_trace, length);
+    free(p_trace);
+
+    if (self_test && (packet_count == 0 || m_rx_count != MESSAGE_COUNT))
+    {
+        printf("Expected %u messages\n", MESSAGE_COUNT);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
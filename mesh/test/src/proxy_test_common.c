@@ -73,6 +73,16 @@ static struct
     bool allocated;
     bool available;
 } m_gatt_tx_packet;
+static struct
+{
+    bool hold;
+    uint32_t count;
+    uint16_t conn_index[CORE_TX_SHARED_PDU_COUNT];
+    uint8_t * p_data[CORE_TX_SHARED_PDU_COUNT];
+    mesh_gatt_packet_ref_release_cb_t release_cb[CORE_TX_SHARED_PDU_COUNT];
+} m_gatt_tx_refs;
+static bool m_core_tx_shared;
+static uint32_t m_pdu_release_count;
 static const core_tx_bearer_interface_t * mp_core_tx_if;
 static core_tx_bearer_t * mp_core_tx_bearer;
 static const nrf_mesh_evt_handler_t * mp_mesh_evt_handler;
@@ -168,6 +178,43 @@ uint32_t mesh_gatt_packet_send(uint16_t conn_index, const uint8_t * p_packet)
     return NRF_SUCCESS;
 }
 
+uint8_t * mesh_gatt_packet_ref_alloc(uint16_t conn_index,
+                                     mesh_gatt_pdu_type_t type,
+                                     nrf_mesh_tx_token_t token)
+{
+    return mesh_gatt_packet_alloc(conn_index, type, 0, token);
+}
+
+uint32_t mesh_gatt_packet_ref_send(uint16_t conn_index,
+                                   const uint8_t * p_packet,
+                                   uint8_t * p_data,
+                                   uint16_t length,
+                                   mesh_gatt_packet_ref_release_cb_t release_cb)
+{
+    TEST_ASSERT_NOT_NULL(p_data);
+    TEST_ASSERT_NOT_NULL(release_cb);
+    TEST_ASSERT_EQUAL(0, m_gatt_tx_packet.size);
+    uint32_t status = mesh_gatt_packet_send(conn_index, p_packet);
+
+    /* Pretend the referenced payload was transmitted right away. */
+    TEST_ASSERT_TRUE(length < sizeof(m_gatt_tx_packet.buffer));
+    memcpy(m_gatt_tx_packet.buffer, p_data, length);
+    m_gatt_tx_packet.size = length;
+    if (m_gatt_tx_refs.hold)
+    {
+        TEST_ASSERT_TRUE(m_gatt_tx_refs.count < CORE_TX_SHARED_PDU_COUNT);
+        m_gatt_tx_refs.conn_index[m_gatt_tx_refs.count] = conn_index;
+        m_gatt_tx_refs.p_data[m_gatt_tx_refs.count]     = p_data;
+        m_gatt_tx_refs.release_cb[m_gatt_tx_refs.count] = release_cb;
+        m_gatt_tx_refs.count++;
+    }
+    else
+    {
+        release_cb(conn_index, p_data);
+    }
+    return status;
+}
+
 void mesh_gatt_packet_discard(uint16_t conn_index, const uint8_t * p_packet)
 {
     TEST_ASSERT_EQUAL_PTR(m_gatt_tx_packet.buffer, p_packet);
@@ -222,6 +269,19 @@ void core_tx_complete(core_tx_bearer_t * p_bearer,
 
 }
 
+bool core_tx_packet_is_shared(void)
+{
+    return m_core_tx_shared;
+}
+
+void core_tx_pdu_release(core_tx_pdu_t * p_pdu)
+{
+    TEST_ASSERT_NOT_NULL(p_pdu);
+    TEST_ASSERT_TRUE(p_pdu->refcount > 0);
+    p_pdu->refcount--;
+    m_pdu_release_count++;
+}
+
 void nrf_mesh_evt_handler_add(nrf_mesh_evt_handler_t * p_handler_params)
 {
     mp_mesh_evt_handler = p_handler_params;
@@ -239,6 +299,9 @@ void init(void)
 {
     m_gatt_tx_packet.available = true;
     m_gatt_tx_packet.count     = 0;
+    m_pdu_release_count        = 0;
+    m_core_tx_shared           = true;
+    memset(&m_gatt_tx_refs, 0, sizeof(m_gatt_tx_refs));
     mp_beacon_info             = NULL;
     mp_net_secmat              = NULL;
     proxy_init();
@@ -313,6 +376,32 @@ uint32_t gatt_tx_packet_alloc_count(void)
     return m_gatt_tx_packet.count;
 }
 
+void gatt_tx_refs_hold_set(bool hold)
+{
+    m_gatt_tx_refs.hold = hold;
+}
+
+uint32_t gatt_tx_refs_release(void)
+{
+    uint32_t count = m_gatt_tx_refs.count;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        m_gatt_tx_refs.release_cb[i](m_gatt_tx_refs.conn_index[i], m_gatt_tx_refs.p_data[i]);
+    }
+    m_gatt_tx_refs.count = 0;
+    return count;
+}
+
+void core_tx_packet_shared_set(bool shared)
+{
+    m_core_tx_shared = shared;
+}
+
+uint32_t core_tx_pdu_release_count(void)
+{
+    return m_pdu_release_count;
+}
+
 const core_tx_bearer_interface_t * core_tx_if_get(void)
 {
     return mp_core_tx_if;
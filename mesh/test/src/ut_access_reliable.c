@@ -48,6 +48,8 @@
 #include "bearer_event_mock.h"
 #include "timer_scheduler_mock.h"
 #include "timer_mock.h"
+#include "device_state_manager_mock.h"
+#include "nrf_mesh_utils_mock.h"
 
 /* ******************* Various definitions ******************* */
 
@@ -56,6 +58,11 @@
 #define TEST_HANDLE (1)
 #define REPEATS (8)
 #define TIME_SPACING MS_TO_US(2)
+#define TEST_DST_BASE (0x0100)
+#define TEST_GROUP_ADDR (0xC001)
+#define TEST_GROUP_HANDLE (7)
+#define TEST_UNASSIGNED_HANDLE (8)
+#define TEST_INVALID_HANDLE (9)
 /* ******************* Type definitions ******************* */
 
 typedef enum
@@ -90,6 +97,13 @@ static struct
     uint32_t num_calls;
 } m_status_cb;
 
+static struct
+{
+    expected_cb_data_t expected_data[ACCESS_RELIABLE_TRANSFER_COUNT];
+    uint16_t expected_dst[ACCESS_RELIABLE_TRANSFER_COUNT];
+    uint32_t num_calls;
+} m_transaction_cb;
+
 access_reliable_t m_reliables[ACCESS_RELIABLE_TRANSFER_COUNT];
 
 /* ******************* Callback functions ******************* */
@@ -132,6 +146,46 @@ void status_cb(access_model_handle_t handle, void * p_args, access_reliable_stat
     TEST_ASSERT_EQUAL(m_status_cb.expected_data[m_status_cb.num_calls].status, status);
 }
 
+void transaction_cb(access_model_handle_t handle, void * p_args, uint16_t dst, access_reliable_status_t status)
+{
+    TEST_ASSERT_MESSAGE(m_transaction_cb.num_calls > 0, "Transaction callback called more times than expected");
+    m_transaction_cb.num_calls--;
+    TEST_ASSERT_EQUAL(m_transaction_cb.expected_data[m_transaction_cb.num_calls].handle, handle);
+    TEST_ASSERT_EQUAL(m_transaction_cb.expected_data[m_transaction_cb.num_calls].p_args, p_args);
+    TEST_ASSERT_EQUAL(m_transaction_cb.expected_dst[m_transaction_cb.num_calls], dst);
+    TEST_ASSERT_EQUAL(m_transaction_cb.expected_data[m_transaction_cb.num_calls].status, status);
+}
+
+/* Address handle N is unicast address TEST_DST_BASE + N, except for a few special handles. */
+static uint32_t dsm_address_get_cb(dsm_handle_t address_handle, nrf_mesh_address_t * p_address, int num_calls)
+{
+    if (address_handle == TEST_INVALID_HANDLE)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    else if (address_handle == TEST_UNASSIGNED_HANDLE)
+    {
+        p_address->type = NRF_MESH_ADDRESS_TYPE_INVALID;
+        p_address->value = NRF_MESH_ADDR_UNASSIGNED;
+    }
+    else if (address_handle == TEST_GROUP_HANDLE)
+    {
+        p_address->type = NRF_MESH_ADDRESS_TYPE_GROUP;
+        p_address->value = TEST_GROUP_ADDR;
+    }
+    else
+    {
+        p_address->type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+        p_address->value = TEST_DST_BASE + address_handle;
+    }
+    return NRF_SUCCESS;
+}
+
+static nrf_mesh_address_type_t address_type_get_cb(uint16_t address, int num_calls)
+{
+    return (address >= 0xC000) ? NRF_MESH_ADDRESS_TYPE_GROUP : NRF_MESH_ADDRESS_TYPE_UNICAST;
+}
+
 /* ******************* Utility functions ******************* */
 
 void fire_timeout(timestamp_t timestamp, void * p_args)
@@ -163,6 +217,15 @@ void status_cb_Expect(access_model_handle_t handle, void * p_args, access_reliab
     m_status_cb.num_calls++;
 }
 
+void transaction_cb_Expect(access_model_handle_t handle, void * p_args, uint16_t dst, access_reliable_status_t status)
+{
+    m_transaction_cb.expected_data[m_transaction_cb.num_calls].handle = handle;
+    m_transaction_cb.expected_data[m_transaction_cb.num_calls].p_args = p_args;
+    m_transaction_cb.expected_data[m_transaction_cb.num_calls].status = status;
+    m_transaction_cb.expected_dst[m_transaction_cb.num_calls] = dst;
+    m_transaction_cb.num_calls++;
+}
+
 void timer_reschedule_ExpectAndReturn(timer_state_t state, timestamp_t timeout)
 {
     m_timer.sch_calls++;
@@ -216,11 +279,62 @@ static void initialize_contexts(void)
     }
 }
 
+static void transaction_init(access_reliable_transaction_t * p_transaction, dsm_handle_t address_handle)
+{
+    static const uint8_t data[] = "Hi";
+    memset(p_transaction, 0, sizeof(*p_transaction));
+    p_transaction->model_handle = TEST_HANDLE;
+    p_transaction->address_handle = address_handle;
+    p_transaction->message.length = sizeof(data);
+    p_transaction->message.p_buffer = &data[0];
+    p_transaction->message.opcode.opcode = 0x01;
+    p_transaction->message.opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    p_transaction->reply_opcode.opcode = 0x02;
+    p_transaction->reply_opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    p_transaction->timeout = ACCESS_RELIABLE_TIMEOUT_MIN;
+    p_transaction->status_cb = transaction_cb;
+}
+
+static void transaction_publish(const access_reliable_transaction_t * p_transaction, timestamp_t time_now, bool earliest)
+{
+    uint8_t ttl = 0;
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    timer_now_ExpectAndReturn(time_now);
+    if (earliest)
+    {
+        timer_reschedule_ExpectAndReturn(m_timer.current_state, time_now + ACCESS_RELIABLE_INTERVAL_DEFAULT);
+    }
+    access_model_publish_ttl_get_ExpectAndReturn(p_transaction->model_handle, NULL, NRF_SUCCESS);
+    access_model_publish_ttl_get_IgnoreArg_p_ttl();
+    access_model_publish_ttl_get_ReturnThruPtr_p_ttl(&ttl);
+    access_model_publish_to_ExpectAndReturn(p_transaction->model_handle,
+                                            p_transaction->address_handle,
+                                            DSM_HANDLE_INVALID,
+                                            &p_transaction->message,
+                                            NRF_SUCCESS);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_reliable_transaction_publish(p_transaction));
+}
+
+static void reply_rx(access_model_handle_t model_handle, uint16_t src, access_opcode_t opcode, void * p_args)
+{
+    access_message_rx_t rx_message = {0};
+    rx_message.opcode = opcode;
+    rx_message.meta_data.src.value = src;
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    access_reliable_message_rx_cb(model_handle, &rx_message, p_args);
+}
+
 static void verify_callbacks(void)
 {
     char error_message[512];
     sprintf(error_message, "Status callback called less times than expected %u.", m_status_cb.num_calls);
     TEST_ASSERT_MESSAGE(m_status_cb.num_calls == 0, error_message);
+    sprintf(error_message, "Transaction callback called less times than expected %u.", m_transaction_cb.num_calls);
+    TEST_ASSERT_MESSAGE(m_transaction_cb.num_calls == 0, error_message);
     sprintf(error_message, "Timer (re)schedule called less times than expected %u.", m_timer.sch_calls);
     TEST_ASSERT_MESSAGE(m_timer.sch_calls == 0, error_message);
     sprintf(error_message, "Timer abort called less times than expected %u.", m_timer.abort_calls);
@@ -234,11 +348,16 @@ void setUp(void)
     timer_mock_Init();
     timer_scheduler_mock_Init();
     bearer_event_mock_Init();
+    device_state_manager_mock_Init();
+    nrf_mesh_utils_mock_Init();
     memset(&m_timer, 0, sizeof(m_timer));
     memset(&m_status_cb, 0, sizeof(m_status_cb));
+    memset(&m_transaction_cb, 0, sizeof(m_transaction_cb));
     access_reliable_init();
     timer_sch_reschedule_StubWithCallback(timer_sch_reschedule_cb);
     timer_sch_abort_StubWithCallback(timer_sch_abort_cb);
+    dsm_address_get_StubWithCallback(dsm_address_get_cb);
+    nrf_mesh_address_type_get_StubWithCallback(address_type_get_cb);
 }
 
 void tearDown(void)
@@ -254,6 +373,10 @@ void tearDown(void)
     timer_scheduler_mock_Destroy();
     bearer_event_mock_Verify();
     bearer_event_mock_Destroy();
+    device_state_manager_mock_Verify();
+    device_state_manager_mock_Destroy();
+    nrf_mesh_utils_mock_Verify();
+    nrf_mesh_utils_mock_Destroy();
 }
 
 /* ******************* Test functions ******************* */
@@ -747,4 +870,236 @@ void test_access_reliable_model_is_free(void)
     {
         TEST_ASSERT_EQUAL(true, access_reliable_model_is_free(m_reliables[i].model_handle));
     }
-}
\ No newline at end of file
+}
+void test_transaction_error_conditions(void)
+{
+    access_reliable_transaction_t transaction;
+    transaction_init(&transaction, 0);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, access_model_reliable_transaction_publish(NULL));
+    transaction.status_cb = NULL;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, access_model_reliable_transaction_publish(&transaction));
+    transaction.status_cb = transaction_cb;
+
+    transaction.address_handle = TEST_INVALID_HANDLE;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, access_model_reliable_transaction_publish(&transaction));
+    transaction.address_handle = TEST_UNASSIGNED_HANDLE;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_ADDR, access_model_reliable_transaction_publish(&transaction));
+    transaction.address_handle = 0;
+
+    transaction.model_handle = ACCESS_MODEL_COUNT;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, access_model_reliable_transaction_publish(&transaction));
+    transaction.model_handle = TEST_HANDLE;
+
+    transaction.timeout = ACCESS_RELIABLE_TIMEOUT_MAX + 1;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, access_model_reliable_transaction_publish(&transaction));
+    transaction.timeout = ACCESS_RELIABLE_TIMEOUT_MIN;
+
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    access_model_publish_to_ExpectAndReturn(transaction.model_handle, transaction.address_handle, DSM_HANDLE_INVALID, &transaction.message, SOME_ERROR_CODE);
+    TEST_ASSERT_EQUAL(SOME_ERROR_CODE, access_model_reliable_transaction_publish(&transaction));
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, access_model_reliable_transaction_cancel(ACCESS_MODEL_COUNT, TEST_DST_BASE, transaction.reply_opcode));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, access_model_reliable_transaction_cancel(TEST_HANDLE, NRF_MESH_ADDR_UNASSIGNED, transaction.reply_opcode));
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, access_model_reliable_transaction_cancel(TEST_HANDLE, TEST_DST_BASE, transaction.reply_opcode));
+    TEST_ASSERT_TRUE(access_reliable_model_is_free(TEST_HANDLE));
+}
+
+void test_transactions_per_destination(void)
+{
+    access_reliable_transaction_t transactions[3];
+    for (uint32_t i = 0; i < ARRAY_SIZE(transactions); ++i)
+    {
+        transaction_init(&transactions[i], i);
+        transaction_publish(&transactions[i], i * TIME_SPACING, i == 0);
+    }
+    TEST_ASSERT_FALSE(access_reliable_model_is_free(TEST_HANDLE));
+
+    /* The same destination and reply opcode can only have one transaction at a time. */
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, access_model_reliable_transaction_publish(&transactions[1]));
+
+    /* A different reply opcode is a different transaction. */
+    access_reliable_transaction_t other_opcode = transactions[1];
+    other_opcode.reply_opcode.opcode = 0x03;
+    transaction_publish(&other_opcode, 3 * TIME_SPACING, false);
+
+    /* Replies from unknown sources or with the wrong opcode are ignored. */
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 5, transactions[1].reply_opcode, TEST_ARGS_PTR);
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 1, transactions[1].message.opcode, TEST_ARGS_PTR);
+    reply_rx(TEST_HANDLE + 1, TEST_DST_BASE + 1, transactions[1].reply_opcode, TEST_ARGS_PTR);
+
+    /* The reply completes the transaction to its source only. */
+    transaction_cb_Expect(TEST_HANDLE, TEST_ARGS_PTR, TEST_DST_BASE + 1, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 1, transactions[1].reply_opcode, TEST_ARGS_PTR);
+    verify_callbacks();
+    TEST_ASSERT_FALSE(access_reliable_model_is_free(TEST_HANDLE));
+
+    /* Cancelling the earliest transaction reschedules to the next one. */
+    void * p_args = TEST_ARGS_PTR;
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, ACCESS_RELIABLE_INTERVAL_DEFAULT + 2 * TIME_SPACING);
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    access_model_p_args_get_ExpectAndReturn(TEST_HANDLE, NULL, NRF_SUCCESS);
+    access_model_p_args_get_IgnoreArg_pp_args();
+    access_model_p_args_get_ReturnThruPtr_pp_args(&p_args);
+    transaction_cb_Expect(TEST_HANDLE, p_args, TEST_DST_BASE, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_reliable_transaction_cancel(TEST_HANDLE, TEST_DST_BASE, transactions[0].reply_opcode));
+    verify_callbacks();
+
+    /* Cancelling the model cancels the rest. */
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, ACCESS_RELIABLE_INTERVAL_DEFAULT + 3 * TIME_SPACING);
+    __timer_abort_ExpectAndReturn(TIMER_STATE_RUNNING);
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    access_model_p_args_get_ExpectAndReturn(TEST_HANDLE, NULL, NRF_SUCCESS);
+    access_model_p_args_get_IgnoreArg_pp_args();
+    access_model_p_args_get_ReturnThruPtr_pp_args(&p_args);
+    access_model_p_args_get_ExpectAndReturn(TEST_HANDLE, NULL, NRF_SUCCESS);
+    access_model_p_args_get_IgnoreArg_pp_args();
+    access_model_p_args_get_ReturnThruPtr_pp_args(&p_args);
+    transaction_cb_Expect(TEST_HANDLE, p_args, TEST_DST_BASE + 1, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    transaction_cb_Expect(TEST_HANDLE, p_args, TEST_DST_BASE + 2, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_reliable_cancel(TEST_HANDLE));
+    TEST_ASSERT_TRUE(access_reliable_model_is_free(TEST_HANDLE));
+}
+
+void test_transactions_with_legacy_and_group(void)
+{
+    access_reliable_t * p_reliable = &m_reliables[0];
+    const uint8_t data[] = "Hi";
+    uint8_t ttl = 0;
+    p_reliable->model_handle = TEST_HANDLE;
+    p_reliable->message.length = sizeof(data);
+    p_reliable->message.p_buffer = &data[0];
+    p_reliable->message.opcode.opcode = 0x01;
+    p_reliable->message.opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    p_reliable->reply_opcode.opcode = 0x02;
+    p_reliable->reply_opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    p_reliable->timeout = ACCESS_RELIABLE_TIMEOUT_MIN;
+    p_reliable->status_cb = status_cb;
+
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    timer_now_ExpectAndReturn(0);
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_STOPPED, ACCESS_RELIABLE_INTERVAL_DEFAULT);
+    access_model_publish_ttl_get_ExpectAndReturn(p_reliable->model_handle, NULL, NRF_SUCCESS);
+    access_model_publish_ttl_get_IgnoreArg_p_ttl();
+    access_model_publish_ttl_get_ReturnThruPtr_p_ttl(&ttl);
+    access_model_publish_ExpectAndReturn(p_reliable->model_handle, &p_reliable->message, NRF_SUCCESS);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_reliable_publish(p_reliable));
+
+    access_reliable_transaction_t unicast;
+    access_reliable_transaction_t group;
+    transaction_init(&unicast, 3);
+    transaction_init(&group, TEST_GROUP_HANDLE);
+    group.reply_opcode.opcode = 0x04;
+    transaction_publish(&unicast, TIME_SPACING, false);
+    transaction_publish(&group, 2 * TIME_SPACING, false);
+
+    /* A reply from the transaction destination goes to the transaction, others to the legacy message. */
+    transaction_cb_Expect(TEST_HANDLE, TEST_ARGS_PTR, TEST_DST_BASE + 3, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 3, unicast.reply_opcode, TEST_ARGS_PTR);
+    status_cb_Expect(TEST_HANDLE, TEST_ARGS_PTR, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, ACCESS_RELIABLE_INTERVAL_DEFAULT + 2 * TIME_SPACING);
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 4, p_reliable->reply_opcode, TEST_ARGS_PTR);
+
+    /* Any member of the group may complete the group transaction. */
+    transaction_cb_Expect(TEST_HANDLE, TEST_ARGS_PTR, TEST_GROUP_ADDR, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+    __timer_abort_ExpectAndReturn(TIMER_STATE_RUNNING);
+    reply_rx(TEST_HANDLE, TEST_DST_BASE + 9, group.reply_opcode, TEST_ARGS_PTR);
+    TEST_ASSERT_TRUE(access_reliable_model_is_free(TEST_HANDLE));
+}
+
+void test_transaction_timeouts_in_order(void)
+{
+    access_reliable_transaction_t transactions[4];
+    /* Publish in reverse order, so that every new transaction is the earliest. */
+    for (int i = ARRAY_SIZE(transactions) - 1; i >= 0; --i)
+    {
+        transaction_init(&transactions[i], i);
+        transaction_publish(&transactions[i], i * TIME_SPACING, true);
+    }
+
+    for (uint32_t time = ACCESS_RELIABLE_INTERVAL_DEFAULT;
+         time < ACCESS_RELIABLE_TIMEOUT_MIN;
+         time *= ACCESS_RELIABLE_BACK_OFF_FACTOR)
+    {
+        for (uint32_t i = 0; i < ARRAY_SIZE(transactions); ++i)
+        {
+            if (i < ARRAY_SIZE(transactions) - 1)
+            {
+                timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, time + (i + 1) * TIME_SPACING);
+            }
+            else if (TIMER_OLDER_THAN(ACCESS_RELIABLE_TIMEOUT_MIN, time * ACCESS_RELIABLE_BACK_OFF_FACTOR))
+            {
+                timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, ACCESS_RELIABLE_TIMEOUT_MIN);
+            }
+            else
+            {
+                timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, time * ACCESS_RELIABLE_BACK_OFF_FACTOR);
+            }
+            access_model_publish_to_ExpectAndReturn(TEST_HANDLE, i, DSM_HANDLE_INVALID, &transactions[i].message, NRF_SUCCESS);
+            fire_timeout(time + i * TIME_SPACING, NULL);
+        }
+    }
+
+    void * p_args = TEST_ARGS_PTR;
+    for (uint32_t i = 0; i < ARRAY_SIZE(transactions); ++i)
+    {
+        access_model_p_args_get_ExpectAndReturn(TEST_HANDLE, NULL, NRF_SUCCESS);
+        access_model_p_args_get_IgnoreArg_pp_args();
+        access_model_p_args_get_ReturnThruPtr_pp_args(&p_args);
+        transaction_cb_Expect(TEST_HANDLE, p_args, TEST_DST_BASE + i, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+        if (i < ARRAY_SIZE(transactions) - 1)
+        {
+            timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, ACCESS_RELIABLE_TIMEOUT_MIN + (i + 1) * TIME_SPACING);
+        }
+        fire_timeout(ACCESS_RELIABLE_TIMEOUT_MIN + i * TIME_SPACING, NULL);
+        verify_callbacks();
+    }
+    TEST_ASSERT_TRUE(access_reliable_model_is_free(TEST_HANDLE));
+}
+
+void test_transaction_no_mem_back_off(void)
+{
+    access_reliable_transaction_t transaction;
+    transaction_init(&transaction, 0);
+    transaction_publish(&transaction, 0, true);
+
+    /* Every consecutive failure doubles the retry delay. */
+    uint32_t time = ACCESS_RELIABLE_INTERVAL_DEFAULT;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, time + (ACCESS_RELIABLE_RETRY_DELAY << i));
+        access_model_publish_to_ExpectAndReturn(TEST_HANDLE, 0, DSM_HANDLE_INVALID, &transaction.message, NRF_ERROR_NO_MEM);
+        fire_timeout(time, NULL);
+        time += (ACCESS_RELIABLE_RETRY_DELAY << i);
+    }
+
+    /* Success resets the back-off and continues with the regular interval. */
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, time + ACCESS_RELIABLE_INTERVAL_DEFAULT);
+    access_model_publish_to_ExpectAndReturn(TEST_HANDLE, 0, DSM_HANDLE_INVALID, &transaction.message, NRF_SUCCESS);
+    fire_timeout(time, NULL);
+    time += ACCESS_RELIABLE_INTERVAL_DEFAULT;
+
+    timer_reschedule_ExpectAndReturn(TIMER_STATE_RUNNING, time + ACCESS_RELIABLE_RETRY_DELAY);
+    access_model_publish_to_ExpectAndReturn(TEST_HANDLE, 0, DSM_HANDLE_INVALID, &transaction.message, NRF_ERROR_NO_MEM);
+    fire_timeout(time, NULL);
+
+    __timer_abort_ExpectAndReturn(TIMER_STATE_RUNNING);
+    void * p_args = TEST_ARGS_PTR;
+    bearer_event_critical_section_begin_Expect();
+    bearer_event_critical_section_end_Expect();
+    access_model_p_args_get_ExpectAndReturn(TEST_HANDLE, NULL, NRF_SUCCESS);
+    access_model_p_args_get_IgnoreArg_pp_args();
+    access_model_p_args_get_ReturnThruPtr_pp_args(&p_args);
+    transaction_cb_Expect(TEST_HANDLE, p_args, TEST_DST_BASE, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_reliable_transaction_cancel(TEST_HANDLE, TEST_DST_BASE, transaction.reply_opcode));
+}
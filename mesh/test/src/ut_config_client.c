@@ -38,6 +38,7 @@
 /*lint -e64 Lint incorrectly flags type mismatches in struct initializers. */
 
 #include "config_client.h"
+#include "config_client_bulk.h"
 #include "config_messages.h"
 
 #include <stdbool.h>
@@ -63,6 +64,8 @@
 #define VIRTUAL_UUID {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}
 #define CONFIG_ELEMENT_INDEX (0)
 #define ERROR_CODE (0xCAFEBABE)
+#define BULK_DEVKEY_HANDLE (4)
+#define BULK_ADDRESS_HANDLE (5)
 
 #define EXPECT_TX(OPCODE, DATA, LENGTH)                                 \
     do                                                                  \
@@ -136,6 +139,9 @@ static bool m_expect_timeout;
 static bool m_expect_cancelled;
 static bool m_expect_ack;
 static int m_pacman_refcount;
+static uint32_t m_bulk_tx_count;
+static uint32_t m_bulk_rx_count;
+static bool m_bulk_rx_consume;
 
 void config_client_reset(void);
 
@@ -233,6 +239,61 @@ static void event_cb(config_client_event_type_t event_type, const config_client_
 
 }
 
+static dsm_handle_t m_publish_address_handle;
+static dsm_handle_t m_publish_appkey_handle;
+
+static uint32_t publish_address_set_cb(access_model_handle_t handle, dsm_handle_t address_handle, int num_calls)
+{
+    TEST_ASSERT_EQUAL(m_handle, handle);
+    m_publish_address_handle = address_handle;
+    return NRF_SUCCESS;
+}
+
+static uint32_t publish_application_set_cb(access_model_handle_t handle, dsm_handle_t appkey_handle, int num_calls)
+{
+    TEST_ASSERT_EQUAL(m_handle, handle);
+    m_publish_appkey_handle = appkey_handle;
+    return NRF_SUCCESS;
+}
+
+static uint32_t bulk_tx_hook(config_opcode_t opcode, const uint8_t * p_data, uint16_t length, config_opcode_t reply_opcode)
+{
+    TEST_ASSERT_EQUAL(1, m_pacman_refcount);
+    TEST_ASSERT_EQUAL(m_buffer.opcode, opcode);
+    TEST_ASSERT_EQUAL(m_buffer.length, length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_buffer.buffer, p_data, length);
+    TEST_ASSERT_EQUAL(CONFIG_OPCODE_APPKEY_STATUS, reply_opcode);
+    m_bulk_tx_count++;
+    m_buffer.free = true;
+    return NRF_SUCCESS;
+}
+
+static bool bulk_rx_hook(uint16_t src, const config_client_event_t * p_event, uint16_t length)
+{
+    TEST_ASSERT_EQUAL(0x0100, src);
+    TEST_ASSERT_EQUAL(CONFIG_OPCODE_APPKEY_STATUS, p_event->opcode);
+    TEST_ASSERT_EQUAL(sizeof(config_msg_appkey_status_t), length);
+    m_bulk_rx_count++;
+    return m_bulk_rx_consume;
+}
+
+static uint32_t bulk_publish_to_cb(access_model_handle_t handle,
+                                   dsm_handle_t address_handle,
+                                   dsm_handle_t appkey_handle,
+                                   const access_message_tx_t * p_message,
+                                   int num_calls)
+{
+    TEST_ASSERT_EQUAL(m_handle, handle);
+    TEST_ASSERT_EQUAL(BULK_ADDRESS_HANDLE, address_handle);
+    TEST_ASSERT_EQUAL(BULK_DEVKEY_HANDLE, appkey_handle);
+    TEST_ASSERT_EQUAL(CONFIG_OPCODE_APPKEY_ADD, p_message->opcode.opcode);
+    TEST_ASSERT_EQUAL(ACCESS_COMPANY_ID_NONE, p_message->opcode.company_id);
+    TEST_ASSERT_EQUAL(m_buffer.length, p_message->length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_buffer.buffer, p_message->p_buffer, m_buffer.length);
+    m_bulk_tx_count++;
+    return NRF_SUCCESS;
+}
+
 /*****************************************************************************
  * Helper functions
  *****************************************************************************/
@@ -288,6 +349,9 @@ void setUp(void)
     m_expect_cancelled = false;
     m_expect_ack = false;
     m_pacman_refcount = 0;
+    m_bulk_tx_count = 0;
+    m_bulk_rx_count = 0;
+    m_bulk_rx_consume = false;
 }
 
 void tearDown(void)
@@ -1349,3 +1413,132 @@ void test_pending_msg_cancel(void)
     access_model_reliable_cancel_ExpectAndReturn(m_handle, NRF_SUCCESS);
     config_client_pending_msg_cancel();
 }
+
+void test_bulk_hooks(void)
+{
+    __setup();
+
+    config_msg_key_index_24_t key_indexes;
+    config_msg_key_index_24_set(&key_indexes, 1, 2);
+    const config_msg_appkey_add_t appkey_add =
+        {
+            .key_indexes = key_indexes,
+            .appkey = APPKEY
+        };
+    uint8_t appkey[NRF_MESH_KEY_SIZE] = APPKEY;
+
+    /* Captured requests are handed to the bulk engine instead of being sent. */
+    config_client_bulk_tx_hook_set(bulk_tx_hook);
+    memcpy(m_buffer.buffer, &appkey_add, sizeof(appkey_add));
+    m_buffer.length = sizeof(appkey_add);
+    m_buffer.opcode = CONFIG_OPCODE_APPKEY_ADD;
+    m_buffer.free = false;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_appkey_add(1, 2, appkey));
+    TEST_ASSERT_EQUAL(1, m_bulk_tx_count);
+    TEST_ASSERT_EQUAL(0, m_pacman_refcount);
+    config_client_bulk_tx_hook_set(NULL);
+
+    /* The bulk engine sends unacknowledged, to the node given with each request. */
+    const config_client_bulk_dest_t dest =
+        {
+            .address = 0x0100,
+            .devkey_handle = BULK_DEVKEY_HANDLE,
+            .address_handle = BULK_ADDRESS_HANDLE,
+            .hops = 1
+        };
+    access_model_publish_to_StubWithCallback(bulk_publish_to_cb);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_tx(&dest, CONFIG_OPCODE_APPKEY_ADD, (const uint8_t *) &appkey_add, sizeof(appkey_add)));
+    TEST_ASSERT_EQUAL(2, m_bulk_tx_count);
+    m_buffer.free = true;
+
+    /* Replies consumed by the bulk engine don't reach the client event callback. */
+    config_client_bulk_rx_hook_set(bulk_rx_hook);
+    const config_msg_appkey_status_t status =
+        {
+            .status = 0,
+            .key_indexes = key_indexes
+        };
+    access_opcode_handler_cb_t p_cb = NULL;
+    for (uint32_t i = 0; i < m_model_params.opcode_count; ++i)
+    {
+        if (m_model_params.p_opcode_handlers[i].opcode.opcode == CONFIG_OPCODE_APPKEY_STATUS)
+        {
+            p_cb = m_model_params.p_opcode_handlers[i].handler;
+        }
+    }
+    TEST_ASSERT_NOT_NULL(p_cb);
+    access_message_rx_t msg = {0};
+    msg.opcode.opcode = CONFIG_OPCODE_APPKEY_STATUS;
+    msg.opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    msg.p_data = (const uint8_t *) &status;
+    msg.length = sizeof(status);
+    msg.meta_data.src.value = 0x0100;
+    m_bulk_rx_consume = true;
+    p_cb(m_handle, &msg, m_model_params.p_args);
+    TEST_ASSERT_EQUAL(1, m_bulk_rx_count);
+
+    /* Replies the bulk engine doesn't recognize are passed on. */
+    m_bulk_rx_consume = false;
+    EXPECT_ACK(CONFIG_OPCODE_APPKEY_STATUS, &status, sizeof(status));
+    m_expect_ack = true;
+    p_cb(m_handle, &msg, m_model_params.p_args);
+    TEST_ASSERT_EQUAL(2, m_bulk_rx_count);
+
+    /* Not allowed during a regular transaction. */
+    EXPECT_TX(CONFIG_OPCODE_APPKEY_ADD, &appkey_add, sizeof(appkey_add));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_appkey_add(1, 2, appkey));
+    TEST_ASSERT_EQUAL(NRF_ERROR_BUSY, config_client_bulk_tx(&dest, CONFIG_OPCODE_APPKEY_ADD, (const uint8_t *) &appkey_add, sizeof(appkey_add)));
+    EXPECT_TIMEOUT();
+    m_reliable_cb(m_handle, NULL, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+}
+
+void test_bulk_server_kept(void)
+{
+    __setup();
+
+    /* Regular requests go to the server set with config_client_server_set(). */
+    dsm_handle_t address = DSM_HANDLE_INVALID;
+    access_model_publish_address_get_ExpectAndReturn(m_handle, NULL, NRF_SUCCESS);
+    access_model_publish_address_get_IgnoreArg_p_address_handle();
+    access_model_publish_address_get_ReturnThruPtr_p_address_handle(&address);
+    access_model_publish_address_set_StubWithCallback(publish_address_set_cb);
+    access_model_publish_application_set_StubWithCallback(publish_application_set_cb);
+    access_flash_config_store_Expect();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_server_set(52, 42));
+    TEST_ASSERT_EQUAL(42, m_publish_address_handle);
+    TEST_ASSERT_EQUAL(52, m_publish_appkey_handle);
+
+    /* A bulk request goes to its own node, with that node's device key. */
+    const config_client_bulk_dest_t dest =
+        {
+            .address = 0x0100,
+            .devkey_handle = BULK_DEVKEY_HANDLE,
+            .address_handle = BULK_ADDRESS_HANDLE,
+            .hops = 1
+        };
+    config_msg_key_index_24_t key_indexes;
+    config_msg_key_index_24_set(&key_indexes, 1, 2);
+    const config_msg_appkey_add_t appkey_add =
+        {
+            .key_indexes = key_indexes,
+            .appkey = APPKEY
+        };
+    memcpy(m_buffer.buffer, &appkey_add, sizeof(appkey_add));
+    m_buffer.length = sizeof(appkey_add);
+    access_model_publish_to_StubWithCallback(bulk_publish_to_cb);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_tx(&dest, CONFIG_OPCODE_APPKEY_ADD, (const uint8_t *) &appkey_add, sizeof(appkey_add)));
+    TEST_ASSERT_EQUAL(1, m_bulk_tx_count);
+
+    /* The publication state, which is stored to flash, still points at the server. */
+    TEST_ASSERT_EQUAL(42, m_publish_address_handle);
+    TEST_ASSERT_EQUAL(52, m_publish_appkey_handle);
+
+    /* So the next regular request reaches the server. */
+    config_msg_composition_data_get_t composition_data = {0};
+    EXPECT_TX(CONFIG_OPCODE_COMPOSITION_DATA_GET, &composition_data, sizeof(composition_data));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_composition_data_get(0));
+    TEST_ASSERT_EQUAL(42, m_publish_address_handle);
+    TEST_ASSERT_EQUAL(52, m_publish_appkey_handle);
+    EXPECT_TIMEOUT();
+    m_reliable_cb(m_handle, NULL, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+}
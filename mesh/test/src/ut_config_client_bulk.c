@@ -0,0 +1,497 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unity.h>
+#include <cmock.h>
+
+#include <string.h>
+
+#include "timer_scheduler_mock.h"
+#include "nrf_mesh_utils_mock.h"
+
+#include "config_client_bulk.h"
+#include "config_opcodes.h"
+#include "utils.h"
+
+/* Simulated config servers answer after a fixed per hop latency in each direction. */
+#define NODE_COUNT          (12)
+#define NODE_ADDRESS_BASE   (0x0100)
+#define HOP_LATENCY_US      (MS_TO_US(30))
+#define TIME_STEP_US        (MS_TO_US(5))
+#define SIMULATION_LIMIT_US (SEC_TO_US(120))
+
+typedef struct
+{
+    uint8_t hops;
+    /** Number of upcoming requests to drop. */
+    uint32_t drop;
+    /** Never answer. */
+    bool unreachable;
+    bool reply_pending;
+    timestamp_t reply_at;
+    config_opcode_t reply_opcode;
+    uint32_t rx_count;
+    /** Opcodes of the requests in the order they were first received. */
+    config_opcode_t log[8];
+    uint32_t log_count;
+} sim_node_t;
+
+typedef struct
+{
+    config_client_bulk_event_type_t type;
+    uint16_t address;
+    timestamp_t time;
+} sim_event_t;
+
+static timestamp_t m_now;
+static timer_event_t * mp_timer;
+static bool m_timer_scheduled;
+static config_client_bulk_tx_hook_t m_tx_hook;
+static config_client_bulk_rx_hook_t m_rx_hook;
+static sim_node_t m_nodes[NODE_COUNT];
+static uint32_t m_in_flight;
+static uint32_t m_in_flight_max;
+static sim_event_t m_events[64];
+static uint32_t m_event_count;
+
+/*****************************************************************************
+ * Mocks
+ *****************************************************************************/
+
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+static void timer_sch_reschedule_cb(timer_event_t * p_timer_evt, timestamp_t new_timestamp, int count)
+{
+    mp_timer = p_timer_evt;
+    mp_timer->timestamp = new_timestamp;
+    m_timer_scheduled = true;
+}
+
+static void timer_sch_abort_cb(timer_event_t * p_timer_evt, int count)
+{
+    m_timer_scheduled = false;
+}
+
+static nrf_mesh_address_type_t address_type_get_cb(uint16_t address, int count)
+{
+    if (address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_MESH_ADDRESS_TYPE_INVALID;
+    }
+    return (address & 0x8000) ? NRF_MESH_ADDRESS_TYPE_GROUP : NRF_MESH_ADDRESS_TYPE_UNICAST;
+}
+
+void config_client_bulk_tx_hook_set(config_client_bulk_tx_hook_t tx_hook)
+{
+    m_tx_hook = tx_hook;
+}
+
+void config_client_bulk_rx_hook_set(config_client_bulk_rx_hook_t rx_hook)
+{
+    m_rx_hook = rx_hook;
+}
+
+static config_opcode_t reply_opcode_get(config_opcode_t opcode)
+{
+    return (opcode == CONFIG_OPCODE_APPKEY_ADD) ? CONFIG_OPCODE_APPKEY_STATUS : CONFIG_OPCODE_MODEL_APP_STATUS;
+}
+
+uint32_t config_client_bulk_tx(const config_client_bulk_dest_t * p_dest,
+                               config_opcode_t opcode,
+                               const uint8_t * p_data,
+                               uint16_t length)
+{
+    TEST_ASSERT_TRUE(p_dest->address >= NODE_ADDRESS_BASE && p_dest->address < NODE_ADDRESS_BASE + NODE_COUNT);
+    sim_node_t * p_node = &m_nodes[p_dest->address - NODE_ADDRESS_BASE];
+    TEST_ASSERT_EQUAL(p_node->hops, p_dest->hops);
+    TEST_ASSERT_EQUAL(p_dest->address, p_dest->devkey_handle);
+    TEST_ASSERT_EQUAL(p_dest->address + 1, p_dest->address_handle);
+
+    p_node->rx_count++;
+    if (p_node->unreachable)
+    {
+        return NRF_SUCCESS;
+    }
+    if (p_node->drop > 0)
+    {
+        p_node->drop--;
+        return NRF_SUCCESS;
+    }
+
+    /* A retransmission of an already answered request is answered again, like a real server. */
+    if (!p_node->reply_pending)
+    {
+        TEST_ASSERT_TRUE(p_node->log_count < ARRAY_SIZE(p_node->log));
+        p_node->log[p_node->log_count++] = opcode;
+        p_node->reply_pending = true;
+        p_node->reply_at = m_now + 2 * p_node->hops * HOP_LATENCY_US + HOP_LATENCY_US;
+        p_node->reply_opcode = reply_opcode_get(opcode);
+    }
+    return NRF_SUCCESS;
+}
+
+static void event_cb(config_client_bulk_event_type_t event_type,
+                     uint16_t address,
+                     const config_client_event_t * p_event,
+                     uint16_t length)
+{
+    TEST_ASSERT_TRUE(m_event_count < ARRAY_SIZE(m_events));
+    m_events[m_event_count].type = event_type;
+    m_events[m_event_count].address = address;
+    m_events[m_event_count].time = m_now;
+    m_event_count++;
+
+    if (event_type == CONFIG_CLIENT_BULK_EVENT_TYPE_MSG)
+    {
+        TEST_ASSERT_NOT_NULL(p_event);
+        TEST_ASSERT_TRUE(m_in_flight > 0);
+        m_in_flight--;
+    }
+    else
+    {
+        TEST_ASSERT_NULL(p_event);
+    }
+}
+
+/*****************************************************************************
+ * Simulation
+ *****************************************************************************/
+
+static void node_setup(uint32_t index, uint8_t hops)
+{
+    m_nodes[index].hops = hops;
+}
+
+static void requests_queue(uint32_t index, uint32_t count)
+{
+    const config_client_bulk_dest_t dest =
+    {
+        .address = NODE_ADDRESS_BASE + index,
+        .devkey_handle = NODE_ADDRESS_BASE + index,
+        .address_handle = NODE_ADDRESS_BASE + index + 1,
+        .hops = m_nodes[index].hops
+    };
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_begin(&dest));
+    TEST_ASSERT_NOT_NULL(m_tx_hook);
+
+    uint8_t appkey_add[19] = {0};
+    uint8_t app_bind[6] = {0};
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i == 0)
+        {
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, m_tx_hook(CONFIG_OPCODE_APPKEY_ADD, appkey_add, sizeof(appkey_add), CONFIG_OPCODE_APPKEY_STATUS));
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, m_tx_hook(CONFIG_OPCODE_MODEL_APP_BIND, app_bind, sizeof(app_bind), CONFIG_OPCODE_MODEL_APP_STATUS));
+        }
+    }
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_end());
+    TEST_ASSERT_NULL(m_tx_hook);
+}
+
+static uint32_t in_flight_count(void)
+{
+    config_client_bulk_progress_t progress;
+    config_client_bulk_progress_get(&progress);
+    return progress.in_flight;
+}
+
+/** Runs the simulation until the engine reports that it's done. */
+static void simulate(void)
+{
+    while (m_now < SIMULATION_LIMIT_US)
+    {
+        if (m_event_count > 0 && m_events[m_event_count - 1].type == CONFIG_CLIENT_BULK_EVENT_TYPE_DONE)
+        {
+            return;
+        }
+
+        m_now += TIME_STEP_US;
+        for (uint32_t i = 0; i < NODE_COUNT; ++i)
+        {
+            sim_node_t * p_node = &m_nodes[i];
+            if (p_node->reply_pending && !TIMER_OLDER_THAN(m_now, p_node->reply_at))
+            {
+                p_node->reply_pending = false;
+                config_msg_t msg;
+                memset(&msg, 0, sizeof(msg));
+                config_client_event_t evt = {p_node->reply_opcode, &msg};
+                m_in_flight = in_flight_count();
+                TEST_ASSERT_TRUE(m_rx_hook(NODE_ADDRESS_BASE + i, &evt, 1));
+            }
+        }
+
+        if (m_timer_scheduled && !TIMER_OLDER_THAN(m_now, mp_timer->timestamp))
+        {
+            m_timer_scheduled = false;
+            mp_timer->cb(m_now, mp_timer->p_context);
+        }
+
+        uint32_t in_flight = in_flight_count();
+        m_in_flight_max = MAX(m_in_flight_max, in_flight);
+    }
+    TEST_FAIL_MESSAGE("Simulation did not finish");
+}
+
+static uint32_t events_count(config_client_bulk_event_type_t type, uint16_t address)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < m_event_count; ++i)
+    {
+        if (m_events[i].type == type && (address == NRF_MESH_ADDR_UNASSIGNED || m_events[i].address == address))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+static const sim_event_t * event_find(config_client_bulk_event_type_t type, uint16_t address)
+{
+    for (uint32_t i = 0; i < m_event_count; ++i)
+    {
+        if (m_events[i].type == type && m_events[i].address == address)
+        {
+            return &m_events[i];
+        }
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * Setup
+ *****************************************************************************/
+
+void setUp(void)
+{
+    timer_scheduler_mock_Init();
+    nrf_mesh_utils_mock_Init();
+    timer_sch_reschedule_StubWithCallback(timer_sch_reschedule_cb);
+    timer_sch_abort_StubWithCallback(timer_sch_abort_cb);
+    nrf_mesh_address_type_get_StubWithCallback(address_type_get_cb);
+
+    m_now = 0;
+    mp_timer = NULL;
+    m_timer_scheduled = false;
+    m_tx_hook = NULL;
+    m_rx_hook = NULL;
+    memset(m_nodes, 0, sizeof(m_nodes));
+    memset(m_events, 0, sizeof(m_events));
+    m_event_count = 0;
+    m_in_flight = 0;
+    m_in_flight_max = 0;
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_init(event_cb));
+    TEST_ASSERT_NOT_NULL(m_rx_hook);
+}
+
+void tearDown(void)
+{
+    timer_scheduler_mock_Verify();
+    timer_scheduler_mock_Destroy();
+    nrf_mesh_utils_mock_Verify();
+    nrf_mesh_utils_mock_Destroy();
+}
+
+/*****************************************************************************
+ * Tests
+ *****************************************************************************/
+
+void test_invalid_params(void)
+{
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, config_client_bulk_init(NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, config_client_bulk_begin(NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, config_client_bulk_end());
+
+    config_client_bulk_dest_t dest = {.address = 0xC000, .devkey_handle = 0, .address_handle = 0, .hops = 0};
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_ADDR, config_client_bulk_begin(&dest));
+    dest.address = NRF_MESH_ADDR_UNASSIGNED;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_ADDR, config_client_bulk_begin(&dest));
+
+    dest.address = NODE_ADDRESS_BASE;
+    dest.devkey_handle = NODE_ADDRESS_BASE;
+    dest.address_handle = NODE_ADDRESS_BASE + 1;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_begin(&dest));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, config_client_bulk_begin(&dest));
+
+    uint8_t too_long[CONFIG_CLIENT_BULK_MESSAGE_LENGTH_MAX + 1] = {0};
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_LENGTH,
+                      m_tx_hook(CONFIG_OPCODE_APPKEY_ADD, too_long, sizeof(too_long), CONFIG_OPCODE_APPKEY_STATUS));
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, m_tx_hook(CONFIG_OPCODE_BEACON_GET, NULL, 0, CONFIG_OPCODE_BEACON_STATUS));
+    }
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, m_tx_hook(CONFIG_OPCODE_BEACON_GET, NULL, 0, CONFIG_OPCODE_BEACON_STATUS));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, config_client_bulk_end());
+    TEST_ASSERT_EQUAL(1, in_flight_count());
+
+    config_client_bulk_cancel();
+    TEST_ASSERT_EQUAL(CONFIG_CLIENT_BULK_QUEUE_SIZE, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED, NODE_ADDRESS_BASE));
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_DONE, NRF_MESH_ADDR_UNASSIGNED));
+    TEST_ASSERT_FALSE(m_timer_scheduled);
+}
+
+void test_pipelining(void)
+{
+    const uint32_t requests_per_node = 2;
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        node_setup(i, i % 4);
+        requests_queue(i, requests_per_node);
+    }
+    TEST_ASSERT_EQUAL(CONFIG_CLIENT_BULK_IN_FLIGHT_MAX, in_flight_count());
+
+    simulate();
+
+    TEST_ASSERT_EQUAL(CONFIG_CLIENT_BULK_IN_FLIGHT_MAX, m_in_flight_max);
+    TEST_ASSERT_EQUAL(NODE_COUNT * requests_per_node, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, NRF_MESH_ADDR_UNASSIGNED));
+    TEST_ASSERT_EQUAL(0, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, NRF_MESH_ADDR_UNASSIGNED));
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_DONE, NRF_MESH_ADDR_UNASSIGNED));
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        /* Requests to the same node keep their order. */
+        TEST_ASSERT_EQUAL(requests_per_node, m_nodes[i].log_count);
+        TEST_ASSERT_EQUAL(CONFIG_OPCODE_APPKEY_ADD, m_nodes[i].log[0]);
+        TEST_ASSERT_EQUAL(CONFIG_OPCODE_MODEL_APP_BIND, m_nodes[i].log[1]);
+    }
+
+    /* Sending one request at a time would take the sum of all round trips. */
+    timestamp_t serial_time = 0;
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        serial_time += requests_per_node * (2 * m_nodes[i].hops + 1) * HOP_LATENCY_US;
+    }
+    TEST_ASSERT_TRUE(m_now * 3 < serial_time);
+
+    config_client_bulk_progress_t progress;
+    config_client_bulk_progress_get(&progress);
+    TEST_ASSERT_EQUAL(0, progress.queued);
+    TEST_ASSERT_EQUAL(0, progress.in_flight);
+    TEST_ASSERT_EQUAL(NODE_COUNT * requests_per_node, progress.completed);
+    TEST_ASSERT_EQUAL(0, progress.failed);
+    TEST_ASSERT_EQUAL(0, progress.retransmissions);
+    TEST_ASSERT_EQUAL(m_now / 1000, progress.elapsed_ms);
+    TEST_ASSERT_TRUE(progress.rtt_avg_ms >= HOP_LATENCY_US / 1000);
+    TEST_ASSERT_EQUAL((uint64_t) progress.completed * 60000 / progress.elapsed_ms, progress.throughput_per_minute);
+
+    /* The progress report is frozen once the engine is idle. */
+    m_now += SEC_TO_US(10);
+    config_client_bulk_progress_get(&progress);
+    TEST_ASSERT_EQUAL((m_now - SEC_TO_US(10)) / 1000, progress.elapsed_ms);
+}
+
+void test_retransmit_backoff(void)
+{
+    node_setup(0, 2);
+    m_nodes[0].drop = 3;
+    requests_queue(0, 1);
+
+    simulate();
+
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, NODE_ADDRESS_BASE));
+    TEST_ASSERT_EQUAL(4, m_nodes[0].rx_count);
+
+    /* The interval doubles on every retransmission. */
+    const uint32_t interval = CONFIG_CLIENT_BULK_INTERVAL_BASE + 2 * CONFIG_CLIENT_BULK_INTERVAL_PER_HOP;
+    const timestamp_t last_tx = interval + 2 * interval + 4 * interval;
+    const sim_event_t * p_msg = event_find(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, NODE_ADDRESS_BASE);
+    TEST_ASSERT_NOT_NULL(p_msg);
+    TEST_ASSERT_TRUE(p_msg->time >= last_tx + 5 * HOP_LATENCY_US);
+    TEST_ASSERT_TRUE(p_msg->time <= last_tx + 5 * HOP_LATENCY_US + 2 * TIME_STEP_US);
+
+    config_client_bulk_progress_t progress;
+    config_client_bulk_progress_get(&progress);
+    TEST_ASSERT_EQUAL(3, progress.retransmissions);
+}
+
+void test_timeout_scales_with_hops(void)
+{
+    node_setup(0, 0);
+    node_setup(1, 6);
+    node_setup(2, 1);
+    m_nodes[0].unreachable = true;
+    m_nodes[1].unreachable = true;
+    requests_queue(0, 3);
+    requests_queue(1, 1);
+    requests_queue(2, 2);
+
+    simulate();
+
+    /* Requests queued after a failed request to the same node are cancelled. */
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, NODE_ADDRESS_BASE));
+    TEST_ASSERT_EQUAL(2, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED, NODE_ADDRESS_BASE));
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, NODE_ADDRESS_BASE + 1));
+    TEST_ASSERT_EQUAL(2, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, NODE_ADDRESS_BASE + 2));
+
+    const sim_event_t * p_near = event_find(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, NODE_ADDRESS_BASE);
+    const sim_event_t * p_far = event_find(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, NODE_ADDRESS_BASE + 1);
+    TEST_ASSERT_NOT_NULL(p_near);
+    TEST_ASSERT_NOT_NULL(p_far);
+    TEST_ASSERT_UINT32_WITHIN(TIME_STEP_US, CONFIG_CLIENT_BULK_TIMEOUT_BASE, p_near->time);
+    TEST_ASSERT_UINT32_WITHIN(TIME_STEP_US, CONFIG_CLIENT_BULK_TIMEOUT_BASE + 6 * CONFIG_CLIENT_BULK_TIMEOUT_PER_HOP, p_far->time);
+
+    config_client_bulk_progress_t progress;
+    config_client_bulk_progress_get(&progress);
+    TEST_ASSERT_EQUAL(2, progress.completed);
+    TEST_ASSERT_EQUAL(4, progress.failed);
+}
+
+void test_unrelated_messages_pass_through(void)
+{
+    node_setup(0, 0);
+    requests_queue(0, 1);
+
+    config_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    config_client_event_t evt = {CONFIG_OPCODE_BEACON_STATUS, &msg};
+    /* Wrong opcode from the right node, and the right opcode from a node without a request. */
+    TEST_ASSERT_FALSE(m_rx_hook(NODE_ADDRESS_BASE, &evt, 1));
+    evt.opcode = CONFIG_OPCODE_APPKEY_STATUS;
+    TEST_ASSERT_FALSE(m_rx_hook(NODE_ADDRESS_BASE + 1, &evt, 1));
+    TEST_ASSERT_EQUAL(0, m_event_count);
+
+    m_in_flight = 1;
+    TEST_ASSERT_TRUE(m_rx_hook(NODE_ADDRESS_BASE, &evt, 1));
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, NODE_ADDRESS_BASE));
+    TEST_ASSERT_EQUAL(1, events_count(CONFIG_CLIENT_BULK_EVENT_TYPE_DONE, NRF_MESH_ADDR_UNASSIGNED));
+    TEST_ASSERT_FALSE(m_timer_scheduled);
+}
@@ -46,6 +46,7 @@
 #define TOKEN   0x12345678
 
 static core_tx_bearer_interface_t m_interface;
+static core_tx_bearer_interface_t m_shared_interface;
 static core_tx_bearer_t m_bearer;
 
 static void setup_bearer(void);
@@ -140,6 +141,23 @@ void packet_discard(core_tx_bearer_t * p_bearer)
         m_expect_discard.expected_calls++;                                                         \
     } while (0)
 
+struct
+{
+    uint32_t calls;
+    core_tx_bearer_t * p_bearers[CORE_TX_BEARER_COUNT_MAX];
+    core_tx_pdu_t * p_pdus[CORE_TX_BEARER_COUNT_MAX];
+} m_shared_send;
+void packet_send_shared(core_tx_bearer_t * p_bearer, core_tx_pdu_t * p_pdu)
+{
+    TEST_ASSERT_TRUE(m_shared_send.calls < CORE_TX_BEARER_COUNT_MAX);
+    TEST_ASSERT_NOT_NULL(p_pdu);
+    /* The bearer holds a reference on top of the Core TX reference: */
+    TEST_ASSERT_TRUE(p_pdu->refcount >= 2);
+    m_shared_send.p_bearers[m_shared_send.calls] = p_bearer;
+    m_shared_send.p_pdus[m_shared_send.calls]    = p_pdu;
+    m_shared_send.calls++;
+}
+
 /*****************************************************************************
 * Helper functions
 *****************************************************************************/
@@ -171,6 +189,11 @@ static void setup_bearer(void)
     m_interface.packet_send = packet_send;
     m_interface.packet_discard = packet_discard;
     core_tx_bearer_add(&m_bearer, &m_interface, CORE_TX_BEARER_TYPE_ADV);
+
+    m_shared_interface.packet_alloc       = packet_alloc;
+    m_shared_interface.packet_send        = packet_send;
+    m_shared_interface.packet_discard     = packet_discard;
+    m_shared_interface.packet_send_shared = packet_send_shared;
 }
 
 static void clear_interface_mocks(void)
@@ -178,6 +201,7 @@ static void clear_interface_mocks(void)
     memset(&m_expect_alloc, 0, sizeof(m_expect_alloc));
     memset(&m_expect_discard, 0, sizeof(m_expect_discard));
     memset(&m_expect_send, 0, sizeof(m_expect_send));
+    memset(&m_shared_send, 0, sizeof(m_shared_send));
 }
 /*****************************************************************************
 * Test functions
@@ -197,6 +221,10 @@ void test_bearer_add(void)
     TEST_NRF_MESH_ASSERT_EXPECT(core_tx_bearer_add(NULL, &m_interface, CORE_TX_BEARER_TYPE_ADV));
     TEST_NRF_MESH_ASSERT_EXPECT(core_tx_bearer_add(&bearers[0], &m_interface, CORE_TX_BEARER_TYPE_INVALID));
 
+    /* Bearers that send by reference must also be able to send a copy: */
+    m_shared_interface.packet_send = NULL;
+    TEST_NRF_MESH_ASSERT_EXPECT(core_tx_bearer_add(&bearers[0], &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER));
+
     /* Successful */
     for (uint32_t i = 0; i < ARRAY_SIZE(bearers); ++i)
     {
@@ -429,3 +457,230 @@ void test_tx_complete(void)
     /* even for invalid data: */
     core_tx_complete(&m_bearer, 42, 1234, TOKEN);
 }
+
+void test_send_shared(void)
+{
+    core_tx_bearer_t shared_bearers[2];
+    core_tx_bearer_add(&shared_bearers[0], &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER);
+    core_tx_bearer_add(&shared_bearers[1], &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER);
+
+    uint8_t * p_packet = NULL;
+    network_packet_metadata_t metadata;
+    core_tx_alloc_params_t params = {.role           = CORE_TX_ROLE_ORIGINATOR,
+                                     .net_packet_len = 20,
+                                     .p_metadata     = &metadata,
+                                     .token          = TOKEN};
+
+    EXPECT_ALLOC(&m_bearer,          &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&shared_bearers[0], &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&shared_bearers[1], &params, CORE_TX_ALLOC_SUCCESS);
+    TEST_ASSERT_EQUAL_HEX32(0x7, core_tx_packet_alloc(&params, &p_packet));
+    TEST_ASSERT_NOT_NULL(p_packet);
+
+    /* The copying bearer gets the staged packet, the others get a reference to the same PDU: */
+    EXPECT_SEND(&m_bearer, p_packet, params.net_packet_len);
+    core_tx_packet_send();
+    TEST_ASSERT_EQUAL(1, m_expect_send.calls);
+    TEST_ASSERT_EQUAL(2, m_shared_send.calls);
+    TEST_ASSERT_EQUAL_PTR(&shared_bearers[0], m_shared_send.p_bearers[0]);
+    TEST_ASSERT_EQUAL_PTR(&shared_bearers[1], m_shared_send.p_bearers[1]);
+
+    core_tx_pdu_t * p_pdu = m_shared_send.p_pdus[0];
+    TEST_ASSERT_EQUAL_PTR(p_pdu, m_shared_send.p_pdus[1]);
+    TEST_ASSERT_EQUAL_PTR(p_packet, p_pdu->packet.pdu);
+    TEST_ASSERT_EQUAL(params.net_packet_len, p_pdu->length);
+    /* Core TX dropped its own reference, only the bearers hold it now: */
+    TEST_ASSERT_EQUAL(2, p_pdu->refcount);
+
+    core_tx_pdu_release(p_pdu);
+    TEST_ASSERT_EQUAL(1, p_pdu->refcount);
+    core_tx_pdu_release(p_pdu);
+    TEST_ASSERT_EQUAL(0, p_pdu->refcount);
+    TEST_NRF_MESH_ASSERT_EXPECT(core_tx_pdu_release(p_pdu));
+
+    clear_interface_mocks();
+
+    /* A discarded packet returns the PDU to the pool: */
+    EXPECT_ALLOC(&m_bearer,          &params, CORE_TX_ALLOC_FAIL_REJECTED);
+    EXPECT_ALLOC(&shared_bearers[0], &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&shared_bearers[1], &params, CORE_TX_ALLOC_FAIL_NO_MEM);
+    TEST_ASSERT_EQUAL_HEX32(0x2, core_tx_packet_alloc(&params, &p_packet));
+    p_pdu = PARENT_BY_FIELD_GET(core_tx_pdu_t, packet, p_packet);
+    TEST_ASSERT_EQUAL(1, p_pdu->refcount);
+    EXPECT_DISCARD(&shared_bearers[0]);
+    core_tx_packet_discard();
+    TEST_ASSERT_EQUAL(0, p_pdu->refcount);
+
+    /* Releasing memory outside the pool is not allowed: */
+    core_tx_pdu_t pdu;
+    TEST_NRF_MESH_ASSERT_EXPECT(core_tx_pdu_release(&pdu));
+
+    clear_interface_mocks();
+}
+
+void test_shared_pool_exhausted(void)
+{
+    core_tx_bearer_t shared_bearer;
+    core_tx_bearer_add(&shared_bearer, &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER);
+
+    uint8_t * p_packet = NULL;
+    network_packet_metadata_t metadata;
+    core_tx_alloc_params_t params = {.role           = CORE_TX_ROLE_ORIGINATOR,
+                                     .net_packet_len = 20,
+                                     .p_metadata     = &metadata,
+                                     .token          = TOKEN};
+
+    /* Hold on to every PDU in the pool: */
+    core_tx_pdu_t * p_pdus[CORE_TX_SHARED_PDU_COUNT];
+    for (uint32_t i = 0; i < CORE_TX_SHARED_PDU_COUNT; ++i)
+    {
+        EXPECT_ALLOC(&m_bearer,      &params, CORE_TX_ALLOC_FAIL_REJECTED);
+        EXPECT_ALLOC(&shared_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+        TEST_ASSERT_EQUAL_HEX32(0x2, core_tx_packet_alloc(&params, &p_packet));
+        core_tx_packet_send();
+        TEST_ASSERT_EQUAL(1, m_shared_send.calls);
+        p_pdus[i] = m_shared_send.p_pdus[0];
+        clear_interface_mocks();
+    }
+
+    /* Both bearers get a copy from the local buffer instead: */
+    EXPECT_ALLOC(&m_bearer,      &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&shared_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+    TEST_ASSERT_EQUAL_HEX32(0x3, core_tx_packet_alloc(&params, &p_packet));
+    for (uint32_t i = 0; i < CORE_TX_SHARED_PDU_COUNT; ++i)
+    {
+        TEST_ASSERT_NOT_EQUAL(p_pdus[i]->packet.pdu, p_packet);
+    }
+    EXPECT_SEND(&m_bearer,      p_packet, params.net_packet_len);
+    EXPECT_SEND(&shared_bearer, p_packet, params.net_packet_len);
+    core_tx_packet_send();
+    TEST_ASSERT_EQUAL(2, m_expect_send.calls);
+    TEST_ASSERT_EQUAL(0, m_shared_send.calls);
+    clear_interface_mocks();
+
+    /* Also when only the shared bearer accepts the packet: */
+    EXPECT_ALLOC(&m_bearer,      &params, CORE_TX_ALLOC_FAIL_NO_MEM);
+    EXPECT_ALLOC(&shared_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+    TEST_ASSERT_EQUAL_HEX32(0x2, core_tx_packet_alloc(&params, &p_packet));
+    EXPECT_SEND(&shared_bearer, p_packet, params.net_packet_len);
+    core_tx_packet_send();
+    TEST_ASSERT_EQUAL(1, m_expect_send.calls);
+    clear_interface_mocks();
+
+    core_tx_bearer_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, core_tx_bearer_stats_get(shared_bearer.bearer_index, &stats));
+    TEST_ASSERT_EQUAL(CORE_TX_SHARED_PDU_COUNT + 2, stats.alloc_count);
+    TEST_ASSERT_EQUAL(CORE_TX_SHARED_PDU_COUNT, stats.shared_count);
+    TEST_ASSERT_EQUAL(2, stats.send_count);
+    TEST_ASSERT_EQUAL(2, stats.no_pdu_count);
+
+    /* Releasing one PDU makes the shared bearer available again: */
+    core_tx_pdu_release(p_pdus[0]);
+    EXPECT_ALLOC(&m_bearer,      &params, CORE_TX_ALLOC_FAIL_REJECTED);
+    EXPECT_ALLOC(&shared_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+    TEST_ASSERT_EQUAL_HEX32(0x2, core_tx_packet_alloc(&params, &p_packet));
+    TEST_ASSERT_EQUAL_PTR(p_pdus[0]->packet.pdu, p_packet);
+    EXPECT_DISCARD(&shared_bearer);
+    core_tx_packet_discard();
+    clear_interface_mocks();
+}
+
+void test_shared_bearer_stalled(void)
+{
+    core_tx_bearer_t shared_bearers[2];
+    core_tx_bearer_add(&shared_bearers[0], &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER);
+    core_tx_bearer_add(&shared_bearers[1], &m_shared_interface, CORE_TX_BEARER_TYPE_GATT_SERVER);
+
+    uint8_t * p_packet = NULL;
+    network_packet_metadata_t metadata;
+    core_tx_alloc_params_t params = {.role           = CORE_TX_ROLE_ORIGINATOR,
+                                     .net_packet_len = 20,
+                                     .p_metadata     = &metadata,
+                                     .token          = TOKEN};
+
+    /* The first shared bearer never completes its transmissions, and holds on to every PDU it gets,
+     * while the second releases them right away. The second bearer must get every packet: */
+    uint32_t received = 0;
+    for (uint32_t i = 0; i < 2 * CORE_TX_SHARED_PDU_COUNT; ++i)
+    {
+        EXPECT_ALLOC(&m_bearer,          &params, CORE_TX_ALLOC_FAIL_REJECTED);
+        EXPECT_ALLOC(&shared_bearers[0], &params, CORE_TX_ALLOC_SUCCESS);
+        EXPECT_ALLOC(&shared_bearers[1], &params, CORE_TX_ALLOC_SUCCESS);
+        TEST_ASSERT_EQUAL_HEX32(0x6, core_tx_packet_alloc(&params, &p_packet));
+        if (i >= CORE_TX_SHARED_PDU_COUNT)
+        {
+            EXPECT_SEND(&shared_bearers[0], p_packet, params.net_packet_len);
+            EXPECT_SEND(&shared_bearers[1], p_packet, params.net_packet_len);
+        }
+        core_tx_packet_send();
+
+        for (uint32_t j = 0; j < m_shared_send.calls; ++j)
+        {
+            if (m_shared_send.p_bearers[j] == &shared_bearers[1])
+            {
+                core_tx_pdu_release(m_shared_send.p_pdus[j]);
+                received++;
+            }
+        }
+        for (uint32_t j = 0; j < m_expect_send.calls; ++j)
+        {
+            if (m_expect_send.p_bearers[j] == &shared_bearers[1])
+            {
+                received++;
+            }
+        }
+        clear_interface_mocks();
+    }
+    TEST_ASSERT_EQUAL(2 * CORE_TX_SHARED_PDU_COUNT, received);
+
+    core_tx_bearer_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, core_tx_bearer_stats_get(shared_bearers[1].bearer_index, &stats));
+    TEST_ASSERT_EQUAL(2 * CORE_TX_SHARED_PDU_COUNT, stats.alloc_count);
+    TEST_ASSERT_EQUAL(CORE_TX_SHARED_PDU_COUNT, stats.shared_count);
+    TEST_ASSERT_EQUAL(CORE_TX_SHARED_PDU_COUNT, stats.send_count);
+}
+
+void test_stats(void)
+{
+    core_tx_bearer_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, core_tx_bearer_stats_get(m_bearer.bearer_index, NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, core_tx_bearer_stats_get(m_bearer.bearer_index + 1, &stats));
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, core_tx_bearer_stats_get(m_bearer.bearer_index, &stats));
+    TEST_ASSERT_EQUAL(0, stats.alloc_count);
+    TEST_ASSERT_EQUAL(0, stats.send_count);
+
+    uint8_t * p_packet = NULL;
+    network_packet_metadata_t metadata;
+    core_tx_alloc_params_t params = {.role           = CORE_TX_ROLE_ORIGINATOR,
+                                     .net_packet_len = 20,
+                                     .p_metadata     = &metadata,
+                                     .token          = TOKEN};
+
+    EXPECT_ALLOC(&m_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&m_bearer, &params, CORE_TX_ALLOC_SUCCESS);
+    EXPECT_ALLOC(&m_bearer, &params, CORE_TX_ALLOC_FAIL_NO_MEM);
+    EXPECT_ALLOC(&m_bearer, &params, CORE_TX_ALLOC_FAIL_NO_MEM);
+    EXPECT_ALLOC(&m_bearer, &params, CORE_TX_ALLOC_FAIL_REJECTED);
+
+    (void) core_tx_packet_alloc(&params, &p_packet);
+    EXPECT_SEND(&m_bearer, p_packet, params.net_packet_len);
+    core_tx_packet_send();
+    (void) core_tx_packet_alloc(&params, &p_packet);
+    EXPECT_DISCARD(&m_bearer);
+    core_tx_packet_discard();
+    (void) core_tx_packet_alloc(&params, &p_packet);
+    (void) core_tx_packet_alloc(&params, &p_packet);
+    (void) core_tx_packet_alloc(&params, &p_packet);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, core_tx_bearer_stats_get(m_bearer.bearer_index, &stats));
+    TEST_ASSERT_EQUAL(2, stats.alloc_count);
+    TEST_ASSERT_EQUAL(2, stats.no_mem_count);
+    TEST_ASSERT_EQUAL(1, stats.reject_count);
+    TEST_ASSERT_EQUAL(1, stats.send_count);
+    TEST_ASSERT_EQUAL(1, stats.discard_count);
+    TEST_ASSERT_EQUAL(0, stats.shared_count);
+    TEST_ASSERT_EQUAL(0, stats.no_pdu_count);
+
+    clear_interface_mocks();
+}
@@ -44,6 +44,7 @@
 #include "utils.h"
 #include "test_assert.h"
 #include "mesh_opt_core.h"
+#include "packet_mesh.h"
 
 #define TOKEN   0x12345678
 
@@ -172,7 +173,7 @@ void test_alloc_send_discard(void)
         {CORE_TX_ROLE_ORIGINATOR, 12, false},
         {CORE_TX_ROLE_RELAY, 12, true, true},
         {CORE_TX_ROLE_ORIGINATOR, 29, true, true},
-        {CORE_TX_ROLE_ORIGINATOR, 30, false},
+        {CORE_TX_ROLE_ORIGINATOR, 30, false}, /* Longer than the legacy advertising packet, rejected */
         /* Discard all: */
         {CORE_TX_ROLE_ORIGINATOR, 12, true, false},
         {CORE_TX_ROLE_ORIGINATOR, 0, true, false},
@@ -201,6 +202,12 @@ void test_alloc_send_discard(void)
                                          .p_metadata     = &metadata,
                                          .token          = TOKEN};
 
+        if (vector[i].size > PACKET_MESH_NET_MAX_SIZE)
+        {
+            TEST_ASSERT_EQUAL(CORE_TX_ALLOC_FAIL_REJECTED, mp_interface->packet_alloc(mp_bearer, &params));
+            continue;
+        }
+
         advertiser_packet_alloc_ExpectAndReturn(mp_advertisers[vector[i].role],
                                                 vector[i].size + 2,
                                                 vector[i].successful_alloc ? &adv_packet
@@ -0,0 +1,208 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "dfu_fec.h"
+
+#define BLOCK_SIZE      (16)
+#define REPAIR_COUNT    (DFU_FEC_REPAIR_MAX)
+
+static uint8_t m_block[BLOCK_SIZE][SEGMENT_LENGTH];
+static uint8_t m_repair[REPAIR_COUNT][SEGMENT_LENGTH];
+
+static void block_encode(uint32_t block_size, uint32_t repair_count)
+{
+    memset(m_repair, 0, sizeof(m_repair));
+    for (uint32_t j = 0; j < repair_count; ++j)
+    {
+        for (uint32_t i = 0; i < block_size; ++i)
+        {
+            dfu_fec_accumulate(m_repair[j], m_block[i], j, i);
+        }
+    }
+}
+
+/* Recovers the lost segments with the given repair segments, and checks that they match. */
+static void block_recover(uint32_t block_size,
+                          const uint8_t* p_lost,
+                          const uint8_t* p_repair_indices,
+                          uint32_t count)
+{
+    uint8_t segments[REPAIR_COUNT][SEGMENT_LENGTH];
+    for (uint32_t r = 0; r < count; ++r)
+    {
+        memcpy(segments[r], m_repair[p_repair_indices[r]], SEGMENT_LENGTH);
+    }
+    for (uint32_t i = 0; i < block_size; ++i)
+    {
+        if (memchr(p_lost, i, count) == NULL)
+        {
+            for (uint32_t r = 0; r < count; ++r)
+            {
+                dfu_fec_accumulate(segments[r], m_block[i], p_repair_indices[r], i);
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(dfu_fec_solve(count, p_repair_indices, p_lost, segments));
+    for (uint32_t r = 0; r < count; ++r)
+    {
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(m_block[p_lost[r]], segments[r], SEGMENT_LENGTH);
+    }
+}
+
+void setUp(void)
+{
+    srand(0);
+    for (uint32_t i = 0; i < BLOCK_SIZE; ++i)
+    {
+        for (uint32_t j = 0; j < SEGMENT_LENGTH; ++j)
+        {
+            m_block[i][j] = rand();
+        }
+    }
+}
+
+void tearDown(void)
+{
+}
+
+void test_encode(void)
+{
+    /* Reference values from tools/dfu/dfu_fec_encode.py. */
+    static const uint8_t repair_0[SEGMENT_LENGTH] = {0xFA, 0x09, 0x01, 0xF2, 0x11, 0xE2, 0xEA, 0x19,
+                                                     0x31, 0xC2, 0xCA, 0x39, 0xDA, 0x29, 0x21, 0xD2};
+    static const uint8_t repair_5[SEGMENT_LENGTH] = {0x27, 0xC3, 0xF2, 0x16, 0x90, 0x74, 0x45, 0xA1,
+                                                     0x54, 0xB0, 0x81, 0x65, 0xE3, 0x07, 0x36, 0xD2};
+    for (uint32_t i = 0; i < 4 * SEGMENT_LENGTH; ++i)
+    {
+        m_block[i / SEGMENT_LENGTH][i % SEGMENT_LENGTH] = i;
+    }
+    uint8_t repair[SEGMENT_LENGTH] = {0};
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        dfu_fec_accumulate(repair, m_block[i], 0, i);
+    }
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(repair_0, repair, SEGMENT_LENGTH);
+
+    memset(repair, 0, sizeof(repair));
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        dfu_fec_accumulate(repair, m_block[i], 5, i);
+    }
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(repair_5, repair, SEGMENT_LENGTH);
+}
+
+void test_recover_single(void)
+{
+    block_encode(BLOCK_SIZE, REPAIR_COUNT);
+    /* Any repair segment recovers any single lost segment. */
+    for (uint8_t lost = 0; lost < BLOCK_SIZE; ++lost)
+    {
+        for (uint8_t repair = 0; repair < REPAIR_COUNT; ++repair)
+        {
+            block_recover(BLOCK_SIZE, &lost, &repair, 1);
+        }
+    }
+}
+
+void test_recover_pairs(void)
+{
+    block_encode(BLOCK_SIZE, REPAIR_COUNT);
+    const uint8_t repair[] = {REPAIR_COUNT - 1, 0};
+    for (uint8_t a = 0; a < BLOCK_SIZE; ++a)
+    {
+        for (uint8_t b = a + 1; b < BLOCK_SIZE; ++b)
+        {
+            const uint8_t lost[] = {b, a};
+            block_recover(BLOCK_SIZE, lost, repair, 2);
+        }
+    }
+}
+
+void test_recover_random(void)
+{
+    block_encode(BLOCK_SIZE, REPAIR_COUNT);
+    for (uint32_t run = 0; run < 1000; ++run)
+    {
+        /* Pick random distinct lost segments and repair segments. */
+        uint32_t count = 1 + rand() % REPAIR_COUNT;
+        uint8_t lost[REPAIR_COUNT];
+        uint8_t repair[REPAIR_COUNT];
+        for (uint32_t r = 0; r < count; ++r)
+        {
+            do
+            {
+                lost[r] = rand() % BLOCK_SIZE;
+            } while (memchr(lost, lost[r], r) != NULL);
+            do
+            {
+                repair[r] = rand() % REPAIR_COUNT;
+            } while (memchr(repair, repair[r], r) != NULL);
+        }
+        block_recover(BLOCK_SIZE, lost, repair, count);
+    }
+}
+
+void test_short_block(void)
+{
+    /* The last block of a transfer may have fewer segments. */
+    block_encode(3, 2);
+    const uint8_t lost[] = {2, 0};
+    const uint8_t repair[] = {1, 0};
+    block_recover(3, lost, repair, 2);
+}
+
+void test_solve_invalid(void)
+{
+    uint8_t segments[REPAIR_COUNT + 1][SEGMENT_LENGTH];
+    uint8_t indices[REPAIR_COUNT + 1];
+    for (uint32_t i = 0; i < REPAIR_COUNT + 1; ++i)
+    {
+        indices[i] = i;
+    }
+    TEST_ASSERT_FALSE(dfu_fec_solve(REPAIR_COUNT + 1, indices, indices, segments));
+
+    /* The same repair segment twice doesn't carry enough information. */
+    const uint8_t lost[] = {0, 1};
+    const uint8_t repair[] = {3, 3};
+    TEST_ASSERT_FALSE(dfu_fec_solve(2, repair, lost, segments));
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unity.h>
+#include <string.h>
+
+#include "ecc_p256.h"
+#include "nrf_error.h"
+#include "uECC.h"
+
+#define TEST_ITERATIONS     (20)
+
+/* Private keys returned by the rand_hw_rng_get() stub, in order. */
+static const uint8_t * mp_rand_keys[2];
+static uint32_t m_rand_calls;
+
+/** The base point G, from SEC 2. */
+static const uint8_t m_base_point[ECC_P256_PUBLIC_KEY_SIZE] =
+{
+    0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+    0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+    0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+    0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+};
+
+/** The curve order n, from SEC 2. */
+static const uint8_t m_order[ECC_P256_PRIVATE_KEY_SIZE] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84, 0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51
+};
+
+void rand_hw_rng_get(uint8_t * p_result, uint16_t len)
+{
+    TEST_ASSERT_EQUAL(ECC_P256_PRIVATE_KEY_SIZE, len);
+    TEST_ASSERT_TRUE(m_rand_calls < 2);
+    memcpy(p_result, mp_rand_keys[m_rand_calls++], len);
+}
+
+void setUp(void)
+{
+    m_rand_calls = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/*****************************************************************************
+* Tests
+*****************************************************************************/
+void test_base_point(void)
+{
+    uint8_t private_key[ECC_P256_PRIVATE_KEY_SIZE] = {0};
+    uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+    private_key[ECC_P256_PRIVATE_KEY_SIZE - 1] = 1;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_public_key_compute(private_key, public_key));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_base_point, public_key, ECC_P256_PUBLIC_KEY_SIZE);
+
+    /* (n - 1) * G = -G */
+    memcpy(private_key, m_order, sizeof(private_key));
+    private_key[ECC_P256_PRIVATE_KEY_SIZE - 1] -= 1;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_public_key_compute(private_key, public_key));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_base_point, public_key, ECC_P256_PUBLIC_KEY_SIZE / 2);
+    TEST_ASSERT_TRUE(ecc_p256_public_key_valid(public_key));
+}
+
+void test_public_key_compute(void)
+{
+    const struct uECC_Curve_t * p_curve = uECC_secp256r1();
+    for (uint32_t i = 0; i < TEST_ITERATIONS; ++i)
+    {
+        uint8_t private_key[ECC_P256_PRIVATE_KEY_SIZE];
+        uint8_t expected[ECC_P256_PUBLIC_KEY_SIZE];
+        uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+        TEST_ASSERT_EQUAL(1, uECC_make_key(expected, private_key, p_curve));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_public_key_compute(private_key, public_key));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, public_key, ECC_P256_PUBLIC_KEY_SIZE);
+        TEST_ASSERT_TRUE(ecc_p256_public_key_valid(public_key));
+    }
+}
+
+void test_shared_secret(void)
+{
+    const struct uECC_Curve_t * p_curve = uECC_secp256r1();
+    for (uint32_t i = 0; i < TEST_ITERATIONS; ++i)
+    {
+        uint8_t private_a[ECC_P256_PRIVATE_KEY_SIZE];
+        uint8_t public_a[ECC_P256_PUBLIC_KEY_SIZE];
+        uint8_t private_b[ECC_P256_PRIVATE_KEY_SIZE];
+        uint8_t public_b[ECC_P256_PUBLIC_KEY_SIZE];
+        TEST_ASSERT_EQUAL(1, uECC_make_key(public_a, private_a, p_curve));
+        TEST_ASSERT_EQUAL(1, uECC_make_key(public_b, private_b, p_curve));
+
+        uint8_t expected[ECC_P256_SHARED_SECRET_SIZE];
+        uint8_t secret_a[ECC_P256_SHARED_SECRET_SIZE];
+        uint8_t secret_b[ECC_P256_SHARED_SECRET_SIZE];
+        TEST_ASSERT_EQUAL(1, uECC_shared_secret(public_b, private_a, expected, p_curve));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_shared_secret(public_b, private_a, secret_a));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_shared_secret(public_a, private_b, secret_b));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, secret_a, ECC_P256_SHARED_SECRET_SIZE);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, secret_b, ECC_P256_SHARED_SECRET_SIZE);
+    }
+}
+
+void test_keys_generate(void)
+{
+    const struct uECC_Curve_t * p_curve = uECC_secp256r1();
+    uint8_t expected_public[ECC_P256_PUBLIC_KEY_SIZE];
+    uint8_t valid_key[ECC_P256_PRIVATE_KEY_SIZE];
+    TEST_ASSERT_EQUAL(1, uECC_make_key(expected_public, valid_key, p_curve));
+
+    /* The order itself is out of range, and should be rejected. */
+    mp_rand_keys[0] = m_order;
+    mp_rand_keys[1] = valid_key;
+
+    uint8_t private_key[ECC_P256_PRIVATE_KEY_SIZE];
+    uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_keys_generate(public_key, private_key));
+    TEST_ASSERT_EQUAL(2, m_rand_calls);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(valid_key, private_key, ECC_P256_PRIVATE_KEY_SIZE);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_public, public_key, ECC_P256_PUBLIC_KEY_SIZE);
+}
+
+void test_invalid_keys(void)
+{
+    uint8_t private_key[ECC_P256_PRIVATE_KEY_SIZE] = {0};
+    uint8_t public_key[ECC_P256_PUBLIC_KEY_SIZE];
+    uint8_t secret[ECC_P256_SHARED_SECRET_SIZE];
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, ecc_p256_public_key_compute(private_key, public_key));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, ecc_p256_public_key_compute(m_order, public_key));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, ecc_p256_shared_secret(m_base_point, private_key, secret));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, ecc_p256_shared_secret(m_base_point, m_order, secret));
+
+    private_key[ECC_P256_PRIVATE_KEY_SIZE - 1] = 2;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, ecc_p256_shared_secret(m_base_point, private_key, secret));
+
+    /* Off the curve */
+    memcpy(public_key, m_base_point, sizeof(public_key));
+    public_key[ECC_P256_PUBLIC_KEY_SIZE - 1] ^= 0x01;
+    TEST_ASSERT_FALSE(ecc_p256_public_key_valid(public_key));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, ecc_p256_shared_secret(public_key, private_key, secret));
+
+    /* Coordinates out of range */
+    memset(public_key, 0xFF, sizeof(public_key));
+    TEST_ASSERT_FALSE(ecc_p256_public_key_valid(public_key));
+
+    /* The identity has no affine representation, and the all-zero point isn't on the curve. */
+    memset(public_key, 0, sizeof(public_key));
+    TEST_ASSERT_FALSE(ecc_p256_public_key_valid(public_key));
+}
@@ -35,7 +35,11 @@
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <string.h>
+
 #include "event.h"
+#include "list.h"
+#include "nrf_error.h"
 
 #include "unity.h"
 #include "cmock.h"
@@ -113,11 +117,92 @@ static void event_cb5(const nrf_mesh_evt_t * p_evt)
     test_step++;
 }
 
+/* Generic handlers counting their calls, for the subscription tests. */
+#define COUNTING_HANDLER_COUNT (EVENT_HANDLER_INDEX_SIZE + 4)
+
+static nrf_mesh_evt_handler_t m_counting_handlers[COUNTING_HANDLER_COUNT];
+static uint32_t m_counting_calls[COUNTING_HANDLER_COUNT];
+static uint32_t m_call_order[COUNTING_HANDLER_COUNT * 2];
+static uint32_t m_call_order_count;
+static nrf_mesh_evt_handler_t * mp_handler_to_add;
+static nrf_mesh_evt_handler_t * mp_handler_to_remove;
+static bool m_dispatch_nested;
+
+/* Handlers beyond the first four only take up space in the index. */
+static void counting_cb(const nrf_mesh_evt_t * p_evt)
+{
+    (void) p_evt;
+}
+
+#define COUNTING_CB(N)                                                      \
+    static void counting_cb_##N(const nrf_mesh_evt_t * p_evt)               \
+    {                                                                       \
+        m_counting_calls[N]++;                                              \
+        m_call_order[m_call_order_count++] = N;                             \
+        if (mp_handler_to_add != NULL)                                      \
+        {                                                                   \
+            nrf_mesh_evt_handler_t * p_handler = mp_handler_to_add;         \
+            mp_handler_to_add = NULL;                                       \
+            event_handler_add(p_handler);                                   \
+        }                                                                   \
+        if (mp_handler_to_remove != NULL)                                   \
+        {                                                                   \
+            nrf_mesh_evt_handler_t * p_handler = mp_handler_to_remove;      \
+            mp_handler_to_remove = NULL;                                    \
+            event_handler_remove(p_handler);                                \
+        }                                                                   \
+        if (m_dispatch_nested)                                              \
+        {                                                                   \
+            m_dispatch_nested = false;                                      \
+            nrf_mesh_evt_t nested_evt = {.type = NRF_MESH_EVT_TX_COMPLETE}; \
+            event_handle(&nested_evt);                                      \
+        }                                                                   \
+    }
+
+COUNTING_CB(0)
+COUNTING_CB(1)
+COUNTING_CB(2)
+COUNTING_CB(3)
+
+static void counting_handlers_init(uint32_t count)
+{
+    static const nrf_mesh_evt_handler_cb_t cbs[] = {counting_cb_0, counting_cb_1, counting_cb_2, counting_cb_3};
+    memset(m_counting_handlers, 0, sizeof(m_counting_handlers));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        m_counting_handlers[i].evt_cb = (i < ARRAY_SIZE(cbs)) ? cbs[i] : counting_cb;
+    }
+}
+
+static void evt_send(nrf_mesh_evt_type_t type)
+{
+    nrf_mesh_evt_t evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = type;
+    event_handle(&evt);
+}
+
 void setUp(void)
-{}
+{
+    memset(m_counting_calls, 0, sizeof(m_counting_calls));
+    m_call_order_count = 0;
+    mp_handler_to_add = NULL;
+    mp_handler_to_remove = NULL;
+    m_dispatch_nested = false;
+    event_stats_clear();
+}
 
 void tearDown(void)
-{}
+{
+    for (uint32_t i = 0; i < COUNTING_HANDLER_COUNT; ++i)
+    {
+        if (m_counting_handlers[i].evt_cb != NULL)
+        {
+            event_handler_remove(&m_counting_handlers[i]);
+            m_counting_handlers[i].evt_cb = NULL;
+        }
+    }
+}
 
 void test_event_handling(void)
 {
@@ -136,4 +221,175 @@ void test_event_handling(void)
     event_handle(&event);
 
     TEST_ASSERT_TRUE(test_step == FINAL_VALUE);
+
+    event_handler_remove(&event_handler1);
+    event_handler_remove(&event_handler5);
+}
+
+void test_event_mask(void)
+{
+    counting_handlers_init(4);
+    m_counting_handlers[0].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    m_counting_handlers[1].evt_mask = NRF_MESH_EVT_MASK_ALL;
+    m_counting_handlers[2].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE) |
+                                      NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    m_counting_handlers[3].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_CONFIG_LOAD_FAILURE);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        event_handler_add(&m_counting_handlers[i]);
+    }
+
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(3, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(1, m_call_order[1]);
+    TEST_ASSERT_EQUAL(2, m_call_order[2]);
+
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_TX_COMPLETE);
+    TEST_ASSERT_EQUAL(2, m_call_order_count);
+    TEST_ASSERT_EQUAL(1, m_call_order[0]);
+    TEST_ASSERT_EQUAL(2, m_call_order[1]);
+
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_CONFIG_LOAD_FAILURE);
+    TEST_ASSERT_EQUAL(2, m_call_order_count);
+    TEST_ASSERT_EQUAL(1, m_call_order[0]);
+    TEST_ASSERT_EQUAL(3, m_call_order[1]);
+
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_FLASH_STABLE);
+    TEST_ASSERT_EQUAL(1, m_call_order_count);
+    TEST_ASSERT_EQUAL(1, m_call_order[0]);
+
+    /* Unknown event types only go to the handlers subscribing to all events. */
+    m_call_order_count = 0;
+    evt_send((nrf_mesh_evt_type_t) NRF_MESH_EVT_TYPE_COUNT);
+    TEST_ASSERT_EQUAL(1, m_call_order_count);
+    TEST_ASSERT_EQUAL(1, m_call_order[0]);
+
+    /* Removed handlers no longer get events. */
+    event_handler_remove(&m_counting_handlers[1]);
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(2, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(2, m_call_order[1]);
+}
+
+void test_add_remove_during_dispatch(void)
+{
+    counting_handlers_init(4);
+    m_counting_handlers[0].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    m_counting_handlers[1].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    m_counting_handlers[2].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE);
+    m_counting_handlers[3].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    event_handler_add(&m_counting_handlers[0]);
+    event_handler_add(&m_counting_handlers[1]);
+
+    /* Handler 0 adds handlers 2 and 3, and removes handler 1, before it gets the event. */
+    mp_handler_to_remove = &m_counting_handlers[1];
+    mp_handler_to_add = &m_counting_handlers[3];
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(2, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(3, m_call_order[1]);
+
+    /* The index has been rebuilt after the dispatch. */
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(2, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(3, m_call_order[1]);
+
+    /* A nested event is dispatched to the handlers added in the outer dispatch too. */
+    m_call_order_count = 0;
+    mp_handler_to_add = &m_counting_handlers[2];
+    m_dispatch_nested = true;
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(3, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(2, m_call_order[1]);
+    TEST_ASSERT_EQUAL(3, m_call_order[2]);
+
+    event_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_TX_COMPLETE, &stats));
+    TEST_ASSERT_EQUAL(1, stats.handler_count);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_MESSAGE_RECEIVED, &stats));
+    TEST_ASSERT_EQUAL(2, stats.handler_count);
+}
+
+void test_index_overflow(void)
+{
+    counting_handlers_init(COUNTING_HANDLER_COUNT);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        m_counting_handlers[i].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE) |
+                                          NRF_MESH_EVT_MASK(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    }
+    /* The rest subscribe to all events, and won't fit in the index. */
+    for (uint32_t i = 0; i < COUNTING_HANDLER_COUNT; ++i)
+    {
+        event_handler_add(&m_counting_handlers[i]);
+    }
+    m_counting_handlers[1].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE);
+    event_handler_remove(&m_counting_handlers[1]);
+    event_handler_add(&m_counting_handlers[1]);
+
+    evt_send(NRF_MESH_EVT_MESSAGE_RECEIVED);
+    TEST_ASSERT_EQUAL(3, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(2, m_call_order[1]);
+    TEST_ASSERT_EQUAL(3, m_call_order[2]);
+
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_TX_COMPLETE);
+    TEST_ASSERT_EQUAL(4, m_call_order_count);
+    TEST_ASSERT_EQUAL(1, m_call_order[3]);
+
+    event_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_TX_COMPLETE, &stats));
+    TEST_ASSERT_EQUAL(COUNTING_HANDLER_COUNT, stats.handler_count);
+
+    /* Back in the index once the subscriptions fit again. */
+    for (uint32_t i = 4; i < COUNTING_HANDLER_COUNT; ++i)
+    {
+        event_handler_remove(&m_counting_handlers[i]);
+        m_counting_handlers[i].evt_cb = NULL;
+    }
+    m_call_order_count = 0;
+    evt_send(NRF_MESH_EVT_TX_COMPLETE);
+    TEST_ASSERT_EQUAL(4, m_call_order_count);
+    TEST_ASSERT_EQUAL(0, m_call_order[0]);
+    TEST_ASSERT_EQUAL(2, m_call_order[1]);
+    TEST_ASSERT_EQUAL(3, m_call_order[2]);
+    TEST_ASSERT_EQUAL(1, m_call_order[3]);
+}
+
+void test_stats(void)
+{
+    event_stats_t stats;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, event_stats_get(NRF_MESH_EVT_TX_COMPLETE, NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM,
+                      event_stats_get((nrf_mesh_evt_type_t) NRF_MESH_EVT_TYPE_COUNT, &stats));
+
+    counting_handlers_init(1);
+    m_counting_handlers[0].evt_mask = NRF_MESH_EVT_MASK(NRF_MESH_EVT_TX_COMPLETE);
+    event_handler_add(&m_counting_handlers[0]);
+
+    evt_send(NRF_MESH_EVT_TX_COMPLETE);
+    evt_send(NRF_MESH_EVT_TX_COMPLETE);
+    evt_send(NRF_MESH_EVT_FLASH_STABLE);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_TX_COMPLETE, &stats));
+    TEST_ASSERT_EQUAL(2, stats.dispatch_count);
+    TEST_ASSERT_EQUAL(1, stats.handler_count);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_FLASH_STABLE, &stats));
+    TEST_ASSERT_EQUAL(1, stats.dispatch_count);
+    TEST_ASSERT_EQUAL(0, stats.handler_count);
+
+    event_stats_clear();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_stats_get(NRF_MESH_EVT_TX_COMPLETE, &stats));
+    TEST_ASSERT_EQUAL(0, stats.dispatch_count);
+    TEST_ASSERT_EQUAL(1, stats.handler_count);
 }
@@ -0,0 +1,288 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "fsm.h"
+#include "fsm_assistant.h"
+#include "test_assert.h"
+#include "utils.h"
+
+#define EVENT_LIST E_START,                     \
+                   E_STOP,                      \
+                   E_TICK,                      \
+                   E_RESET
+
+#define STATE_LIST  S_IDLE,                     \
+                    S_RUNNING,                  \
+                    S_STOPPED
+
+#define ACTION_LIST A_START,                a_start,               \
+                    A_TICK,                 a_tick,                \
+                    A_RESET,                a_reset
+
+#define GUARD_LIST  G_CAN_START,            g_can_start
+
+typedef enum
+{
+    DECLARE_ENUM(EVENT_LIST)
+} test_event_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM(STATE_LIST)
+} test_state_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM_PAIR(ACTION_LIST)
+} test_action_ids_t;
+
+typedef enum
+{
+    DECLARE_ENUM_PAIR(GUARD_LIST)
+} test_guard_ids_t;
+
+typedef void (* test_fsm_action_t)(void *);
+typedef bool (* test_fsm_guard_t)(void *);
+
+/* Not having a semi-colon is intentional. */
+DECLARE_ACTION_PROTOTYPE(ACTION_LIST)
+DECLARE_GUARD_PROTOTYPE(GUARD_LIST)
+
+static void test_fsm_action(fsm_action_id_t action_id, void * p_data);
+static bool test_fsm_guard(fsm_guard_id_t guard_id, void * p_data);
+
+static const fsm_transition_t m_test_fsm_transition_table[] =
+{
+    FSM_STATE(S_IDLE),
+    FSM_TRANSITION(E_START,          G_CAN_START,            A_START,               S_RUNNING),
+    FSM_TRANSITION(E_START,          FSM_OTHERWISE,          FSM_NO_ACTION,         S_STOPPED),
+
+    FSM_STATE(S_RUNNING),
+    FSM_TRANSITION(E_TICK,           FSM_ALWAYS,             A_TICK,                FSM_SAME_STATE),
+    FSM_TRANSITION(E_STOP,           FSM_ALWAYS,             FSM_NO_ACTION,         S_STOPPED),
+
+    FSM_STATE(S_STOPPED),
+
+    FSM_STATE(FSM_ANY_STATE),
+    FSM_TRANSITION(E_RESET,          FSM_ALWAYS,             A_RESET,               S_IDLE),
+};
+
+static const char * m_action_lookup_table[] =
+{
+    DECLARE_STRING_PAIR(ACTION_LIST)
+};
+
+static const char * m_guard_lookup_table[] =
+{
+    DECLARE_STRING_PAIR(GUARD_LIST)
+};
+
+static const char * m_event_lookup_table[] =
+{
+    DECLARE_STRING(EVENT_LIST)
+};
+
+static const char * m_state_lookup_table[] =
+{
+    DECLARE_STRING(STATE_LIST)
+};
+
+static uint8_t m_test_fsm_state_index_table[VA_NARGS(STATE_LIST)];
+
+static const fsm_const_descriptor_t m_indexed_descriptor =
+{
+    .transition_table = m_test_fsm_transition_table,
+    .transitions_count = ARRAY_SIZE(m_test_fsm_transition_table),
+    .initial_state = S_IDLE,
+    .guard = test_fsm_guard,
+    .action = test_fsm_action,
+    .state_index_table = m_test_fsm_state_index_table,
+    .states_count = ARRAY_SIZE(m_test_fsm_state_index_table),
+    .fsm_name = "test-fsm",
+    .action_lookup = m_action_lookup_table,
+    .event_lookup = m_event_lookup_table,
+    .guard_lookup = m_guard_lookup_table,
+    .state_lookup = m_state_lookup_table
+};
+
+static const fsm_const_descriptor_t m_unindexed_descriptor =
+{
+    .transition_table = m_test_fsm_transition_table,
+    .transitions_count = ARRAY_SIZE(m_test_fsm_transition_table),
+    .initial_state = S_IDLE,
+    .guard = test_fsm_guard,
+    .action = test_fsm_action,
+    .state_index_table = NULL,
+    .states_count = 0,
+    .fsm_name = "test-fsm",
+    .action_lookup = m_action_lookup_table,
+    .event_lookup = m_event_lookup_table,
+    .guard_lookup = m_guard_lookup_table,
+    .state_lookup = m_state_lookup_table
+};
+
+static const test_fsm_action_t test_fsm_actions[] =
+{
+    DECLARE_HANDLER(ACTION_LIST)
+};
+
+static const test_fsm_guard_t test_fsm_guards[] =
+{
+    DECLARE_HANDLER(GUARD_LIST)
+};
+
+static bool m_can_start;
+static uint32_t m_action_count[ARRAY_SIZE(test_fsm_actions)];
+
+static void test_fsm_action(fsm_action_id_t action_id, void * p_data)
+{
+    m_action_count[action_id]++;
+    test_fsm_actions[action_id](p_data);
+}
+
+static bool test_fsm_guard(fsm_guard_id_t guard_id, void * p_data)
+{
+    return test_fsm_guards[guard_id](p_data);
+}
+
+static void a_start(void * p_data)
+{
+}
+
+static void a_tick(void * p_data)
+{
+}
+
+static void a_reset(void * p_data)
+{
+}
+
+static bool g_can_start(void * p_data)
+{
+    return m_can_start;
+}
+
+void setUp(void)
+{
+    m_can_start = true;
+    memset(m_action_count, 0, sizeof(m_action_count));
+    memset(m_test_fsm_state_index_table, 0, sizeof(m_test_fsm_state_index_table));
+}
+
+void tearDown(void)
+{
+}
+
+static void run_sequence(const fsm_const_descriptor_t * p_descriptor)
+{
+    fsm_t fsm;
+    fsm_init(&fsm, p_descriptor);
+    TEST_ASSERT_EQUAL(S_IDLE, fsm.current_state);
+
+    /* Events that aren't handled in the current state are ignored: */
+    fsm_event_post(&fsm, E_TICK, NULL);
+    TEST_ASSERT_EQUAL(S_IDLE, fsm.current_state);
+    TEST_ASSERT_EQUAL(0, m_action_count[A_TICK]);
+
+    fsm_event_post(&fsm, E_START, NULL);
+    TEST_ASSERT_EQUAL(S_RUNNING, fsm.current_state);
+    TEST_ASSERT_EQUAL(1, m_action_count[A_START]);
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        fsm_event_post(&fsm, E_TICK, NULL);
+        TEST_ASSERT_EQUAL(S_RUNNING, fsm.current_state);
+    }
+    TEST_ASSERT_EQUAL(10, m_action_count[A_TICK]);
+
+    fsm_event_post(&fsm, E_STOP, NULL);
+    TEST_ASSERT_EQUAL(S_STOPPED, fsm.current_state);
+
+    /* S_STOPPED has no transitions of its own, but the "any state" transitions apply: */
+    fsm_event_post(&fsm, E_START, NULL);
+    TEST_ASSERT_EQUAL(S_STOPPED, fsm.current_state);
+    fsm_event_post(&fsm, E_RESET, NULL);
+    TEST_ASSERT_EQUAL(S_IDLE, fsm.current_state);
+    TEST_ASSERT_EQUAL(1, m_action_count[A_RESET]);
+
+    /* Failing guard falls through to the next transition for the same event: */
+    m_can_start = false;
+    fsm_event_post(&fsm, E_START, NULL);
+    TEST_ASSERT_EQUAL(S_STOPPED, fsm.current_state);
+    TEST_ASSERT_EQUAL(1, m_action_count[A_START]);
+
+    TEST_ASSERT_FALSE(fsm_is_processing(&fsm));
+}
+
+/*****************************************************************************
+* Tests
+*****************************************************************************/
+void test_dispatch_unindexed(void)
+{
+    run_sequence(&m_unindexed_descriptor);
+}
+
+void test_dispatch_indexed(void)
+{
+    run_sequence(&m_indexed_descriptor);
+}
+
+void test_index_table(void)
+{
+    fsm_t fsm;
+    fsm_init(&fsm, &m_indexed_descriptor);
+
+    TEST_ASSERT_EQUAL(0, m_test_fsm_state_index_table[S_IDLE]);
+    TEST_ASSERT_EQUAL(3, m_test_fsm_state_index_table[S_RUNNING]);
+    TEST_ASSERT_EQUAL(6, m_test_fsm_state_index_table[S_STOPPED]);
+    TEST_ASSERT_EQUAL(7, fsm.any_state_transitions_index);
+    TEST_ASSERT_EQUAL(0, fsm.current_state_index);
+}
+
+void test_index_table_too_small(void)
+{
+    fsm_t fsm;
+    fsm_const_descriptor_t descriptor = m_indexed_descriptor;
+    descriptor.states_count = S_STOPPED;
+
+    TEST_NRF_MESH_ASSERT_EXPECT(fsm_init(&fsm, &descriptor));
+}
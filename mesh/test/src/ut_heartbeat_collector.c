@@ -0,0 +1,301 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "heartbeat_collector.h"
+#include "timer_scheduler.h"
+#include "test_assert.h"
+#include "utils.h"
+#include "nordic_common.h"
+
+static timestamp_t m_now;
+static timer_event_t * mp_timer;
+
+/* ******************* Fakes ******************* */
+
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    mp_timer = p_timer_evt;
+}
+
+/* ******************* Helpers ******************* */
+
+static void scanner_rx(uint16_t src, uint8_t hops, int8_t rssi)
+{
+    nrf_mesh_rx_metadata_t rx_metadata;
+    memset(&rx_metadata, 0, sizeof(rx_metadata));
+    rx_metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
+    rx_metadata.params.scanner.rssi = rssi;
+    heartbeat_collector_rx(src, hops, 0x0001, &rx_metadata);
+}
+
+/* Advances time, firing the clock timer like the scheduler would. */
+static void time_advance(uint64_t time_us)
+{
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    while (time_us > 0)
+    {
+        uint32_t time_to_timer = mp_timer->timestamp - m_now;
+        if (time_to_timer <= time_us)
+        {
+            m_now = mp_timer->timestamp;
+            time_us -= time_to_timer;
+            mp_timer->timestamp += mp_timer->interval;
+            mp_timer->cb(m_now, mp_timer->p_context);
+        }
+        else
+        {
+            m_now += time_us;
+            time_us = 0;
+        }
+    }
+}
+
+void setUp(void)
+{
+    m_now = 0x12345678;
+    mp_timer = NULL;
+    heartbeat_collector_init();
+}
+
+void tearDown(void)
+{
+}
+
+/* ******************* Tests ******************* */
+
+void test_empty(void)
+{
+    heartbeat_collector_entry_t entry;
+    TEST_ASSERT_EQUAL(0, heartbeat_collector_count_get());
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, heartbeat_collector_entry_get(0, &entry));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(0, heartbeat_collector_stats_get()->received);
+}
+
+void test_sorted_by_source(void)
+{
+    const uint16_t sources[] = {0x0300, 0x0010, 0x7FFF, 0x0001, 0x0200};
+    const uint16_t sorted[] = {0x0001, 0x0010, 0x0200, 0x0300, 0x7FFF};
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(sources); ++i)
+    {
+        scanner_rx(sources[i], 1, -50);
+    }
+
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sources), heartbeat_collector_count_get());
+    for (uint32_t i = 0; i < ARRAY_SIZE(sorted); ++i)
+    {
+        heartbeat_collector_entry_t entry;
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_entry_get(i, &entry));
+        TEST_ASSERT_EQUAL_HEX16(sorted[i], entry.src);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(sorted[i], &entry));
+        TEST_ASSERT_EQUAL_HEX16(sorted[i], entry.src);
+    }
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(sources), heartbeat_collector_stats_get()->received);
+}
+
+void test_hops_and_features(void)
+{
+    nrf_mesh_rx_metadata_t rx_metadata;
+    memset(&rx_metadata, 0, sizeof(rx_metadata));
+    rx_metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
+
+    heartbeat_collector_rx(0x0042, 3, 0x0001, &rx_metadata);
+    heartbeat_collector_rx(0x0042, 1, 0x0003, &rx_metadata);
+    heartbeat_collector_rx(0x0042, 5, 0x0007, &rx_metadata);
+    heartbeat_collector_rx(0x0042, 2, 0x0002, &rx_metadata);
+
+    heartbeat_collector_entry_t entry;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0042, &entry));
+    TEST_ASSERT_EQUAL(1, heartbeat_collector_count_get());
+    TEST_ASSERT_EQUAL(4, entry.count);
+    TEST_ASSERT_EQUAL(1, entry.min_hops);
+    TEST_ASSERT_EQUAL(5, entry.max_hops);
+    TEST_ASSERT_EQUAL(2, entry.last_hops);
+    TEST_ASSERT_EQUAL_HEX16(0x0002, entry.features);
+}
+
+void test_count_saturates(void)
+{
+    for (uint32_t i = 0; i < UINT16_MAX + 10; ++i)
+    {
+        scanner_rx(0x0001, 1, -50);
+    }
+    heartbeat_collector_entry_t entry;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(UINT16_MAX, entry.count);
+    TEST_ASSERT_EQUAL(UINT16_MAX, entry.rssi_count);
+}
+
+void test_rssi(void)
+{
+    heartbeat_collector_entry_t entry;
+
+    /* Heartbeats that didn't come from the scanner have no RSSI */
+    nrf_mesh_rx_metadata_t rx_metadata;
+    memset(&rx_metadata, 0, sizeof(rx_metadata));
+    rx_metadata.source = NRF_MESH_RX_SOURCE_GATT;
+    heartbeat_collector_rx(0x0001, 1, 0, &rx_metadata);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(1, entry.count);
+    TEST_ASSERT_EQUAL(0, entry.rssi_count);
+
+    scanner_rx(0x0001, 1, -60);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(1, entry.rssi_count);
+    TEST_ASSERT_EQUAL(-60, entry.rssi_last);
+    TEST_ASSERT_EQUAL(-60, entry.rssi_min);
+    TEST_ASSERT_EQUAL(-60, entry.rssi_max);
+    TEST_ASSERT_EQUAL(-60, entry.rssi_avg);
+
+    scanner_rx(0x0001, 1, -40);
+    scanner_rx(0x0001, 1, -80);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(3, entry.rssi_count);
+    TEST_ASSERT_EQUAL(-80, entry.rssi_last);
+    TEST_ASSERT_EQUAL(-80, entry.rssi_min);
+    TEST_ASSERT_EQUAL(-40, entry.rssi_max);
+    TEST_ASSERT_INT_WITHIN(2, -60, entry.rssi_avg);
+
+    /* The average converges to a steady RSSI */
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        scanner_rx(0x0001, 1, -70);
+    }
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_INT_WITHIN(1, -70, entry.rssi_avg);
+    TEST_ASSERT_EQUAL(-80, entry.rssi_min);
+    TEST_ASSERT_EQUAL(-40, entry.rssi_max);
+}
+
+void test_age(void)
+{
+    heartbeat_collector_entry_t entry;
+    scanner_rx(0x0001, 1, -50);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(0, entry.age_s);
+
+    time_advance(SEC_TO_US(10) + 500000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(10, entry.age_s);
+
+    /* Fractions of seconds are carried over */
+    time_advance(500000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(11, entry.age_s);
+
+    scanner_rx(0x0001, 1, -50);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(0, entry.age_s);
+
+    /* Well beyond the wrap-around of the microsecond timer */
+    time_advance(SEC_TO_US(3 * 3600ull));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(3 * 3600, entry.age_s);
+}
+
+void test_evict_oldest(void)
+{
+    /* Fill the table, with source 3 heard first */
+    scanner_rx(3, 1, -50);
+    for (uint16_t src = 0; src < HEARTBEAT_COLLECTOR_ENTRIES; ++src)
+    {
+        time_advance(SEC_TO_US(1));
+        if (src != 3)
+        {
+            scanner_rx(src, 1, -50);
+        }
+    }
+    TEST_ASSERT_EQUAL(HEARTBEAT_COLLECTOR_ENTRIES, heartbeat_collector_count_get());
+    TEST_ASSERT_EQUAL(0, heartbeat_collector_stats_get()->evicted);
+
+    /* Hearing source 0 again makes source 1 the oldest after source 3 */
+    scanner_rx(0, 1, -50);
+
+    heartbeat_collector_entry_t entry;
+    time_advance(SEC_TO_US(1));
+    scanner_rx(0x1000, 1, -50);
+    TEST_ASSERT_EQUAL(HEARTBEAT_COLLECTOR_ENTRIES, heartbeat_collector_count_get());
+    TEST_ASSERT_EQUAL(1, heartbeat_collector_stats_get()->evicted);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, heartbeat_collector_lookup(3, &entry));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x1000, &entry));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_entry_get(HEARTBEAT_COLLECTOR_ENTRIES - 1, &entry));
+    TEST_ASSERT_EQUAL_HEX16(0x1000, entry.src);
+
+    scanner_rx(0x0800, 1, -50);
+    TEST_ASSERT_EQUAL(2, heartbeat_collector_stats_get()->evicted);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, heartbeat_collector_lookup(1, &entry));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0, &entry));
+
+    /* The entries stay sorted */
+    uint16_t prev_src = 0;
+    for (uint16_t i = 0; i < heartbeat_collector_count_get(); ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_entry_get(i, &entry));
+        TEST_ASSERT_TRUE(i == 0 || entry.src > prev_src);
+        prev_src = entry.src;
+    }
+}
+
+void test_clear(void)
+{
+    scanner_rx(0x0001, 1, -50);
+    scanner_rx(0x0002, 1, -50);
+    TEST_ASSERT_EQUAL(2, heartbeat_collector_count_get());
+
+    heartbeat_collector_clear();
+    heartbeat_collector_entry_t entry;
+    TEST_ASSERT_EQUAL(0, heartbeat_collector_count_get());
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, heartbeat_collector_lookup(0x0001, &entry));
+    TEST_ASSERT_EQUAL(0, heartbeat_collector_stats_get()->received);
+
+    scanner_rx(0x0002, 4, -50);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, heartbeat_collector_lookup(0x0002, &entry));
+    TEST_ASSERT_EQUAL(1, entry.count);
+    TEST_ASSERT_EQUAL(4, entry.min_hops);
+}
@@ -0,0 +1,122 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "instr.h"
+#include "nrf_error.h"
+#include "test_assert.h"
+
+void setUp(void)
+{
+    instr_init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_stage_record(void)
+{
+    const instr_histogram_t * p_histogram = instr_histogram_get(INSTR_STAGE_NET_DECRYPT);
+    TEST_ASSERT_NOT_NULL(p_histogram);
+    TEST_ASSERT_EQUAL(0, p_histogram->count);
+
+    /* Durations well above the time it takes to record them, in different buckets. */
+    instr_stage_record(INSTR_STAGE_NET_DECRYPT, instr_timestamp_get() - (1 << 20));
+    instr_stage_record(INSTR_STAGE_NET_DECRYPT, instr_timestamp_get() - (1 << 20));
+    instr_stage_record(INSTR_STAGE_NET_DECRYPT, instr_timestamp_get() - (1 << 22));
+    /* Long durations end up in the last bucket. */
+    instr_stage_record(INSTR_STAGE_NET_DECRYPT, instr_timestamp_get() - 0xF0000000);
+
+    TEST_ASSERT_EQUAL(4, p_histogram->count);
+    TEST_ASSERT_EQUAL(2, p_histogram->buckets[20]);
+    TEST_ASSERT_EQUAL(1, p_histogram->buckets[22]);
+    TEST_ASSERT_EQUAL(1, p_histogram->buckets[INSTR_HISTOGRAM_BUCKET_COUNT - 1]);
+    TEST_ASSERT_TRUE(p_histogram->max >= 0xF0000000);
+    TEST_ASSERT_TRUE(p_histogram->total >= 0xF0000000ULL + (1 << 21) + (1 << 22));
+
+    /* Other stages are unaffected. */
+    TEST_ASSERT_EQUAL(0, instr_histogram_get(INSTR_STAGE_ACCESS)->count);
+    TEST_ASSERT_NULL(instr_histogram_get(INSTR_STAGE_COUNT));
+
+    instr_clear();
+    TEST_ASSERT_EQUAL(0, p_histogram->count);
+    TEST_ASSERT_EQUAL(0, p_histogram->buckets[20]);
+
+    TEST_NRF_MESH_ASSERT_EXPECT(instr_stage_record(INSTR_STAGE_COUNT, 0));
+}
+
+void test_stage_macros(void)
+{
+    INSTR_STAGE_BEGIN(start);
+    INSTR_STAGE_END(INSTR_STAGE_TRANSPORT, start);
+    TEST_ASSERT_EQUAL(1, instr_histogram_get(INSTR_STAGE_TRANSPORT)->count);
+}
+
+void test_opt(void)
+{
+    instr_histogram_t histogram;
+    nrf_mesh_opt_t opt;
+    opt.len = sizeof(histogram);
+    opt.opt.p_array = (uint8_t *) &histogram;
+
+    instr_stage_record(INSTR_STAGE_ADV_TX, instr_timestamp_get() - (1 << 20));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, instr_opt_get(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX, &opt));
+    TEST_ASSERT_EQUAL(sizeof(histogram), opt.len);
+    TEST_ASSERT_EQUAL_MEMORY(instr_histogram_get(INSTR_STAGE_ADV_TX), &histogram, sizeof(histogram));
+    TEST_ASSERT_EQUAL(1, histogram.count);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, instr_opt_get(NRF_MESH_OPT_INSTR_HISTOGRAM_SCANNER_RX, &opt));
+    TEST_ASSERT_EQUAL(0, histogram.count);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, instr_opt_get(NRF_MESH_OPT_INSTR_CLEAR, &opt));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, instr_opt_get((nrf_mesh_opt_id_t) (NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX + 1), &opt));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, instr_opt_get(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX, NULL));
+    opt.len = sizeof(histogram) - 1;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_LENGTH, instr_opt_get(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX, &opt));
+    opt.opt.p_array = NULL;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, instr_opt_get(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX, &opt));
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, instr_opt_set(NRF_MESH_OPT_INSTR_HISTOGRAM_ADV_TX, &opt));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, instr_opt_set(NRF_MESH_OPT_INSTR_CLEAR, NULL));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, instr_opt_set(NRF_MESH_OPT_INSTR_CLEAR, &opt));
+    TEST_ASSERT_EQUAL(0, instr_histogram_get(INSTR_STAGE_ADV_TX)->count);
+}
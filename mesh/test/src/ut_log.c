@@ -0,0 +1,203 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "log.h"
+#include "test_assert.h"
+#include "utils.h"
+
+#define TEST_LINE       (123)
+#define TEST_TIMESTAMP  (0x12345678)
+
+typedef struct
+{
+    log_deferred_header_t header;
+    uint32_t args[LOG_DEFERRED_ARGS_SIZE_MAX / sizeof(uint32_t)];
+} test_record_t;
+
+static char m_formatted[256];
+
+static void log_callback_format(uint32_t dbg_level, const char * p_filename, uint16_t line,
+    uint32_t timestamp, const char * format, va_list arguments)
+{
+    (void) vsnprintf(m_formatted, sizeof(m_formatted), format, arguments);
+}
+
+static uint32_t record_read(test_record_t * p_record)
+{
+    return log_deferred_read((uint8_t *) p_record, sizeof(test_record_t));
+}
+
+void setUp(void)
+{
+    log_init(LOG_SRC_TEST, LOG_LEVEL_DBG3, log_callback_deferred);
+    memset(m_formatted, 0, sizeof(m_formatted));
+}
+
+void tearDown(void)
+{
+}
+
+void test_deferred_record(void)
+{
+    static const char * p_format = "%d %5s %llx %c %*u %%\n";
+    log_printf(LOG_LEVEL_INFO, __FILENAME__, TEST_LINE, TEST_TIMESTAMP, p_format,
+               -2, "abcde", 0x1122334455667788ULL, 'x', 4, 7);
+
+    test_record_t record;
+    uint32_t length = record_read(&record);
+    TEST_ASSERT_EQUAL((sizeof(log_deferred_header_t) + 9 * sizeof(uint32_t)), length);
+    TEST_ASSERT_EQUAL((uint32_t) (uintptr_t) p_format, record.header.format);
+    TEST_ASSERT_EQUAL((uint32_t) (uintptr_t) __FILENAME__, record.header.filename);
+    TEST_ASSERT_EQUAL(TEST_TIMESTAMP, record.header.timestamp);
+    TEST_ASSERT_EQUAL(TEST_LINE, record.header.line);
+    TEST_ASSERT_EQUAL(LOG_LEVEL_INFO, record.header.flags_level);
+    TEST_ASSERT_EQUAL(9, record.header.args_length);
+
+    TEST_ASSERT_EQUAL(-2, (int32_t) record.args[0]);
+    TEST_ASSERT_EQUAL(5, record.args[1]);
+    TEST_ASSERT_EQUAL_MEMORY("abcde", &record.args[2], 5);
+    TEST_ASSERT_EQUAL(0x55667788, record.args[4]);
+    TEST_ASSERT_EQUAL(0x11223344, record.args[5]);
+    TEST_ASSERT_EQUAL('x', record.args[6]);
+    TEST_ASSERT_EQUAL(4, record.args[7]);
+    TEST_ASSERT_EQUAL(7, record.args[8]);
+    TEST_ASSERT_EQUAL(0, record_read(&record));
+    TEST_ASSERT_EQUAL(1, log_deferred_stats_get()->records_written);
+    TEST_ASSERT_EQUAL(0, log_deferred_stats_get()->records_truncated);
+}
+
+void test_deferred_args(void)
+{
+    /* NULL strings are stored the way the formatting callbacks print them. */
+    const char * volatile p_null = NULL; /* Keeps the compiler from warning about the NULL argument. */
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "%s %s\n", p_null, "");
+
+    test_record_t record;
+    TEST_ASSERT_EQUAL(sizeof(log_deferred_header_t) + 4 * sizeof(uint32_t), record_read(&record));
+    TEST_ASSERT_EQUAL(6, record.args[0]);
+    TEST_ASSERT_EQUAL_MEMORY("(null)", &record.args[1], 6);
+    TEST_ASSERT_EQUAL(0, record.args[3]);
+
+    /* Long doubles are stored as doubles, with the arguments after them intact. */
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "%Lf %u\n", (long double) 1.5, 7);
+
+    const double value = 1.5;
+    TEST_ASSERT_EQUAL(sizeof(log_deferred_header_t) + 3 * sizeof(uint32_t), record_read(&record));
+    TEST_ASSERT_EQUAL_MEMORY(&value, &record.args[0], sizeof(value));
+    TEST_ASSERT_EQUAL(7, record.args[2]);
+}
+
+void test_deferred_truncate(void)
+{
+    char long_string[LOG_DEFERRED_ARGS_SIZE_MAX * 2];
+    memset(long_string, 'a', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = 0;
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%u %s %u\n", 1, long_string, 2);
+
+    test_record_t record;
+    TEST_ASSERT_EQUAL(sizeof(test_record_t), record_read(&record));
+    TEST_ASSERT_EQUAL(LOG_LEVEL_ERROR | LOG_DEFERRED_FLAG_TRUNCATED, record.header.flags_level);
+    TEST_ASSERT_EQUAL(ARRAY_SIZE(record.args), record.header.args_length);
+    TEST_ASSERT_EQUAL(1, record.args[0]);
+    TEST_ASSERT_EQUAL(LOG_DEFERRED_ARGS_SIZE_MAX - 2 * sizeof(uint32_t), record.args[1]);
+    TEST_ASSERT_EQUAL(1, log_deferred_stats_get()->records_truncated);
+}
+
+void test_deferred_array(void)
+{
+    static const char * p_msg = "Array";
+    const uint8_t array[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    __LOG_XB(LOG_SRC_TEST, LOG_LEVEL_WARN, p_msg, array, sizeof(array));
+
+    test_record_t record;
+    TEST_ASSERT_EQUAL(sizeof(log_deferred_header_t) + 3 * sizeof(uint32_t), record_read(&record));
+    TEST_ASSERT_EQUAL(LOG_LEVEL_WARN | LOG_DEFERRED_FLAG_ARRAY, record.header.flags_level);
+    TEST_ASSERT_EQUAL((uint32_t) (uintptr_t) p_msg, record.header.format);
+    TEST_ASSERT_EQUAL(sizeof(array), record.args[0]);
+    TEST_ASSERT_EQUAL_MEMORY(array, &record.args[1], sizeof(array));
+
+    /* Arrays are formatted as before when another callback is used. */
+    log_set_callback(log_callback_format);
+    __LOG_XB(LOG_SRC_TEST, LOG_LEVEL_WARN, p_msg, array, sizeof(array));
+    TEST_ASSERT_EQUAL_STRING("Array: 0102030405\n", m_formatted);
+    TEST_ASSERT_EQUAL(0, record_read(&record));
+}
+
+void test_deferred_full(void)
+{
+    const uint32_t record_size = sizeof(log_deferred_header_t) + sizeof(uint32_t);
+    const uint32_t records_max = LOG_DEFERRED_BUFFER_SIZE / record_size;
+    for (uint32_t i = 0; i < records_max + 2; ++i)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "%u\n", i);
+    }
+    TEST_ASSERT_EQUAL(records_max, log_deferred_stats_get()->records_written);
+    TEST_ASSERT_EQUAL(2, log_deferred_stats_get()->records_dropped);
+
+    /* Only whole records are read, in order. */
+    uint32_t buffer[(record_size * 2) / sizeof(uint32_t) + 1];
+    TEST_ASSERT_EQUAL(record_size * 2, log_deferred_read((uint8_t *) buffer, record_size * 2 + 1));
+    TEST_ASSERT_EQUAL(0, buffer[4]);
+    TEST_ASSERT_EQUAL(1, buffer[9]);
+
+    /* Filtered messages are not stored. */
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_DBG3 + 1, "%u\n", 0);
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "%u\n", 0);
+    TEST_ASSERT_EQUAL(records_max, log_deferred_stats_get()->records_written);
+
+    /* The buffer wraps around. */
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "%u\n", records_max + i);
+    }
+    TEST_ASSERT_EQUAL(records_max + 2, log_deferred_stats_get()->records_written);
+    for (uint32_t i = 2; i < records_max + 2; ++i)
+    {
+        test_record_t record;
+        TEST_ASSERT_EQUAL(record_size, log_deferred_read((uint8_t *) &record, record_size));
+        TEST_ASSERT_EQUAL(i, record.args[0]);
+    }
+    test_record_t record;
+    TEST_ASSERT_EQUAL(0, record_read(&record));
+}
@@ -87,6 +87,9 @@ static bool m_tx_complete_evt_expect;
 static bool m_connected_evt_expect;
 static bool m_disconnected_evt_expect;
 static bool m_tx_ready_evt_expect;
+static uint8_t * mp_ref_released[4];
+static uint32_t m_ref_release_count;
+static const uint8_t * mp_hvx_data;
 
 /*******************************************************************************
  * Helper functions / macros
@@ -235,9 +238,17 @@ static void disconnect(uint16_t conn_handle)
 static uint32_t sd_ble_gatts_hvx_cb(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params, int num_calls)
 {
     expected_pdu_check(p_hvx_params->p_data, *p_hvx_params->p_len);
+    mp_hvx_data = p_hvx_params->p_data;
     return NRF_SUCCESS;
 }
 
+static void ref_release_cb(uint16_t conn_index, uint8_t * p_data)
+{
+    TEST_ASSERT_EQUAL(0, conn_index);
+    TEST_ASSERT_TRUE(m_ref_release_count < ARRAY_SIZE(mp_ref_released));
+    mp_ref_released[m_ref_release_count++] = p_data;
+}
+
 static void m_gatt_evt_handler(const mesh_gatt_evt_t * p_evt, void * p_context)
 {
     switch (p_evt->type)
@@ -290,6 +301,8 @@ static void m_gatt_evt_handler(const mesh_gatt_evt_t * p_evt, void * p_context)
 void setUp(void)
 {
     packet_buffer_init(&m_pdu_buffer, m_pdu_buffer_raw, sizeof(m_pdu_buffer_raw));
+    m_ref_release_count = 0;
+    mp_hvx_data = NULL;
     timer_mock_Init();
     timer_scheduler_mock_Init();
     ble_gatts_mock_Init();
@@ -651,3 +664,102 @@ void test_disconnect_on_too_long_message(void)
                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
 }
+
+void test_send_ref_single_segment(void)
+{
+    test_gatt_init();
+
+    connected_evt_expect();
+    connect(0);
+
+    /* The byte in front of the payload is reserved for the header: */
+    uint8_t buffer[] = {0x00, 0xca, 0xfe, 0xba, 0xbe};
+    uint8_t * p_data = &buffer[1];
+
+    uint8_t * p_packet = mesh_gatt_packet_ref_alloc(0, MESH_GATT_PDU_TYPE_NETWORK_PDU, TX_TOKEN);
+    TEST_ASSERT_NOT_NULL(p_packet);
+
+    sd_ble_gatts_hvx_StubWithCallback(sd_ble_gatts_hvx_cb);
+
+    EXPECT_PDU({MESH_GATT_PDU_TYPE_NETWORK_PDU, 0xca, 0xfe, 0xba, 0xbe});
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_gatt_packet_ref_send(0, p_packet, p_data, 4, ref_release_cb));
+    /* Sent straight from the referenced buffer: */
+    TEST_ASSERT_EQUAL_PTR(&buffer[0], mp_hvx_data);
+    TEST_ASSERT_EQUAL(0, m_ref_release_count);
+
+    tx_complete_evt_expect();
+    tx_complete_evt_send();
+    TEST_ASSERT_EQUAL(1, m_ref_release_count);
+    TEST_ASSERT_EQUAL_PTR(p_data, mp_ref_released[0]);
+
+    /* Not connected: */
+    disconnected_evt_expect();
+    disconnect(0);
+    TEST_ASSERT_NULL(mesh_gatt_packet_ref_alloc(0, MESH_GATT_PDU_TYPE_NETWORK_PDU, TX_TOKEN));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, mesh_gatt_packet_ref_send(0, p_packet, p_data, 4, ref_release_cb));
+    TEST_ASSERT_EQUAL(1, m_ref_release_count);
+}
+
+void test_send_ref_segmented_sample_data(void)
+{
+    test_gatt_init();
+
+    connected_evt_expect();
+    connect(0);
+
+    uint8_t buffer[66] = {0x00,
+                          SAMPLE_DATA_SEGMENT_1,
+                          SAMPLE_DATA_SEGMENT_2,
+                          SAMPLE_DATA_SEGMENT_3,
+                          SAMPLE_DATA_SEGMENT_4};
+    uint8_t original[sizeof(buffer)];
+    memcpy(original, buffer, sizeof(buffer));
+
+    uint8_t * p_packet = mesh_gatt_packet_ref_alloc(0, MESH_GATT_PDU_TYPE_PROV_PDU, TX_TOKEN);
+
+    EXPECT_PDU({0x43, SAMPLE_DATA_SEGMENT_1});
+    EXPECT_PDU({0x83, SAMPLE_DATA_SEGMENT_2});
+    EXPECT_PDU({0x83, SAMPLE_DATA_SEGMENT_3});
+    EXPECT_PDU({0xc3, SAMPLE_DATA_SEGMENT_4});
+
+    sd_ble_gatts_hvx_StubWithCallback(sd_ble_gatts_hvx_cb);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_gatt_packet_ref_send(0, p_packet, &buffer[1], 65, ref_release_cb));
+
+    tx_complete_evt_send();
+    tx_complete_evt_send();
+    tx_complete_evt_send();
+    TEST_ASSERT_EQUAL(0, m_ref_release_count);
+
+    tx_complete_evt_expect();
+    tx_complete_evt_send();
+    TEST_ASSERT_EQUAL(1, m_ref_release_count);
+
+    /* The referenced payload may be shared, and must not be altered by segmentation: */
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&original[1], &buffer[1], sizeof(buffer) - 1);
+}
+
+void test_ref_release_on_disconnect(void)
+{
+    test_gatt_init();
+
+    connected_evt_expect();
+    connect(0);
+
+    uint8_t buffer[] = {0x00, 0xca, 0xfe, 0xba, 0xbe};
+
+    /* Keep the first packet in flight, and queue another one behind it: */
+    sd_ble_gatts_hvx_IgnoreAndReturn(NRF_SUCCESS);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        uint8_t * p_packet = mesh_gatt_packet_ref_alloc(0, MESH_GATT_PDU_TYPE_NETWORK_PDU, TX_TOKEN);
+        TEST_ASSERT_NOT_NULL(p_packet);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_gatt_packet_ref_send(0, p_packet, &buffer[1], 4, ref_release_cb));
+    }
+    TEST_ASSERT_EQUAL(0, m_ref_release_count);
+
+    disconnected_evt_expect();
+    disconnect(0);
+    TEST_ASSERT_EQUAL(2, m_ref_release_count);
+    TEST_ASSERT_EQUAL_PTR(&buffer[1], mp_ref_released[0]);
+    TEST_ASSERT_EQUAL_PTR(&buffer[1], mp_ref_released[1]);
+}
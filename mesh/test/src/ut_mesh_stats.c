@@ -0,0 +1,188 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "mesh_stats.h"
+#include "scanner.h"
+#include "nrf_error.h"
+
+static scanner_stats_t m_scanner_stats;
+
+/* ******************* Fakes ******************* */
+
+const scanner_stats_t * scanner_stats_get(void)
+{
+    return &m_scanner_stats;
+}
+
+/* ******************* Setup ******************* */
+
+void setUp(void)
+{
+    memset(&m_scanner_stats, 0, sizeof(m_scanner_stats));
+    mesh_stats_init();
+}
+
+void tearDown(void)
+{
+}
+
+/* ******************* Tests ******************* */
+
+void test_init(void)
+{
+    MESH_STATS_INC(MESH_STATS_NET_RX);
+    m_scanner_stats.successful_receives = 10;
+    mesh_stats_init();
+
+    /* The scanner starts counting after the module has been initialized, its counters are taken as is. */
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_NET_RX]);
+    TEST_ASSERT_EQUAL(10, stats.counters[MESH_STATS_SCANNER_RX]);
+}
+
+void test_inc(void)
+{
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, stats.counters[i]);
+    }
+
+    MESH_STATS_INC(MESH_STATS_NET_RX);
+    MESH_STATS_INC(MESH_STATS_NET_RX);
+    MESH_STATS_INC(MESH_STATS_TRS_SAR_TX_FAIL);
+    MESH_STATS_INC(MESH_STATS_FLASH_QUEUE_FULL);
+
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(2, stats.counters[MESH_STATS_NET_RX]);
+    TEST_ASSERT_EQUAL(1, stats.counters[MESH_STATS_TRS_SAR_TX_FAIL]);
+    TEST_ASSERT_EQUAL(1, stats.counters[MESH_STATS_FLASH_QUEUE_FULL]);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_NET_TX]);
+
+    /* Counters wrap. */
+    g_mesh_stats_counters[MESH_STATS_NET_TX] = UINT32_MAX;
+    MESH_STATS_INC(MESH_STATS_NET_TX);
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_NET_TX]);
+}
+
+void test_scanner(void)
+{
+    m_scanner_stats.successful_receives = 100;
+    m_scanner_stats.crc_failures = 5;
+    m_scanner_stats.length_out_of_bounds = 7;
+    m_scanner_stats.out_of_memory = 3;
+
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(100, stats.counters[MESH_STATS_SCANNER_RX]);
+    TEST_ASSERT_EQUAL(5, stats.counters[MESH_STATS_SCANNER_CRC_FAIL]);
+    TEST_ASSERT_EQUAL(3, stats.counters[MESH_STATS_SCANNER_NO_MEM]);
+
+    /* The scanner counters are relative to the last clear, and wrap with the scanner counters. */
+    mesh_stats_clear();
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_SCANNER_RX]);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_SCANNER_CRC_FAIL]);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_SCANNER_NO_MEM]);
+
+    m_scanner_stats.successful_receives = 20;
+    m_scanner_stats.crc_failures = 6;
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t) (20 - 100), stats.counters[MESH_STATS_SCANNER_RX]);
+    TEST_ASSERT_EQUAL(1, stats.counters[MESH_STATS_SCANNER_CRC_FAIL]);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_SCANNER_NO_MEM]);
+}
+
+void test_clear(void)
+{
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        MESH_STATS_INC(i);
+    }
+    mesh_stats_clear();
+
+    mesh_stats_t stats;
+    mesh_stats_get(&stats);
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, stats.counters[i]);
+    }
+}
+
+void test_opt(void)
+{
+    uint8_t buffer[sizeof(mesh_stats_t) + 1];
+    nrf_mesh_opt_t opt;
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, mesh_stats_opt_get(NRF_MESH_OPT_STATS_COUNTERS, NULL));
+    opt.opt.p_array = NULL;
+    opt.len = sizeof(buffer);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, mesh_stats_opt_get(NRF_MESH_OPT_STATS_COUNTERS, &opt));
+    opt.opt.p_array = buffer;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, mesh_stats_opt_get((nrf_mesh_opt_id_t) (NRF_MESH_OPT_STATS_COUNTERS + 1), &opt));
+    opt.len = sizeof(mesh_stats_t) - 1;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_LENGTH, mesh_stats_opt_get(NRF_MESH_OPT_STATS_COUNTERS, &opt));
+
+    MESH_STATS_INC(MESH_STATS_ACCESS_RX);
+    m_scanner_stats.out_of_memory = 2;
+
+    /* Unaligned buffer. */
+    opt.opt.p_array = &buffer[1];
+    opt.len = sizeof(mesh_stats_t);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_stats_opt_get(NRF_MESH_OPT_STATS_COUNTERS, &opt));
+    TEST_ASSERT_EQUAL(sizeof(mesh_stats_t), opt.len);
+    mesh_stats_t stats;
+    memcpy(&stats, &buffer[1], sizeof(stats));
+    TEST_ASSERT_EQUAL(1, stats.counters[MESH_STATS_ACCESS_RX]);
+    TEST_ASSERT_EQUAL(2, stats.counters[MESH_STATS_SCANNER_NO_MEM]);
+
+    /* Setting the option clears the counters. */
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, mesh_stats_opt_set(NRF_MESH_OPT_STATS_COUNTERS, NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, mesh_stats_opt_set((nrf_mesh_opt_id_t) (NRF_MESH_OPT_STATS_COUNTERS + 1), &opt));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_stats_opt_set(NRF_MESH_OPT_STATS_COUNTERS, &opt));
+    mesh_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_ACCESS_RX]);
+    TEST_ASSERT_EQUAL(0, stats.counters[MESH_STATS_SCANNER_NO_MEM]);
+}
@@ -0,0 +1,366 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "model_transition.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "app_timer_mock.h"
+
+#define RTC_COUNTER_MASK        (0x00FFFFFF)
+#define CONTEXT_COUNT           (MODEL_TRANSITION_SLOT_COUNT + 1)
+
+typedef struct
+{
+    int32_t value;
+    uint32_t calls;
+    bool complete;
+} context_state_t;
+
+static context_state_t m_contexts[CONTEXT_COUNT];
+
+/* Simulated RTC. */
+static uint32_t m_rtc_counter;
+static app_timer_timeout_handler_t m_timeout_handler;
+static void * mp_timer_context;
+static bool m_timer_running;
+static uint32_t m_timer_expiry;
+static uint32_t m_timer_expiry_count;
+
+/******** Simulated APP_TIMER ********/
+
+static ret_code_t app_timer_create_stub(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                                        app_timer_timeout_handler_t timeout_handler, int count)
+{
+    TEST_ASSERT_EQUAL(APP_TIMER_MODE_SINGLE_SHOT, mode);
+    m_timeout_handler = timeout_handler;
+    return NRF_SUCCESS;
+}
+
+static ret_code_t app_timer_start_stub(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context, int count)
+{
+    TEST_ASSERT_TRUE(timeout_ticks >= APP_TIMER_MIN_TIMEOUT_TICKS);
+    mp_timer_context = p_context;
+    m_timer_expiry = m_rtc_counter + timeout_ticks;
+    m_timer_running = true;
+    return NRF_SUCCESS;
+}
+
+static ret_code_t app_timer_stop_stub(app_timer_id_t timer_id, int count)
+{
+    m_timer_running = false;
+    return NRF_SUCCESS;
+}
+
+static uint32_t app_timer_cnt_get_stub(int count)
+{
+    return m_rtc_counter & RTC_COUNTER_MASK;
+}
+
+static uint32_t app_timer_cnt_diff_compute_stub(uint32_t ticks_to, uint32_t ticks_from, int count)
+{
+    return (ticks_to - ticks_from) & RTC_COUNTER_MASK;
+}
+
+/* Advances simulated time, firing the timer whenever it expires. */
+static void time_advance_ms(uint32_t ms)
+{
+    uint32_t end = m_rtc_counter + APP_TIMER_TICKS(ms);
+    while (m_timer_running && (int32_t) (end - m_timer_expiry) >= 0)
+    {
+        m_rtc_counter = m_timer_expiry;
+        m_timer_running = false;
+        m_timer_expiry_count++;
+        m_timeout_handler(mp_timer_context);
+    }
+    m_rtc_counter = end;
+}
+
+/******** Helpers ********/
+
+static void transition_cb(void * p_context, int32_t present_value, bool complete)
+{
+    context_state_t * p_state = (context_state_t *) p_context;
+    p_state->value = present_value;
+    p_state->complete = complete;
+    p_state->calls++;
+}
+
+static model_transition_params_t linear_params(uint32_t index, int32_t start, int32_t target,
+                                               uint32_t delay_ms, uint32_t transition_time_ms)
+{
+    model_transition_params_t params =
+    {
+        .type = MODEL_TRANSITION_TYPE_LINEAR,
+        .start_value = start,
+        .target_value = target,
+        .delay_ms = delay_ms,
+        .transition_time_ms = transition_time_ms,
+        .cb = transition_cb,
+        .p_context = &m_contexts[index]
+    };
+    m_contexts[index].value = start;
+    return params;
+}
+
+/******** Setup and Tear Down ********/
+
+void setUp(void)
+{
+    app_timer_mock_Init();
+    app_timer_create_StubWithCallback(app_timer_create_stub);
+    app_timer_start_StubWithCallback(app_timer_start_stub);
+    app_timer_stop_StubWithCallback(app_timer_stop_stub);
+    app_timer_cnt_get_StubWithCallback(app_timer_cnt_get_stub);
+    app_timer_cnt_diff_compute_StubWithCallback(app_timer_cnt_diff_compute_stub);
+
+    memset(m_contexts, 0, sizeof(m_contexts));
+    m_timer_expiry_count = 0;
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_init());
+}
+
+void tearDown(void)
+{
+    for (uint32_t i = 0; i < CONTEXT_COUNT; ++i)
+    {
+        (void) model_transition_abort(&m_contexts[i]);
+    }
+    TEST_ASSERT_FALSE(m_timer_running);
+
+    app_timer_mock_Verify();
+    app_timer_mock_Destroy();
+}
+
+/******** Tests ********/
+
+void test_start_invalid_params(void)
+{
+    model_transition_params_t params = linear_params(0, 0, 100, 0, 1000);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, model_transition_start(NULL));
+    params.cb = NULL;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, model_transition_start(&params));
+    params = linear_params(0, 0, 100, 0, 1000);
+    params.p_context = NULL;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, model_transition_start(&params));
+
+    params = linear_params(0, 0, 100, 0, 0);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, model_transition_start(&params));
+    params.type = MODEL_TRANSITION_TYPE_MOVE;
+    params.move_delta = 10;
+    params.delay_ms = 100;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, model_transition_start(&params));
+
+    params = linear_params(0, 0, 100, 0, 1000);
+    params.type = MODEL_TRANSITION_TYPE_MOVE;
+    params.move_delta = 0;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, model_transition_start(&params));
+
+    TEST_ASSERT_EQUAL(0, model_transition_active_count_get());
+    TEST_ASSERT_FALSE(m_timer_running);
+}
+
+void test_linear(void)
+{
+    model_transition_params_t params = linear_params(0, -1000, 1000, 0, 1000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    TEST_ASSERT_TRUE(model_transition_is_active(&m_contexts[0]));
+    TEST_ASSERT_TRUE(m_timer_running);
+    TEST_ASSERT_EQUAL(1000, model_transition_remaining_time_get(&m_contexts[0]));
+
+    time_advance_ms(500);
+    TEST_ASSERT_INT_WITHIN(2 * 2000 * MODEL_TRANSITION_TICK_INTERVAL_MS / 1000, 0, m_contexts[0].value);
+    TEST_ASSERT_FALSE(m_contexts[0].complete);
+    TEST_ASSERT_UINT32_WITHIN(MODEL_TRANSITION_TICK_INTERVAL_MS, 500, model_transition_remaining_time_get(&m_contexts[0]));
+
+    /* Values are monotonic and reported once per change. */
+    uint32_t calls = m_contexts[0].calls;
+    int32_t previous = m_contexts[0].value;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        time_advance_ms(MODEL_TRANSITION_TICK_INTERVAL_MS);
+        TEST_ASSERT_TRUE(m_contexts[0].value > previous);
+        previous = m_contexts[0].value;
+    }
+    TEST_ASSERT_EQUAL(calls + 10, m_contexts[0].calls);
+
+    time_advance_ms(500);
+    TEST_ASSERT_EQUAL(1000, m_contexts[0].value);
+    TEST_ASSERT_TRUE(m_contexts[0].complete);
+    TEST_ASSERT_FALSE(model_transition_is_active(&m_contexts[0]));
+    TEST_ASSERT_EQUAL(0, model_transition_remaining_time_get(&m_contexts[0]));
+
+    /* The shared tick stops when there is nothing left to do. */
+    TEST_ASSERT_FALSE(m_timer_running);
+}
+
+void test_delay(void)
+{
+    model_transition_params_t params = linear_params(0, 0, 100, 200, 100);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    TEST_ASSERT_EQUAL(300, model_transition_remaining_time_get(&m_contexts[0]));
+
+    /* Delay without transition time: a single step when the delay expires. */
+    params = linear_params(1, 0, 100, 200, 0);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+
+    time_advance_ms(180);
+    TEST_ASSERT_EQUAL(0, m_contexts[0].calls);
+    TEST_ASSERT_EQUAL(0, m_contexts[1].calls);
+    TEST_ASSERT_UINT32_WITHIN(MODEL_TRANSITION_TICK_INTERVAL_MS, 120, model_transition_remaining_time_get(&m_contexts[0]));
+
+    time_advance_ms(25);
+    TEST_ASSERT_EQUAL(1, m_contexts[1].calls);
+    TEST_ASSERT_EQUAL(100, m_contexts[1].value);
+    TEST_ASSERT_TRUE(m_contexts[1].complete);
+
+    time_advance_ms(200);
+    TEST_ASSERT_EQUAL(100, m_contexts[0].value);
+    TEST_ASSERT_TRUE(m_contexts[0].complete);
+    TEST_ASSERT_FALSE(m_timer_running);
+}
+
+void test_move(void)
+{
+    model_transition_params_t params = linear_params(0, 0, 1000, 0, 100);
+    params.type = MODEL_TRANSITION_TYPE_MOVE;
+    params.move_delta = 10;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+
+    /* Move transitions report the step time as remaining time. */
+    TEST_ASSERT_EQUAL(100, model_transition_remaining_time_get(&m_contexts[0]));
+
+    time_advance_ms(2000);
+    TEST_ASSERT_INT_WITHIN(2, 200, m_contexts[0].value);
+    TEST_ASSERT_FALSE(m_contexts[0].complete);
+
+    /* Stops at the limit. */
+    time_advance_ms(10000);
+    TEST_ASSERT_EQUAL(1000, m_contexts[0].value);
+    TEST_ASSERT_TRUE(m_contexts[0].complete);
+
+    /* Negative moves stop at the lower limit. */
+    params = linear_params(1, 0, -50, 0, 100);
+    params.type = MODEL_TRANSITION_TYPE_MOVE;
+    params.move_delta = -10;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    time_advance_ms(1000);
+    TEST_ASSERT_EQUAL(-50, m_contexts[1].value);
+    TEST_ASSERT_TRUE(m_contexts[1].complete);
+}
+
+void test_many_transitions_share_tick(void)
+{
+    model_transition_params_t params;
+
+    for (uint32_t i = 0; i < MODEL_TRANSITION_SLOT_COUNT; ++i)
+    {
+        params = linear_params(i, 0, 1000, 0, 100 * (i + 1));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    }
+    TEST_ASSERT_EQUAL(MODEL_TRANSITION_SLOT_COUNT, model_transition_active_count_get());
+
+    params = linear_params(MODEL_TRANSITION_SLOT_COUNT, 0, 1000, 0, 100);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, model_transition_start(&params));
+
+    /* Restarting an active context reuses its slot. */
+    params = linear_params(0, 500, 0, 0, 100);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    TEST_ASSERT_EQUAL(MODEL_TRANSITION_SLOT_COUNT, model_transition_active_count_get());
+
+    /* Transitions complete in order of their transition time, the others keep running. */
+    time_advance_ms(110);
+    TEST_ASSERT_TRUE(m_contexts[0].complete);
+    /* All transitions are driven by one tick, not one timer per transition. */
+    TEST_ASSERT_TRUE(m_timer_expiry_count <= 100 / MODEL_TRANSITION_TICK_INTERVAL_MS + 1);
+    TEST_ASSERT_EQUAL(0, m_contexts[0].value);
+    TEST_ASSERT_EQUAL(MODEL_TRANSITION_SLOT_COUNT - 1, model_transition_active_count_get());
+
+    for (uint32_t i = 1; i < MODEL_TRANSITION_SLOT_COUNT; ++i)
+    {
+        time_advance_ms(100);
+        TEST_ASSERT_TRUE(m_contexts[i].complete);
+        TEST_ASSERT_EQUAL(1000, m_contexts[i].value);
+        TEST_ASSERT_EQUAL(MODEL_TRANSITION_SLOT_COUNT - 1 - i, model_transition_active_count_get());
+    }
+
+    TEST_ASSERT_FALSE(m_timer_running);
+}
+
+void test_abort(void)
+{
+    model_transition_params_t params = linear_params(0, 0, 1000, 0, 1000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+    params = linear_params(1, 0, 1000, 0, 1000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+
+    time_advance_ms(100);
+    uint32_t calls = m_contexts[0].calls;
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_abort(&m_contexts[0]));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, model_transition_abort(&m_contexts[0]));
+    TEST_ASSERT_TRUE(m_timer_running);
+
+    time_advance_ms(100);
+    TEST_ASSERT_EQUAL(calls, m_contexts[0].calls);
+    TEST_ASSERT_TRUE(m_contexts[1].calls > calls);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_abort(&m_contexts[1]));
+    TEST_ASSERT_FALSE(m_timer_running);
+}
+
+void test_long_transition_across_counter_wrap(void)
+{
+    /* 10 minutes is longer than the 24 bit RTC counter period. */
+    model_transition_params_t params = linear_params(0, 0, 600, 0, MIN_TO_MS(10));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, model_transition_start(&params));
+
+    for (uint32_t minute = 1; minute < 10; ++minute)
+    {
+        time_advance_ms(MIN_TO_MS(1));
+        TEST_ASSERT_INT_WITHIN(1, minute * 60, m_contexts[0].value);
+    }
+
+    time_advance_ms(MIN_TO_MS(1));
+    TEST_ASSERT_EQUAL(600, m_contexts[0].value);
+    TEST_ASSERT_TRUE(m_contexts[0].complete);
+}
@@ -120,6 +120,7 @@ static uint32_t m_rand_value;
 static uint32_t m_time_now;
 static advertiser_t * mp_adv;
 static advertiser_tx_complete_cb_t m_tx_complete_cb;
+static nrf_mesh_key_refresh_phase_t m_kr_phase;
 
 extern const mesh_config_entry_params_t m_net_beacon_enable_params;
 
@@ -130,6 +131,7 @@ void setUp(void)
     m_info_count = 0;
     mpp_infos = NULL;
     m_time_now = 0;
+    m_kr_phase = NRF_MESH_KEY_REFRESH_PHASE_0;
     beacon_mock_Init();
     net_state_mock_Init();
     timer_scheduler_mock_Init();
@@ -187,7 +189,7 @@ void nrf_mesh_beacon_info_next_get(const uint8_t * p_network_id, const nrf_mesh_
             TEST_ASSERT_EQUAL(NULL, *pp_beacon_info);
         }
         *pp_beacon_info = mpp_infos[m_info_index];
-        *p_subnet_kr_phase = NRF_MESH_KEY_REFRESH_PHASE_0;
+        *p_subnet_kr_phase = m_kr_phase;
     }
 
     m_info_index++;
@@ -413,11 +415,9 @@ void test_packet_in(void)
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(1, sample_data.info.p_tx_info->rx_count[0]);
 
-        /* Try again, should bump the tx count */
+        /* Try again, should bump the tx count. The beacon has already been authenticated, so the CMAC
+         * shouldn't be recalculated. */
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(2, sample_data.info.p_tx_info->rx_count[0]);
@@ -425,9 +425,6 @@ void test_packet_in(void)
         /* Try again without permitting IV update. Should still produce an event, and should count the RX */
         sample_data.info.iv_update_permitted = false;
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(3, sample_data.info.p_tx_info->rx_count[0]);
@@ -437,16 +434,15 @@ void test_packet_in(void)
         m_info_index = 0;
         sample_data.info.iv_update_permitted = true;
         sample_data.info.p_tx_info->rx_count[0] = 0xFFFF;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(0xFFFF, sample_data.info.p_tx_info->rx_count[0]);
 
-        /* Invalid auth, shouldn't handle the beacon: */
+        /* Invalid auth, shouldn't handle the beacon. Use a different beacon key to avoid the cached
+         * authentication of the same beacon: */
         uint8_t dummy_auth[NRF_MESH_KEY_SIZE];
         memset(dummy_auth, 0xDA, NRF_MESH_KEY_SIZE);
+        sample_data.info.secmat.key[0] ^= 0xFF;
         sample_data.info.p_tx_info->rx_count[0] = 0;
         m_info_index = 0;
         enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
@@ -454,7 +450,19 @@ void test_packet_in(void)
         enc_aes_cmac_ReturnMemThruPtr_p_result(dummy_auth, 16);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(0, sample_data.info.p_tx_info->rx_count[0]);
+
+        /* The failed authentication shouldn't have been cached: */
+        m_info_index = 0;
+        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_IgnoreArg_p_result();
+        enc_aes_cmac_ReturnMemThruPtr_p_result(dummy_auth, 16);
+        net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
+        TEST_ASSERT_EQUAL(0, sample_data.info.p_tx_info->rx_count[0]);
     }
+
+    /* Three cache hits per sample */
+    TEST_ASSERT_EQUAL(3 * ARRAY_SIZE(sample_datas), net_beacon_stats_get()->cache_hits);
+    TEST_ASSERT_EQUAL(3 * ARRAY_SIZE(sample_datas), net_beacon_stats_get()->cmacs_saved);
 }
 
 void test_pkt_in_multi(void)
@@ -470,8 +478,10 @@ void test_pkt_in_multi(void)
         SEC_NET_SAMPLE_DATA_1,
         SEC_NET_SAMPLE_DATA_1
     };
-    /* Invalidate the second auth, making this one fail verification. */
+    /* Invalidate the second auth and key, making this one fail verification. The third network uses
+     * the same key as the first, and should be authenticated through the cache. */
     memset(stored_beacons[1].auth, 0x56, NRF_MESH_KEY_SIZE);
+    stored_beacons[1].info.secmat.key[0] ^= 0xFF;
 
     /* Yield 3 networks on lookup with NET ID */
     nrf_mesh_beacon_info_t * p_info[] =
@@ -499,9 +509,12 @@ void test_pkt_in_multi(void)
     m_info_index = 0;
     for (uint32_t j = 0; j < ARRAY_SIZE(p_info); j++)
     {
-        enc_aes_cmac_ExpectWithArray(p_info[j]->secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(stored_beacons[j].auth, 16);
+        if (j != 2)
+        {
+            enc_aes_cmac_ExpectWithArray(p_info[j]->secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
+            enc_aes_cmac_IgnoreArg_p_result();
+            enc_aes_cmac_ReturnMemThruPtr_p_result(stored_beacons[j].auth, 16);
+        }
 
         /* Only the valid auths should generate an event: */
         if (j != 1)
@@ -520,6 +533,61 @@ void test_pkt_in_multi(void)
     TEST_ASSERT_EQUAL(1, tx_infos[0].rx_count[0]);
     TEST_ASSERT_EQUAL(0, tx_infos[1].rx_count[0]); /* Had invalid auth, didn't get a match */
     TEST_ASSERT_EQUAL(1, tx_infos[2].rx_count[0]);
+    TEST_ASSERT_EQUAL(1, net_beacon_stats_get()->cache_hits);
+    TEST_ASSERT_EQUAL(1, net_beacon_stats_get()->cmacs_saved);
+}
+
+void test_packet_in_key_refresh(void)
+{
+    setup_module();
+
+    net_beacon_sample_data_t sample_data = SEC_NET_SAMPLE_DATA_1;
+    nrf_mesh_beacon_tx_info_t tx_info;
+    memset(&tx_info, 0, sizeof(tx_info));
+    sample_data.info.p_tx_info = &tx_info;
+    /* The beacon is authenticated with the updated key, the old key has a different network ID: */
+    memcpy(&sample_data.info.secmat_updated, &sample_data.info.secmat, sizeof(nrf_mesh_beacon_secmat_t));
+    sample_data.info.secmat.key[0] ^= 0xFF;
+    sample_data.info.secmat.net_id[0] ^= 0xFF;
+
+    nrf_mesh_beacon_info_t * p_info[] = {&sample_data.info};
+    mpp_infos = p_info;
+    m_info_count = 1;
+    mp_expected_net_id = sample_data.info.secmat_updated.net_id;
+    m_kr_phase = NRF_MESH_KEY_REFRESH_PHASE_1;
+
+    nrf_mesh_evt_t evt;
+    evt.type                                = NRF_MESH_EVT_NET_BEACON_RECEIVED;
+    evt.params.net_beacon.p_beacon_info     = &sample_data.info;
+    evt.params.net_beacon.p_beacon_secmat   = &sample_data.info.secmat_updated;
+    evt.params.net_beacon.p_rx_metadata     = NULL;
+    evt.params.net_beacon.iv_index          = sample_data.iv_index;
+    evt.params.net_beacon.flags.iv_update   = sample_data.iv_update;
+    evt.params.net_beacon.flags.key_refresh = sample_data.key_refresh;
+
+    /* First reception only calculates the CMAC for the key with a matching network ID: */
+    m_info_index = 0;
+    enc_aes_cmac_ExpectWithArray(sample_data.info.secmat_updated.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
+    enc_aes_cmac_IgnoreArg_p_result();
+    enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+    event_handle_Expect(&evt);
+    net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
+    TEST_ASSERT_EQUAL(1, tx_info.rx_count[0]);
+    TEST_ASSERT_EQUAL(0, net_beacon_stats_get()->cache_hits);
+
+    /* Second reception is authenticated with the updated key without any CMAC calculations: */
+    m_info_index = 0;
+    event_handle_Expect(&evt);
+    net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
+    TEST_ASSERT_EQUAL(2, tx_info.rx_count[0]);
+    TEST_ASSERT_EQUAL(1, net_beacon_stats_get()->cache_hits);
+    TEST_ASSERT_EQUAL(1, net_beacon_stats_get()->cmacs_saved);
+
+    /* The cached authentication only applies while the updated key is in use: */
+    m_info_index = 0;
+    m_kr_phase = NRF_MESH_KEY_REFRESH_PHASE_0;
+    net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
+    TEST_ASSERT_EQUAL(2, tx_info.rx_count[0]);
 }
 
 void test_beacon_state_change(void)
@@ -337,6 +337,82 @@ void test_encrypt(void)
     TEST_NRF_MESH_ASSERT_EXPECT(net_packet_encrypt(&metadata, len, &payload, 0x44));
 }
 
+void test_relay_encrypt(void)
+{
+    uint8_t pecb_data[NRF_MESH_KEY_SIZE];
+    uint8_t pecb[NRF_MESH_KEY_SIZE];
+    nrf_mesh_network_secmat_t secmat;
+    network_packet_metadata_t metadata;
+    packet_mesh_net_packet_t rx_packet;
+    packet_mesh_net_packet_t relay_packet;
+    uint8_t len = 10;
+    memset(secmat.encryption_key, 0xEC, NRF_MESH_KEY_SIZE);
+    memset(secmat.privacy_key, 0x93, NRF_MESH_KEY_SIZE);
+    secmat.nid = 0x2A;
+
+    for (uint32_t i = 0; i < NRF_MESH_KEY_SIZE; ++i)
+    {
+        pecb[i] = 137 * i; // arbitrary values
+    }
+
+    for (uint32_t control = 0; control < 2; ++control)
+    {
+        m_enc_nonce_generate_params.executed = 0;
+        m_enc_nonce_generate_params.calls = 0;
+
+        metadata.dst.value                = 0x1234;
+        metadata.dst.type                 = NRF_MESH_ADDRESS_TYPE_UNICAST;
+        metadata.src                      = 0x0102;
+        metadata.ttl                      = 4;
+        metadata.p_security_material      = &secmat;
+        metadata.internal.iv_index        = IV_INDEX;
+        metadata.internal.sequence_number = SEQNUM;
+        metadata.control_packet           = control;
+
+        /* The received packet has the header of the previous hop. */
+        metadata.ttl++;
+        net_packet_header_set(&rx_packet, &metadata);
+        metadata.ttl--;
+        for (uint32_t i = 0; i < len; ++i)
+        {
+            rx_packet.pdu[9 + i] = i;
+        }
+
+        memset(&relay_packet, 0xAB, sizeof(relay_packet));
+        m_expected_encrypt_ccm.a_len   = 0;
+        m_expected_encrypt_ccm.p_a     = NULL;
+        m_expected_encrypt_ccm.p_key   = secmat.encryption_key;
+        m_expected_encrypt_ccm.p_m     = &rx_packet.pdu[7];
+        m_expected_encrypt_ccm.p_out   = &relay_packet.pdu[7];
+        m_expected_encrypt_ccm.p_nonce = m_enc_nonce_generate_params.nonce_return;
+        m_expected_encrypt_ccm.p_mic   = &relay_packet.pdu[9 + len];
+        m_expected_encrypt_ccm.m_len   = 2 + len;
+        m_expected_encrypt_ccm.mic_len = control ? 8 : 4;
+        m_enc_nonce_generate_Expect(&metadata, NET_PACKET_KIND_TRANSPORT);
+        enc_nonce_generate_StubWithCallback(enc_nonce_generate_callback);
+        enc_aes_ccm_encrypt_StubWithCallback(&enc_aes_ccm_encrypt_callback);
+        transfuscate_Expect(&metadata, (uint8_t *) &relay_packet, pecb, pecb_data);
+
+        net_packet_relay_encrypt(&metadata, len, &rx_packet, &relay_packet);
+
+        /* Same header as the received packet, but with the new TTL, obfuscated. */
+        TEST_ASSERT_EQUAL_HEX8(rx_packet.pdu[0], relay_packet.pdu[0]);
+        TEST_ASSERT_EQUAL_HEX8(((control << 7) | metadata.ttl) ^ pecb[0], relay_packet.pdu[1]);
+        for (uint32_t i = 2; i < 7; ++i)
+        {
+            TEST_ASSERT_EQUAL_HEX8(rx_packet.pdu[i] ^ pecb[i - 1], relay_packet.pdu[i]);
+        }
+        TEST_ASSERT_EQUAL(1, m_enc_nonce_generate_params.executed);
+        enc_mock_Verify();
+    }
+
+    /* Invalid params */
+    TEST_NRF_MESH_ASSERT_EXPECT(net_packet_relay_encrypt(NULL, len, &rx_packet, &relay_packet));
+    TEST_NRF_MESH_ASSERT_EXPECT(net_packet_relay_encrypt(&metadata, len, NULL, &relay_packet));
+    TEST_NRF_MESH_ASSERT_EXPECT(net_packet_relay_encrypt(&metadata, len, &rx_packet, NULL));
+    TEST_NRF_MESH_ASSERT_EXPECT(net_packet_relay_encrypt(&metadata, len, &rx_packet, &rx_packet));
+}
+
 /**
  * Test decrypt function, to make sure it parses the header and calls the encryption module
  * correctly, as well as discarding packets correctly.
@@ -454,8 +530,21 @@ void test_packet_in(void)
                                              (packet_mesh_net_packet_t *) net_packet,
                                              (packet_mesh_net_packet_t *) decrypted_packet,
                                              vector[i].kind);
-        TEST_ASSERT_EQUAL(((vector[i].fail_step == STEP_SUCCESS) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND),
-                          status);
+        if (vector[i].fail_step == STEP_SUCCESS)
+        {
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, status);
+        }
+        else if (vector[i].fail_step == STEP_MSG_CACHE)
+        {
+            /* Duplicates are reported with their source and sequence number. */
+            TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, status);
+            TEST_ASSERT_EQUAL(0x0001, vector[i].meta.src);
+            TEST_ASSERT_EQUAL(SEQNUM, vector[i].meta.internal.sequence_number);
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, status);
+        }
 
         nrf_mesh_externs_mock_Verify();
         enc_mock_Verify();
@@ -56,6 +56,8 @@
 #include "net_beacon_mock.h"
 #include "net_state_mock.h"
 #include "net_packet_mock.h"
+#include "relay_policy_mock.h"
+#include "relay_queue_mock.h"
 #include "nrf_mesh_externs_mock.h"
 
 #define TOKEN 0x12345678U
@@ -75,6 +77,8 @@ void setUp(void)
     net_state_mock_Init();
     net_packet_mock_Init();
     nrf_mesh_externs_mock_Init();
+    relay_policy_mock_Init();
+    relay_queue_mock_Init();
 }
 
 void tearDown(void)
@@ -97,6 +101,10 @@ void tearDown(void)
     net_packet_mock_Destroy();
     nrf_mesh_externs_mock_Verify();
     nrf_mesh_externs_mock_Destroy();
+    relay_policy_mock_Verify();
+    relay_policy_mock_Destroy();
+    relay_queue_mock_Verify();
+    relay_queue_mock_Destroy();
 }
 /*****************************************************************************
 * Helper functions
@@ -110,6 +118,8 @@ struct
     bool retval;
 } m_relay_callback_expect;
 
+static relay_queue_tx_cb_t m_relay_queue_tx_cb;
+
 static bool relay_callback(uint16_t src, uint16_t dst, uint8_t ttl)
 {
     TEST_ASSERT_TRUE(m_relay_callback_expect.calls > 0);
@@ -134,7 +144,12 @@ static void packet_alloc_Expect(network_packet_metadata_t * p_metadata, uint32_t
     core_tx_packet_alloc_ReturnThruPtr_pp_packet(pp_packet);
 }
 
-static void relay_Expect(network_packet_metadata_t * p_metadata, uint32_t packet_len, packet_mesh_net_packet_t ** pp_relay_packet)
+static void relay_queue_init_callback(relay_queue_t * p_queue, relay_queue_tx_cb_t tx_cb, int num_calls)
+{
+    m_relay_queue_tx_cb = tx_cb;
+}
+
+static void relay_Expect(network_packet_metadata_t * p_metadata, uint32_t packet_len)
 {
     m_relay_callback_expect.calls  = 1;
     m_relay_callback_expect.dst    = p_metadata->dst.value;
@@ -143,15 +158,20 @@ static void relay_Expect(network_packet_metadata_t * p_metadata, uint32_t packet
     m_relay_callback_expect.ttl    = p_metadata->ttl;
     uint8_t mic_size               = (p_metadata->control_packet ? 8 : 4);
 
-    static network_packet_metadata_t relay_meta;
-    memcpy(&relay_meta, p_metadata, sizeof(relay_meta));
-    relay_meta.ttl--;
+    /* The decrypted packet is on the stack of the network module. */
+    relay_policy_packet_in_ExpectAnyArgsAndReturn(true);
+    relay_queue_push_Expect(NULL, p_metadata, NULL, packet_len - 9 - mic_size);
+    relay_queue_push_IgnoreArg_p_queue();
+    relay_queue_push_IgnoreArg_p_net_packet();
+}
 
-    packet_alloc_Expect(&relay_meta, packet_len, (uint8_t **) pp_relay_packet, CORE_TX_ROLE_RELAY, true);
-    net_packet_from_payload_ExpectAndReturn(&(*pp_relay_packet)->pdu[9], *pp_relay_packet);
-    net_packet_header_set_Expect(*pp_relay_packet, &relay_meta);
-    net_packet_encrypt_Expect(&relay_meta, packet_len - 9 - mic_size, *pp_relay_packet, NET_PACKET_KIND_TRANSPORT);
-    core_tx_packet_send_Expect();
+static void network_init_Expect(void)
+{
+    net_beacon_init_Expect();
+    net_state_recover_from_flash_Expect();
+    net_state_init_Expect();
+    relay_policy_init_ExpectAnyArgs();
+    relay_queue_init_StubWithCallback(relay_queue_init_callback);
 }
 
 struct
@@ -213,15 +233,13 @@ nrf_mesh_address_type_t nrf_mesh_address_type_get(uint16_t address)
 *****************************************************************************/
 void test_init(void)
 {
-    net_beacon_init_Expect();
-    net_state_recover_from_flash_Expect();
-    net_state_init_Expect();
+    network_init_Expect();
     nrf_mesh_init_params_t init_params = {0};
+    m_relay_queue_tx_cb = NULL;
     network_init(&init_params);
+    TEST_ASSERT_NOT_NULL(m_relay_queue_tx_cb);
 
-    net_beacon_init_Expect();
-    net_state_recover_from_flash_Expect();
-    net_state_init_Expect();
+    network_init_Expect();
     init_params.relay_cb = relay_callback;
     network_init(&init_params);
 }
@@ -272,6 +290,7 @@ void test_alloc(void)
         metadata.ttl                 = vector[i].ttl;
         buffer.user_data.payload_len = vector[i].payload_len;
 
+        relay_queue_originator_allowed_ExpectAnyArgsAndReturn(true);
         packet_alloc_Expect(&metadata,
                             vector[i].payload_len + 9 + (vector[i].control ? 8 : 4),
                             &p_packet,
@@ -291,6 +310,7 @@ void test_alloc(void)
             if (vector[i].seqnum_alloc_ok)
             {
                 net_packet_header_set_Expect((packet_mesh_net_packet_t *) p_packet, &metadata);
+                relay_queue_originator_sent_ExpectAnyArgs();
                 TEST_ASSERT_EQUAL(NRF_SUCCESS, network_packet_alloc(&buffer));
                 TEST_ASSERT_EQUAL_PTR(&payload[9], buffer.p_payload);
             }
@@ -307,6 +327,10 @@ void test_alloc(void)
         net_state_mock_Verify();
         core_tx_mock_Verify();
     }
+    /* Relayed packets have priority */
+    relay_queue_originator_allowed_ExpectAnyArgsAndReturn(false);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, network_packet_alloc(&buffer));
+
     /* Invalid params not covered by vectors */
     TEST_NRF_MESH_ASSERT_EXPECT(network_packet_alloc(NULL));
     metadata.p_security_material = NULL;
@@ -418,13 +442,12 @@ void test_packet_in(void)
 
     for (uint32_t i = 0; i < ARRAY_SIZE(vector); ++i)
     {
-        packet_mesh_net_packet_t relay_packet;
-        packet_mesh_net_packet_t * p_relay_packet = &relay_packet;
         packet_mesh_net_packet_t net_packet;
         uint8_t mic_len = vector[i].meta.control_packet ? 8 : 4;
         memset(&net_packet, 0xAB, sizeof(net_packet));
 
         net_packet_obfuscation_start_get_ExpectAndReturn(&net_packet, &net_packet.pdu[1]);
+        relay_policy_neighbour_heard_ExpectAnyArgs();
 
         /* 1: Decrypt */
         net_packet_decrypt_ExpectAndReturn(NULL,
@@ -469,7 +492,7 @@ void test_packet_in(void)
                 }
                 if (vector[i].fail_step > STEP_DO_RELAY)
                 {
-                    relay_Expect(&vector[i].meta, vector[i].length, &p_relay_packet);
+                    relay_Expect(&vector[i].meta, vector[i].length);
                 }
             }
 
@@ -487,3 +510,129 @@ void test_packet_in(void)
         net_packet_mock_Verify();
     }
 }
+
+void test_duplicate_in(void)
+{
+    nrf_mesh_network_secmat_t secmat;
+    network_packet_metadata_t meta = {{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat};
+    nrf_mesh_rx_metadata_t rx_meta;
+    packet_mesh_net_packet_t net_packet;
+    memset(&net_packet, 0xAB, sizeof(net_packet));
+
+    /* Packets dropped by the message cache are reported to the relay policy, but not processed. */
+    net_packet_obfuscation_start_get_ExpectAndReturn(&net_packet, &net_packet.pdu[1]);
+    relay_policy_neighbour_heard_ExpectAnyArgs();
+    net_packet_decrypt_ExpectAndReturn(NULL, 18, &net_packet, NULL, NET_PACKET_KIND_TRANSPORT, NRF_ERROR_INVALID_STATE);
+    net_packet_decrypt_IgnoreArg_p_net_decrypted_packet();
+    net_packet_decrypt_IgnoreArg_p_net_metadata();
+    net_packet_decrypt_ReturnThruPtr_p_net_metadata(&meta);
+    relay_policy_duplicate_in_Expect(NULL, meta.src, meta.internal.sequence_number);
+    relay_policy_duplicate_in_IgnoreArg_p_policy();
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, network_packet_in(net_packet.pdu, 18, &rx_meta));
+}
+
+void test_opt_relay_policy_backoff(void)
+{
+    relay_policy_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.type = RELAY_POLICY_TYPE_COUNTER;
+    cfg.backoff_max_us = MS_TO_US(40);
+    relay_policy_config_t expected_cfg = cfg;
+    expected_cfg.backoff_max_us = MS_TO_US(500);
+
+    nrf_mesh_opt_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.len = sizeof(opt.opt.val);
+    opt.opt.val = 500;
+    relay_policy_config_get_Expect(NULL, NULL);
+    relay_policy_config_get_IgnoreArg_p_policy();
+    relay_policy_config_get_IgnoreArg_p_config();
+    relay_policy_config_get_ReturnThruPtr_p_config(&cfg);
+    relay_policy_config_set_ExpectAndReturn(NULL, &expected_cfg, NRF_SUCCESS);
+    relay_policy_config_set_IgnoreArg_p_policy();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS, &opt));
+
+    /* The largest back-off is the largest number of microseconds that fits in 32 bits. */
+    opt.opt.val = UINT32_MAX / 1000 + 1;
+    relay_policy_config_get_Expect(NULL, NULL);
+    relay_policy_config_get_IgnoreArg_p_policy();
+    relay_policy_config_get_IgnoreArg_p_config();
+    relay_policy_config_get_ReturnThruPtr_p_config(&cfg);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, network_opt_set(NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS, &opt));
+
+    memset(&opt, 0, sizeof(opt));
+    relay_policy_config_get_Expect(NULL, NULL);
+    relay_policy_config_get_IgnoreArg_p_policy();
+    relay_policy_config_get_IgnoreArg_p_config();
+    relay_policy_config_get_ReturnThruPtr_p_config(&expected_cfg);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, network_opt_get(NRF_MESH_OPT_NET_RELAY_POLICY_BACKOFF_MAX_MS, &opt));
+    TEST_ASSERT_EQUAL(500, opt.opt.val);
+    TEST_ASSERT_EQUAL(sizeof(opt.opt.val), opt.len);
+}
+
+void test_relay_tx(void)
+{
+    nrf_mesh_init_params_t init_params = {0};
+    network_init_Expect();
+    network_init(&init_params);
+
+    nrf_mesh_network_secmat_t secmat;
+    network_packet_metadata_t meta = {{NRF_MESH_ADDRESS_TYPE_GROUP, 0xC001}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat};
+    network_packet_metadata_t relay_meta = meta;
+    relay_meta.ttl--;
+    packet_mesh_net_packet_t net_packet;
+    uint8_t relay_buffer[PACKET_MESH_NET_MAX_SIZE];
+    packet_mesh_net_packet_t * p_relay_packet = (packet_mesh_net_packet_t *) relay_buffer;
+    memset(&net_packet, 0xAB, sizeof(net_packet));
+
+    /* The queue hands packets to the relay bearers, encrypted straight from the decrypted packet. */
+    packet_alloc_Expect(&relay_meta, 9 + 10 + 4, (uint8_t **) &p_relay_packet, CORE_TX_ROLE_RELAY, true);
+    net_packet_relay_encrypt_Expect(&relay_meta, 10, &net_packet, p_relay_packet);
+    core_tx_packet_send_Expect();
+    TEST_ASSERT_TRUE(m_relay_queue_tx_cb(NULL, &meta, &net_packet, 10));
+    TEST_ASSERT_EQUAL(5, meta.ttl);
+
+    /* Packets the bearers can't take stay in the queue. */
+    packet_alloc_Expect(&relay_meta, 9 + 10 + 4, (uint8_t **) &p_relay_packet, CORE_TX_ROLE_RELAY, false);
+    TEST_ASSERT_FALSE(m_relay_queue_tx_cb(NULL, &meta, &net_packet, 10));
+    TEST_ASSERT_EQUAL(5, meta.ttl);
+}
+
+void test_opt_relay_queue_max_age(void)
+{
+    relay_queue_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.max_age_us = MS_TO_US(100);
+    relay_queue_config_t expected_cfg = cfg;
+    expected_cfg.max_age_us = MS_TO_US(2000);
+
+    nrf_mesh_opt_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.len = sizeof(opt.opt.val);
+    opt.opt.val = 2000;
+    relay_queue_config_get_Expect(NULL, NULL);
+    relay_queue_config_get_IgnoreArg_p_queue();
+    relay_queue_config_get_IgnoreArg_p_config();
+    relay_queue_config_get_ReturnThruPtr_p_config(&cfg);
+    relay_queue_config_set_ExpectAndReturn(NULL, &expected_cfg, NRF_SUCCESS);
+    relay_queue_config_set_IgnoreArg_p_queue();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, network_opt_set(NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS, &opt));
+
+    /* The longest max age is the largest number of microseconds that fits in 32 bits. */
+    opt.opt.val = UINT32_MAX / 1000 + 1;
+    relay_queue_config_get_Expect(NULL, NULL);
+    relay_queue_config_get_IgnoreArg_p_queue();
+    relay_queue_config_get_IgnoreArg_p_config();
+    relay_queue_config_get_ReturnThruPtr_p_config(&cfg);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, network_opt_set(NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS, &opt));
+
+    memset(&opt, 0, sizeof(opt));
+    relay_queue_config_get_Expect(NULL, NULL);
+    relay_queue_config_get_IgnoreArg_p_queue();
+    relay_queue_config_get_IgnoreArg_p_config();
+    relay_queue_config_get_ReturnThruPtr_p_config(&expected_cfg);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, network_opt_get(NRF_MESH_OPT_NET_RELAY_QUEUE_MAX_AGE_MS, &opt));
+    TEST_ASSERT_EQUAL(2000, opt.opt.val);
+    TEST_ASSERT_EQUAL(sizeof(opt.opt.val), opt.len);
+}
@@ -0,0 +1,175 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "packet_trace.h"
+#include "test_assert.h"
+
+#define RECORD_SIZE(packet_len) (sizeof(packet_trace_record_t) + BLE_ADV_PACKET_OVERHEAD + (packet_len))
+
+static uint8_t m_read_buffer[PACKET_TRACE_BUFFER_SIZE];
+
+static void packet_build(scanner_packet_t * p_packet, uint8_t payload_len, uint8_t seed)
+{
+    memset(p_packet, 0, sizeof(scanner_packet_t));
+    p_packet->metadata.timestamp = 0x12345678 + seed;
+    p_packet->metadata.channel = 37 + (seed % 3);
+    p_packet->metadata.rssi = -40 - seed;
+    p_packet->packet.header.type = BLE_PACKET_TYPE_ADV_NONCONN_IND;
+    p_packet->packet.header.addr_type = 1;
+    p_packet->packet.header.length = BLE_ADV_PACKET_OVERHEAD + payload_len;
+    for (uint32_t i = 0; i < BLE_GAP_ADDR_LEN; ++i)
+    {
+        p_packet->packet.addr[i] = seed + i;
+    }
+    for (uint32_t i = 0; i < payload_len; ++i)
+    {
+        p_packet->packet.payload[i] = seed * i;
+    }
+}
+
+static void record_check(const uint8_t * p_data, const scanner_packet_t * p_packet)
+{
+    packet_trace_record_t record;
+    memcpy(&record, p_data, sizeof(record));
+    TEST_ASSERT_EQUAL(p_packet->metadata.timestamp, record.timestamp);
+    TEST_ASSERT_EQUAL(p_packet->metadata.channel, record.channel);
+    TEST_ASSERT_EQUAL(p_packet->metadata.rssi, record.rssi);
+    TEST_ASSERT_EQUAL(BLE_PACKET_TYPE_ADV_NONCONN_IND | (1 << 6), record.pdu_type);
+    TEST_ASSERT_EQUAL(p_packet->packet.header.length, record.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(p_packet->packet.addr, &p_data[sizeof(record)], record.length);
+}
+
+void setUp(void)
+{
+    packet_trace_start();
+}
+
+void tearDown(void)
+{
+    packet_trace_stop();
+}
+
+void test_record(void)
+{
+    scanner_packet_t packets[3];
+    packet_build(&packets[0], 0, 1);
+    packet_build(&packets[1], 10, 2);
+    packet_build(&packets[2], BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH, 3);
+
+    TEST_ASSERT_TRUE(packet_trace_is_enabled());
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        packet_trace_scanner_rx(&packets[i]);
+    }
+    TEST_ASSERT_EQUAL(3, packet_trace_stats_get()->recorded);
+    TEST_ASSERT_EQUAL(0, packet_trace_stats_get()->dropped);
+
+    uint32_t expected_length = sizeof(packet_trace_header_t) + RECORD_SIZE(0) + RECORD_SIZE(10) +
+                               RECORD_SIZE(BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+    TEST_ASSERT_EQUAL(expected_length, packet_trace_read(m_read_buffer, sizeof(m_read_buffer)));
+    TEST_ASSERT_EQUAL(0, packet_trace_read(m_read_buffer, sizeof(m_read_buffer)));
+
+    packet_trace_header_t header;
+    memcpy(&header, m_read_buffer, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX32(PACKET_TRACE_MAGIC, header.magic);
+    TEST_ASSERT_EQUAL(PACKET_TRACE_VERSION, header.version);
+
+    const uint8_t * p_data = &m_read_buffer[sizeof(header)];
+    record_check(p_data, &packets[0]);
+    p_data += RECORD_SIZE(0);
+    record_check(p_data, &packets[1]);
+    p_data += RECORD_SIZE(10);
+    record_check(p_data, &packets[2]);
+
+    /* Nothing is recorded when stopped. */
+    packet_trace_stop();
+    TEST_ASSERT_FALSE(packet_trace_is_enabled());
+    packet_trace_scanner_rx(&packets[0]);
+    TEST_ASSERT_EQUAL(3, packet_trace_stats_get()->recorded);
+    TEST_ASSERT_EQUAL(0, packet_trace_read(m_read_buffer, sizeof(m_read_buffer)));
+
+    TEST_NRF_MESH_ASSERT_EXPECT(packet_trace_scanner_rx(NULL));
+    TEST_NRF_MESH_ASSERT_EXPECT(packet_trace_read(NULL, 1));
+}
+
+void test_full_buffer(void)
+{
+    scanner_packet_t packet;
+    packet_build(&packet, BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH, 4);
+
+    uint32_t fits = (PACKET_TRACE_BUFFER_SIZE - sizeof(packet_trace_header_t)) /
+                    RECORD_SIZE(BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+    for (uint32_t i = 0; i < fits + 2; ++i)
+    {
+        packet_trace_scanner_rx(&packet);
+    }
+    TEST_ASSERT_EQUAL(fits, packet_trace_stats_get()->recorded);
+    TEST_ASSERT_EQUAL(2, packet_trace_stats_get()->dropped);
+
+    /* Reading out makes room for more records, which wrap around the end of the buffer. */
+    uint32_t length = packet_trace_read(m_read_buffer, sizeof(packet_trace_header_t) + RECORD_SIZE(BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH));
+    TEST_ASSERT_EQUAL(sizeof(packet_trace_header_t) + RECORD_SIZE(BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH), length);
+    packet_trace_scanner_rx(&packet);
+    TEST_ASSERT_EQUAL(fits + 1, packet_trace_stats_get()->recorded);
+
+    /* The stream can be read in small pieces, and records are split between reads. */
+    for (uint32_t i = 0; i < fits; ++i)
+    {
+        uint8_t * p_record = m_read_buffer;
+        uint32_t remaining = RECORD_SIZE(BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH);
+        while (remaining > 0)
+        {
+            uint32_t chunk = packet_trace_read(p_record, remaining < 7 ? remaining : 7);
+            TEST_ASSERT_NOT_EQUAL(0, chunk);
+            p_record += chunk;
+            remaining -= chunk;
+        }
+        record_check(m_read_buffer, &packet);
+    }
+    TEST_ASSERT_EQUAL(0, packet_trace_read(m_read_buffer, sizeof(m_read_buffer)));
+
+    /* Restarting clears the statistics and writes a new header. */
+    packet_trace_start();
+    TEST_ASSERT_EQUAL(0, packet_trace_stats_get()->recorded);
+    TEST_ASSERT_EQUAL(0, packet_trace_stats_get()->dropped);
+    TEST_ASSERT_EQUAL(sizeof(packet_trace_header_t), packet_trace_read(m_read_buffer, sizeof(m_read_buffer)));
+}
@@ -0,0 +1,628 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "nrf_mesh_prov_scheduler.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cmock.h>
+#include <unity.h>
+
+#include "prov_utils_mock.h"
+#include "prov_beacon_mock.h"
+#include "enc_mock.h"
+#include "nrf_mesh_utils_mock.h"
+#include "timer_mock.h"
+
+#include "nrf_mesh_prov.h"
+#include "nrf_mesh_prov_bearer.h"
+
+/* The test runs the real provisioner and provisionee state machines against each other over a
+ * simulated advertising bearer. Cryptographic operations are stubbed out, but the provisioner's
+ * ECDH calculation is charged to simulated time, as it blocks the CPU on a real device. */
+
+#define LINK_COUNT              (4)
+#define DEVICE_COUNT            (40)
+#define ADDRESS_FIRST           (0x0100)
+
+/** One way latency of an advertising bearer segment, including retransmission delays. */
+#define SEGMENT_LATENCY_US      (30000)
+/** Payload bytes in each PB-ADV segment. */
+#define SEGMENT_PAYLOAD_SIZE    (20)
+/** Time the provisioner spends calculating the ECDH shared secret. */
+#define ECDH_DURATION_US        (200000)
+
+#define SIM_EVENT_QUEUE_SIZE    (64)
+#define SIM_PACKET_MAXLEN       (80)
+
+typedef enum
+{
+    SIM_EVT_OPENED,
+    SIM_EVT_RX,
+    SIM_EVT_ACK,
+    SIM_EVT_CLOSED
+} sim_evt_type_t;
+
+typedef struct
+{
+    timestamp_t time;
+    uint32_t sequence;
+    sim_evt_type_t type;
+    prov_bearer_t * p_bearer;
+    nrf_mesh_prov_link_close_reason_t reason;
+    uint16_t length;
+    uint8_t data[SIM_PACKET_MAXLEN];
+} sim_evt_t;
+
+typedef struct
+{
+    nrf_mesh_prov_ctx_t ctx;
+    prov_bearer_t bearer;
+    uint8_t uuid[NRF_MESH_UUID_SIZE];
+    uint8_t num_elements;
+    bool listening;
+    bool provisioned;
+} sim_device_t;
+
+static uint32_t sim_tx(prov_bearer_t * p_bearer, const uint8_t * p_data, uint16_t length);
+static uint32_t sim_listen_start(prov_bearer_t * p_bearer, const char * p_uri, uint16_t oob_info, uint32_t link_timeout_us);
+static uint32_t sim_listen_stop(prov_bearer_t * p_bearer);
+static uint32_t sim_link_open(prov_bearer_t * p_bearer, const uint8_t * p_uuid, uint32_t link_timeout_us);
+static void sim_link_close(prov_bearer_t * p_bearer, nrf_mesh_prov_link_close_reason_t close_reason);
+
+static const prov_bearer_interface_t m_sim_interface =
+{
+    .tx = sim_tx,
+    .listen_start = sim_listen_start,
+    .listen_stop = sim_listen_stop,
+    .link_open = sim_link_open,
+    .link_close = sim_link_close
+};
+
+static const uint8_t m_public_key[NRF_MESH_PROV_PUBKEY_SIZE] = {1};
+static const uint8_t m_private_key[NRF_MESH_PROV_PRIVKEY_SIZE] = {2};
+
+static nrf_mesh_prov_scheduler_link_t m_links[LINK_COUNT];
+static prov_bearer_t m_link_bearers[LINK_COUNT];
+static sim_device_t m_devices[DEVICE_COUNT];
+
+/* Peer bearer of every bearer with an open link. */
+static prov_bearer_t * mp_peers[LINK_COUNT + DEVICE_COUNT];
+
+static sim_evt_t m_sim_events[SIM_EVENT_QUEUE_SIZE];
+static uint32_t m_sim_event_count;
+static uint32_t m_sim_sequence;
+static timestamp_t m_now;
+
+static uint32_t m_provisioned_count;
+static uint32_t m_failed_count;
+static uint32_t m_idle_count;
+static nrf_mesh_prov_scheduler_evt_device_failed_t m_last_failure;
+static uint16_t m_addresses[DEVICE_COUNT];
+static timestamp_t m_end_time;
+
+/******** Simulated bearer ********/
+
+static uint32_t bearer_index(const prov_bearer_t * p_bearer)
+{
+    if (p_bearer >= &m_link_bearers[0] && p_bearer < &m_link_bearers[LINK_COUNT])
+    {
+        return p_bearer - &m_link_bearers[0];
+    }
+    return LINK_COUNT + (PARENT_BY_FIELD_GET(sim_device_t, bearer, p_bearer) - &m_devices[0]);
+}
+
+static void sim_event_post(uint32_t delay_us, sim_evt_type_t type, prov_bearer_t * p_bearer,
+                           const uint8_t * p_data, uint16_t length, nrf_mesh_prov_link_close_reason_t reason)
+{
+    TEST_ASSERT_TRUE(m_sim_event_count < SIM_EVENT_QUEUE_SIZE);
+    TEST_ASSERT_TRUE(length <= SIM_PACKET_MAXLEN);
+    sim_evt_t * p_evt = &m_sim_events[m_sim_event_count++];
+    p_evt->time = m_now + delay_us;
+    p_evt->sequence = m_sim_sequence++;
+    p_evt->type = type;
+    p_evt->p_bearer = p_bearer;
+    p_evt->reason = reason;
+    p_evt->length = length;
+    if (length > 0)
+    {
+        memcpy(p_evt->data, p_data, length);
+    }
+}
+
+static uint32_t transfer_time_us(uint16_t length)
+{
+    return SEGMENT_LATENCY_US * (1 + length / SEGMENT_PAYLOAD_SIZE);
+}
+
+static uint32_t sim_tx(prov_bearer_t * p_bearer, const uint8_t * p_data, uint16_t length)
+{
+    prov_bearer_t * p_peer = mp_peers[bearer_index(p_bearer)];
+    TEST_ASSERT_NOT_NULL(p_peer);
+    uint32_t delay = transfer_time_us(length);
+    sim_event_post(delay, SIM_EVT_RX, p_peer, p_data, length, 0);
+    sim_event_post(delay + SEGMENT_LATENCY_US, SIM_EVT_ACK, p_bearer, NULL, 0, 0);
+    return NRF_SUCCESS;
+}
+
+static uint32_t sim_listen_start(prov_bearer_t * p_bearer, const char * p_uri, uint16_t oob_info, uint32_t link_timeout_us)
+{
+    PARENT_BY_FIELD_GET(sim_device_t, bearer, p_bearer)->listening = true;
+    return NRF_SUCCESS;
+}
+
+static uint32_t sim_listen_stop(prov_bearer_t * p_bearer)
+{
+    PARENT_BY_FIELD_GET(sim_device_t, bearer, p_bearer)->listening = false;
+    return NRF_SUCCESS;
+}
+
+static uint32_t sim_link_open(prov_bearer_t * p_bearer, const uint8_t * p_uuid, uint32_t link_timeout_us)
+{
+    TEST_ASSERT_NULL(mp_peers[bearer_index(p_bearer)]);
+    for (uint32_t i = 0; i < DEVICE_COUNT; ++i)
+    {
+        if (m_devices[i].listening && memcmp(m_devices[i].uuid, p_uuid, NRF_MESH_UUID_SIZE) == 0)
+        {
+            m_devices[i].listening = false;
+            mp_peers[bearer_index(p_bearer)] = &m_devices[i].bearer;
+            mp_peers[bearer_index(&m_devices[i].bearer)] = p_bearer;
+            /* Link Open and Link Ack. */
+            sim_event_post(SEGMENT_LATENCY_US, SIM_EVT_OPENED, &m_devices[i].bearer, NULL, 0, 0);
+            sim_event_post(2 * SEGMENT_LATENCY_US, SIM_EVT_OPENED, p_bearer, NULL, 0, 0);
+            return NRF_SUCCESS;
+        }
+    }
+    TEST_FAIL_MESSAGE("Link opened to unknown device");
+    return NRF_ERROR_NOT_FOUND;
+}
+
+static void sim_link_close(prov_bearer_t * p_bearer, nrf_mesh_prov_link_close_reason_t close_reason)
+{
+    prov_bearer_t * p_peer = mp_peers[bearer_index(p_bearer)];
+    TEST_ASSERT_NOT_NULL(p_peer);
+    mp_peers[bearer_index(p_bearer)] = NULL;
+    mp_peers[bearer_index(p_peer)] = NULL;
+    /* Link Close is repeated a few times before the sender considers the link closed. */
+    sim_event_post(SEGMENT_LATENCY_US, SIM_EVT_CLOSED, p_peer, NULL, 0, close_reason);
+    sim_event_post(3 * SEGMENT_LATENCY_US, SIM_EVT_CLOSED, p_bearer, NULL, 0, close_reason);
+}
+
+/* Processes the next simulated event in time order. */
+static void sim_step(void)
+{
+    TEST_ASSERT_TRUE(m_sim_event_count > 0);
+    uint32_t next = 0;
+    for (uint32_t i = 1; i < m_sim_event_count; ++i)
+    {
+        if (TIMER_OLDER_THAN(m_sim_events[i].time, m_sim_events[next].time) ||
+            (m_sim_events[i].time == m_sim_events[next].time &&
+             m_sim_events[i].sequence < m_sim_events[next].sequence))
+        {
+            next = i;
+        }
+    }
+
+    sim_evt_t evt = m_sim_events[next];
+    m_sim_events[next] = m_sim_events[--m_sim_event_count];
+
+    /* The CPU may have been busy past the event time. */
+    if (TIMER_OLDER_THAN(m_now, evt.time))
+    {
+        m_now = evt.time;
+    }
+
+    switch (evt.type)
+    {
+        case SIM_EVT_OPENED:
+            evt.p_bearer->p_callbacks->opened(evt.p_bearer);
+            break;
+        case SIM_EVT_RX:
+            evt.p_bearer->p_callbacks->rx(evt.p_bearer, evt.data, evt.length);
+            break;
+        case SIM_EVT_ACK:
+            evt.p_bearer->p_callbacks->ack(evt.p_bearer);
+            break;
+        case SIM_EVT_CLOSED:
+            evt.p_bearer->p_callbacks->closed(evt.p_bearer, evt.reason);
+            break;
+    }
+}
+
+/* Processes simulated events until there are none left. */
+static void sim_run(void)
+{
+    while (m_sim_event_count > 0)
+    {
+        sim_step();
+    }
+}
+
+/******** Stubs ********/
+
+static timestamp_t timer_now_stub(int count)
+{
+    return m_now;
+}
+
+static bool ecdh_offloading_stub(int count)
+{
+    return false;
+}
+
+static uint32_t shared_secret_stub(const nrf_mesh_prov_ctx_t * p_ctx, uint8_t * p_shared_secret, int count)
+{
+    memset(p_shared_secret, 0xAB, NRF_MESH_PROV_ECDHSECRET_SIZE);
+    if (p_ctx->role == NRF_MESH_PROV_ROLE_PROVISIONER)
+    {
+        m_now += ECDH_DURATION_US;
+    }
+    return NRF_SUCCESS;
+}
+
+static void auth_values_derive_stub(const nrf_mesh_prov_ctx_t * p_ctx, uint8_t * p_confirmation_salt,
+                                    uint8_t * p_confirmation, uint8_t * p_random, int count)
+{
+    memset(p_confirmation_salt, 0x11, PROV_SALT_LEN);
+    memset(p_confirmation, 0x22, PROV_CONFIRMATION_LEN);
+    memset(p_random, 0x33, PROV_RANDOM_LEN);
+}
+
+static void derive_keys_stub(const nrf_mesh_prov_ctx_t * p_ctx, uint8_t * p_session_key,
+                             uint8_t * p_session_nonce, uint8_t * p_device_key, int count)
+{
+    memset(p_session_key, 0x44, NRF_MESH_KEY_SIZE);
+    memset(p_session_nonce, 0x55, PROV_NONCE_LEN);
+    memset(p_device_key, 0x66, NRF_MESH_KEY_SIZE);
+}
+
+static void generate_oob_data_stub(const nrf_mesh_prov_ctx_t * p_ctx, uint8_t * p_auth_value, int count)
+{
+    memset(p_auth_value, 0, PROV_AUTH_LEN);
+}
+
+static bool confirmation_check_stub(const nrf_mesh_prov_ctx_t * p_ctx, int count)
+{
+    return true;
+}
+
+static void ccm_encrypt_stub(ccm_soft_data_t * const p_ccm_data, int count)
+{
+    memmove(p_ccm_data->p_out, p_ccm_data->p_m, p_ccm_data->m_len);
+    memset(p_ccm_data->p_mic, 0, p_ccm_data->mic_len);
+}
+
+static void ccm_decrypt_stub(ccm_soft_data_t * const p_ccm_data, bool * const p_mic_passed, int count)
+{
+    memmove(p_ccm_data->p_out, p_ccm_data->p_m, p_ccm_data->m_len);
+    *p_mic_passed = true;
+}
+
+static nrf_mesh_address_type_t address_type_get_stub(uint16_t address, int count)
+{
+    if (address == 0)
+    {
+        return NRF_MESH_ADDRESS_TYPE_INVALID;
+    }
+    return (address < 0x8000) ? NRF_MESH_ADDRESS_TYPE_UNICAST : NRF_MESH_ADDRESS_TYPE_GROUP;
+}
+
+/******** Simulated devices ********/
+
+static void device_evt_handler(const nrf_mesh_prov_evt_t * p_evt)
+{
+    if (p_evt->type == NRF_MESH_PROV_EVT_COMPLETE)
+    {
+        sim_device_t * p_device = PARENT_BY_FIELD_GET(sim_device_t, ctx, p_evt->params.complete.p_context);
+        p_device->provisioned = true;
+    }
+}
+
+static void devices_init(void)
+{
+    memset(m_devices, 0, sizeof(m_devices));
+    for (uint32_t i = 0; i < DEVICE_COUNT; ++i)
+    {
+        sim_device_t * p_device = &m_devices[i];
+        p_device->uuid[0] = 0xDE;
+        p_device->uuid[1] = (uint8_t) i;
+        p_device->num_elements = 1 + (i % 3);
+        p_device->bearer.bearer_type = NRF_MESH_PROV_BEARER_ADV;
+        p_device->bearer.p_interface = &m_sim_interface;
+
+        nrf_mesh_prov_oob_caps_t caps = NRF_MESH_PROV_OOB_CAPS_DEFAULT(p_device->num_elements);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_init(&p_device->ctx, m_public_key, m_private_key,
+                                                          &caps, device_evt_handler));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_bearer_add(&p_device->ctx, &p_device->bearer));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_listen(&p_device->ctx, NULL, 0, NRF_MESH_PROV_BEARER_ADV));
+    }
+}
+
+/******** Scheduler ********/
+
+static void scheduler_evt_handler(const nrf_mesh_prov_scheduler_evt_t * p_evt)
+{
+    switch (p_evt->type)
+    {
+        case NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_PROVISIONED:
+        {
+            uint32_t index = p_evt->params.device_provisioned.p_uuid[1];
+            TEST_ASSERT_EQUAL(m_devices[index].num_elements, p_evt->params.device_provisioned.num_elements);
+            m_addresses[index] = p_evt->params.device_provisioned.address;
+            for (uint32_t i = 0; i < NRF_MESH_PROV_SCHEDULER_PHASE_CLOSE; ++i)
+            {
+                TEST_ASSERT_TRUE(p_evt->params.device_provisioned.p_phase_durations_us[i] > 0);
+            }
+            m_provisioned_count++;
+            break;
+        }
+        case NRF_MESH_PROV_SCHEDULER_EVT_DEVICE_FAILED:
+            m_last_failure = p_evt->params.device_failed;
+            m_failed_count++;
+            break;
+        case NRF_MESH_PROV_SCHEDULER_EVT_IDLE:
+            m_idle_count++;
+            m_end_time = m_now;
+            break;
+        default:
+            TEST_FAIL();
+            break;
+    }
+}
+
+static void scheduler_init(uint32_t link_count, uint16_t address_last)
+{
+    nrf_mesh_prov_scheduler_init_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.p_links = m_links;
+    params.link_count = link_count;
+    params.p_public_key = m_public_key;
+    params.p_private_key = m_private_key;
+    params.prov_data.address = ADDRESS_FIRST;
+    params.prov_data.netkey_index = 0;
+    params.prov_data.iv_index = 0;
+    params.address_last = address_last;
+    params.evt_cb = scheduler_evt_handler;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_init(&params));
+}
+
+/* Provisions all simulated devices and returns the total simulated time. */
+static timestamp_t provision_all(uint32_t link_count)
+{
+    timestamp_t start = m_now;
+    scheduler_init(link_count, 0x7FFF);
+
+    uint32_t added = 0;
+    while (added < DEVICE_COUNT)
+    {
+        while (added < DEVICE_COUNT &&
+               nrf_mesh_prov_scheduler_queue_length_get() < NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE)
+        {
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_device_add(m_devices[added].uuid));
+            added++;
+        }
+
+        /* Run until the queue has room, as an application scanning for beacons would. */
+        while (m_sim_event_count > 0 &&
+               nrf_mesh_prov_scheduler_queue_length_get() == NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE)
+        {
+            sim_step();
+        }
+    }
+    sim_run();
+
+    TEST_ASSERT_EQUAL(DEVICE_COUNT, m_provisioned_count);
+    TEST_ASSERT_EQUAL(0, m_failed_count);
+    TEST_ASSERT_EQUAL(0, nrf_mesh_prov_scheduler_active_link_count_get());
+    return m_end_time - start;
+}
+
+static void sim_reset(void)
+{
+    memset(m_links, 0, sizeof(m_links));
+    memset(m_link_bearers, 0, sizeof(m_link_bearers));
+    memset(mp_peers, 0, sizeof(mp_peers));
+    for (uint32_t i = 0; i < LINK_COUNT; ++i)
+    {
+        m_link_bearers[i].bearer_type = NRF_MESH_PROV_BEARER_ADV;
+        m_link_bearers[i].p_interface = &m_sim_interface;
+        m_links[i].p_bearer = &m_link_bearers[i];
+    }
+    m_sim_event_count = 0;
+    m_provisioned_count = 0;
+    m_failed_count = 0;
+    m_idle_count = 0;
+    memset(m_addresses, 0, sizeof(m_addresses));
+    devices_init();
+}
+
+/******** Setup ********/
+
+void setUp(void)
+{
+    prov_utils_mock_Init();
+    prov_beacon_mock_Init();
+    enc_mock_Init();
+    nrf_mesh_utils_mock_Init();
+    timer_mock_Init();
+
+    timer_now_StubWithCallback(timer_now_stub);
+    prov_utils_use_ecdh_offloading_StubWithCallback(ecdh_offloading_stub);
+    prov_utils_calculate_shared_secret_StubWithCallback(shared_secret_stub);
+    prov_utils_authentication_values_derive_StubWithCallback(auth_values_derive_stub);
+    prov_utils_derive_keys_StubWithCallback(derive_keys_stub);
+    prov_utils_generate_oob_data_StubWithCallback(generate_oob_data_stub);
+    prov_utils_confirmation_check_StubWithCallback(confirmation_check_stub);
+    enc_aes_ccm_encrypt_StubWithCallback(ccm_encrypt_stub);
+    enc_aes_ccm_decrypt_StubWithCallback(ccm_decrypt_stub);
+    nrf_mesh_address_type_get_StubWithCallback(address_type_get_stub);
+
+    m_now = 0;
+    sim_reset();
+}
+
+void tearDown(void)
+{
+    prov_utils_mock_Verify();
+    prov_utils_mock_Destroy();
+    prov_beacon_mock_Verify();
+    prov_beacon_mock_Destroy();
+    enc_mock_Verify();
+    enc_mock_Destroy();
+    nrf_mesh_utils_mock_Verify();
+    nrf_mesh_utils_mock_Destroy();
+    timer_mock_Verify();
+    timer_mock_Destroy();
+}
+
+/******** Tests ********/
+
+void test_parallel_provisioning(void)
+{
+    (void) provision_all(LINK_COUNT);
+    TEST_ASSERT_EQUAL(1, m_idle_count);
+
+    /* Every device gets its own consecutive address range. */
+    uint32_t element_count = 0;
+    for (uint32_t i = 0; i < DEVICE_COUNT; ++i)
+    {
+        TEST_ASSERT_TRUE(m_devices[i].provisioned);
+        TEST_ASSERT_TRUE(m_addresses[i] >= ADDRESS_FIRST);
+        for (uint32_t j = 0; j < DEVICE_COUNT; ++j)
+        {
+            if (i != j)
+            {
+                TEST_ASSERT_TRUE(m_addresses[i] + m_devices[i].num_elements <= m_addresses[j] ||
+                                 m_addresses[j] + m_devices[j].num_elements <= m_addresses[i]);
+            }
+        }
+        TEST_ASSERT_EQUAL(m_addresses[i], m_devices[i].ctx.data.address);
+        element_count += m_devices[i].num_elements;
+    }
+
+    uint16_t address_max = 0;
+    for (uint32_t i = 0; i < DEVICE_COUNT; ++i)
+    {
+        if (m_addresses[i] + m_devices[i].num_elements > address_max)
+        {
+            address_max = m_addresses[i] + m_devices[i].num_elements;
+        }
+    }
+    TEST_ASSERT_EQUAL(ADDRESS_FIRST + element_count, address_max);
+
+    const nrf_mesh_prov_scheduler_stats_t * p_stats = nrf_mesh_prov_scheduler_stats_get();
+    TEST_ASSERT_EQUAL(DEVICE_COUNT, p_stats->devices_provisioned);
+    TEST_ASSERT_EQUAL(0, p_stats->devices_failed);
+    for (uint32_t i = 0; i < NRF_MESH_PROV_SCHEDULER_PHASE_COUNT; ++i)
+    {
+        TEST_ASSERT_TRUE(p_stats->phase_max_us[i] > 0);
+        TEST_ASSERT_TRUE(p_stats->phase_total_us[i] >= p_stats->phase_max_us[i]);
+    }
+    /* The ECDH calculation is part of the provisioning phase. */
+    TEST_ASSERT_TRUE(p_stats->phase_max_us[NRF_MESH_PROV_SCHEDULER_PHASE_PROVISION] >= ECDH_DURATION_US);
+}
+
+void test_parallel_speedup(void)
+{
+    timestamp_t serial_time = provision_all(1);
+
+    sim_reset();
+    timestamp_t parallel_time = provision_all(LINK_COUNT);
+
+    printf("Provisioned %u devices in %u ms with 1 link, %u ms with %u links\n",
+           DEVICE_COUNT, serial_time / 1000, parallel_time / 1000, LINK_COUNT);
+
+    /* The ECDH calculation blocks all links while it runs, which keeps the speedup below the
+     * link count. */
+    TEST_ASSERT_TRUE(parallel_time * 2 < serial_time);
+}
+
+void test_device_add(void)
+{
+    scheduler_init(1, 0x7FFF);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, nrf_mesh_prov_scheduler_device_add(NULL));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_device_add(m_devices[0].uuid));
+    TEST_ASSERT_EQUAL(1, nrf_mesh_prov_scheduler_active_link_count_get());
+    TEST_ASSERT_EQUAL(0, nrf_mesh_prov_scheduler_queue_length_get());
+
+    /* Devices being provisioned or queued can't be added again. */
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, nrf_mesh_prov_scheduler_device_add(m_devices[0].uuid));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_device_add(m_devices[1].uuid));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_STATE, nrf_mesh_prov_scheduler_device_add(m_devices[1].uuid));
+
+    for (uint32_t i = 2; i < NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE + 1; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_device_add(m_devices[i].uuid));
+    }
+    TEST_ASSERT_EQUAL(NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE, nrf_mesh_prov_scheduler_queue_length_get());
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM,
+                      nrf_mesh_prov_scheduler_device_add(m_devices[NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE + 1].uuid));
+
+    sim_run();
+    TEST_ASSERT_EQUAL(NRF_MESH_PROV_SCHEDULER_QUEUE_SIZE + 1, m_provisioned_count);
+    TEST_ASSERT_EQUAL(1, m_idle_count);
+}
+
+void test_address_exhaustion(void)
+{
+    /* Devices 0, 1 and 2 have 1, 2 and 3 elements, only the first two fit. */
+    scheduler_init(1, ADDRESS_FIRST + 2);
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, nrf_mesh_prov_scheduler_device_add(m_devices[i].uuid));
+    }
+    sim_run();
+
+    TEST_ASSERT_EQUAL(2, m_provisioned_count);
+    TEST_ASSERT_EQUAL(ADDRESS_FIRST, m_addresses[0]);
+    TEST_ASSERT_EQUAL(ADDRESS_FIRST + 1, m_addresses[1]);
+
+    TEST_ASSERT_EQUAL(1, m_failed_count);
+    TEST_ASSERT_FALSE(m_devices[2].provisioned);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_devices[2].uuid, m_last_failure.p_uuid, NRF_MESH_UUID_SIZE);
+    TEST_ASSERT_EQUAL(NRF_MESH_PROV_SCHEDULER_PHASE_PROVISION, m_last_failure.phase);
+    TEST_ASSERT_EQUAL(NRF_MESH_PROV_FAILURE_CODE_OUT_OF_RESOURCES, m_last_failure.failure_code);
+
+    const nrf_mesh_prov_scheduler_stats_t * p_stats = nrf_mesh_prov_scheduler_stats_get();
+    TEST_ASSERT_EQUAL(2, p_stats->devices_provisioned);
+    TEST_ASSERT_EQUAL(1, p_stats->devices_failed);
+    TEST_ASSERT_EQUAL(1, m_idle_count);
+}
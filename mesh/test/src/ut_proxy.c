@@ -392,7 +392,8 @@ void test_tx_mesh(void)
     TEST_ASSERT_NOT_NULL(p_if);
     TEST_ASSERT_NOT_NULL(p_bearer);
 
-    packet_mesh_net_packet_t net_packet;
+    core_tx_pdu_t pdu;
+    memset(&pdu, 0, sizeof(pdu));
 
     network_packet_metadata_t net_metadata;
     net_metadata.dst.value = 0x1234;
@@ -410,8 +411,22 @@ void test_tx_mesh(void)
 
     TEST_ASSERT_EQUAL(CORE_TX_ALLOC_SUCCESS, p_if->packet_alloc(p_bearer, &params));
     TEST_ASSERT_TRUE(gatt_tx_packet_is_allocated());
-    p_if->packet_send(p_bearer, net_packet.pdu, params.net_packet_len);
+    /* Shared network PDUs are sent by reference: */
+    for (uint32_t i = 0; i < params.net_packet_len; ++i)
+    {
+        pdu.packet.pdu[i] = i;
+    }
+    pdu.length   = params.net_packet_len;
+    pdu.refcount = 1;
+    p_if->packet_send_shared(p_bearer, &pdu);
     TEST_ASSERT_FALSE(gatt_tx_packet_is_allocated());
+    uint16_t size;
+    uint8_t * p_sent = gatt_tx_packet_get(&size);
+    TEST_ASSERT_EQUAL(params.net_packet_len, size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(pdu.packet.pdu, p_sent, size);
+    /* The bearer released its reference: */
+    TEST_ASSERT_EQUAL(1, core_tx_pdu_release_count());
+    TEST_ASSERT_EQUAL(0, pdu.refcount);
 
     /* Filter rejects the packet: */
     proxy_filter_accept_ExpectAndReturn(NULL, 0x1234, false);
@@ -429,6 +444,88 @@ void test_tx_mesh(void)
     TEST_ASSERT_FALSE(gatt_tx_packet_is_allocated());
 }
 
+void test_tx_mesh_copy(void)
+{
+    cache_init_ExpectAnyArgs();
+    init();
+    establish_connection(0);
+
+    const core_tx_bearer_interface_t * p_if = core_tx_if_get();
+    core_tx_bearer_t * p_bearer = core_tx_bearer_get();
+
+    network_packet_metadata_t net_metadata;
+    net_metadata.dst.value = 0x1234;
+    net_metadata.dst.type  = NRF_MESH_ADDRESS_TYPE_UNICAST;
+
+    core_tx_alloc_params_t params;
+    params.net_packet_len = 20;
+    params.role           = CORE_TX_ROLE_ORIGINATOR;
+    params.token          = TX_TOKEN;
+    params.p_metadata     = &net_metadata;
+
+    core_tx_pdu_t pdu;
+    memset(&pdu, 0, sizeof(pdu));
+    for (uint32_t i = 0; i < params.net_packet_len; ++i)
+    {
+        pdu.packet.pdu[i] = i;
+    }
+    pdu.length = params.net_packet_len;
+
+    uint16_t size;
+    uint8_t * p_sent;
+    const uint32_t shared_pdu_count_max = CORE_TX_SHARED_PDU_COUNT / MESH_GATT_CONNECTION_COUNT_MAX;
+
+    /* The packet isn't staged in a shared PDU, so the connection gets a copy: */
+    core_tx_packet_shared_set(false);
+    proxy_filter_accept_ExpectAndReturn(NULL, 0x1234, true);
+    proxy_filter_accept_IgnoreArg_p_filter();
+    TEST_ASSERT_EQUAL(CORE_TX_ALLOC_SUCCESS, p_if->packet_alloc(p_bearer, &params));
+    p_if->packet_send(p_bearer, pdu.packet.pdu, pdu.length);
+    p_sent = gatt_tx_packet_get(&size);
+    TEST_ASSERT_EQUAL(params.net_packet_len, size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(pdu.packet.pdu, p_sent, size);
+    core_tx_packet_shared_set(true);
+
+    /* The connection holds on to the shared PDUs until they're transmitted: */
+    gatt_tx_refs_hold_set(true);
+    for (uint32_t i = 0; i < shared_pdu_count_max; ++i)
+    {
+        proxy_filter_accept_ExpectAndReturn(NULL, 0x1234, true);
+        proxy_filter_accept_IgnoreArg_p_filter();
+        TEST_ASSERT_EQUAL(CORE_TX_ALLOC_SUCCESS, p_if->packet_alloc(p_bearer, &params));
+        pdu.refcount = 1;
+        p_if->packet_send_shared(p_bearer, &pdu);
+        TEST_ASSERT_EQUAL(1, pdu.refcount);
+    }
+    TEST_ASSERT_EQUAL(0, core_tx_pdu_release_count());
+
+    /* Once the connection holds its share of the pool, shared PDUs are copied, and released right away: */
+    proxy_filter_accept_ExpectAndReturn(NULL, 0x1234, true);
+    proxy_filter_accept_IgnoreArg_p_filter();
+    TEST_ASSERT_EQUAL(CORE_TX_ALLOC_SUCCESS, p_if->packet_alloc(p_bearer, &params));
+    memset(&pdu.packet.pdu[0], 0xab, pdu.length);
+    pdu.refcount = 1;
+    p_if->packet_send_shared(p_bearer, &pdu);
+    TEST_ASSERT_EQUAL(0, pdu.refcount);
+    TEST_ASSERT_EQUAL(1, core_tx_pdu_release_count());
+    p_sent = gatt_tx_packet_get(&size);
+    TEST_ASSERT_EQUAL(params.net_packet_len, size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(pdu.packet.pdu, p_sent, size);
+
+    /* The connection may take references again when it has transmitted its packets: */
+    pdu.refcount = shared_pdu_count_max;
+    TEST_ASSERT_EQUAL(shared_pdu_count_max, gatt_tx_refs_release());
+    TEST_ASSERT_EQUAL(0, pdu.refcount);
+    gatt_tx_refs_hold_set(false);
+
+    proxy_filter_accept_ExpectAndReturn(NULL, 0x1234, true);
+    proxy_filter_accept_IgnoreArg_p_filter();
+    TEST_ASSERT_EQUAL(CORE_TX_ALLOC_SUCCESS, p_if->packet_alloc(p_bearer, &params));
+    pdu.refcount = 1;
+    p_if->packet_send_shared(p_bearer, &pdu);
+    TEST_ASSERT_EQUAL(shared_pdu_count_max + 2, core_tx_pdu_release_count());
+}
+
 /**
  * Test various events that should trigger the proxy server to send beacons to the connected device:
  * 1. On TX ready (send beacon for all secmats)
@@ -0,0 +1,400 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "relay_policy.h"
+#include "test_assert.h"
+#include "utils.h"
+
+#define SRC      (0x0001)
+#define SEQNUM   (0x000100)
+#define IV_INDEX (0x12345678)
+
+static relay_policy_t m_policy;
+static timestamp_t m_now;
+static timer_event_t * mp_timer;
+static uint32_t m_relay_count;
+static network_packet_metadata_t m_relayed_metadata;
+static packet_mesh_net_packet_t m_relayed_packet;
+static uint8_t m_relayed_payload_len;
+
+/* ******************* Fakes ******************* */
+
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    p_timer_evt->state = TIMER_EVENT_STATE_ADDED;
+    mp_timer = p_timer_evt;
+}
+
+static void relay_cb(relay_policy_t * p_policy,
+                     network_packet_metadata_t * p_net_metadata,
+                     const packet_mesh_net_packet_t * p_net_packet,
+                     uint8_t payload_len)
+{
+    TEST_ASSERT_EQUAL_PTR(&m_policy, p_policy);
+    m_relay_count++;
+    m_relayed_metadata = *p_net_metadata;
+    m_relayed_packet = *p_net_packet;
+    m_relayed_payload_len = payload_len;
+}
+
+/* ******************* Helpers ******************* */
+
+static void metadata_build(network_packet_metadata_t * p_metadata, uint32_t sequence_number)
+{
+    memset(p_metadata, 0, sizeof(network_packet_metadata_t));
+    p_metadata->dst.value = 0xC001;
+    p_metadata->dst.type = NRF_MESH_ADDRESS_TYPE_GROUP;
+    p_metadata->src = SRC;
+    p_metadata->ttl = 5;
+    p_metadata->internal.sequence_number = sequence_number;
+    p_metadata->internal.iv_index = IV_INDEX;
+}
+
+static void rx_metadata_build(nrf_mesh_rx_metadata_t * p_rx_metadata, int8_t rssi, uint8_t addr)
+{
+    memset(p_rx_metadata, 0, sizeof(nrf_mesh_rx_metadata_t));
+    p_rx_metadata->source = NRF_MESH_RX_SOURCE_SCANNER;
+    p_rx_metadata->params.scanner.rssi = rssi;
+    p_rx_metadata->params.scanner.adv_addr.addr[0] = addr;
+}
+
+static void config_set(relay_policy_type_t type)
+{
+    relay_policy_config_t config;
+    relay_policy_config_get(&m_policy, &config);
+    config.type = type;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, relay_policy_config_set(&m_policy, &config));
+}
+
+/** Fires the policy timer, if it has been ordered, at its timestamp. */
+static void timer_fire(void)
+{
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    timer_event_t * p_timer = mp_timer;
+    mp_timer = NULL;
+    m_now = p_timer->timestamp;
+    p_timer->state = TIMER_EVENT_STATE_IN_CALLBACK;
+    p_timer->cb(m_now, p_timer->p_context);
+}
+
+/* ******************* Setup ******************* */
+
+void setUp(void)
+{
+    m_now = 1000;
+    mp_timer = NULL;
+    m_relay_count = 0;
+    relay_policy_init(&m_policy, relay_cb);
+}
+
+void tearDown(void)
+{
+}
+
+/* ******************* Tests ******************* */
+
+void test_config(void)
+{
+    relay_policy_config_t config;
+    relay_policy_config_get(&m_policy, &config);
+    TEST_ASSERT_EQUAL(RELAY_POLICY_TYPE_ALWAYS, config.type);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, relay_policy_config_set(&m_policy, NULL));
+
+    relay_policy_config_t invalid = config;
+    invalid.type = (relay_policy_type_t) (RELAY_POLICY_TYPE_DENSITY + 1);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_policy_config_set(&m_policy, &invalid));
+    invalid = config;
+    invalid.counter_threshold = 0;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_policy_config_set(&m_policy, &invalid));
+    invalid = config;
+    invalid.backoff_max_us = 0;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_policy_config_set(&m_policy, &invalid));
+    invalid = config;
+    invalid.density_target = 0;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_policy_config_set(&m_policy, &invalid));
+
+    config.type = RELAY_POLICY_TYPE_RSSI;
+    config.rssi_threshold = -42;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, relay_policy_config_set(&m_policy, &config));
+    relay_policy_config_t readback;
+    relay_policy_config_get(&m_policy, &readback);
+    TEST_ASSERT_EQUAL_MEMORY(&config, &readback, sizeof(config));
+
+    TEST_NRF_MESH_ASSERT_EXPECT(relay_policy_init(NULL, relay_cb));
+    TEST_NRF_MESH_ASSERT_EXPECT(relay_policy_init(&m_policy, NULL));
+}
+
+void test_always(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    metadata_build(&metadata, SEQNUM);
+    rx_metadata_build(&rx_metadata, -20, 1);
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    }
+    /* Duplicates are ignored. */
+    relay_policy_duplicate_in(&m_policy, SRC, SEQNUM);
+    TEST_ASSERT_NULL(mp_timer);
+
+    relay_policy_stats_t stats;
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(10, stats.relayed);
+    TEST_ASSERT_EQUAL(0, stats.duplicates);
+    relay_policy_stats_clear(&m_policy);
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(0, stats.relayed);
+}
+
+void test_counter(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    rx_metadata_build(&rx_metadata, -20, 1);
+    for (uint32_t i = 0; i < sizeof(packet); ++i)
+    {
+        packet.pdu[i] = i;
+    }
+    config_set(RELAY_POLICY_TYPE_COUNTER);
+    relay_policy_config_t config;
+    relay_policy_config_get(&m_policy, &config);
+
+    /* Heard fewer times than the threshold during the back-off: relayed at the end of it. */
+    metadata_build(&metadata, SEQNUM);
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    TEST_ASSERT_TRUE(mp_timer->timestamp - m_now < config.backoff_max_us);
+    for (uint32_t i = 0; i < config.counter_threshold - 2U; ++i)
+    {
+        relay_policy_duplicate_in(&m_policy, SRC, SEQNUM);
+    }
+    /* Other packets don't count. */
+    relay_policy_duplicate_in(&m_policy, SRC, SEQNUM + 1);
+    relay_policy_duplicate_in(&m_policy, SRC + 1, SEQNUM);
+    timer_fire();
+    TEST_ASSERT_EQUAL(1, m_relay_count);
+    TEST_ASSERT_EQUAL_MEMORY(&metadata, &m_relayed_metadata, sizeof(metadata));
+    TEST_ASSERT_EQUAL_MEMORY(&packet, &m_relayed_packet, PACKET_MESH_NET_PDU_OFFSET + 10);
+    TEST_ASSERT_EQUAL(10, m_relayed_payload_len);
+    TEST_ASSERT_NULL(mp_timer);
+
+    /* Heard as many times as the threshold: suppressed. */
+    metadata_build(&metadata, SEQNUM + 1);
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    for (uint32_t i = 0; i < config.counter_threshold - 1U; ++i)
+    {
+        relay_policy_duplicate_in(&m_policy, SRC, SEQNUM + 1);
+    }
+    timer_fire();
+    TEST_ASSERT_EQUAL(1, m_relay_count);
+
+    relay_policy_stats_t stats;
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(1, stats.relayed);
+    TEST_ASSERT_EQUAL(2, stats.deferred);
+    TEST_ASSERT_EQUAL(1, stats.suppressed_counter);
+    TEST_ASSERT_EQUAL(config.counter_threshold - 2U + config.counter_threshold - 1U, stats.duplicates);
+}
+
+void test_counter_pending_full(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    rx_metadata_build(&rx_metadata, -20, 1);
+    config_set(RELAY_POLICY_TYPE_COUNTER);
+
+    for (uint32_t i = 0; i < RELAY_POLICY_PENDING_COUNT; ++i)
+    {
+        metadata_build(&metadata, SEQNUM + i);
+        TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    }
+    /* Relayed right away when there's no room to defer it. */
+    metadata_build(&metadata, SEQNUM + RELAY_POLICY_PENDING_COUNT);
+    TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+
+    /* The timer is ordered for the earliest deadline, and all deferred packets come out in the end. */
+    uint32_t fired = 0;
+    timestamp_t last = 0;
+    while (mp_timer != NULL)
+    {
+        TEST_ASSERT_TRUE(fired == 0 || !TIMER_OLDER_THAN(mp_timer->timestamp, last));
+        last = mp_timer->timestamp;
+        timer_fire();
+        fired++;
+    }
+    TEST_ASSERT_EQUAL(RELAY_POLICY_PENDING_COUNT, m_relay_count);
+
+    relay_policy_stats_t stats;
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(RELAY_POLICY_PENDING_COUNT + 1, stats.relayed);
+    TEST_ASSERT_EQUAL(1, stats.deferred_full);
+}
+
+void test_counter_timer_early(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    rx_metadata_build(&rx_metadata, -20, 1);
+    config_set(RELAY_POLICY_TYPE_COUNTER);
+
+    metadata_build(&metadata, SEQNUM);
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    TEST_ASSERT_NOT_NULL(mp_timer);
+
+    /* The scheduler fires timers within a small margin of their timestamp. The packet must be
+     * relayed, instead of ordering the timer for the same deadline again. */
+    timer_event_t * p_timer = mp_timer;
+    mp_timer = NULL;
+    m_now = p_timer->timestamp - 10;
+    p_timer->state = TIMER_EVENT_STATE_IN_CALLBACK;
+    p_timer->cb(m_now, p_timer->p_context);
+    TEST_ASSERT_EQUAL(1, m_relay_count);
+    TEST_ASSERT_NULL(mp_timer);
+}
+
+void test_rssi(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    metadata_build(&metadata, SEQNUM);
+    config_set(RELAY_POLICY_TYPE_RSSI);
+    relay_policy_config_t config;
+    relay_policy_config_get(&m_policy, &config);
+
+    /* Packets from nearby nodes aren't relayed. */
+    rx_metadata_build(&rx_metadata, config.rssi_threshold, 1);
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    rx_metadata_build(&rx_metadata, config.rssi_threshold + 10, 1);
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    rx_metadata_build(&rx_metadata, config.rssi_threshold - 1, 1);
+    TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+
+    rx_metadata.source = NRF_MESH_RX_SOURCE_INSTABURST;
+    rx_metadata.params.instaburst.rssi = config.rssi_threshold;
+    TEST_ASSERT_FALSE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+
+    /* Packets without an RSSI are always relayed. */
+    rx_metadata.source = NRF_MESH_RX_SOURCE_GATT;
+    TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+
+    relay_policy_stats_t stats;
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(2, stats.relayed);
+    TEST_ASSERT_EQUAL(3, stats.suppressed_rssi);
+}
+
+void test_density(void)
+{
+    network_packet_metadata_t metadata;
+    nrf_mesh_rx_metadata_t rx_metadata;
+    packet_mesh_net_packet_t packet;
+    metadata_build(&metadata, SEQNUM);
+
+    /* Neighbours are only tracked with the density policy. */
+    rx_metadata_build(&rx_metadata, -20, 1);
+    relay_policy_neighbour_heard(&m_policy, &rx_metadata);
+    TEST_ASSERT_EQUAL(0, relay_policy_neighbour_count_get(&m_policy));
+
+    config_set(RELAY_POLICY_TYPE_DENSITY);
+    relay_policy_config_t config;
+    relay_policy_config_get(&m_policy, &config);
+
+    /* Each neighbour is counted once. */
+    for (uint32_t i = 0; i < config.density_target; ++i)
+    {
+        rx_metadata_build(&rx_metadata, -20, i);
+        relay_policy_neighbour_heard(&m_policy, &rx_metadata);
+        relay_policy_neighbour_heard(&m_policy, &rx_metadata);
+    }
+    TEST_ASSERT_EQUAL(config.density_target, relay_policy_neighbour_count_get(&m_policy));
+
+    /* Always relay when there are few neighbours. */
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+    }
+
+    /* With more neighbours than the table can hold, the table is full, and the probability of
+     * relaying is the target divided by the table size. */
+    for (uint32_t i = 0; i < 2 * RELAY_POLICY_NEIGHBOUR_COUNT; ++i)
+    {
+        m_now++;
+        rx_metadata_build(&rx_metadata, -20, i);
+        relay_policy_neighbour_heard(&m_policy, &rx_metadata);
+    }
+    TEST_ASSERT_EQUAL(RELAY_POLICY_NEIGHBOUR_COUNT, relay_policy_neighbour_count_get(&m_policy));
+
+    const uint32_t packets = 10000;
+    uint32_t relayed = 0;
+    for (uint32_t i = 0; i < packets; ++i)
+    {
+        relayed += relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata);
+    }
+    uint32_t expected = packets * config.density_target / RELAY_POLICY_NEIGHBOUR_COUNT;
+    TEST_ASSERT_UINT32_WITHIN(expected / 5, expected, relayed);
+
+    relay_policy_stats_t stats;
+    relay_policy_stats_get(&m_policy, &stats);
+    TEST_ASSERT_EQUAL(100 + relayed, stats.relayed);
+    TEST_ASSERT_EQUAL(packets - relayed, stats.suppressed_density);
+
+    /* Silent neighbours time out. */
+    m_now += MS_TO_US(RELAY_POLICY_NEIGHBOUR_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL(0, relay_policy_neighbour_count_get(&m_policy));
+    TEST_ASSERT_TRUE(relay_policy_packet_in(&m_policy, &metadata, &packet, 10, &rx_metadata));
+}
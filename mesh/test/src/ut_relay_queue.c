@@ -0,0 +1,394 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "relay_queue.h"
+#include "test_assert.h"
+#include "utils.h"
+
+#define SRC      (0x0001)
+#define SEQNUM   (0x000100)
+#define TTL      (5)
+
+static relay_queue_t m_queue;
+static timestamp_t m_now;
+static timer_event_t * mp_timer;
+static bool m_tx_accept;
+static uint32_t m_tx_count;
+static network_packet_metadata_t m_tx_metadata[RELAY_QUEUE_SIZE * 2];
+
+/* ******************* Fakes ******************* */
+
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    p_timer_evt->state = TIMER_EVENT_STATE_ADDED;
+    mp_timer = p_timer_evt;
+}
+
+static bool tx_cb(relay_queue_t * p_queue,
+                  network_packet_metadata_t * p_net_metadata,
+                  const packet_mesh_net_packet_t * p_net_packet,
+                  uint8_t payload_len)
+{
+    TEST_ASSERT_EQUAL_PTR(&m_queue, p_queue);
+    TEST_ASSERT_EQUAL(10, payload_len);
+    for (uint32_t i = 0; i < payload_len; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX8((uint8_t) (p_net_metadata->internal.sequence_number + i),
+                               p_net_packet->pdu[PACKET_MESH_NET_PDU_OFFSET + i]);
+    }
+
+    if (m_tx_accept)
+    {
+        TEST_ASSERT_TRUE(m_tx_count < ARRAY_SIZE(m_tx_metadata));
+        m_tx_metadata[m_tx_count++] = *p_net_metadata;
+    }
+    return m_tx_accept;
+}
+
+/* ******************* Helpers ******************* */
+
+static void push(uint32_t sequence_number, uint8_t ttl)
+{
+    network_packet_metadata_t metadata;
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.dst.value = 0xC001;
+    metadata.dst.type = NRF_MESH_ADDRESS_TYPE_GROUP;
+    metadata.src = SRC;
+    metadata.ttl = ttl;
+    metadata.internal.sequence_number = sequence_number;
+
+    packet_mesh_net_packet_t packet;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        packet.pdu[PACKET_MESH_NET_PDU_OFFSET + i] = sequence_number + i;
+    }
+    relay_queue_push(&m_queue, &metadata, &packet, 10);
+}
+
+static void config_set(relay_queue_priority_t priority, relay_queue_drop_t drop)
+{
+    relay_queue_config_t config;
+    relay_queue_config_get(&m_queue, &config);
+    config.priority = priority;
+    config.drop = drop;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, relay_queue_config_set(&m_queue, &config));
+}
+
+/** Fires the queue timer at its timestamp. */
+static void timer_fire(void)
+{
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    timer_event_t * p_timer = mp_timer;
+    mp_timer = NULL;
+    m_now = p_timer->timestamp;
+    p_timer->state = TIMER_EVENT_STATE_IN_CALLBACK;
+    p_timer->cb(m_now, p_timer->p_context);
+    if (p_timer->state == TIMER_EVENT_STATE_IN_CALLBACK)
+    {
+        p_timer->state = TIMER_EVENT_STATE_UNUSED;
+    }
+}
+
+static void stats_get(relay_queue_stats_t * p_stats)
+{
+    relay_queue_stats_get(&m_queue, p_stats);
+}
+
+/* ******************* Setup ******************* */
+
+void setUp(void)
+{
+    m_now = 1000;
+    mp_timer = NULL;
+    m_tx_accept = true;
+    m_tx_count = 0;
+    relay_queue_init(&m_queue, tx_cb);
+}
+
+void tearDown(void)
+{
+}
+
+/* ******************* Tests ******************* */
+
+void test_config(void)
+{
+    relay_queue_config_t config;
+    relay_queue_config_get(&m_queue, &config);
+    TEST_ASSERT_EQUAL(RELAY_QUEUE_PRIORITY_EQUAL, config.priority);
+    TEST_ASSERT_EQUAL(RELAY_QUEUE_DROP_OLDEST, config.drop);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, relay_queue_config_set(&m_queue, NULL));
+
+    relay_queue_config_t invalid = config;
+    invalid.priority = (relay_queue_priority_t) (RELAY_QUEUE_PRIORITY_ORIGINATOR + 1);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_queue_config_set(&m_queue, &invalid));
+    invalid = config;
+    invalid.drop = (relay_queue_drop_t) (RELAY_QUEUE_DROP_LOWEST_TTL + 1);
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_queue_config_set(&m_queue, &invalid));
+    invalid = config;
+    invalid.max_age_us = 0;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, relay_queue_config_set(&m_queue, &invalid));
+
+    config.priority = RELAY_QUEUE_PRIORITY_RELAY;
+    config.drop = RELAY_QUEUE_DROP_LOWEST_TTL;
+    config.max_age_us = 1234;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, relay_queue_config_set(&m_queue, &config));
+    relay_queue_config_t readback;
+    relay_queue_config_get(&m_queue, &readback);
+    TEST_ASSERT_EQUAL_MEMORY(&config, &readback, sizeof(config));
+
+    TEST_NRF_MESH_ASSERT_EXPECT(relay_queue_init(NULL, tx_cb));
+    TEST_NRF_MESH_ASSERT_EXPECT(relay_queue_init(&m_queue, NULL));
+}
+
+void test_direct(void)
+{
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        push(SEQNUM + i, TTL);
+    }
+    TEST_ASSERT_EQUAL(3, m_tx_count);
+    TEST_ASSERT_NULL(mp_timer);
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(3, stats.sent_direct);
+    TEST_ASSERT_EQUAL(0, stats.sent_queued);
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(0, stats.depth_max);
+}
+
+void test_queued(void)
+{
+    /* The bearers are busy, so the packets are queued. */
+    m_tx_accept = false;
+    push(SEQNUM, TTL);
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    TEST_ASSERT_EQUAL(m_now + MS_TO_US(RELAY_QUEUE_RETRY_INTERVAL_MS), mp_timer->timestamp);
+    push(SEQNUM + 1, TTL);
+    push(SEQNUM + 2, TTL);
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(3, stats.depth);
+    TEST_ASSERT_EQUAL(3, stats.depth_max);
+
+    /* Still busy on the first retry. */
+    timer_fire();
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    TEST_ASSERT_EQUAL(0, m_tx_count);
+
+    /* Sent in the order they arrived. */
+    m_tx_accept = true;
+    timer_fire();
+    TEST_ASSERT_NULL(mp_timer);
+    TEST_ASSERT_EQUAL(3, m_tx_count);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL(SEQNUM + i, m_tx_metadata[i].internal.sequence_number);
+    }
+
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(3, stats.sent_queued);
+    TEST_ASSERT_EQUAL(MS_TO_US(2 * RELAY_QUEUE_RETRY_INTERVAL_MS), stats.latency_max_us);
+    TEST_ASSERT_EQUAL(3 * MS_TO_US(2 * RELAY_QUEUE_RETRY_INTERVAL_MS), stats.latency_total_us);
+
+    /* New packets wait behind the queued ones. */
+    m_tx_accept = false;
+    push(SEQNUM + 3, TTL);
+    m_tx_accept = true;
+    push(SEQNUM + 4, TTL);
+    TEST_ASSERT_EQUAL(3, m_tx_count);
+    timer_fire();
+    TEST_ASSERT_EQUAL(5, m_tx_count);
+    TEST_ASSERT_EQUAL(SEQNUM + 3, m_tx_metadata[3].internal.sequence_number);
+    TEST_ASSERT_EQUAL(SEQNUM + 4, m_tx_metadata[4].internal.sequence_number);
+
+    relay_queue_stats_clear(&m_queue);
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.sent_queued);
+    TEST_ASSERT_EQUAL(0, stats.depth_max);
+}
+
+void test_drop_oldest(void)
+{
+    m_tx_accept = false;
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE + 2; ++i)
+    {
+        push(SEQNUM + i, TTL);
+        m_now += 100;
+    }
+
+    m_tx_accept = true;
+    timer_fire();
+    TEST_ASSERT_EQUAL(RELAY_QUEUE_SIZE, m_tx_count);
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        TEST_ASSERT_EQUAL(SEQNUM + 2 + i, m_tx_metadata[i].internal.sequence_number);
+    }
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(2, stats.dropped_full);
+    TEST_ASSERT_EQUAL(RELAY_QUEUE_SIZE, stats.depth_max);
+}
+
+void test_drop_lowest_ttl(void)
+{
+    config_set(RELAY_QUEUE_PRIORITY_EQUAL, RELAY_QUEUE_DROP_LOWEST_TTL);
+    m_tx_accept = false;
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        push(SEQNUM + i, (i == 3) ? 2 : TTL);
+        m_now += 100;
+    }
+
+    /* Packets with no more hops to go than any queued packet are dropped themselves. */
+    push(SEQNUM + RELAY_QUEUE_SIZE, 2);
+    /* Otherwise, the packet with the lowest TTL goes. */
+    push(SEQNUM + RELAY_QUEUE_SIZE + 1, TTL);
+
+    m_tx_accept = true;
+    timer_fire();
+    TEST_ASSERT_EQUAL(RELAY_QUEUE_SIZE, m_tx_count);
+    for (uint32_t i = 0; i < RELAY_QUEUE_SIZE; ++i)
+    {
+        TEST_ASSERT_NOT_EQUAL(SEQNUM + 3, m_tx_metadata[i].internal.sequence_number);
+        TEST_ASSERT_NOT_EQUAL(SEQNUM + RELAY_QUEUE_SIZE, m_tx_metadata[i].internal.sequence_number);
+    }
+    TEST_ASSERT_EQUAL(SEQNUM + RELAY_QUEUE_SIZE + 1, m_tx_metadata[RELAY_QUEUE_SIZE - 1].internal.sequence_number);
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(2, stats.dropped_full);
+}
+
+void test_drop_age(void)
+{
+    relay_queue_config_t config;
+    relay_queue_config_get(&m_queue, &config);
+
+    m_tx_accept = false;
+    push(SEQNUM, TTL);
+    m_now += config.max_age_us / 2;
+    push(SEQNUM + 1, TTL);
+    m_now += config.max_age_us / 2 + 1;
+
+    /* The first packet has expired by the time the bearers have room. */
+    m_tx_accept = true;
+    mp_timer->timestamp = m_now;
+    timer_fire();
+    TEST_ASSERT_EQUAL(1, m_tx_count);
+    TEST_ASSERT_EQUAL(SEQNUM + 1, m_tx_metadata[0].internal.sequence_number);
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(1, stats.dropped_age);
+    TEST_ASSERT_EQUAL(1, stats.sent_queued);
+}
+
+void test_priority_relay(void)
+{
+    /* Originated packets are always allowed with equal priority. */
+    m_tx_accept = false;
+    push(SEQNUM, TTL);
+    TEST_ASSERT_TRUE(relay_queue_originator_allowed(&m_queue));
+
+    config_set(RELAY_QUEUE_PRIORITY_RELAY, RELAY_QUEUE_DROP_OLDEST);
+    TEST_ASSERT_FALSE(relay_queue_originator_allowed(&m_queue));
+
+    m_tx_accept = true;
+    timer_fire();
+    TEST_ASSERT_TRUE(relay_queue_originator_allowed(&m_queue));
+    relay_queue_originator_sent(&m_queue);
+    push(SEQNUM + 1, TTL);
+    TEST_ASSERT_EQUAL(2, m_tx_count);
+
+    relay_queue_stats_t stats;
+    stats_get(&stats);
+    TEST_ASSERT_EQUAL(1, stats.originator_deferred);
+}
+
+void test_priority_originator(void)
+{
+    config_set(RELAY_QUEUE_PRIORITY_ORIGINATOR, RELAY_QUEUE_DROP_OLDEST);
+    TEST_ASSERT_TRUE(relay_queue_originator_allowed(&m_queue));
+    relay_queue_originator_sent(&m_queue);
+    timestamp_t held_until = m_now + MS_TO_US(RELAY_QUEUE_ORIGINATOR_HOLDOFF_MS);
+
+    /* Relays wait for the originated packet, even if the bearers have room. */
+    push(SEQNUM, TTL);
+    TEST_ASSERT_EQUAL(0, m_tx_count);
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    TEST_ASSERT_EQUAL(held_until, mp_timer->timestamp);
+
+    timer_fire();
+    TEST_ASSERT_EQUAL(1, m_tx_count);
+    push(SEQNUM + 1, TTL);
+    TEST_ASSERT_EQUAL(2, m_tx_count);
+}
+
+void test_priority_originator_timer_early(void)
+{
+    config_set(RELAY_QUEUE_PRIORITY_ORIGINATOR, RELAY_QUEUE_DROP_OLDEST);
+    relay_queue_originator_sent(&m_queue);
+    push(SEQNUM, TTL);
+    TEST_ASSERT_NOT_NULL(mp_timer);
+
+    /* The scheduler fires timers within a small margin of their timestamp. The hold-off must end,
+     * instead of ordering the timer for the same deadline again. */
+    timer_event_t * p_timer = mp_timer;
+    mp_timer = NULL;
+    m_now = p_timer->timestamp - 10;
+    p_timer->state = TIMER_EVENT_STATE_IN_CALLBACK;
+    p_timer->cb(m_now, p_timer->p_context);
+    TEST_ASSERT_EQUAL(1, m_tx_count);
+    TEST_ASSERT_NULL(mp_timer);
+}
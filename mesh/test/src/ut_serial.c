@@ -60,6 +60,7 @@
 #include "serial_handler_mesh_mock.h"
 #include "serial_handler_prov_mock.h"
 #include "serial_handler_openmesh_mock.h"
+#include "serial_handler_stats_mock.h"
 
 NRF_POWER_Type  * NRF_POWER;
 static NRF_POWER_Type m_power;
@@ -318,6 +319,21 @@ void test_serial_rx(void)
     serial_bearer_rx_get_IgnoreArg_p_packet();
     m_serial_process_cmd(NULL);
 
+    /* Call serial process cmd and test with valid packets of STATS type */
+    serial_packet.opcode = SERIAL_OPCODE_CMD_RANGE_STATS_START;
+    serial_bearer_rx_get_ExpectAndReturn(&serial_packet, true);
+    serial_bearer_rx_get_IgnoreArg_p_packet();
+    serial_bearer_rx_get_ReturnThruPtr_p_packet(&serial_packet);
+    serial_handler_stats_rx_Expect(&serial_packet);
+    serial_packet.opcode = SERIAL_OPCODE_CMD_RANGE_STATS_END;
+    serial_bearer_rx_get_ExpectAndReturn(&serial_packet, true);
+    serial_bearer_rx_get_IgnoreArg_p_packet();
+    serial_bearer_rx_get_ReturnThruPtr_p_packet(&serial_packet);
+    serial_handler_stats_rx_Expect(&serial_packet);
+    serial_bearer_rx_get_ExpectAndReturn(NULL, false);
+    serial_bearer_rx_get_IgnoreArg_p_packet();
+    m_serial_process_cmd(NULL);
+
     /* Call serial process cmd and test with valid packets of PROV type */
     serial_packet.opcode = SERIAL_OPCODE_CMD_RANGE_PROV_START;
     serial_bearer_rx_get_ExpectAndReturn(&serial_packet, true);
@@ -366,8 +382,8 @@ void test_serial_rx(void)
     /** Test the reception of invalid packets */
     serial_packet_t serial_packet2;
     serial_packet_t * p_packet = &serial_packet2;
-    /* No opcodes between SERIAL_OPCODE_CMD_RANGE_MESH_END and SERIAL_OPCODE_CMD_RANGE_DFU_START are supported*/
-    for (uint32_t i = SERIAL_OPCODE_CMD_RANGE_MESH_END+1; i < SERIAL_OPCODE_CMD_RANGE_DFU_START; ++i)
+    /* No opcodes between SERIAL_OPCODE_CMD_RANGE_STATS_END and SERIAL_OPCODE_CMD_RANGE_DFU_START are supported*/
+    for (uint32_t i = SERIAL_OPCODE_CMD_RANGE_STATS_END+1; i < SERIAL_OPCODE_CMD_RANGE_DFU_START; ++i)
     {
         serial_packet.opcode = i;
         serial_bearer_packet_buffer_get_ExpectAndReturn(SERIAL_EVT_CMD_RSP_LEN_OVERHEAD, &p_packet, NRF_SUCCESS);
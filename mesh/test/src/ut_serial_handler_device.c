@@ -174,6 +174,30 @@ void test_device_rx(void)
     serial_mock_Verify();
     callbacks_verify();
 
+    /* instrumentation is compiled out of the unit test */
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD + sizeof(serial_cmd_device_instr_histogram_get_t);
+    cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_INSTR_HISTOGRAM_GET;
+    cmd.payload.cmd.device.instr_histogram_get.stage = 0;
+    EXPECT_ACK_NO_TRANSLATE(SERIAL_OPCODE_CMD_DEVICE_INSTR_HISTOGRAM_GET, SERIAL_STATUS_ERROR_CMD_UNKNOWN);
+    serial_handler_device_rx(&cmd);
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+    cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_INSTR_CLEAR;
+    EXPECT_ACK_NO_TRANSLATE(SERIAL_OPCODE_CMD_DEVICE_INSTR_CLEAR, SERIAL_STATUS_ERROR_CMD_UNKNOWN);
+    serial_handler_device_rx(&cmd);
+    serial_mock_Verify();
+
+    /* so is the packet trace */
+    cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_START;
+    EXPECT_ACK_NO_TRANSLATE(SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_START, SERIAL_STATUS_ERROR_CMD_UNKNOWN);
+    serial_handler_device_rx(&cmd);
+    cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_READ;
+    EXPECT_ACK_NO_TRANSLATE(SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_READ, SERIAL_STATUS_ERROR_CMD_UNKNOWN);
+    serial_handler_device_rx(&cmd);
+    cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_STOP;
+    EXPECT_ACK_NO_TRANSLATE(SERIAL_OPCODE_CMD_DEVICE_PACKET_TRACE_STOP, SERIAL_STATUS_ERROR_CMD_UNKNOWN);
+    serial_handler_device_rx(&cmd);
+    serial_mock_Verify();
+
     /* reset device */
     cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
     cmd.opcode = SERIAL_OPCODE_CMD_DEVICE_RADIO_RESET;
@@ -173,6 +173,22 @@ void test_stateclear()
     serial_handler_mesh_rx(&cmd);
 }
 
+void test_heartbeat_table_disabled(void)
+{
+    /* The heartbeat collector is compiled out in this test */
+    serial_packet_t cmd;
+    cmd.opcode = SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_GET;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD + sizeof(serial_cmd_mesh_heartbeat_table_get_t);
+    cmd.payload.cmd.mesh.heartbeat_table_get.start_index = 0;
+    serial_cmd_rsp_send_Expect(SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_GET, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+    serial_handler_mesh_rx(&cmd);
+
+    cmd.opcode = SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_CLEAR;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+    serial_cmd_rsp_send_Expect(SERIAL_OPCODE_CMD_MESH_HEARTBEAT_TABLE_CLEAR, SERIAL_STATUS_ERROR_CMD_UNKNOWN, NULL, 0);
+    serial_handler_mesh_rx(&cmd);
+}
+
 void test_subnet(void)
 {
     serial_packet_t cmd;
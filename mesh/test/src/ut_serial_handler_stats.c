@@ -0,0 +1,154 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "serial_handler_stats.h"
+#include "serial_packet.h"
+#include "serial_status.h"
+#include "serial_cmd_rsp.h"
+#include "test_assert.h"
+
+#include "serial_mock.h"
+#include "mesh_stats_mock.h"
+
+static serial_evt_cmd_rsp_data_stats_t m_rsp;
+static uint16_t m_rsp_length;
+static uint8_t m_rsp_status;
+static uint32_t m_rsp_count;
+
+static void serial_cmd_rsp_send_cb(uint8_t opcode, uint8_t status, const uint8_t * p_data, uint16_t length, int num_calls)
+{
+    TEST_ASSERT_TRUE(length <= sizeof(m_rsp));
+    if (length > 0)
+    {
+        memcpy(&m_rsp, p_data, length);
+    }
+    m_rsp_length = length;
+    m_rsp_status = status;
+    m_rsp_count++;
+}
+
+static void mesh_stats_get_cb(mesh_stats_t * p_stats, int num_calls)
+{
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        p_stats->counters[i] = 0x01000000 + i;
+    }
+}
+
+void setUp(void)
+{
+    serial_mock_Init();
+    mesh_stats_mock_Init();
+    memset(&m_rsp, 0, sizeof(m_rsp));
+    m_rsp_length = 0;
+    m_rsp_status = 0xFF;
+    m_rsp_count = 0;
+    serial_cmd_rsp_send_StubWithCallback(serial_cmd_rsp_send_cb);
+}
+
+void tearDown(void)
+{
+    serial_mock_Verify();
+    serial_mock_Destroy();
+    mesh_stats_mock_Verify();
+    mesh_stats_mock_Destroy();
+}
+
+/******** Tests ********/
+
+void test_stats_get(void)
+{
+    serial_packet_t cmd;
+    cmd.opcode = SERIAL_OPCODE_CMD_STATS_GET;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+
+    mesh_stats_get_StubWithCallback(mesh_stats_get_cb);
+    serial_handler_stats_rx(&cmd);
+    TEST_ASSERT_EQUAL(1, m_rsp_count);
+    TEST_ASSERT_EQUAL(SERIAL_STATUS_SUCCESS, m_rsp_status);
+    TEST_ASSERT_EQUAL(sizeof(uint8_t) + MESH_STATS_COUNT * sizeof(uint32_t), m_rsp_length);
+    TEST_ASSERT_EQUAL(MESH_STATS_COUNT, m_rsp.counter_count);
+    for (uint32_t i = 0; i < MESH_STATS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX32(0x01000000 + i, m_rsp.counters[i]);
+    }
+
+    /* Parameters aren't allowed. */
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD + 1;
+    serial_handler_stats_rx(&cmd);
+    TEST_ASSERT_EQUAL(2, m_rsp_count);
+    TEST_ASSERT_EQUAL(SERIAL_STATUS_ERROR_INVALID_LENGTH, m_rsp_status);
+    TEST_ASSERT_EQUAL(0, m_rsp_length);
+}
+
+void test_stats_clear(void)
+{
+    serial_packet_t cmd;
+    cmd.opcode = SERIAL_OPCODE_CMD_STATS_CLEAR;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+
+    mesh_stats_clear_Expect();
+    serial_handler_stats_rx(&cmd);
+    TEST_ASSERT_EQUAL(1, m_rsp_count);
+    TEST_ASSERT_EQUAL(SERIAL_STATUS_SUCCESS, m_rsp_status);
+    TEST_ASSERT_EQUAL(0, m_rsp_length);
+
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD + 1;
+    serial_handler_stats_rx(&cmd);
+    TEST_ASSERT_EQUAL(2, m_rsp_count);
+    TEST_ASSERT_EQUAL(SERIAL_STATUS_ERROR_INVALID_LENGTH, m_rsp_status);
+}
+
+void test_unknown_opcode(void)
+{
+    serial_packet_t cmd;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+    for (uint32_t opcode = SERIAL_OPCODE_CMD_STATS_CLEAR + 1; opcode <= SERIAL_OPCODE_CMD_RANGE_STATS_END; ++opcode)
+    {
+        cmd.opcode = opcode;
+        serial_handler_stats_rx(&cmd);
+        TEST_ASSERT_EQUAL(SERIAL_STATUS_ERROR_CMD_UNKNOWN, m_rsp_status);
+    }
+
+    cmd.opcode = SERIAL_OPCODE_CMD_RANGE_STATS_END + 1;
+    TEST_NRF_MESH_ASSERT_EXPECT(serial_handler_stats_rx(&cmd));
+}
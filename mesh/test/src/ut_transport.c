@@ -316,3 +316,105 @@ void test_control_tx(void)
     TEST_ASSERT_EQUAL_HEX8(control_packet.opcode, network_packet_buffer[0]); /* opcode */
     TEST_ASSERT_EQUAL_HEX8_ARRAY(control_packet_buffer, &network_packet_buffer[1], control_packet.data_len); /* payload */
 }
+
+static uint32_t m_bulk_alloc_payload_len[2];
+static uint32_t m_bulk_alloc_calls;
+static uint32_t network_packet_alloc_no_mem_callback(network_tx_packet_buffer_t * p_buf, int calls)
+{
+    TEST_ASSERT_TRUE(m_bulk_alloc_calls < ARRAY_SIZE(m_bulk_alloc_payload_len));
+    m_bulk_alloc_payload_len[m_bulk_alloc_calls++] = p_buf->user_data.payload_len;
+    return NRF_ERROR_NO_MEM;
+}
+
+void test_bulk_opt(void)
+{
+    expect_init();
+    transport_init(NULL);
+
+    nrf_mesh_opt_t opt = {.len = sizeof(uint32_t)};
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_opt_get(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+    TEST_ASSERT_EQUAL(0, opt.opt.val);
+
+    opt.opt.val = 1;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_opt_set(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+    opt.opt.val = 0;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_opt_get(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+    TEST_ASSERT_EQUAL(1, opt.opt.val);
+
+    opt.opt.val = 2;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, transport_opt_set(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+}
+
+void test_bulk_tx(void)
+{
+    expect_init();
+    transport_init(NULL);
+    enc_nonce_generate_Ignore();
+    enc_aes_ccm_encrypt_Ignore();
+
+    nrf_mesh_opt_t opt = {.len = sizeof(uint32_t), .opt.val = 1};
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_opt_set(NRF_MESH_OPT_TRS_BULK_ENABLE, &opt));
+
+    uint8_t access_payload[TRANSPORT_BULK_PDU_MAX_SIZE - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE] = {0};
+    uint8_t network_packet_buffer[PACKET_MESH_TRS_UNSEG_PDU_OFFSET + TRANSPORT_BULK_PDU_MAX_SIZE] = {0xFF};
+    nrf_mesh_application_secmat_t app_secmat = {.is_device_key = false, .aid = 0x12};
+    nrf_mesh_network_secmat_t net_secmat;
+
+    nrf_mesh_tx_params_t tx_params;
+    memset(&tx_params, 0, sizeof(tx_params));
+    tx_params.dst.type                   = NRF_MESH_ADDRESS_TYPE_GROUP;
+    tx_params.dst.value                  = 0xC001;
+    tx_params.src                        = 0x0002;
+    tx_params.ttl                        = 5;
+    tx_params.p_data                     = access_payload;
+    tx_params.data_len                   = sizeof(access_payload);
+    tx_params.transmic_size              = NRF_MESH_TRANSMIC_SIZE_SMALL;
+    tx_params.security_material.p_app    = &app_secmat;
+    tx_params.security_material.p_net    = &net_secmat;
+    tx_params.tx_token                   = TX_TOKEN;
+
+    /* The long message goes out as a single unsegmented PDU when a bearer accepts it. */
+    m_expect_network_packet_alloc.calls                        = 1;
+    m_expect_network_packet_alloc.net_meta.control_packet      = false;
+    m_expect_network_packet_alloc.net_meta.dst                 = tx_params.dst;
+    m_expect_network_packet_alloc.net_meta.src                 = tx_params.src;
+    m_expect_network_packet_alloc.net_meta.ttl                 = tx_params.ttl;
+    m_expect_network_packet_alloc.net_meta.p_security_material = &net_secmat;
+    m_expect_network_packet_alloc.payload_len                  = sizeof(network_packet_buffer);
+    m_expect_network_packet_alloc.tx_token                     = TX_TOKEN;
+    m_expect_network_packet_alloc.p_buffer                     = network_packet_buffer;
+    m_expect_network_packet_alloc.retval                       = NRF_SUCCESS;
+    network_packet_alloc_StubWithCallback(network_packet_alloc_callback);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_tx(&tx_params, NULL));
+    TEST_ASSERT_EQUAL(0, m_expect_network_packet_alloc.calls);
+    TEST_ASSERT_FALSE(packet_mesh_trs_common_seg_get((const packet_mesh_trs_packet_t *) network_packet_buffer));
+    TEST_ASSERT_EQUAL_HEX8(app_secmat.aid,
+                           packet_mesh_trs_access_aid_get((const packet_mesh_trs_packet_t *) network_packet_buffer));
+
+    /* Without a bearer for the long PDU, the message falls back to segmentation. */
+    network_mock_Verify();
+    m_bulk_alloc_calls = 0;
+    network_packet_alloc_StubWithCallback(network_packet_alloc_no_mem_callback);
+    timer_now_IgnoreAndReturn(0);
+    timer_sch_reschedule_Ignore();
+    net_state_iv_index_lock_Ignore();
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_tx(&tx_params, NULL));
+    TEST_ASSERT_EQUAL(2, m_bulk_alloc_calls);
+    TEST_ASSERT_EQUAL(sizeof(network_packet_buffer), m_bulk_alloc_payload_len[0]);
+    TEST_ASSERT_EQUAL(PACKET_MESH_TRS_SEG_PDU_OFFSET + PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE,
+                      m_bulk_alloc_payload_len[1]);
+
+    /* Messages that need a large TransMIC are always segmented. */
+    network_mock_Verify();
+    m_bulk_alloc_calls = 0;
+    tx_params.data_len      = sizeof(access_payload) - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE;
+    tx_params.transmic_size = NRF_MESH_TRANSMIC_SIZE_LARGE;
+    network_packet_alloc_StubWithCallback(network_packet_alloc_no_mem_callback);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_tx(&tx_params, NULL));
+    TEST_ASSERT_EQUAL(1, m_bulk_alloc_calls);
+    TEST_ASSERT_EQUAL(PACKET_MESH_TRS_SEG_PDU_OFFSET + PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE,
+                      m_bulk_alloc_payload_len[0]);
+}
@@ -0,0 +1,380 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include <cmock.h>
+
+#include "transport_rtt.h"
+#include "test_assert.h"
+
+/* ******************* Simulation definitions ******************* */
+
+/** Receiver acknowledgment delay, the default base RX ack timeout plus the per hop addition for the default segack TTL. */
+#define SIM_ACK_DELAY_US        (MS_TO_US(150) + MS_TO_US(50) * TRANSPORT_SAR_SEGACK_TTL_DEFAULT)
+/** Default TX retry timeout parameters. */
+#define SIM_RETRY_BASE_US       MS_TO_US(500)
+#define SIM_RETRY_PER_HOP_US    MS_TO_US(50)
+/** Number of retries before giving up, as in the transport layer. */
+#define SIM_RETRIES             (4)
+/** Time between segments sent in a round. */
+#define SIM_SEGMENT_INTERVAL_US MS_TO_US(10)
+#define SIM_SEGMENT_COUNT       (8)
+#define SIM_TRANSFER_COUNT      (200)
+#define SIM_DST                 (0x0042)
+
+typedef struct
+{
+    uint32_t completed;
+    uint32_t timeouts;          /**< Retry timer expiries. */
+    uint32_t spurious_timeouts; /**< Retry timer expiries where the acknowledgment was on its way. */
+    uint32_t segments_sent;
+    uint64_t latency_us;        /**< Total time spent on completed transfers. */
+} sim_result_t;
+
+typedef struct
+{
+    uint32_t hops;
+    uint32_t hop_delay_us;  /**< Mean delay per hop, jittered by +/- 50 %. */
+    uint32_t loss_percent;  /**< Probability of losing a packet on each hop. */
+} sim_scenario_t;
+
+static uint32_t m_random;
+
+/* ******************* Simulation ******************* */
+
+static uint32_t sim_random(void)
+{
+    m_random = m_random * 1664525u + 1013904223u;
+    return m_random >> 8;
+}
+
+/* Returns the time a packet takes over the path, or UINT32_MAX if it is lost. */
+static uint32_t sim_path_delay(const sim_scenario_t * p_scenario)
+{
+    uint32_t delay = 0;
+    for (uint32_t hop = 0; hop < p_scenario->hops; ++hop)
+    {
+        if ((sim_random() % 100) < p_scenario->loss_percent)
+        {
+            return UINT32_MAX;
+        }
+        delay += p_scenario->hop_delay_us / 2 + (sim_random() % (p_scenario->hop_delay_us + 1));
+    }
+    return delay;
+}
+
+/* Sends a round of the missing segments at the given time, and returns when the acknowledgment
+ * for it reaches the sender, or UINT64_MAX if it never does. */
+static uint64_t sim_round(const sim_scenario_t * p_scenario, uint64_t now, uint32_t * p_received, uint32_t * p_ack_block, sim_result_t * p_result)
+{
+    uint64_t last_arrival = 0;
+    uint32_t sent = 0;
+    for (uint32_t segment = 0; segment < SIM_SEGMENT_COUNT; ++segment)
+    {
+        if ((*p_ack_block & (1u << segment)) == 0)
+        {
+            uint32_t delay = sim_path_delay(p_scenario);
+            if (delay != UINT32_MAX)
+            {
+                *p_received |= (1u << segment);
+                last_arrival = MAX(last_arrival, now + sent * SIM_SEGMENT_INTERVAL_US + delay);
+            }
+            sent++;
+        }
+    }
+    p_result->segments_sent += sent;
+    uint32_t ack_delay = sim_path_delay(p_scenario);
+    if (last_arrival == 0 || ack_delay == UINT32_MAX)
+    {
+        return UINT64_MAX;
+    }
+    *p_ack_block = *p_received;
+    return last_arrival + SIM_ACK_DELAY_US + ack_delay;
+}
+
+/* Runs transfers to one destination with the same retry logic as the transport layer. */
+static void sim_run(const sim_scenario_t * p_scenario, bool adaptive, sim_result_t * p_result)
+{
+    const uint32_t full = (1u << SIM_SEGMENT_COUNT) - 1;
+    const uint32_t static_timeout = SIM_RETRY_BASE_US + SIM_RETRY_PER_HOP_US * (p_scenario->hops + 1);
+
+    memset(p_result, 0, sizeof(sim_result_t));
+    m_random = p_scenario->hops * 1000 + p_scenario->loss_percent;
+    transport_rtt_init();
+
+    for (uint32_t transfer = 0; transfer < SIM_TRANSFER_COUNT; ++transfer)
+    {
+        uint64_t start = (uint64_t) transfer * SEC_TO_US(60);
+        uint64_t now = start;
+        uint32_t received = 0;
+        uint32_t acked = 0;
+        uint32_t retries = SIM_RETRIES;
+        bool retransmitted = false;
+        uint32_t timeout;
+        if (!adaptive || !transport_rtt_timeout_get(SIM_DST, &timeout))
+        {
+            timeout = static_timeout;
+        }
+
+        uint32_t ack_block = 0;
+        uint64_t ack_time = sim_round(p_scenario, now, &received, &ack_block, p_result);
+        uint64_t round_start = now;
+        while (acked != full)
+        {
+            if (ack_time <= round_start + timeout)
+            {
+                /* Acknowledgment received before the retry timer fired. */
+                if (adaptive && !retransmitted && (ack_block & ~acked) != 0)
+                {
+                    transport_rtt_sample_add(SIM_DST, (uint32_t) (ack_time - round_start));
+                }
+                acked |= ack_block;
+                now = ack_time;
+                if (acked == full)
+                {
+                    break;
+                }
+                retransmitted = true;
+                if (!adaptive || !transport_rtt_timeout_get(SIM_DST, &timeout))
+                {
+                    timeout = static_timeout;
+                }
+            }
+            else
+            {
+                p_result->timeouts++;
+                if (ack_time != UINT64_MAX)
+                {
+                    p_result->spurious_timeouts++;
+                }
+                if (retries-- == 0)
+                {
+                    break;
+                }
+                now = round_start + timeout;
+                retransmitted = true;
+                if (adaptive)
+                {
+                    timeout = transport_rtt_timeout_expired(SIM_DST, timeout);
+                }
+            }
+
+            /* A late acknowledgment of the previous round may still arrive during the next one. */
+            uint32_t next_ack_block = acked;
+            uint64_t next_ack_time = sim_round(p_scenario, now, &received, &next_ack_block, p_result);
+            if (ack_time > now && ack_time != UINT64_MAX && ack_time < next_ack_time)
+            {
+                next_ack_time = ack_time;
+                next_ack_block = ack_block;
+            }
+            ack_time = next_ack_time;
+            ack_block = next_ack_block;
+            round_start = now;
+        }
+
+        if (acked == full)
+        {
+            p_result->completed++;
+            p_result->latency_us += now - start;
+        }
+    }
+}
+
+static void sim_compare(const sim_scenario_t * p_scenario, sim_result_t * p_static, sim_result_t * p_adaptive)
+{
+    sim_run(p_scenario, false, p_static);
+    sim_run(p_scenario, true, p_adaptive);
+    printf("%u hops, %3u ms/hop, %2u %% loss:\n", p_scenario->hops, p_scenario->hop_delay_us / 1000, p_scenario->loss_percent);
+    printf("    static:   %3u completed, %4u segments sent, %4u timeouts (%4u spurious), %6u ms avg\n",
+           p_static->completed, p_static->segments_sent, p_static->timeouts, p_static->spurious_timeouts,
+           (uint32_t) (p_static->latency_us / MAX(p_static->completed, 1) / 1000));
+    printf("    adaptive: %3u completed, %4u segments sent, %4u timeouts (%4u spurious), %6u ms avg\n",
+           p_adaptive->completed, p_adaptive->segments_sent, p_adaptive->timeouts, p_adaptive->spurious_timeouts,
+           (uint32_t) (p_adaptive->latency_us / MAX(p_adaptive->completed, 1) / 1000));
+}
+
+/* ******************* Test functions ******************* */
+
+void setUp(void)
+{
+    transport_rtt_init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_no_estimate(void)
+{
+    uint32_t timeout;
+    TEST_ASSERT_FALSE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_FALSE(transport_rtt_timeout_get(NRF_MESH_ADDR_UNASSIGNED, &timeout));
+    TEST_NRF_MESH_ASSERT_EXPECT(transport_rtt_sample_add(NRF_MESH_ADDR_UNASSIGNED, MS_TO_US(500)));
+    TEST_NRF_MESH_ASSERT_EXPECT(transport_rtt_timeout_get(SIM_DST, NULL));
+}
+
+void test_estimate(void)
+{
+    uint32_t timeout;
+
+    /* First sample: SRTT = R, RTTVAR = R / 2. */
+    transport_rtt_sample_add(SIM_DST, MS_TO_US(600));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(600) + 4 * MS_TO_US(300), timeout);
+
+    /* Constant samples make the variation decay towards the granularity. */
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        transport_rtt_sample_add(SIM_DST, MS_TO_US(600));
+    }
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(600) + TRANSPORT_RTT_GRANULARITY_US, timeout);
+
+    /* A sudden change is followed quickly. */
+    transport_rtt_sample_add(SIM_DST, MS_TO_US(1400));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(700) + 4 * MS_TO_US(200), timeout);
+
+    /* Clamped to the retry timeout limits. */
+    transport_rtt_sample_add(SIM_DST + 1, MS_TO_US(10));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST + 1, &timeout));
+    TEST_ASSERT_EQUAL(TRANSPORT_RTT_TIMEOUT_MIN_US, timeout);
+    transport_rtt_sample_add(SIM_DST + 2, SEC_TO_US(30));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST + 2, &timeout));
+    TEST_ASSERT_EQUAL(TRANSPORT_RTT_TIMEOUT_MAX_US, timeout);
+
+    /* Estimates are per destination. */
+    TEST_ASSERT_FALSE(transport_rtt_timeout_get(SIM_DST + 3, &timeout));
+}
+
+void test_replacement(void)
+{
+    uint32_t timeout;
+    for (uint16_t i = 0; i < TRANSPORT_RTT_ENTRY_COUNT; ++i)
+    {
+        transport_rtt_sample_add(SIM_DST + i, MS_TO_US(500) + i);
+    }
+    /* Refresh the first destination, so the second is the least recently used. */
+    transport_rtt_sample_add(SIM_DST, MS_TO_US(500));
+    transport_rtt_sample_add(SIM_DST + TRANSPORT_RTT_ENTRY_COUNT, MS_TO_US(500));
+
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_FALSE(transport_rtt_timeout_get(SIM_DST + 1, &timeout));
+    for (uint16_t i = 2; i <= TRANSPORT_RTT_ENTRY_COUNT; ++i)
+    {
+        TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST + i, &timeout));
+    }
+
+    transport_rtt_init();
+    TEST_ASSERT_FALSE(transport_rtt_timeout_get(SIM_DST, &timeout));
+}
+
+void test_timeout_expired(void)
+{
+    uint32_t timeout;
+
+    /* Without an estimate, the timeout is doubled and kept until the next measurement. */
+    TEST_ASSERT_EQUAL(MS_TO_US(1200), transport_rtt_timeout_expired(SIM_DST, MS_TO_US(600)));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(1200), timeout);
+    TEST_ASSERT_EQUAL(TRANSPORT_RTT_TIMEOUT_MAX_US, transport_rtt_timeout_expired(SIM_DST, TRANSPORT_RTT_TIMEOUT_MAX_US - 1));
+
+    transport_rtt_sample_add(SIM_DST, MS_TO_US(800));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(800) + 4 * MS_TO_US(400), timeout);
+
+    /* With an estimate, the estimated timeout is kept, until it has expired too many times. */
+    for (uint32_t i = 0; i < TRANSPORT_RTT_TIMEOUT_COUNT_MAX - 1; ++i)
+    {
+        TEST_ASSERT_EQUAL(MS_TO_US(2400), transport_rtt_timeout_expired(SIM_DST, MS_TO_US(2400)));
+    }
+    TEST_ASSERT_EQUAL(MS_TO_US(4800), transport_rtt_timeout_expired(SIM_DST, MS_TO_US(2400)));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(4800), timeout);
+
+    /* A measurement starts a new estimate. */
+    transport_rtt_sample_add(SIM_DST, MS_TO_US(2000));
+    TEST_ASSERT_TRUE(transport_rtt_timeout_get(SIM_DST, &timeout));
+    TEST_ASSERT_EQUAL(MS_TO_US(2000) + 4 * MS_TO_US(1000), timeout);
+    TEST_NRF_MESH_ASSERT_EXPECT(transport_rtt_timeout_expired(NRF_MESH_ADDR_UNASSIGNED, MS_TO_US(600)));
+}
+
+/* Segmented transfers over a short path: the static timeout is close to the round trip time, and
+ * the adaptive timeout stops the retries that fire just before the acknowledgment arrives. */
+void test_simulation_short_path(void)
+{
+    const sim_scenario_t scenarios[] =
+    {
+        {1, MS_TO_US(10), 0},
+        {1, MS_TO_US(10), 10},
+        {2, MS_TO_US(20), 20},
+    };
+    for (uint32_t i = 0; i < ARRAY_SIZE(scenarios); ++i)
+    {
+        sim_result_t static_result;
+        sim_result_t adaptive_result;
+        sim_compare(&scenarios[i], &static_result, &adaptive_result);
+        TEST_ASSERT_TRUE(adaptive_result.completed >= static_result.completed);
+        TEST_ASSERT_TRUE(adaptive_result.spurious_timeouts * 10 < static_result.spurious_timeouts);
+        TEST_ASSERT_TRUE(adaptive_result.segments_sent < static_result.segments_sent);
+    }
+}
+
+/* Segmented transfers over long or slow paths: the static timeout fires well before the
+ * acknowledgment can arrive, so lossy transfers run out of retries. The adaptive timeout learns the
+ * round trip time, completing more transfers with less airtime. */
+void test_simulation_long_path(void)
+{
+    const sim_scenario_t scenarios[] =
+    {
+        {4, MS_TO_US(50), 0},
+        {6, MS_TO_US(60), 5},
+        {8, MS_TO_US(80), 10},
+    };
+    for (uint32_t i = 0; i < ARRAY_SIZE(scenarios); ++i)
+    {
+        sim_result_t static_result;
+        sim_result_t adaptive_result;
+        sim_compare(&scenarios[i], &static_result, &adaptive_result);
+        TEST_ASSERT_TRUE(adaptive_result.completed >= static_result.completed);
+        TEST_ASSERT_TRUE(adaptive_result.spurious_timeouts * 10 < static_result.spurious_timeouts);
+        TEST_ASSERT_TRUE(adaptive_result.segments_sent < static_result.segments_sent);
+    }
+}
@@ -0,0 +1,301 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CONFIG_CLIENT_BULK_H__
+#define CONFIG_CLIENT_BULK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config_client.h"
+#include "config_opcodes.h"
+#include "device_state_manager.h"
+#include "utils.h"
+
+/**
+ * @defgroup CONFIG_CLIENT_BULK Bulk configuration engine
+ * @ingroup CONFIG_CLIENT
+ * Pipelines configuration client requests across many nodes.
+ *
+ * The regular configuration client has a single acknowledged transaction in flight at a time,
+ * which makes configuring a large network a strictly serial process where every request waits
+ * for the round trip to the slowest node. The bulk engine queues requests for any number of
+ * nodes and keeps up to @ref CONFIG_CLIENT_BULK_IN_FLIGHT_MAX of them in flight at once, one per
+ * destination. Requests to the same node are always sent in the order they were queued, so
+ * dependent operations (e.g. an AppKey Add followed by a Model App Bind) remain valid.
+ *
+ * Requests are queued by calling the regular configuration client API between
+ * @ref config_client_bulk_begin() and @ref config_client_bulk_end():
+ *
+ * @code{.c}
+ * config_client_bulk_dest_t node = {.address = 0x0010, .devkey_handle = devkey, .address_handle = addr, .hops = 2};
+ * config_client_bulk_begin(&node);
+ * config_client_appkey_add(0, 0, p_appkey);
+ * config_client_model_app_bind(0x0011, 0, model_id);
+ * config_client_bulk_end();
+ * @endcode
+ *
+ * Retransmission intervals and transaction timeouts scale with the number of hops to each
+ * destination, so distant nodes are not given up on early and close nodes are not waited on
+ * for longer than necessary.
+ *
+ * @note The bulk engine and the regular configuration client share the same model instance.
+ * Don't start regular configuration client transactions while bulk requests are in flight.
+ *
+ * @{
+ */
+
+/** Number of requests that can be queued. */
+#ifndef CONFIG_CLIENT_BULK_QUEUE_SIZE
+#define CONFIG_CLIENT_BULK_QUEUE_SIZE (32)
+#endif
+
+/** Maximum number of requests in flight, each to a different destination. */
+#ifndef CONFIG_CLIENT_BULK_IN_FLIGHT_MAX
+#define CONFIG_CLIENT_BULK_IN_FLIGHT_MAX (8)
+#endif
+
+/** Maximum payload length of a queued request. */
+#ifndef CONFIG_CLIENT_BULK_MESSAGE_LENGTH_MAX
+#define CONFIG_CLIENT_BULK_MESSAGE_LENGTH_MAX (32)
+#endif
+
+/** Base retransmission interval of a request. */
+#ifndef CONFIG_CLIENT_BULK_INTERVAL_BASE
+#define CONFIG_CLIENT_BULK_INTERVAL_BASE (MS_TO_US(200))
+#endif
+
+/** Retransmission interval addition for every hop to the destination. */
+#ifndef CONFIG_CLIENT_BULK_INTERVAL_PER_HOP
+#define CONFIG_CLIENT_BULK_INTERVAL_PER_HOP (MS_TO_US(50))
+#endif
+
+/** Upper bound on the retransmission interval after back-off. */
+#ifndef CONFIG_CLIENT_BULK_INTERVAL_MAX
+#define CONFIG_CLIENT_BULK_INTERVAL_MAX (SEC_TO_US(2))
+#endif
+
+/** Base timeout of a request. */
+#ifndef CONFIG_CLIENT_BULK_TIMEOUT_BASE
+#define CONFIG_CLIENT_BULK_TIMEOUT_BASE (SEC_TO_US(4))
+#endif
+
+/** Timeout addition for every hop to the destination. */
+#ifndef CONFIG_CLIENT_BULK_TIMEOUT_PER_HOP
+#define CONFIG_CLIENT_BULK_TIMEOUT_PER_HOP (MS_TO_US(500))
+#endif
+
+/** Bulk request destination. */
+typedef struct
+{
+    /** Unicast address of the node's primary element. Used to match replies. */
+    uint16_t address;
+    /** Device key handle of the node. */
+    dsm_handle_t devkey_handle;
+    /** Address handle of @c address. */
+    dsm_handle_t address_handle;
+    /** Number of hops to the node, e.g. as reported by its heartbeats. Scales retransmission intervals and timeouts. */
+    uint8_t hops;
+} config_client_bulk_dest_t;
+
+/** Bulk engine event types. */
+typedef enum
+{
+    /** A request was answered. The event carries the status message. */
+    CONFIG_CLIENT_BULK_EVENT_TYPE_MSG,
+    /** A request timed out. */
+    CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT,
+    /** A request was dropped because an earlier request to the same node failed. */
+    CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED,
+    /** All queued requests have been resolved. */
+    CONFIG_CLIENT_BULK_EVENT_TYPE_DONE
+} config_client_bulk_event_type_t;
+
+/**
+ * Bulk engine event callback type.
+ *
+ * @param[in] event_type Event type.
+ * @param[in] address    Address of the node the event concerns, or @ref NRF_MESH_ADDR_UNASSIGNED for
+ *                       @ref CONFIG_CLIENT_BULK_EVENT_TYPE_DONE.
+ * @param[in] p_event    Status message for @ref CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, @c NULL otherwise.
+ * @param[in] length     Length of the status message.
+ */
+typedef void (*config_client_bulk_event_cb_t)(config_client_bulk_event_type_t event_type,
+                                              uint16_t address,
+                                              const config_client_event_t * p_event,
+                                              uint16_t length);
+
+/** Progress report of the bulk engine. */
+typedef struct
+{
+    /** Number of requests waiting to be sent. */
+    uint16_t queued;
+    /** Number of requests currently in flight. */
+    uint16_t in_flight;
+    /** Number of requests answered since the engine went active. */
+    uint16_t completed;
+    /** Number of requests that timed out or were cancelled since the engine went active. */
+    uint16_t failed;
+    /** Number of retransmissions since the engine went active. */
+    uint32_t retransmissions;
+    /** Time since the engine went active in milliseconds. */
+    uint32_t elapsed_ms;
+    /** Average round trip time of the answered requests in milliseconds. */
+    uint32_t rtt_avg_ms;
+    /** Answered requests per minute. */
+    uint32_t throughput_per_minute;
+} config_client_bulk_progress_t;
+
+/**
+ * Initializes the bulk engine.
+ *
+ * @note The configuration client must be initialized first.
+ *
+ * @param[in] event_cb Event callback pointer.
+ *
+ * @retval NRF_SUCCESS    Successfully initialized the bulk engine.
+ * @retval NRF_ERROR_NULL @c event_cb was @c NULL.
+ */
+uint32_t config_client_bulk_init(config_client_bulk_event_cb_t event_cb);
+
+/**
+ * Starts queueing requests for a node.
+ *
+ * Until @ref config_client_bulk_end() is called, every request made through the configuration
+ * client API is queued for @c p_dest instead of being sent.
+ *
+ * @param[in] p_dest Destination of the requests. Copied.
+ *
+ * @retval NRF_SUCCESS             Requests are now queued for @c p_dest.
+ * @retval NRF_ERROR_NULL          @c p_dest was @c NULL.
+ * @retval NRF_ERROR_INVALID_ADDR  The destination address is not a unicast address.
+ * @retval NRF_ERROR_INVALID_STATE Not initialized, or already queueing requests.
+ */
+uint32_t config_client_bulk_begin(const config_client_bulk_dest_t * p_dest);
+
+/**
+ * Stops queueing requests and starts sending the queued ones.
+ *
+ * @retval NRF_SUCCESS             Successfully stopped queueing.
+ * @retval NRF_ERROR_INVALID_STATE Not queueing requests.
+ */
+uint32_t config_client_bulk_end(void);
+
+/**
+ * Cancels all queued and in flight requests.
+ *
+ * Every cancelled request is reported with a @ref CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED event.
+ */
+void config_client_bulk_cancel(void);
+
+/**
+ * Gets a progress report of the bulk engine.
+ *
+ * @param[out] p_progress Progress report.
+ */
+void config_client_bulk_progress_get(config_client_bulk_progress_t * p_progress);
+
+/**
+ * @internal
+ * @defgroup CONFIG_CLIENT_BULK_INTERNAL Bulk configuration engine hooks
+ * Hooks between the configuration client and the bulk engine.
+ * @{
+ */
+
+/**
+ * Request capture hook type. Called by the configuration client instead of sending a request.
+ *
+ * @param[in] opcode       Request opcode.
+ * @param[in] p_data       Request payload, may be @c NULL if @c length is 0.
+ * @param[in] length       Request payload length.
+ * @param[in] reply_opcode Opcode of the expected status message.
+ *
+ * @returns The status code returned from the configuration client API.
+ */
+typedef uint32_t (*config_client_bulk_tx_hook_t)(config_opcode_t opcode,
+                                                 const uint8_t * p_data,
+                                                 uint16_t length,
+                                                 config_opcode_t reply_opcode);
+
+/**
+ * Status message hook type. Called by the configuration client for every valid status message.
+ *
+ * @param[in] src     Source address of the status message.
+ * @param[in] p_event Status message.
+ * @param[in] length  Length of the status message.
+ *
+ * @returns @c true if the message was consumed and must not be passed to the client event callback.
+ */
+typedef bool (*config_client_bulk_rx_hook_t)(uint16_t src, const config_client_event_t * p_event, uint16_t length);
+
+/**
+ * Sets the request capture hook of the configuration client.
+ *
+ * @param[in] tx_hook Capture hook, or @c NULL to send requests normally.
+ */
+void config_client_bulk_tx_hook_set(config_client_bulk_tx_hook_t tx_hook);
+
+/**
+ * Sets the status message hook of the configuration client.
+ *
+ * @param[in] rx_hook Status message hook, or @c NULL to disable.
+ */
+void config_client_bulk_rx_hook_set(config_client_bulk_rx_hook_t rx_hook);
+
+/**
+ * Sends an unacknowledged configuration request to a node.
+ *
+ * @param[in] p_dest Destination node.
+ * @param[in] opcode Request opcode.
+ * @param[in] p_data Request payload, may be @c NULL if @c length is 0.
+ * @param[in] length Request payload length.
+ *
+ * @retval NRF_SUCCESS             The request was sent.
+ * @retval NRF_ERROR_BUSY          The client is in a regular transaction.
+ * @retval NRF_ERROR_INVALID_STATE Client not initialized.
+ * @returns Otherwise, the status code from the access layer.
+ */
+uint32_t config_client_bulk_tx(const config_client_bulk_dest_t * p_dest,
+                               config_opcode_t opcode,
+                               const uint8_t * p_data,
+                               uint16_t length);
+
+/** @} end of CONFIG_CLIENT_BULK_INTERNAL */
+
+/** @} end of CONFIG_CLIENT_BULK */
+
+#endif  /* CONFIG_CLIENT_BULK_H__ */
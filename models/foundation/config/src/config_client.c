@@ -36,6 +36,7 @@
  */
 
 #include "config_client.h"
+#include "config_client_bulk.h"
 #include "config_opcodes.h"
 #include "config_messages.h"
 
@@ -100,6 +101,8 @@ typedef struct
 
 static config_client_t m_client;
 static uint8_t * mp_packet_buffer;
+static config_client_bulk_tx_hook_t m_bulk_tx_hook;
+static config_client_bulk_rx_hook_t m_bulk_rx_hook;
 
 /*****************************************************************************
  * Static functions
@@ -136,6 +139,18 @@ static void reliable_status_cb(access_model_handle_t model_handle, void * p_args
 
 static uint32_t send_reliable(config_opcode_t opcode, uint16_t length, config_opcode_t reply_opcode)
 {
+    if (m_bulk_tx_hook != NULL)
+    {
+        /* The bulk engine takes a copy of the request and sends it later. */
+        uint32_t status = m_bulk_tx_hook(opcode, mp_packet_buffer, length, reply_opcode);
+        if (mp_packet_buffer != NULL)
+        {
+            packet_mgr_free(mp_packet_buffer);
+            mp_packet_buffer = NULL;
+        }
+        return status;
+    }
+
     access_reliable_t reliable;
     reliable.model_handle = m_client.model_handle;
     reliable.message.p_buffer = mp_packet_buffer;
@@ -235,6 +250,10 @@ static void config_opcode_handler(access_model_handle_t handle, const access_mes
     }
 
     config_client_event_t evt = {(config_opcode_t) p_message->opcode.opcode, (const config_msg_t *) p_message->p_data};
+    if (m_bulk_rx_hook != NULL && m_bulk_rx_hook(p_message->meta_data.src.value, &evt, p_message->length))
+    {
+        return;
+    }
     m_client.event_cb(CONFIG_CLIENT_EVENT_TYPE_MSG, &evt, p_message->length);
 }
 
@@ -1102,9 +1121,48 @@ void config_client_pending_msg_cancel(void)
     (void)access_model_reliable_cancel(m_client.model_handle);
 }
 
+/*****************************************************************************
+ * Bulk engine hooks
+ *****************************************************************************/
+
+void config_client_bulk_tx_hook_set(config_client_bulk_tx_hook_t tx_hook)
+{
+    m_bulk_tx_hook = tx_hook;
+}
+
+void config_client_bulk_rx_hook_set(config_client_bulk_rx_hook_t rx_hook)
+{
+    m_bulk_rx_hook = rx_hook;
+}
+
+uint32_t config_client_bulk_tx(const config_client_bulk_dest_t * p_dest,
+                               config_opcode_t opcode,
+                               const uint8_t * p_data,
+                               uint16_t length)
+{
+    uint32_t status = NRF_SUCCESS;
+    if (client_in_wrong_state(&status))
+    {
+        return status;
+    }
+
+    access_message_tx_t message;
+    message.opcode.opcode = opcode;
+    message.opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    message.p_buffer = p_data;
+    message.length = length;
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    message.access_token = nrf_mesh_unique_token_get();
+    /* Leave the publication state alone, it still points at the server of regular requests. */
+    return access_model_publish_to(m_client.model_handle, p_dest->address_handle, p_dest->devkey_handle, &message);
+}
+
 #if defined(UNIT_TEST)
 void config_client_reset(void)
 {
     memset(&m_client, 0, sizeof(m_client));
+    m_bulk_tx_hook = NULL;
+    m_bulk_rx_hook = NULL;
 }
 #endif
@@ -0,0 +1,420 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config_client_bulk.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "nrf_mesh_utils.h"
+#include "nrf_error.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+
+/*****************************************************************************
+ * Definitions
+ *****************************************************************************/
+
+typedef enum
+{
+    BULK_OP_STATE_FREE,
+    BULK_OP_STATE_QUEUED,
+    BULK_OP_STATE_IN_FLIGHT
+} bulk_op_state_t;
+
+typedef struct
+{
+    bulk_op_state_t state;
+    /** Queue order. Requests to the same node are sent in ascending order. */
+    uint32_t sequence;
+    config_client_bulk_dest_t dest;
+    config_opcode_t opcode;
+    config_opcode_t reply_opcode;
+    uint16_t length;
+    uint8_t data[CONFIG_CLIENT_BULK_MESSAGE_LENGTH_MAX];
+    /** Time of the first transmission. */
+    timestamp_t sent_at;
+    /** Time of the next retransmission. */
+    timestamp_t next_tx;
+    /** Time at which the request times out. */
+    timestamp_t timeout_at;
+    /** Current retransmission interval. */
+    uint32_t interval;
+} bulk_op_t;
+
+typedef struct
+{
+    config_client_bulk_event_cb_t event_cb;
+    bool capturing;
+    config_client_bulk_dest_t capture_dest;
+    uint32_t next_sequence;
+    uint16_t queued;
+    uint16_t in_flight;
+    uint16_t completed;
+    uint16_t failed;
+    uint32_t retransmissions;
+    uint64_t rtt_sum_us;
+    /** Time the engine went active, i.e. went from having no requests to having some. */
+    timestamp_t active_since;
+    /** Elapsed time, frozen when the engine goes idle. */
+    uint32_t elapsed_us;
+    bool active;
+} bulk_engine_t;
+
+/*****************************************************************************
+ * Static data
+ *****************************************************************************/
+
+static bulk_engine_t m_bulk;
+static bulk_op_t m_ops[CONFIG_CLIENT_BULK_QUEUE_SIZE];
+static timer_event_t m_timer;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t interval_initial(uint8_t hops)
+{
+    return CONFIG_CLIENT_BULK_INTERVAL_BASE + hops * CONFIG_CLIENT_BULK_INTERVAL_PER_HOP;
+}
+
+static uint32_t timeout_get(uint8_t hops)
+{
+    return CONFIG_CLIENT_BULK_TIMEOUT_BASE + hops * CONFIG_CLIENT_BULK_TIMEOUT_PER_HOP;
+}
+
+static uint32_t elapsed_us_get(void)
+{
+    return m_bulk.active ? timer_diff(timer_now(), m_bulk.active_since) : m_bulk.elapsed_us;
+}
+
+static bool destination_in_flight(uint16_t address)
+{
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        if (m_ops[i].state == BULK_OP_STATE_IN_FLIGHT && m_ops[i].dest.address == address)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Finds the oldest queued request whose destination has nothing in flight. */
+static bulk_op_t * next_op_get(void)
+{
+    bulk_op_t * p_next = NULL;
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        if (m_ops[i].state == BULK_OP_STATE_QUEUED &&
+            (p_next == NULL || (int32_t) (m_ops[i].sequence - p_next->sequence) < 0) &&
+            !destination_in_flight(m_ops[i].dest.address))
+        {
+            p_next = &m_ops[i];
+        }
+    }
+    return p_next;
+}
+
+static void op_free(bulk_op_t * p_op)
+{
+    if (p_op->state == BULK_OP_STATE_IN_FLIGHT)
+    {
+        m_bulk.in_flight--;
+    }
+    else
+    {
+        m_bulk.queued--;
+    }
+    p_op->state = BULK_OP_STATE_FREE;
+}
+
+static void op_transmit(bulk_op_t * p_op, timestamp_t now)
+{
+    /* A failed send is treated like a lost packet and retried at the next interval. */
+    (void) config_client_bulk_tx(&p_op->dest, p_op->opcode, p_op->data, p_op->length);
+    p_op->next_tx = now + p_op->interval;
+}
+
+static void dispatch(timestamp_t now)
+{
+    bulk_op_t * p_op;
+    while (m_bulk.in_flight < CONFIG_CLIENT_BULK_IN_FLIGHT_MAX && (p_op = next_op_get()) != NULL)
+    {
+        m_bulk.queued--;
+        m_bulk.in_flight++;
+        p_op->state = BULK_OP_STATE_IN_FLIGHT;
+        p_op->sent_at = now;
+        p_op->interval = interval_initial(p_op->dest.hops);
+        p_op->timeout_at = now + timeout_get(p_op->dest.hops);
+        op_transmit(p_op, now);
+    }
+}
+
+static void timer_update(void)
+{
+    bool found = false;
+    timestamp_t next = 0;
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        if (m_ops[i].state == BULK_OP_STATE_IN_FLIGHT)
+        {
+            timestamp_t deadline = TIMER_OLDER_THAN(m_ops[i].next_tx, m_ops[i].timeout_at) ?
+                m_ops[i].next_tx : m_ops[i].timeout_at;
+            if (!found || TIMER_OLDER_THAN(deadline, next))
+            {
+                next = deadline;
+                found = true;
+            }
+        }
+    }
+
+    if (found)
+    {
+        timer_sch_reschedule(&m_timer, next);
+    }
+    else
+    {
+        timer_sch_abort(&m_timer);
+    }
+}
+
+/** Drops every queued request to @c address, as they may depend on a request that failed. */
+static void destination_cancel(uint16_t address)
+{
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        if (m_ops[i].state == BULK_OP_STATE_QUEUED && m_ops[i].dest.address == address)
+        {
+            op_free(&m_ops[i]);
+            m_bulk.failed++;
+            m_bulk.event_cb(CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED, address, NULL, 0);
+        }
+    }
+}
+
+static void idle_check(void)
+{
+    if (m_bulk.active && m_bulk.queued == 0 && m_bulk.in_flight == 0 && !m_bulk.capturing)
+    {
+        m_bulk.elapsed_us = timer_diff(timer_now(), m_bulk.active_since);
+        m_bulk.active = false;
+        m_bulk.event_cb(CONFIG_CLIENT_BULK_EVENT_TYPE_DONE, NRF_MESH_ADDR_UNASSIGNED, NULL, 0);
+    }
+}
+
+static void timeout_cb(timestamp_t timestamp, void * p_context)
+{
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        bulk_op_t * p_op = &m_ops[i];
+        if (p_op->state != BULK_OP_STATE_IN_FLIGHT)
+        {
+            continue;
+        }
+
+        if (!TIMER_OLDER_THAN(timestamp, p_op->timeout_at))
+        {
+            uint16_t address = p_op->dest.address;
+            op_free(p_op);
+            m_bulk.failed++;
+            m_bulk.event_cb(CONFIG_CLIENT_BULK_EVENT_TYPE_TIMEOUT, address, NULL, 0);
+            destination_cancel(address);
+        }
+        else if (!TIMER_OLDER_THAN(timestamp, p_op->next_tx))
+        {
+            /* Exponential back-off, so a congested or distant node isn't flooded. */
+            p_op->interval = MIN(p_op->interval * 2, CONFIG_CLIENT_BULK_INTERVAL_MAX);
+            m_bulk.retransmissions++;
+            op_transmit(p_op, timestamp);
+        }
+    }
+
+    dispatch(timestamp);
+    timer_update();
+    idle_check();
+}
+
+static bool rx_hook(uint16_t src, const config_client_event_t * p_event, uint16_t length)
+{
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        bulk_op_t * p_op = &m_ops[i];
+        if (p_op->state == BULK_OP_STATE_IN_FLIGHT &&
+            p_op->dest.address == src &&
+            p_op->reply_opcode == p_event->opcode)
+        {
+            timestamp_t now = timer_now();
+            m_bulk.rtt_sum_us += timer_diff(now, p_op->sent_at);
+            m_bulk.completed++;
+            op_free(p_op);
+            m_bulk.event_cb(CONFIG_CLIENT_BULK_EVENT_TYPE_MSG, src, p_event, length);
+
+            dispatch(now);
+            timer_update();
+            idle_check();
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t tx_hook(config_opcode_t opcode, const uint8_t * p_data, uint16_t length, config_opcode_t reply_opcode)
+{
+    if (length > CONFIG_CLIENT_BULK_MESSAGE_LENGTH_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        bulk_op_t * p_op = &m_ops[i];
+        if (p_op->state == BULK_OP_STATE_FREE)
+        {
+            p_op->state = BULK_OP_STATE_QUEUED;
+            p_op->sequence = m_bulk.next_sequence++;
+            p_op->dest = m_bulk.capture_dest;
+            p_op->opcode = opcode;
+            p_op->reply_opcode = reply_opcode;
+            p_op->length = length;
+            if (length > 0)
+            {
+                memcpy(p_op->data, p_data, length);
+            }
+            m_bulk.queued++;
+
+            if (!m_bulk.active)
+            {
+                m_bulk.active = true;
+                m_bulk.active_since = timer_now();
+                m_bulk.completed = 0;
+                m_bulk.failed = 0;
+                m_bulk.retransmissions = 0;
+                m_bulk.rtt_sum_us = 0;
+            }
+            return NRF_SUCCESS;
+        }
+    }
+    return NRF_ERROR_NO_MEM;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t config_client_bulk_init(config_client_bulk_event_cb_t event_cb)
+{
+    if (event_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    memset(&m_bulk, 0, sizeof(m_bulk));
+    memset(m_ops, 0, sizeof(m_ops));
+    m_bulk.event_cb = event_cb;
+    m_timer.cb = timeout_cb;
+    m_timer.p_context = NULL;
+    m_timer.interval = 0;
+    config_client_bulk_rx_hook_set(rx_hook);
+    return NRF_SUCCESS;
+}
+
+uint32_t config_client_bulk_begin(const config_client_bulk_dest_t * p_dest)
+{
+    if (p_dest == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (m_bulk.event_cb == NULL || m_bulk.capturing)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    else if (nrf_mesh_address_type_get(p_dest->address) != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    m_bulk.capture_dest = *p_dest;
+    m_bulk.capturing = true;
+    config_client_bulk_tx_hook_set(tx_hook);
+    return NRF_SUCCESS;
+}
+
+uint32_t config_client_bulk_end(void)
+{
+    if (!m_bulk.capturing)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    config_client_bulk_tx_hook_set(NULL);
+    m_bulk.capturing = false;
+    dispatch(timer_now());
+    timer_update();
+    idle_check();
+    return NRF_SUCCESS;
+}
+
+void config_client_bulk_cancel(void)
+{
+    for (uint32_t i = 0; i < CONFIG_CLIENT_BULK_QUEUE_SIZE; ++i)
+    {
+        if (m_ops[i].state != BULK_OP_STATE_FREE)
+        {
+            uint16_t address = m_ops[i].dest.address;
+            op_free(&m_ops[i]);
+            m_bulk.failed++;
+            m_bulk.event_cb(CONFIG_CLIENT_BULK_EVENT_TYPE_CANCELLED, address, NULL, 0);
+        }
+    }
+    timer_update();
+    idle_check();
+}
+
+void config_client_bulk_progress_get(config_client_bulk_progress_t * p_progress)
+{
+    uint32_t elapsed_us = elapsed_us_get();
+    p_progress->queued = m_bulk.queued;
+    p_progress->in_flight = m_bulk.in_flight;
+    p_progress->completed = m_bulk.completed;
+    p_progress->failed = m_bulk.failed;
+    p_progress->retransmissions = m_bulk.retransmissions;
+    p_progress->elapsed_ms = elapsed_us / 1000;
+    p_progress->rtt_avg_ms = (m_bulk.completed > 0) ? (uint32_t) (m_bulk.rtt_sum_us / m_bulk.completed / 1000) : 0;
+    p_progress->throughput_per_minute = (elapsed_us > 0) ? (uint32_t) (((uint64_t) m_bulk.completed * SEC_TO_US(60)) / elapsed_us) : 0;
+}
@@ -0,0 +1,194 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MODEL_TRANSITION_H__
+#define MODEL_TRANSITION_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "model_common.h"
+
+/**
+ * @defgroup MODEL_TRANSITION Shared transition engine for models.
+ * @ingroup MODEL_COMMON
+ * Drives delayed and gradual state transitions for any number of model instances from a single
+ * periodic tick.
+ *
+ * Instead of every server instance owning a @ref model_timer_t that fires once per level step,
+ * all active transitions are kept in a compact array and interpolated together whenever the
+ * shared tick expires. The tick only runs while at least one transition is active, so an idle
+ * node has no transition related timer activity at all.
+ *
+ * Transitions are identified by their `p_context` pointer, typically the server instance that
+ * started them. Starting a new transition for a context that already has one active replaces it.
+ *
+ * Two kinds of transitions are supported:
+ * - @ref MODEL_TRANSITION_TYPE_LINEAR moves the value from `start_value` to `target_value` over
+ *   `transition_time_ms`. Generic Set and Generic Delta Set transitions both map to this type;
+ *   for Delta Set, the caller computes the target from the accumulated delta.
+ * - @ref MODEL_TRANSITION_TYPE_MOVE changes the value by `move_delta` every `transition_time_ms`
+ *   until it reaches `target_value`, or until the transition is aborted.
+ *
+ * The engine time base is the RTC counter read through APP_TIMER, which makes the module testable
+ * on the host by stubbing the APP_TIMER counter with simulated time.
+ *
+ * @{
+ */
+
+/** Maximum number of simultaneously active transitions. */
+#ifndef MODEL_TRANSITION_SLOT_COUNT
+#define MODEL_TRANSITION_SLOT_COUNT             (8)
+#endif
+
+/** Interval between two ticks of the shared transition timer, in milliseconds. */
+#ifndef MODEL_TRANSITION_TICK_INTERVAL_MS
+#define MODEL_TRANSITION_TICK_INTERVAL_MS       (20)
+#endif
+
+/** Transition types handled by the engine. */
+typedef enum
+{
+    /** Linear interpolation from the start value to the target value. */
+    MODEL_TRANSITION_TYPE_LINEAR,
+    /** Constant rate change of `move_delta` per transition time, until the target is reached. */
+    MODEL_TRANSITION_TYPE_MOVE
+} model_transition_type_t;
+
+/**
+ * Transition value callback.
+ *
+ * Called from the shared tick whenever the interpolated value of a transition changes, and once
+ * with @p complete set when the transition reaches its target. The transition is no longer active
+ * when the completing call is made, so the callback may start a new transition for the same context.
+ *
+ * @param[in] p_context     Context pointer the transition was started with.
+ * @param[in] present_value New present value.
+ * @param[in] complete      True if this is the final value of the transition.
+ */
+typedef void (*model_transition_cb_t)(void * p_context, int32_t present_value, bool complete);
+
+/** Parameters for starting a transition. */
+typedef struct
+{
+    /** Transition type. */
+    model_transition_type_t type;
+    /** Present value at the moment the transition starts. */
+    int32_t start_value;
+    /** Target value for linear transitions, or the limit value for move transitions. */
+    int32_t target_value;
+    /** Value change per `transition_time_ms`. Only used by move transitions. */
+    int32_t move_delta;
+    /** Delay before the transition starts, in milliseconds. */
+    uint32_t delay_ms;
+    /** Transition time in milliseconds. May only be zero for linear transitions with a delay, in
+     * which case the target value is reached when the delay expires. */
+    uint32_t transition_time_ms;
+    /** Value callback. */
+    model_transition_cb_t cb;
+    /** Context pointer identifying the transition, passed to the callback. */
+    void * p_context;
+} model_transition_params_t;
+
+/**
+ * Initializes the transition engine.
+ *
+ * Creates the shared APP_TIMER instance. Calling this function more than once is allowed, so
+ * every model behaviour module using the engine may call it from its own init function.
+ *
+ * @retval NRF_SUCCESS      The engine is ready for use.
+ * @returns Other return values returned by @ref model_timer_create().
+ */
+uint32_t model_transition_init(void);
+
+/**
+ * Starts a transition, replacing any active transition with the same context.
+ *
+ * @param[in] p_params              Transition parameters.
+ *
+ * @retval NRF_SUCCESS              The transition was started.
+ * @retval NRF_ERROR_NULL           The parameters, the callback or the context are NULL.
+ * @retval NRF_ERROR_INVALID_PARAM  Both transition time and delay are zero for a linear transition,
+ *                                  or the transition time or move delta is zero for a move transition.
+ * @retval NRF_ERROR_NO_MEM         All @ref MODEL_TRANSITION_SLOT_COUNT slots are in use.
+ * @retval NRF_ERROR_INVALID_STATE  The engine has not been initialized.
+ */
+uint32_t model_transition_start(const model_transition_params_t * p_params);
+
+/**
+ * Aborts the active transition for the given context, leaving the value where it is.
+ *
+ * The callback is not called.
+ *
+ * @param[in] p_context     Context pointer the transition was started with.
+ *
+ * @retval NRF_SUCCESS          The transition was aborted.
+ * @retval NRF_ERROR_NOT_FOUND  There is no active transition for the context.
+ */
+uint32_t model_transition_abort(const void * p_context);
+
+/**
+ * Checks whether the given context has an active transition, including its delay phase.
+ *
+ * @param[in] p_context     Context pointer the transition was started with.
+ *
+ * @returns True if a transition is active for the context.
+ */
+bool model_transition_is_active(const void * p_context);
+
+/**
+ * Gets the remaining time of the transition for the given context, for use in status replies.
+ *
+ * For linear transitions this is the time until the target value is reached, including any
+ * remaining delay. For move transitions this is the configured transition time, as required by
+ * the Generic Level Move behaviour.
+ *
+ * @param[in] p_context     Context pointer the transition was started with.
+ *
+ * @returns Remaining time in milliseconds, or 0 if there is no active transition for the context.
+ */
+uint32_t model_transition_remaining_time_get(const void * p_context);
+
+/**
+ * Gets the number of active transitions.
+ *
+ * @returns Number of slots currently in use.
+ */
+uint32_t model_transition_active_count_get(void);
+
+/** @} end of MODEL_TRANSITION */
+
+#endif /* MODEL_TRANSITION_H__ */
@@ -0,0 +1,347 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "model_transition.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "app_timer.h"
+#include "model_common.h"
+#include "nrf_mesh_assert.h"
+#include "utils.h"
+
+/** Single active transition. Kept small, as all active entries are walked on every tick. */
+typedef struct
+{
+    void * p_context;
+    model_transition_cb_t cb;
+    /** Engine time at which the transition phase starts, after the delay. */
+    uint64_t start_ticks;
+    /** Transition time in engine ticks. */
+    uint64_t transition_ticks;
+    uint32_t transition_time_ms;
+    int32_t start_value;
+    int32_t target_value;
+    int32_t move_delta;
+    /** Last value reported through the callback. */
+    int32_t present_value;
+    model_transition_type_t type;
+} transition_slot_t;
+
+NRF_MESH_STATIC_ASSERT(MODEL_TRANSITION_SLOT_COUNT > 0);
+NRF_MESH_STATIC_ASSERT(MODEL_TRANSITION_TICK_INTERVAL_MS > 0);
+
+APP_TIMER_DEF(m_transition_app_timer);
+
+/* Active transitions are kept packed in the beginning of the array. */
+static transition_slot_t m_slots[MODEL_TRANSITION_SLOT_COUNT];
+static uint32_t m_active_count;
+
+static model_timer_t m_timer;
+static bool m_initialized;
+static bool m_tick_running;
+
+/* Monotonic engine time in RTC ticks, extended from the 24 bit APP_TIMER counter. */
+static uint64_t m_now_ticks;
+static uint32_t m_last_rtc_stamp;
+
+static void time_update(void)
+{
+    uint32_t rtc_stamp = app_timer_cnt_get();
+    m_now_ticks += app_timer_cnt_diff_compute(rtc_stamp, m_last_rtc_stamp);
+    m_last_rtc_stamp = rtc_stamp;
+}
+
+static transition_slot_t * slot_find(const void * p_context)
+{
+    for (uint32_t i = 0; i < m_active_count; ++i)
+    {
+        if (m_slots[i].p_context == p_context)
+        {
+            return &m_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void slot_remove(transition_slot_t * p_slot)
+{
+    NRF_MESH_ASSERT(m_active_count > 0);
+    transition_slot_t * p_last = &m_slots[m_active_count - 1];
+    if (p_slot != p_last)
+    {
+        *p_slot = *p_last;
+    }
+    m_active_count--;
+}
+
+/* Computes the present value of the slot. Returns true if the transition has completed. */
+static bool slot_value_get(const transition_slot_t * p_slot, int32_t * p_value)
+{
+    uint64_t elapsed_ticks = (m_now_ticks > p_slot->start_ticks) ? (m_now_ticks - p_slot->start_ticks) : 0;
+
+    if (p_slot->type == MODEL_TRANSITION_TYPE_LINEAR)
+    {
+        if (elapsed_ticks >= p_slot->transition_ticks)
+        {
+            *p_value = p_slot->target_value;
+            return true;
+        }
+
+        int64_t delta = (int64_t) p_slot->target_value - p_slot->start_value;
+        *p_value = p_slot->start_value + (int32_t) ((delta * (int64_t) elapsed_ticks) / (int64_t) p_slot->transition_ticks);
+        return false;
+    }
+    else
+    {
+        int64_t value = p_slot->start_value +
+                        ((int64_t) p_slot->move_delta * (int64_t) elapsed_ticks) / (int64_t) p_slot->transition_ticks;
+
+        if ((p_slot->move_delta > 0 && value >= p_slot->target_value) ||
+            (p_slot->move_delta < 0 && value <= p_slot->target_value))
+        {
+            *p_value = p_slot->target_value;
+            return true;
+        }
+
+        *p_value = (int32_t) value;
+        return false;
+    }
+}
+
+/* Schedules the next tick: after the tick interval, or earlier if a delay or a linear transition
+ * ends before that, so that transitions start and complete on time. */
+static void tick_schedule(void)
+{
+    if (m_active_count == 0)
+    {
+        if (m_tick_running)
+        {
+            model_timer_abort(&m_timer);
+            m_tick_running = false;
+        }
+        return;
+    }
+
+    uint64_t next_ticks = MODEL_TIMER_TICKS_GET_MS(MODEL_TRANSITION_TICK_INTERVAL_MS);
+    for (uint32_t i = 0; i < m_active_count; ++i)
+    {
+        const transition_slot_t * p_slot = &m_slots[i];
+        uint64_t event_ticks = p_slot->start_ticks;
+        if (m_now_ticks >= event_ticks && p_slot->type == MODEL_TRANSITION_TYPE_LINEAR)
+        {
+            event_ticks += p_slot->transition_ticks;
+        }
+
+        if (event_ticks > m_now_ticks && event_ticks - m_now_ticks < next_ticks)
+        {
+            next_ticks = event_ticks - m_now_ticks;
+        }
+    }
+
+    m_timer.mode = MODEL_TIMER_MODE_SINGLE_SHOT;
+    m_timer.timeout_rtc_ticks = MAX(next_ticks, MODEL_TIMER_TIMEOUT_MIN_TICKS);
+    NRF_MESH_ERROR_CHECK(model_timer_schedule(&m_timer));
+    m_tick_running = true;
+}
+
+static void transition_tick_cb(void * p_context)
+{
+    time_update();
+
+    uint32_t i = 0;
+    while (i < m_active_count)
+    {
+        transition_slot_t * p_slot = &m_slots[i];
+
+        if (m_now_ticks < p_slot->start_ticks)
+        {
+            /* Still in the delay phase. */
+            i++;
+            continue;
+        }
+
+        int32_t value;
+        if (slot_value_get(p_slot, &value))
+        {
+            /* Free the slot before notifying, so the callback can start a new transition. */
+            model_transition_cb_t cb = p_slot->cb;
+            void * p_slot_context = p_slot->p_context;
+            slot_remove(p_slot);
+            cb(p_slot_context, value, true);
+        }
+        else
+        {
+            if (value != p_slot->present_value)
+            {
+                p_slot->present_value = value;
+                p_slot->cb(p_slot->p_context, value, false);
+            }
+            i++;
+        }
+    }
+
+    tick_schedule();
+}
+
+/***** Interface functions *****/
+
+uint32_t model_transition_init(void)
+{
+    if (m_initialized)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_active_count = 0;
+    m_tick_running = false;
+    m_now_ticks = 0;
+    m_last_rtc_stamp = app_timer_cnt_get();
+
+    m_timer.p_timer_id = &m_transition_app_timer;
+    m_timer.cb = transition_tick_cb;
+    m_timer.p_context = NULL;
+
+    uint32_t status = model_timer_create(&m_timer);
+    if (status == NRF_SUCCESS)
+    {
+        m_initialized = true;
+    }
+    return status;
+}
+
+uint32_t model_transition_start(const model_transition_params_t * p_params)
+{
+    if (p_params == NULL || p_params->cb == NULL || p_params->p_context == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if ((p_params->type == MODEL_TRANSITION_TYPE_LINEAR &&
+         p_params->transition_time_ms == 0 && p_params->delay_ms == 0) ||
+        (p_params->type == MODEL_TRANSITION_TYPE_MOVE &&
+         (p_params->transition_time_ms == 0 || p_params->move_delta == 0)))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    transition_slot_t * p_slot = slot_find(p_params->p_context);
+    if (p_slot == NULL)
+    {
+        if (m_active_count == MODEL_TRANSITION_SLOT_COUNT)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+        p_slot = &m_slots[m_active_count++];
+    }
+
+    time_update();
+
+    p_slot->p_context = p_params->p_context;
+    p_slot->cb = p_params->cb;
+    p_slot->type = p_params->type;
+    p_slot->start_value = p_params->start_value;
+    p_slot->present_value = p_params->start_value;
+    p_slot->target_value = p_params->target_value;
+    p_slot->move_delta = p_params->move_delta;
+    p_slot->transition_time_ms = p_params->transition_time_ms;
+    p_slot->transition_ticks = MODEL_TIMER_TICKS_GET_MS(p_params->transition_time_ms);
+    if (p_slot->type == MODEL_TRANSITION_TYPE_MOVE && p_slot->transition_ticks == 0)
+    {
+        /* Used as divisor for the move rate. */
+        p_slot->transition_ticks = 1;
+    }
+    p_slot->start_ticks = m_now_ticks + MODEL_TIMER_TICKS_GET_MS(p_params->delay_ms);
+
+    tick_schedule();
+    return NRF_SUCCESS;
+}
+
+uint32_t model_transition_abort(const void * p_context)
+{
+    transition_slot_t * p_slot = slot_find(p_context);
+    if (p_slot == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    slot_remove(p_slot);
+    if (m_active_count == 0)
+    {
+        tick_schedule();
+    }
+    return NRF_SUCCESS;
+}
+
+bool model_transition_is_active(const void * p_context)
+{
+    return (slot_find(p_context) != NULL);
+}
+
+uint32_t model_transition_remaining_time_get(const void * p_context)
+{
+    const transition_slot_t * p_slot = slot_find(p_context);
+    if (p_slot == NULL)
+    {
+        return 0;
+    }
+
+    if (p_slot->type == MODEL_TRANSITION_TYPE_MOVE)
+    {
+        return p_slot->transition_time_ms;
+    }
+
+    time_update();
+
+    uint64_t end_ticks = p_slot->start_ticks + p_slot->transition_ticks;
+    if (m_now_ticks >= end_ticks)
+    {
+        return 0;
+    }
+    return MODEL_TIMER_PERIOD_MS_GET(end_ticks - m_now_ticks);
+}
+
+uint32_t model_transition_active_count_get(void)
+{
+    return m_active_count;
+}
@@ -0,0 +1,214 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Decoder for the binary records written by the deferred logging backend (log_callback_deferred()).
+
+The records only hold the addresses of the format strings and filenames, so the ELF file of the
+application that produced the log is needed to decode them. The output has the same format as the
+RTT log backend.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+
+HEADER = struct.Struct("<IIIHBB")
+WORD_SIZE = 4
+
+LEVEL_MASK = 0x3F
+FLAG_ARRAY = (1 << 7)
+FLAG_TRUNCATED = (1 << 6)
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+CONVERSION_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcspeEfFgGaAn%])")
+
+
+class ElfImage(object):
+    """Read-only view of the allocated sections of a 32-bit little endian ELF file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s is not a 32-bit little endian ELF file" % path)
+
+        (shoff,) = struct.unpack_from("<I", data, 0x20)
+        (shentsize, shnum) = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                "<IIIIII", data, shoff + i * shentsize)
+            if (flags & SHF_ALLOC) and sh_type != SHT_NOBITS and size > 0:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string_get(self, address):
+        for (start, data) in self.sections:
+            if start <= address < start + len(data):
+                end = data.find(b"\0", address - start)
+                if end < 0:
+                    end = len(data)
+                return data[address - start:end].decode("utf-8", "replace")
+        return "<unknown string at 0x%08x>" % address
+
+
+class ArgumentReader(object):
+    def __init__(self, words):
+        self.words = words
+        self.index = 0
+
+    def word(self):
+        if self.index >= len(self.words):
+            raise IndexError()
+        self.index += 1
+        return self.words[self.index - 1]
+
+    def double_word(self):
+        low = self.word()
+        return (self.word() << 32) | low
+
+    def bytes(self):
+        length = self.word()
+        count = (length + WORD_SIZE - 1) // WORD_SIZE
+        data = b"".join(struct.pack("<I", self.word()) for _ in range(count))
+        return data[:length]
+
+
+def signed(value, bits):
+    if value & (1 << (bits - 1)):
+        return value - (1 << bits)
+    return value
+
+
+def conversion_format(match, reader):
+    (flags, width, precision, length, conversion) = match.groups()
+    if conversion == "%":
+        return "%"
+    if width == "*":
+        width = str(signed(reader.word(), 32))
+    if precision == "*":
+        precision = str(signed(reader.word(), 32))
+    spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+
+    if conversion == "n":
+        return ""
+    if conversion == "s":
+        return (spec + "s") % reader.bytes().decode("utf-8", "replace")
+    if conversion in "eEfFgGaA":
+        value = struct.unpack("<d", struct.pack("<Q", reader.double_word()))[0]
+        if conversion in "aA":
+            return value.hex()
+        return (spec + conversion) % value
+    if conversion == "p":
+        return "0x%08x" % reader.word()
+
+    # Integers, sized for the 32-bit target.
+    if length in ("ll", "j"):
+        (value, bits) = (reader.double_word(), 64)
+    else:
+        (value, bits) = (reader.word(), 32)
+    if length == "h":
+        (value, bits) = (value & 0xFFFF, 16)
+    elif length == "hh":
+        (value, bits) = (value & 0xFF, 8)
+
+    if conversion == "c":
+        return (spec + "c") % chr(value & 0xFF)
+    if conversion in "di":
+        return (spec + "d") % signed(value, bits)
+    if conversion == "u":
+        return (spec + "d") % value
+    return (spec + conversion) % value
+
+
+def message_format(fmt, words):
+    reader = ArgumentReader(words)
+    out = []
+    pos = 0
+    for match in CONVERSION_RE.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        try:
+            out.append(conversion_format(match, reader))
+        except IndexError:
+            out.append("<truncated>")
+            pos = len(fmt)
+            break
+        pos = match.end()
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def records_decode(data, image):
+    """Generates (level, text) for each complete record in the data."""
+    offset = 0
+    while offset + HEADER.size <= len(data):
+        (fmt, filename, timestamp, line, flags_level, args_length) = HEADER.unpack_from(data, offset)
+        end = offset + HEADER.size + args_length * WORD_SIZE
+        if end > len(data):
+            break
+        words = struct.unpack_from("<%dI" % args_length, data, offset + HEADER.size)
+        offset = end
+
+        if flags_level & FLAG_ARRAY:
+            array = ArgumentReader(words).bytes()
+            message = "%s: %s\n" % (image.string_get(fmt), array.hex().upper())
+        else:
+            message = message_format(image.string_get(fmt), words)
+        if flags_level & FLAG_TRUNCATED and not message.endswith("\n"):
+            message += "\n"
+
+        yield (flags_level & LEVEL_MASK,
+               "<t: %10u>, %s, %4d, %s" % (timestamp, image.string_get(filename), line, message))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes a binary log from the deferred logging backend.")
+    parser.add_argument("elf", help="ELF file of the application that produced the log")
+    parser.add_argument("log", nargs="?", help="Binary log file, for instance captured with JLinkRTTLogger. "
+                        "Reads from stdin if not given.")
+    parser.add_argument("-l", "--level", type=int, default=None, help="Only print messages up to this log level")
+    args = parser.parse_args()
+
+    image = ElfImage(args.elf)
+    if args.log:
+        with open(args.log, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    for (level, text) in records_decode(data, image):
+        if args.level is None or level <= args.level:
+            sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,352 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+import asyncio
+import collections
+import logging
+import threading
+import traceback
+
+from serial import Serial
+from aci.aci_cmd import CommandPacket
+from aci.aci_evt import Event, event_deserialize
+
+# Commands that are answered by an event other than the command response.
+RESPONSE_EVENT_LUT = {
+    0x02: Event.DEVICE_ECHO_RSP,  # Echo
+}
+RESPONSE_EVENT_CMD_LUT = {event: opcode for opcode, event in RESPONSE_EVENT_LUT.items()}
+
+
+class PacketDecoder(object):
+    """Splits a serial byte stream into length-prefixed packets.
+
+    Every packet is a length byte, followed by that many bytes of opcode and payload. The decoder
+    works on whole chunks of received data, slicing out each complete packet at once, and keeps
+    the trailing partial packet for the next chunk.
+    """
+    def __init__(self):
+        self.__buffer = bytearray()
+
+    def feed(self, data):
+        """Adds received bytes, and returns the list of complete packets."""
+        buf = self.__buffer
+        buf += data
+        packets = []
+        start = 0
+        end = len(buf)
+        while start < end:
+            packet_end = start + buf[start] + 1
+            if packet_end > end:
+                break
+            packets.append(buf[start:packet_end])
+            start = packet_end
+        del buf[:start]
+        return packets
+
+
+class AsyncDevice(object):
+    """ACI transport on an asyncio event loop.
+
+    Commands are pipelined: up to `window` commands can be outstanding at a time, and each
+    response is matched to its command by opcode. The device handles commands in order, so
+    responses with the same opcode arrive in the order the commands were sent. Commands queued
+    in the same iteration of the event loop go to the port in a single write.
+
+    Parameters
+    ----------
+        port : str
+            Serial port to open.
+        baudrate : int
+            Baud rate.
+        device_name : str
+            Name for logging, defaults to the port name.
+        window : int
+            Maximum number of commands awaiting a response.
+        timeout : float
+            Time to wait for a response, in seconds.
+    """
+    def __init__(self, port, baudrate=115200, device_name=None, rtscts=True, window=8, timeout=2.0,
+                 loop=None):
+        self.device_name = device_name or port
+        self.logger = logging.getLogger(self.device_name)
+        self.window = window
+        self.timeout = timeout
+        self._pack_recipients = []
+        self._cmd_recipients = []
+        self.serial = Serial(port=port, baudrate=baudrate, rtscts=rtscts, timeout=0)
+        self.__loop = loop or asyncio.get_event_loop()
+        self.__decoder = PacketDecoder()
+        self.__tx_buffer = bytearray()
+        self.__tx_scheduled = False
+        self.__outstanding = collections.defaultdict(collections.deque)
+        self.__slots = asyncio.Semaphore(window)
+        self.__loop.add_reader(self.serial.fileno(), self.__on_readable)
+
+    def close(self):
+        self.__loop.remove_reader(self.serial.fileno())
+        for futures in self.__outstanding.values():
+            for future in futures:
+                future.cancel()
+        self.__outstanding.clear()
+        self.serial.close()
+
+    def add_packet_recipient(self, function):
+        self._pack_recipients.append(function)
+
+    def remove_packet_recipient(self, function):
+        if function in self._pack_recipients:
+            self._pack_recipients.remove(function)
+
+    def add_command_recipient(self, function):
+        self._cmd_recipients.append(function)
+
+    async def send(self, cmd):
+        """Sends a command, and returns its response event, or None on timeout."""
+        if not isinstance(cmd, CommandPacket):
+            raise TypeError("Expected a CommandPacket, got %r" % cmd)
+        await self.__slots.acquire()
+        try:
+            response_opcode = RESPONSE_EVENT_LUT.get(cmd._opcode, Event.CMD_RSP)
+            future = self.__loop.create_future()
+            queue = self.__outstanding[(response_opcode, cmd._opcode)]
+            queue.append(future)
+            self.__write(cmd.serialize())
+            timer = self.__loop.call_later(self.timeout, self.__expire, cmd, future)
+            try:
+                return await future
+            finally:
+                timer.cancel()
+        finally:
+            self.__slots.release()
+
+    def __expire(self, cmd, future):
+        # The device answers every command, so a timed out command stays in its queue. Its late
+        # response then pops it and is discarded, instead of being taken as the response to the
+        # next command with the same opcode.
+        if not future.done():
+            future.set_result(None)
+            self.logger.info('cmd %s, timeout waiting for event' % (cmd.__class__.__name__))
+
+    async def send_all(self, cmds):
+        """Sends a list of commands, pipelined, and returns the list of responses."""
+        return await asyncio.gather(*(self.send(cmd) for cmd in cmds))
+
+    def __write(self, data):
+        self.__tx_buffer += data
+        if not self.__tx_scheduled:
+            self.__tx_scheduled = True
+            self.__loop.call_soon(self.__flush)
+
+    def __flush(self):
+        self.__tx_scheduled = False
+        data, self.__tx_buffer = self.__tx_buffer, bytearray()
+        self.logger.debug("TX: %s", data.hex())
+        self.serial.write(data)
+        for fun in self._cmd_recipients[:]:
+            try:
+                fun(data)
+            except:
+                self.logger.error('Exception in cmd handler %r', fun)
+                self.logger.error('traceback: %s', traceback.format_exc())
+
+    def __on_readable(self):
+        data = self.serial.read(max(self.serial.in_waiting, 1))
+        for packet in self.__decoder.feed(data):
+            self.logger.debug("RX: %s", packet.hex())
+            if len(packet) < 2:
+                self.logger.error('Invalid packet: %r', packet)
+                continue
+            try:
+                event = event_deserialize(packet)
+            except Exception:
+                self.logger.error('Exception with packet %s', packet.hex())
+                self.logger.error('traceback: %s', traceback.format_exc())
+                continue
+            if not event:
+                self.logger.error("Unable to deserialize %s", packet.hex())
+                continue
+            self.__match(event)
+            self.process_packet(event)
+
+    def __match(self, event):
+        if event._opcode == Event.CMD_RSP:
+            key = (Event.CMD_RSP, event._data["opcode"])
+        elif event._opcode in RESPONSE_EVENT_CMD_LUT:
+            key = (event._opcode, RESPONSE_EVENT_CMD_LUT[event._opcode])
+        else:
+            return
+        queue = self.__outstanding.get(key)
+        if queue:
+            future = queue.popleft()
+            if not future.done():
+                future.set_result(event)
+
+    def process_packet(self, packet):
+        for fun in self._pack_recipients[:]:
+            try:
+                fun(packet)
+            except:
+                self.logger.error('Exception in pkt handler %r', fun)
+                self.logger.error('traceback: %s', traceback.format_exc())
+
+
+class AsyncUart(object):
+    """Drop-in replacement for aci_uart.Uart on an AsyncDevice.
+
+    The event loop runs in a background thread. write_aci_cmd() queues a command without waiting
+    for the response, so commands from the interactive session are pipelined too.
+    """
+    def __init__(self, port, baudrate=115200, device_name=None, rtscts=True, window=8):
+        self.loop = asyncio.new_event_loop()
+        ready = threading.Event()
+        self.__thread = threading.Thread(target=self.__run, args=(ready,), daemon=True)
+        self.__thread.start()
+        ready.wait()
+        self.device = self.__call(self.__create, port, baudrate, device_name, rtscts, window)
+        self.device_name = self.device.device_name
+        self.logger = self.device.logger
+        self.serial = self.device.serial
+
+    async def __create(self, *args):
+        return AsyncDevice(*args, loop=self.loop)
+
+    def __run(self, ready):
+        asyncio.set_event_loop(self.loop)
+        self.loop.call_soon(ready.set)
+        self.loop.run_forever()
+
+    def __call(self, coroutine_function, *args):
+        return asyncio.run_coroutine_threadsafe(coroutine_function(*args), self.loop).result()
+
+    def stop(self):
+        if self.loop.is_running():
+            self.__call(self.__shutdown)
+            self.loop.call_soon_threadsafe(self.loop.stop)
+            self.__thread.join()
+
+    async def __shutdown(self):
+        self.device.close()
+        tasks = [t for t in asyncio.all_tasks(self.loop) if t is not asyncio.current_task()]
+        await asyncio.gather(*tasks, return_exceptions=True)
+
+    def add_packet_recipient(self, function):
+        self.loop.call_soon_threadsafe(self.device.add_packet_recipient, function)
+
+    def remove_packet_recipient(self, function):
+        self.loop.call_soon_threadsafe(self.device.remove_packet_recipient, function)
+
+    def add_command_recipient(self, function):
+        self.loop.call_soon_threadsafe(self.device.add_command_recipient, function)
+
+    def write_aci_cmd(self, cmd):
+        """Queues a command. Returns a concurrent.futures.Future for its response."""
+        if isinstance(cmd, CommandPacket):
+            return asyncio.run_coroutine_threadsafe(self.device.send(cmd), self.loop)
+        else:
+            self.logger.error('The command provided is not valid: %s\nIt must be an instance of the CommandPacket class (or one of its subclasses)', str(cmd))
+
+    def send_all(self, cmds):
+        """Sends a list of commands, pipelined, and waits for all the responses."""
+        return self.__call(self.device.send_all, cmds)
+
+    def __repr__(self):
+        return '%s(port="%s", baudrate=%s, device_name="%s")' % (self.__class__.__name__, self.serial.port, self.serial.baudrate, self.device_name)
+
+
+def loopback_benchmark(transport, count, latency):
+    """Sends a number of commands to a simulated device on a pty, and returns commands/second."""
+    import time
+    from aci.aci_cmd import SerialVersionGet
+    from aci.aci_loopback import PtyLoopback
+
+    device = PtyLoopback(latency)
+    uart = transport(device.port, baudrate=1000000, rtscts=False)
+    responses = threading.Semaphore(0)
+    uart.add_packet_recipient(lambda event: responses.release())
+    try:
+        start = time.monotonic()
+        for _ in range(count):
+            uart.write_aci_cmd(SerialVersionGet())
+        for _ in range(count):
+            if not responses.acquire(timeout=5):
+                raise RuntimeError("Timeout waiting for responses")
+        return count / (time.monotonic() - start)
+    finally:
+        uart.stop()
+        if isinstance(uart, threading.Thread):
+            # Let the reader of aci_uart.Uart see the stop before the pty goes away.
+            uart.join()
+        device.stop()
+
+
+def loopback_late_response_check(latency=0.5, timeout=0.3):
+    """Checks that a response arriving after its command timed out is discarded, and not taken as
+    the response to the next command with the same opcode."""
+    from aci.aci_cmd import Echo
+    from aci.aci_loopback import PtyLoopback
+
+    device = PtyLoopback(latency)
+    loop = asyncio.new_event_loop()
+
+    async def exchange():
+        aci = AsyncDevice(device.port, baudrate=1000000, rtscts=False, timeout=timeout, loop=loop)
+        try:
+            late = await aci.send(Echo(b"late"))
+            device.latency = 0
+            return late, await aci.send(Echo(b"on time"))
+        finally:
+            aci.close()
+
+    try:
+        late, on_time = loop.run_until_complete(exchange())
+    finally:
+        loop.close()
+        device.stop()
+    if late is not None:
+        raise RuntimeError("Expected a timeout, got %r" % late)
+    if on_time is None or on_time._data["data"] != b"on time":
+        raise RuntimeError("Expected the echo of the second command, got %r" % on_time)
+
+
+if __name__ == "__main__":
+    from argparse import ArgumentParser
+    from aci.aci_uart import Uart
+
+    parser = ArgumentParser(description="Measures the command throughput of the ACI transports.")
+    parser.add_argument("-n", "--count", type=int, default=2000, help="Number of commands to send")
+    parser.add_argument("-l", "--latency", type=float, nargs="+", default=[0, 0.0005, 0.001, 0.002],
+                        help="Response latencies of the simulated device to compare, in seconds")
+    args = parser.parse_args()
+
+    loopback_late_response_check()
+    for latency in args.latency:
+        for transport in (Uart, AsyncUart):
+            print("{:.1f} ms latency, {}: {:.0f} commands/s".format(
+                latency * 1000, transport.__name__, loopback_benchmark(transport, args.count, latency)))
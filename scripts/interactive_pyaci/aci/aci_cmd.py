@@ -157,6 +157,48 @@ class HousekeepingDataClear(CommandPacket):
         super(HousekeepingDataClear, self).__init__(0x15, __data)
 
 
+class InstrHistogramGet(CommandPacket):
+    """Get the latency histogram of a packet processing stage.
+
+    Parameters
+    ----------
+        stage : uint8_t
+            Stage to get the histogram of, see @ref instr_stage_t.
+    """
+    def __init__(self, stage):
+        __data = bytearray()
+        __data += struct.pack("<B", stage)
+        super(InstrHistogramGet, self).__init__(0x16, __data)
+
+
+class InstrClear(CommandPacket):
+    """Clear the latency histograms of all packet processing stages."""
+    def __init__(self):
+        __data = bytearray()
+        super(InstrClear, self).__init__(0x17, __data)
+
+
+class PacketTraceStart(CommandPacket):
+    """Start recording a new trace of the packets received by the scanner."""
+    def __init__(self):
+        __data = bytearray()
+        super(PacketTraceStart, self).__init__(0x18, __data)
+
+
+class PacketTraceStop(CommandPacket):
+    """Stop recording the packet trace."""
+    def __init__(self):
+        __data = bytearray()
+        super(PacketTraceStop, self).__init__(0x19, __data)
+
+
+class PacketTraceRead(CommandPacket):
+    """Read out the next part of the recorded packet trace."""
+    def __init__(self):
+        __data = bytearray()
+        super(PacketTraceRead, self).__init__(0x1A, __data)
+
+
 class Application(CommandPacket):
     """Application-specific command, has no functionality in the framework, but is forwarded to
     the application.
@@ -920,6 +962,41 @@ class StateClear(CommandPacket):
         super(StateClear, self).__init__(0xAC, __data)
 
 
+class HeartbeatTableGet(CommandPacket):
+    """Get entries of the heartbeat collector table, sorted by source address.
+
+    Parameters
+    ----------
+        start_index : uint16_t
+            Index of the first heartbeat collector entry to get.
+    """
+    def __init__(self, start_index=0):
+        __data = bytearray()
+        __data += struct.pack("<H", start_index)
+        super(HeartbeatTableGet, self).__init__(0xAD, __data)
+
+
+class HeartbeatTableClear(CommandPacket):
+    """Remove all entries from the heartbeat collector table."""
+    def __init__(self):
+        __data = bytearray()
+        super(HeartbeatTableClear, self).__init__(0xAE, __data)
+
+
+class StatsGet(CommandPacket):
+    """Get the statistics counters of the stack."""
+    def __init__(self):
+        __data = bytearray()
+        super(StatsGet, self).__init__(0xB0, __data)
+
+
+class StatsClear(CommandPacket):
+    """Reset all the statistics counters to zero."""
+    def __init__(self):
+        __data = bytearray()
+        super(StatsClear, self).__init__(0xB1, __data)
+
+
 class JumpToBootloader(CommandPacket):
     """Immediately jump to bootloader mode."""
     def __init__(self):
@@ -1425,6 +1502,27 @@ class HousekeepingDataGetRsp(ResponsePacket):
         super(HousekeepingDataGetRsp, self).__init__("HousekeepingDataGet", 0x14, __data)
 
 
+class InstrHistogramGetRsp(ResponsePacket):
+    """Response to a(n) InstrHistogramGet command."""
+    def __init__(self, raw_data):
+        __data = {}
+        __data["stage"], = struct.unpack("<B", raw_data[0:1])
+        __data["count"], = struct.unpack("<I", raw_data[1:5])
+        __data["max"], = struct.unpack("<I", raw_data[5:9])
+        __data["total"], = struct.unpack("<Q", raw_data[9:17])
+        __data["buckets"] = list(struct.unpack("<%dI" % ((len(raw_data) - 17) // 4), raw_data[17:]))
+        super(InstrHistogramGetRsp, self).__init__("InstrHistogramGet", 0x16, __data)
+
+
+class PacketTraceReadRsp(ResponsePacket):
+    """Response to a(n) PacketTraceRead command."""
+    def __init__(self, raw_data):
+        __data = {}
+        __data["dropped"], = struct.unpack("<I", raw_data[0:4])
+        __data["data"] = raw_data[4:]
+        super(PacketTraceReadRsp, self).__init__("PacketTraceRead", 0x1A, __data)
+
+
 class AdvAddrGetRsp(ResponsePacket):
     """Response to a(n) AdvAddrGet command."""
     def __init__(self, raw_data):
@@ -1680,6 +1778,42 @@ class AddrPublicationRemoveRsp(ResponsePacket):
         super(AddrPublicationRemoveRsp, self).__init__("AddrPublicationRemove", 0xA6, __data)
 
 
+class HeartbeatTableGetRsp(ResponsePacket):
+    """Response to a(n) HeartbeatTableGet command."""
+    ENTRY_FORMAT = "<HHIHBBBbbbb"
+    ENTRY_FIELDS = ["src", "count", "age_s", "features", "min_hops", "max_hops", "last_hops",
+                    "rssi_last", "rssi_min", "rssi_max", "rssi_avg"]
+
+    def __init__(self, raw_data):
+        __data = {}
+        __data["total_count"], = struct.unpack("<H", raw_data[0:2])
+        entry_size = struct.calcsize(self.ENTRY_FORMAT)
+        __data["entries"] = [dict(zip(self.ENTRY_FIELDS,
+                                      struct.unpack(self.ENTRY_FORMAT, raw_data[i:i + entry_size])))
+                             for i in range(2, len(raw_data) - entry_size + 1, entry_size)]
+        super(HeartbeatTableGetRsp, self).__init__("HeartbeatTableGet", 0xAD, __data)
+
+
+class StatsGetRsp(ResponsePacket):
+    """Response to a(n) StatsGet command."""
+    # In the order of mesh_stats_counter_t. Counters unknown to this list are named by their index.
+    COUNTER_NAMES = ["net_rx", "net_decrypt_attempt", "net_rx_drop_cache", "net_rx_drop_decrypt",
+                     "net_rx_drop_invalid", "net_tx", "net_relayed", "trs_rx_drop_unknown_dst",
+                     "trs_rx_drop_replay", "trs_rx_drop_replay_full", "trs_rx_drop_decrypt",
+                     "trs_sar_rx_start", "trs_sar_rx_complete", "trs_sar_rx_fail", "trs_sar_tx_start",
+                     "trs_sar_tx_complete", "trs_sar_tx_fail", "access_rx", "access_rx_unhandled",
+                     "adv_tx_queue_full", "flash_write", "flash_erase", "flash_queue_full",
+                     "scanner_rx", "scanner_crc_fail", "scanner_no_mem"]
+
+    def __init__(self, raw_data):
+        __data = {}
+        count, = struct.unpack("<B", raw_data[0:1])
+        values = struct.unpack("<%dI" % count, raw_data[1:1 + 4 * count])
+        names = self.COUNTER_NAMES + ["counter_%d" % i for i in range(len(self.COUNTER_NAMES), count)]
+        __data["counters"] = dict(zip(names, values))
+        super(StatsGetRsp, self).__init__("StatsGet", 0xB0, __data)
+
+
 class BankInfoGetRsp(ResponsePacket):
     """Response to a(n) BankInfoGet command."""
     def __init__(self, raw_data):
@@ -1836,6 +1970,8 @@ RESPONSE_LUT = {
     0x0A: {"object": FwInfoGetRsp, "name": "FwInfoGet"},
     0x13: {"object": BeaconParamsGetRsp, "name": "BeaconParamsGet"},
     0x14: {"object": HousekeepingDataGetRsp, "name": "HousekeepingDataGet"},
+    0x16: {"object": InstrHistogramGetRsp, "name": "InstrHistogramGet"},
+    0x1A: {"object": PacketTraceReadRsp, "name": "PacketTraceRead"},
     0x41: {"object": AdvAddrGetRsp, "name": "AdvAddrGet"},
     0x45: {"object": TxPowerGetRsp, "name": "TxPowerGet"},
     0x54: {"object": UuidGetRsp, "name": "UuidGet"},
@@ -1867,6 +2003,8 @@ RESPONSE_LUT = {
     0xA4: {"object": AddrPublicationAddRsp, "name": "AddrPublicationAdd"},
     0xA5: {"object": AddrPublicationAddVirtualRsp, "name": "AddrPublicationAddVirtual"},
     0xA6: {"object": AddrPublicationRemoveRsp, "name": "AddrPublicationRemove"},
+    0xAD: {"object": HeartbeatTableGetRsp, "name": "HeartbeatTableGet"},
+    0xB0: {"object": StatsGetRsp, "name": "StatsGet"},
     0xD4: {"object": BankInfoGetRsp, "name": "BankInfoGet"},
     0xD6: {"object": StateGetRsp, "name": "StateGet"},
     0xE1: {"object": ModelPubAddrGetRsp, "name": "ModelPubAddrGet"},
@@ -0,0 +1,150 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+import collections
+import os
+import struct
+import threading
+
+from aci.aci_uart import Device
+from aci.aci_evt import Event, event_deserialize
+
+
+CMD_RSP_OPCODE = Event.CMD_RSP
+ECDH_SECRET_OPCODE = 0x68
+
+
+class Loopback(Device):
+    """Simulated device for running the host side of the serial interface without hardware.
+
+    Every command is answered with a successful command response, like the serial example would.
+    Events are injected with the *_inject() functions, and go through the same deserialization
+    and recipients as events from a UART.
+    """
+    def __init__(self, device_name="loopback"):
+        Device.__init__(self, device_name)
+        self.commands = []
+        self.ecdh_secrets = {}
+        self.__ecdh_lock = threading.Condition()
+
+    def stop(self):
+        self.kill_writer()
+
+    def event_inject(self, opcode, data):
+        raw = bytearray([len(data) + 1, opcode]) + bytearray(data)
+        self.process_packet(event_deserialize(raw))
+
+    def ecdh_request_inject(self, context_id, peer_public, node_private):
+        """Injects a _Provisioning ECDH Request_ event, as sent by a device with ECDH offloading
+        enabled."""
+        with self.__ecdh_lock:
+            self.ecdh_secrets.pop(context_id, None)
+        self.event_inject(Event.PROV_ECDH_REQUEST,
+                          struct.pack("<B", context_id) + bytes(peer_public) + bytes(node_private))
+
+    def ecdh_secret_wait(self, context_id, timeout=None):
+        """Waits for the shared secret of a context to be set with the EcdhSecret command."""
+        with self.__ecdh_lock:
+            self.__ecdh_lock.wait_for(lambda: context_id in self.ecdh_secrets, timeout)
+            return self.ecdh_secrets.get(context_id)
+
+    def write_data(self, data):
+        opcode = data[1]
+        self.commands.append(bytearray(data))
+        self.process_command(data)
+        response = struct.pack("<BB", opcode, 0)
+        if opcode == ECDH_SECRET_OPCODE:
+            context_id = data[2]
+            with self.__ecdh_lock:
+                self.ecdh_secrets[context_id] = bytearray(data[3:35])
+                self.__ecdh_lock.notify_all()
+            response += struct.pack("<B", context_id)
+        self.event_inject(CMD_RSP_OPCODE, response)
+
+    def __repr__(self):
+        return '%s(device_name="%s")' % (self.__class__.__name__, self.device_name)
+
+
+class PtyLoopback(threading.Thread):
+    """Simulated device behind a pseudo-terminal.
+
+    Answers every command written to the pty with a successful command response, and echo
+    commands with an echo response, so that a transport can be run against `self.port` like
+    against a real serial port. Each response is delayed by `latency` seconds, to model the
+    command handling and the USB or UART turnaround of a real device.
+    """
+    def __init__(self, latency=0.001):
+        import pty
+        import tty
+        threading.Thread.__init__(self, daemon=True)
+        self.__master, slave = pty.openpty()
+        tty.setraw(self.__master)
+        tty.setraw(slave)
+        self.port = os.ttyname(slave)
+        self.__slave = slave
+        self.latency = latency
+        self.commands = 0
+        self.keep_running = True
+        self.start()
+
+    def stop(self):
+        self.keep_running = False
+        os.close(self.__slave)
+
+    def run(self):
+        import select
+        import time
+        from aci.aci_async import PacketDecoder
+        decoder = PacketDecoder()
+        responses = collections.deque()
+        while self.keep_running:
+            timeout = max(responses[0][0] - time.monotonic(), 0) if responses else 0.1
+            readable, _, _ = select.select([self.__master], [], [], timeout)
+            if readable:
+                try:
+                    data = os.read(self.__master, 4096)
+                except OSError:
+                    break
+                due = time.monotonic() + self.latency
+                for packet in decoder.feed(data):
+                    self.commands += 1
+                    opcode = packet[1]
+                    if opcode == 0x02:
+                        response = bytearray([len(packet) - 1, Event.DEVICE_ECHO_RSP]) + packet[2:]
+                    else:
+                        response = bytearray([3, CMD_RSP_OPCODE, opcode, 0])
+                    responses.append((due, response))
+
+            data = bytearray()
+            now = time.monotonic()
+            while responses and responses[0][0] <= now:
+                data += responses.popleft()[1]
+            if data:
+                os.write(self.__master, data)
+        os.close(self.__master)
@@ -44,6 +44,7 @@ from argparse import ArgumentParser
 import traitlets.config
 
 from aci.aci_uart import Uart
+from aci.aci_async import AsyncUart
 from aci.aci_utils import STATUS_CODE_LUT
 from aci.aci_config import ApplicationConfig
 import aci.aci_cmd as cmd
@@ -211,10 +212,11 @@ def start_ipython(options):
         print("Creating log directory: {}".format(os.path.abspath(LOG_DIR)))
         os.mkdir(LOG_DIR)
 
+    transport = AsyncUart if options.async_transport else Uart
     for dev_com in comports:
-        d.append(Interactive(Uart(port=dev_com,
-                                  baudrate=options.baudrate,
-                                  device_name=dev_com.split("/")[-1])))
+        d.append(Interactive(transport(port=dev_com,
+                                       baudrate=options.baudrate,
+                                       device_name=dev_com.split("/")[-1])))
 
     device = d[0]
     send = device.acidev.write_aci_cmd  # NOQA: Ignore unused variable
@@ -265,6 +267,13 @@ if __name__ == '__main__':
                         required=False,
                         default=False,
                         help="Disables logging to file.")
+    parser.add_argument("--async",
+                        dest="async_transport",
+                        action="store_true",
+                        required=False,
+                        default=False,
+                        help=("Use the asyncio transport, which pipelines "
+                              + "commands instead of waiting for each response."))
     parser.add_argument("-l", "--log-level",
                         dest="log_level",
                         type=int,
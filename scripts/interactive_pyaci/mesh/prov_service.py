@@ -0,0 +1,316 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+import collections
+import concurrent.futures
+import logging
+import threading
+import time
+
+from cryptography.hazmat.backends import default_backend
+from cryptography.hazmat.primitives import cmac
+from cryptography.hazmat.primitives.ciphers import algorithms
+from cryptography.hazmat.primitives.asymmetric import ec
+
+import aci.aci_cmd as cmd
+from aci.aci_evt import Event
+
+
+PROV_NONCE_LEN = 13
+ZERO_KEY = bytes(16)
+
+
+# Cryptographic functions of the provisioning procedure, matching prov_utils.c. They are plain
+# module functions so that they can be pickled and run in the worker processes.
+
+def aes_cmac(key, data):
+    c = cmac.CMAC(algorithms.AES(bytes(key)), backend=default_backend())
+    c.update(bytes(data))
+    return c.finalize()
+
+
+def s1(data):
+    """Salt generation function s1."""
+    return aes_cmac(ZERO_KEY, data)
+
+
+def k1(ikm, salt, info):
+    """Key derivation function k1."""
+    return aes_cmac(aes_cmac(salt, ikm), info)
+
+
+def ecdh(peer_public, node_private):
+    """Calculates the ECDH shared secret of a raw public and private key."""
+    private_key = ec.derive_private_key(int.from_bytes(bytes(node_private), "big"), ec.SECP256R1(),
+                                        default_backend())
+    public_key = ec.EllipticCurvePublicNumbers(int.from_bytes(bytes(peer_public[:32]), "big"),
+                                               int.from_bytes(bytes(peer_public[32:]), "big"),
+                                               ec.SECP256R1()).public_key(default_backend())
+    return private_key.exchange(ec.ECDH(), public_key)
+
+
+def authentication_values_derive(shared_secret, confirmation_inputs, local_random, auth_value):
+    """Derives the confirmation salt and confirmation value, as prov_utils_authentication_values_derive().
+
+    The confirmation inputs are the invite, capabilities and start PDU values, followed by the
+    provisioner's and the device's public keys.
+    """
+    confirmation_salt = s1(confirmation_inputs)
+    confirmation_key = k1(shared_secret, confirmation_salt, b"prck")
+    confirmation = aes_cmac(confirmation_key, bytes(local_random) + bytes(auth_value))
+    return confirmation_salt, confirmation
+
+
+def derive_keys(shared_secret, confirmation_salt, provisioner_random, device_random):
+    """Derives the session key, session nonce and device key, as prov_utils_derive_keys()."""
+    provisioning_salt = s1(bytes(confirmation_salt) + bytes(provisioner_random) + bytes(device_random))
+    session_key = k1(shared_secret, provisioning_salt, b"prsk")
+    session_nonce = k1(shared_secret, provisioning_salt, b"prsn")[-PROV_NONCE_LEN:]
+    device_key = k1(shared_secret, provisioning_salt, b"prdk")
+    return session_key, session_nonce, device_key
+
+
+def batch_run(jobs):
+    """Runs a list of (function, args) jobs, returning a (result, exception) pair for each.
+
+    Jobs are sent to the worker processes in batches, as a single ECDH takes about as long as the
+    round trip to a worker.
+    """
+    results = []
+    for function, args in jobs:
+        try:
+            results.append((function(*args), None))
+        except Exception as e:
+            results.append((None, e))
+    return results
+
+
+class ProvisioningServiceStats(object):
+    def __init__(self):
+        self.requests = 0
+        self.completed = 0
+        self.failed = 0
+        self.in_flight = 0
+        self.in_flight_max = 0
+        self.latency_total = 0.0
+        self.latency_max = 0.0
+        self.first_request = None
+        self.last_completion = None
+
+    @property
+    def throughput(self):
+        """Completed jobs per second, from the first request to the last completion."""
+        if not self.completed or self.last_completion <= self.first_request:
+            return 0.0
+        return self.completed / (self.last_completion - self.first_request)
+
+    @property
+    def latency_avg(self):
+        return self.latency_total / self.completed if self.completed else 0.0
+
+    def __str__(self):
+        return ("{} requests, {} completed, {} failed, {} in flight (max {}), "
+                "{:.1f} jobs/s, latency avg {:.1f} ms max {:.1f} ms").format(
+                    self.requests, self.completed, self.failed, self.in_flight,
+                    self.in_flight_max, self.throughput, self.latency_avg * 1000,
+                    self.latency_max * 1000)
+
+
+class ProvisioningService(object):
+    """Host-side provisioning crypto service.
+
+    Answers the _Provisioning ECDH Request_ events of a device with ECDH offloading enabled,
+    running the ECDH in a pool of worker processes so that the links of a serial gateway don't
+    wait for each other. The key derivation steps can be run in the same pool with
+    authentication_values_derive_async() and derive_keys_async().
+
+    Parameters
+    ----------
+        interactive_device : Interactive
+            Device to serve. The service registers itself as the device's `ecdh_service`, so
+            that the Provisioner or Provisionee on the device leaves the requests to it.
+        workers : int
+            Number of worker processes, or 0 to run the jobs in the calling thread.
+        max_in_flight : int
+            Maximum number of job batches submitted to the pool at a time. Further jobs are
+            queued, and sent in batches of up to batch_size jobs as the pool catches up.
+        batch_size : int
+            Maximum number of jobs sent to a worker process at a time.
+    """
+    def __init__(self, interactive_device, workers=None, max_in_flight=None, batch_size=16):
+        self.iaci = interactive_device
+        self.logger = getattr(interactive_device, "logger", logging.getLogger(__name__))
+        self.stats = ProvisioningServiceStats()
+        self.batch_size = batch_size
+        self.__lock = threading.Lock()
+        self.__pending = collections.deque()
+        self.__batches = 0
+        if workers == 0:
+            self.__pool = None
+            self.max_in_flight = 1
+        else:
+            self.__pool = concurrent.futures.ProcessPoolExecutor(max_workers=workers)
+            self.max_in_flight = max_in_flight or 2 * self.__pool._max_workers
+        self.iaci.ecdh_service = self
+        self.iaci.acidev.add_packet_recipient(self.__event_handler)
+
+    def close(self):
+        self.iaci.acidev.remove_packet_recipient(self.__event_handler)
+        self.iaci.ecdh_service = None
+        if self.__pool:
+            self.__pool.shutdown(wait=True)
+
+    def authentication_values_derive_async(self, shared_secret, confirmation_inputs, local_random, auth_value):
+        return self.__submit(authentication_values_derive,
+                             (shared_secret, confirmation_inputs, local_random, auth_value))
+
+    def derive_keys_async(self, shared_secret, confirmation_salt, provisioner_random, device_random):
+        return self.__submit(derive_keys,
+                             (shared_secret, confirmation_salt, provisioner_random, device_random))
+
+    def __event_handler(self, event):
+        if event._opcode == Event.PROV_ECDH_REQUEST:
+            context_id = event._data["context_id"]
+            future = self.__submit(ecdh, (event._data["peer_public"], event._data["node_private"]))
+            future.add_done_callback(lambda f: self.__ecdh_done(context_id, f))
+
+    def __ecdh_done(self, context_id, future):
+        if future.exception() is None:
+            self.iaci.send(cmd.EcdhSecret(context_id, future.result()))
+        else:
+            self.logger.error("ECDH for context %d failed: %s", context_id, future.exception())
+
+    def __submit(self, function, args):
+        """Queues a job, and starts it if fewer than max_in_flight batches are running."""
+        future = concurrent.futures.Future()
+        with self.__lock:
+            now = time.monotonic()
+            self.stats.requests += 1
+            if self.stats.first_request is None:
+                self.stats.first_request = now
+            self.__pending.append((function, args, future, now))
+        self.__dispatch()
+        return future
+
+    def __dispatch(self):
+        while True:
+            with self.__lock:
+                if not self.__pending or self.__batches >= self.max_in_flight:
+                    return
+                batch = [self.__pending.popleft()
+                         for _ in range(min(self.batch_size, len(self.__pending)))]
+                self.__batches += 1
+                self.stats.in_flight += len(batch)
+                self.stats.in_flight_max = max(self.stats.in_flight_max, self.stats.in_flight)
+
+            jobs = [(function, args) for function, args, _, _ in batch]
+            if self.__pool is None:
+                self.__complete(batch, batch_run(jobs))
+            else:
+                self.__pool.submit(batch_run, jobs).add_done_callback(
+                    lambda f, batch=batch: self.__complete(batch, f.result()))
+
+    def __complete(self, batch, results):
+        with self.__lock:
+            now = time.monotonic()
+            self.__batches -= 1
+            self.stats.in_flight -= len(batch)
+            for (_, _, _, start_time), (_, exception) in zip(batch, results):
+                if exception is None:
+                    latency = now - start_time
+                    self.stats.completed += 1
+                    self.stats.latency_total += latency
+                    self.stats.latency_max = max(self.stats.latency_max, latency)
+                    self.stats.last_completion = now
+                else:
+                    self.stats.failed += 1
+
+        for (_, _, future, _), (result, exception) in zip(batch, results):
+            if exception is None:
+                future.set_result(result)
+            else:
+                future.set_exception(exception)
+        self.__dispatch()
+
+
+def loopback_run(links, workers):
+    """Runs ECDH offloading for a number of links against a simulated device, checking every
+    shared secret. Returns the service statistics."""
+    from aci.aci_loopback import Loopback
+
+    class LoopbackInteractive(object):
+        def __init__(self):
+            self.acidev = Loopback()
+            self.logger = logging.getLogger("loopback")
+            self.send = self.acidev.write_aci_cmd
+
+    def raw_keys(private_key):
+        """Returns the raw private and public key, in the format of the serial interface."""
+        numbers = private_key.private_numbers()
+        public = numbers.public_numbers
+        return (numbers.private_value.to_bytes(32, "big"),
+                public.x.to_bytes(32, "big") + public.y.to_bytes(32, "big"))
+
+    iaci = LoopbackInteractive()
+    service = ProvisioningService(iaci, workers=workers)
+    try:
+        links = [(raw_keys(ec.generate_private_key(ec.SECP256R1(), default_backend())),
+                  raw_keys(ec.generate_private_key(ec.SECP256R1(), default_backend())))
+                 for _ in range(links)]
+        expected = [ecdh(peer_public, node_private)
+                    for (node_private, _), (_, peer_public) in links]
+
+        # The device has one outstanding request per context ID, so run the links in rounds of
+        # 256 contexts.
+        for first in range(0, len(links), 0x100):
+            keys = links[first:first + 0x100]
+            for context_id, ((node_private, _), (_, peer_public)) in enumerate(keys):
+                iaci.acidev.ecdh_request_inject(context_id, peer_public, node_private)
+
+            for context_id in range(len(keys)):
+                secret = iaci.acidev.ecdh_secret_wait(context_id, timeout=60)
+                if secret != expected[first + context_id]:
+                    raise RuntimeError("Wrong shared secret for link {}".format(first + context_id))
+        return service.stats
+    finally:
+        service.close()
+        iaci.acidev.stop()
+
+
+if __name__ == "__main__":
+    from argparse import ArgumentParser
+
+    parser = ArgumentParser(description="Runs the provisioning service against a simulated device.")
+    parser.add_argument("-l", "--links", type=int, default=256, help="Number of links to serve")
+    parser.add_argument("-w", "--workers", type=int, nargs="+", default=[0, 1, 2, 4],
+                        help="Worker process counts to compare, 0 for no pool")
+    args = parser.parse_args()
+
+    for workers in args.workers:
+        print("{} workers: {}".format(workers, loopback_run(args.links, workers)))
@@ -162,6 +162,9 @@ class ProvDevice(object):
 
     def default_handler(self, event):
         if event._opcode == Event.PROV_ECDH_REQUEST:
+            if getattr(self.iaci, "ecdh_service", None):
+                # Answered by the ProvisioningService attached to the device
+                return
             self.logger.info("ECDH request received")
             public_key_peer = raw_to_public_key(event._data["peer_public"])
             private_key = raw_to_private_key(event._data["node_private"])
@@ -0,0 +1,181 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Captures and prints packet traces recorded by the packet trace module (packet_trace.h).
+
+A trace is a header followed by one record per packet received by the scanner. See packet_trace.h
+for the format.
+"""
+
+import argparse
+import argparse
+import csv
+import json
+import os
+import sys
+import time
+
+
+class StatsDevice(object):
+    """Reads the statistics counters of a serial example device."""
+    def __init__(self, port, baudrate):
+        sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "interactive_pyaci"))
+        from aci.aci_uart import Uart
+        from aci import aci_cmd
+        from aci import aci_evt
+
+        self._aci_cmd = aci_cmd
+        self._aci_evt = aci_evt
+        self._responses = []
+        self._device = Uart(port=port, baudrate=baudrate, device_name=port)
+        self._device.add_packet_recipient(self._response_handler)
+
+    def _response_handler(self, event):
+        if event._opcode == self._aci_evt.Event.CMD_RSP and event._data["opcode"] in (0xB0, 0xB1):
+            self._responses.append(event)
+
+    def _command(self, cmd, timeout):
+        self._responses = []
+        self._device.write_aci_cmd(cmd)
+        end = time.time() + timeout
+        while not self._responses:
+            if time.time() > end:
+                raise RuntimeError("No response from the device")
+            time.sleep(0.01)
+        event = self._responses.pop(0)
+        if event._data["status"] != 0:
+            raise RuntimeError("Command failed with status 0x%02x, is the device built with MESH_STATS_ENABLE?" %
+                               event._data["status"])
+        return event
+
+    def get(self, timeout=1.0):
+        event = self._command(self._aci_cmd.StatsGet(), timeout)
+        return self._aci_cmd.response_deserialize(event)._data["counters"]
+
+    def clear(self, timeout=1.0):
+        self._command(self._aci_cmd.StatsClear(), timeout)
+
+    def stop(self):
+        self._device.stop()
+
+
+def deltas_get(previous, current):
+    """Returns the increase of each counter, the counters wrap at 2^32."""
+    return {name: (value - previous.get(name, 0)) & 0xFFFFFFFF for name, value in current.items()}
+
+
+def poll(args):
+    device = StatsDevice(args.device, args.baudrate)
+    writer = None
+    output = None
+    try:
+        if args.clear:
+            device.clear()
+        previous = device.get()
+        start = time.time()
+        end = start + args.duration if args.duration else None
+        while end is None or time.time() < end:
+            time.sleep(args.interval)
+            current = device.get()
+            deltas = deltas_get(previous, current)
+            previous = current
+            elapsed = time.time() - start
+            changed = ["%s +%u" % (name, delta) for name, delta in deltas.items() if delta]
+            print("%8.1f s: %s" % (elapsed, ", ".join(changed) if changed else "no change"))
+            if args.output:
+                if writer is None:
+                    output = open(args.output, "w", newline="")
+                    writer = csv.DictWriter(output, fieldnames=["time"] + list(current.keys()))
+                    writer.writeheader()
+                row = dict(current)
+                row["time"] = "%.3f" % elapsed
+                writer.writerow(row)
+                output.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if output:
+            output.close()
+        device.stop()
+
+
+def export(args):
+    device = StatsDevice(args.device, args.baudrate)
+    try:
+        counters = device.get()
+        if args.clear:
+            device.clear()
+    finally:
+        device.stop()
+
+    if args.format == "json":
+        text = json.dumps({"time": time.time(), "counters": counters}, indent=4)
+        if args.output:
+            with open(args.output, "w") as f:
+                f.write(text + "\n")
+        else:
+            print(text)
+    else:
+        f = open(args.output, "w", newline="") if args.output else sys.stdout
+        writer = csv.writer(f)
+        writer.writerow(["counter", "value"])
+        for name, value in counters.items():
+            writer.writerow([name, value])
+        if args.output:
+            f.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reads the statistics counters of a serial example device.")
+    parser.add_argument("device", help="Serial port of the device")
+    parser.add_argument("-b", "--baudrate", type=int, default=115200)
+    subparsers = parser.add_subparsers(dest="command")
+    subparsers.required = True
+
+    poll_parser = subparsers.add_parser("poll", help="Print the counters that changed at regular intervals")
+    poll_parser.add_argument("-i", "--interval", type=float, default=1.0,
+                             help="Time between reads in seconds")
+    poll_parser.add_argument("-d", "--duration", type=float, default=0,
+                             help="Polling duration in seconds, polls until interrupted if 0")
+    poll_parser.add_argument("-o", "--output", help="CSV file to append every read to")
+    poll_parser.add_argument("-c", "--clear", action="store_true", help="Clear the counters before polling")
+    poll_parser.set_defaults(func=poll)
+
+    export_parser = subparsers.add_parser("export", help="Export a snapshot of the counters")
+    export_parser.add_argument("-f", "--format", choices=["json", "csv"], default="json")
+    export_parser.add_argument("-o", "--output", help="File to write, standard output if omitted")
+    export_parser.add_argument("-c", "--clear", action="store_true", help="Clear the counters after reading them")
+    export_parser.set_defaults(func=export)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -72,6 +72,7 @@ HEADER_START="""/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
 #define PACKET_MESH_H__
 
 #include <stdint.h>
+#include "nrf_mesh_config_core.h"
 
 /**
  * @defgroup PACKET_MESH Mesh packet formats
@@ -393,6 +394,11 @@ class PacketFMT(object):
             self._max_length = args['max_length']
         else:
             self._max_length = 0
+        # Size of the packet type's buffer, if it differs from the max length.
+        if 'buffer_size' in args:
+            self._buffer_size = args['buffer_size']
+        else:
+            self._buffer_size = None
         self._packet_type = args['packet_type']
         if 'defines' in args:
             self._defines = [Define(**fields) for fields in args['defines']]
@@ -492,6 +498,7 @@ if __name__ == "__main__":
     fields = json_reads()
     defines = []
     pdu_types = {}
+    pdu_buffer_sizes = {}
     pdu_strings = ""
     pdu_funcs = ""
     pdu_defines = ""
@@ -509,11 +516,14 @@ if __name__ == "__main__":
         if f._type == "variable":
             pdu_funcs += pdu_func_format_string.format(lname=f.get_full_name().lower(), uname=f.get_full_name().upper(), packet_type=f._packet_type)
 
+        if f._buffer_size is not None:
+            pdu_buffer_sizes[f._packet_type] = f._buffer_size
+
         if not f._packet_type in pdu_types or f._max_length > pdu_types[f._packet_type]:
             pdu_types[f._packet_type] = f._max_length
 
     for pdu in pdu_types:
-        pdu_strings += packet_format_string.format(full_name_human_readable=pdu.replace('_', ' ')[len('packet_mesh_'):-len('_packet_t')], pdu_type=pdu, maxlen=pdu_types[pdu])
+        pdu_strings += packet_format_string.format(full_name_human_readable=pdu.replace('_', ' ')[len('packet_mesh_'):-len('_packet_t')], pdu_type=pdu, maxlen=pdu_buffer_sizes.get(pdu, pdu_types[pdu]))
 
     blob = []
     for fmt in fields:
@@ -0,0 +1,131 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Captures and prints packet traces recorded by the packet trace module (packet_trace.h).
+
+A trace is a header followed by one record per packet received by the scanner. See packet_trace.h
+for the format.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+TRACE_MAGIC = 0x4352544D
+TRACE_VERSION = 1
+HEADER_FORMAT = "<IB3x"
+RECORD_FORMAT = "<IBbBB"
+
+
+def records_parse(data):
+    """Parses a trace, and yields (timestamp, channel, rssi, pdu_type, packet) for each record."""
+    if len(data) < struct.calcsize(HEADER_FORMAT):
+        raise ValueError("Trace too short")
+    magic, version = struct.unpack_from(HEADER_FORMAT, data)
+    if magic != TRACE_MAGIC or version != TRACE_VERSION:
+        raise ValueError("Not a version %d packet trace" % TRACE_VERSION)
+
+    offset = struct.calcsize(HEADER_FORMAT)
+    record_size = struct.calcsize(RECORD_FORMAT)
+    while offset + record_size <= len(data):
+        timestamp, channel, rssi, pdu_type, length = struct.unpack_from(RECORD_FORMAT, data, offset)
+        offset += record_size
+        if offset + length > len(data):
+            break
+        yield timestamp, channel, rssi, pdu_type, data[offset:offset + length]
+        offset += length
+
+
+def dump(args):
+    with open(args.trace, "rb") as f:
+        data = f.read()
+    for timestamp, channel, rssi, pdu_type, packet in records_parse(data):
+        print("%10u ch%-2u %4d dBm type %u %s %s" % (timestamp, channel, rssi, pdu_type & 0x0F,
+                                                    packet[:6][::-1].hex(), packet[6:].hex()))
+
+
+def capture(args):
+    sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "interactive_pyaci"))
+    from aci.aci_uart import Uart
+    from aci import aci_cmd
+    from aci import aci_evt
+
+    responses = []
+
+    def response_handler(event):
+        if (event._opcode == aci_evt.Event.CMD_RSP and event._data["opcode"] == 0x1A and
+                event._data["status"] == 0):
+            responses.append(aci_cmd.response_deserialize(event))
+
+    device = Uart(port=args.device, baudrate=args.baudrate, device_name=args.device)
+    device.add_packet_recipient(response_handler)
+
+    device.write_aci_cmd(aci_cmd.PacketTraceStart())
+    end = time.time() + args.duration
+    dropped = 0
+    with open(args.trace, "wb") as f:
+        while time.time() < end:
+            device.write_aci_cmd(aci_cmd.PacketTraceRead())
+            time.sleep(args.interval)
+            while responses:
+                rsp = responses.pop(0)
+                dropped = rsp._data["dropped"]
+                f.write(rsp._data["data"])
+    device.write_aci_cmd(aci_cmd.PacketTraceStop())
+    device.stop()
+    print("Capture done, %d records dropped on the device." % dropped)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Captures and prints packet traces.")
+    subparsers = parser.add_subparsers(dest="command")
+    subparsers.required = True
+
+    dump_parser = subparsers.add_parser("dump", help="Print the records of a trace")
+    dump_parser.add_argument("trace", help="Trace file")
+    dump_parser.set_defaults(func=dump)
+
+    capture_parser = subparsers.add_parser("capture", help="Capture a trace from a serial example device")
+    capture_parser.add_argument("device", help="Serial port of the device")
+    capture_parser.add_argument("trace", help="Trace file to write")
+    capture_parser.add_argument("-b", "--baudrate", type=int, default=115200)
+    capture_parser.add_argument("-d", "--duration", type=float, default=60.0,
+                                help="Capture duration in seconds")
+    capture_parser.add_argument("-i", "--interval", type=float, default=0.05,
+                                help="Time between reads in seconds")
+    capture_parser.set_defaults(func=capture)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
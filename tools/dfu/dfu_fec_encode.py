@@ -0,0 +1,146 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Creates forward error correction repair packets for a mesh DFU transfer.
+
+The data segments of the transfer are split into blocks of consecutive segments, and each repair
+packet carries a combination of all the segments of a block. A target recovers any lost data
+segments of a block from the same number of repair packets, without sending data requests. See
+mesh/bootloader/include/dfu_fec.h for the code.
+
+The repair packets are printed as hex strings, one DFU packet per line, ready to be sent after or
+interleaved with the data packets of the transfer.
+"""
+
+import argparse
+import struct
+import sys
+
+from intelhex import IntelHex
+
+SEGMENT_LENGTH = 16
+DFU_PACKET_TYPE_DATA_REPAIR = 0xFFF8
+BLOCK_SIZE_MAX = 128
+REPAIR_COUNT_MAX = 128
+REPAIR_INDEX_BASE = 0x80
+GF_POLYNOMIAL = 0x11D
+
+
+def gf_tables():
+    exp = [0] * 510
+    log = [0] * 256
+    x = 1
+    for i in range(255):
+        exp[i] = exp[i + 255] = x
+        log[x] = i
+        x <<= 1
+        if x & 0x100:
+            x ^= GF_POLYNOMIAL
+    return exp, log
+
+
+GF_EXP, GF_LOG = gf_tables()
+
+
+def coefficient(repair_index, segment_index):
+    return GF_EXP[255 - GF_LOG[(REPAIR_INDEX_BASE | repair_index) ^ segment_index]]
+
+
+def segments_from_image(data, start_address):
+    """Splits the image into the data segments of the transfer, padded with 0xFF.
+
+    The first segment ends at the first segment aligned address after the start address."""
+    segments = []
+    offset = 0
+    first_length = SEGMENT_LENGTH - (start_address % SEGMENT_LENGTH)
+    while offset < len(data):
+        length = first_length if offset == 0 else SEGMENT_LENGTH
+        segment = data[offset:offset + length]
+        segments.append(bytearray(segment) + bytearray([0xFF] * (SEGMENT_LENGTH - len(segment))))
+        offset += length
+    return segments
+
+
+def repair_segment(block, repair_index):
+    repair = bytearray(SEGMENT_LENGTH)
+    for segment_index, segment in enumerate(block):
+        c = GF_LOG[coefficient(repair_index, segment_index)]
+        for i, byte in enumerate(segment):
+            if byte:
+                repair[i] ^= GF_EXP[GF_LOG[byte] + c]
+    return repair
+
+
+def repair_packets(segments, transaction_id, block_size, repair_count):
+    for block_number in range(0, (len(segments) + block_size - 1) // block_size):
+        block = segments[block_number * block_size:(block_number + 1) * block_size]
+        for repair_index in range(repair_count):
+            yield struct.pack("<HHIBB", DFU_PACKET_TYPE_DATA_REPAIR, block_number, transaction_id,
+                              block_size, repair_index) + repair_segment(block, repair_index)
+
+
+def load_image(filename, start_address):
+    if filename.lower().endswith(".hex"):
+        ih = IntelHex(filename)
+        start_address = ih.minaddr()
+        data = ih.tobinstr()
+    else:
+        with open(filename, "rb") as f:
+            data = f.read()
+    # The transfer length is given in words.
+    data += b"\xFF" * (-len(data) % 4)
+    return data, start_address
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Mesh DFU forward error correction encoder")
+    parser.add_argument("image", help="Firmware image, as .hex or raw binary")
+    parser.add_argument("--transaction-id", type=lambda x: int(x, 0), required=True,
+                        help="Transaction ID of the DFU transfer")
+    parser.add_argument("--start-address", type=lambda x: int(x, 0), default=0,
+                        help="Start address of a raw binary image")
+    parser.add_argument("--block-size", type=int, default=32,
+                        help="Number of data segments in each block")
+    parser.add_argument("--repair", type=int, default=4,
+                        help="Number of repair packets per block")
+    args = parser.parse_args()
+
+    if not 0 < args.block_size <= BLOCK_SIZE_MAX:
+        parser.error("block size must be between 1 and %u" % BLOCK_SIZE_MAX)
+    if not 0 < args.repair <= REPAIR_COUNT_MAX:
+        parser.error("repair count must be between 1 and %u" % REPAIR_COUNT_MAX)
+
+    data, start_address = load_image(args.image, args.start_address)
+    segments = segments_from_image(data, start_address)
+    for packet in repair_packets(segments, args.transaction_id, args.block_size, args.repair):
+        sys.stdout.write("".join("%02X" % b for b in bytearray(packet)) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,256 @@
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Simulates a mesh DFU transfer over a chain of relays with packet loss.
+
+Models the data request (NACK) behavior of the mesh bootloader, and compares the completion time
+of single segment requests with windowed requests carrying a bitmap of missing segments. Every
+node only hears its direct neighbors, and every packet is lost to each receiver independently.
+Collisions and radio scheduling are not modeled.
+
+Nodes that can't complete because an upstream node aborted, or because they lost the final segment
+of the transfer, are reported as stuck.
+"""
+
+import argparse
+import heapq
+import random
+
+# Timing of the bootloader transmit intervals, in milliseconds.
+EXPONENTIAL_TX_OFFSETS_MS = [0, 20, 60]  # TX_REPEATS_DATA/TX_REPEATS_RSP with exponential backoff
+REQ_INTERVAL_MS = 100                    # TX_INTERVAL_TYPE_REQ, repeated until served
+RELAY_DELAY_MS = 2
+REQ_RX_COUNT_RETRY = 8
+REQ_CACHE_SIZE = 4
+TX_SLOTS = 8
+
+
+class Node(object):
+    def __init__(self, index, segment_count, missing_window):
+        self.index = index
+        self.segment_count = segment_count
+        self.missing_window = missing_window
+        self.have = set()
+        self.segment_max = 0
+        self.req_segment = None
+        self.req_generation = 0
+        self.last_requested = 0
+        self.req_cache = []
+        self.done_time = None
+        self.aborted = False
+
+    def missing(self, segment):
+        return segment not in self.have
+
+    def oldest_missing(self):
+        start = max(1, self.segment_max - self.missing_window + 1, self.last_requested)
+        for segment in range(start, self.segment_max + 1):
+            if self.missing(segment):
+                return segment
+        return None
+
+
+class Simulation(object):
+    def __init__(self, hops, segment_count, loss, req_window, missing_window, period_ms, seed,
+                 time_limit_ms):
+        self.time_limit_ms = time_limit_ms
+        self.rng = random.Random(seed)
+        self.loss = loss
+        self.req_window = req_window
+        self.period_ms = period_ms
+        self.segment_count = segment_count
+        self.nodes = [Node(i, segment_count, missing_window) for i in range(hops + 1)]
+        self.nodes[0].have = set(range(1, segment_count + 1))
+        self.nodes[0].segment_max = segment_count
+        self.nodes[0].done_time = 0
+        self.events = []
+        self.sequence = 0
+        self.req_packets = 0
+        self.rsp_packets = 0
+
+    def post(self, time, action, *args):
+        heapq.heappush(self.events, (time, self.sequence, action, args))
+        self.sequence += 1
+
+    def neighbors(self, node):
+        return [n for n in (node.index - 1, node.index + 1) if 0 <= n < len(self.nodes)]
+
+    def broadcast(self, time, sender, handler, *args):
+        for offset in EXPONENTIAL_TX_OFFSETS_MS:
+            self.post(time + offset, self.deliver, sender, handler, args)
+
+    def deliver(self, time, sender, handler, args):
+        for n in self.neighbors(sender):
+            if self.rng.random() >= self.loss:
+                handler(time, self.nodes[n], *args)
+
+    # Target behavior
+
+    def rx_data(self, time, node, segment):
+        if node.aborted or not node.missing(segment):
+            return
+        if segment > node.segment_max:
+            # Segments falling out of the missing window can't be recovered.
+            for s in range(max(1, node.segment_max - node.missing_window + 1),
+                           segment - node.missing_window + 1):
+                if node.missing(s):
+                    node.aborted = True
+                    return
+            node.segment_max = segment
+        node.have.add(segment)
+        if len(node.have) == self.segment_count:
+            node.done_time = time
+        # Relay the new segment.
+        self.broadcast(time + RELAY_DELAY_MS, node, self.rx_data, segment)
+
+        if node.req_segment == segment:
+            node.req_segment = None
+        if node.req_segment is None:
+            self.request_missing(time, node, node.segment_max)
+
+    def request_missing(self, time, node, newest_segment):
+        segment = node.oldest_missing()
+        if segment is None:
+            return
+        if not (segment < newest_segment - 1 or newest_segment == self.segment_count):
+            return
+        last = self.segment_count if newest_segment == self.segment_count else newest_segment - 2
+        bitmap = [s for s in range(segment + 1, min(segment + self.req_window, last) + 1)
+                  if node.missing(s)]
+        node.req_segment = segment
+        node.last_requested = segment
+        node.req_generation += 1
+        self.tx_req(time, node, node.req_generation, segment, bitmap)
+
+    def tx_req(self, time, node, generation, segment, bitmap):
+        if node.req_segment != segment or node.req_generation != generation or node.aborted:
+            return
+        self.req_packets += 1
+        self.deliver(time, node, self.rx_req, (segment, bitmap))
+        self.post(time + REQ_INTERVAL_MS, self.tx_req, node, generation, segment, bitmap)
+
+    # Serving behavior
+
+    def serve(self, time, node, segment):
+        for entry in node.req_cache:
+            if entry[0] == segment:
+                entry[1] += 1
+                if entry[1] <= REQ_RX_COUNT_RETRY:
+                    return False
+                entry[1] = 0
+                break
+        else:
+            if node.missing(segment):
+                return False
+            node.req_cache.append([segment, 0])
+            if len(node.req_cache) > REQ_CACHE_SIZE:
+                node.req_cache.pop(0)
+        if node.missing(segment):
+            return False
+        self.rsp_packets += 1
+        self.broadcast(time + RELAY_DELAY_MS, node, self.rx_data, segment)
+        return True
+
+    def rx_req(self, time, node, segment, bitmap):
+        served = 1 if self.serve(time, node, segment) else 0
+        for s in bitmap:
+            if served >= TX_SLOTS - 1:
+                break
+            if self.serve(time, node, s):
+                served += 1
+
+    def run(self):
+        for segment in range(1, self.segment_count + 1):
+            self.broadcast((segment - 1) * self.period_ms, self.nodes[0], self.rx_data, segment)
+        while self.events:
+            time, _, action, args = heapq.heappop(self.events)
+            if time > self.time_limit_ms:
+                break
+            action(time, *args)
+            if action == self.rx_data and all(n.done_time is not None or n.aborted for n in self.nodes):
+                break
+        return self.nodes
+
+
+def simulate(args, req_window):
+    results = []
+    for run in range(args.runs):
+        sim = Simulation(args.hops, args.segments, args.loss, req_window, args.missing_window,
+                         args.period, args.seed + run, args.time_limit * 1000)
+        targets = sim.run()[1:]
+        done_times = [n.done_time for n in targets if n.done_time is not None]
+        results.append({
+            "completed": len(done_times),
+            "aborted": sum(1 for n in targets if n.aborted),
+            "stuck": sum(1 for n in targets if n.done_time is None and not n.aborted),
+            "time": max(done_times) if len(done_times) == len(targets) else None,
+            "requests": sim.req_packets,
+            "responses": sim.rsp_packets})
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Mesh DFU packet loss simulator")
+    parser.add_argument("--hops", type=int, default=6, help="Number of relays after the source")
+    parser.add_argument("--segments", type=int, default=2048,
+                        help="Number of 16 byte segments in the transfer")
+    parser.add_argument("--loss", type=float, default=0.4,
+                        help="Probability of losing a packet, per receiver")
+    parser.add_argument("--period", type=int, default=20,
+                        help="Interval between new segments from the source, in milliseconds")
+    parser.add_argument("--window", type=int, default=64,
+                        help="Segments covered by a windowed data request (DFU_DATA_REQ_WINDOW)")
+    parser.add_argument("--missing-window", type=int, default=256,
+                        help="Segments tracked as missing (DFU_TRANSFER_MISSING_WINDOW)")
+    parser.add_argument("--time-limit", type=int, default=600,
+                        help="Simulated time to give up after, in seconds")
+    parser.add_argument("--runs", type=int, default=5, help="Number of runs to average over")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed of the first run")
+    args = parser.parse_args()
+
+    print("%u segments, %u hops, %.0f%% loss, %u runs" %
+          (args.segments, args.hops, args.loss * 100, args.runs))
+    print("%-20s %10s %8s %8s %12s %10s %10s" %
+          ("Request type", "Completed", "Aborted", "Stuck", "Time (s)", "Requests", "Responses"))
+    for name, window in (("Single segment", 0), ("Window of %u" % args.window, args.window)):
+        results = simulate(args, window)
+        runs = float(len(results))
+        times = [r["time"] for r in results if r["time"] is not None]
+        print("%-20s %10.1f %8.1f %8.1f %12s %10.0f %10.0f" % (
+            name,
+            sum(r["completed"] for r in results) / runs,
+            sum(r["aborted"] for r in results) / runs,
+            sum(r["stuck"] for r in results) / runs,
+            "%.1f" % (sum(times) / len(times) / 1000.0) if times else "-",
+            sum(r["requests"] for r in results) / runs,
+            sum(r["responses"] for r in results) / runs))
+
+
+if __name__ == "__main__":
+    main()